@@ -0,0 +1,122 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef AMATHUTILS_LIB_SLIDING_WINDOW_STATISTICS_HPP
+#define AMATHUTILS_LIB_SLIDING_WINDOW_STATISTICS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * @file sliding_window_statistics.hpp
+ * @brief order statistics, mean and variance of a first-in first-out window of values
+ *
+ * Values are kept in insertion order and in a treap ordered by value, so that push and pop take O(log n),
+ * order statistics O(log n) and mean and variance O(1). NaN is ordered after all other values.
+ */
+
+namespace amathutils
+{
+class SlidingWindowStatistics
+{
+public:
+  SlidingWindowStatistics();
+
+  /**
+   * @brief add a value to the back of the window
+   */
+  void push(const double value);
+
+  /**
+   * @brief remove the oldest value, does nothing if the window is empty
+   */
+  void pop();
+
+  /**
+   * @brief remove all values
+   */
+  void clear();
+
+  /**
+   * @brief oldest value in the window
+   */
+  double front() const;
+
+  size_t size() const;
+  bool empty() const;
+
+  /**
+   * @brief k-th smallest value, 0-based
+   * @throws std::out_of_range if k >= size()
+   */
+  double getKthSmallest(const size_t k) const;
+
+  /**
+   * @brief nearest-rank percentile, the (floor(ratio * size()))-th smallest value
+   * @param ratio in [0, 1], 0.5 gives the same value as getMedian()
+   * @throws std::out_of_range if the window is empty
+   */
+  double getPercentile(const double ratio) const;
+
+  /**
+   * @brief the (size() / 2)-th smallest value, the upper median for an even number of values
+   * @throws std::out_of_range if the window is empty
+   */
+  double getMedian() const;
+
+  /**
+   * @brief mean of the values, 0 if the window is empty and NaN while it holds a non-finite value
+   */
+  double getMean() const;
+
+  /**
+   * @brief population variance of the values, 0 if the window is empty and NaN while it holds a non-finite value
+   */
+  double getVariance() const;
+
+private:
+  struct Node
+  {
+    double value;
+    uint32_t priority;
+    int left;
+    int right;
+    int size;
+  };
+
+  int newNode(const double value);
+  int nodeSize(const int t) const;
+  void update(const int t);
+  // split t into values < value (or <= value if inclusive) and the rest
+  void split(const int t, const double value, const bool inclusive, int* lower, int* upper);
+  int merge(const int lower, const int upper);
+
+  std::deque<double> values_;  // in insertion order
+  std::vector<Node> nodes_;
+  std::vector<int> free_nodes_;
+  int root_;
+  uint32_t random_state_;
+
+  // Welford's running mean and sum of squared deviations of the finite values
+  size_t num_non_finite_;
+  double mean_;
+  double m2_;
+};
+}  // namespace amathutils
+
+#endif  // AMATHUTILS_LIB_SLIDING_WINDOW_STATISTICS_HPP
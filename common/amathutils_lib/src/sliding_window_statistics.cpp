@@ -0,0 +1,252 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "amathutils_lib/sliding_window_statistics.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace amathutils
+{
+namespace
+{
+// total order of the values, NaN is greater than any other value and equal to itself
+bool isLess(const double lhs, const double rhs)
+{
+  return std::isnan(rhs) ? !std::isnan(lhs) : lhs < rhs;
+}
+}  // namespace
+
+SlidingWindowStatistics::SlidingWindowStatistics()
+  : root_(-1), random_state_(2463534242u), num_non_finite_(0), mean_(0.0), m2_(0.0)
+{
+}
+
+void SlidingWindowStatistics::push(const double value)
+{
+  values_.push_back(value);
+
+  int lower, upper;
+  split(root_, value, false, &lower, &upper);
+  root_ = merge(merge(lower, newNode(value)), upper);
+
+  if (!std::isfinite(value))
+  {
+    ++num_non_finite_;
+    return;
+  }
+  const double delta = value - mean_;
+  mean_ += delta / (values_.size() - num_non_finite_);
+  m2_ += delta * (value - mean_);
+}
+
+void SlidingWindowStatistics::pop()
+{
+  if (values_.empty())
+  {
+    return;
+  }
+
+  const double value = values_.front();
+  values_.pop_front();
+
+  // remove one node of the value, any of equal values will do
+  int lower, equal, upper;
+  split(root_, value, false, &lower, &upper);
+  split(upper, value, true, &equal, &upper);
+  free_nodes_.push_back(equal);
+  equal = merge(nodes_[equal].left, nodes_[equal].right);
+  root_ = merge(merge(lower, equal), upper);
+
+  if (!std::isfinite(value))
+  {
+    --num_non_finite_;
+    return;
+  }
+  const size_t num_finite = values_.size() - num_non_finite_;
+  if (num_finite == 0)
+  {
+    mean_ = 0.0;
+    m2_ = 0.0;
+    return;
+  }
+  const double delta = value - mean_;
+  mean_ -= delta / num_finite;
+  m2_ = std::max(0.0, m2_ - delta * (value - mean_));
+}
+
+void SlidingWindowStatistics::clear()
+{
+  values_.clear();
+  nodes_.clear();
+  free_nodes_.clear();
+  root_ = -1;
+  num_non_finite_ = 0;
+  mean_ = 0.0;
+  m2_ = 0.0;
+}
+
+double SlidingWindowStatistics::front() const
+{
+  return values_.front();
+}
+
+size_t SlidingWindowStatistics::size() const
+{
+  return values_.size();
+}
+
+bool SlidingWindowStatistics::empty() const
+{
+  return values_.empty();
+}
+
+double SlidingWindowStatistics::getKthSmallest(const size_t k) const
+{
+  if (k >= values_.size())
+  {
+    throw std::out_of_range("SlidingWindowStatistics::getKthSmallest: k is out of the window");
+  }
+
+  int t = root_;
+  int rank = static_cast<int>(k);
+  while (true)
+  {
+    const int left_size = nodeSize(nodes_[t].left);
+    if (rank < left_size)
+    {
+      t = nodes_[t].left;
+    }
+    else if (rank == left_size)
+    {
+      return nodes_[t].value;
+    }
+    else
+    {
+      rank -= left_size + 1;
+      t = nodes_[t].right;
+    }
+  }
+}
+
+double SlidingWindowStatistics::getPercentile(const double ratio) const
+{
+  const double clamped = std::min(1.0, std::max(0.0, ratio));
+  const size_t k = std::min(values_.size() - 1, static_cast<size_t>(std::floor(clamped * values_.size())));
+  return getKthSmallest(values_.empty() ? 0 : k);
+}
+
+double SlidingWindowStatistics::getMedian() const
+{
+  return getKthSmallest(values_.size() / 2);
+}
+
+double SlidingWindowStatistics::getMean() const
+{
+  return num_non_finite_ > 0 ? std::numeric_limits<double>::quiet_NaN() : mean_;
+}
+
+double SlidingWindowStatistics::getVariance() const
+{
+  if (num_non_finite_ > 0)
+  {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  return values_.empty() ? 0.0 : m2_ / values_.size();
+}
+
+int SlidingWindowStatistics::newNode(const double value)
+{
+  // xorshift32
+  random_state_ ^= random_state_ << 13;
+  random_state_ ^= random_state_ >> 17;
+  random_state_ ^= random_state_ << 5;
+
+  Node node;
+  node.value = value;
+  node.priority = random_state_;
+  node.left = -1;
+  node.right = -1;
+  node.size = 1;
+
+  if (free_nodes_.empty())
+  {
+    nodes_.push_back(node);
+    return static_cast<int>(nodes_.size()) - 1;
+  }
+  const int t = free_nodes_.back();
+  free_nodes_.pop_back();
+  nodes_[t] = node;
+  return t;
+}
+
+int SlidingWindowStatistics::nodeSize(const int t) const
+{
+  return t < 0 ? 0 : nodes_[t].size;
+}
+
+void SlidingWindowStatistics::update(const int t)
+{
+  nodes_[t].size = 1 + nodeSize(nodes_[t].left) + nodeSize(nodes_[t].right);
+}
+
+void SlidingWindowStatistics::split(const int t, const double value, const bool inclusive, int* lower, int* upper)
+{
+  if (t < 0)
+  {
+    *lower = -1;
+    *upper = -1;
+    return;
+  }
+
+  const bool goes_lower = inclusive ? !isLess(value, nodes_[t].value) : isLess(nodes_[t].value, value);
+  if (goes_lower)
+  {
+    split(nodes_[t].right, value, inclusive, &nodes_[t].right, upper);
+    *lower = t;
+  }
+  else
+  {
+    split(nodes_[t].left, value, inclusive, lower, &nodes_[t].left);
+    *upper = t;
+  }
+  update(t);
+}
+
+int SlidingWindowStatistics::merge(const int lower, const int upper)
+{
+  if (lower < 0)
+  {
+    return upper;
+  }
+  if (upper < 0)
+  {
+    return lower;
+  }
+
+  if (nodes_[lower].priority > nodes_[upper].priority)
+  {
+    nodes_[lower].right = merge(nodes_[lower].right, upper);
+    update(lower);
+    return lower;
+  }
+  nodes_[upper].left = merge(lower, nodes_[upper].left);
+  update(upper);
+  return upper;
+}
+}  // namespace amathutils
@@ -0,0 +1,232 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include "amathutils_lib/sliding_window_statistics.hpp"
+
+namespace
+{
+// the previous median of vel_pose_diff_checker, copy the window and select the middle element
+double copyNthElementMedian(const std::deque<double>& window)
+{
+  std::deque<double> tmp = window;
+  const size_t median_index = tmp.size() / 2;
+  std::nth_element(std::begin(tmp), std::begin(tmp) + median_index, std::end(tmp));
+  return tmp.at(median_index);
+}
+}  // namespace
+
+TEST(TestSlidingWindowStatistics, orderStatistics)
+{
+  amathutils::SlidingWindowStatistics stats;
+  ASSERT_TRUE(stats.empty());
+  ASSERT_THROW(stats.getMedian(), std::out_of_range);
+  ASSERT_DOUBLE_EQ(stats.getMean(), 0.0);
+  ASSERT_DOUBLE_EQ(stats.getVariance(), 0.0);
+
+  for (const double v : { 5.0, 1.0, 4.0, 1.0, 3.0 })
+  {
+    stats.push(v);
+  }
+  ASSERT_EQ(stats.size(), 5u);
+  ASSERT_DOUBLE_EQ(stats.front(), 5.0);
+  ASSERT_DOUBLE_EQ(stats.getKthSmallest(0), 1.0);
+  ASSERT_DOUBLE_EQ(stats.getKthSmallest(1), 1.0);
+  ASSERT_DOUBLE_EQ(stats.getKthSmallest(4), 5.0);
+  ASSERT_THROW(stats.getKthSmallest(5), std::out_of_range);
+  ASSERT_DOUBLE_EQ(stats.getMedian(), 3.0);
+  ASSERT_DOUBLE_EQ(stats.getPercentile(0.0), 1.0);
+  ASSERT_DOUBLE_EQ(stats.getPercentile(0.5), 3.0);
+  ASSERT_DOUBLE_EQ(stats.getPercentile(1.0), 5.0);
+  ASSERT_DOUBLE_EQ(stats.getMean(), 2.8);
+  ASSERT_NEAR(stats.getVariance(), 2.56, 1e-12);
+
+  // remove 5 and 1 in insertion order, the upper median of an even window
+  stats.pop();
+  stats.pop();
+  ASSERT_EQ(stats.size(), 3u);
+  ASSERT_DOUBLE_EQ(stats.front(), 4.0);
+  ASSERT_DOUBLE_EQ(stats.getMedian(), 3.0);
+  stats.push(10.0);
+  ASSERT_DOUBLE_EQ(stats.getMedian(), 4.0);
+
+  stats.clear();
+  ASSERT_TRUE(stats.empty());
+  stats.pop();
+  ASSERT_TRUE(stats.empty());
+}
+
+TEST(TestSlidingWindowStatistics, matchesBruteForce)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> value(-10.0, 10.0);
+  std::uniform_int_distribution<int> rounded(0, 20);
+  std::uniform_int_distribution<int> pops(0, 3);
+
+  for (const bool with_duplicates : { false, true })
+  {
+    amathutils::SlidingWindowStatistics stats;
+    std::deque<double> window;
+    for (int i = 0; i < 5000; ++i)
+    {
+      const double v = with_duplicates ? rounded(gen) * 0.5 : value(gen);
+      stats.push(v);
+      window.push_back(v);
+      for (int n = pops(gen) - 1; n > 0 && window.size() > 1; --n)
+      {
+        stats.pop();
+        window.pop_front();
+      }
+
+      ASSERT_EQ(stats.size(), window.size());
+      ASSERT_EQ(stats.getMedian(), copyNthElementMedian(window));
+
+      std::vector<double> sorted(window.begin(), window.end());
+      std::sort(sorted.begin(), sorted.end());
+      for (const double ratio : { 0.0, 0.1, 0.25, 0.9, 1.0 })
+      {
+        const size_t k = std::min(sorted.size() - 1, static_cast<size_t>(std::floor(ratio * sorted.size())));
+        ASSERT_EQ(stats.getPercentile(ratio), sorted.at(k));
+      }
+
+      double mean = 0.0;
+      for (const double w : window)
+      {
+        mean += w;
+      }
+      mean /= window.size();
+      double variance = 0.0;
+      for (const double w : window)
+      {
+        variance += (w - mean) * (w - mean);
+      }
+      variance /= window.size();
+      ASSERT_NEAR(stats.getMean(), mean, 1e-9);
+      ASSERT_NEAR(stats.getVariance(), variance, 1e-8);
+    }
+  }
+}
+
+TEST(TestSlidingWindowStatistics, nonFiniteValues)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  const double inf = std::numeric_limits<double>::infinity();
+
+  amathutils::SlidingWindowStatistics stats;
+  for (const double v : { 2.0, nan, 1.0, inf, nan, 3.0, -inf })
+  {
+    stats.push(v);
+  }
+  ASSERT_EQ(stats.size(), 7u);
+  ASSERT_DOUBLE_EQ(stats.getKthSmallest(0), -inf);
+  ASSERT_DOUBLE_EQ(stats.getMedian(), 3.0);
+  ASSERT_DOUBLE_EQ(stats.getKthSmallest(4), inf);
+  ASSERT_TRUE(std::isnan(stats.getKthSmallest(5)));
+  ASSERT_TRUE(std::isnan(stats.getKthSmallest(6)));
+  ASSERT_TRUE(std::isnan(stats.getMean()));
+  ASSERT_TRUE(std::isnan(stats.getVariance()));
+
+  // every value is removed again, the statistics recover once the non-finite values left the window
+  for (size_t n = 6; n >= 2; --n)
+  {
+    stats.pop();
+    ASSERT_EQ(stats.size(), n);
+  }
+  ASSERT_DOUBLE_EQ(stats.getMedian(), 3.0);
+  ASSERT_TRUE(std::isnan(stats.getMean()));
+  stats.pop();
+  ASSERT_DOUBLE_EQ(stats.getMedian(), -inf);
+  stats.pop();
+  stats.push(4.0);
+  stats.push(nan);
+  stats.pop();
+  stats.push(6.0);
+  stats.pop();
+  ASSERT_EQ(stats.size(), 1u);
+  ASSERT_DOUBLE_EQ(stats.getMedian(), 6.0);
+  ASSERT_DOUBLE_EQ(stats.getMean(), 6.0);
+  ASSERT_DOUBLE_EQ(stats.getVariance(), 0.0);
+}
+
+TEST(TestSlidingWindowStatistics, benchmark)
+{
+  std::mt19937 gen(1);
+  std::normal_distribution<double> value(0.0, 1.0);
+  const int update_num = 20000;
+
+  for (const size_t window_size : { 10u, 100u, 1000u, 10000u })
+  {
+    std::vector<double> values(update_num + window_size);
+    for (double& v : values)
+    {
+      v = value(gen);
+    }
+
+    // slide a full window, one median query per update
+    amathutils::SlidingWindowStatistics stats;
+    std::deque<double> window;
+    for (size_t i = 0; i < window_size; ++i)
+    {
+      stats.push(values[i]);
+      window.push_back(values[i]);
+    }
+
+    double checksum_stats = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < update_num; ++i)
+    {
+      stats.push(values[window_size + i]);
+      stats.pop();
+      checksum_stats += stats.getMedian();
+    }
+    const double stats_usec =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / update_num;
+
+    double checksum_copy = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < update_num; ++i)
+    {
+      window.push_back(values[window_size + i]);
+      window.pop_front();
+      checksum_copy += copyNthElementMedian(window);
+    }
+    const double copy_usec =
+        std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / update_num;
+
+    std::printf("[ window %5zu ] copy and nth_element: %9.3f us/update, sliding window statistics: %7.3f us/update\n",
+                window_size, copy_usec, stats_usec);
+    ASSERT_EQ(checksum_stats, checksum_copy);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -15,6 +15,7 @@ private:
 
   double m_PLato;  //plane lat
   double m_PLo;  //plane lon
+  double m_PSo;  //meridian arc length of the plane origin
 
 public:
   geo_pos_conv();
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef GNSS_NMEA_SENTENCE_HPP
+#define GNSS_NMEA_SENTENCE_HPP
+
+#include <cstddef>
+#include <string>
+
+namespace gnss
+{
+// Comma separated field of an NMEA sentence, pointing into the tokenized sentence
+struct NmeaField
+{
+  const char* data = nullptr;
+  std::size_t size = 0;
+
+  bool empty() const
+  {
+    return size == 0;
+  }
+  bool operator==(const char* str) const;
+  bool operator!=(const char* str) const
+  {
+    return !(*this == str);
+  }
+  bool startsWith(const char* prefix) const;
+  std::string str() const
+  {
+    return std::string(data, size);
+  }
+};
+
+// Tokenizer of a single NMEA sentence ("$GPGGA,...*hh") without copies or allocations.
+// The fields point into the tokenized string, which must outlive the tokenizer or the next call of tokenize().
+// The checksum suffix is not part of the last field.
+class NmeaSentence
+{
+public:
+  static constexpr std::size_t MAX_FIELDS = 64;
+
+  // Split the sentence at ',' up to the checksum delimiter '*'.
+  // Returns false if the sentence has more than MAX_FIELDS fields, the fields are then left empty.
+  bool tokenize(const std::string& sentence);
+  bool tokenize(const char* sentence);
+  bool tokenize(const char* sentence, std::size_t length);
+  // the fields would point into a destroyed string
+  bool tokenize(std::string&& sentence) = delete;
+
+  std::size_t size() const
+  {
+    return size_;
+  }
+
+  // Throws std::out_of_range if the sentence has no field i, like std::vector::at
+  const NmeaField& field(std::size_t i) const;
+
+  // True if the sentence ends with "*hh"
+  bool hasChecksum() const
+  {
+    return has_checksum_;
+  }
+  // True if the transmitted checksum is the XOR of the characters between the leading '$' and '*'
+  bool isChecksumValid() const
+  {
+    return has_checksum_ && transmitted_checksum_ == calculated_checksum_;
+  }
+
+  // Numerical value of field i, with the semantics of std::stod and std::stoi:
+  // leading white space and trailing characters are ignored, and std::invalid_argument is thrown
+  // if the field does not start with a number
+  double toDouble(std::size_t i) const;
+  int toInt(std::size_t i) const;
+
+private:
+  NmeaField fields_[MAX_FIELDS];
+  std::size_t size_ = 0;
+  bool has_checksum_ = false;
+  unsigned char transmitted_checksum_ = 0;
+  unsigned char calculated_checksum_ = 0;
+};
+
+}  // namespace gnss
+
+#endif  // GNSS_NMEA_SENTENCE_HPP
@@ -16,6 +16,84 @@
 
 #include <gnss/geo_pos_conv.hpp>
 
+namespace
+{
+// Series coefficients of the meridian arc length of the WGS84 ellipsoid.
+// They only depend on constants and are computed once instead of for every conversion.
+struct MeridianArcCoefficients
+{
+  double Pe;   //
+  double Pet;  //
+  double PB1, PB2, PB3, PB4, PB5, PB6, PB7, PB8, PB9;
+
+  MeridianArcCoefficients()
+  {
+    double PA, PB, PC, PD, PE, PF, PG, PH, PI;
+    double AW, FW;
+
+    /*WGS84 Parameters*/
+    AW = 6378137.0;            // Semimajor Axis
+    FW = 1.0 / 298.257222101;  // 298.257223563 //Geometrical flattening
+
+    Pe = (double)sqrt(2.0 * FW - pow(FW, 2));
+    Pet = (double)sqrt(pow(Pe, 2) / (1.0 - pow(Pe, 2)));
+
+    PA = (double)1.0 + 3.0 / 4.0 * pow(Pe, 2) + 45.0 / 64.0 * pow(Pe, 4) + 175.0 / 256.0 * pow(Pe, 6) +
+         11025.0 / 16384.0 * pow(Pe, 8) + 43659.0 / 65536.0 * pow(Pe, 10) + 693693.0 / 1048576.0 * pow(Pe, 12) +
+         19324305.0 / 29360128.0 * pow(Pe, 14) + 4927697775.0 / 7516192768.0 * pow(Pe, 16);
+
+    PB = (double)3.0 / 4.0 * pow(Pe, 2) + 15.0 / 16.0 * pow(Pe, 4) + 525.0 / 512.0 * pow(Pe, 6) +
+         2205.0 / 2048.0 * pow(Pe, 8) + 72765.0 / 65536.0 * pow(Pe, 10) + 297297.0 / 262144.0 * pow(Pe, 12) +
+         135270135.0 / 117440512.0 * pow(Pe, 14) + 547521975.0 / 469762048.0 * pow(Pe, 16);
+
+    PC = (double)15.0 / 64.0 * pow(Pe, 4) + 105.0 / 256.0 * pow(Pe, 6) + 2205.0 / 4096.0 * pow(Pe, 8) +
+         10395.0 / 16384.0 * pow(Pe, 10) + 1486485.0 / 2097152.0 * pow(Pe, 12) + 45090045.0 / 58720256.0 * pow(Pe, 14) +
+         766530765.0 / 939524096.0 * pow(Pe, 16);
+
+    PD = (double)35.0 / 512.0 * pow(Pe, 6) + 315.0 / 2048.0 * pow(Pe, 8) + 31185.0 / 131072.0 * pow(Pe, 10) +
+         165165.0 / 524288.0 * pow(Pe, 12) + 45090045.0 / 117440512.0 * pow(Pe, 14) +
+         209053845.0 / 469762048.0 * pow(Pe, 16);
+
+    PE = (double)315.0 / 16384.0 * pow(Pe, 8) + 3465.0 / 65536.0 * pow(Pe, 10) + 99099.0 / 1048576.0 * pow(Pe, 12) +
+         4099095.0 / 29360128.0 * pow(Pe, 14) + 348423075.0 / 1879048192.0 * pow(Pe, 16);
+
+    PF = (double)693.0 / 131072.0 * pow(Pe, 10) + 9009.0 / 524288.0 * pow(Pe, 12) +
+         4099095.0 / 117440512.0 * pow(Pe, 14) + 26801775.0 / 469762048.0 * pow(Pe, 16);
+
+    PG = (double)3003.0 / 2097152.0 * pow(Pe, 12) + 315315.0 / 58720256.0 * pow(Pe, 14) +
+         11486475.0 / 939524096.0 * pow(Pe, 16);
+
+    PH = (double)45045.0 / 117440512.0 * pow(Pe, 14) + 765765.0 / 469762048.0 * pow(Pe, 16);
+
+    PI = (double)765765.0 / 7516192768.0 * pow(Pe, 16);
+
+    PB1 = (double)AW * (1.0 - pow(Pe, 2)) * PA;
+    PB2 = (double)AW * (1.0 - pow(Pe, 2)) * PB / -2.0;
+    PB3 = (double)AW * (1.0 - pow(Pe, 2)) * PC / 4.0;
+    PB4 = (double)AW * (1.0 - pow(Pe, 2)) * PD / -6.0;
+    PB5 = (double)AW * (1.0 - pow(Pe, 2)) * PE / 8.0;
+    PB6 = (double)AW * (1.0 - pow(Pe, 2)) * PF / -10.0;
+    PB7 = (double)AW * (1.0 - pow(Pe, 2)) * PG / 12.0;
+    PB8 = (double)AW * (1.0 - pow(Pe, 2)) * PH / -14.0;
+    PB9 = (double)AW * (1.0 - pow(Pe, 2)) * PI / 16.0;
+  }
+};
+
+const MeridianArcCoefficients& meridianArcCoefficients()
+{
+  static const MeridianArcCoefficients coefficients;
+  return coefficients;
+}
+
+double meridianArcLength(double lat)
+{
+  const MeridianArcCoefficients& c = meridianArcCoefficients();
+  return (double)c.PB1 * lat + c.PB2 * sin(2.0 * lat) + c.PB3 * sin(4.0 * lat) + c.PB4 * sin(6.0 * lat) +
+         c.PB5 * sin(8.0 * lat) + c.PB6 * sin(10.0 * lat) + c.PB7 * sin(12.0 * lat) + c.PB8 * sin(14.0 * lat) +
+         c.PB9 * sin(16.0 * lat);
+}
+}  // namespace
+
 geo_pos_conv::geo_pos_conv()
     : m_x(0)
     , m_y(0)
@@ -25,6 +103,7 @@ geo_pos_conv::geo_pos_conv()
     , m_h(0)
     , m_PLato(0)
     , m_PLo(0)
+    , m_PSo(0)
 {
 }
 
@@ -47,6 +126,7 @@ void geo_pos_conv::set_plane(double lat, double lon)
 {
   m_PLato = lat;
   m_PLo = lon;
+  m_PSo = meridianArcLength(m_PLato);
 }
 
 void geo_pos_conv::set_plane(int num)
@@ -189,6 +269,7 @@ void geo_pos_conv::set_plane(int num)
   // swap longitude and latitude
   m_PLo = M_PI * ((double)lat_deg + (double)lat_min / 60.0) / 180.0;
   m_PLato = M_PI * ((double)lon_deg + (double)lon_min / 60.0) / 180;
+  m_PSo = meridianArcLength(m_PLato);
 }
 
 void geo_pos_conv::set_xyz(double cx, double cy, double cz)
@@ -244,74 +325,22 @@ void geo_pos_conv::llh_to_xyz(double lat, double lon, double ele)
 void geo_pos_conv::conv_llh2xyz(void)
 {
   double PS;   //
-  double PSo;  //
   double PDL;  //
   double Pt;   //
   double PN;   //
   double PW;   //
 
-  double PB1, PB2, PB3, PB4, PB5, PB6, PB7, PB8, PB9;
-  double PA, PB, PC, PD, PE, PF, PG, PH, PI;
-  double Pe;   //
-  double Pet;  //
   double Pnn;  //
-  double AW, FW, Pmo;
-
-  Pmo = 0.9999;
-
-  /*WGS84 Parameters*/
-  AW = 6378137.0;            // Semimajor Axis
-  FW = 1.0 / 298.257222101;  // 298.257223563 //Geometrical flattening
+  double AW, Pmo;
 
-  Pe = (double)sqrt(2.0 * FW - pow(FW, 2));
-  Pet = (double)sqrt(pow(Pe, 2) / (1.0 - pow(Pe, 2)));
+  const MeridianArcCoefficients& c = meridianArcCoefficients();
+  const double Pe = c.Pe;
+  const double Pet = c.Pet;
 
-  PA = (double)1.0 + 3.0 / 4.0 * pow(Pe, 2) + 45.0 / 64.0 * pow(Pe, 4) + 175.0 / 256.0 * pow(Pe, 6) +
-       11025.0 / 16384.0 * pow(Pe, 8) + 43659.0 / 65536.0 * pow(Pe, 10) + 693693.0 / 1048576.0 * pow(Pe, 12) +
-       19324305.0 / 29360128.0 * pow(Pe, 14) + 4927697775.0 / 7516192768.0 * pow(Pe, 16);
-
-  PB = (double)3.0 / 4.0 * pow(Pe, 2) + 15.0 / 16.0 * pow(Pe, 4) + 525.0 / 512.0 * pow(Pe, 6) +
-       2205.0 / 2048.0 * pow(Pe, 8) + 72765.0 / 65536.0 * pow(Pe, 10) + 297297.0 / 262144.0 * pow(Pe, 12) +
-       135270135.0 / 117440512.0 * pow(Pe, 14) + 547521975.0 / 469762048.0 * pow(Pe, 16);
-
-  PC = (double)15.0 / 64.0 * pow(Pe, 4) + 105.0 / 256.0 * pow(Pe, 6) + 2205.0 / 4096.0 * pow(Pe, 8) +
-       10395.0 / 16384.0 * pow(Pe, 10) + 1486485.0 / 2097152.0 * pow(Pe, 12) + 45090045.0 / 58720256.0 * pow(Pe, 14) +
-       766530765.0 / 939524096.0 * pow(Pe, 16);
-
-  PD = (double)35.0 / 512.0 * pow(Pe, 6) + 315.0 / 2048.0 * pow(Pe, 8) + 31185.0 / 131072.0 * pow(Pe, 10) +
-       165165.0 / 524288.0 * pow(Pe, 12) + 45090045.0 / 117440512.0 * pow(Pe, 14) +
-       209053845.0 / 469762048.0 * pow(Pe, 16);
-
-  PE = (double)315.0 / 16384.0 * pow(Pe, 8) + 3465.0 / 65536.0 * pow(Pe, 10) + 99099.0 / 1048576.0 * pow(Pe, 12) +
-       4099095.0 / 29360128.0 * pow(Pe, 14) + 348423075.0 / 1879048192.0 * pow(Pe, 16);
-
-  PF = (double)693.0 / 131072.0 * pow(Pe, 10) + 9009.0 / 524288.0 * pow(Pe, 12) +
-       4099095.0 / 117440512.0 * pow(Pe, 14) + 26801775.0 / 469762048.0 * pow(Pe, 16);
-
-  PG = (double)3003.0 / 2097152.0 * pow(Pe, 12) + 315315.0 / 58720256.0 * pow(Pe, 14) +
-       11486475.0 / 939524096.0 * pow(Pe, 16);
-
-  PH = (double)45045.0 / 117440512.0 * pow(Pe, 14) + 765765.0 / 469762048.0 * pow(Pe, 16);
-
-  PI = (double)765765.0 / 7516192768.0 * pow(Pe, 16);
-
-  PB1 = (double)AW * (1.0 - pow(Pe, 2)) * PA;
-  PB2 = (double)AW * (1.0 - pow(Pe, 2)) * PB / -2.0;
-  PB3 = (double)AW * (1.0 - pow(Pe, 2)) * PC / 4.0;
-  PB4 = (double)AW * (1.0 - pow(Pe, 2)) * PD / -6.0;
-  PB5 = (double)AW * (1.0 - pow(Pe, 2)) * PE / 8.0;
-  PB6 = (double)AW * (1.0 - pow(Pe, 2)) * PF / -10.0;
-  PB7 = (double)AW * (1.0 - pow(Pe, 2)) * PG / 12.0;
-  PB8 = (double)AW * (1.0 - pow(Pe, 2)) * PH / -14.0;
-  PB9 = (double)AW * (1.0 - pow(Pe, 2)) * PI / 16.0;
-
-  PS = (double)PB1 * m_lat + PB2 * sin(2.0 * m_lat) + PB3 * sin(4.0 * m_lat) + PB4 * sin(6.0 * m_lat) +
-       PB5 * sin(8.0 * m_lat) + PB6 * sin(10.0 * m_lat) + PB7 * sin(12.0 * m_lat) + PB8 * sin(14.0 * m_lat) +
-       PB9 * sin(16.0 * m_lat);
+  Pmo = 0.9999;
+  AW = 6378137.0;  // Semimajor Axis
 
-  PSo = (double)PB1 * m_PLato + PB2 * sin(2.0 * m_PLato) + PB3 * sin(4.0 * m_PLato) + PB4 * sin(6.0 * m_PLato) +
-        PB5 * sin(8.0 * m_PLato) + PB6 * sin(10.0 * m_PLato) + PB7 * sin(12.0 * m_PLato) + PB8 * sin(14.0 * m_PLato) +
-        PB9 * sin(16.0 * m_PLato);
+  PS = meridianArcLength(m_lat);
 
   PDL = (double)m_lon - m_PLo;
   Pt = (double)tan(m_lat);
@@ -319,7 +348,7 @@ void geo_pos_conv::conv_llh2xyz(void)
   PN = (double)AW / PW;
   Pnn = (double)sqrt(pow(Pet, 2) * pow(cos(m_lat), 2));
 
-  m_x = (double)((PS - PSo) + (1.0 / 2.0) * PN * pow(cos(m_lat), 2.0) * Pt * pow(PDL, 2.0) +
+  m_x = (double)((PS - m_PSo) + (1.0 / 2.0) * PN * pow(cos(m_lat), 2.0) * Pt * pow(PDL, 2.0) +
                  (1.0 / 24.0) * PN * pow(cos(m_lat), 4) * Pt *
                      (5.0 - pow(Pt, 2) + 9.0 * pow(Pnn, 2) + 4.0 * pow(Pnn, 4)) * pow(PDL, 4) -
                  (1.0 / 720.0) * PN * pow(cos(m_lat), 6) * Pt *
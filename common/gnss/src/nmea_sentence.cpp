@@ -0,0 +1,170 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gnss/nmea_sentence.hpp>
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+namespace gnss
+{
+namespace
+{
+// Longest field converted to a number, longer fields are truncated
+constexpr std::size_t NUMBER_BUFFER_SIZE = 64;
+
+int hexValue(char c)
+{
+  if (c >= '0' && c <= '9')
+    return c - '0';
+  if (c >= 'A' && c <= 'F')
+    return c - 'A' + 10;
+  if (c >= 'a' && c <= 'f')
+    return c - 'a' + 10;
+  return -1;
+}
+
+// Copy a field into a null terminated buffer for strtod/strtol
+void copyField(const NmeaField& field, char (&buffer)[NUMBER_BUFFER_SIZE])
+{
+  std::size_t size = field.size < NUMBER_BUFFER_SIZE ? field.size : NUMBER_BUFFER_SIZE - 1;
+  std::memcpy(buffer, field.data, size);
+  buffer[size] = '\0';
+}
+}  // namespace
+
+constexpr std::size_t NmeaSentence::MAX_FIELDS;
+
+bool NmeaField::operator==(const char* str) const
+{
+  std::size_t length = std::strlen(str);
+  return length == size && std::memcmp(data, str, size) == 0;
+}
+
+bool NmeaField::startsWith(const char* prefix) const
+{
+  std::size_t length = std::strlen(prefix);
+  return length <= size && std::memcmp(data, prefix, length) == 0;
+}
+
+bool NmeaSentence::tokenize(const std::string& sentence)
+{
+  return tokenize(sentence.data(), sentence.size());
+}
+
+bool NmeaSentence::tokenize(const char* sentence)
+{
+  return tokenize(sentence, std::strlen(sentence));
+}
+
+bool NmeaSentence::tokenize(const char* sentence, std::size_t length)
+{
+  size_ = 0;
+  has_checksum_ = false;
+  transmitted_checksum_ = 0;
+  calculated_checksum_ = 0;
+
+  if (length == 0)
+    return true;
+
+  const char* end = sentence + length;
+  const char* p = sentence;
+
+  // the start delimiter is not part of the checksum
+  std::size_t checksum_begin = (*p == '$' || *p == '!') ? 1 : 0;
+  unsigned char checksum = 0;
+  for (const char* c = p + checksum_begin; c != end && *c != '*'; ++c)
+    checksum ^= static_cast<unsigned char>(*c);
+  calculated_checksum_ = checksum;
+
+  const char* field_begin = p;
+  for (; p != end && *p != '*'; ++p)
+  {
+    if (*p != ',')
+      continue;
+    if (size_ == MAX_FIELDS)
+    {
+      size_ = 0;
+      return false;
+    }
+    fields_[size_].data = field_begin;
+    fields_[size_].size = p - field_begin;
+    ++size_;
+    field_begin = p + 1;
+  }
+  if (size_ == MAX_FIELDS)
+  {
+    size_ = 0;
+    return false;
+  }
+  fields_[size_].data = field_begin;
+  fields_[size_].size = p - field_begin;
+  ++size_;
+
+  if (p != end && end - p >= 3)
+  {
+    int high = hexValue(p[1]);
+    int low = hexValue(p[2]);
+    if (high >= 0 && low >= 0)
+    {
+      has_checksum_ = true;
+      transmitted_checksum_ = static_cast<unsigned char>(high << 4 | low);
+    }
+  }
+  return true;
+}
+
+const NmeaField& NmeaSentence::field(std::size_t i) const
+{
+  if (i >= size_)
+    throw std::out_of_range("NMEA sentence has no field " + std::to_string(i));
+  return fields_[i];
+}
+
+double NmeaSentence::toDouble(std::size_t i) const
+{
+  char buffer[NUMBER_BUFFER_SIZE];
+  copyField(field(i), buffer);
+
+  char* number_end;
+  errno = 0;
+  double value = std::strtod(buffer, &number_end);
+  if (number_end == buffer)
+    throw std::invalid_argument("NMEA field " + std::to_string(i) + " is not a number");
+  if (errno == ERANGE)
+    throw std::out_of_range("NMEA field " + std::to_string(i) + " is out of range");
+  return value;
+}
+
+int NmeaSentence::toInt(std::size_t i) const
+{
+  char buffer[NUMBER_BUFFER_SIZE];
+  copyField(field(i), buffer);
+
+  char* number_end;
+  errno = 0;
+  long value = std::strtol(buffer, &number_end, 10);
+  if (number_end == buffer)
+    throw std::invalid_argument("NMEA field " + std::to_string(i) + " is not a number");
+  if (errno == ERANGE || value < std::numeric_limits<int>::min() || value > std::numeric_limits<int>::max())
+    throw std::out_of_range("NMEA field " + std::to_string(i) + " is out of range");
+  return static_cast<int>(value);
+}
+
+}  // namespace gnss
@@ -0,0 +1,221 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "gnss/geo_pos_conv.hpp"
+#include "gnss/nmea_sentence.hpp"
+
+namespace
+{
+// Splitting through a stringstream, as done by the NMEA nodes before the shared tokenizer
+std::vector<std::string> split(const std::string& string)
+{
+  std::vector<std::string> str_vec_ptr;
+  std::string token;
+  std::stringstream ss(string);
+
+  while (getline(ss, token, ','))
+    str_vec_ptr.push_back(token);
+
+  return str_vec_ptr;
+}
+
+std::string addChecksum(const std::string& body)
+{
+  unsigned char checksum = 0;
+  for (size_t i = 1; i < body.size(); ++i)
+    checksum ^= static_cast<unsigned char>(body[i]);
+  char suffix[8];
+  std::snprintf(suffix, sizeof(suffix), "*%02X", checksum);
+  return body + suffix;
+}
+
+// Synthetic receiver log with GGA, RMC, PASHR and QQ sentences along a trajectory
+std::vector<std::string> createLog(size_t size)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> noise(-0.0001, 0.0001);
+  std::vector<std::string> log;
+  log.reserve(size);
+  char buffer[256];
+  for (size_t i = 0; log.size() < size; ++i)
+  {
+    double time = 123519.0 + 0.05 * i;
+    double lat = 3514.0 + 0.0005 * i + noise(gen);
+    double lon = 13700.0 + 0.0007 * i + noise(gen);
+    std::snprintf(buffer, sizeof(buffer), "$GPGGA,%.2f,%.5f,N,%.5f,E,1,08,0.9,%.3f,M,46.9,M,,", time, lat, lon,
+                  45.0 + noise(gen) * 1000);
+    log.push_back(addChecksum(buffer));
+    std::snprintf(buffer, sizeof(buffer), "$GPRMC,%.2f,A,%.5f,N,%.5f,E,022.4,084.4,230394,003.1,W", time, lat, lon);
+    log.push_back(addChecksum(buffer));
+    std::snprintf(buffer, sizeof(buffer), "$PASHR,%.2f,%.2f,T,%.2f,%.2f,0.00,0.101,0.113,0.267,1,0", time,
+                  90.0 + noise(gen) * 1000, noise(gen) * 1000, noise(gen) * 1000);
+    log.push_back(addChecksum(buffer));
+    std::snprintf(buffer, sizeof(buffer), "QQ02C,INSDAT,%.2f,%.3f,%.3f,%.3f,%.3f,0.000,0.000,0.000", time, time,
+                  noise(gen) * 1000, noise(gen) * 1000, 90.0 + noise(gen) * 1000);
+    log.push_back(buffer);
+  }
+  log.resize(size);
+  return log;
+}
+}  // namespace
+
+TEST(TestNmeaSentence, sameFieldsAsStringSplit)
+{
+  gnss::NmeaSentence nmea;
+  for (const std::string& sentence : createLog(400))
+  {
+    ASSERT_TRUE(nmea.tokenize(sentence));
+    std::vector<std::string> expected = split(sentence.substr(0, sentence.find('*')));
+    ASSERT_GE(nmea.size(), expected.size());
+    for (size_t i = 0; i < expected.size(); ++i)
+      ASSERT_EQ(expected[i], nmea.field(i).str()) << sentence;
+    // getline drops the trailing empty fields
+    for (size_t i = expected.size(); i < nmea.size(); ++i)
+      ASSERT_TRUE(nmea.field(i).empty()) << sentence;
+  }
+}
+
+TEST(TestNmeaSentence, checksum)
+{
+  gnss::NmeaSentence nmea;
+
+  ASSERT_TRUE(nmea.tokenize("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"));
+  EXPECT_TRUE(nmea.hasChecksum());
+  EXPECT_TRUE(nmea.isChecksumValid());
+  EXPECT_EQ(15u, nmea.size());
+  EXPECT_TRUE(nmea.field(14).empty());
+
+  // lower case checksum and trailing line break
+  ASSERT_TRUE(nmea.tokenize("$GPGGA,123519,4807.038,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47\r\n"));
+  EXPECT_TRUE(nmea.isChecksumValid());
+  ASSERT_TRUE(nmea.tokenize("$GPRMC,123519,A,4807.038,N,01131.000,E,022.4,084.4,230394,003.1,W*6a"));
+  EXPECT_TRUE(nmea.isChecksumValid());
+
+  ASSERT_TRUE(nmea.tokenize("$GPGGA,123519,4807.039,N,01131.000,E,1,08,0.9,545.4,M,46.9,M,,*47"));
+  EXPECT_TRUE(nmea.hasChecksum());
+  EXPECT_FALSE(nmea.isChecksumValid());
+
+  ASSERT_TRUE(nmea.tokenize("QQ02C,INSDAT,01:18:07.443,123519.00,0.1,0.2,0.3"));
+  EXPECT_FALSE(nmea.hasChecksum());
+  EXPECT_FALSE(nmea.isChecksumValid());
+  EXPECT_EQ(7u, nmea.size());
+
+  ASSERT_TRUE(nmea.tokenize("$GPGGA,1*4"));
+  EXPECT_FALSE(nmea.hasChecksum());
+}
+
+TEST(TestNmeaSentence, fieldConversion)
+{
+  gnss::NmeaSentence nmea;
+  ASSERT_TRUE(nmea.tokenize("$GPRMC,123519.50,A,-4807.038,S, 1131.5,W,,abc,1e999*00"));
+
+  EXPECT_TRUE(nmea.field(0) == "$GPRMC");
+  EXPECT_TRUE(nmea.field(0).startsWith("$GP"));
+  EXPECT_FALSE(nmea.field(0) == "$GPRMCX");
+  EXPECT_TRUE(nmea.field(4) == "S");
+  EXPECT_FALSE(nmea.field(4) == "");
+
+  EXPECT_EQ(std::stod("123519.50"), nmea.toDouble(1));
+  EXPECT_EQ(std::stoi("123519.50"), nmea.toInt(1));
+  EXPECT_EQ(std::stod("-4807.038"), nmea.toDouble(3));
+  EXPECT_EQ(std::stod(" 1131.5"), nmea.toDouble(5));
+  EXPECT_THROW(nmea.toDouble(7), std::invalid_argument);
+  EXPECT_THROW(nmea.toDouble(8), std::invalid_argument);
+  EXPECT_THROW(nmea.toDouble(9), std::out_of_range);
+  EXPECT_THROW(nmea.field(10), std::out_of_range);
+  EXPECT_THROW(nmea.toDouble(10), std::out_of_range);
+
+  ASSERT_TRUE(nmea.tokenize(""));
+  EXPECT_EQ(0u, nmea.size());
+  EXPECT_THROW(nmea.field(0), std::out_of_range);
+
+  std::string too_many_fields(gnss::NmeaSentence::MAX_FIELDS, ',');
+  EXPECT_FALSE(nmea.tokenize(too_many_fields));
+  EXPECT_EQ(0u, nmea.size());
+  too_many_fields.pop_back();
+  EXPECT_TRUE(nmea.tokenize(too_many_fields));
+  EXPECT_EQ(gnss::NmeaSentence::MAX_FIELDS, nmea.size());
+}
+
+TEST(TestNmeaSentence, replayBenchmark)
+{
+  const std::vector<std::string> log = createLog(400000);
+  geo_pos_conv geo;
+  geo.set_plane(7);
+
+  // parse the position sentences like nmea2tfpose
+  auto start = std::chrono::steady_clock::now();
+  double previous_sum = 0;
+  for (const std::string& sentence : log)
+  {
+    std::vector<std::string> nmea = split(sentence);
+    if (nmea.at(0).compare(3, 3, "GGA") == 0)
+    {
+      geo.set_llh_nmea_degrees(std::stod(nmea.at(2)), std::stod(nmea.at(4)), std::stod(nmea.at(9)));
+      previous_sum += geo.x() + geo.y() + geo.z() + std::stod(nmea.at(1));
+    }
+    else if (nmea.at(0) == "$PASHR")
+    {
+      previous_sum += std::stod(nmea.at(1)) + std::stod(nmea.at(2)) + std::stod(nmea.at(4)) + std::stod(nmea.at(5));
+    }
+  }
+  double previous_time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  gnss::NmeaSentence nmea;
+  double sum = 0;
+  size_t valid = 0;
+  for (const std::string& sentence : log)
+  {
+    nmea.tokenize(sentence);
+    if (!nmea.hasChecksum() || nmea.isChecksumValid())
+      ++valid;
+    const gnss::NmeaField& header = nmea.field(0);
+    if (header.size >= 6 && header.data[3] == 'G' && header.data[4] == 'G' && header.data[5] == 'A')
+    {
+      geo.set_llh_nmea_degrees(nmea.toDouble(2), nmea.toDouble(4), nmea.toDouble(9));
+      sum += geo.x() + geo.y() + geo.z() + nmea.toDouble(1);
+    }
+    else if (header == "$PASHR")
+    {
+      sum += nmea.toDouble(1) + nmea.toDouble(2) + nmea.toDouble(4) + nmea.toDouble(5);
+    }
+  }
+  double time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  EXPECT_EQ(previous_sum, sum);
+  EXPECT_EQ(log.size(), valid);
+  std::printf("[ %zu sentences ] split and stod: %7.1f ms (%5.0f ns/sentence), NmeaSentence: %7.1f ms (%5.0f "
+              "ns/sentence, checksum included)\n",
+              log.size(), previous_time * 1e3, previous_time * 1e9 / log.size(), time * 1e3,
+              time * 1e9 / log.size());
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -32,8 +32,10 @@
 
 #include <lanelet2_extension/regulatory_elements/autoware_traffic_light.h>
 
+#include <memory>
 #include <vector>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 
 namespace lanelet
@@ -91,28 +93,28 @@ lanelet::ConstLanelets laneletLayer(const lanelet::LaneletMapPtr ll_Map);
  * lanelet::AttributeValueString::Road)]
  * @return         [lanelets with given subtype]
  */
-lanelet::ConstLanelets subtypeLanelets(const lanelet::ConstLanelets lls, const char subtype[]);
+lanelet::ConstLanelets subtypeLanelets(const lanelet::ConstLanelets& lls, const char subtype[]);
 
 /**
  * [crosswalkLanelets extracts crosswalk lanelets]
  * @param  lls [input lanelets with various subtypes]
  * @return     [crosswalk lanelets]
  */
-lanelet::ConstLanelets crosswalkLanelets(const lanelet::ConstLanelets lls);
+lanelet::ConstLanelets crosswalkLanelets(const lanelet::ConstLanelets& lls);
 
 /**
  * [roadLanelets extracts road lanelets]
  * @param  lls [input lanelets with subtype road]
  * @return     [road lanelets]
  */
-lanelet::ConstLanelets roadLanelets(const lanelet::ConstLanelets lls);
+lanelet::ConstLanelets roadLanelets(const lanelet::ConstLanelets& lls);
 
 /**
  * [trafficLights extracts Traffic Light regulatory element from lanelets]
  * @param lanelets [input lanelets]
  * @return         [traffic light that are associated with input lanenets]
  */
-std::vector<lanelet::TrafficLightConstPtr> trafficLights(const lanelet::ConstLanelets lanelets);
+std::vector<lanelet::TrafficLightConstPtr> trafficLights(const lanelet::ConstLanelets& lanelets);
 
 /**
  * [autowareTrafficLights extracts Autoware Traffic Light regulatory element
@@ -121,14 +123,14 @@ std::vector<lanelet::TrafficLightConstPtr> trafficLights(const lanelet::ConstLan
  * @return         [autoware traffic light that are associated with input
  * lanenets]
  */
-std::vector<lanelet::AutowareTrafficLightConstPtr> autowareTrafficLights(const lanelet::ConstLanelets lanelets);
+std::vector<lanelet::AutowareTrafficLightConstPtr> autowareTrafficLights(const lanelet::ConstLanelets& lanelets);
 
 /**
  * [stopLinesLanelets extracts stoplines that are associated to lanelets]
  * @param lanelets [input lanelets]
  * @return         [stop lines that are associated with input lanelets]
  */
-std::vector<lanelet::ConstLineString3d> stopLinesLanelets(const lanelet::ConstLanelets lanelets);
+std::vector<lanelet::ConstLineString3d> stopLinesLanelets(const lanelet::ConstLanelets& lanelets);
 
 /**
  * [stopLinesLanelet extracts stop lines that are associated with a given
@@ -136,7 +138,7 @@ std::vector<lanelet::ConstLineString3d> stopLinesLanelets(const lanelet::ConstLa
  * @param ll [input lanelet]
  * @return   [stop lines that are associated with input lanelet]
  */
-std::vector<lanelet::ConstLineString3d> stopLinesLanelet(const lanelet::ConstLanelet ll);
+std::vector<lanelet::ConstLineString3d> stopLinesLanelet(const lanelet::ConstLanelet& ll);
 
 /**
  * [stopSignes extracts stoplines that are associated with stopsignes]
@@ -144,9 +146,113 @@ std::vector<lanelet::ConstLineString3d> stopLinesLanelet(const lanelet::ConstLan
  * @param stop_sign_id [sign id of stop sign]
  * @return             [array of stoplines]
  */
-std::vector<lanelet::ConstLineString3d> stopSignStopLines(const lanelet::ConstLanelets lanelets,
+std::vector<lanelet::ConstLineString3d> stopSignStopLines(const lanelet::ConstLanelets& lanelets,
                                                           const std::string& stop_sign_id = "stop_sign");
 
+/**
+ * [QueryIndex indexes the lanelets of a map once, so that the queries above
+ * don't go through the regulatory elements of every lanelet on every call.
+ * The results and their order are the same as those of the free functions.
+ * Lanelets that are not in the indexed map are queried directly. The index has
+ * to be rebuilt whenever the map changes]
+ */
+class QueryIndex
+{
+public:
+  /**
+   * [QueryIndex::QueryIndex builds the index of a map]
+   * @param ll_map [input lanelet map]
+   */
+  explicit QueryIndex(const lanelet::LaneletMapConstPtr ll_map);
+
+  /**
+   * [QueryIndex::laneletLayer returns all lanelets in the map]
+   * @return [all lanelets in the map, in the order of laneletLayer]
+   */
+  const lanelet::ConstLanelets& laneletLayer() const;
+
+  /**
+   * [QueryIndex::subtypeLanelets returns the lanelets in the map that have the
+   * given subtype attribute]
+   * @param  subtype [subtype of lanelets to be retrieved (e.g.
+   * lanelet::AttributeValueString::Road)]
+   * @return         [lanelets with given subtype, in the order of laneletLayer]
+   */
+  const lanelet::ConstLanelets& subtypeLanelets(const char subtype[]) const;
+
+  /**
+   * [QueryIndex::crosswalkLanelets returns the crosswalk lanelets in the map]
+   * @return [crosswalk lanelets]
+   */
+  const lanelet::ConstLanelets& crosswalkLanelets() const;
+
+  /**
+   * [QueryIndex::roadLanelets returns the road lanelets in the map]
+   * @return [road lanelets]
+   */
+  const lanelet::ConstLanelets& roadLanelets() const;
+
+  /**
+   * [QueryIndex::trafficLights same as query::trafficLights]
+   * @param lanelets [input lanelets]
+   * @return         [traffic light that are associated with input lanenets]
+   */
+  std::vector<lanelet::TrafficLightConstPtr> trafficLights(const lanelet::ConstLanelets& lanelets) const;
+
+  /**
+   * [QueryIndex::autowareTrafficLights same as query::autowareTrafficLights]
+   * @param lanelets [input lanelets]
+   * @return         [autoware traffic light that are associated with input
+   * lanenets]
+   */
+  std::vector<lanelet::AutowareTrafficLightConstPtr>
+  autowareTrafficLights(const lanelet::ConstLanelets& lanelets) const;
+
+  /**
+   * [QueryIndex::stopLinesLanelets same as query::stopLinesLanelets]
+   * @param lanelets [input lanelets]
+   * @return         [stop lines that are associated with input lanelets]
+   */
+  std::vector<lanelet::ConstLineString3d> stopLinesLanelets(const lanelet::ConstLanelets& lanelets) const;
+
+  /**
+   * [QueryIndex::stopLinesLanelet same as query::stopLinesLanelet]
+   * @param ll [input lanelet]
+   * @return   [stop lines that are associated with input lanelet]
+   */
+  std::vector<lanelet::ConstLineString3d> stopLinesLanelet(const lanelet::ConstLanelet& ll) const;
+
+  /**
+   * [QueryIndex::stopSignStopLines same as query::stopSignStopLines]
+   * @param lanelets     [input lanelets]
+   * @param stop_sign_id [sign id of stop sign]
+   * @return             [array of stoplines]
+   */
+  std::vector<lanelet::ConstLineString3d> stopSignStopLines(const lanelet::ConstLanelets& lanelets,
+                                                            const std::string& stop_sign_id = "stop_sign") const;
+
+private:
+  // typed regulatory elements and stop lines of one lanelet
+  struct LaneletElements
+  {
+    lanelet::ConstLanelet lanelet;
+    std::vector<lanelet::TrafficLightConstPtr> traffic_lights;
+    std::vector<lanelet::AutowareTrafficLightConstPtr> autoware_traffic_lights;
+    std::vector<std::shared_ptr<const lanelet::TrafficSign>> traffic_signs;
+    std::vector<lanelet::ConstLineString3d> stop_lines;
+  };
+
+  lanelet::ConstLanelets lanelets_;
+  std::unordered_map<std::string, lanelet::ConstLanelets> subtype_lanelets_;
+  std::unordered_map<lanelet::Id, LaneletElements> lanelet_elements_;
+  lanelet::ConstLanelets null_lanelets_;
+
+  static void collectElements(const lanelet::ConstLanelet& ll, LaneletElements* elements);
+
+  // the indexed elements if ll is the lanelet in the map, otherwise the ones collected into scratch
+  const LaneletElements& findElements(const lanelet::ConstLanelet& ll, LaneletElements* scratch) const;
+};
+
 }  // namespace query
 }  // namespace utils
 }  // namespace lanelet
@@ -37,7 +37,8 @@ namespace visualization
 {
 /**
  * [lanelet2Triangle converts lanelet into vector of triangles. Used for
- * triangulation]
+ * triangulation. The strip between the bounds is triangulated in linear
+ * time, shapes it doesn't cover fall back to ear clipping]
  * @param ll        [input lanelet]
  * @param triangles [array of polygon message, each containing 3 vertices]
  */
@@ -84,6 +85,23 @@ void trafficLight2TriangleMarker(const lanelet::ConstLineString3d ls, visualizat
  */
 visualization_msgs::MarkerArray laneletsBoundaryAsMarkerArray(const lanelet::ConstLanelets& lanelets,
                                                               const std_msgs::ColorRGBA c, const bool viz_centerline);
+/**
+ * [lanelets2TriangleMesh triangulates lanelets in parallel into one list of
+ * triangle vertices, which can be kept to create markers again]
+ * @param lanelets [input lanelets]
+ * @param mesh     [three vertices per triangle, in the order of the lanelets]
+ */
+void lanelets2TriangleMesh(const lanelet::ConstLanelets& lanelets, std::vector<geometry_msgs::Point>* mesh);
+/**
+ * [triangleMeshAsMarkerArray create marker array to visualize a triangle mesh]
+ * @param  ns   [namespace of the marker]
+ * @param  mesh [three vertices per triangle]
+ * @param  c    [color of the marker]
+ * @return      [created marker array, empty for an empty mesh]
+ */
+visualization_msgs::MarkerArray triangleMeshAsMarkerArray(const std::string ns,
+                                                          const std::vector<geometry_msgs::Point>& mesh,
+                                                          const std_msgs::ColorRGBA c);
 /**
  * [laneletsAsTriangleMarkerArray create marker array to visualize shape of the
  * lanelet]
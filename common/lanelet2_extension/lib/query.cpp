@@ -23,8 +23,9 @@
 #include <lanelet2_extension/utility/message_conversion.h>
 #include <lanelet2_extension/utility/query.h>
 
-#include <set>
+#include <memory>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 namespace lanelet
@@ -197,111 +198,97 @@ lanelet::ConstLanelets query::laneletLayer(const lanelet::LaneletMapPtr ll_map)
   return lanelets;
 }
 
-lanelet::ConstLanelets query::subtypeLanelets(const lanelet::ConstLanelets lls, const char subtype[])
+namespace
 {
-  lanelet::ConstLanelets subtype_lanelets;
+// appends the elements whose ids are not in ids yet, keeping their order
+template <class T>
+void appendUnique(const std::vector<std::shared_ptr<const T>>& elems, std::unordered_set<lanelet::Id>* ids,
+                  std::vector<std::shared_ptr<const T>>* unique_elems)
+{
+  for (const auto& elem : elems)
+  {
+    if (ids->insert(elem->id()).second)
+      unique_elems->push_back(elem);
+  }
+}
 
-  for (auto li = lls.begin(); li != lls.end(); li++)
+// stop lines of traffic signs with the given type, skipping stop lines whose ids are in ids already
+void appendStopSignStopLines(const std::vector<std::shared_ptr<const lanelet::TrafficSign>>& traffic_signs,
+                             const std::string& stop_sign_id, std::unordered_set<lanelet::Id>* ids,
+                             std::vector<lanelet::ConstLineString3d>* stoplines)
+{
+  for (const auto& ts : traffic_signs)
   {
-    lanelet::ConstLanelet ll = *li;
+    // skip if traffic sign is not stop sign
+    if (ts->type() != stop_sign_id)
+      continue;
 
-    if (ll.hasAttribute(lanelet::AttributeName::Subtype))
-    {
-      lanelet::Attribute attr = ll.attribute(lanelet::AttributeName::Subtype);
-      if (attr.value() == subtype)
-      {
-        subtype_lanelets.push_back(ll);
-      }
-    }
+    lanelet::ConstLineStrings3d traffic_sign_stoplines = ts->refLines();
+
+    // only add new items
+    if (traffic_sign_stoplines.size() > 0 && ids->insert(traffic_sign_stoplines.front().id()).second)
+      stoplines->push_back(traffic_sign_stoplines.front());
+  }
+}
+}  // namespace
+
+lanelet::ConstLanelets query::subtypeLanelets(const lanelet::ConstLanelets& lls, const char subtype[])
+{
+  lanelet::ConstLanelets subtype_lanelets;
+
+  for (const auto& ll : lls)
+  {
+    auto attr = ll.attributes().find(lanelet::AttributeName::Subtype);
+    if (attr != ll.attributes().end() && attr->second.value() == subtype)
+      subtype_lanelets.push_back(ll);
   }
 
   return subtype_lanelets;
 }
 
-lanelet::ConstLanelets query::crosswalkLanelets(const lanelet::ConstLanelets lls)
+lanelet::ConstLanelets query::crosswalkLanelets(const lanelet::ConstLanelets& lls)
 {
   return (query::subtypeLanelets(lls, lanelet::AttributeValueString::Crosswalk));
 }
 
-lanelet::ConstLanelets query::roadLanelets(const lanelet::ConstLanelets lls)
+lanelet::ConstLanelets query::roadLanelets(const lanelet::ConstLanelets& lls)
 {
   return (query::subtypeLanelets(lls, lanelet::AttributeValueString::Road));
 }
 
-std::vector<lanelet::TrafficLightConstPtr> query::trafficLights(const lanelet::ConstLanelets lanelets)
+std::vector<lanelet::TrafficLightConstPtr> query::trafficLights(const lanelet::ConstLanelets& lanelets)
 {
   std::vector<lanelet::TrafficLightConstPtr> tl_reg_elems;
+  std::unordered_set<lanelet::Id> ids;
 
-  for (auto i = lanelets.begin(); i != lanelets.end(); i++)
-  {
-    lanelet::ConstLanelet ll = *i;
-    std::vector<lanelet::TrafficLightConstPtr> ll_tl_re = ll.regulatoryElementsAs<lanelet::TrafficLight>();
+  // insert unique tl into array
+  for (const auto& ll : lanelets)
+    appendUnique(ll.regulatoryElementsAs<lanelet::TrafficLight>(), &ids, &tl_reg_elems);
 
-    // insert unique tl into array
-    for (auto tli = ll_tl_re.begin(); tli != ll_tl_re.end(); tli++)
-    {
-      lanelet::TrafficLightConstPtr tl_ptr = *tli;
-      lanelet::Id id = tl_ptr->id();
-      bool unique_id = true;
-      for (auto ii = tl_reg_elems.begin(); ii != tl_reg_elems.end(); ii++)
-      {
-        if (id == (*ii)->id())
-        {
-          unique_id = false;
-          break;
-        }
-      }
-      if (unique_id)
-      {
-        tl_reg_elems.push_back(tl_ptr);
-      }
-    }
-  }
   return tl_reg_elems;
 }
 
-std::vector<lanelet::AutowareTrafficLightConstPtr> query::autowareTrafficLights(const lanelet::ConstLanelets lanelets)
+std::vector<lanelet::AutowareTrafficLightConstPtr>
+query::autowareTrafficLights(const lanelet::ConstLanelets& lanelets)
 {
   std::vector<lanelet::AutowareTrafficLightConstPtr> tl_reg_elems;
+  std::unordered_set<lanelet::Id> ids;
 
-  for (auto i = lanelets.begin(); i != lanelets.end(); i++)
-  {
-    lanelet::ConstLanelet ll = *i;
-    std::vector<lanelet::AutowareTrafficLightConstPtr> ll_tl_re =
-        ll.regulatoryElementsAs<lanelet::autoware::AutowareTrafficLight>();
-
-    // insert unique tl into array
-    for (auto tli = ll_tl_re.begin(); tli != ll_tl_re.end(); tli++)
-    {
-      lanelet::AutowareTrafficLightConstPtr tl_ptr = *tli;
-      lanelet::Id id = tl_ptr->id();
-      bool unique_id = true;
-
-      for (auto ii = tl_reg_elems.begin(); ii != tl_reg_elems.end(); ii++)
-      {
-        if (id == (*ii)->id())
-        {
-          unique_id = false;
-          break;
-        }
-      }
+  // insert unique tl into array
+  for (const auto& ll : lanelets)
+    appendUnique(ll.regulatoryElementsAs<lanelet::autoware::AutowareTrafficLight>(), &ids, &tl_reg_elems);
 
-      if (unique_id)
-        tl_reg_elems.push_back(tl_ptr);
-    }
-  }
   return tl_reg_elems;
 }
 
 // return all stop lines and ref lines from a given set of lanelets
-std::vector<lanelet::ConstLineString3d> query::stopLinesLanelets(const lanelet::ConstLanelets lanelets)
+std::vector<lanelet::ConstLineString3d> query::stopLinesLanelets(const lanelet::ConstLanelets& lanelets)
 {
   std::vector<lanelet::ConstLineString3d> stoplines;
 
-  for (auto lli = lanelets.begin(); lli != lanelets.end(); lli++)
+  for (const auto& ll : lanelets)
   {
-    std::vector<lanelet::ConstLineString3d> ll_stoplines;
-    ll_stoplines = query::stopLinesLanelet(*lli);
+    std::vector<lanelet::ConstLineString3d> ll_stoplines = query::stopLinesLanelet(ll);
     stoplines.insert(stoplines.end(), ll_stoplines.begin(), ll_stoplines.end());
   }
 
@@ -309,101 +296,184 @@ std::vector<lanelet::ConstLineString3d> query::stopLinesLanelets(const lanelet::
 }
 
 // return all stop and ref lines from a given lanel
-std::vector<lanelet::ConstLineString3d> query::stopLinesLanelet(const lanelet::ConstLanelet ll)
+std::vector<lanelet::ConstLineString3d> query::stopLinesLanelet(const lanelet::ConstLanelet& ll)
 {
+  // stop lines of right of way, traffic light and traffic sign reg. elems., collected in one pass and returned in
+  // this order
   std::vector<lanelet::ConstLineString3d> stoplines;
+  std::vector<lanelet::ConstLineString3d> traffic_light_stoplines;
+  std::vector<lanelet::ConstLineString3d> traffic_sign_stoplines;
 
-  // find stop lines referened by right ofway reg. elems.
-  std::vector<std::shared_ptr<const lanelet::RightOfWay> > right_of_way_reg_elems =
-      ll.regulatoryElementsAs<const lanelet::RightOfWay>();
-
-  if (right_of_way_reg_elems.size() > 0)
+  for (const auto& reg_elem : ll.regulatoryElements())
   {
-    // lanelet has a right of way elem elemetn
-    for (auto j = right_of_way_reg_elems.begin(); j < right_of_way_reg_elems.end(); j++)
+    // find stop lines referened by right of way reg. elems. that the lanelet yields to
+    auto right_of_way = std::dynamic_pointer_cast<const lanelet::RightOfWay>(reg_elem);
+    if (right_of_way && right_of_way->getManeuver(ll) == lanelet::ManeuverType::Yield)
     {
-      if ((*j)->getManeuver(ll) == lanelet::ManeuverType::Yield)
-      {
-        // lanelet has a yield reg. elem.
-        lanelet::Optional<lanelet::ConstLineString3d> row_stopline_opt = (*j)->stopLine();
-        if (!!row_stopline_opt)
-          stoplines.push_back(row_stopline_opt.get());
-      }
+      lanelet::Optional<lanelet::ConstLineString3d> row_stopline_opt = right_of_way->stopLine();
+      if (!!row_stopline_opt)
+        stoplines.push_back(row_stopline_opt.get());
     }
-  }
-
-  // find stop lines referenced by traffic lights
-  std::vector<std::shared_ptr<const lanelet::TrafficLight> > traffic_light_reg_elems =
-      ll.regulatoryElementsAs<const lanelet::TrafficLight>();
 
-  if (traffic_light_reg_elems.size() > 0)
-  {
-    // lanelet has a traffic light elem elemetn
-    for (auto j = traffic_light_reg_elems.begin(); j < traffic_light_reg_elems.end(); j++)
+    // find stop lines referenced by traffic lights
+    auto traffic_light = std::dynamic_pointer_cast<const lanelet::TrafficLight>(reg_elem);
+    if (traffic_light)
     {
-      lanelet::Optional<lanelet::ConstLineString3d> traffic_light_stopline_opt = (*j)->stopLine();
+      lanelet::Optional<lanelet::ConstLineString3d> traffic_light_stopline_opt = traffic_light->stopLine();
       if (!!traffic_light_stopline_opt)
-        stoplines.push_back(traffic_light_stopline_opt.get());
+        traffic_light_stoplines.push_back(traffic_light_stopline_opt.get());
     }
-  }
-  // find stop lines referenced by traffic signs
-  std::vector<std::shared_ptr<const lanelet::TrafficSign> > traffic_sign_reg_elems =
-      ll.regulatoryElementsAs<const lanelet::TrafficSign>();
 
-  if (traffic_sign_reg_elems.size() > 0)
-  {
-    // lanelet has a traffic sign reg elem - can have multiple ref lines (but
-    // stop sign shod have 1
-    for (auto j = traffic_sign_reg_elems.begin(); j < traffic_sign_reg_elems.end(); j++)
+    // find stop lines referenced by traffic signs - can have multiple ref lines (but stop sign shod have 1
+    auto traffic_sign = std::dynamic_pointer_cast<const lanelet::TrafficSign>(reg_elem);
+    if (traffic_sign)
     {
-      lanelet::ConstLineStrings3d traffic_sign_stoplines = (*j)->refLines();
-      if (traffic_sign_stoplines.size() > 0)
-        stoplines.push_back(traffic_sign_stoplines.front());
+      lanelet::ConstLineStrings3d ref_lines = traffic_sign->refLines();
+      if (ref_lines.size() > 0)
+        traffic_sign_stoplines.push_back(ref_lines.front());
     }
   }
+
+  stoplines.insert(stoplines.end(), traffic_light_stoplines.begin(), traffic_light_stoplines.end());
+  stoplines.insert(stoplines.end(), traffic_sign_stoplines.begin(), traffic_sign_stoplines.end());
   return stoplines;
 }
 
-std::vector<lanelet::ConstLineString3d> query::stopSignStopLines(const lanelet::ConstLanelets lanelets,
+std::vector<lanelet::ConstLineString3d> query::stopSignStopLines(const lanelet::ConstLanelets& lanelets,
                                                                  const std::string& stop_sign_id)
 {
   std::vector<lanelet::ConstLineString3d> stoplines;
-
-  std::set<lanelet::Id> checklist;
+  std::unordered_set<lanelet::Id> checklist;
 
   for (const auto& ll : lanelets)
+    appendStopSignStopLines(ll.regulatoryElementsAs<const lanelet::TrafficSign>(), stop_sign_id, &checklist,
+                            &stoplines);
+
+  return stoplines;
+}
+
+query::QueryIndex::QueryIndex(const lanelet::LaneletMapConstPtr ll_map)
+{
+  if (!ll_map)
   {
-    // find stop lines referenced by traffic signs
-    std::vector<std::shared_ptr<const lanelet::TrafficSign> > traffic_sign_reg_elems =
-        ll.regulatoryElementsAs<const lanelet::TrafficSign>();
+    ROS_WARN("No map received!");
+    return;
+  }
 
-    if (traffic_sign_reg_elems.size() > 0)
-    {
-      // lanelet has a traffic sign reg elem - can have multiple ref lines (but
-      // stop sign shod have 1
-      for (const auto& ts : traffic_sign_reg_elems)
-      {
-        // skip if traffic sign is not stop sign
-        if (ts->type() != stop_sign_id)
-        {
-          continue;
-        }
-
-        lanelet::ConstLineStrings3d traffic_sign_stoplines = ts->refLines();
-
-        // only add new items
-        if (traffic_sign_stoplines.size() > 0)
-        {
-          auto id = traffic_sign_stoplines.front().id();
-          if (checklist.find(id) == checklist.end())
-          {
-            checklist.insert(id);
-            stoplines.push_back(traffic_sign_stoplines.front());
-          }
-        }
-      }
-    }
+  lanelets_.reserve(ll_map->laneletLayer.size());
+  lanelet_elements_.reserve(ll_map->laneletLayer.size());
+  for (const auto& ll : ll_map->laneletLayer)
+  {
+    lanelets_.push_back(ll);
+
+    auto attr = ll.attributes().find(lanelet::AttributeName::Subtype);
+    if (attr != ll.attributes().end())
+      subtype_lanelets_[attr->second.value()].push_back(ll);
+
+    collectElements(ll, &lanelet_elements_[ll.id()]);
   }
+}
+
+void query::QueryIndex::collectElements(const lanelet::ConstLanelet& ll, LaneletElements* elements)
+{
+  elements->lanelet = ll;
+  elements->traffic_lights = ll.regulatoryElementsAs<lanelet::TrafficLight>();
+  elements->autoware_traffic_lights = ll.regulatoryElementsAs<lanelet::autoware::AutowareTrafficLight>();
+  elements->traffic_signs = ll.regulatoryElementsAs<lanelet::TrafficSign>();
+  elements->stop_lines = query::stopLinesLanelet(ll);
+}
+
+const query::QueryIndex::LaneletElements& query::QueryIndex::findElements(const lanelet::ConstLanelet& ll,
+                                                                          LaneletElements* scratch) const
+{
+  // an inverted lanelet or another lanelet with the same id may have other stop lines
+  auto it = lanelet_elements_.find(ll.id());
+  if (it != lanelet_elements_.end() && it->second.lanelet == ll)
+    return it->second;
+
+  collectElements(ll, scratch);
+  return *scratch;
+}
+
+const lanelet::ConstLanelets& query::QueryIndex::laneletLayer() const
+{
+  return lanelets_;
+}
+
+const lanelet::ConstLanelets& query::QueryIndex::subtypeLanelets(const char subtype[]) const
+{
+  auto it = subtype_lanelets_.find(subtype);
+  if (it == subtype_lanelets_.end())
+    return null_lanelets_;
+  return it->second;
+}
+
+const lanelet::ConstLanelets& query::QueryIndex::crosswalkLanelets() const
+{
+  return (subtypeLanelets(lanelet::AttributeValueString::Crosswalk));
+}
+
+const lanelet::ConstLanelets& query::QueryIndex::roadLanelets() const
+{
+  return (subtypeLanelets(lanelet::AttributeValueString::Road));
+}
+
+std::vector<lanelet::TrafficLightConstPtr> query::QueryIndex::trafficLights(const lanelet::ConstLanelets& lanelets) const
+{
+  std::vector<lanelet::TrafficLightConstPtr> tl_reg_elems;
+  std::unordered_set<lanelet::Id> ids;
+  LaneletElements scratch;
+
+  for (const auto& ll : lanelets)
+    appendUnique(findElements(ll, &scratch).traffic_lights, &ids, &tl_reg_elems);
+
+  return tl_reg_elems;
+}
+
+std::vector<lanelet::AutowareTrafficLightConstPtr>
+query::QueryIndex::autowareTrafficLights(const lanelet::ConstLanelets& lanelets) const
+{
+  std::vector<lanelet::AutowareTrafficLightConstPtr> tl_reg_elems;
+  std::unordered_set<lanelet::Id> ids;
+  LaneletElements scratch;
+
+  for (const auto& ll : lanelets)
+    appendUnique(findElements(ll, &scratch).autoware_traffic_lights, &ids, &tl_reg_elems);
+
+  return tl_reg_elems;
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryIndex::stopLinesLanelets(const lanelet::ConstLanelets& lanelets) const
+{
+  std::vector<lanelet::ConstLineString3d> stoplines;
+  LaneletElements scratch;
+
+  for (const auto& ll : lanelets)
+  {
+    const auto& ll_stoplines = findElements(ll, &scratch).stop_lines;
+    stoplines.insert(stoplines.end(), ll_stoplines.begin(), ll_stoplines.end());
+  }
+
+  return stoplines;
+}
+
+std::vector<lanelet::ConstLineString3d> query::QueryIndex::stopLinesLanelet(const lanelet::ConstLanelet& ll) const
+{
+  LaneletElements scratch;
+  return findElements(ll, &scratch).stop_lines;
+}
+
+std::vector<lanelet::ConstLineString3d>
+query::QueryIndex::stopSignStopLines(const lanelet::ConstLanelets& lanelets, const std::string& stop_sign_id) const
+{
+  std::vector<lanelet::ConstLineString3d> stoplines;
+  std::unordered_set<lanelet::Id> checklist;
+  LaneletElements scratch;
+
+  for (const auto& ll : lanelets)
+    appendStopSignStopLines(findElements(ll, &scratch).traffic_signs, stop_sign_id, &checklist, &stoplines);
+
   return stoplines;
 }
 
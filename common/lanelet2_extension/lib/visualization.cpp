@@ -22,7 +22,11 @@
 
 #include <Eigen/Eigen>
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <lanelet2_extension/utility/message_conversion.h>
@@ -33,7 +37,7 @@
 
 namespace
 {
-void adjacentPoints(const int i, const int N, const geometry_msgs::Polygon poly, geometry_msgs::Point32* p0,
+void adjacentPoints(const int i, const int N, const geometry_msgs::Polygon& poly, geometry_msgs::Point32* p0,
                     geometry_msgs::Point32* p1, geometry_msgs::Point32* p2)
 {
   if (p0 == nullptr || p1 == nullptr || p2 == nullptr)
@@ -59,6 +63,84 @@ double hypot(const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1)
   return (sqrt(pow((p1.x - p0.x), 2.0) + pow((p1.y - p0.y), 2.0)));
 }
 
+// twice the signed area of the triangle, positive if counterclockwise
+double signedArea(const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1, const geometry_msgs::Point32& p2)
+{
+  return (static_cast<double>(p1.x) - p0.x) * (static_cast<double>(p2.y) - p0.y) -
+         (static_cast<double>(p2.x) - p0.x) * (static_cast<double>(p1.y) - p0.y);
+}
+
+void toPoints32(const lanelet::ConstLineString3d& ls, std::vector<geometry_msgs::Point32>* points)
+{
+  points->reserve(ls.size());
+  for (const auto& pt : ls)
+  {
+    geometry_msgs::Point32 pt32;
+    lanelet::utils::conversion::toGeomMsgPt32(pt.basicPoint(), &pt32);
+    points->push_back(pt32);
+  }
+}
+
+// triangulates the strip between the left and right bound, walking along both bounds and taking the shorter diagonal.
+// triangles have the orientation of the lanelet polygon. returns false if a triangle is inverted, e.g. where the
+// bounds cross each other, as the strip doesn't cover the lanelet then
+bool laneletStripTriangles(const lanelet::ConstLanelet& ll, std::vector<geometry_msgs::Polygon>* triangles)
+{
+  std::vector<geometry_msgs::Point32> left, right;
+  toPoints32(ll.leftBound(), &left);
+  toPoints32(ll.rightBound(), &right);
+  if (left.empty() || right.empty() || left.size() + right.size() < 3)
+    return false;
+
+  // polygon of the left bound forward and the right bound backward
+  double polygon_area = 0;
+  std::vector<geometry_msgs::Point32> polygon(left);
+  polygon.insert(polygon.end(), right.rbegin(), right.rend());
+  for (size_t k = 0; k < polygon.size(); k++)
+  {
+    const geometry_msgs::Point32& p0 = polygon[k];
+    const geometry_msgs::Point32& p1 = polygon[(k + 1) % polygon.size()];
+    polygon_area += static_cast<double>(p0.x) * p1.y - static_cast<double>(p1.x) * p0.y;
+  }
+  if (!std::isfinite(polygon_area) || polygon_area == 0)
+    return false;
+
+  size_t i = 0, j = 0;
+  while (i + 1 < left.size() || j + 1 < right.size())
+  {
+    bool advance_left;
+    if (i + 1 == left.size())
+      advance_left = false;
+    else if (j + 1 == right.size())
+      advance_left = true;
+    else
+      advance_left = hypot(left[i + 1], right[j]) <= hypot(left[i], right[j + 1]);
+
+    geometry_msgs::Polygon triangle;
+    triangle.points.push_back(left[i]);
+    if (advance_left)
+    {
+      triangle.points.push_back(left[i + 1]);
+      triangle.points.push_back(right[j]);
+      i++;
+    }
+    else
+    {
+      triangle.points.push_back(right[j + 1]);
+      triangle.points.push_back(right[j]);
+      j++;
+    }
+
+    double area = signedArea(triangle.points[0], triangle.points[1], triangle.points[2]);
+    if (!(area * polygon_area >= 0))
+      return false;
+    // degenerate triangles, e.g. where the bounds share a point, cover nothing
+    if (area != 0)
+      triangles->push_back(triangle);
+  }
+  return true;
+}
+
 bool isAttributeValue(const lanelet::ConstPoint3d p, const std::string attr_str, const std::string value_str)
 {
   lanelet::Attribute attr = p.attribute(attr_str);
@@ -234,6 +316,11 @@ void visualization::lanelet2Triangle(const lanelet::ConstLanelet& ll, std::vecto
     return;
   }
 
+  triangles->clear();
+  if (laneletStripTriangles(ll, triangles))
+    return;
+
+  // shapes the strip doesn't cover fall back to ear clipping
   triangles->clear();
   geometry_msgs::Polygon ll_poly;
   lanelet2Polygon(ll, &ll_poly);
@@ -466,11 +553,60 @@ visualization_msgs::MarkerArray visualization::trafficLightsAsTriangleMarkerArra
   return (marker_array);
 }
 
-visualization_msgs::MarkerArray visualization::laneletsAsTriangleMarkerArray(const std::string ns,
-                                                                             const lanelet::ConstLanelets& lanelets,
-                                                                             const std_msgs::ColorRGBA c)
+void visualization::lanelets2TriangleMesh(const lanelet::ConstLanelets& lanelets,
+                                         std::vector<geometry_msgs::Point>* mesh)
+{
+  if (mesh == nullptr)
+  {
+    ROS_ERROR_STREAM(__FUNCTION__ << ": mesh is null pointer!");
+    return;
+  }
+
+  // lanelets are triangulated independently, by several threads for large maps
+  const size_t lanelets_per_thread = 64;
+  std::vector<std::vector<geometry_msgs::Polygon>> triangles(lanelets.size());
+  size_t thread_count = std::max(1u, std::thread::hardware_concurrency());
+  thread_count = std::min(thread_count, (lanelets.size() + lanelets_per_thread - 1) / lanelets_per_thread);
+
+  std::atomic<size_t> next_lanelet(0);
+  auto triangulate = [&]()
+  {
+    for (size_t i = next_lanelet++; i < lanelets.size(); i = next_lanelet++)
+      lanelet2Triangle(lanelets[i], &triangles[i]);
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count; i++)
+    threads.emplace_back(triangulate);
+  triangulate();
+  for (auto& thread : threads)
+    thread.join();
+
+  size_t triangle_count = 0;
+  for (const auto& ll_triangles : triangles)
+    triangle_count += ll_triangles.size();
+
+  mesh->clear();
+  mesh->reserve(3 * triangle_count);
+  for (const auto& ll_triangles : triangles)
+  {
+    for (const auto& tri : ll_triangles)
+    {
+      for (int i = 0; i < 3; i++)
+        mesh->push_back(utils::conversion::toGeomMsgPt(tri.points[i]));
+    }
+  }
+}
+
+visualization_msgs::MarkerArray visualization::triangleMeshAsMarkerArray(const std::string ns,
+                                                                         const std::vector<geometry_msgs::Point>& mesh,
+                                                                         const std_msgs::ColorRGBA c)
 {
   visualization_msgs::MarkerArray marker_array;
+  if (mesh.empty())
+  {
+    return (marker_array);
+  }
+
   visualization_msgs::Marker marker;
 
   marker.header.frame_id = "map";
@@ -490,32 +626,22 @@ visualization_msgs::MarkerArray visualization::laneletsAsTriangleMarkerArray(con
   marker.color.b = 1.0f;
   marker.color.a = 1.0f;
 
-  for (auto ll : lanelets)
-  {
-    std::vector<geometry_msgs::Polygon> triangles;
-    lanelet2Triangle(ll, &triangles);
-
-    for (auto tri : triangles)
-    {
-      geometry_msgs::Point tri0[3];
-
-      for (int i = 0; i < 3; i++)
-      {
-        utils::conversion::toGeomMsgPt(tri.points[i], &tri0[i]);
-
-        marker.points.push_back(tri0[i]);
-        marker.colors.push_back(c);
-      }
-    }
-  }
-  if (!marker.points.empty())
-  {
-    marker_array.markers.push_back(marker);
-  }
+  marker.points = mesh;
+  marker.colors.assign(mesh.size(), c);
+  marker_array.markers.push_back(marker);
 
   return (marker_array);
 }
 
+visualization_msgs::MarkerArray visualization::laneletsAsTriangleMarkerArray(const std::string ns,
+                                                                             const lanelet::ConstLanelets& lanelets,
+                                                                             const std_msgs::ColorRGBA c)
+{
+  std::vector<geometry_msgs::Point> mesh;
+  lanelets2TriangleMesh(lanelets, &mesh);
+  return (triangleMeshAsMarkerArray(ns, mesh, c));
+}
+
 void visualization::trafficLight2TriangleMarker(const lanelet::ConstLineString3d ls, visualization_msgs::Marker* marker,
                                                 const std::string ns, const std_msgs::ColorRGBA cl,
                                                 const ros::Duration duration, const double scale)
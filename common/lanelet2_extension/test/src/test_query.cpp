@@ -21,6 +21,13 @@
 #include <math.h>
 #include <ros/ros.h>
 
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
 using lanelet::Lanelet;
 using lanelet::LineString3d;
 using lanelet::LineStringOrPolygon3d;
@@ -246,6 +253,176 @@ TEST_F(TestSuite, QueryStopLine)
   ASSERT_EQ(1, stop_lines2.size()) << "failed to retrieve stop lines from a lanelet";
 }
 
+// autowareTrafficLights before the query index, deduplicating by a linear scan over the result
+std::vector<lanelet::AutowareTrafficLightConstPtr> legacyAutowareTrafficLights(const lanelet::ConstLanelets lanelets)
+{
+  std::vector<lanelet::AutowareTrafficLightConstPtr> tl_reg_elems;
+  for (const auto& ll : lanelets)
+  {
+    for (const auto& tl_ptr : ll.regulatoryElementsAs<lanelet::autoware::AutowareTrafficLight>())
+    {
+      bool unique_id = true;
+      for (const auto& added : tl_reg_elems)
+      {
+        if (tl_ptr->id() == added->id())
+        {
+          unique_id = false;
+          break;
+        }
+      }
+      if (unique_id)
+        tl_reg_elems.push_back(tl_ptr);
+    }
+  }
+  return tl_reg_elems;
+}
+
+template <class T>
+bool isSameIds(const std::vector<T>& lhs, const std::vector<T>& rhs)
+{
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                    [](const T& l, const T& r) { return l.id() == r.id(); });
+}
+
+template <class T>
+bool isSameElements(const std::vector<std::shared_ptr<const T>>& lhs, const std::vector<std::shared_ptr<const T>>& rhs)
+{
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+void expectSameQueries(const lanelet::utils::query::QueryIndex& index, const lanelet::ConstLanelets& lanelets)
+{
+  EXPECT_TRUE(isSameElements(index.trafficLights(lanelets), lanelet::utils::query::trafficLights(lanelets)));
+  EXPECT_TRUE(isSameElements(index.autowareTrafficLights(lanelets),
+                             lanelet::utils::query::autowareTrafficLights(lanelets)));
+  EXPECT_TRUE(isSameIds(index.stopLinesLanelets(lanelets), lanelet::utils::query::stopLinesLanelets(lanelets)));
+  EXPECT_TRUE(isSameIds(index.stopSignStopLines(lanelets), lanelet::utils::query::stopSignStopLines(lanelets)));
+  for (const auto& ll : lanelets)
+    EXPECT_TRUE(isSameIds(index.stopLinesLanelet(ll), lanelet::utils::query::stopLinesLanelet(ll)));
+}
+
+TEST_F(TestSuite, QueryIndex)
+{
+  lanelet::utils::query::QueryIndex index(sample_map_ptr);
+  lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(sample_map_ptr);
+
+  ASSERT_TRUE(isSameIds(index.laneletLayer(), all_lanelets));
+  ASSERT_TRUE(isSameIds(index.roadLanelets(), lanelet::utils::query::roadLanelets(all_lanelets)));
+  ASSERT_TRUE(isSameIds(index.crosswalkLanelets(), lanelet::utils::query::crosswalkLanelets(all_lanelets)));
+  ASSERT_TRUE(index.subtypeLanelets("no_subtype").empty());
+
+  ASSERT_EQ(1, index.autowareTrafficLights(all_lanelets).size());
+  ASSERT_EQ(1, index.stopLinesLanelets(all_lanelets).size());
+  expectSameQueries(index, all_lanelets);
+
+  // lanelets that are not in the map, or differ from the indexed one, are queried directly
+  Lanelet unindexed_lanelet(getId(), ls_right, ls_right_right);
+  unindexed_lanelet.addRegulatoryElement(tl);
+  Lanelet changed_lanelet(road_lanelet1.id(), ls_right, ls_right_right);
+  changed_lanelet.addRegulatoryElement(tl);
+  expectSameQueries(index, { unindexed_lanelet, changed_lanelet, road_lanelet.invert(), road_lanelet });
+  ASSERT_EQ(1, index.stopLinesLanelet(changed_lanelet).size());
+
+  lanelet::utils::query::QueryIndex null_index(nullptr);
+  ASSERT_TRUE(null_index.laneletLayer().empty());
+  ASSERT_TRUE(null_index.roadLanelets().empty());
+}
+
+// a grid of lanes, with traffic lights, stop signs and yield rules shared by the lanelets around each intersection
+lanelet::LaneletMapPtr createLargeMap(int lanes, int lanelets_per_lane)
+{
+  lanelet::LaneletMapPtr map(new lanelet::LaneletMap());
+  std::vector<LineString3d> bounds;
+  for (int i = 0; i <= lanes; i++)
+  {
+    Points3d points;
+    for (int j = 0; j <= lanelets_per_lane; j++)
+      points.push_back(Point3d(getId(), 10. * j, 3. * i, 0.));
+    bounds.push_back(LineString3d(getId(), points));
+  }
+
+  std::vector<Lanelet> lanelets;
+  for (int i = 0; i < lanes; i++)
+  {
+    for (int j = 0; j < lanelets_per_lane; j++)
+    {
+      LineString3d left(getId(), { bounds[i + 1][j], bounds[i + 1][j + 1] });
+      LineString3d right(getId(), { bounds[i][j], bounds[i][j + 1] });
+      Lanelet ll(getId(), left, right);
+      ll.attributes()[lanelet::AttributeName::Subtype] =
+          j % 10 == 9 ? lanelet::AttributeValueString::Crosswalk : lanelet::AttributeValueString::Road;
+      lanelets.push_back(ll);
+    }
+  }
+
+  for (int j = 0; j < lanelets_per_lane; j += 5)
+  {
+    LineString3d stop_line(getId(), { Point3d(getId(), 10. * j, 0., 0.), Point3d(getId(), 10. * j, 3. * lanes, 0.) });
+    LineString3d light(getId(), { Point3d(getId(), 10. * j, 0., 5.), Point3d(getId(), 10. * j, 1., 5.) });
+    LineString3d bulbs(getId(), { Point3d(getId(), 10. * j, 0., 5.5), Point3d(getId(), 10. * j, 1., 5.5) });
+    auto aw_tl = lanelet::autoware::AutowareTrafficLight::make(getId(), lanelet::AttributeMap(), { light }, stop_line,
+                                                               { bulbs });
+    LineString3d sign(getId(), { Point3d(getId(), 10. * j, -1., 2.), Point3d(getId(), 10. * j, -1., 3.) });
+    lanelet::TrafficSignsWithType signs{ { sign }, j % 10 == 0 ? "stop_sign" : "yield_sign" };
+    auto traffic_sign = lanelet::TrafficSign::make(getId(), lanelet::AttributeMap(), signs, {}, { stop_line });
+    auto right_of_way = lanelet::RightOfWay::make(getId(), lanelet::AttributeMap(), { lanelets[j] },
+                                                  { lanelets[lanelets_per_lane + j] }, stop_line);
+    for (int i = 0; i < lanes; i++)
+    {
+      lanelets[i * lanelets_per_lane + j].addRegulatoryElement(aw_tl);
+      lanelets[i * lanelets_per_lane + j].addRegulatoryElement(traffic_sign);
+      lanelets[i * lanelets_per_lane + j].addRegulatoryElement(right_of_way);
+    }
+  }
+
+  for (const auto& ll : lanelets)
+    map->add(ll);
+  return map;
+}
+
+TEST(QueryIndexBenchmark, LargeMap)
+{
+  for (int lanelets_per_lane : { 100, 1000, 5000 })
+  {
+    lanelet::LaneletMapPtr map = createLargeMap(4, lanelets_per_lane);
+    lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(map);
+
+    auto start = std::chrono::steady_clock::now();
+    lanelet::utils::query::QueryIndex index(map);
+    auto built = std::chrono::steady_clock::now();
+    auto index_lights = index.autowareTrafficLights(index.laneletLayer());
+    auto index_stop_lines = index.stopLinesLanelets(index.roadLanelets());
+    auto index_stop_signs = index.stopSignStopLines(index.laneletLayer());
+    auto index_queried = std::chrono::steady_clock::now();
+    auto lights = lanelet::utils::query::autowareTrafficLights(all_lanelets);
+    auto stop_lines = lanelet::utils::query::stopLinesLanelets(lanelet::utils::query::roadLanelets(all_lanelets));
+    auto stop_signs = lanelet::utils::query::stopSignStopLines(all_lanelets);
+    auto queried = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(lanelets_per_lane / 5, lights.size());
+    ASSERT_TRUE(isSameElements(index_lights, lights));
+    ASSERT_TRUE(isSameIds(index_stop_lines, stop_lines));
+    ASSERT_TRUE(isSameIds(index_stop_signs, stop_signs));
+
+    // the per cycle query of traffic_light_recognizer on a long list of lanelets
+    auto index_cycle_start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 10; i++)
+      index_lights = index.autowareTrafficLights(all_lanelets);
+    auto index_cycle_end = std::chrono::steady_clock::now();
+    auto legacy_lights = legacyAutowareTrafficLights(all_lanelets);
+    auto legacy_end = std::chrono::steady_clock::now();
+    ASSERT_TRUE(isSameElements(legacy_lights, lights));
+
+    auto ms = [](std::chrono::steady_clock::time_point from, std::chrono::steady_clock::time_point to) {
+      return std::chrono::duration<double, std::milli>(to - from).count();
+    };
+    std::cout << all_lanelets.size() << " lanelets: index built in " << ms(start, built) << " ms, queried in "
+              << ms(built, index_queried) << " ms, direct queries " << ms(index_queried, queried)
+              << " ms, traffic lights of all lanelets " << ms(index_cycle_start, index_cycle_end) / 10
+              << " ms per call with the index, " << ms(index_cycle_end, legacy_end) << " ms before" << std::endl;
+  }
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
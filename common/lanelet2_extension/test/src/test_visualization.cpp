@@ -0,0 +1,357 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+
+#include <lanelet2_extension/utility/message_conversion.h>
+#include <lanelet2_extension/visualization/visualization.h>
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using lanelet::Lanelet;
+using lanelet::LineString3d;
+using lanelet::Point3d;
+using lanelet::Points3d;
+using lanelet::utils::getId;
+
+namespace
+{
+// ear clipping as lanelet2Triangle did for every lanelet
+void legacyLanelet2Triangle(const lanelet::ConstLanelet& ll, std::vector<geometry_msgs::Polygon>* triangles)
+{
+  triangles->clear();
+  geometry_msgs::Polygon ll_poly;
+  lanelet::visualization::lanelet2Polygon(ll, &ll_poly);
+
+  auto adjacentPoints = [](const int i, const int N, const geometry_msgs::Polygon poly, geometry_msgs::Point32* p0,
+                           geometry_msgs::Point32* p1, geometry_msgs::Point32* p2)
+  {
+    *p1 = poly.points[i];
+    *p0 = i == 0 ? poly.points[N - 1] : poly.points[i - 1];
+    *p2 = i < N - 1 ? poly.points[i + 1] : poly.points[0];
+  };
+  auto hypot = [](const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1)
+  {
+    return (sqrt(pow((p1.x - p0.x), 2.0) + pow((p1.y - p0.y), 2.0)));
+  };
+
+  int N = ll_poly.points.size();
+  while (N >= 3)
+  {
+    double min_angle = 2 * M_PI;
+    int min_i = -1;
+
+    for (int i = 0; i < N; i++)
+    {
+      geometry_msgs::Point32 p0, p1, p2;
+      adjacentPoints(i, N, ll_poly, &p0, &p1, &p2);
+
+      double a = hypot(p0, p1);
+      double b = hypot(p1, p2);
+      double c = hypot(p0, p2);
+      double theta = acos((a * a + b * b - c * c) / (2.0 * a * b));
+
+      geometry_msgs::Point p64_0, p64_1, p64_2;
+      lanelet::utils::conversion::toGeomMsgPt(p0, &p64_0);
+      lanelet::utils::conversion::toGeomMsgPt(p1, &p64_1);
+      lanelet::utils::conversion::toGeomMsgPt(p2, &p64_2);
+      double n = p64_2.x * (p64_0.y - p64_1.y) + p64_0.x * (p64_1.y - p64_2.y) + p64_1.x * (p64_2.y - p64_0.y);
+      if (n > 0)
+      {
+        theta = 2 * M_PI - theta;
+      }
+
+      if (theta < min_angle)
+      {
+        min_angle = theta;
+        min_i = i;
+      }
+    }
+    if (min_i >= 0 && min_i < N)
+    {
+      geometry_msgs::Point32 p0, p1, p2;
+      adjacentPoints(min_i, N, ll_poly, &p0, &p1, &p2);
+      geometry_msgs::Polygon triangle;
+      triangle.points.push_back(p0);
+      triangle.points.push_back(p1);
+      triangle.points.push_back(p2);
+      triangles->push_back(triangle);
+
+      auto it = ll_poly.points.begin();
+      std::advance(it, min_i);
+      ll_poly.points.erase(it);
+    }
+    N = ll_poly.points.size();
+  }
+}
+
+LineString3d createArc(const double radius, const double start_angle, const double end_angle, const int points)
+{
+  Points3d arc;
+  for (int i = 0; i < points; i++)
+  {
+    double angle = start_angle + (end_angle - start_angle) * i / std::max(points - 1, 1);
+    arc.push_back(Point3d(getId(), radius * std::cos(angle), radius * std::sin(angle), 0.1 * i));
+  }
+  return LineString3d(getId(), arc);
+}
+
+LineString3d createLine(const double x0, const double y0, const double x1, const double y1, const int points)
+{
+  Points3d line;
+  for (int i = 0; i < points; i++)
+  {
+    double t = static_cast<double>(i) / std::max(points - 1, 1);
+    line.push_back(Point3d(getId(), x0 + (x1 - x0) * t, y0 + (y1 - y0) * t, 0.));
+  }
+  return LineString3d(getId(), line);
+}
+
+// lanelet along an arc, turning left for a positive angle, with a different number of points on either bound
+Lanelet createCurvedLanelet(const double angle, const int left_points, const int right_points)
+{
+  const double radius = 30.0;
+  const double width = 3.5;
+  double sign = angle > 0 ? 1.0 : -1.0;
+  double start_angle = -sign * M_PI / 2;
+  LineString3d left = createArc(radius - sign * width / 2, start_angle, start_angle + angle, left_points);
+  LineString3d right = createArc(radius + sign * width / 2, start_angle, start_angle + angle, right_points);
+  return Lanelet(getId(), left, right);
+}
+
+double signedArea(const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1, const geometry_msgs::Point32& p2)
+{
+  return ((static_cast<double>(p1.x) - p0.x) * (static_cast<double>(p2.y) - p0.y) -
+          (static_cast<double>(p2.x) - p0.x) * (static_cast<double>(p1.y) - p0.y)) / 2;
+}
+
+bool isInTriangle(const geometry_msgs::Polygon& triangle, const geometry_msgs::Point32& p)
+{
+  double a0 = signedArea(triangle.points[0], triangle.points[1], p);
+  double a1 = signedArea(triangle.points[1], triangle.points[2], p);
+  double a2 = signedArea(triangle.points[2], triangle.points[0], p);
+  return (a0 > 0 && a1 > 0 && a2 > 0) || (a0 < 0 && a1 < 0 && a2 < 0);
+}
+
+int windingNumber(const geometry_msgs::Polygon& polygon, const geometry_msgs::Point32& p)
+{
+  int winding_number = 0;
+  for (size_t i = 0; i < polygon.points.size(); i++)
+  {
+    const geometry_msgs::Point32& p0 = polygon.points[i];
+    const geometry_msgs::Point32& p1 = polygon.points[(i + 1) % polygon.points.size()];
+    if (p0.y <= p.y && p1.y > p.y && signedArea(p0, p1, p) > 0)
+      winding_number++;
+    else if (p0.y > p.y && p1.y <= p.y && signedArea(p0, p1, p) < 0)
+      winding_number--;
+  }
+  return winding_number;
+}
+
+// the triangles cover every point of the lanelet polygon once and no other point
+void expectCoversLanelet(const lanelet::ConstLanelet& ll, const std::vector<geometry_msgs::Polygon>& triangles)
+{
+  geometry_msgs::Polygon polygon;
+  lanelet::visualization::lanelet2Polygon(ll, &polygon);
+
+  double polygon_area = 0;
+  for (size_t i = 0; i < polygon.points.size(); i++)
+  {
+    const geometry_msgs::Point32& p0 = polygon.points[i];
+    const geometry_msgs::Point32& p1 = polygon.points[(i + 1) % polygon.points.size()];
+    polygon_area += (static_cast<double>(p0.x) * p1.y - static_cast<double>(p1.x) * p0.y) / 2;
+  }
+
+  double triangles_area = 0;
+  for (const auto& triangle : triangles)
+  {
+    ASSERT_EQ(triangle.points.size(), 3u);
+    double area = signedArea(triangle.points[0], triangle.points[1], triangle.points[2]);
+    EXPECT_GT(area * polygon_area, 0) << "triangle is inverted or degenerate";
+    triangles_area += area;
+  }
+  EXPECT_NEAR(triangles_area, polygon_area, 1e-3 * std::fabs(polygon_area));
+
+  float min_x = polygon.points[0].x, max_x = min_x, min_y = polygon.points[0].y, max_y = min_y;
+  for (const auto& p : polygon.points)
+  {
+    min_x = std::min(min_x, p.x);
+    max_x = std::max(max_x, p.x);
+    min_y = std::min(min_y, p.y);
+    max_y = std::max(max_y, p.y);
+  }
+  std::mt19937 engine(0);
+  std::uniform_real_distribution<float> x(min_x, max_x), y(min_y, max_y);
+  for (int i = 0; i < 2000; i++)
+  {
+    geometry_msgs::Point32 p;
+    p.x = x(engine);
+    p.y = y(engine);
+    int covering_triangles = 0;
+    for (const auto& triangle : triangles)
+    {
+      if (isInTriangle(triangle, p))
+        covering_triangles++;
+    }
+    EXPECT_EQ(covering_triangles, std::abs(windingNumber(polygon, p))) << "at " << p.x << ", " << p.y;
+  }
+}
+
+bool isSamePoint(const geometry_msgs::Point32& p0, const geometry_msgs::Point32& p1)
+{
+  return p0.x == p1.x && p0.y == p1.y && p0.z == p1.z;
+}
+}  // namespace
+
+TEST(TestVisualization, StripCoversLanelet)
+{
+  std::vector<Lanelet> lanelets;
+  lanelets.push_back(Lanelet(getId(), createLine(0, 1.75, 20, 1.75, 2), createLine(0, -1.75, 20, -1.75, 2)));
+  lanelets.push_back(Lanelet(getId(), createLine(0, 1.75, 20, 1.75, 7), createLine(0, -1.75, 20, -1.75, 3)));
+  lanelets.push_back(createCurvedLanelet(M_PI / 2, 20, 20));
+  lanelets.push_back(createCurvedLanelet(M_PI / 2, 5, 40));
+  lanelets.push_back(createCurvedLanelet(-M_PI / 2, 40, 5));
+  lanelets.push_back(createCurvedLanelet(-3 * M_PI / 2, 60, 90));
+
+  // bounds meeting at their start, as where a lane splits off
+  LineString3d left = createLine(0, 0, 20, 3.5, 10);
+  Points3d right{ left.front() };
+  for (const auto& p : createLine(0, 0, 20, 0, 10))
+  {
+    if (p.x() > 0)
+      right.push_back(p);
+  }
+  lanelets.push_back(Lanelet(getId(), left, LineString3d(getId(), right)));
+
+  // right bound of a single point
+  lanelets.push_back(Lanelet(getId(), createLine(0, 2, 10, 2, 5), createLine(5, 0, 5, 0, 1)));
+
+  for (const auto& ll : lanelets)
+  {
+    std::vector<geometry_msgs::Polygon> triangles;
+    lanelet::visualization::lanelet2Triangle(ll, &triangles);
+    EXPECT_FALSE(triangles.empty());
+    expectCoversLanelet(ll, triangles);
+  }
+}
+
+TEST(TestVisualization, FallbackForCrossingBounds)
+{
+  // bounds swapping sides halfway
+  Lanelet ll(getId(), createLine(0, 2, 20, -2, 9), createLine(0, -2, 20, 2, 9));
+
+  std::vector<geometry_msgs::Polygon> expected, triangles;
+  legacyLanelet2Triangle(ll, &expected);
+  lanelet::visualization::lanelet2Triangle(ll, &triangles);
+  ASSERT_EQ(triangles.size(), expected.size());
+  for (size_t i = 0; i < triangles.size(); i++)
+  {
+    for (int j = 0; j < 3; j++)
+      EXPECT_TRUE(isSamePoint(triangles[i].points[j], expected[i].points[j]));
+  }
+}
+
+TEST(TestVisualization, TriangleMesh)
+{
+  lanelet::ConstLanelets lanelets;
+  for (int i = 0; i < 300; i++)
+  {
+    double y = 4.0 * i;
+    if (i % 3 == 0)
+      lanelets.push_back(createCurvedLanelet(M_PI / (2 + i % 5), 3 + i % 11, 3 + i % 7));
+    else
+      lanelets.push_back(Lanelet(getId(), createLine(0, y + 1.75, 20, y + 1.75, 2 + i % 4),
+                                 createLine(0, y - 1.75, 20, y - 1.75, 2 + i % 6)));
+  }
+
+  std::vector<geometry_msgs::Point> expected;
+  for (const auto& ll : lanelets)
+  {
+    std::vector<geometry_msgs::Polygon> triangles;
+    lanelet::visualization::lanelet2Triangle(ll, &triangles);
+    for (const auto& triangle : triangles)
+    {
+      for (const auto& p : triangle.points)
+        expected.push_back(lanelet::utils::conversion::toGeomMsgPt(p));
+    }
+  }
+
+  std::vector<geometry_msgs::Point> mesh;
+  lanelet::visualization::lanelets2TriangleMesh(lanelets, &mesh);
+  ASSERT_EQ(mesh.size(), expected.size());
+  for (size_t i = 0; i < mesh.size(); i++)
+  {
+    EXPECT_EQ(mesh[i].x, expected[i].x);
+    EXPECT_EQ(mesh[i].y, expected[i].y);
+    EXPECT_EQ(mesh[i].z, expected[i].z);
+  }
+
+  std_msgs::ColorRGBA c;
+  c.g = 0.7;
+  c.a = 0.3;
+  visualization_msgs::MarkerArray marker_array =
+      lanelet::visualization::laneletsAsTriangleMarkerArray("lanelets", lanelets, c);
+  ASSERT_EQ(marker_array.markers.size(), 1u);
+  EXPECT_EQ(marker_array.markers[0].type, visualization_msgs::Marker::TRIANGLE_LIST);
+  EXPECT_EQ(marker_array.markers[0].ns, "lanelets");
+  EXPECT_EQ(marker_array.markers[0].points.size(), mesh.size());
+  ASSERT_EQ(marker_array.markers[0].colors.size(), mesh.size());
+  EXPECT_EQ(marker_array.markers[0].colors.back().g, c.g);
+
+  EXPECT_TRUE(
+      lanelet::visualization::laneletsAsTriangleMarkerArray("lanelets", lanelet::ConstLanelets(), c).markers.empty());
+}
+
+TEST(TestVisualization, TriangulationBenchmark)
+{
+  for (int points : { 16, 64, 256, 1024, 4096 })
+  {
+    Lanelet ll = createCurvedLanelet(M_PI / 2, points, points);
+    std::vector<geometry_msgs::Polygon> triangles;
+
+    auto start = std::chrono::steady_clock::now();
+    lanelet::visualization::lanelet2Triangle(ll, &triangles);
+    double strip_time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    EXPECT_EQ(triangles.size(), 2u * points - 2);
+
+    // ear clipping is cubic in the points, too slow beyond a few hundred
+    if (points <= 256)
+    {
+      start = std::chrono::steady_clock::now();
+      legacyLanelet2Triangle(ll, &triangles);
+      double ear_clipping_time =
+          std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+      std::cout << points << " points per bound: strip " << strip_time << " ms, ear clipping " << ear_clipping_time
+                << " ms" << std::endl;
+    }
+    else
+    {
+      std::cout << points << " points per bound: strip " << strip_time << " ms" << std::endl;
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "TestNode");
+  return RUN_ALL_TESTS();
+}
@@ -14,16 +14,18 @@
  * limitations under the License.
  */
 
-#include <iostream>
-#include <vector>
-#include <string>
+#include "laserscan2costmap.h"
+
 #include <algorithm>
+#include <cmath>
+#include <limits>
 
-#include <ros/ros.h>
-#include <sensor_msgs/LaserScan.h>
-#include <tf/transform_listener.h>
-#include <nav_msgs/OccupancyGrid.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
+namespace object_map
+{
 namespace
 {
 constexpr auto OGM_FRAME = "/map";
@@ -31,38 +33,6 @@ constexpr int OCCUPIED_MAX = 8;
 constexpr int OCCUPIED_MIN = -8;
 constexpr int OCCUPIED_INCREMENT = 2;
 constexpr int FREE_INCREMENT = 1;
-std::string g_sensor_frame = "/velodyne";  // sensor which publihes lasescan message
-std::string g_scan_topic = "/scan";        // laser scan topic
-double g_resolution = 0.1;                 // [m]
-int g_scan_size_x = 1000;                  // actual scanning size
-int g_scan_size_y = 1000;
-int g_map_size_x = 500;  // publishing occupancy grid map size
-int g_map_size_y = 500;
-
-struct Grid
-{
-  int index;
-  int index_x, index_y;
-  double x, y;
-  double weight;
-  double range;
-
-  void calcCoordinate();
-  void calcRange();
-  int calcGlobalIndex(const tf::StampedTransform& transform) const;
-};
-
-struct Cost
-{
-  int occupied = 0;
-  int free     = 0;
-  bool unknown = true;
-
-  void accumulateCost(int occ, int free);
-};
-
-ros::Publisher g_map_pub;
-tf::TransformListener* g_tf_listenerp;
 
 double calcYawFromQuaternion(const tf::Quaternion& q)
 {
@@ -73,242 +43,363 @@ double calcYawFromQuaternion(const tf::Quaternion& q)
   return yaw;
 }
 
-// Accumulate cost value
-void Cost::accumulateCost(int occupied_inc, int free_inc)
+// First cell, step and ray parameters of the next grid line along one axis
+void initTraversal(double origin, double direction, int* index, int* step, double* t_max, double* t_delta)
 {
-  occupied += occupied_inc - free_inc;
-  free     += free_inc;
-  unknown   = false;
-
-  if (occupied > OCCUPIED_MAX)
-    occupied = OCCUPIED_MAX;
-
-  if (occupied < OCCUPIED_MIN)
-    occupied = OCCUPIED_MIN;
+  if (direction > 0)
+  {
+    *index = static_cast<int>(std::floor(origin));
+    *step = 1;
+    *t_max = (*index + 1 - origin) / direction;
+    *t_delta = 1.0 / direction;
+  }
+  else if (direction < 0)
+  {
+    // A ray starting on a grid line enters the lower cell
+    *index = static_cast<int>(std::ceil(origin)) - 1;
+    *step = -1;
+    *t_max = (origin - *index) / -direction;
+    *t_delta = -1.0 / direction;
+  }
+  else
+  {
+    *index = static_cast<int>(std::floor(origin));
+    *step = 0;
+    *t_max = std::numeric_limits<double>::infinity();
+    *t_delta = std::numeric_limits<double>::infinity();
+  }
 }
+}  // namespace
 
-// Calcurate grid's coordinate in sensor frame
-void Grid::calcCoordinate()
+void castBeam(double angle, double resolution, int scan_size_x, int scan_size_y, std::vector<BeamCell>* cells)
 {
-  // index coordinate
-  index_x = index % g_scan_size_x;
-  index_y = (index - index_x) / g_scan_size_x;
+  cells->clear();
 
-  // actual coordinate
-  x = (index_x - g_scan_size_x / 2.0) * g_resolution;
-  y = (index_y - g_scan_size_y / 2.0) * g_resolution;
-}
+  // Ray in grid units, starting from the sensor at the grid center
+  int index_x, index_y, step_x, step_y;
+  double t_max_x, t_max_y, t_delta_x, t_delta_y;
+  initTraversal(scan_size_x / 2.0, cos(angle), &index_x, &step_x, &t_max_x, &t_delta_x);
+  initTraversal(scan_size_y / 2.0, sin(angle), &index_y, &step_y, &t_max_y, &t_delta_y);
 
-// Calculate a range from sensor in a certain grid
-void Grid::calcRange()
-{
-  double distance_x = g_resolution * fabs(g_scan_size_x / 2 - index_x);
-  double distance_y = g_resolution * fabs(g_scan_size_y / 2 - index_y);
+  while (index_x >= 0 && index_x < scan_size_x && index_y >= 0 && index_y < scan_size_y)
+  {
+    BeamCell cell;
+    cell.index_x = index_x;
+    cell.index_y = index_y;
 
-  range = sqrt(distance_x * distance_x + distance_y * distance_y);
+    double distance_x = resolution * fabs(scan_size_x / 2 - index_x);
+    double distance_y = resolution * fabs(scan_size_y / 2 - index_y);
+    cell.range = sqrt(distance_x * distance_x + distance_y * distance_y);
+    cells->push_back(cell);
+
+    // Cross the nearest grid line
+    if (t_max_x < t_max_y)
+    {
+      index_x += step_x;
+      t_max_x += t_delta_x;
+    }
+    else
+    {
+      index_y += step_y;
+      t_max_y += t_delta_y;
+    }
+  }
 }
 
-// Change local index into global index
-int Grid::calcGlobalIndex(const tf::StampedTransform& transform) const
+// Accumulate cost value
+void LaserScan2Costmap::Cost::accumulateCost(int occupied_inc, int free_inc)
 {
-  // Calculate index in global frame
-  int ix = (x + transform.getOrigin().x()) / g_resolution;
-  int iy = (y + transform.getOrigin().y()) / g_resolution;
+  int cost = occupied + occupied_inc - free_inc;
+  unknown = false;
 
-  // Make indexes positive value
-  int global_grid_x = (ix + 100000 * g_scan_size_x) % g_scan_size_x;
-  int global_grid_y = (iy + 100000 * g_scan_size_y) % g_scan_size_y;
+  if (cost > OCCUPIED_MAX)
+    cost = OCCUPIED_MAX;
 
-  int global_index = global_grid_x + global_grid_y * g_scan_size_x;
+  if (cost < OCCUPIED_MIN)
+    cost = OCCUPIED_MIN;
 
-  return global_index;
+  occupied = cost;
 }
 
-int calcGlobalIndex(int grid_x, int grid_y, const tf::StampedTransform& transform)
+LaserScan2Costmap::LaserScan2Costmap(double resolution, int scan_size_x, int scan_size_y, int map_size_x,
+                                     int map_size_y)
+  : resolution_(resolution)
+  , scan_size_x_(scan_size_x)
+  , scan_size_y_(scan_size_y)
+  , map_size_x_(map_size_x)
+  , map_size_y_(map_size_y)
+  , precasted_angle_increment_(0)
+  , laser_offset_(0)
+  , cost_map_(scan_size_x * scan_size_y)
+  , initialized_(false)
+  , prev_x_(0)
+  , prev_y_(0)
+  , global_x_(scan_size_x)
+  , global_y_(scan_size_y)
+  , row_band_(scan_size_y)
+  , dirty_x_(scan_size_x)
+  , dirty_y_(scan_size_y)
 {
-  // Point coordinate in velodyne(local) frame
-  double local_x = (grid_x - g_scan_size_x / 2.0) * g_resolution;
-  double local_y = (grid_y - g_scan_size_y / 2.0) * g_resolution;
-
-  // Calculate index in global coordinate
-  int ix = (local_x + transform.getOrigin().x()) / g_resolution;
-  int iy = (local_y + transform.getOrigin().y()) / g_resolution;
-
-  // Make indexes positive value
-  int global_grid_x = (ix + 100000 * g_scan_size_x) % g_scan_size_x;
-  int global_grid_y = (iy + 100000 * g_scan_size_y) % g_scan_size_y;
-
-  int global_index = global_grid_x + global_grid_y * g_scan_size_x;
+}
 
-  return global_index;
+const nav_msgs::OccupancyGrid& LaserScan2Costmap::getMap() const
+{
+  return map_;
 }
 
-void preCasting(const sensor_msgs::LaserScan& scan, std::vector<std::vector<Grid>>* precasted_grids)
+// Cast every angle of the scan once, again only when the scan geometry changes
+void LaserScan2Costmap::preCasting(const sensor_msgs::LaserScan& scan)
 {
   int iangle_size = 2 * M_PI / scan.angle_increment;
-  // We decide if a grid is passed by laser by this search_step
-  double search_step = g_resolution / 10.0;
-
-  // Grid indexes for each laser
-  std::vector<std::vector<int>> grid_indexes(iangle_size);
+  precasted_grids_.resize(iangle_size);
 
   for (int iangle = 0; iangle < iangle_size; iangle++)
   {
     // Angle of each laser from Lidar
-    double angle = scan.angle_increment * iangle;  // + scan.angle_min;
-    double step = 0;
-
-    while (1)
-    {
-      step += search_step;
+    double angle = scan.angle_increment * iangle;
+    castBeam(angle, resolution_, scan_size_x_, scan_size_y_, &precasted_grids_[iangle]);
+  }
 
-      // Calculate a grid index passed by laser scan
-      int grid_x = step * cos(angle) / g_resolution + g_scan_size_x / 2.0;
-      int grid_y = step * sin(angle) / g_resolution + g_scan_size_y / 2.0;
+  precasted_angle_increment_ = scan.angle_increment;
+  laser_offset_ = fabs(scan.angle_min);
+}
 
-      if (grid_x >= g_scan_size_x || grid_x < 0 || grid_y >= g_scan_size_y || grid_y < 0)
-        break;
+// Delete old cost values, returns true if any cell was reset
+bool LaserScan2Costmap::deleteOldData(double current_x, double current_y)
+{
+  double begin_x = current_x;
+  double begin_y = current_y;
+  double end_x = prev_x_;
+  double end_y = prev_y_;
 
-      grid_indexes[iangle].push_back(grid_x + grid_y * g_scan_size_x);
-    }
-  }
+  if (begin_x > end_x)
+    std::swap(begin_x, end_x);
+  if (begin_y > end_y)
+    std::swap(begin_y, end_y);
 
-  // Erase overlapping values
-  auto unique_grid_indexes = grid_indexes;
-  for (auto& vec : unique_grid_indexes)
-    vec.erase(std::unique(vec.begin(), vec.end()), vec.end());
+  int ibegin_x = begin_x / resolution_ + scan_size_x_ / 2;
+  int ibegin_y = begin_y / resolution_ + scan_size_y_ / 2;
+  int iend_x = end_x / resolution_ + scan_size_x_ / 2;
+  int iend_y = end_y / resolution_ + scan_size_y_ / 2;
 
-  // Max size of step counts
-  // Precated laser steps for each grid are less than this value
-  // int max_count = g_resolution / search_step * sqrt(2) + 1;
+  for (int i = ibegin_x; i < iend_x; i++)
+  {
+    int global_grid_x = (i + 100000 * scan_size_x_) % scan_size_x_;
+    for (int j = 0; j < scan_size_y_; j++)
+      cost_map_[global_grid_x + j * scan_size_x_] = Cost();
+  }
 
-  for (int i = 0; i < iangle_size; i++)
+  for (int i = 0; i < scan_size_x_; i++)
   {
-    // Push grid indexes for each laser
-    // Each index has weight which is decided by passing laser rate
-    for (const auto& unique_index : unique_grid_indexes[i])
+    for (int j = ibegin_y; j < iend_y; j++)
     {
-      Grid g;
-      g.index = unique_index;
-      // g.weight = 1.0 * std::count(grid_indexes[i].begin(), grid_indexes[i].end(), unique_index) / max_count;
-      g.calcCoordinate();
-      g.calcRange();
-      precasted_grids->at(i).push_back(g);
+      int global_grid_y = (j + 100000 * scan_size_y_) % scan_size_y_;
+      cost_map_[i + global_grid_y * scan_size_x_] = Cost();
     }
   }
-}
 
+  return ibegin_x < iend_x || ibegin_y < iend_y;
+}
 
-// Delete old cost values
-void deleteOldData(std::vector<Cost>* cost_map, double current_x, double current_y, double prev_x, double prev_y)
+// Change local indexes into ring buffer indexes, one column and one row at a time since the
+// global index of a grid only depends on its own column or row and the sensor position
+void LaserScan2Costmap::calcGlobalIndexTables(const tf::Transform& sensor_pose)
 {
-  double begin_x = current_x;
-  double begin_y = current_y;
-  double end_x = prev_x;
-  double end_y = prev_y;
+  for (int i = 0; i < scan_size_x_; i++)
+  {
+    double x = (i - scan_size_x_ / 2.0) * resolution_;
+    int ix = (x + sensor_pose.getOrigin().x()) / resolution_;
+    global_x_[i] = (ix + 100000 * scan_size_x_) % scan_size_x_;
+  }
 
-  if (begin_x > end_x)
-    std::swap(begin_x, end_x);
-  if (begin_y > end_y)
-    std::swap(begin_y, end_y);
+  for (int i = 0; i < scan_size_y_; i++)
+  {
+    double y = (i - scan_size_y_ / 2.0) * resolution_;
+    int iy = (y + sensor_pose.getOrigin().y()) / resolution_;
+    global_y_[i] = (iy + 100000 * scan_size_y_) % scan_size_y_;
+  }
+}
 
-  int ibegin_x = begin_x / g_resolution + g_scan_size_x / 2;
-  int ibegin_y = begin_y / g_resolution + g_scan_size_y / 2;
-  int iend_x = end_x / g_resolution + g_scan_size_x / 2;
-  int iend_y = end_y / g_resolution + g_scan_size_y / 2;
+// Accumulate the costs of every beam, in parallel over bands of rows. The costs saturate, so each cell
+// still receives the beams in scan order: a cell is only updated by the thread owning its row.
+void LaserScan2Costmap::accumulateBeams()
+{
+  int band_count = 1;
+#ifdef _OPENMP
+  band_count = omp_get_max_threads();
+#endif
+
+  // Several local rows may fall on one ring buffer row, a band never splits them
+  std::vector<int> band_begin(1, 0);
+  for (int band = 1; band < band_count; band++)
+  {
+    int row = std::max(band_begin.back() + 1, band * scan_size_y_ / band_count);
+    while (row < scan_size_y_ && global_y_[row] == global_y_[row - 1])
+      row++;
+    if (row < scan_size_y_)
+      band_begin.push_back(row);
+  }
+  band_begin.push_back(scan_size_y_);
 
-  for (int i = ibegin_x; i < iend_x; i++)
+  // Rows wrapping around the ring buffer could still be shared by two bands
+  std::fill(row_band_.begin(), row_band_.end(), -1);
+  bool shared_row = false;
+  for (size_t band = 0; band + 1 < band_begin.size(); band++)
   {
-    for (int j = 0; j < g_scan_size_y; j++)
+    for (int i = band_begin[band]; i < band_begin[band + 1]; i++)
     {
-      int global_grid_x = (i + 100000 * g_scan_size_x) % g_scan_size_x;
-      cost_map->at(global_grid_x + j * g_scan_size_x).occupied = 0;
-      cost_map->at(global_grid_x + j * g_scan_size_x).free     = 0;
-      cost_map->at(global_grid_x + j * g_scan_size_x).unknown  = true;
+      int& owner = row_band_[global_y_[i]];
+      shared_row = shared_row || (owner >= 0 && owner != static_cast<int>(band));
+      owner = band;
     }
   }
+  if (shared_row)
+    band_begin = { 0, scan_size_y_ };
 
-  for (int i = 0; i < g_scan_size_x; i++)
+  const int bands = band_begin.size() - 1;
+#pragma omp parallel for schedule(dynamic, 1)
+  for (int band = 0; band < bands; band++)
   {
-    for (int j = ibegin_y; j < iend_y; j++)
+    const int begin_y = band_begin[band];
+    const int end_y = band_begin[band + 1];
+
+    for (const BeamUpdate& beam : beam_updates_)
     {
-      int global_grid_y = (j + 100000 * g_scan_size_y) % g_scan_size_y;
-      cost_map->at(i + global_grid_y * g_scan_size_x).occupied = 0;
-      cost_map->at(i + global_grid_y * g_scan_size_x).free     = 0;
-      cost_map->at(i + global_grid_y * g_scan_size_x).unknown  = true;
+      const std::vector<BeamCell>& cells = *beam.cells;
+      auto cells_end = cells.begin() + beam.obstacle + 1;
+
+      // Rows are monotonic along a beam, so its cells in the band are consecutive
+      std::vector<BeamCell>::const_iterator first, last;
+      if (cells.back().index_y >= cells.front().index_y)
+      {
+        first = std::partition_point(cells.begin(), cells_end,
+                                     [begin_y](const BeamCell& c) { return c.index_y < begin_y; });
+        last = std::partition_point(first, cells_end, [end_y](const BeamCell& c) { return c.index_y < end_y; });
+      }
+      else
+      {
+        first = std::partition_point(cells.begin(), cells_end,
+                                     [end_y](const BeamCell& c) { return c.index_y >= end_y; });
+        last = std::partition_point(first, cells_end, [begin_y](const BeamCell& c) { return c.index_y >= begin_y; });
+      }
+
+      // Free range
+      last = std::min(last, cells.begin() + beam.free_count);
+      for (auto it = first; it < last; ++it)
+        cost_map_[global_x_[it->index_x] + global_y_[it->index_y] * scan_size_x_].accumulateCost(0, FREE_INCREMENT);
+
+      // Obstacle
+      const BeamCell& obstacle = cells[beam.obstacle];
+      if (obstacle.index_y >= begin_y && obstacle.index_y < end_y)
+        cost_map_[global_x_[obstacle.index_x] + global_y_[obstacle.index_y] * scan_size_x_].accumulateCost(
+            OCCUPIED_INCREMENT, 0);
     }
   }
 }
 
-void setOccupancyGridMap(nav_msgs::OccupancyGrid* map, const std_msgs::Header& header,
-                         const tf::StampedTransform& transform)
+void LaserScan2Costmap::setOccupancyGridMap(const std_msgs::Header& header, const tf::Transform& sensor_pose)
 {
-  map->header.stamp = header.stamp;
-  map->header.frame_id = OGM_FRAME;
-  map->info.map_load_time = header.stamp;
-  map->info.resolution = g_resolution;
-  map->info.height = g_map_size_y;
-  map->info.width = g_map_size_x;
-  map->info.origin.position.x = transform.getOrigin().x() - (g_map_size_x / 2) * g_resolution;
-  map->info.origin.position.y = transform.getOrigin().y() - (g_map_size_y / 2) * g_resolution;
-  map->info.origin.position.z = transform.getOrigin().z() - 5;
-  map->info.origin.orientation.x = 0;
-  map->info.origin.orientation.y = 0;
-  map->info.origin.orientation.z = 0;
-  map->info.origin.orientation.w = 1;
+  map_.header.stamp = header.stamp;
+  map_.header.frame_id = OGM_FRAME;
+  map_.info.map_load_time = header.stamp;
+  map_.info.resolution = resolution_;
+  map_.info.height = map_size_y_;
+  map_.info.width = map_size_x_;
+  map_.info.origin.position.x = sensor_pose.getOrigin().x() - (map_size_x_ / 2) * resolution_;
+  map_.info.origin.position.y = sensor_pose.getOrigin().y() - (map_size_y_ / 2) * resolution_;
+  map_.info.origin.position.z = sensor_pose.getOrigin().z() - 5;
+  map_.info.origin.orientation.x = 0;
+  map_.info.origin.orientation.y = 0;
+  map_.info.origin.orientation.z = 0;
+  map_.info.origin.orientation.w = 1;
 }
 
-void createCostMap(const sensor_msgs::LaserScan& scan, const std::vector<std::vector<Grid>>& precasted_grids)
+// Set cost values for publishing OccuppancyGridMap, when the sensor stayed in the same ring buffer cell only
+// the rows and columns touched by the scan can change
+void LaserScan2Costmap::publishCells(bool full_update)
 {
-  tf::StampedTransform transform;
+  // Begining of grid index of publishing OGM
+  const int origin_index_x = (scan_size_x_ - map_size_x_) / 2.0;
+  const int origin_index_y = (scan_size_y_ - map_size_y_) / 2.0;
+
+  full_update = full_update || global_x_ != published_global_x_ || global_y_ != published_global_y_;
+
+  std::fill(dirty_x_.begin(), dirty_x_.end(), full_update);
+  std::fill(dirty_y_.begin(), dirty_y_.end(), full_update);
+  if (!full_update && !beam_updates_.empty())
+  {
+    for (int i = touched_min_x_; i <= touched_max_x_; i++)
+      dirty_x_[global_x_[i]] = true;
+    for (int i = touched_min_y_; i <= touched_max_y_; i++)
+      dirty_y_[global_y_[i]] = true;
+  }
 
-  try
+  dirty_columns_.clear();
+  for (int j = 0; j < map_size_x_; j++)
   {
-    // What time should we use?
-    g_tf_listenerp->lookupTransform(OGM_FRAME, g_sensor_frame, ros::Time(0), transform);
+    if (dirty_x_[global_x_[origin_index_x + j]])
+      dirty_columns_.push_back(j);
   }
-  catch (tf::TransformException ex)
+
+  for (int i = 0; i < map_size_y_; i++)
   {
-    ROS_ERROR("%s", ex.what());
-    return;
+    const int global_y = global_y_[origin_index_y + i];
+    if (!dirty_y_[global_y])
+      continue;
+
+    const Cost* cost_row = &cost_map_[global_y * scan_size_x_];
+    int8_t* map_row = &map_.data[i * map_size_x_];
+    for (int j : dirty_columns_)
+    {
+      const Cost& cost = cost_row[global_x_[origin_index_x + j]];
+      map_row[j] = cost.unknown ? -1 : (cost.occupied + 8) * 6;
+    }
   }
 
-  // Save costs in this variable
-  static std::vector<Cost> cost_map(g_scan_size_x * g_scan_size_y);
+  published_global_x_ = global_x_;
+  published_global_y_ = global_y_;
+}
 
-  static bool initialized_map = false;
-  static double prev_x = transform.getOrigin().x();
-  static double prev_y = transform.getOrigin().y();
-  static nav_msgs::OccupancyGrid map;
-  setOccupancyGridMap(&map, scan.header, transform);
-  if (!initialized_map)
+void LaserScan2Costmap::update(const sensor_msgs::LaserScan& scan, const tf::Transform& sensor_pose)
+{
+  if (precasted_grids_.empty() || scan.angle_increment != precasted_angle_increment_ ||
+      fabs(scan.angle_min) != laser_offset_)
+    preCasting(scan);
+
+  const double current_x = sensor_pose.getOrigin().x();
+  const double current_y = sensor_pose.getOrigin().y();
+
+  setOccupancyGridMap(scan.header, sensor_pose);
+  bool full_update = !initialized_;
+  if (!initialized_)
   {
-    map.data.resize(g_map_size_x * g_map_size_y, -1);
-    initialized_map = true;
+    map_.data.assign(map_size_x_ * map_size_y_, -1);
+    prev_x_ = current_x;
+    prev_y_ = current_y;
+    initialized_ = true;
   }
 
   // Since we implement as ring buffer, we have to delete old data regularly
-  deleteOldData(&cost_map, transform.getOrigin().x(), transform.getOrigin().y(), prev_x, prev_y);
-  prev_x = transform.getOrigin().x();
-  prev_y = transform.getOrigin().y();
+  if (deleteOldData(current_x, current_y))
+    full_update = true;
+  prev_x_ = current_x;
+  prev_y_ = current_y;
+
+  calcGlobalIndexTables(sensor_pose);
 
   // Vehicle's orientation
-  double yaw = calcYawFromQuaternion(transform.getRotation());
+  double yaw = calcYawFromQuaternion(sensor_pose.getRotation());
 
   // Original yaw is -PI ~ PI, so make its range 0 ~ 2PI
   if (yaw < 0)
     yaw += 2 * M_PI;
-  static double laser_offset = fabs(scan.angle_min);
 
-  // For tough_urg
-  // static double manual_offset = -10.0 / 180 * M_PI + M_PI;
-  // int index_offset = (yaw + laser_offset + manual_offset) / scan.angle_increment;
-
-  int index_offset = (yaw + laser_offset) / scan.angle_increment;
-  static int iangle_size = 2 * M_PI / scan.angle_increment;
+  int index_offset = (yaw + laser_offset_) / scan.angle_increment;
+  int iangle_size = precasted_grids_.size();
 
   //----------------- RING OCCUPANCY GRID MAPPING --------------
-  // Accumulate grid costs for each laser scan
+  beam_updates_.clear();
+  std::vector<double> ranges;
   for (size_t i = 0; i < scan.ranges.size(); i++)
   {
     double range = scan.ranges[i];
@@ -321,95 +412,46 @@ void createCostMap(const sensor_msgs::LaserScan& scan, const std::vector<std::ve
     if (scan.ranges[i] > scan.range_max)
       range = scan.range_max;
 
-    int precasted_index = (i + index_offset) % iangle_size;
-    int obstacle_index = -1;
-    for (const auto& g : precasted_grids[precasted_index])
-    {
-      obstacle_index++;
-
-      if (g.range > range)
-        break;
-
-      // Free range
-      int global_index = g.calcGlobalIndex(transform);
-      cost_map[global_index].accumulateCost(0, FREE_INCREMENT);
-    }
-
-    // Obstacle
-    int global_index = precasted_grids[precasted_index][obstacle_index].calcGlobalIndex(transform);
-    cost_map[global_index].accumulateCost(OCCUPIED_INCREMENT, 0);
+    const std::vector<BeamCell>& cells = precasted_grids_[(i + index_offset) % iangle_size];
+    if (cells.empty())
+      continue;
 
+    BeamUpdate beam;
+    beam.cells = &cells;
+    beam_updates_.push_back(beam);
+    ranges.push_back(range);
   }
 
-
-  // Begining of grid index of publishing OGM
-  static int origin_index_x = (g_scan_size_x - g_map_size_x) / 2.0;
-  static int origin_index_y = (g_scan_size_y - g_map_size_y) / 2.0;
-  // static int origin_index = origin_index_x + origin_index_y * g_scan_size_x;
-
-  // Set cost values for publishing OccuppancyGridMap
-  for (int i = 0; i < g_map_size_y; i++)
+  // Free cells of each beam end at the first grid farther than the range, which is the obstacle
+  const int beam_count = beam_updates_.size();
+#pragma omp parallel for schedule(static)
+  for (int i = 0; i < beam_count; i++)
   {
-    for (int j = 0; j < g_map_size_x; j++)
-    {
-      int scanmap_index_x = origin_index_x + j;
-      int scanmap_index_y = origin_index_y + i;
-
-      int global_index = calcGlobalIndex(scanmap_index_x, scanmap_index_y, transform);
-      if (cost_map[global_index].unknown)
-        map.data[j + i * g_map_size_x] = -1;
-      else
-        map.data[j + i * g_map_size_x] = (cost_map[global_index].occupied + 8) * 6;
-    }
+    const std::vector<BeamCell>& cells = *beam_updates_[i].cells;
+    int free_count = 0;
+    while (free_count < static_cast<int>(cells.size()) && cells[free_count].range <= ranges[i])
+      free_count++;
+    beam_updates_[i].free_count = free_count;
+    beam_updates_[i].obstacle = std::min(free_count, static_cast<int>(cells.size()) - 1);
   }
 
-  g_map_pub.publish(map);
-}
-
-// Make CostMap from LaserScan message
-void laserScanCallback(const sensor_msgs::LaserScanConstPtr& msg)
-{
-  static bool precasted = false;
-  static int iangle_size = 2 * M_PI / msg->angle_increment;
-  static std::vector<std::vector<Grid>> precasted_grids(iangle_size);
-
-  if (!precasted)
+  // Bounding box of the touched cells, the ends of each beam since beams are straight
+  touched_min_x_ = touched_min_y_ = std::numeric_limits<int>::max();
+  touched_max_x_ = touched_max_y_ = std::numeric_limits<int>::min();
+  for (const BeamUpdate& beam : beam_updates_)
   {
-    preCasting(*msg, &precasted_grids);
-    precasted = true;
+    for (const BeamCell& end : { beam.cells->front(), (*beam.cells)[beam.obstacle] })
+    {
+      touched_min_x_ = std::min(touched_min_x_, end.index_x);
+      touched_max_x_ = std::max(touched_max_x_, end.index_x);
+      touched_min_y_ = std::min(touched_min_y_, end.index_y);
+      touched_max_y_ = std::max(touched_max_y_, end.index_y);
+    }
   }
 
-  // Create costmap and publish
-  createCostMap(*msg, precasted_grids);
+  accumulateBeams();
 
-  return;
+  publishCells(full_update);
 }
 
-}  // namespace
-
-int main(int argc, char** argv)
-{
-  ros::init(argc, argv, "laserscan2costmap");
-
-  tf::TransformListener tf_listener;
-  g_tf_listenerp = &tf_listener;
-
-  ros::NodeHandle nh;
-  ros::NodeHandle private_nh("~");
-
-  private_nh.param<double>("resolution", g_resolution, 0.1);
-  private_nh.param<int>("scan_size_x", g_scan_size_x, 1000);
-  private_nh.param<int>("scan_size_y", g_scan_size_y, 1000);
-  private_nh.param<int>("map_size_x", g_map_size_x, 500);
-  private_nh.param<int>("map_size_y", g_map_size_y, 500);
-  private_nh.param<std::string>("scan_topic", g_scan_topic, "/scan");
-  private_nh.param<std::string>("sensor_frame", g_sensor_frame, "/velodyne");
-
-  ros::Subscriber laserscan_sub = nh.subscribe(g_scan_topic, 1, laserScanCallback);
-
-  g_map_pub = nh.advertise<nav_msgs::OccupancyGrid>("/ring_ogm", 1);
-
-  ros::spin();
-
-  return 0;
-}
+}  // namespace object_map
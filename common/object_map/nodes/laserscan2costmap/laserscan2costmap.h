@@ -0,0 +1,115 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef LASERSCAN2COSTMAP_H
+#define LASERSCAN2COSTMAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <nav_msgs/OccupancyGrid.h>
+#include <sensor_msgs/LaserScan.h>
+#include <tf/transform_datatypes.h>
+
+namespace object_map
+{
+// Cell of the scan grid crossed by a laser beam
+struct BeamCell
+{
+  int index_x;
+  int index_y;
+  double range;  // distance of the cell from the sensor [m]
+};
+
+// Cells of the scan grid crossed by a ray cast from the grid center, in order, until the ray leaves the grid.
+// The grid lines are traversed exactly (Amanatides & Woo), so every crossed cell is listed once.
+void castBeam(double angle, double resolution, int scan_size_x, int scan_size_y, std::vector<BeamCell>* cells);
+
+// Ring buffer occupancy grid accumulated from laser scans around the sensor
+class LaserScan2Costmap
+{
+public:
+  LaserScan2Costmap(double resolution, int scan_size_x, int scan_size_y, int map_size_x, int map_size_y);
+
+  // Accumulate a scan taken at sensor_pose, given in the map frame, and update the published grid
+  void update(const sensor_msgs::LaserScan& scan, const tf::Transform& sensor_pose);
+
+  const nav_msgs::OccupancyGrid& getMap() const;
+
+private:
+  // Saturated occupancy of a ring buffer cell, kept small so that the whole buffer stays in cache
+  struct Cost
+  {
+    int8_t occupied = 0;
+    bool unknown = true;
+
+    void accumulateCost(int occupied_inc, int free_inc);
+  };
+
+  // Free cells and obstacle cell of a beam of the current scan
+  struct BeamUpdate
+  {
+    const std::vector<BeamCell>* cells;
+    int free_count;
+    int obstacle;
+  };
+
+  void preCasting(const sensor_msgs::LaserScan& scan);
+  bool deleteOldData(double current_x, double current_y);
+  void calcGlobalIndexTables(const tf::Transform& sensor_pose);
+  void accumulateBeams();
+  void setOccupancyGridMap(const std_msgs::Header& header, const tf::Transform& sensor_pose);
+  void publishCells(bool full_update);
+
+  double resolution_;
+  int scan_size_x_;
+  int scan_size_y_;
+  int map_size_x_;
+  int map_size_y_;
+
+  // Traversed cells of each precasted angle, and the scan geometry they were cast for
+  std::vector<std::vector<BeamCell>> precasted_grids_;
+  double precasted_angle_increment_;
+  double laser_offset_;
+
+  std::vector<Cost> cost_map_;
+  bool initialized_;
+  double prev_x_;
+  double prev_y_;
+
+  // Ring buffer column and row of every scan grid column and row for the current sensor position,
+  // the map only translates with the sensor
+  std::vector<int> global_x_;
+  std::vector<int> global_y_;
+
+  std::vector<BeamUpdate> beam_updates_;
+  std::vector<int> row_band_;
+  // Scan grid cells touched by the current scan
+  int touched_min_x_, touched_max_x_, touched_min_y_, touched_max_y_;
+
+  nav_msgs::OccupancyGrid map_;
+  // Tables of the last published grid, unchanged tables allow to only refresh the touched cells
+  std::vector<int> published_global_x_;
+  std::vector<int> published_global_y_;
+  std::vector<char> dirty_x_;
+  std::vector<char> dirty_y_;
+  std::vector<int> dirty_columns_;
+};
+
+}  // namespace object_map
+
+#endif  // LASERSCAN2COSTMAP_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string>
+
+#include <ros/ros.h>
+#include <sensor_msgs/LaserScan.h>
+#include <tf/transform_listener.h>
+#include <nav_msgs/OccupancyGrid.h>
+
+#include "laserscan2costmap.h"
+
+namespace
+{
+constexpr auto OGM_FRAME = "/map";
+
+class LaserScan2CostmapNode
+{
+public:
+  LaserScan2CostmapNode(ros::NodeHandle& nh, const std::string& scan_topic, const std::string& sensor_frame,
+                        object_map::LaserScan2Costmap* costmap)
+    : sensor_frame_(sensor_frame), costmap_(costmap)
+  {
+    laserscan_sub_ = nh.subscribe(scan_topic, 1, &LaserScan2CostmapNode::laserScanCallback, this);
+    map_pub_ = nh.advertise<nav_msgs::OccupancyGrid>("/ring_ogm", 1);
+  }
+
+private:
+  // Make CostMap from LaserScan message
+  void laserScanCallback(const sensor_msgs::LaserScanConstPtr& msg)
+  {
+    tf::StampedTransform transform;
+
+    try
+    {
+      // What time should we use?
+      tf_listener_.lookupTransform(OGM_FRAME, sensor_frame_, ros::Time(0), transform);
+    }
+    catch (tf::TransformException ex)
+    {
+      ROS_ERROR("%s", ex.what());
+      return;
+    }
+
+    // Create costmap and publish
+    costmap_->update(*msg, transform);
+    map_pub_.publish(costmap_->getMap());
+  }
+
+  std::string sensor_frame_;
+  object_map::LaserScan2Costmap* costmap_;
+  tf::TransformListener tf_listener_;
+  ros::Subscriber laserscan_sub_;
+  ros::Publisher map_pub_;
+};
+}  // namespace
+
+int main(int argc, char** argv)
+{
+  ros::init(argc, argv, "laserscan2costmap");
+
+  ros::NodeHandle nh;
+  ros::NodeHandle private_nh("~");
+
+  double resolution;             // [m]
+  int scan_size_x, scan_size_y;  // actual scanning size
+  int map_size_x, map_size_y;    // publishing occupancy grid map size
+  std::string scan_topic;        // laser scan topic
+  std::string sensor_frame;      // sensor which publihes lasescan message
+  private_nh.param<double>("resolution", resolution, 0.1);
+  private_nh.param<int>("scan_size_x", scan_size_x, 1000);
+  private_nh.param<int>("scan_size_y", scan_size_y, 1000);
+  private_nh.param<int>("map_size_x", map_size_x, 500);
+  private_nh.param<int>("map_size_y", map_size_y, 500);
+  private_nh.param<std::string>("scan_topic", scan_topic, "/scan");
+  private_nh.param<std::string>("sensor_frame", sensor_frame, "/velodyne");
+
+  object_map::LaserScan2Costmap costmap(resolution, scan_size_x, scan_size_y, map_size_x, map_size_y);
+  LaserScan2CostmapNode node(nh, scan_topic, sensor_frame, &costmap);
+
+  ros::spin();
+
+  return 0;
+}
@@ -0,0 +1,386 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "laserscan2costmap.h"
+
+using object_map::BeamCell;
+
+namespace
+{
+// The previous laserscan2costmap, with its statics as members and the precasted table as a parameter
+class PreviousCostmap
+{
+public:
+  PreviousCostmap(double resolution, int scan_size_x, int scan_size_y, int map_size_x, int map_size_y)
+    : g_resolution(resolution)
+    , g_scan_size_x(scan_size_x)
+    , g_scan_size_y(scan_size_y)
+    , g_map_size_x(map_size_x)
+    , g_map_size_y(map_size_y)
+    , cost_map(scan_size_x * scan_size_y)
+  {
+  }
+
+  struct Grid
+  {
+    int index;
+    int index_x, index_y;
+    double x, y;
+    double range;
+  };
+
+  struct Cost
+  {
+    int occupied = 0;
+    int free = 0;
+    bool unknown = true;
+
+    void accumulateCost(int occupied_inc, int free_inc)
+    {
+      occupied += occupied_inc - free_inc;
+      free += free_inc;
+      unknown = false;
+      if (occupied > 8)
+        occupied = 8;
+      if (occupied < -8)
+        occupied = -8;
+    }
+  };
+
+  Grid makeGrid(int index) const
+  {
+    Grid g;
+    g.index = index;
+    g.index_x = index % g_scan_size_x;
+    g.index_y = (index - g.index_x) / g_scan_size_x;
+    g.x = (g.index_x - g_scan_size_x / 2.0) * g_resolution;
+    g.y = (g.index_y - g_scan_size_y / 2.0) * g_resolution;
+    double distance_x = g_resolution * fabs(g_scan_size_x / 2 - g.index_x);
+    double distance_y = g_resolution * fabs(g_scan_size_y / 2 - g.index_y);
+    g.range = sqrt(distance_x * distance_x + distance_y * distance_y);
+    return g;
+  }
+
+  // The previous sampling of each beam at a tenth of the resolution
+  void preCastingBySampling(const sensor_msgs::LaserScan& scan)
+  {
+    int iangle_size = 2 * M_PI / scan.angle_increment;
+    double search_step = g_resolution / 10.0;
+    precasted_grids.assign(iangle_size, std::vector<Grid>());
+    for (int iangle = 0; iangle < iangle_size; iangle++)
+    {
+      double angle = scan.angle_increment * iangle;
+      double step = 0;
+      std::vector<int> indexes;
+      while (1)
+      {
+        step += search_step;
+        int grid_x = step * cos(angle) / g_resolution + g_scan_size_x / 2.0;
+        int grid_y = step * sin(angle) / g_resolution + g_scan_size_y / 2.0;
+        if (grid_x >= g_scan_size_x || grid_x < 0 || grid_y >= g_scan_size_y || grid_y < 0)
+          break;
+        indexes.push_back(grid_x + grid_y * g_scan_size_x);
+      }
+      indexes.erase(std::unique(indexes.begin(), indexes.end()), indexes.end());
+      for (int index : indexes)
+        precasted_grids[iangle].push_back(makeGrid(index));
+    }
+    setScanGeometry(scan);
+  }
+
+  void preCastingByTraversal(const sensor_msgs::LaserScan& scan)
+  {
+    int iangle_size = 2 * M_PI / scan.angle_increment;
+    precasted_grids.assign(iangle_size, std::vector<Grid>());
+    std::vector<BeamCell> cells;
+    for (int iangle = 0; iangle < iangle_size; iangle++)
+    {
+      object_map::castBeam(scan.angle_increment * iangle, g_resolution, g_scan_size_x, g_scan_size_y, &cells);
+      for (const BeamCell& c : cells)
+        precasted_grids[iangle].push_back(makeGrid(c.index_x + c.index_y * g_scan_size_x));
+    }
+    setScanGeometry(scan);
+  }
+
+  int calcGlobalIndex(double x, double y, const tf::Transform& transform) const
+  {
+    int ix = (x + transform.getOrigin().x()) / g_resolution;
+    int iy = (y + transform.getOrigin().y()) / g_resolution;
+    int global_grid_x = (ix + 100000 * g_scan_size_x) % g_scan_size_x;
+    int global_grid_y = (iy + 100000 * g_scan_size_y) % g_scan_size_y;
+    return global_grid_x + global_grid_y * g_scan_size_x;
+  }
+
+  void deleteOldData(double current_x, double current_y)
+  {
+    double begin_x = current_x, begin_y = current_y, end_x = prev_x, end_y = prev_y;
+    if (begin_x > end_x)
+      std::swap(begin_x, end_x);
+    if (begin_y > end_y)
+      std::swap(begin_y, end_y);
+    int ibegin_x = begin_x / g_resolution + g_scan_size_x / 2;
+    int ibegin_y = begin_y / g_resolution + g_scan_size_y / 2;
+    int iend_x = end_x / g_resolution + g_scan_size_x / 2;
+    int iend_y = end_y / g_resolution + g_scan_size_y / 2;
+    for (int i = ibegin_x; i < iend_x; i++)
+      for (int j = 0; j < g_scan_size_y; j++)
+        cost_map.at((i + 100000 * g_scan_size_x) % g_scan_size_x + j * g_scan_size_x) = Cost();
+    for (int i = 0; i < g_scan_size_x; i++)
+      for (int j = ibegin_y; j < iend_y; j++)
+        cost_map.at(i + (j + 100000 * g_scan_size_y) % g_scan_size_y * g_scan_size_x) = Cost();
+  }
+
+  void createCostMap(const sensor_msgs::LaserScan& scan, const tf::Transform& transform)
+  {
+    if (!initialized_map)
+    {
+      map.data.resize(g_map_size_x * g_map_size_y, -1);
+      prev_x = transform.getOrigin().x();
+      prev_y = transform.getOrigin().y();
+      initialized_map = true;
+    }
+    deleteOldData(transform.getOrigin().x(), transform.getOrigin().y());
+    prev_x = transform.getOrigin().x();
+    prev_y = transform.getOrigin().y();
+
+    tf::Matrix3x3 m(transform.getRotation());
+    double roll, pitch, yaw;
+    m.getRPY(roll, pitch, yaw);
+    if (yaw < 0)
+      yaw += 2 * M_PI;
+
+    int index_offset = (yaw + laser_offset) / scan.angle_increment;
+    for (size_t i = 0; i < scan.ranges.size(); i++)
+    {
+      double range = scan.ranges[i];
+      if (range == 0)
+        continue;
+      if (scan.ranges[i] > scan.range_max)
+        range = scan.range_max;
+
+      int precasted_index = (i + index_offset) % iangle_size;
+      int obstacle_index = -1;
+      for (const auto& g : precasted_grids[precasted_index])
+      {
+        obstacle_index++;
+        if (g.range > range)
+          break;
+        cost_map[calcGlobalIndex(g.x, g.y, transform)].accumulateCost(0, 1);
+      }
+      const Grid& g = precasted_grids[precasted_index][obstacle_index];
+      cost_map[calcGlobalIndex(g.x, g.y, transform)].accumulateCost(2, 0);
+    }
+
+    int origin_index_x = (g_scan_size_x - g_map_size_x) / 2.0;
+    int origin_index_y = (g_scan_size_y - g_map_size_y) / 2.0;
+    for (int i = 0; i < g_map_size_y; i++)
+    {
+      for (int j = 0; j < g_map_size_x; j++)
+      {
+        double local_x = (origin_index_x + j - g_scan_size_x / 2.0) * g_resolution;
+        double local_y = (origin_index_y + i - g_scan_size_y / 2.0) * g_resolution;
+        int global_index = calcGlobalIndex(local_x, local_y, transform);
+        if (cost_map[global_index].unknown)
+          map.data[j + i * g_map_size_x] = -1;
+        else
+          map.data[j + i * g_map_size_x] = (cost_map[global_index].occupied + 8) * 6;
+      }
+    }
+  }
+
+  nav_msgs::OccupancyGrid map;
+
+private:
+  void setScanGeometry(const sensor_msgs::LaserScan& scan)
+  {
+    laser_offset = fabs(scan.angle_min);
+    iangle_size = 2 * M_PI / scan.angle_increment;
+  }
+
+  double g_resolution;
+  int g_scan_size_x, g_scan_size_y, g_map_size_x, g_map_size_y;
+  std::vector<std::vector<Grid>> precasted_grids;
+  std::vector<Cost> cost_map;
+  bool initialized_map = false;
+  double prev_x = 0, prev_y = 0;
+  double laser_offset = 0;
+  int iangle_size = 0;
+};
+
+sensor_msgs::LaserScan createScan(int beams, std::mt19937& gen)
+{
+  std::uniform_real_distribution<float> range(0.3f, 45.f);
+  std::uniform_real_distribution<float> event(0.f, 1.f);
+  sensor_msgs::LaserScan scan;
+  scan.angle_min = -M_PI;
+  scan.angle_increment = 2 * M_PI / beams;
+  scan.angle_max = scan.angle_min + scan.angle_increment * (beams - 1);
+  scan.range_max = 40.f;
+  for (int i = 0; i < beams; i++)
+  {
+    const float e = event(gen);
+    scan.ranges.push_back(e < 0.05f ? 0.f : (e < 0.1f ? 100.f : range(gen)));
+  }
+  return scan;
+}
+
+// Vehicle driving in a curve around the map origin, stopping for a while, sub cell moves included
+std::vector<tf::Transform> createPath(int poses)
+{
+  std::vector<tf::Transform> path;
+  double x = -3.03, y = -1.57, yaw = -2.5;
+  for (int i = 0; i < poses; i++)
+  {
+    path.push_back(tf::Transform(tf::createQuaternionFromYaw(yaw), tf::Vector3(x, y, 0.5)));
+    if (i % 10 >= 7)
+      continue;
+    x += 0.37 * cos(yaw) + (i % 3 == 0 ? 0.004 : 0);
+    y += 0.37 * sin(yaw);
+    yaw += 0.11;
+  }
+  return path;
+}
+}  // namespace
+
+TEST(TestLaserScan2Costmap, castBeamTraversesEveryCrossedCell)
+{
+  const int size_x = 200, size_y = 160;
+  const double resolution = 0.1;
+  std::vector<BeamCell> cells;
+  for (int a = 0; a < 720; a++)
+  {
+    const double angle = (a + 0.37) * M_PI / 360;
+    object_map::castBeam(angle, resolution, size_x, size_y, &cells);
+    ASSERT_FALSE(cells.empty());
+    EXPECT_EQ(cells.front().index_x, size_x / 2 - (cos(angle) < 0 ? 1 : 0));
+    EXPECT_EQ(cells.front().index_y, size_y / 2 - (sin(angle) < 0 ? 1 : 0));
+
+    // Neighbouring cells, ending on the border of the grid
+    std::set<std::pair<int, int>> traversed;
+    for (size_t i = 0; i < cells.size(); i++)
+    {
+      traversed.insert(std::make_pair(cells[i].index_x, cells[i].index_y));
+      if (i > 0)
+      {
+        ASSERT_EQ(abs(cells[i].index_x - cells[i - 1].index_x) + abs(cells[i].index_y - cells[i - 1].index_y), 1);
+      }
+    }
+    EXPECT_EQ(traversed.size(), cells.size());
+    const BeamCell& last = cells.back();
+    EXPECT_TRUE(last.index_x == 0 || last.index_x == size_x - 1 || last.index_y == 0 || last.index_y == size_y - 1);
+
+    // Every cell reached by a fine sampling of the beam is traversed
+    for (double step = 0.0001; step < 50; step += 0.0007)
+    {
+      int grid_x = std::floor(step * cos(angle) / resolution + size_x / 2.0);
+      int grid_y = std::floor(step * sin(angle) / resolution + size_y / 2.0);
+      if (grid_x >= size_x || grid_x < 0 || grid_y >= size_y || grid_y < 0)
+        break;
+      ASSERT_EQ(traversed.count(std::make_pair(grid_x, grid_y)), 1u) << angle << " " << step;
+    }
+  }
+}
+
+TEST(TestLaserScan2Costmap, sameAsPerCellTransform)
+{
+  std::mt19937 gen(0);
+  const double resolution = 0.1;
+  object_map::LaserScan2Costmap costmap(resolution, 600, 500, 300, 240);
+  PreviousCostmap previous(resolution, 600, 500, 300, 240);
+
+  int beams = 1440;
+  sensor_msgs::LaserScan scan = createScan(beams, gen);
+  previous.preCastingByTraversal(scan);
+
+  const std::vector<tf::Transform> path = createPath(60);
+  for (size_t i = 0; i < path.size(); i++)
+  {
+    // The precasted table follows a change of the scan geometry
+    if (i == 40)
+    {
+      beams = 1080;
+      scan = createScan(beams, gen);
+      previous.preCastingByTraversal(scan);
+    }
+    else
+    {
+      scan = createScan(beams, gen);
+    }
+
+    previous.createCostMap(scan, path[i]);
+    costmap.update(scan, path[i]);
+
+    const nav_msgs::OccupancyGrid& map = costmap.getMap();
+    ASSERT_EQ(map.info.width, 300u);
+    ASSERT_EQ(map.info.height, 240u);
+    ASSERT_DOUBLE_EQ(map.info.origin.position.x, path[i].getOrigin().x() - 150 * resolution);
+    ASSERT_TRUE(previous.map.data == map.data) << "scan " << i;
+  }
+}
+
+TEST(TestLaserScan2Costmap, benchmark)
+{
+  std::mt19937 gen(1);
+  const double resolution = 0.1;
+  const int beams = 2880, scans = 20;
+  std::vector<sensor_msgs::LaserScan> input;
+  for (int i = 0; i < scans; i++)
+    input.push_back(createScan(beams, gen));
+  const std::vector<tf::Transform> path = createPath(scans);
+
+  PreviousCostmap previous(resolution, 1000, 1000, 500, 500);
+  auto start = std::chrono::steady_clock::now();
+  previous.preCastingBySampling(input[0]);
+  const double previous_cast_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < scans; i++)
+    previous.createCostMap(input[i], path[i]);
+  const double previous_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / scans;
+
+  object_map::LaserScan2Costmap costmap(resolution, 1000, 1000, 500, 500);
+  start = std::chrono::steady_clock::now();
+  costmap.update(input[0], path[0]);
+  const double first_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  start = std::chrono::steady_clock::now();
+  for (int i = 1; i < scans; i++)
+    costmap.update(input[i], path[i]);
+  const double costmap_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / (scans - 1);
+
+  std::printf("[ %d beams, 1000x1000 scan grid ] previous: %7.2f ms/scan (precasting %.1f ms), "
+              "LaserScan2Costmap: %6.2f ms/scan (first scan with precasting %.1f ms)\n",
+              beams, previous_msec, previous_cast_msec, costmap_msec, first_msec);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
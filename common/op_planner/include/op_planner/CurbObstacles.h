@@ -0,0 +1,67 @@
+
+/// \file CurbObstacles.h
+/// \brief Grid index over the map curbs, extracts the curbs near the vehicle as obstacles without visiting the whole map
+/// \date Oct 18, 2026
+
+
+
+#ifndef CURBOBSTACLES_H_
+#define CURBOBSTACLES_H_
+
+#include <vector>
+#include "RoadNetwork.h"
+
+
+namespace PlannerHNS {
+
+class CurbObstacles
+{
+public:
+	CurbObstacles();
+	virtual ~CurbObstacles();
+
+	/**
+	 * @brief Builds the index and the obstacle of each curb, called once after the map is loaded
+	 * @param curbs map curbs, curbs without points are ignored
+	 * @param cellSize minimum grid cell size in meters, it grows for large sparse maps to bound the number of cells
+	 */
+	void SetCurbs(const std::vector<Curb>& curbs, const double& cellSize = 10.0);
+
+	void Clear();
+
+	/**
+	 * @brief Curbs with the first point within horizon of currPos, in map order, skipping a curb closer than
+	 * minDistanceBetweenCurbs to the previously selected one
+	 * @param obstacles only rewritten when the selection differs from the previous call
+	 * @return true if obstacles changed
+	 */
+	bool GetObstacles(const WayPoint& currPos, const double& horizon, const double& minDistanceBetweenCurbs,
+			std::vector<DetectedObject>& obstacles);
+
+	unsigned int GetCurbsCount() const { return m_Objects.size(); }
+
+private:
+	void GetCellRange(const double& v, const double& min, const int& nCells, const double& r, int& from, int& to) const;
+
+	double m_CellSize;
+	double m_MinX;
+	double m_MinY;
+	int m_nCols;
+	int m_nRows;
+
+	//curbs of cell i are m_CellCurbs[m_CellStart[i] .. m_CellStart[i+1]-1]
+	std::vector<unsigned int> m_CellStart;
+	std::vector<unsigned int> m_CellCurbs;
+
+	//prebuilt obstacle for each indexed curb, contour copied once at SetCurbs
+	std::vector<DetectedObject> m_Objects;
+
+	std::vector<unsigned int> m_Candidates;
+	std::vector<unsigned int> m_Selected;
+	std::vector<unsigned int> m_PrevSelected;
+	bool m_bHasSelection;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* CURBOBSTACLES_H_ */
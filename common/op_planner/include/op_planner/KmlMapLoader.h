@@ -0,0 +1,90 @@
+
+/// \file KmlMapLoader.h
+/// \brief Streaming reader for OpenPlanner .kml maps, extracts the map elements in one pass over the file content without building an XML document tree
+/// \date Oct 18, 2026
+
+
+
+#ifndef KMLMAPLOADER_H_
+#define KMLMAPLOADER_H_
+
+#include <string>
+#include <vector>
+#include "RoadNetwork.h"
+
+
+namespace PlannerHNS {
+
+class KmlMapLoader
+{
+public:
+	KmlMapLoader();
+	virtual ~KmlMapLoader();
+
+	/**
+	 * @brief Reads the map elements from a .kml map file
+	 * @param kmlFile path of the .kml file
+	 * @param bVerZero waypoints use the version zero description format (MappingHelpers::m_USING_VER_ZERO)
+	 * @return false if the file can't be opened
+	 */
+	bool LoadFile(const std::string& kmlFile, const bool& bVerZero = false);
+
+	/**
+	 * @brief Reads the map elements from .kml content in memory, same results as LoadFile
+	 */
+	void Parse(const char* pBegin, const char* pEnd, const bool& bVerZero = false);
+
+	void Clear();
+
+	std::vector<Lane> lanes;
+	std::vector<RoadSegment> roadSegments;
+	std::vector<TrafficLight> trafficLights;
+	std::vector<StopLine> stopLines;
+	std::vector<TrafficSign> signs;
+	std::vector<Crossing> crossings;
+	std::vector<Marking> markings;
+	std::vector<Boundary> boundaries;
+	std::vector<Curb> curbs;
+
+private:
+	struct XmlElement
+	{
+		const char* name;
+		const char* name_end;
+		const char* content;
+		const char* content_end;
+
+		bool Is(const char* tag) const;
+	};
+
+	static bool NextElement(const char*& p, const char* pEnd, XmlElement& elem);
+	static bool FirstChildElement(const XmlElement& parent, const char* tag, XmlElement& child);
+	//position of the first child element with the tag, NextElement from it continues with all its siblings
+	static const char* FirstChildPosition(const XmlElement& parent, const char* tag);
+	static bool GetText(const XmlElement& elem, std::string& text);
+	static bool GetChildText(const XmlElement& parent, const char* tag, std::string& text);
+
+	void ReadLanes(const XmlElement& folder, const bool& bVerZero);
+	void ReadLaneWaypoints(const XmlElement& laneFolder, Lane& lane, const bool& bVerZero);
+	void ReadRoadSegments(const XmlElement& folder);
+	void ReadTrafficLights(const XmlElement& folder);
+	void ReadStopLines(const XmlElement& folder);
+	void ReadTrafficSigns(const XmlElement& folder);
+	void ReadCrossings(const XmlElement& folder);
+	void ReadMarkings(const XmlElement& folder);
+	void ReadBoundaries(const XmlElement& folder);
+	void ReadCurbs(const XmlElement& folder);
+
+	static void ReadPoints(const XmlElement& coordinates, std::vector<GPSPoint>& points);
+	static bool GetPlacemarkPoints(const XmlElement& placemark, const char* geometry, std::vector<GPSPoint>& points);
+
+	//reused buffers for element texts
+	std::string m_Name;
+	std::string m_Description;
+	std::vector<int> m_Ids;
+	std::vector<double> m_Numbers;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* KMLMAPLOADER_H_ */
@@ -10,6 +10,7 @@
 #define LANE_CHANGE_SMOOTH_FACTOR_DISTANCE 8 // meters
 
 #include "RoadNetwork.h"
+#include "RouteSearchTree.h"
 
 namespace PlannerHNS
 {
@@ -48,7 +49,43 @@ public:
 
 	double PredictTrajectoriesUsingDP(const WayPoint& startPose, std::vector<WayPoint*> closestWPs, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths, const bool& bFindBranches = true, const bool bDirectionBased = false, const bool pathDensity = 1.0);
 
+	/**
+	 * @brief Routes from carPos to each goal of goalsPos, answered from one search tree expanded from the start.
+	 * The tree is reused while the start stays on the same lane, call ClearSearchTree after the map or its costs change
+	 * @param paths paths of each goal, same as PlanUsingDP for that goal, empty when the goal has no route
+	 * @param distances planned distance of each goal, 0 when the goal has no route
+	 * @return number of goals with a route
+	 */
+	int PlanUsingDPMultiGoal(const WayPoint& carPos, const std::vector<WayPoint>& goalsPos,
+			const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
+			RoadNetwork& map, std::vector<std::vector<std::vector<WayPoint> > >& paths, std::vector<double>& distances);
+
+	/**
+	 * @brief Route from carPos through the via points in order, the last via point is the goal.
+	 * Each leg is answered from a cached search tree expanded from the start of the leg
+	 * @return planned distance, 0 if a via point can't be reached
+	 */
+	double PlanUsingDPViaPoints(const WayPoint& carPos, const std::vector<WayPoint>& viaPoints,
+			const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
+			RoadNetwork& map, std::vector<std::vector<WayPoint> >& paths);
+
+	void ClearSearchTree();
+
 	void DeleteWaypoints(std::vector<WayPoint*>& wps);
+
+private:
+	WayPoint* GetStartWaypoint(const WayPoint& start, RoadNetwork& map, RelativeInfo& start_info);
+	WayPoint* GetGoalWaypoint(const WayPoint& goalPos, const RelativeInfo& start_info, RoadNetwork& map,
+			std::vector<WayPoint>& goal_path);
+	void UpdateSearchTree(RouteSearchTree& tree, WayPoint* pStart, const double& maxPlanningDistance,
+			const bool bEnableLaneChange, const std::vector<int>& globalPath);
+	bool TraverseSearchTree(const RouteSearchTree& tree, WayPoint* pGoalCell, WayPoint* pStart,
+			const std::vector<int>& globalPath, std::vector<WayPoint>& path);
+	void AttachGoalPath(std::vector<WayPoint> goal_path, std::vector<std::vector<WayPoint> >& paths);
+
+	//tree from the current start, and the trees from each via point
+	RouteSearchTree m_SearchTree;
+	std::vector<RouteSearchTree> m_ViaPointsSearchTrees;
 };
 
 }
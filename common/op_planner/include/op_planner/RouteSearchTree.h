@@ -0,0 +1,79 @@
+
+/// \file RouteSearchTree.h
+/// \brief Search tree expanded once from a start waypoint, answers the routes to many goals without new expansions
+/// \date Oct 18, 2026
+
+
+
+#ifndef ROUTESEARCHTREE_H_
+#define ROUTESEARCHTREE_H_
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "RoadNetwork.h"
+
+
+namespace PlannerHNS {
+
+class RouteSearchTree
+{
+public:
+	RouteSearchTree();
+	virtual ~RouteSearchTree();
+
+	//cells point to each other, a copy starts empty
+	RouteSearchTree(const RouteSearchTree& other);
+	RouteSearchTree& operator=(const RouteSearchTree& other);
+
+	/**
+	 * @brief Expands the tree from pStart with the rules of PlanningHelpers::BuildPlanningSearchTreeV2, without stopping at a goal
+	 * @param pStart map waypoint, the map must outlive the tree
+	 */
+	void Build(WayPoint* pStart, const std::vector<int>& globalPath, const double& distanceLimit, const bool& bEnableLaneChange);
+
+	/**
+	 * @brief True if the tree was built with the same parameters from a waypoint of the lane of pStart, at or before pStart,
+	 * so that routes from pStart can be cut from the routes of the tree
+	 */
+	bool IsBuiltFor(const WayPoint* pStart, const std::vector<int>& globalPath, const double& distanceLimit, const bool& bEnableLaneChange) const;
+
+	/**
+	 * @brief The cell BuildPlanningSearchTreeV2 returns for goalPos from the same start:
+	 * the first expanded cell at the goal, or the cell expanded when the distance limit was reached
+	 * @param bReached set to false when the returned cell is not at the goal
+	 * @return null when the goal is not reachable and the tree was expanded without reaching the distance limit
+	 */
+	WayPoint* FindGoalCell(const WayPoint& goalPos, bool* bReached = nullptr) const;
+
+	//map waypoint the tree was expanded from, null when empty
+	WayPoint* GetStart() const { return m_pStart; }
+
+	unsigned int GetCellsCount() const { return m_Cells.size(); }
+
+	bool IsEmpty() const { return m_Cells.size() == 0; }
+
+	void Clear();
+
+private:
+	uint64_t GetGridKey(const int& col, const int& row) const;
+	void IndexExpandedCell(WayPoint* pCell);
+
+	WayPoint* m_pStart;
+	std::vector<int> m_GlobalPath;
+	double m_DistanceLimit;
+	bool m_bEnableLaneChange;
+
+	//all created cells, owned by the tree
+	std::vector<WayPoint*> m_Cells;
+	//cells in expansion order
+	std::vector<WayPoint*> m_Expanded;
+	//cell expanded when the distance limit was reached, null if the tree was completely expanded
+	WayPoint* m_pLimitCell;
+	//indices into m_Expanded of the cells of each grid cell, to find the cells at a goal
+	std::unordered_map<uint64_t, std::vector<unsigned int> > m_ExpandedGrid;
+};
+
+} /* namespace PlannerHNS */
+
+#endif /* ROUTESEARCHTREE_H_ */
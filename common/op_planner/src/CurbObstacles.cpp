@@ -0,0 +1,170 @@
+
+/// \file CurbObstacles.cpp
+/// \brief Grid index over the map curbs, extracts the curbs near the vehicle as obstacles without visiting the whole map
+/// \date Oct 18, 2026
+
+#include "op_planner/CurbObstacles.h"
+#include <math.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+CurbObstacles::CurbObstacles()
+{
+	m_CellSize = 10.0;
+	m_MinX = 0;
+	m_MinY = 0;
+	m_nCols = 0;
+	m_nRows = 0;
+	m_bHasSelection = false;
+}
+
+CurbObstacles::~CurbObstacles()
+{
+}
+
+void CurbObstacles::Clear()
+{
+	m_nCols = 0;
+	m_nRows = 0;
+	m_CellStart.clear();
+	m_CellCurbs.clear();
+	m_Objects.clear();
+	m_Selected.clear();
+	m_PrevSelected.clear();
+	m_bHasSelection = false;
+}
+
+void CurbObstacles::SetCurbs(const std::vector<Curb>& curbs, const double& cellSize)
+{
+	Clear();
+
+	double max_x = 0, max_y = 0;
+	for(unsigned int ic = 0; ic < curbs.size(); ic++)
+	{
+		if(curbs.at(ic).points.size() == 0)
+			continue;
+
+		DetectedObject obj;
+		obj.center.pos = curbs.at(ic).points.at(0);
+		obj.bDirection = false;
+		obj.bVelocity = false;
+		obj.id = -1;
+		obj.t  = SIDEWALK;
+		obj.label = "curb";
+		obj.contour = curbs.at(ic).points;
+
+		if(m_Objects.size() == 0)
+		{
+			m_MinX = max_x = obj.center.pos.x;
+			m_MinY = max_y = obj.center.pos.y;
+		}
+		else
+		{
+			m_MinX = min(m_MinX, obj.center.pos.x);
+			m_MinY = min(m_MinY, obj.center.pos.y);
+			max_x = max(max_x, obj.center.pos.x);
+			max_y = max(max_y, obj.center.pos.y);
+		}
+
+		m_Objects.push_back(obj);
+	}
+
+	if(m_Objects.size() == 0)
+		return;
+
+	//at most about four cells per curb, so a sparse map spread over a large area doesn't allocate a huge grid
+	m_CellSize = max(cellSize, 0.1);
+	double min_cell_size = sqrt((max_x - m_MinX) * (max_y - m_MinY) / (4.0 * m_Objects.size()));
+	if(m_CellSize < min_cell_size)
+		m_CellSize = min_cell_size;
+
+	m_nCols = (int)((max_x - m_MinX) / m_CellSize) + 1;
+	m_nRows = (int)((max_y - m_MinY) / m_CellSize) + 1;
+
+	vector<unsigned int> curb_cell(m_Objects.size());
+	m_CellStart.assign(m_nCols * m_nRows + 1, 0);
+	for(unsigned int i = 0; i < m_Objects.size(); i++)
+	{
+		int col = min(m_nCols - 1, (int)((m_Objects.at(i).center.pos.x - m_MinX) / m_CellSize));
+		int row = min(m_nRows - 1, (int)((m_Objects.at(i).center.pos.y - m_MinY) / m_CellSize));
+		curb_cell.at(i) = row * m_nCols + col;
+		m_CellStart.at(curb_cell.at(i) + 1)++;
+	}
+
+	for(unsigned int i = 1; i < m_CellStart.size(); i++)
+		m_CellStart.at(i) += m_CellStart.at(i-1);
+
+	//curbs are added in map order, so each cell list stays sorted
+	vector<unsigned int> next(m_CellStart.begin(), m_CellStart.end() - 1);
+	m_CellCurbs.resize(m_Objects.size());
+	for(unsigned int i = 0; i < m_Objects.size(); i++)
+		m_CellCurbs.at(next.at(curb_cell.at(i))++) = i;
+}
+
+void CurbObstacles::GetCellRange(const double& v, const double& min, const int& nCells, const double& r, int& from, int& to) const
+{
+	double f = floor((v - r - min) / m_CellSize);
+	double t = floor((v + r - min) / m_CellSize);
+	from = f < 0 ? 0 : (f >= nCells ? nCells : (int)f);
+	to = t < 0 ? -1 : (t >= nCells ? nCells - 1 : (int)t);
+}
+
+bool CurbObstacles::GetObstacles(const WayPoint& currPos, const double& horizon, const double& minDistanceBetweenCurbs,
+		std::vector<DetectedObject>& obstacles)
+{
+	m_Candidates.clear();
+	if(m_Objects.size() > 0 && horizon >= 0)
+	{
+		int col_from, col_to, row_from, row_to;
+		GetCellRange(currPos.pos.x, m_MinX, m_nCols, horizon, col_from, col_to);
+		GetCellRange(currPos.pos.y, m_MinY, m_nRows, horizon, row_from, row_to);
+
+		for(int row = row_from; row <= row_to; row++)
+		{
+			for(int col = col_from; col <= col_to; col++)
+			{
+				int cell = row * m_nCols + col;
+				for(unsigned int k = m_CellStart.at(cell); k < m_CellStart.at(cell+1); k++)
+				{
+					const GPSPoint& p = m_Objects.at(m_CellCurbs.at(k)).center.pos;
+					if(hypot(currPos.pos.y - p.y, currPos.pos.x - p.x) <= horizon)
+						m_Candidates.push_back(m_CellCurbs.at(k));
+				}
+			}
+		}
+
+		sort(m_Candidates.begin(), m_Candidates.end());
+	}
+
+	//thinning depends on the map order of the curbs within the horizon only
+	m_Selected.clear();
+	for(unsigned int i = 0; i < m_Candidates.size(); i++)
+	{
+		const GPSPoint& p = m_Objects.at(m_Candidates.at(i)).center.pos;
+		if(m_Selected.size() > 0)
+		{
+			const GPSPoint& prev = m_Objects.at(m_Selected.back()).center.pos;
+			if(hypot(prev.y - p.y, prev.x - p.x) < minDistanceBetweenCurbs)
+				continue;
+		}
+		m_Selected.push_back(m_Candidates.at(i));
+	}
+
+	if(m_bHasSelection && m_Selected == m_PrevSelected)
+		return false;
+
+	m_bHasSelection = true;
+	m_PrevSelected.swap(m_Selected);
+
+	obstacles.clear();
+	for(unsigned int i = 0; i < m_PrevSelected.size(); i++)
+		obstacles.push_back(m_Objects.at(m_PrevSelected.at(i)));
+
+	return true;
+}
+
+} /* namespace PlannerHNS */
@@ -0,0 +1,892 @@
+
+/// \file KmlMapLoader.cpp
+/// \brief Streaming reader for OpenPlanner .kml maps, extracts the map elements in one pass over the file content without building an XML document tree
+/// \date Oct 18, 2026
+
+#include "op_planner/KmlMapLoader.h"
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+
+using namespace std;
+
+namespace PlannerHNS
+{
+
+namespace
+{
+
+//Element texts are read like TinyXML does: leading and trailing white space removed, inner white space condensed to one space
+
+bool IsXmlSpace(const char& c)
+{
+	return isspace((unsigned char)c) || c == '\n' || c == '\r';
+}
+
+bool StartsWith(const char* p, const char* pEnd, const char* str)
+{
+	size_t len = strlen(str);
+	return (size_t)(pEnd - p) >= len && strncmp(p, str, len) == 0;
+}
+
+const char* FindString(const char* p, const char* pEnd, const char* str)
+{
+	size_t len = strlen(str);
+	for(; (size_t)(pEnd - p) >= len; p++)
+	{
+		p = (const char*)memchr(p, str[0], pEnd - p);
+		if(!p || (size_t)(pEnd - p) < len)
+			break;
+		if(memcmp(p, str, len) == 0)
+			return p;
+	}
+	return pEnd;
+}
+
+void AppendEntity(const char*& p, const char* pEnd, string& text)
+{
+	static const char* entities[5][2] = {{"&amp;", "&"}, {"&lt;", "<"}, {"&gt;", ">"}, {"&quot;", "\""}, {"&apos;", "'"}};
+	for(unsigned int i = 0; i < 5; i++)
+	{
+		if(StartsWith(p, pEnd, entities[i][0]))
+		{
+			text += entities[i][1];
+			p += strlen(entities[i][0]);
+			return;
+		}
+	}
+
+	if(StartsWith(p, pEnd, "&#"))
+	{
+		const char* pSemi = (const char*)memchr(p, ';', pEnd - p);
+		if(pSemi)
+		{
+			bool bHex = p[2] == 'x';
+			unsigned long code = strtoul(string(p + (bHex ? 3 : 2), pSemi).c_str(), 0, bHex ? 16 : 10);
+			if(code > 0 && code < 128)
+			{
+				text += (char)code;
+				p = pSemi + 1;
+				return;
+			}
+		}
+	}
+
+	text += *p++;
+}
+
+//same as atof/atoi on the given characters
+double ToDouble(const char* pBegin, const char* pEnd)
+{
+	//plain decimals with up to 15 digits are exact doubles divided by an exact power of ten, this is correctly
+	//rounded like strtod, everything else is left to atof
+	static const double pow10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15};
+	const char* p = pBegin;
+	bool bNegative = p < pEnd && *p == '-';
+	if(p < pEnd && (*p == '-' || *p == '+'))
+		p++;
+
+	long long mantissa = 0;
+	int nDigits = 0;
+	int nSignificant = 0;
+	int nDecimals = -1;
+	for(; p < pEnd; p++)
+	{
+		if(*p >= '0' && *p <= '9')
+		{
+			nDigits++;
+			if(mantissa > 0 || *p != '0')
+				nSignificant++;
+			//digits past the 15th significant one only send the number to atof, adding them could overflow
+			if(nSignificant <= 15)
+				mantissa = mantissa * 10 + (*p - '0');
+			if(nDecimals >= 0)
+				nDecimals++;
+		}
+		else if(*p == '.' && nDecimals < 0)
+		{
+			nDecimals = 0;
+		}
+		else
+		{
+			break;
+		}
+	}
+
+	if(p == pEnd && nDigits > 0 && nSignificant <= 15 && nDecimals <= 15)
+	{
+		double value = (double)mantissa / pow10[nDecimals > 0 ? nDecimals : 0];
+		return bNegative ? -value : value;
+	}
+
+	char buffer[64];
+	size_t len = pEnd - pBegin;
+	if(len >= sizeof(buffer))
+		return atof(string(pBegin, pEnd).c_str());
+	memcpy(buffer, pBegin, len);
+	buffer[len] = 0;
+	return atof(buffer);
+}
+
+int ToInt(const char* pBegin, const char* pEnd)
+{
+	const char* p = pBegin;
+	bool bNegative = p < pEnd && *p == '-';
+	if(p < pEnd && (*p == '-' || *p == '+'))
+		p++;
+
+	int value = 0;
+	int nDigits = 0;
+	for(; p < pEnd && *p >= '0' && *p <= '9' && nDigits < 9; p++, nDigits++)
+		value = value * 10 + (*p - '0');
+
+	//white space and larger numbers are left to atoi
+	if(nDigits > 0 && (p == pEnd || *p < '0' || *p > '9'))
+		return bNegative ? -value : value;
+
+	char buffer[64];
+	size_t len = pEnd - pBegin;
+	if(len >= sizeof(buffer))
+		return atoi(string(pBegin, pEnd).c_str());
+	memcpy(buffer, pBegin, len);
+	buffer[len] = 0;
+	return atoi(buffer);
+}
+
+/**
+ * Same part of the string as MappingHelpers::GetIDsFromPrefix selects, between prefix and postfix, the parts
+ * of it are the ones MappingHelpers::SplitString(str, "_") returns.
+ */
+bool GetPrefixRange(const char* str, const char* strEnd, const char* prefix, const char* postfix,
+		const char*& pBegin, const char*& pEnd)
+{
+	size_t prefix_len = strlen(prefix);
+	const char* pPrefix = FindString(str, strEnd, prefix);
+	size_t index1 = (pPrefix == strEnd) ? prefix_len - 1 : (pPrefix - str) + prefix_len;
+	if(index1 > (size_t)(strEnd - str))
+		return false;
+
+	pBegin = str + index1;
+	pEnd = strEnd;
+	if(strlen(postfix) > 0)
+		pEnd = FindString(pBegin, strEnd, postfix);
+	return true;
+}
+
+void GetIDsFromPrefix(const char* str, const char* strEnd, const char* prefix, const char* postfix, vector<int>& ids)
+{
+	ids.clear();
+	const char *pBegin, *pEnd;
+	if(!GetPrefixRange(str, strEnd, prefix, postfix, pBegin, pEnd))
+		return;
+
+	const char* p = (const char*)memchr(pBegin, '_', pEnd - pBegin);
+	while(p)
+	{
+		const char* pPart = p + 1;
+		p = (const char*)memchr(pPart, '_', pEnd - pPart);
+		const char* pPartEnd = p ? p : pEnd;
+		if(pPartEnd > pPart)
+			ids.push_back(ToInt(pPart, pPartEnd));
+	}
+}
+
+void GetDoubleFromPrefix(const char* str, const char* strEnd, const char* prefix, const char* postfix, vector<double>& nums)
+{
+	nums.clear();
+	const char *pBegin, *pEnd;
+	if(!GetPrefixRange(str, strEnd, prefix, postfix, pBegin, pEnd))
+		return;
+
+	const char* p = (const char*)memchr(pBegin, '_', pEnd - pBegin);
+	while(p)
+	{
+		const char* pPart = p + 1;
+		p = (const char*)memchr(pPart, '_', pEnd - pPart);
+		const char* pPartEnd = p ? p : pEnd;
+		if(pPartEnd > pPart)
+			nums.push_back(ToDouble(pPart, pPartEnd));
+	}
+}
+
+pair<ACTION_TYPE, double> GetActionPairFromPrefix(const char* str, const char* strEnd, const char* prefix, const char* postfix)
+{
+	pair<ACTION_TYPE, double> act_cost;
+	act_cost.first = FORWARD_ACTION;
+	act_cost.second = 0;
+
+	const char *pBegin, *pEnd;
+	if(!GetPrefixRange(str, strEnd, prefix, postfix, pBegin, pEnd))
+		return act_cost;
+
+	//the first two parts are the action and the cost
+	const char* p1 = (const char*)memchr(pBegin, '_', pEnd - pBegin);
+	if(!p1)
+		return act_cost;
+	const char* p2 = (const char*)memchr(p1 + 1, '_', pEnd - p1 - 1);
+	if(!p2)
+		return act_cost;
+	const char* p3 = (const char*)memchr(p2 + 1, '_', pEnd - p2 - 1);
+	if(!p3)
+		p3 = pEnd;
+
+	if(p2 > p1 + 1 && p1[1] == 'L')
+		act_cost.first = LEFT_TURN_ACTION;
+	else if(p2 > p1 + 1 && p1[1] == 'R')
+		act_cost.first = RIGHT_TURN_ACTION;
+	if(p3 > p2 + 1)
+		act_cost.second = ToDouble(p2 + 1, p3);
+
+	return act_cost;
+}
+
+int FirstId(const vector<int>& ids)
+{
+	return ids.size() > 0 ? ids.at(0) : 0;
+}
+
+}  // namespace
+
+bool KmlMapLoader::XmlElement::Is(const char* tag) const
+{
+	size_t len = strlen(tag);
+	return (size_t)(name_end - name) == len && strncmp(name, tag, len) == 0;
+}
+
+KmlMapLoader::KmlMapLoader()
+{
+}
+
+KmlMapLoader::~KmlMapLoader()
+{
+}
+
+void KmlMapLoader::Clear()
+{
+	lanes.clear();
+	roadSegments.clear();
+	trafficLights.clear();
+	stopLines.clear();
+	signs.clear();
+	crossings.clear();
+	markings.clear();
+	boundaries.clear();
+	curbs.clear();
+}
+
+bool KmlMapLoader::LoadFile(const std::string& kmlFile, const bool& bVerZero)
+{
+	Clear();
+
+	ifstream f(kmlFile.c_str(), ios::in | ios::binary);
+	if(!f.good())
+		return false;
+
+	f.seekg(0, ios::end);
+	streamoff size = f.tellg();
+	if(size <= 0)
+		return true;
+
+	vector<char> content(size);
+	f.seekg(0, ios::beg);
+	f.read(content.data(), size);
+	content.resize(f.gcount());
+
+	Parse(content.data(), content.data() + content.size(), bVerZero);
+	return true;
+}
+
+bool KmlMapLoader::NextElement(const char*& p, const char* pEnd, XmlElement& elem)
+{
+	while(p < pEnd)
+	{
+		p = (const char*)memchr(p, '<', pEnd - p);
+		if(!p)
+		{
+			p = pEnd;
+			return false;
+		}
+
+		if(StartsWith(p, pEnd, "</"))
+			return false;
+
+		if(StartsWith(p, pEnd, "<!--"))
+		{
+			p = FindString(p, pEnd, "-->");
+			p = (p == pEnd) ? pEnd : p + 3;
+			continue;
+		}
+
+		if(StartsWith(p, pEnd, "<![CDATA["))
+		{
+			p = FindString(p, pEnd, "]]>");
+			p = (p == pEnd) ? pEnd : p + 3;
+			continue;
+		}
+
+		if(StartsWith(p, pEnd, "<?") || StartsWith(p, pEnd, "<!"))
+		{
+			p = (const char*)memchr(p, '>', pEnd - p);
+			p = p ? p + 1 : pEnd;
+			continue;
+		}
+
+		elem.name = ++p;
+		while(p < pEnd && !IsXmlSpace(*p) && *p != '>' && *p != '/')
+			p++;
+		elem.name_end = p;
+
+		//attributes, quoted values may contain '>'
+		bool bEmpty = false;
+		while(p < pEnd && *p != '>')
+		{
+			if(*p == '"' || *p == '\'')
+			{
+				const char* pQuote = (const char*)memchr(p + 1, *p, pEnd - p - 1);
+				p = pQuote ? pQuote : pEnd;
+			}
+			else if(*p == '/')
+			{
+				bEmpty = true;
+			}
+			else if(!IsXmlSpace(*p))
+			{
+				bEmpty = false;
+			}
+
+			if(p < pEnd)
+				p++;
+		}
+		p = (p < pEnd) ? p + 1 : pEnd;
+
+		elem.content = p;
+		if(bEmpty)
+		{
+			elem.content_end = p;
+			return true;
+		}
+
+		XmlElement child;
+		while(NextElement(p, pEnd, child));
+		elem.content_end = p;
+
+		p = (const char*)memchr(p, '>', pEnd - p);
+		p = p ? p + 1 : pEnd;
+		return true;
+	}
+
+	return false;
+}
+
+bool KmlMapLoader::FirstChildElement(const XmlElement& parent, const char* tag, XmlElement& child)
+{
+	const char* p = parent.content;
+	while(NextElement(p, parent.content_end, child))
+	{
+		if(child.Is(tag))
+			return true;
+	}
+	return false;
+}
+
+const char* KmlMapLoader::FirstChildPosition(const XmlElement& parent, const char* tag)
+{
+	XmlElement child;
+	const char* p = parent.content;
+	const char* pChild = p;
+	while(NextElement(p, parent.content_end, child))
+	{
+		if(child.Is(tag))
+			return pChild;
+		pChild = p;
+	}
+	return parent.content_end;
+}
+
+bool KmlMapLoader::GetText(const XmlElement& elem, std::string& text)
+{
+	text.clear();
+	const char* p = elem.content;
+	const char* pEnd = elem.content_end;
+	while(p < pEnd && IsXmlSpace(*p))
+		p++;
+
+	if(p == pEnd)
+		return false;
+
+	if(*p == '<')
+	{
+		if(!StartsWith(p, pEnd, "<![CDATA["))
+			return false;
+		p += 9;
+		text.assign(p, FindString(p, pEnd, "]]>"));
+		return true;
+	}
+
+	bool bWhiteSpace = false;
+	while(p < pEnd && *p != '<')
+	{
+		if(IsXmlSpace(*p))
+		{
+			bWhiteSpace = true;
+			p++;
+			continue;
+		}
+
+		if(bWhiteSpace)
+		{
+			text += ' ';
+			bWhiteSpace = false;
+		}
+
+		if(*p == '&')
+			AppendEntity(p, pEnd, text);
+		else
+			text += *p++;
+	}
+
+	return true;
+}
+
+bool KmlMapLoader::GetChildText(const XmlElement& parent, const char* tag, std::string& text)
+{
+	XmlElement child;
+	if(!FirstChildElement(parent, tag, child))
+	{
+		text.clear();
+		return false;
+	}
+	GetText(child, text);
+	return true;
+}
+
+void KmlMapLoader::ReadPoints(const XmlElement& coordinates, std::vector<GPSPoint>& points)
+{
+	//"x,y,z x,y,z ...", missing values are 0
+	const char* p = coordinates.content;
+	const char* pEnd = (const char*)memchr(p, '<', coordinates.content_end - p);
+	if(!pEnd)
+		pEnd = coordinates.content_end;
+
+	while(p < pEnd)
+	{
+		while(p < pEnd && IsXmlSpace(*p))
+			p++;
+		if(p == pEnd)
+			break;
+
+		const char* pToken = p;
+		while(p < pEnd && !IsXmlSpace(*p))
+			p++;
+
+		double values[3] = {0, 0, 0};
+		const char* pValue = pToken;
+		for(unsigned int i = 0; i < 3 && pValue <= p; i++)
+		{
+			const char* pComma = (const char*)memchr(pValue, ',', p - pValue);
+			const char* pValueEnd = pComma ? pComma : p;
+			if(pValueEnd > pValue)
+				values[i] = ToDouble(pValue, pValueEnd);
+			pValue = pValueEnd + 1;
+		}
+
+		GPSPoint gp;
+		gp.x = gp.lat = values[0];
+		gp.y = gp.lon = values[1];
+		gp.z = gp.alt = values[2];
+		points.push_back(gp);
+	}
+}
+
+bool KmlMapLoader::GetPlacemarkPoints(const XmlElement& placemark, const char* geometry, std::vector<GPSPoint>& points)
+{
+	points.clear();
+	XmlElement geometryElem, coordinates;
+	if(!FirstChildElement(placemark, geometry, geometryElem) || !FirstChildElement(geometryElem, "coordinates", coordinates))
+		return false;
+
+	ReadPoints(coordinates, points);
+	return true;
+}
+
+void KmlMapLoader::Parse(const char* pBegin, const char* pEnd, const bool& bVerZero)
+{
+	Clear();
+
+	//Same element as MappingHelpers::GetHeadElement
+	XmlElement root, head, child;
+	const char* p = pBegin;
+	if(!NextElement(p, pEnd, root) || !FirstChildElement(root, "Folder", head))
+		return;
+	if(FirstChildElement(head, "Folder", child))
+		head = child;
+	if(FirstChildElement(head, "Document", child))
+		head = child;
+
+	//Data folders are found by name like MappingHelpers::GetDataFolder, starting with the first Folder element
+	const char* folderNames[] = {"Lanes", "RoadSegments", "TrafficLights", "StopLines", "TrafficSigns", "Crossings",
+			"Markings", "Boundaries", "CurbsLines"};
+	const unsigned int nFolders = sizeof(folderNames) / sizeof(folderNames[0]);
+	XmlElement folders[nFolders];
+	bool bFound[nFolders] = {false};
+
+	p = FirstChildPosition(head, "Folder");
+	while(NextElement(p, head.content_end, child))
+	{
+		GetChildText(child, "name", m_Name);
+		for(unsigned int i = 0; i < nFolders; i++)
+		{
+			if(!bFound[i] && m_Name.compare(folderNames[i]) == 0)
+			{
+				folders[i] = child;
+				bFound[i] = true;
+			}
+		}
+	}
+
+	if(bFound[0]) ReadLanes(folders[0], bVerZero);
+	if(bFound[1]) ReadRoadSegments(folders[1]);
+	if(bFound[2]) ReadTrafficLights(folders[2]);
+	if(bFound[3]) ReadStopLines(folders[3]);
+	if(bFound[4]) ReadTrafficSigns(folders[4]);
+	if(bFound[5]) ReadCrossings(folders[5]);
+	if(bFound[6]) ReadMarkings(folders[6]);
+	if(bFound[7]) ReadBoundaries(folders[7]);
+	if(bFound[8]) ReadCurbs(folders[8]);
+}
+
+void KmlMapLoader::ReadLanes(const XmlElement& folder, const bool& bVerZero)
+{
+	XmlElement laneFolder;
+	const char* p = FirstChildPosition(folder, "Folder");
+	while(NextElement(p, folder.content_end, laneFolder))
+	{
+		if(!GetChildText(laneFolder, "description", m_Description))
+			continue;
+
+		const char* str = m_Description.data();
+		const char* strEnd = str + m_Description.size();
+
+		Lane ll;
+		GetIDsFromPrefix(str, strEnd, "LID", "RSID", m_Ids);
+		ll.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "RSID", "NUM", m_Ids);
+		ll.roadId = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "NUM", "From", m_Ids);
+		ll.num = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "From", "To", ll.fromIds);
+		GetIDsFromPrefix(str, strEnd, "To", "Vel", ll.toIds);
+		GetIDsFromPrefix(str, strEnd, "Vel", "", m_Ids);
+		ll.speed = FirstId(m_Ids);
+
+		ReadLaneWaypoints(laneFolder, ll, bVerZero);
+
+		lanes.push_back(ll);
+	}
+}
+
+void KmlMapLoader::ReadLaneWaypoints(const XmlElement& laneFolder, Lane& lane, const bool& bVerZero)
+{
+	XmlElement placemark, lineString, coordinates, infoFolder;
+	if(!FirstChildElement(laneFolder, "Placemark", placemark) || !FirstChildElement(placemark, "LineString", lineString)
+			|| !FirstChildElement(lineString, "coordinates", coordinates))
+		return;
+
+	vector<GPSPoint> points;
+	ReadPoints(coordinates, points);
+
+	lane.points.reserve(points.size());
+	for(unsigned int i = 0; i < points.size(); i++)
+	{
+		WayPoint wp;
+		wp.pos.x = wp.pos.lat = points.at(i).lat;
+		wp.pos.y = wp.pos.lon = points.at(i).lon;
+		wp.pos.z = wp.pos.alt = points.at(i).alt;
+		wp.laneId = lane.id;
+		lane.points.push_back(wp);
+	}
+
+	//comma separated waypoint descriptions, the last character of the text is not part of them
+	m_Description.clear();
+	if(FirstChildElement(laneFolder, "Folder", infoFolder))
+		GetChildText(infoFolder, "description", m_Description);
+	if(m_Description.size() == 0)
+		return;
+
+	const char* str = m_Description.data();
+	const char* strEnd = str + m_Description.size() - 1;
+	unsigned int nInfo = 1;
+	for(const char* c = str; c < strEnd; c++)
+		if(*c == ',') nInfo++;
+	if(nInfo != lane.points.size())
+		return;
+
+	const char* pInfo = str;
+	for(unsigned int i = 0; i < lane.points.size(); i++)
+	{
+		const char* pInfoEnd = (const char*)memchr(pInfo, ',', strEnd - pInfo);
+		if(!pInfoEnd)
+			pInfoEnd = strEnd;
+
+		WayPoint& wp = lane.points.at(i);
+		if(bVerZero)
+		{
+			GetIDsFromPrefix(pInfo, pInfoEnd, "WPID", "C", m_Ids);
+			wp.id = FirstId(m_Ids);
+			GetIDsFromPrefix(pInfo, pInfoEnd, "From", "To", wp.fromIds);
+			GetIDsFromPrefix(pInfo, pInfoEnd, "To", "Vel", wp.toIds);
+			GetDoubleFromPrefix(pInfo, pInfoEnd, "Vel", "Dir", m_Numbers);
+			if(m_Numbers.size() > 0)
+				wp.v = m_Numbers.at(0);
+			GetDoubleFromPrefix(pInfo, pInfoEnd, "Dir", "", m_Numbers);
+			if(m_Numbers.size() > 0)
+				wp.pos.a = wp.pos.dir = m_Numbers.at(0);
+		}
+		else
+		{
+			GetIDsFromPrefix(pInfo, pInfoEnd, "WPID", "AC", m_Ids);
+			wp.id = FirstId(m_Ids);
+			wp.actionCost.push_back(GetActionPairFromPrefix(pInfo, pInfoEnd, "AC", "From"));
+			GetIDsFromPrefix(pInfo, pInfoEnd, "From", "To", wp.fromIds);
+			GetIDsFromPrefix(pInfo, pInfoEnd, "To", "Lid", wp.toIds);
+
+			GetIDsFromPrefix(pInfo, pInfoEnd, "Lid", "Rid", m_Ids);
+			if(m_Ids.size() > 0)
+				wp.LeftPointId = m_Ids.at(0);
+
+			GetIDsFromPrefix(pInfo, pInfoEnd, "Rid", "Vel", m_Ids);
+			if(m_Ids.size() > 0)
+				wp.RightPointId = m_Ids.at(0);
+
+			GetDoubleFromPrefix(pInfo, pInfoEnd, "Vel", "Dir", m_Numbers);
+			if(m_Numbers.size() > 0)
+				wp.v = m_Numbers.at(0);
+
+			GetDoubleFromPrefix(pInfo, pInfoEnd, "Dir", "", m_Numbers);
+			if(m_Numbers.size() > 0)
+				wp.pos.a = wp.pos.dir = m_Numbers.at(0);
+		}
+
+		pInfo = pInfoEnd + 1;
+	}
+}
+
+void KmlMapLoader::ReadRoadSegments(const XmlElement& folder)
+{
+	XmlElement placemark;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		GetChildText(placemark, "description", m_Description);
+		const char* str = m_Description.data();
+
+		RoadSegment rl;
+		GetIDsFromPrefix(str, str + m_Description.size(), "RSID", "", m_Ids);
+		rl.id = FirstId(m_Ids);
+		roadSegments.push_back(rl);
+	}
+}
+
+void KmlMapLoader::ReadTrafficLights(const XmlElement& folder)
+{
+	XmlElement placemark;
+	vector<GPSPoint> points;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		TrafficLight tl;
+		GetIDsFromPrefix(str, strEnd, "TLID", "LnID", m_Ids);
+		tl.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "LnID", "", tl.laneIds);
+
+		GetPlacemarkPoints(placemark, "Point", points);
+		if(points.size() > 0)
+			tl.pos = points.at(0);
+
+		trafficLights.push_back(tl);
+	}
+}
+
+void KmlMapLoader::ReadStopLines(const XmlElement& folder)
+{
+	XmlElement placemark;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		StopLine sl;
+		GetIDsFromPrefix(str, strEnd, "SLID", "LnID", m_Ids);
+		sl.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "LnID", "TSID", m_Ids);
+		sl.laneId = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "TSID", "TLID", m_Ids);
+		sl.stopSignID = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "TLID", "", m_Ids);
+		sl.trafficLightID = FirstId(m_Ids);
+
+		GetPlacemarkPoints(placemark, "LineString", sl.points);
+
+		stopLines.push_back(sl);
+	}
+}
+
+void KmlMapLoader::ReadTrafficSigns(const XmlElement& folder)
+{
+	XmlElement placemark;
+	vector<GPSPoint> points;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		TrafficSign ts;
+		GetIDsFromPrefix(str, strEnd, "TSID", "LnID", m_Ids);
+		ts.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "LnID", "RdID", m_Ids);
+		ts.laneId = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "RdID", "Type", m_Ids);
+		ts.roadId = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "Type", "", m_Ids);
+		switch(FirstId(m_Ids))
+		{
+		case 0:
+			ts.signType = UNKNOWN_SIGN;
+			break;
+		case 1:
+			ts.signType = STOP_SIGN;
+			break;
+		case 2:
+			ts.signType = MAX_SPEED_SIGN;
+			break;
+		case 3:
+			ts.signType = MIN_SPEED_SIGN;
+			break;
+		default:
+			ts.signType = STOP_SIGN;
+			break;
+		}
+
+		GetPlacemarkPoints(placemark, "LineString", points);
+		if(points.size() > 0)
+			ts.pos = points.at(0);
+
+		signs.push_back(ts);
+	}
+}
+
+void KmlMapLoader::ReadCrossings(const XmlElement& folder)
+{
+	XmlElement placemark;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		Crossing cross;
+		GetIDsFromPrefix(str, strEnd, "CRID", "RdID", m_Ids);
+		cross.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "RdID", "", m_Ids);
+		cross.roadId = FirstId(m_Ids);
+
+		GetPlacemarkPoints(placemark, "LineString", cross.points);
+
+		crossings.push_back(cross);
+	}
+}
+
+void KmlMapLoader::ReadMarkings(const XmlElement& folder)
+{
+	XmlElement placemark;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		Marking m;
+		GetIDsFromPrefix(str, strEnd, "MID", "LnID", m_Ids);
+		m.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "LnID", "RdID", m_Ids);
+		m.laneId = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "RdID", "", m_Ids);
+		m.roadId = FirstId(m_Ids);
+
+		GetPlacemarkPoints(placemark, "LineString", m.points);
+		if(m.points.size() > 0)
+		{
+			//first item is the center of the marking
+			m.center = m.points.at(0);
+			m.points.erase(m.points.begin()+0);
+		}
+
+		markings.push_back(m);
+	}
+}
+
+void KmlMapLoader::ReadBoundaries(const XmlElement& folder)
+{
+	XmlElement placemark;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		Boundary b;
+		GetIDsFromPrefix(str, strEnd, "BID", "RdID", m_Ids);
+		b.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "RdID", "", m_Ids);
+		b.roadId = FirstId(m_Ids);
+
+		GetPlacemarkPoints(placemark, "LineString", b.points);
+
+		boundaries.push_back(b);
+	}
+}
+
+void KmlMapLoader::ReadCurbs(const XmlElement& folder)
+{
+	XmlElement placemark;
+	const char* p = FirstChildPosition(folder, "Placemark");
+	while(NextElement(p, folder.content_end, placemark))
+	{
+		if(!GetChildText(placemark, "name", m_Name))
+			continue;
+		const char* str = m_Name.data();
+		const char* strEnd = str + m_Name.size();
+
+		Curb c;
+		GetIDsFromPrefix(str, strEnd, "BID", "LnID", m_Ids);
+		c.id = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "LnID", "RdID", m_Ids);
+		c.laneId = FirstId(m_Ids);
+		GetIDsFromPrefix(str, strEnd, "RdID", "", m_Ids);
+		c.roadId = FirstId(m_Ids);
+
+		GetPlacemarkPoints(placemark, "LineString", c.points);
+
+		curbs.push_back(c);
+	}
+}
+
+} /* namespace PlannerHNS */
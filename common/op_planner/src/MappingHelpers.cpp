@@ -7,12 +7,14 @@
 
 
 #include "op_planner/MappingHelpers.h"
+#include "op_planner/KmlMapLoader.h"
 #include "op_planner/MatrixOperations.h"
 #include "op_planner/PlanningHelpers.h"
 #include <float.h>
 
 #include "math.h"
 #include <fstream>
+#include <unordered_map>
 
 using namespace UtilityHNS;
 using namespace std;
@@ -665,78 +667,38 @@ bool MappingHelpers::GetWayPoint(const int& id, const int& laneID,const double&
 
 void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 {
-	//First, Get the main element
-	TiXmlElement* pHeadElem = 0;
-	TiXmlElement* pElem = 0;
-
-	ifstream f(kmlFile.c_str());
-	if(!f.good())
-	{
-		cout << "Can't Open KML Map File: (" << kmlFile << ")" << endl;
-		return;
-	}
-
 	std::cout << " >> Loading KML Map file ... " << std::endl;
 
-	TiXmlDocument doc(kmlFile);
-	try
-	{
-		doc.LoadFile();
-	}
-	catch(exception& e)
+	//Read all map elements in one pass, without building the TinyXML document
+	KmlMapLoader loader;
+	if(!loader.LoadFile(kmlFile, m_USING_VER_ZERO == 1))
 	{
-		cout << "KML Custom Reader Error, Can't Load .kml File, path is: "<<  kmlFile << endl;
-		cout << e.what() << endl;
+		cout << "Can't Open KML Map File: (" << kmlFile << ")" << endl;
 		return;
 	}
 
-
-	std::cout << " >> Reading Data from KML map file ... " << std::endl;
-
-	pElem = doc.FirstChildElement();
-	pHeadElem = GetHeadElement(pElem);
-
-	std::cout << " >> Load Lanes from KML file .. " << std::endl;
-	vector<Lane> laneLinksList = GetLanesList(pHeadElem);
+	vector<Lane>& laneLinksList = loader.lanes;
 
 	map.roadSegments.clear();
-	map.roadSegments = GetRoadSegmentsList(pHeadElem);
-
-	std::cout << " >> Load Traffic lights from KML file .. " << std::endl;
-	vector<TrafficLight> trafficLights = GetTrafficLightsList(pHeadElem);
-
-	std::cout << " >> Load Stop lines from KML file .. " << std::endl;
-	vector<StopLine> stopLines = GetStopLinesList(pHeadElem);
-
-	std::cout << " >> Load Signes from KML file .. " << std::endl;
-	vector<TrafficSign> signs = GetTrafficSignsList(pHeadElem);
-
-	std::cout << " >> Load Crossings from KML file .. " << std::endl;
-	vector<Crossing> crossings = GetCrossingsList(pHeadElem);
-
-	std::cout << " >> Load Markings from KML file .. " << std::endl;
-	vector<Marking> markings = GetMarkingsList(pHeadElem);
-
-	std::cout << " >> Load Road boundaries from KML file .. " << std::endl;
-	vector<Boundary> boundaries = GetBoundariesList(pHeadElem);
-
-	std::cout << " >> Load Curbs from KML file .. " << std::endl;
-	vector<Curb> curbs = GetCurbsList(pHeadElem);
+	map.roadSegments = loader.roadSegments;
 
 	map.signs.clear();
-	map.signs = signs;
+	map.signs = loader.signs;
 
 	map.crossings.clear();
-	map.crossings = crossings;
+	map.crossings = loader.crossings;
 
 	map.markings.clear();
-	map.markings = markings;
+	map.markings = loader.markings;
 
 	map.boundaries.clear();
-	map.boundaries = boundaries;
+	map.boundaries = loader.boundaries;
 
 	map.curbs.clear();
-	map.curbs = curbs;
+	map.curbs = loader.curbs;
+
+	vector<TrafficLight>& trafficLights = loader.trafficLights;
+	vector<StopLine>& stopLines = loader.stopLines;
 
 	//Fill the relations
 	for(unsigned int i= 0; i<map.roadSegments.size(); i++ )
@@ -752,30 +714,30 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 	//Link Lanes and lane's waypoints by pointers
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
 	{
+		//lanes by id in map order, ids are not required to be unique
+		std::unordered_map<int, vector<Lane*> > lanesById;
+		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+		{
+			Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
+			lanesById[pL->id].push_back(pL);
+		}
+
 		//Link Lanes
 		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
 		{
 			Lane* pL = &map.roadSegments.at(rs).Lanes.at(i);
 			for(unsigned int j = 0 ; j < pL->fromIds.size(); j++)
 			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->fromIds.at(j))
-					{
-						pL->fromLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
-				}
+				std::unordered_map<int, vector<Lane*> >::const_iterator it = lanesById.find(pL->fromIds.at(j));
+				if(it != lanesById.end())
+					pL->fromLanes.insert(pL->fromLanes.end(), it->second.begin(), it->second.end());
 			}
 
 			for(unsigned int j = 0 ; j < pL->toIds.size(); j++)
 			{
-				for(unsigned int l= 0; l < map.roadSegments.at(rs).Lanes.size(); l++)
-				{
-					if(map.roadSegments.at(rs).Lanes.at(l).id == pL->toIds.at(j))
-					{
-						pL->toLanes.push_back(&map.roadSegments.at(rs).Lanes.at(l));
-					}
-				}
+				std::unordered_map<int, vector<Lane*> >::const_iterator it = lanesById.find(pL->toIds.at(j));
+				if(it != lanesById.end())
+					pL->toLanes.insert(pL->toLanes.end(), it->second.begin(), it->second.end());
 			}
 
 			for(unsigned int j = 0 ; j < pL->points.size(); j++)
@@ -789,6 +751,33 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 	cout << " >> Link missing branches and waypoints... " << endl;
 	LinkMissingBranchingWayPointsV2(map);
 
+	//waypoints by id in map order, gives the same waypoint as FindWaypointV2 without searching the whole map
+	std::unordered_map<int, vector<WayPoint*> > waypointsById;
+	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
+	{
+		for(unsigned int i =0; i < map.roadSegments.at(rs).Lanes.size(); i++)
+		{
+			for(unsigned int p= 0; p < map.roadSegments.at(rs).Lanes.at(i).points.size(); p++)
+			{
+				WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
+				waypointsById[pWP->id].push_back(pWP);
+			}
+		}
+	}
+
+	auto findWaypoint = [&waypointsById](const int& id, const int& l_id) -> WayPoint*
+	{
+		std::unordered_map<int, vector<WayPoint*> >::const_iterator it = waypointsById.find(id);
+		if(it == waypointsById.end())
+			return nullptr;
+		for(unsigned int k = 0; k < it->second.size(); k++)
+		{
+			if(it->second.at(k)->pLane->id != l_id)
+				return it->second.at(k);
+		}
+		return nullptr;
+	};
+
 	cout << " >> Link Lane change semantics ... " << endl;
 	for(unsigned int rs = 0; rs < map.roadSegments.size(); rs++)
 	{
@@ -799,7 +788,7 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 				WayPoint* pWP = &map.roadSegments.at(rs).Lanes.at(i).points.at(p);
 				if(pWP->pLeft == 0 && pWP->LeftPointId > 0)
 				{
-					pWP->pLeft = FindWaypointV2(pWP->LeftPointId, pWP->laneId, map);
+					pWP->pLeft = findWaypoint(pWP->LeftPointId, pWP->laneId);
 
 					if(pWP->pLeft != nullptr)
 					{
@@ -817,7 +806,7 @@ void MappingHelpers::LoadKML(const std::string& kmlFile, RoadNetwork& map)
 
 				if(pWP->pRight == 0 && pWP->RightPointId > 0)
 				{
-					pWP->pRight = FindWaypointV2(pWP->RightPointId, pWP->laneId, map);
+					pWP->pRight = findWaypoint(pWP->RightPointId, pWP->laneId);
 
 					if(pWP->pRight != nullptr)
 					{
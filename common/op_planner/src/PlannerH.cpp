@@ -131,37 +131,24 @@ double PlannerH::PlanUsingDPRandom(const WayPoint& start,
 	return totalPlanningDistance;
 }
 
-double PlannerH::PlanUsingDP(const WayPoint& start,
-		const WayPoint& goalPos,
-		const double& maxPlanningDistance,
-		const bool bEnableLaneChange,
-		const std::vector<int>& globalPath,
-		RoadNetwork& map,
-		std::vector<std::vector<WayPoint> >& paths, vector<WayPoint*>* all_cell_to_delete)
+WayPoint* PlannerH::GetStartWaypoint(const WayPoint& start, RoadNetwork& map, RelativeInfo& start_info)
 {
 	PlannerHNS::WayPoint* pStart = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(start, map);
-	PlannerHNS::WayPoint* pGoal = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(goalPos, map);
-	bool bEnableGoalBranching = false;
 
-	if(!pStart ||  !pGoal)
+	if(!pStart)
 	{
 		GPSPoint sp = start.pos;
-		GPSPoint gp = goalPos.pos;
-		cout << endl << "Error: PlannerH -> Can't Find Global Waypoint Nodes in the Map for Start (" <<  sp.ToString() << ") and Goal (" << gp.ToString() << ")" << endl;
-		return 0;
+		cout << endl << "Error: PlannerH -> Can't Find Global Waypoint Nodes in the Map for Start (" <<  sp.ToString() << ")" << endl;
+		return nullptr;
 	}
 
-	if(!pStart->pLane || !pGoal->pLane)
+	if(!pStart->pLane)
 	{
-		cout << endl << "Error: PlannerH -> Null Lane, Start (" << pStart->pLane << ") and Goal (" << pGoal->pLane << ")" << endl;
-		return 0;
+		cout << endl << "Error: PlannerH -> Null Lane, Start (" << pStart->pLane << ")" << endl;
+		return nullptr;
 	}
 
-	RelativeInfo start_info, goal_info;
 	PlanningHelpers::GetRelativeInfo(pStart->pLane->points, start, start_info);
-	PlanningHelpers::GetRelativeInfo(pGoal->pLane->points, goalPos, goal_info);
-
-	vector<WayPoint> start_path, goal_path;
 
 	if(fabs(start_info.perp_distance) > START_POINT_MAX_DISTANCE)
 	{
@@ -169,9 +156,33 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 		cout << endl << "Error: PlannerH -> Start Distance to Lane is: " << start_info.perp_distance
 				<< ", Pose: " << sp.ToString() << ", LanePose:" << start_info.perp_point.pos.ToString()
 				<< ", LaneID: " << pStart->pLane->id << " -> Check origin and vector map. " << endl;
-		return 0;
+		return nullptr;
 	}
 
+	return pStart;
+}
+
+WayPoint* PlannerH::GetGoalWaypoint(const WayPoint& goalPos, const RelativeInfo& start_info, RoadNetwork& map,
+		vector<WayPoint>& goal_path)
+{
+	PlannerHNS::WayPoint* pGoal = PlannerHNS::MappingHelpers::GetClosestWaypointFromMap(goalPos, map);
+
+	if(!pGoal)
+	{
+		GPSPoint gp = goalPos.pos;
+		cout << endl << "Error: PlannerH -> Can't Find Global Waypoint Nodes in the Map for Goal (" << gp.ToString() << ")" << endl;
+		return nullptr;
+	}
+
+	if(!pGoal->pLane)
+	{
+		cout << endl << "Error: PlannerH -> Null Lane, Goal (" << pGoal->pLane << ")" << endl;
+		return nullptr;
+	}
+
+	RelativeInfo goal_info;
+	PlanningHelpers::GetRelativeInfo(pGoal->pLane->points, goalPos, goal_info);
+
 	if(fabs(goal_info.perp_distance) > GOAL_POINT_MAX_DISTANCE)
 	{
 		if(fabs(start_info.perp_distance) > 20)
@@ -180,7 +191,7 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 			cout << endl << "Error: PlannerH -> Goal Distance to Lane is: " << goal_info.perp_distance
 					<< ", Pose: " << gp.ToString() << ", LanePose:" << goal_info.perp_point.pos.ToString()
 					<< ", LaneID: " << pGoal->pLane->id << " -> Check origin and vector map. " << endl;
-			return 0;
+			return nullptr;
 		}
 		else
 		{
@@ -192,6 +203,45 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 		}
 	}
 
+	return pGoal;
+}
+
+void PlannerH::AttachGoalPath(vector<WayPoint> goal_path, std::vector<std::vector<WayPoint> >& paths)
+{
+	//attach goal path to the end of the paths
+	for(unsigned int i=0; i< paths.size(); i++ )
+	{
+		if(paths.at(i).size() > 0 && goal_path.size() > 0)
+		{
+			goal_path.insert(goal_path.begin(), paths.at(i).end()-5, paths.at(i).end());
+			PlanningHelpers::SmoothPath(goal_path, 0.25, 0.25);
+			PlanningHelpers::FixPathDensity(goal_path, 0.75);
+			PlanningHelpers::SmoothPath(goal_path, 0.25, 0.35);
+			paths.at(i).erase(paths.at(i).end()-5, paths.at(i).end());
+			paths.at(i).insert(paths.at(i).end(), goal_path.begin(), goal_path.end());
+		}
+	}
+}
+
+double PlannerH::PlanUsingDP(const WayPoint& start,
+		const WayPoint& goalPos,
+		const double& maxPlanningDistance,
+		const bool bEnableLaneChange,
+		const std::vector<int>& globalPath,
+		RoadNetwork& map,
+		std::vector<std::vector<WayPoint> >& paths, vector<WayPoint*>* all_cell_to_delete)
+{
+	RelativeInfo start_info;
+	vector<WayPoint> goal_path;
+
+	PlannerHNS::WayPoint* pStart = GetStartWaypoint(start, map, start_info);
+	if(!pStart)
+		return 0;
+
+	PlannerHNS::WayPoint* pGoal = GetGoalWaypoint(goalPos, start_info, map, goal_path);
+	if(!pGoal)
+		return 0;
+
 	vector<WayPoint*> local_cell_to_delete;
 	WayPoint* pLaneCell = 0;
 	char bPlan = 'A';
@@ -235,27 +285,7 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 		paths.push_back(path);
 	}
 
-	//attach start path to beginning of all paths, but goal path to only the path connected to the goal path.
-	for(unsigned int i=0; i< paths.size(); i++ )
-	{
-		paths.at(i).insert(paths.at(i).begin(), start_path.begin(), start_path.end());
-		if(paths.at(i).size() > 0)
-		{
-			//if(hypot(paths.at(i).at(paths.at(i).size()-1).pos.y-goal_info.perp_point.pos.y, paths.at(i).at(paths.at(i).size()-1).pos.x-goal_info.perp_point.pos.x) < 1.5)
-			{
-
-				if(paths.at(i).size() > 0 && goal_path.size() > 0)
-				{
-					goal_path.insert(goal_path.begin(), paths.at(i).end()-5, paths.at(i).end());
-					PlanningHelpers::SmoothPath(goal_path, 0.25, 0.25);
-					PlanningHelpers::FixPathDensity(goal_path, 0.75);
-					PlanningHelpers::SmoothPath(goal_path, 0.25, 0.35);
-					paths.at(i).erase(paths.at(i).end()-5, paths.at(i).end());
-					paths.at(i).insert(paths.at(i).end(), goal_path.begin(), goal_path.end());
-				}
-			}
-		}
-	}
+	AttachGoalPath(goal_path, paths);
 
 	cout << endl <<"Info: PlannerH -> Plan (" << bPlan << ") Path With Size (" << (int)path.size() << "), MultiPaths No(" << paths.size() << ") Extraction Time : " << endl;
 
@@ -275,6 +305,182 @@ double PlannerH::PlanUsingDP(const WayPoint& start,
 	return totalPlanningDistance;
 }
 
+void PlannerH::UpdateSearchTree(RouteSearchTree& tree, WayPoint* pStart, const double& maxPlanningDistance,
+		const bool bEnableLaneChange, const std::vector<int>& globalPath)
+{
+	if(!tree.IsBuiltFor(pStart, globalPath, maxPlanningDistance, bEnableLaneChange))
+		tree.Build(pStart, globalPath, maxPlanningDistance, bEnableLaneChange);
+}
+
+bool PlannerH::TraverseSearchTree(const RouteSearchTree& tree, WayPoint* pGoalCell, WayPoint* pStart,
+		const std::vector<int>& globalPath, vector<WayPoint>& path)
+{
+	vector<vector<WayPoint> > tempCurrentForwardPathss;
+	PlanningHelpers::TraversePathTreeBackwards(pGoalCell, tree.GetStart(), globalPath, path, tempCurrentForwardPathss);
+
+	if(pStart == tree.GetStart())
+		return true;
+
+	//the tree was expanded from a waypoint behind the start on the same lane, cut the route at the start
+	for(int i = (int)path.size()-1; i >= 0; i--)
+	{
+		if(path.at(i).id == pStart->id)
+		{
+			double start_cost = path.at(i).cost;
+			path.erase(path.begin(), path.begin()+i+1);
+			for(unsigned int j = 0; j < path.size(); j++)
+				path.at(j).cost -= start_cost;
+			return true;
+		}
+	}
+
+	path.clear();
+	return false;
+}
+
+int PlannerH::PlanUsingDPMultiGoal(const WayPoint& carPos, const std::vector<WayPoint>& goalsPos,
+		const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
+		RoadNetwork& map, std::vector<std::vector<std::vector<WayPoint> > >& paths, std::vector<double>& distances)
+{
+	paths.clear();
+	distances.clear();
+	paths.resize(goalsPos.size());
+	distances.resize(goalsPos.size(), 0);
+
+	RelativeInfo start_info;
+	PlannerHNS::WayPoint* pStart = GetStartWaypoint(carPos, map, start_info);
+	if(!pStart)
+		return 0;
+
+	UpdateSearchTree(m_SearchTree, pStart, maxPlanningDistance, bEnableLaneChange, globalPath);
+
+	//a goal missing from the tree is not reachable, PlanUsingDP falls back to plan (B) in that case but the straight tree
+	//is built with the cells of the fully expanded plan (A) tree, so it never finds a path either
+	int nPlanned = 0;
+
+	for(unsigned int ig = 0; ig < goalsPos.size(); ig++)
+	{
+		vector<WayPoint> goal_path;
+		PlannerHNS::WayPoint* pGoal = GetGoalWaypoint(goalsPos.at(ig), start_info, map, goal_path);
+		if(!pGoal)
+			continue;
+
+		vector<WayPoint> path;
+		WayPoint* pGoalCell = m_SearchTree.FindGoalCell(*pGoal);
+		if(!pGoalCell)
+			continue;
+
+		if(!TraverseSearchTree(m_SearchTree, pGoalCell, pStart, globalPath, path))
+		{
+			//the route doesn't pass by the current start, expand a new tree from it
+			m_SearchTree.Build(pStart, globalPath, maxPlanningDistance, bEnableLaneChange);
+			pGoalCell = m_SearchTree.FindGoalCell(*pGoal);
+			if(!pGoalCell)
+				continue;
+			TraverseSearchTree(m_SearchTree, pGoalCell, pStart, globalPath, path);
+		}
+
+		if(path.size() < 2)
+			continue;
+
+		PlanningHelpers::ExtractPlanAlernatives(path, paths.at(ig));
+		AttachGoalPath(goal_path, paths.at(ig));
+		distances.at(ig) = path.back().cost;
+		nPlanned++;
+	}
+
+	cout << endl <<"Info: PlannerH -> Multi Goal Plan, Goals (" << goalsPos.size() << "), Planned (" << nPlanned << "), Tree Cells (" << m_SearchTree.GetCellsCount() << ")" << endl;
+
+	return nPlanned;
+}
+
+double PlannerH::PlanUsingDPViaPoints(const WayPoint& carPos, const std::vector<WayPoint>& viaPoints,
+		const double& maxPlanningDistance, const bool bEnableLaneChange, const std::vector<int>& globalPath,
+		RoadNetwork& map, std::vector<std::vector<WayPoint> >& paths)
+{
+	paths.clear();
+	if(viaPoints.size() == 0)
+		return 0;
+
+	RelativeInfo start_info;
+	PlannerHNS::WayPoint* pStart = GetStartWaypoint(carPos, map, start_info);
+	if(!pStart)
+		return 0;
+
+	//passed via points are dropped from the front, keep the trees of the remaining ones at their legs
+	if(m_ViaPointsSearchTrees.size() > viaPoints.size() - 1)
+		m_ViaPointsSearchTrees.erase(m_ViaPointsSearchTrees.begin(), m_ViaPointsSearchTrees.end() - (viaPoints.size() - 1));
+	else if(m_ViaPointsSearchTrees.size() < viaPoints.size() - 1)
+		m_ViaPointsSearchTrees.resize(viaPoints.size() - 1);
+
+	vector<WayPoint> route;
+	vector<WayPoint> goal_path;
+	WayPoint* pLegStart = pStart;
+
+	for(unsigned int iv = 0; iv < viaPoints.size(); iv++)
+	{
+		vector<WayPoint> via_path;
+		PlannerHNS::WayPoint* pVia = GetGoalWaypoint(viaPoints.at(iv), start_info, map, via_path);
+		if(!pVia)
+			return 0;
+
+		//only the final goal is joined to the off lane goal pose, the route passes by the lane waypoints of the via points
+		if(iv + 1 == viaPoints.size())
+			goal_path = via_path;
+
+		RouteSearchTree& tree = iv == 0 ? m_SearchTree : m_ViaPointsSearchTrees.at(iv - 1);
+		UpdateSearchTree(tree, pLegStart, maxPlanningDistance, bEnableLaneChange, globalPath);
+
+		bool bReached = false;
+		WayPoint* pViaCell = tree.FindGoalCell(*pVia, &bReached);
+		vector<WayPoint> leg;
+		if(!bReached || !TraverseSearchTree(tree, pViaCell, pLegStart, globalPath, leg))
+		{
+			if(tree.GetStart() != pLegStart)
+			{
+				tree.Build(pLegStart, globalPath, maxPlanningDistance, bEnableLaneChange);
+				pViaCell = tree.FindGoalCell(*pVia, &bReached);
+				leg.clear();
+				if(bReached)
+					TraverseSearchTree(tree, pViaCell, pLegStart, globalPath, leg);
+			}
+
+			if(!bReached)
+			{
+				GPSPoint vp = viaPoints.at(iv).pos;
+				cout << endl << "Error: PlannerH -> Can't Reach Via Point " << iv << " (" << vp.ToString() << ")" << endl;
+				return 0;
+			}
+		}
+
+		double leg_start_cost = route.size() > 0 ? route.back().cost : 0;
+		for(unsigned int i = 0; i < leg.size(); i++)
+			leg.at(i).cost += leg_start_cost;
+
+		route.insert(route.end(), leg.begin(), leg.end());
+		pLegStart = pVia;
+	}
+
+	if(route.size() < 2)
+	{
+		cout << endl << "Err: PlannerH -> Invalid Via Points Path, Car Should Stop." << endl;
+		return 0;
+	}
+
+	PlanningHelpers::ExtractPlanAlernatives(route, paths);
+	AttachGoalPath(goal_path, paths);
+
+	cout << endl <<"Info: PlannerH -> Via Points Plan, Via Points (" << viaPoints.size() << "), Path With Size (" << (int)route.size() << "), MultiPaths No(" << paths.size() << ")" << endl;
+
+	return route.back().cost;
+}
+
+void PlannerH::ClearSearchTree()
+{
+	m_SearchTree.Clear();
+	m_ViaPointsSearchTrees.clear();
+}
+
 double PlannerH::PredictPlanUsingDP(PlannerHNS::Lane* l, const WayPoint& start, const double& maxPlanningDistance, std::vector<std::vector<WayPoint> >& paths)
 {
 	if(!l)
@@ -0,0 +1,258 @@
+
+/// \file RouteSearchTree.cpp
+/// \brief Search tree expanded once from a start waypoint, answers the routes to many goals without new expansions
+/// \date Oct 18, 2026
+
+#include "op_planner/RouteSearchTree.h"
+#include "op_planner/PlanningHelpers.h"
+#include <math.h>
+#include <queue>
+#include <unordered_set>
+
+using namespace std;
+using namespace UtilityHNS;
+
+namespace PlannerHNS
+{
+
+//goal tolerance of BuildPlanningSearchTreeV2
+#define GOAL_CELL_MAX_DISTANCE 0.1
+#define GOAL_CELL_MAX_ANGLE M_PI_4
+//grid cell size of the expanded cells index, larger than the goal tolerance so that only the neighbor cells are searched
+#define EXPANDED_GRID_CELL_SIZE 0.2
+
+namespace
+{
+struct OpenCell
+{
+	double cost;
+	unsigned int order;
+	WayPoint* pCell;
+};
+
+//BuildPlanningSearchTreeV2 expands the first cell with the minimum cost, in insertion order
+struct OpenCellGreater
+{
+	bool operator()(const OpenCell& a, const OpenCell& b) const
+	{
+		if(a.cost != b.cost)
+			return a.cost > b.cost;
+		return a.order > b.order;
+	}
+};
+
+uint64_t GetNodeKey(const WayPoint* pWP)
+{
+	return (uint64_t)(uint32_t)pWP->laneId << 32 | (uint32_t)pWP->id;
+}
+}
+
+RouteSearchTree::RouteSearchTree()
+{
+	m_pStart = nullptr;
+	m_DistanceLimit = 0;
+	m_bEnableLaneChange = false;
+	m_pLimitCell = nullptr;
+}
+
+RouteSearchTree::~RouteSearchTree()
+{
+	Clear();
+}
+
+RouteSearchTree::RouteSearchTree(const RouteSearchTree& other)
+{
+	m_pStart = nullptr;
+	m_DistanceLimit = 0;
+	m_bEnableLaneChange = false;
+	m_pLimitCell = nullptr;
+}
+
+RouteSearchTree& RouteSearchTree::operator=(const RouteSearchTree& other)
+{
+	if(this != &other)
+		Clear();
+	return *this;
+}
+
+void RouteSearchTree::Clear()
+{
+	for(unsigned int i = 0; i < m_Cells.size(); i++)
+		delete m_Cells.at(i);
+
+	m_Cells.clear();
+	m_Expanded.clear();
+	m_ExpandedGrid.clear();
+	m_GlobalPath.clear();
+	m_pStart = nullptr;
+	m_pLimitCell = nullptr;
+}
+
+uint64_t RouteSearchTree::GetGridKey(const int& col, const int& row) const
+{
+	//shifted as unsigned, cells at negative coordinates would be undefined for a signed shift
+	return (uint64_t)(uint32_t)col << 32 | (uint32_t)row;
+}
+
+void RouteSearchTree::IndexExpandedCell(WayPoint* pCell)
+{
+	int col = floor(pCell->pos.x / EXPANDED_GRID_CELL_SIZE);
+	int row = floor(pCell->pos.y / EXPANDED_GRID_CELL_SIZE);
+	m_ExpandedGrid[GetGridKey(col, row)].push_back(m_Expanded.size());
+	m_Expanded.push_back(pCell);
+}
+
+void RouteSearchTree::Build(WayPoint* pStart, const std::vector<int>& globalPath, const double& distanceLimit, const bool& bEnableLaneChange)
+{
+	Clear();
+	if(!pStart) return;
+
+	m_pStart = pStart;
+	m_GlobalPath = globalPath;
+	m_DistanceLimit = distanceLimit;
+	m_bEnableLaneChange = bEnableLaneChange;
+
+	//same expansion as BuildPlanningSearchTreeV2, with a heap instead of the linear scan of the open cells,
+	//and hash sets instead of the linear CheckNodeExits and CheckLaneExits over all the created cells
+	priority_queue<OpenCell, vector<OpenCell>, OpenCellGreater> nextLeafToTrace;
+	unordered_set<uint64_t> created_nodes;
+	unordered_set<const Lane*> created_lanes;
+	unsigned int order = 0;
+
+	WayPoint* wp = new WayPoint();
+	*wp = *pStart;
+	m_Cells.push_back(wp);
+	created_nodes.insert(GetNodeKey(wp));
+	created_lanes.insert(wp->pLane);
+	nextLeafToTrace.push({wp->cost, order++, wp});
+
+	double distance = 0;
+	double before_change_distance = 0;
+
+	while(nextLeafToTrace.size() > 0)
+	{
+		WayPoint* pH = nextLeafToTrace.top().pCell;
+		nextLeafToTrace.pop();
+		IndexExpandedCell(pH);
+
+		WayPoint* pSides[2] = {pH->pLeft, pH->pRight};
+		for(unsigned int is = 0; is < 2; is++)
+		{
+			WayPoint* pSide = pSides[is];
+			if(pSide && created_lanes.find(pSide->pLane) == created_lanes.end() && created_nodes.find(GetNodeKey(pSide)) == created_nodes.end()
+					&& bEnableLaneChange && before_change_distance > LANE_CHANGE_MIN_DISTANCE)
+			{
+				wp = new WayPoint();
+				*wp = *pSide;
+				double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
+				distance += d;
+				before_change_distance = -LANE_CHANGE_MIN_DISTANCE*3;
+
+				for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+					d += wp->actionCost.at(a).second;
+
+				wp->cost = pH->cost + d;
+				if(is == 0)
+				{
+					wp->pRight = pH;
+					wp->pLeft = 0;
+				}
+				else
+				{
+					wp->pLeft = pH;
+					wp->pRight = 0;
+				}
+
+				m_Cells.push_back(wp);
+				created_nodes.insert(GetNodeKey(wp));
+				created_lanes.insert(wp->pLane);
+				nextLeafToTrace.push({wp->cost, order++, wp});
+			}
+		}
+
+		for(unsigned int i = 0; i < pH->pFronts.size(); i++)
+		{
+			if(PlanningHelpers::CheckLaneIdExits(globalPath, pH->pLane) && pH->pFronts.at(i) && created_nodes.find(GetNodeKey(pH->pFronts.at(i))) == created_nodes.end())
+			{
+				wp = new WayPoint();
+				*wp = *pH->pFronts.at(i);
+
+				double d = hypot(wp->pos.y - pH->pos.y, wp->pos.x - pH->pos.x);
+				distance += d;
+				before_change_distance += d;
+
+				for(unsigned int a = 0; a < wp->actionCost.size(); a++)
+					d += wp->actionCost.at(a).second;
+
+				wp->cost = pH->cost + d;
+				wp->pBacks.push_back(pH);
+
+				m_Cells.push_back(wp);
+				created_nodes.insert(GetNodeKey(wp));
+				created_lanes.insert(wp->pLane);
+				nextLeafToTrace.push({wp->cost, order++, wp});
+			}
+		}
+
+		if(distance > distanceLimit && globalPath.size() == 0)
+		{
+			m_pLimitCell = pH;
+			break;
+		}
+	}
+}
+
+bool RouteSearchTree::IsBuiltFor(const WayPoint* pStart, const std::vector<int>& globalPath, const double& distanceLimit, const bool& bEnableLaneChange) const
+{
+	if(!m_pStart || !pStart || !pStart->pLane || pStart->pLane != m_pStart->pLane)
+		return false;
+
+	if(globalPath != m_GlobalPath || distanceLimit != m_DistanceLimit || bEnableLaneChange != m_bEnableLaneChange)
+		return false;
+
+	const std::vector<WayPoint>& lane_points = pStart->pLane->points;
+	if(lane_points.size() == 0 || pStart < &lane_points.front() || pStart > &lane_points.back())
+		return false;
+
+	return pStart >= m_pStart;
+}
+
+WayPoint* RouteSearchTree::FindGoalCell(const WayPoint& goalPos, bool* bReached) const
+{
+	int col = floor(goalPos.pos.x / EXPANDED_GRID_CELL_SIZE);
+	int row = floor(goalPos.pos.y / EXPANDED_GRID_CELL_SIZE);
+	double goal_angle = UtilityH::FixNegativeAngle(goalPos.pos.a);
+
+	unsigned int first_index = m_Expanded.size();
+	for(int c = col - 1; c <= col + 1; c++)
+	{
+		for(int r = row - 1; r <= row + 1; r++)
+		{
+			unordered_map<uint64_t, vector<unsigned int> >::const_iterator cell = m_ExpandedGrid.find(GetGridKey(c, r));
+			if(cell == m_ExpandedGrid.end())
+				continue;
+
+			for(unsigned int i = 0; i < cell->second.size() && cell->second.at(i) < first_index; i++)
+			{
+				const WayPoint* pH = m_Expanded.at(cell->second.at(i));
+				double distance_to_goal = distance2points(pH->pos, goalPos.pos);
+				double angle_to_goal = UtilityH::AngleBetweenTwoAnglesPositive(UtilityH::FixNegativeAngle(pH->pos.a), goal_angle);
+				if(distance_to_goal <= GOAL_CELL_MAX_DISTANCE && angle_to_goal < GOAL_CELL_MAX_ANGLE)
+				{
+					first_index = cell->second.at(i);
+					break;
+				}
+			}
+		}
+	}
+
+	if(bReached)
+		*bReached = first_index < m_Expanded.size();
+
+	if(first_index < m_Expanded.size())
+		return m_Expanded.at(first_index);
+
+	return m_pLimitCell;
+}
+
+} /* namespace PlannerHNS */
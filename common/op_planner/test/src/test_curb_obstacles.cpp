@@ -0,0 +1,221 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "op_planner/CurbObstacles.h"
+
+using namespace PlannerHNS;
+
+namespace
+{
+// the previous op_motion_predictor extraction, visits every curb of the map
+void generateCurbsObstacles(const std::vector<Curb>& curbs, const WayPoint& curr_pos, double horizon,
+                            double distance_between_curbs, std::vector<DetectedObject>& curb_obstacles)
+{
+  for (unsigned int ic = 0; ic < curbs.size(); ic++)
+  {
+    if (curbs.at(ic).points.size() > 0)
+    {
+      DetectedObject obj;
+      obj.center.pos = curbs.at(ic).points.at(0);
+
+      if (curb_obstacles.size() > 0)
+      {
+        double distance_to_prev = hypot(curb_obstacles.back().center.pos.y - obj.center.pos.y,
+                                        curb_obstacles.back().center.pos.x - obj.center.pos.x);
+        if (distance_to_prev < distance_between_curbs)
+          continue;
+      }
+
+      double longitudinalDist = hypot(curr_pos.pos.y - obj.center.pos.y, curr_pos.pos.x - obj.center.pos.x);
+      if (longitudinalDist > horizon)
+        continue;
+
+      obj.bDirection = false;
+      obj.bVelocity = false;
+      obj.id = -1;
+      obj.t = SIDEWALK;
+      obj.label = "curb";
+      for (unsigned int icp = 0; icp < curbs.at(ic).points.size(); icp++)
+        obj.contour.push_back(curbs.at(ic).points.at(icp));
+
+      curb_obstacles.push_back(obj);
+    }
+  }
+}
+
+// short curb segments along both borders of parallel roads, one curb without points after each road
+std::vector<Curb> createCurbs(int n_roads, double road_length, std::mt19937& gen)
+{
+  std::uniform_real_distribution<double> noise(-0.3, 0.3);
+  std::vector<Curb> curbs;
+  for (int r = 0; r < n_roads; r++)
+  {
+    for (double s = 0; s < road_length; s += 1.5)
+    {
+      for (const double side : { -3.5, 3.5 })
+      {
+        Curb c;
+        c.id = curbs.size() + 1;
+        for (int i = 0; i < 3; i++)
+        {
+          if (r % 2 == 0)
+            c.points.push_back(GPSPoint(s + i * 0.5, r * 40.0 + side + noise(gen), 0, 0));
+          else
+            c.points.push_back(GPSPoint(r * 40.0 + side + noise(gen), s + i * 0.5, 0, 0));
+        }
+        curbs.push_back(c);
+      }
+    }
+    curbs.push_back(Curb());
+  }
+  return curbs;
+}
+
+void expectSameObstacles(const std::vector<DetectedObject>& expected, const std::vector<DetectedObject>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (unsigned int i = 0; i < expected.size(); i++)
+  {
+    EXPECT_EQ(expected.at(i).center.pos.x, actual.at(i).center.pos.x);
+    EXPECT_EQ(expected.at(i).center.pos.y, actual.at(i).center.pos.y);
+    EXPECT_EQ(expected.at(i).id, actual.at(i).id);
+    EXPECT_EQ(expected.at(i).t, actual.at(i).t);
+    EXPECT_EQ(expected.at(i).label, actual.at(i).label);
+    ASSERT_EQ(expected.at(i).contour.size(), actual.at(i).contour.size());
+    for (unsigned int j = 0; j < expected.at(i).contour.size(); j++)
+    {
+      EXPECT_EQ(expected.at(i).contour.at(j).x, actual.at(i).contour.at(j).x);
+      EXPECT_EQ(expected.at(i).contour.at(j).y, actual.at(i).contour.at(j).y);
+    }
+  }
+}
+}  // namespace
+
+TEST(TestCurbObstacles, sameAsFullScan)
+{
+  std::mt19937 gen(0);
+  std::vector<Curb> curbs = createCurbs(8, 300, gen);
+  std::uniform_real_distribution<double> pos(-50, 350);
+
+  for (const double cell_size : { 1.0, 10.0, 100.0 })
+  {
+    CurbObstacles index;
+    index.SetCurbs(curbs, cell_size);
+    std::vector<DetectedObject> obstacles;
+    for (int i = 0; i < 100; i++)
+    {
+      WayPoint curr_pos(pos(gen), pos(gen), 0, 0);
+      for (const double horizon : { 0.0, 15.0, 120.0, 1000.0 })
+      {
+        std::vector<DetectedObject> expected;
+        generateCurbsObstacles(curbs, curr_pos, horizon, 1.0, expected);
+        index.GetObstacles(curr_pos, horizon, 1.0, obstacles);
+        expectSameObstacles(expected, obstacles);
+      }
+    }
+  }
+}
+
+TEST(TestCurbObstacles, reuseUnchangedSelection)
+{
+  std::mt19937 gen(1);
+  std::vector<Curb> curbs = createCurbs(2, 100, gen);
+
+  CurbObstacles index;
+  std::vector<DetectedObject> obstacles;
+  EXPECT_TRUE(index.GetObstacles(WayPoint(0, 0, 0, 0), 10, 1.0, obstacles));
+  EXPECT_TRUE(obstacles.empty());
+
+  index.SetCurbs(curbs);
+  EXPECT_EQ(index.GetCurbsCount(), curbs.size() - 2);
+  EXPECT_TRUE(index.GetObstacles(WayPoint(50, 0, 0, 0), 10, 1.0, obstacles));
+  EXPECT_FALSE(obstacles.empty());
+  std::vector<DetectedObject> first = obstacles;
+
+  // a small move doesn't reach another curb, the previous obstacles are kept
+  EXPECT_FALSE(index.GetObstacles(WayPoint(50.01, 0, 0, 0), 10, 1.0, obstacles));
+  expectSameObstacles(first, obstacles);
+
+  EXPECT_TRUE(index.GetObstacles(WayPoint(60, 0, 0, 0), 10, 1.0, obstacles));
+  std::vector<DetectedObject> expected;
+  generateCurbsObstacles(curbs, WayPoint(60, 0, 0, 0), 10, 1.0, expected);
+  expectSameObstacles(expected, obstacles);
+
+  EXPECT_TRUE(index.GetObstacles(WayPoint(5000, 5000, 0, 0), 10, 1.0, obstacles));
+  EXPECT_TRUE(obstacles.empty());
+}
+
+TEST(TestCurbObstacles, benchmark)
+{
+  std::mt19937 gen(2);
+  std::vector<Curb> curbs = createCurbs(40, 4000, gen);
+  const double horizon = 120;
+  const int n_cycles = 200;
+
+  // vehicle driving along the first road, 25 Hz at 10 m/s
+  std::vector<WayPoint> path;
+  for (int i = 0; i < n_cycles; i++)
+    path.push_back(WayPoint(100 + i * 0.4, 0, 0, 0));
+
+  auto start = std::chrono::steady_clock::now();
+  size_t n_scan = 0;
+  std::vector<DetectedObject> scan_obstacles;
+  for (const WayPoint& p : path)
+  {
+    scan_obstacles.clear();
+    generateCurbsObstacles(curbs, p, horizon, 1.0, scan_obstacles);
+    n_scan += scan_obstacles.size();
+  }
+  double scan_usec =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / n_cycles;
+
+  start = std::chrono::steady_clock::now();
+  CurbObstacles index;
+  index.SetCurbs(curbs);
+  double build_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  size_t n_index = 0;
+  int n_changed = 0;
+  std::vector<DetectedObject> index_obstacles;
+  for (const WayPoint& p : path)
+  {
+    if (index.GetObstacles(p, horizon, 1.0, index_obstacles))
+      n_changed++;
+    n_index += index_obstacles.size();
+  }
+  double index_usec =
+      std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / n_cycles;
+
+  printf("[ %zu curbs ] full scan: %9.1f us/cycle, grid index: %7.1f us/cycle (%d of %d cycles changed), "
+         "index build: %.1f ms\n",
+         curbs.size(), scan_usec, index_usec, n_changed, n_cycles, build_msec);
+  EXPECT_EQ(n_scan, n_index);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,394 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <stdio.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "op_planner/KmlMapLoader.h"
+#include "op_planner/MappingHelpers.h"
+
+using namespace PlannerHNS;
+
+namespace
+{
+std::string ids(const std::vector<int>& list)
+{
+  std::ostringstream os;
+  for (unsigned int i = 0; i < list.size(); i++)
+    os << "_" << list.at(i);
+  os << "_";
+  return os.str();
+}
+
+void writePlacemark(std::ostream& os, const std::string& name, const std::string& geometry, int n_points, double x,
+                    double y)
+{
+  os << "<Placemark><name>" << name << "</name><" << geometry << "><coordinates>";
+  for (int i = 0; i < n_points; i++)
+    os << (i > 0 ? " " : "") << x + i * 0.5 << "," << y - i * 0.25 << "," << 0.1 * i;
+  os << "</coordinates></" << geometry << "></Placemark>\n";
+}
+
+/**
+ * OpenPlanner .kml map with rows of parallel lanes, each lane connected to the next one in its row
+ * and with left/right neighbour points, plus every other map element type.
+ */
+std::string createKml(int n_rows, int n_lanes, int n_points, bool ver_zero)
+{
+  std::ostringstream os;
+  os << std::setprecision(10);
+  os << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+     << "<kml xmlns=\"http://www.opengis.net/kml/2.2\">\n<Folder>\n<name>OpenPlanner Map</name>\n"
+     << "<Document>\n<name>Map &amp; Data</name>\n<!-- generated <Folder> -->\n";
+
+  os << "<Folder><name>Lanes</name>\n";
+  int wp_id = 1;
+  for (int r = 0; r < n_rows; r++)
+  {
+    for (int l = 0; l < n_lanes; l++)
+    {
+      int id = 1 + r * n_lanes + l;
+      std::vector<int> from, to;
+      if (l > 0)
+        from.push_back(id - 1);
+      if (l + 1 < n_lanes)
+        to.push_back(id + 1);
+
+      os << "<Folder>\n<name>Lane_" << id << "</name>\n"
+         << "<description>LID_" << id << "_RSID_1_NUM_" << r << "_From" << ids(from) << "To" << ids(to)
+         << "Vel_" << 20 + r << "</description>\n<Folder><description>";
+      for (int p = 0; p < n_points; p++)
+      {
+        std::vector<int> wp_from, wp_to;
+        wp_from.push_back(p == 0 ? (l > 0 ? wp_id - 1 : 0) : wp_id - 1);
+        if (p + 1 < n_points || l + 1 < n_lanes)
+          wp_to.push_back(wp_id + 1);
+        int left = (r > 0) ? wp_id - n_lanes * n_points : 0;
+        int right = (r + 1 < n_rows) ? wp_id + n_lanes * n_points : 0;
+        if (ver_zero)
+          os << "WPID_" << wp_id << "_C_0_From" << ids(wp_from) << "To" << ids(wp_to) << "Vel_" << 1.5 + 0.01 * p
+             << "_Dir_" << 0.001 * p << ",";
+        else
+          os << "WPID_" << wp_id << "_AC_" << (p % 3 == 0 ? "F" : (p % 3 == 1 ? "L" : "R")) << "_" << p % 7
+             << "_From" << ids(wp_from) << "To" << ids(wp_to) << "Lid_" << left << "_Rid_" << right << "_Vel_"
+             << 1.5 + 0.01 * p << "_Dir_" << 0.001 * p << ",";
+        wp_id++;
+      }
+      os << "</description></Folder>\n<Placemark><name>Lane_" << id << "_Line</name><LineString>\n<coordinates>";
+      for (int p = 0; p < n_points; p++)
+        os << "\n  " << (l * n_points + p) * 1.01 + 0.123456789 << "," << r * 3.5 - 0.5 << "," << 0.01 * p;
+      os << "\n</coordinates></LineString></Placemark>\n</Folder>\n";
+    }
+  }
+  os << "</Folder>\n";
+
+  os << "<Folder><name>RoadSegments</name>\n<Placemark><name>Road</name><description>RSID_1</description></Placemark>\n"
+     << "</Folder>\n";
+
+  os << "<Folder><name>TrafficLights</name>\n";
+  for (int i = 1; i <= 5; i++)
+  {
+    std::ostringstream name;
+    name << "TLID_" << i << "_LnID_" << i << "_" << i + n_lanes << "_";
+    writePlacemark(os, name.str(), "Point", 1, i * 10.0, 5.0);
+  }
+  os << "</Folder>\n<Folder><name>StopLines</name>\n";
+  for (int i = 1; i <= 5; i++)
+  {
+    std::ostringstream name;
+    name << "SLID_" << i << "_LnID_" << i << "_TSID_0_TLID_" << i << "_";
+    writePlacemark(os, name.str(), "LineString", 2, i * 10.0, 2.0);
+  }
+  os << "</Folder>\n<Folder><name>TrafficSigns</name>\n";
+  for (int i = 1; i <= 5; i++)
+  {
+    std::ostringstream name;
+    name << "TSID_" << i << "_LnID_" << i << "_RdID_1_Type_" << i % 5 << "_";
+    writePlacemark(os, name.str(), "LineString", 1, i * 7.0, 1.0);
+  }
+  os << "</Folder>\n<Folder><name>Crossings</name>\n";
+  writePlacemark(os, "CRID_1_RdID_1_", "LineString", 4, 1.0, 1.0);
+  os << "</Folder>\n<Folder><name>Markings</name>\n";
+  writePlacemark(os, "MID_1_LnID_2_RdID_1_", "LineString", 5, 2.0, 2.0);
+  os << "</Folder>\n<Folder><name>Boundaries</name>\n";
+  writePlacemark(os, "BID_1_RdID_1_", "LineString", 6, 3.0, 3.0);
+  os << "</Folder>\n<Folder><name>CurbsLines</name>\n";
+  for (int i = 1; i <= 3; i++)
+  {
+    std::ostringstream name;
+    name << "BID_" << i << "_LnID_" << i << "_RdID_1_";
+    writePlacemark(os, name.str(), "LineString", 3 + i, i * 4.0, -3.0);
+  }
+  os << "</Folder>\n</Document>\n</Folder>\n</kml>\n";
+  return os.str();
+}
+
+std::string writeTempFile(const std::string& content)
+{
+  char file_name[] = "/tmp/test_kml_map_loaderXXXXXX";
+  int fd = mkstemp(file_name);
+  close(fd);
+  std::ofstream f(file_name);
+  f << content;
+  return file_name;
+}
+
+void expectSamePoint(const GPSPoint& a, const GPSPoint& b)
+{
+  EXPECT_EQ(a.x, b.x);
+  EXPECT_EQ(a.y, b.y);
+  EXPECT_EQ(a.z, b.z);
+  EXPECT_EQ(a.lat, b.lat);
+  EXPECT_EQ(a.lon, b.lon);
+  EXPECT_EQ(a.alt, b.alt);
+  EXPECT_EQ(a.a, b.a);
+  EXPECT_EQ(a.dir, b.dir);
+}
+
+void expectSamePoints(const std::vector<GPSPoint>& a, const std::vector<GPSPoint>& b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (unsigned int i = 0; i < a.size(); i++)
+    expectSamePoint(a.at(i), b.at(i));
+}
+
+void expectSameLanes(const std::vector<Lane>& a, const std::vector<Lane>& b)
+{
+  ASSERT_EQ(a.size(), b.size());
+  for (unsigned int i = 0; i < a.size(); i++)
+  {
+    const Lane& la = a.at(i);
+    const Lane& lb = b.at(i);
+    EXPECT_EQ(la.id, lb.id);
+    EXPECT_EQ(la.roadId, lb.roadId);
+    EXPECT_EQ(la.num, lb.num);
+    EXPECT_EQ(la.speed, lb.speed);
+    EXPECT_EQ(la.fromIds, lb.fromIds);
+    EXPECT_EQ(la.toIds, lb.toIds);
+    ASSERT_EQ(la.points.size(), lb.points.size());
+    for (unsigned int p = 0; p < la.points.size(); p++)
+    {
+      const WayPoint& wa = la.points.at(p);
+      const WayPoint& wb = lb.points.at(p);
+      expectSamePoint(wa.pos, wb.pos);
+      EXPECT_EQ(wa.id, wb.id);
+      EXPECT_EQ(wa.laneId, wb.laneId);
+      EXPECT_EQ(wa.v, wb.v);
+      EXPECT_EQ(wa.LeftPointId, wb.LeftPointId);
+      EXPECT_EQ(wa.RightPointId, wb.RightPointId);
+      EXPECT_EQ(wa.fromIds, wb.fromIds);
+      EXPECT_EQ(wa.toIds, wb.toIds);
+      EXPECT_EQ(wa.actionCost, wb.actionCost);
+    }
+  }
+}
+
+/**
+ * Map elements the way MappingHelpers::LoadKML read them before, from the TinyXML document
+ */
+struct DocumentMap
+{
+  std::vector<Lane> lanes;
+  std::vector<RoadSegment> roadSegments;
+  std::vector<TrafficLight> trafficLights;
+  std::vector<StopLine> stopLines;
+  std::vector<TrafficSign> signs;
+  std::vector<Crossing> crossings;
+  std::vector<Marking> markings;
+  std::vector<Boundary> boundaries;
+  std::vector<Curb> curbs;
+
+  explicit DocumentMap(const std::string& file_name)
+  {
+    TiXmlDocument doc(file_name);
+    doc.LoadFile();
+    TiXmlElement* pHeadElem = MappingHelpers::GetHeadElement(doc.FirstChildElement());
+    lanes = MappingHelpers::GetLanesList(pHeadElem);
+    roadSegments = MappingHelpers::GetRoadSegmentsList(pHeadElem);
+    trafficLights = MappingHelpers::GetTrafficLightsList(pHeadElem);
+    stopLines = MappingHelpers::GetStopLinesList(pHeadElem);
+    signs = MappingHelpers::GetTrafficSignsList(pHeadElem);
+    crossings = MappingHelpers::GetCrossingsList(pHeadElem);
+    markings = MappingHelpers::GetMarkingsList(pHeadElem);
+    boundaries = MappingHelpers::GetBoundariesList(pHeadElem);
+    curbs = MappingHelpers::GetCurbsList(pHeadElem);
+  }
+};
+
+void expectSameElements(const KmlMapLoader& loader, const DocumentMap& doc)
+{
+  expectSameLanes(loader.lanes, doc.lanes);
+
+  ASSERT_EQ(loader.roadSegments.size(), doc.roadSegments.size());
+  for (unsigned int i = 0; i < doc.roadSegments.size(); i++)
+    EXPECT_EQ(loader.roadSegments.at(i).id, doc.roadSegments.at(i).id);
+
+  ASSERT_EQ(loader.trafficLights.size(), doc.trafficLights.size());
+  for (unsigned int i = 0; i < doc.trafficLights.size(); i++)
+  {
+    EXPECT_EQ(loader.trafficLights.at(i).id, doc.trafficLights.at(i).id);
+    EXPECT_EQ(loader.trafficLights.at(i).laneIds, doc.trafficLights.at(i).laneIds);
+    expectSamePoint(loader.trafficLights.at(i).pos, doc.trafficLights.at(i).pos);
+  }
+
+  ASSERT_EQ(loader.stopLines.size(), doc.stopLines.size());
+  for (unsigned int i = 0; i < doc.stopLines.size(); i++)
+  {
+    EXPECT_EQ(loader.stopLines.at(i).id, doc.stopLines.at(i).id);
+    EXPECT_EQ(loader.stopLines.at(i).laneId, doc.stopLines.at(i).laneId);
+    EXPECT_EQ(loader.stopLines.at(i).stopSignID, doc.stopLines.at(i).stopSignID);
+    EXPECT_EQ(loader.stopLines.at(i).trafficLightID, doc.stopLines.at(i).trafficLightID);
+    expectSamePoints(loader.stopLines.at(i).points, doc.stopLines.at(i).points);
+  }
+
+  ASSERT_EQ(loader.signs.size(), doc.signs.size());
+  for (unsigned int i = 0; i < doc.signs.size(); i++)
+  {
+    EXPECT_EQ(loader.signs.at(i).id, doc.signs.at(i).id);
+    EXPECT_EQ(loader.signs.at(i).laneId, doc.signs.at(i).laneId);
+    EXPECT_EQ(loader.signs.at(i).roadId, doc.signs.at(i).roadId);
+    EXPECT_EQ(loader.signs.at(i).signType, doc.signs.at(i).signType);
+    expectSamePoint(loader.signs.at(i).pos, doc.signs.at(i).pos);
+  }
+
+  ASSERT_EQ(loader.crossings.size(), doc.crossings.size());
+  for (unsigned int i = 0; i < doc.crossings.size(); i++)
+  {
+    EXPECT_EQ(loader.crossings.at(i).id, doc.crossings.at(i).id);
+    EXPECT_EQ(loader.crossings.at(i).roadId, doc.crossings.at(i).roadId);
+    expectSamePoints(loader.crossings.at(i).points, doc.crossings.at(i).points);
+  }
+
+  ASSERT_EQ(loader.markings.size(), doc.markings.size());
+  for (unsigned int i = 0; i < doc.markings.size(); i++)
+  {
+    EXPECT_EQ(loader.markings.at(i).id, doc.markings.at(i).id);
+    EXPECT_EQ(loader.markings.at(i).laneId, doc.markings.at(i).laneId);
+    EXPECT_EQ(loader.markings.at(i).roadId, doc.markings.at(i).roadId);
+    expectSamePoint(loader.markings.at(i).center, doc.markings.at(i).center);
+    expectSamePoints(loader.markings.at(i).points, doc.markings.at(i).points);
+  }
+
+  ASSERT_EQ(loader.boundaries.size(), doc.boundaries.size());
+  for (unsigned int i = 0; i < doc.boundaries.size(); i++)
+  {
+    EXPECT_EQ(loader.boundaries.at(i).id, doc.boundaries.at(i).id);
+    EXPECT_EQ(loader.boundaries.at(i).roadId, doc.boundaries.at(i).roadId);
+    expectSamePoints(loader.boundaries.at(i).points, doc.boundaries.at(i).points);
+  }
+
+  ASSERT_EQ(loader.curbs.size(), doc.curbs.size());
+  for (unsigned int i = 0; i < doc.curbs.size(); i++)
+  {
+    EXPECT_EQ(loader.curbs.at(i).id, doc.curbs.at(i).id);
+    EXPECT_EQ(loader.curbs.at(i).laneId, doc.curbs.at(i).laneId);
+    EXPECT_EQ(loader.curbs.at(i).roadId, doc.curbs.at(i).roadId);
+    expectSamePoints(loader.curbs.at(i).points, doc.curbs.at(i).points);
+  }
+}
+}  // namespace
+
+TEST(TestKmlMapLoader, sameElementsAsDocument)
+{
+  for (const bool ver_zero : { false, true })
+  {
+    std::string file_name = writeTempFile(createKml(3, 4, 12, ver_zero));
+
+    KmlMapLoader loader;
+    ASSERT_TRUE(loader.LoadFile(file_name, ver_zero));
+    MappingHelpers::m_USING_VER_ZERO = ver_zero ? 1 : 0;
+    DocumentMap doc(file_name);
+    MappingHelpers::m_USING_VER_ZERO = 0;
+    remove(file_name.c_str());
+
+    ASSERT_EQ(loader.lanes.size(), 12u);
+    ASSERT_EQ(loader.lanes.at(5).points.size(), 12u);
+    EXPECT_EQ(loader.curbs.size(), 3u);
+    expectSameElements(loader, doc);
+  }
+}
+
+TEST(TestKmlMapLoader, missingFile)
+{
+  KmlMapLoader loader;
+  EXPECT_FALSE(loader.LoadFile("/tmp/no_such_map_file.kml"));
+  EXPECT_TRUE(loader.lanes.empty());
+
+  // no map folder
+  std::string kml = "<kml><Document><name>x</name></Document></kml>";
+  loader.Parse(kml.data(), kml.data() + kml.size());
+  EXPECT_TRUE(loader.lanes.empty());
+  EXPECT_TRUE(loader.roadSegments.empty());
+}
+
+TEST(TestKmlMapLoader, loadKml)
+{
+  std::string file_name = writeTempFile(createKml(2, 3, 10, false));
+  RoadNetwork map;
+  MappingHelpers::LoadKML(file_name, map);
+  remove(file_name.c_str());
+
+  ASSERT_EQ(map.roadSegments.size(), 1u);
+  ASSERT_EQ(map.roadSegments.at(0).Lanes.size(), 6u);
+  const Lane& lane = map.roadSegments.at(0).Lanes.at(0);
+  ASSERT_EQ(lane.toLanes.size(), 1u);
+  EXPECT_EQ(lane.toLanes.at(0)->id, 2);
+  EXPECT_EQ(lane.points.at(0).pLane, &lane);
+  EXPECT_EQ(lane.points.at(0).pRight->laneId, 4);
+  EXPECT_EQ(map.trafficLights.size(), 5u);
+  EXPECT_EQ(map.stopLines.size(), 5u);
+}
+
+TEST(TestKmlMapLoader, benchmark)
+{
+  for (const int n_rows : { 10, 40 })
+  {
+    std::string file_name = writeTempFile(createKml(n_rows, 50, 100, false));
+
+    auto start = std::chrono::steady_clock::now();
+    DocumentMap doc(file_name);
+    double doc_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    KmlMapLoader loader;
+    loader.LoadFile(file_name);
+    double loader_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    RoadNetwork map;
+    MappingHelpers::LoadKML(file_name, map);
+    double load_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    remove(file_name.c_str());
+
+    printf("[ %5zu lanes ] TinyXML document and element lists: %9.1f ms, KmlMapLoader: %7.1f ms, LoadKML: %9.1f ms\n",
+           loader.lanes.size(), doc_msec, loader_msec, load_msec);
+    expectSameElements(loader, doc);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
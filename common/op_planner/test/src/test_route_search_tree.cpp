@@ -0,0 +1,356 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "op_planner/PlannerH.h"
+#include "op_planner/PlanningHelpers.h"
+#include "op_planner/RouteSearchTree.h"
+
+using namespace PlannerHNS;
+
+namespace
+{
+// the planner logs every search, silenced while the tests run
+class SilentCout
+{
+public:
+  SilentCout() : previous_(std::cout.rdbuf(sink_.rdbuf()))
+  {
+  }
+  ~SilentCout()
+  {
+    std::cout.rdbuf(previous_);
+  }
+
+private:
+  std::ostringstream sink_;
+  std::streambuf* previous_;
+};
+
+Lane createLane(int id, double x, double y, double a, int length)
+{
+  Lane l;
+  l.id = id;
+  for (int i = 0; i < length; i++)
+  {
+    WayPoint wp(x + i * cos(a), y + i * sin(a), 0, a);
+    wp.laneId = id;
+    l.points.push_back(wp);
+  }
+  return l;
+}
+
+// blocks of two lanes eastward roads and one lane northward roads, with random turn costs,
+// the road ends of each intersection connected to all the road starts
+RoadNetwork createGridMap(int n_blocks, int block_length, std::mt19937& gen)
+{
+  std::uniform_real_distribution<double> turn_cost(0, 5);
+  RoadNetwork map;
+  map.roadSegments.push_back(RoadSegment());
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  std::vector<int> east_left, east_right, north;
+  for (int r = 0; r < n_blocks; r++)
+  {
+    for (int c = 0; c < n_blocks; c++)
+    {
+      if (c + 1 < n_blocks)
+      {
+        east_left.push_back(lanes.size());
+        lanes.push_back(createLane(lanes.size() + 1, c * block_length, r * block_length, 0, block_length));
+        east_right.push_back(lanes.size());
+        lanes.push_back(createLane(lanes.size() + 1, c * block_length, r * block_length - 3.5, 0, block_length));
+      }
+      if (r + 1 < n_blocks)
+      {
+        north.push_back(lanes.size());
+        lanes.push_back(createLane(lanes.size() + 1, c * block_length, r * block_length, M_PI_2, block_length));
+      }
+    }
+  }
+
+  int id = 1;
+  for (Lane& l : lanes)
+  {
+    for (unsigned int i = 0; i < l.points.size(); i++)
+    {
+      l.points.at(i).id = id++;
+      l.points.at(i).pLane = &l;
+      if (i > 0)
+        l.points.at(i - 1).pFronts.push_back(&l.points.at(i));
+    }
+  }
+
+  for (unsigned int i = 0; i < east_left.size(); i++)
+  {
+    Lane& left = lanes.at(east_left.at(i));
+    Lane& right = lanes.at(east_right.at(i));
+    for (unsigned int p = 0; p < left.points.size(); p++)
+    {
+      left.points.at(p).pRight = &right.points.at(p);
+      left.points.at(p).RightPointId = right.points.at(p).id;
+      right.points.at(p).pLeft = &left.points.at(p);
+      right.points.at(p).LeftPointId = left.points.at(p).id;
+    }
+  }
+
+  for (Lane& from : lanes)
+  {
+    GPSPoint end = from.points.back().pos;
+    end.x = round(end.x + cos(from.points.back().pos.a));
+    end.y = round(end.y + sin(from.points.back().pos.a));
+    for (Lane& to : lanes)
+    {
+      const GPSPoint& start = to.points.front().pos;
+      if (start.x == end.x && (start.y == end.y || start.y == end.y - 3.5 || start.y == end.y + 3.5))
+      {
+        if (to.points.front().pos.a != from.points.back().pos.a)
+          to.points.front().actionCost.push_back(std::make_pair(FORWARD_ACTION, turn_cost(gen)));
+        from.points.back().pFronts.push_back(&to.points.front());
+      }
+    }
+  }
+
+  return map;
+}
+
+// lane waypoints away from the intersections, where the closest lane is not ambiguous
+std::vector<WayPoint*> samplePoints(RoadNetwork& map, int n_points, std::mt19937& gen)
+{
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  std::uniform_int_distribution<int> lane_index(0, lanes.size() - 1);
+  std::vector<WayPoint*> points;
+  while ((int)points.size() < n_points)
+  {
+    Lane& l = lanes.at(lane_index(gen));
+    std::uniform_int_distribution<int> point_index(6, l.points.size() - 7);
+    points.push_back(&l.points.at(point_index(gen)));
+  }
+  return points;
+}
+
+void expectSamePath(const std::vector<WayPoint>& expected, const std::vector<WayPoint>& actual)
+{
+  ASSERT_EQ(expected.size(), actual.size());
+  for (unsigned int i = 0; i < expected.size(); i++)
+  {
+    EXPECT_EQ(expected.at(i).id, actual.at(i).id);
+    EXPECT_EQ(expected.at(i).laneId, actual.at(i).laneId);
+    EXPECT_NEAR(expected.at(i).cost, actual.at(i).cost, 1e-9);
+  }
+}
+}  // namespace
+
+TEST(TestRouteSearchTree, sameRoutesAsSearchTreeV2)
+{
+  std::mt19937 gen(0);
+  RoadNetwork map = createGridMap(5, 20, gen);
+  std::vector<WayPoint*> starts = samplePoints(map, 4, gen);
+  std::vector<WayPoint*> goals = samplePoints(map, 40, gen);
+  std::vector<int> global_path;
+  SilentCout silent;
+
+  for (const bool lane_change : { false, true })
+  {
+    for (const double distance_limit : { 150.0, 100000.0 })
+    {
+      for (WayPoint* pStart : starts)
+      {
+        RouteSearchTree tree;
+        tree.Build(pStart, global_path, distance_limit, lane_change);
+        EXPECT_TRUE(tree.IsBuiltFor(pStart, global_path, distance_limit, lane_change));
+        EXPECT_FALSE(tree.IsBuiltFor(pStart, global_path, distance_limit, !lane_change));
+
+        for (WayPoint* pGoal : goals)
+        {
+          std::vector<WayPoint*> cells;
+          WayPoint* pExpected =
+              PlanningHelpers::BuildPlanningSearchTreeV2(pStart, *pGoal, global_path, distance_limit, lane_change, cells);
+          bool bReached = false;
+          WayPoint* pActual = tree.FindGoalCell(*pGoal, &bReached);
+
+          ASSERT_EQ(pExpected == nullptr, pActual == nullptr);
+          if (pExpected)
+          {
+            EXPECT_EQ(pExpected->id, pActual->id);
+            EXPECT_EQ(pExpected->laneId, pActual->laneId);
+            EXPECT_NEAR(pExpected->cost, pActual->cost, 1e-9);
+            EXPECT_EQ(bReached, pExpected->id == pGoal->id);
+
+            std::vector<WayPoint> expected_path, actual_path;
+            std::vector<std::vector<WayPoint> > temp;
+            PlanningHelpers::TraversePathTreeBackwards(pExpected, pStart, global_path, expected_path, temp);
+            PlanningHelpers::TraversePathTreeBackwards(pActual, pStart, global_path, actual_path, temp);
+            expectSamePath(expected_path, actual_path);
+          }
+          for (WayPoint* pCell : cells)
+            delete pCell;
+        }
+      }
+    }
+  }
+}
+
+TEST(TestRouteSearchTree, multiGoalPlanSameAsPlanUsingDP)
+{
+  std::mt19937 gen(1);
+  RoadNetwork map = createGridMap(5, 20, gen);
+  std::vector<WayPoint*> goal_points = samplePoints(map, 30, gen);
+  std::vector<WayPoint> goals;
+  for (WayPoint* p : goal_points)
+    goals.push_back(*p);
+  std::vector<int> global_path;
+  SilentCout silent;
+
+  // the lane changes happen on the first lane where they are possible, the route from a start further
+  // on the same lane is the same route only without them
+  const bool lane_change = false;
+  PlannerH planner;
+  WayPoint* pStart = samplePoints(map, 1, gen).at(0);
+  for (int step = 0; step < 3; step++, pStart += 2)
+  {
+    std::vector<std::vector<std::vector<WayPoint> > > multi_paths;
+    std::vector<double> distances;
+    int n_planned =
+        planner.PlanUsingDPMultiGoal(*pStart, goals, 100000, lane_change, global_path, map, multi_paths, distances);
+    ASSERT_EQ(goals.size(), multi_paths.size());
+    ASSERT_EQ(goals.size(), distances.size());
+
+    int n_expected = 0;
+    for (unsigned int i = 0; i < goals.size(); i++)
+    {
+      std::vector<std::vector<WayPoint> > paths;
+      double distance = planner.PlanUsingDP(*pStart, goals.at(i), 100000, lane_change, global_path, map, paths);
+      if (distance > 0)
+        n_expected++;
+      EXPECT_NEAR(distance, distances.at(i), 1e-9);
+      ASSERT_EQ(paths.size(), multi_paths.at(i).size());
+      for (unsigned int j = 0; j < paths.size(); j++)
+        expectSamePath(paths.at(j), multi_paths.at(i).at(j));
+    }
+    EXPECT_EQ(n_expected, n_planned);
+  }
+}
+
+TEST(TestRouteSearchTree, viaPointsPlan)
+{
+  std::mt19937 gen(2);
+  RoadNetwork map = createGridMap(5, 20, gen);
+  std::vector<int> global_path;
+  SilentCout silent;
+
+  // eastward then northward via points, reachable from each other
+  std::vector<Lane>& lanes = map.roadSegments.at(0).Lanes;
+  std::vector<WayPoint> via_points = { lanes.at(0).points.at(10), lanes.at(4).points.at(8), lanes.at(12).points.at(10),
+                                       lanes.at(25).points.at(12) };
+  WayPoint start = lanes.at(0).points.at(2);
+
+  PlannerH planner;
+  double expected_distance = 0;
+  std::vector<double> leg_distances;
+  WayPoint leg_start = start;
+  for (const WayPoint& via : via_points)
+  {
+    std::vector<std::vector<WayPoint> > leg;
+    double leg_distance = planner.PlanUsingDP(leg_start, via, 100000, true, global_path, map, leg);
+    ASSERT_GT(leg_distance, 0);
+    expected_distance += leg_distance;
+    leg_distances.push_back(leg_distance);
+    leg_start = via;
+  }
+
+  std::vector<std::vector<WayPoint> > paths;
+  double distance = planner.PlanUsingDPViaPoints(start, via_points, 100000, true, global_path, map, paths);
+  EXPECT_NEAR(expected_distance, distance, 1e-9);
+  ASSERT_FALSE(paths.empty());
+  EXPECT_EQ(via_points.back().id, paths.back().back().id);
+
+  // again with the cached trees
+  distance = planner.PlanUsingDPViaPoints(start, via_points, 100000, true, global_path, map, paths);
+  EXPECT_NEAR(expected_distance, distance, 1e-9);
+
+  // the car passed the first via point, which is dropped
+  std::vector<WayPoint> remaining(via_points.begin() + 1, via_points.end());
+  distance = planner.PlanUsingDPViaPoints(via_points.at(0), remaining, 100000, true, global_path, map, paths);
+  EXPECT_NEAR(expected_distance - leg_distances.at(0), distance, 1e-9);
+  EXPECT_EQ(via_points.back().id, paths.back().back().id);
+
+  // the last via point can't be reached from the first one
+  std::vector<WayPoint> backward = { via_points.at(1), via_points.at(0) };
+  EXPECT_EQ(0, planner.PlanUsingDPViaPoints(start, backward, 100000, true, global_path, map, paths));
+  EXPECT_TRUE(paths.empty());
+}
+
+TEST(TestRouteSearchTree, multiGoalBenchmark)
+{
+  std::mt19937 gen(3);
+  RoadNetwork map = createGridMap(8, 30, gen);
+  std::vector<WayPoint> goals;
+  for (WayPoint* p : samplePoints(map, 10, gen))
+    goals.push_back(*p);
+  std::vector<int> global_path;
+  const int n_cycles = 5;
+  SilentCout silent;
+
+  // replanning while the vehicle drives along its start lane
+  WayPoint* pStart = samplePoints(map, 1, gen).at(0);
+  while (pStart->pLane->points.size() - (pStart - &pStart->pLane->points.front()) < 6)
+    pStart = samplePoints(map, 1, gen).at(0);
+
+  PlannerH planner;
+  auto start = std::chrono::steady_clock::now();
+  double sum = 0;
+  for (int c = 0; c < n_cycles; c++)
+  {
+    for (const WayPoint& goal : goals)
+    {
+      std::vector<std::vector<WayPoint> > paths;
+      sum += planner.PlanUsingDP(*(pStart + c), goal, 100000, true, global_path, map, paths);
+    }
+  }
+  double dp_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  start = std::chrono::steady_clock::now();
+  double multi_sum = 0;
+  for (int c = 0; c < n_cycles; c++)
+  {
+    std::vector<std::vector<std::vector<WayPoint> > > paths;
+    std::vector<double> distances;
+    planner.PlanUsingDPMultiGoal(*(pStart + c), goals, 100000, true, global_path, map, paths, distances);
+    for (const double d : distances)
+      multi_sum += d;
+  }
+  double multi_msec = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  printf("[ %zu goals, %d cycles ] PlanUsingDP per goal: %8.1f ms/cycle, PlanUsingDPMultiGoal: %6.1f ms/cycle\n",
+         goals.size(), n_cycles, dp_msec / n_cycles, multi_msec / n_cycles);
+  EXPECT_GT(sum, 0);
+  EXPECT_GT(multi_sum, 0);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
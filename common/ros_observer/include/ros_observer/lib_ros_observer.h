@@ -18,6 +18,7 @@
  *
  */
 
+#include <memory>
 #include <string>
 #include <boost/interprocess/managed_shared_memory.hpp>
 #include <boost/interprocess/sync/interprocess_mutex.hpp>
@@ -32,6 +33,22 @@ enum class VitalMonitorMode
   CNT_MON
 };
 
+// Mapping of the ShmVitalTable of a running ros_observer, kept for the lifetime of the process
+class ShmVitalTableHandle
+{
+public:
+  bool open(void);
+  void close(void);
+  bool is_open(void) const {return p_table_ != nullptr;}
+  // True once the ros_observer that created the table terminated or was restarted
+  bool is_expired(void) const {return p_table_->expired.load(std::memory_order_relaxed);}
+  ShmVitalTable* table(void) const {return p_table_;}
+
+protected:
+  std::unique_ptr<boost::interprocess::managed_shared_memory> shm_;
+  ShmVitalTable* p_table_ = nullptr;
+};
+
 class ShmVitalMonitor
 {
 public:
@@ -42,10 +59,14 @@ public:
   bool is_error_detected(void);
 
 protected:
-  std::string name_, shm_name_, mut_name_;
+  std::string name_;
   VitalMonitorMode mode_;
   bool is_opened_;
+  // True from losing the table of a ros_observer until the module registered again in a new one
+  bool lost_;
   const unsigned int polling_interval_msec_;
+  ShmVitalTableHandle handle_;
+  ShmVitalCounter* p_cnt_;
 
   bool attempt_to_open(void);
   void init_vital_counter(void);
@@ -56,16 +77,40 @@ class ShmDRStopRequest
 {
 public:
   ShmDRStopRequest() :
-  is_opened_(false), name_("DRStopRequest"), shm_name_("SHM_" + name_), mut_name_("MUT_" + name_) {}
+  is_opened_(false), name_("DRStopRequest") {}
 
   void clear_request(void);
   bool is_request_received(void);
 
 protected:
   bool is_opened_;
-  std::string name_, shm_name_, mut_name_;
+  std::string name_;
+  ShmVitalTableHandle handle_;
 
   bool attempt_to_open(void);
 };
 
+// Creates the ShmVitalTable and watches the counters of all modules registered in it
+class ShmVitalObserver
+{
+public:
+  ShmVitalObserver(std::string mod_name, const double loop_rate, unsigned int th_counter,
+                   std::string aggregate_name = "HealthAggregator");
+  ~ShmVitalObserver();
+
+  // Sends the heartbeat of the observer and advances the counters of the other modules by one polling interval.
+  // The status of the aggregate module is set if any module failed, the DR stop request is raised when the first
+  // failure is detected and withdrawn once all modules recovered. Returns false and the names of the failed modules
+  // if any module failed.
+  bool poll(std::string* error_nodes);
+
+protected:
+  std::string name_, aggregate_name_;
+  const unsigned int polling_interval_msec_;
+  boost::interprocess::managed_shared_memory shm_;
+  ShmVitalTable* p_table_;
+  ShmVitalCounter* p_cnt_;
+  bool error_detected_prev_;
+};
+
 #endif  // ROS_OBSERVER_LIB_ROS_OBSERVER_H
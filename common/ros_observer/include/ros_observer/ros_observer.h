@@ -18,6 +18,9 @@
  *
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <iostream>
 #include <string>
 #include <functional>
@@ -28,9 +31,12 @@
 #include <boost/thread.hpp>
 
 static constexpr const char* SHM_NAME = "SharedMemoryForVitalMonitor";
+static constexpr const char* SHM_TABLE_NAME = "VitalTable";
 static constexpr int SHM_SIZE = 65536;
 static constexpr unsigned int SHM_TH_COUNTER = 3;
 static constexpr unsigned int SHM_COUNTER_MAX = 10000;
+static constexpr unsigned int SHM_MAX_MODULES = 32;
+static constexpr unsigned int SHM_MODULE_NAME_LEN = 64;
 
 enum class ModuleStatus
 {
@@ -38,16 +44,86 @@ enum class ModuleStatus
   ErrorDetected
 };
 
+// The counters live in shared memory and are accessed by several processes without a lock
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_BOOL_LOCK_FREE == 2, "shared memory counters must be lock-free");
+
 struct ShmVitalCounter
 {
-  ModuleStatus modstatus;
+  char name[SHM_MODULE_NAME_LEN];
+  std::atomic<ModuleStatus> modstatus;
 
-  bool activated;
-  unsigned int thresh;
-  unsigned int value;
+  std::atomic<bool> activated;
+  std::atomic<unsigned int> thresh;
+  std::atomic<unsigned int> value;
 
   ShmVitalCounter() :
-  modstatus(ModuleStatus::Normal), activated(false), thresh(0), value(0) {}
+  name(), modstatus(ModuleStatus::Normal), activated(false), thresh(0), value(0) {}
+
+  // Sent by the monitored module, clears the counter
+  void heartbeat(void)
+  {
+    value.store(0, std::memory_order_relaxed);
+  }
+
+  // Advances the counter of an activated module by interval_msec, true if it exceeds the threshold. A heartbeat in
+  // between is never lost: the counter is only advanced from the value it was read with.
+  bool advance(unsigned int interval_msec)
+  {
+    unsigned int current = value.load(std::memory_order_relaxed);
+    unsigned int next;
+    do
+    {
+      next = activated.load(std::memory_order_relaxed) ? std::min(current + interval_msec, SHM_COUNTER_MAX) : 0;
+    }
+    while (!value.compare_exchange_weak(current, next, std::memory_order_relaxed));
+
+    return next > thresh.load(std::memory_order_relaxed);
+  }
+};
+
+// Table of the modules monitored by the ros_observer, created by the ros_observer in SHM_NAME. Modules register
+// themselves on first use; registered entries are never moved or removed, so processes keep pointers to them.
+struct ShmVitalTable
+{
+  boost::interprocess::interprocess_mutex registration_mutex;
+  std::atomic<bool> expired;
+  std::atomic<bool> dr_stop_request;
+  std::atomic<unsigned int> num_modules;
+  ShmVitalCounter counters[SHM_MAX_MODULES];
+
+  ShmVitalTable() : expired(false), dr_stop_request(false), num_modules(0) {}
+
+  ShmVitalCounter* find(const std::string& name)
+  {
+    unsigned int size = num_modules.load(std::memory_order_acquire);
+    for (unsigned int i = 0; i < size; ++i)
+    {
+      if (name == counters[i].name)
+      {
+        return &counters[i];
+      }
+    }
+    return nullptr;
+  }
+
+  // Returns nullptr if the name is too long or the table is full
+  ShmVitalCounter* find_or_register(const std::string& name)
+  {
+    if (name.empty() || name.size() >= SHM_MODULE_NAME_LEN)
+    {
+      return nullptr;
+    }
+    boost::interprocess::scoped_lock<boost::interprocess::interprocess_mutex> scpdlock(registration_mutex);
+    ShmVitalCounter* p_cnt = find(name);
+    unsigned int size = num_modules.load(std::memory_order_relaxed);
+    if (p_cnt == nullptr && size < SHM_MAX_MODULES)
+    {
+      p_cnt = &counters[size];
+      std::strncpy(p_cnt->name, name.c_str(), SHM_MODULE_NAME_LEN - 1);
+      num_modules.store(size + 1, std::memory_order_release);
+    }
+    return p_cnt;
+  }
 };
 
 #endif  // ROS_OBSERVER_ROS_OBSERVER_H
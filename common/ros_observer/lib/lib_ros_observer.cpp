@@ -22,14 +22,37 @@
 #include <ros_observer/ros_observer.h>
 
 using boost::interprocess::managed_shared_memory;
-using boost::interprocess::scoped_lock;
+using boost::interprocess::shared_memory_object;
 using boost::interprocess::open_only;
-using boost::interprocess::interprocess_mutex;
+using boost::interprocess::create_only;
 using boost::interprocess::interprocess_exception;
 
+bool ShmVitalTableHandle::open(void)
+{
+  try
+  {
+    shm_.reset(new managed_shared_memory(open_only, SHM_NAME));
+    p_table_ = shm_->find<ShmVitalTable>(SHM_TABLE_NAME).first;
+  }
+  catch(interprocess_exception &ex)
+  {
+    p_table_ = nullptr;
+  }
+  if (p_table_ == nullptr || p_table_->expired)
+  {
+    close();
+  }
+  return is_open();
+}
+
+void ShmVitalTableHandle::close(void)
+{
+  p_table_ = nullptr;
+  shm_.reset();
+}
+
 ShmVitalMonitor::ShmVitalMonitor(std::string mod_name, const double loop_rate, VitalMonitorMode mode) :
-  is_opened_(false), name_(mod_name), shm_name_("SHM_" + mod_name), mut_name_("MUT_" + mod_name),
-  mode_(mode), polling_interval_msec_(1000.0/loop_rate) {}
+  name_(mod_name), mode_(mode), is_opened_(false), lost_(false), polling_interval_msec_(1000.0/loop_rate), p_cnt_(nullptr) {}
 
 void ShmVitalMonitor::run(void)
 {
@@ -48,90 +71,73 @@ void ShmVitalMonitor::init_vital_counter(void)
 {
   if (mode_ == VitalMonitorMode::CNT_CLEAR)
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-
-      p_cnt->activated = true;
-      p_cnt->thresh = (polling_interval_msec_)*(SHM_TH_COUNTER);
-      p_cnt->value = 0;
-    }
-    catch(interprocess_exception &ex)
-    {
-      std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
-    }
+    p_cnt_->thresh = (polling_interval_msec_)*(SHM_TH_COUNTER);
+    p_cnt_->value = 0;
+    p_cnt_->activated = true;
   }
 }
 
 void ShmVitalMonitor::update_vital_counter(void)
 {
-  try
+  if (handle_.is_expired())
   {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    scoped_lock<interprocess_mutex> scpdlock(*p_mut);
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    handle_.close();
+    is_opened_ = false;
+    lost_ = true;
+    return;
+  }
 
-    if (mode_ == VitalMonitorMode::CNT_CLEAR)
-    {
-      p_cnt->value = 0;
-    }
-    else if (mode_ == VitalMonitorMode::CNT_MON)
-    {
-      p_cnt->value = (p_cnt->activated) ? std::min((p_cnt->value + polling_interval_msec_), SHM_COUNTER_MAX) : 0;
-      p_cnt->modstatus = (p_cnt->value > p_cnt->thresh) ? ModuleStatus::ErrorDetected : ModuleStatus::Normal;
-    }
+  if (mode_ == VitalMonitorMode::CNT_CLEAR)
+  {
+    p_cnt_->heartbeat();
   }
-  catch(interprocess_exception &ex)
+  else if (mode_ == VitalMonitorMode::CNT_MON)
   {
-    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    p_cnt_->modstatus = p_cnt_->advance(polling_interval_msec_) ? ModuleStatus::ErrorDetected : ModuleStatus::Normal;
   }
 }
 
 bool ShmVitalMonitor::attempt_to_open(void)
 {
-  bool is_opened = false;
-
-  try
+  if (!handle_.open())
   {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    is_opened = true;
+    return false;
   }
-  catch(interprocess_exception &ex)
+
+  // modules which are watched before they run themselves are registered inactive
+  p_cnt_ = handle_.table()->find_or_register(name_);
+  if (p_cnt_ == nullptr)
   {
-    is_opened = false;
+    std::cout << "[INFO][Failed to register " << name_ << " in shared memory]" << std::endl;
+    handle_.close();
+    return false;
   }
-  return is_opened;
+  lost_ = false;
+  return true;
 }
 
 bool ShmVitalMonitor::is_error_detected(void)
 {
   bool is_error_detected = false;
 
+  if (is_opened_ && handle_.is_expired())
+  {
+    handle_.close();
+    is_opened_ = false;
+    lost_ = true;
+    is_error_detected = true;
+  }
+
   if (!is_opened_)
   {
+    // a module that lost its ros_observer reports an error until it is registered again
     is_opened_ = attempt_to_open();
+    is_error_detected |= lost_;
   }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      is_error_detected = (p_cnt->modstatus == ModuleStatus::ErrorDetected) ? true : false;
-    }
-    catch(interprocess_exception &ex)
-    {
-      is_error_detected = true;
-    }
+    is_error_detected = (p_cnt_->modstatus == ModuleStatus::ErrorDetected) ? true : false;
   }
   return is_error_detected;
 }
@@ -144,22 +150,15 @@ bool ShmDRStopRequest::is_request_received(void)
   {
     is_opened_ = attempt_to_open();
   }
+  else if (handle_.is_expired())
+  {
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    handle_.close();
+    is_opened_ = false;
+  }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      bool* p_stop_request = shm.find<bool>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      is_request_received = (*p_stop_request);
-    }
-    catch(interprocess_exception &ex)
-    {
-      std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
-      is_request_received = false;
-    }
+    is_request_received = handle_.table()->dr_stop_request;
   }
   return is_request_received;
 }
@@ -170,38 +169,96 @@ void ShmDRStopRequest::clear_request(void)
   {
     is_opened_ = attempt_to_open();
   }
+  else if (handle_.is_expired())
+  {
+    std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
+    handle_.close();
+    is_opened_ = false;
+  }
   else
   {
-    try
-    {
-      managed_shared_memory shm(open_only, SHM_NAME);
-      bool* p_stop_request = shm.find<bool>(shm_name_.c_str()).first;
-      interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-
-      scoped_lock<interprocess_mutex> scpdlock(*p_mut);
-      (*p_stop_request) = false;
-    }
-    catch(interprocess_exception &ex)
-    {
-      std::cout << "[INFO][Failed to connect shared memory]" << std::endl;
-    }
+    handle_.table()->dr_stop_request = false;
   }
 }
 
 bool ShmDRStopRequest::attempt_to_open(void)
 {
-  bool is_opened = false;
+  return handle_.open();
+}
 
-  try
+ShmVitalObserver::ShmVitalObserver(std::string mod_name, const double loop_rate, unsigned int th_counter,
+                                   std::string aggregate_name) :
+  name_(mod_name), aggregate_name_(aggregate_name), polling_interval_msec_(1000.0/loop_rate),
+  error_detected_prev_(false)
+{
+  // modules still attached to the table of a previous ros_observer reconnect once it is marked expired
+  ShmVitalTableHandle previous;
+  if (previous.open())
   {
-    managed_shared_memory shm(open_only, SHM_NAME);
-    bool* p_stop_request = shm.find<bool>(shm_name_.c_str()).first;
-    interprocess_mutex* p_mut = shm.find<interprocess_mutex>(mut_name_.c_str()).first;
-    is_opened = true;
+    previous.table()->expired = true;
   }
-  catch(interprocess_exception &ex)
+  previous.close();
+  shared_memory_object::remove(SHM_NAME);
+
+  shm_ = managed_shared_memory(create_only, SHM_NAME, SHM_SIZE);
+  p_table_ = shm_.construct<ShmVitalTable>(SHM_TABLE_NAME)();
+  p_cnt_ = p_table_->find_or_register(name_);
+  p_cnt_->thresh = (polling_interval_msec_) * (th_counter);
+  p_cnt_->value = 0;
+  p_cnt_->activated = true;
+}
+
+ShmVitalObserver::~ShmVitalObserver()
+{
+  p_table_->expired = true;
+  shared_memory_object::remove(SHM_NAME);
+}
+
+bool ShmVitalObserver::poll(std::string* error_nodes)
+{
+  p_cnt_->heartbeat();
+
+  bool error_detected = false;
+  ShmVitalCounter* p_cnt_aggregate = nullptr;
+  error_nodes->clear();
+
+  unsigned int num_modules = p_table_->num_modules.load(std::memory_order_acquire);
+  for (unsigned int i = 0; i < num_modules; ++i)
+  {
+    ShmVitalCounter* p_cnt = &p_table_->counters[i];
+    if (p_cnt == p_cnt_)
+    {
+      continue;
+    }
+    bool is_error = p_cnt->advance(polling_interval_msec_);
+    if (is_error)
+    {
+      error_detected = true;
+      error_nodes->append(error_nodes->empty() ? "" : ", ").append(p_cnt->name);
+    }
+    if (aggregate_name_ == p_cnt->name)
+    {
+      p_cnt_aggregate = p_cnt;
+    }
+    else
+    {
+      p_cnt->modstatus = is_error ? ModuleStatus::ErrorDetected : ModuleStatus::Normal;
+    }
+  }
+
+  // the aggregate module reports the state of all modules to the vehicle drivers
+  if (p_cnt_aggregate != nullptr)
+  {
+    p_cnt_aggregate->modstatus = error_detected ? ModuleStatus::ErrorDetected : ModuleStatus::Normal;
+  }
+  if (error_detected && !error_detected_prev_)
+  {
+    p_table_->dr_stop_request = true;
+  }
+  else if (!error_detected && error_detected_prev_)
   {
-    is_opened = false;
+    p_table_->dr_stop_request = false;
   }
-  return is_opened;
+  error_detected_prev_ = error_detected;
+  return !error_detected;
 }
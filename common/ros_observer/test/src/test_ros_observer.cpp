@@ -16,7 +16,12 @@
  */
 
 #include <ros/ros.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <chrono>
+#include <cstdio>
 #include <string>
+#include <vector>
 #include <gtest/gtest.h>
 #include <ros_observer/lib_ros_observer.h>
 
@@ -24,6 +29,7 @@ using boost::interprocess::managed_shared_memory;
 using boost::interprocess::shared_memory_object;
 using boost::interprocess::scoped_lock;
 using boost::interprocess::create_only;
+using boost::interprocess::open_only;
 using boost::interprocess::interprocess_mutex;
 
 class MyShmDRStopRequest : public ShmDRStopRequest
@@ -59,6 +65,14 @@ protected:
     myDRObj_ = std::unique_ptr<MyShmDRStopRequest>(new MyShmDRStopRequest());
   }
 
+  // the table as the ros_observer creates it
+  ShmVitalTable* createTable(managed_shared_memory* shm)
+  {
+    shared_memory_object::remove(SHM_NAME);
+    *shm = managed_shared_memory(create_only, SHM_NAME, SHM_SIZE);
+    return shm->construct<ShmVitalTable>(SHM_TABLE_NAME)();
+  }
+
 public:
   void modeTestVM(void)
   {
@@ -69,40 +83,65 @@ public:
 
   void nameTestVM(void)
   {
-    ASSERT_EQ(myVMObj_->shm_name_, "SHM_NameTest");
-    ASSERT_EQ(myVMObj_->mut_name_, "MUT_NameTest");
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
+
+    ASSERT_EQ(myVMObj_->name_, "NameTest");
+    myVMObj_->run();
+    ASSERT_EQ(p_table->num_modules, 1);
+    ASSERT_STREQ(p_table->counters[0].name, "NameTest");
+    ASSERT_STREQ(myVMObj_->p_cnt_->name, "NameTest");
+
+    // too long to register
+    setupVM(std::string(SHM_MODULE_NAME_LEN, 'a'), 100.0);
+    ASSERT_FALSE(myVMObj_->attempt_to_open());
+    ASSERT_EQ(p_table->num_modules, 1);
+
+    shared_memory_object::remove(SHM_NAME);
   }
 
   void openTestVM(void)
   {
     EXPECT_FALSE(myVMObj_->attempt_to_open());
 
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
 
     ASSERT_TRUE(myVMObj_->attempt_to_open());
+    ASSERT_NE(p_table->find(myVMObj_->name_), nullptr);
 
     shared_memory_object::remove(SHM_NAME);
   }
 
   void runTestVM(void)
   {
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
 
     myVMObj_->run();
+    ShmVitalCounter* p_cnt_new = p_table->find(myVMObj_->name_);
+    ASSERT_NE(p_cnt_new, nullptr);
     ASSERT_TRUE(p_cnt_new->activated);
+    ASSERT_EQ(p_cnt_new->thresh, myVMObj_->polling_interval_msec_ * SHM_TH_COUNTER);
+
+    // a monitor does not activate the counter it watches
+    setupVM("RunTestMon", 100.0, VitalMonitorMode::CNT_MON);
+    myVMObj_->run();
+    p_cnt_new = p_table->find("RunTestMon");
+    ASSERT_NE(p_cnt_new, nullptr);
+    ASSERT_FALSE(p_cnt_new->activated);
 
     shared_memory_object::remove(SHM_NAME);
   }
 
   void updateTestVM(void)
   {
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
+    ShmVitalCounter* p_cnt_new = p_table->find_or_register(myVMObj_->name_);
+    p_cnt_new->thresh = myVMObj_->polling_interval_msec_ * SHM_TH_COUNTER;
+    ASSERT_TRUE(myVMObj_->attempt_to_open());
+    myVMObj_->is_opened_ = true;
 
     myVMObj_->mode_ = VitalMonitorMode::CNT_CLEAR;
     p_cnt_new->activated = true;
@@ -124,6 +163,11 @@ public:
     myVMObj_->update_vital_counter();
     ASSERT_EQ(p_cnt_new->modstatus, ModuleStatus::ErrorDetected);
 
+    p_cnt_new->activated = false;
+    myVMObj_->update_vital_counter();
+    ASSERT_EQ(p_cnt_new->value, 0);
+    ASSERT_EQ(p_cnt_new->modstatus, ModuleStatus::Normal);
+
     shared_memory_object::remove(SHM_NAME);
   }
 
@@ -131,27 +175,78 @@ public:
   {
     ASSERT_FALSE(myVMObj_->is_opened_);
 
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    ShmVitalCounter*  p_cnt_new = shm_new.construct<ShmVitalCounter>(myVMObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myVMObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
 
     myVMObj_->run();
+    ShmVitalCounter* p_cnt_new = p_table->find(myVMObj_->name_);
     p_cnt_new->modstatus = ModuleStatus::Normal;
     ASSERT_FALSE(myVMObj_->is_error_detected());
     p_cnt_new->modstatus = ModuleStatus::ErrorDetected;
     ASSERT_TRUE(myVMObj_->is_error_detected());
 
+    // the observer terminated
+    p_cnt_new->modstatus = ModuleStatus::Normal;
+    p_table->expired = true;
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+    ASSERT_FALSE(myVMObj_->is_opened_);
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+
+    // the table is gone, the error persists until a new observer is found
+    shared_memory_object::remove(SHM_NAME);
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+    ASSERT_FALSE(myVMObj_->is_opened_);
+
+    // a module that lost the observer while running reports the error as well
+    {
+      ShmVitalObserver observer("RosObserver", 100.0, 10);
+      ASSERT_FALSE(myVMObj_->is_error_detected());
+      ASSERT_TRUE(myVMObj_->is_opened_);
+      ASSERT_FALSE(myVMObj_->is_error_detected());
+      myVMObj_->run();
+    }
+    myVMObj_->run();
+    ASSERT_FALSE(myVMObj_->is_opened_);
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+    ASSERT_TRUE(myVMObj_->is_error_detected());
+
     shared_memory_object::remove(SHM_NAME);
   }
 
+  void reconnectTestVM(void)
+  {
+    std::unique_ptr<ShmVitalObserver> observer(new ShmVitalObserver("RosObserver", 100.0, 10));
+    myVMObj_->run();
+    ASSERT_TRUE(myVMObj_->is_opened_);
+
+    // restarted observer, the module registers again in the new table
+    observer.reset();
+    myVMObj_->run();
+    ASSERT_FALSE(myVMObj_->is_opened_);
+    observer.reset(new ShmVitalObserver("RosObserver", 100.0, 10));
+    myVMObj_->run();
+    ASSERT_TRUE(myVMObj_->is_opened_);
+
+    managed_shared_memory shm(open_only, SHM_NAME);
+    ShmVitalCounter* p_cnt = shm.find<ShmVitalTable>(SHM_TABLE_NAME).first->find(myVMObj_->name_);
+    ASSERT_NE(p_cnt, nullptr);
+    ASSERT_TRUE(p_cnt->activated);
+
+    // a crashed observer is replaced without being destroyed
+    ShmVitalObserver replacement("RosObserver", 100.0, 10);
+    myVMObj_->run();
+    ASSERT_FALSE(myVMObj_->is_opened_);
+  }
+
   void openTestDR(void)
   {
     myDRObj_->is_opened_ = myDRObj_->attempt_to_open();
     ASSERT_FALSE(myDRObj_->is_opened_);
 
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    bool*  p_stop_request_new = shm_new.construct<bool>(myDRObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myDRObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    createTable(&shm_new);
 
     myDRObj_->is_opened_ = myDRObj_->attempt_to_open();
     ASSERT_TRUE(myDRObj_->is_opened_);
@@ -161,31 +256,31 @@ public:
 
   void clearTestDR(void)
   {
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    bool*  p_stop_request_new = shm_new.construct<bool>(myDRObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myDRObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
 
-    (*p_stop_request_new) = false;
     myDRObj_->clear_request();
-    ASSERT_FALSE((*p_stop_request_new));
-    (*p_stop_request_new) = true;
+    p_table->dr_stop_request = false;
+    myDRObj_->clear_request();
+    ASSERT_FALSE(p_table->dr_stop_request);
+    p_table->dr_stop_request = true;
     myDRObj_->clear_request();
-    ASSERT_FALSE((*p_stop_request_new));
+    ASSERT_FALSE(p_table->dr_stop_request);
 
     shared_memory_object::remove(SHM_NAME);
   }
 
   void requestCheckTestDR(void)
   {
-    managed_shared_memory shm_new(create_only, SHM_NAME, SHM_SIZE);
-    bool*  p_stop_request_new = shm_new.construct<bool>(myDRObj_->shm_name_.c_str())();
-    interprocess_mutex* p_mut_new = shm_new.construct<interprocess_mutex>(myDRObj_->mut_name_.c_str())();
+    managed_shared_memory shm_new;
+    ShmVitalTable* p_table = createTable(&shm_new);
     bool is_request_received = false;
 
-    (*p_stop_request_new) = false;
+    myDRObj_->is_request_received();
+    p_table->dr_stop_request = false;
     is_request_received = myDRObj_->is_request_received();
     ASSERT_FALSE(is_request_received);
-    (*p_stop_request_new) = true;
+    p_table->dr_stop_request = true;
     is_request_received = myDRObj_->is_request_received();
     ASSERT_TRUE(is_request_received);
 
@@ -229,6 +324,12 @@ TEST_F(ShmTestSuite, ErrorDetectionTestVM)
   errorDetectionTestVM();
 }
 
+TEST_F(ShmTestSuite, ReconnectTestVM)
+{
+  setupVM("ReconnectTest", 100.0);
+  reconnectTestVM();
+}
+
 TEST_F(ShmTestSuite, OpenTestDR)
 {
   setupDR();
@@ -247,6 +348,209 @@ TEST_F(ShmTestSuite, RequestCheckTestDR)
   requestCheckTestDR();
 }
 
+TEST(ShmVitalObserverTest, ThresholdAndStopRequest)
+{
+  ShmVitalObserver observer("RosObserver", 100.0, 10);
+  ShmVitalMonitor module("Module", 100.0);
+  ShmVitalMonitor aggregate("HealthAggregator", 100.0);
+  ShmVitalMonitor driver_view("HealthAggregator", 100.0);
+  ShmVitalMonitor ro_view("RosObserver", 100.0, VitalMonitorMode::CNT_MON);
+  ShmDRStopRequest stop_request;
+  std::string error_nodes;
+
+  module.run();
+  aggregate.run();
+  driver_view.is_error_detected();
+  ro_view.run();
+  stop_request.is_request_received();
+
+  // the threshold is SHM_TH_COUNTER polling intervals without a heartbeat
+  for (unsigned int i = 0; i < SHM_TH_COUNTER; ++i)
+  {
+    aggregate.run();
+    ASSERT_TRUE(observer.poll(&error_nodes));
+  }
+  aggregate.run();
+  ASSERT_FALSE(observer.poll(&error_nodes));
+  ASSERT_EQ(error_nodes, "Module");
+  ASSERT_TRUE(driver_view.is_error_detected());
+  ASSERT_TRUE(stop_request.is_request_received());
+
+  // the stop request is only raised on the first failure
+  stop_request.clear_request();
+  aggregate.run();
+  ASSERT_FALSE(observer.poll(&error_nodes));
+  ASSERT_FALSE(stop_request.is_request_received());
+
+  // recovered, a raised request is withdrawn
+  module.run();
+  aggregate.run();
+  ASSERT_TRUE(observer.poll(&error_nodes));
+  ASSERT_TRUE(error_nodes.empty());
+  ASSERT_FALSE(driver_view.is_error_detected());
+  for (unsigned int i = 0; i <= SHM_TH_COUNTER; ++i)
+  {
+    aggregate.run();
+    observer.poll(&error_nodes);
+  }
+  ASSERT_TRUE(stop_request.is_request_received());
+  module.run();
+  aggregate.run();
+  ASSERT_TRUE(observer.poll(&error_nodes));
+  ASSERT_FALSE(stop_request.is_request_received());
+
+  // the observer clears its own counter for the health aggregator
+  for (int i = 0; i < 20; ++i)
+  {
+    ro_view.run();
+    module.run();
+    aggregate.run();
+    ASSERT_TRUE(observer.poll(&error_nodes));
+  }
+  ASSERT_FALSE(ro_view.is_error_detected());
+  for (int i = 0; i < 11; ++i)
+  {
+    ro_view.run();
+  }
+  ASSERT_TRUE(ro_view.is_error_detected());
+}
+
+namespace
+{
+// Runs func in a child process, returns its pid
+template <typename Func>
+pid_t spawn(Func func)
+{
+  pid_t pid = fork();
+  if (pid == 0)
+  {
+    _exit(func());
+  }
+  return pid;
+}
+
+int wait_for(pid_t pid)
+{
+  int status = 0;
+  waitpid(pid, &status, 0);
+  return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+}  // namespace
+
+TEST(ShmVitalObserverTest, MultipleProcesses)
+{
+  const int num_modules = 8;
+  ShmVitalObserver observer("RosObserver", 100.0, 10);
+  std::string error_nodes;
+
+  managed_shared_memory shm(open_only, SHM_NAME);
+  ShmVitalTable* p_table = shm.find<ShmVitalTable>(SHM_TABLE_NAME).first;
+  std::atomic<bool>* p_stop = shm.construct<std::atomic<bool>>("StopModules")(false);
+
+  // every module sends its heartbeats until it is stopped, the last one waits for the DR stop request
+  std::vector<pid_t> pids;
+  for (int i = 0; i < num_modules; ++i)
+  {
+    pids.push_back(spawn([i, p_stop]() {
+      ShmVitalMonitor module("Module" + std::to_string(i), 100.0);
+      while (!p_stop->load())
+      {
+        module.run();
+        usleep(1000);
+      }
+      return 0;
+    }));
+  }
+  pid_t drive_recorder = spawn([]() {
+    ShmDRStopRequest stop_request;
+    for (int i = 0; i < 5000; ++i)
+    {
+      if (stop_request.is_request_received())
+      {
+        return 0;
+      }
+      usleep(1000);
+    }
+    return 1;
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  while (p_table->num_modules < num_modules + 1 && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+  {
+    usleep(1000);
+  }
+  ASSERT_EQ(p_table->num_modules, num_modules + 1);
+
+  // no module is SHM_TH_COUNTER polling intervals late while it runs
+  for (int i = 0; i < 20; ++i)
+  {
+    EXPECT_TRUE(observer.poll(&error_nodes)) << error_nodes;
+    usleep(10000);
+  }
+
+  p_stop->store(true);
+  for (pid_t pid : pids)
+  {
+    EXPECT_EQ(wait_for(pid), 0);
+  }
+  for (unsigned int i = 0; i < SHM_TH_COUNTER; ++i)
+  {
+    EXPECT_TRUE(observer.poll(&error_nodes));
+  }
+  EXPECT_FALSE(observer.poll(&error_nodes));
+  for (int i = 0; i < num_modules; ++i)
+  {
+    EXPECT_NE(error_nodes.find("Module" + std::to_string(i)), std::string::npos);
+    EXPECT_EQ(p_table->counters[i + 1].modstatus, ModuleStatus::ErrorDetected);
+  }
+  EXPECT_EQ(wait_for(drive_recorder), 0);
+  shm.destroy<std::atomic<bool>>("StopModules");
+}
+
+TEST(ShmVitalObserverTest, HeartbeatBenchmark)
+{
+  const int iterations = 100000;
+  ShmVitalObserver observer("RosObserver", 100.0, 10);
+
+  // heartbeat as it was sent before: open the segment and look up the counter and its mutex every time
+  {
+    managed_shared_memory shm(open_only, SHM_NAME);
+    shm.construct<ShmVitalCounter>("SHM_Benchmark")();
+    shm.construct<interprocess_mutex>("MUT_Benchmark")();
+  }
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    managed_shared_memory shm(open_only, SHM_NAME);
+    ShmVitalCounter* p_cnt = shm.find<ShmVitalCounter>("SHM_Benchmark").first;
+    interprocess_mutex* p_mut = shm.find<interprocess_mutex>("MUT_Benchmark").first;
+    scoped_lock<interprocess_mutex> scpdlock(*p_mut);
+    p_cnt->value = 0;
+  }
+  double reopen_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  ShmVitalMonitor module("Benchmark", 100.0);
+  module.run();
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    module.run();
+  }
+  double mapped_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  std::string error_nodes;
+  start = std::chrono::steady_clock::now();
+  for (int i = 0; i < iterations; ++i)
+  {
+    observer.poll(&error_nodes);
+  }
+  double poll_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+  printf("[ heartbeat ] reopening the segment: %.1f ns, mapped: %.1f ns, observer poll: %.1f ns\n",
+         reopen_ns / iterations, mapped_ns / iterations, poll_ns / iterations);
+  EXPECT_LT(mapped_ns, reopen_ns);
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char **argv)
 {
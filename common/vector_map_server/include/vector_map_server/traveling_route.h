@@ -0,0 +1,126 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VECTOR_MAP_SERVER_TRAVELING_ROUTE_H
+#define VECTOR_MAP_SERVER_TRAVELING_ROUTE_H
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <geometry_msgs/Point.h>
+#include "autoware_msgs/Lane.h"
+#include "vector_map/vector_map.h"
+
+namespace vector_map_server
+{
+vector_map::Point findStartPoint(const vector_map::VectorMap& vmap, const vector_map::Lane& lane);
+vector_map::Point findEndPoint(const vector_map::VectorMap& vmap, const vector_map::Lane& lane);
+
+// objects of one table by the lane they are linked to, in the order of VectorMap::findByFilter
+template <class T>
+class LaneLinkedObjects
+{
+private:
+  std::unordered_map<int, std::vector<T>> objects_;
+  std::vector<T> null_objects_;
+
+public:
+  void update(const vector_map::VectorMap& vmap)
+  {
+    objects_.clear();
+    for (const auto& object : vmap.findByFilter([](const T& object){return true;}))
+      objects_[object.linkid].push_back(object);
+  }
+
+  const std::vector<T>& findByLane(int lnid) const
+  {
+    auto it = objects_.find(lnid);
+    if (it == objects_.end())
+      return null_objects_;
+    return it->second;
+  }
+};
+
+// lanes from the waypoints to their end, starting at the lane nearest to the pose
+class TravelingRoute
+{
+private:
+  // points within a radius of a position, in the order of the points
+  class PointGrid
+  {
+  private:
+    double cell_size_ = 0;
+    std::unordered_map<uint64_t, std::vector<size_t>> cells_;
+
+    uint64_t findCell(double bx, double ly) const;
+
+  public:
+    void update(const std::vector<vector_map::Point>& points, double radius);
+    std::vector<vector_map::Point> findNearPoints(const std::vector<vector_map::Point>& points,
+                                                  const vector_map::Point& base_point, double radius) const;
+  };
+
+  const vector_map::VectorMap& vmap_;
+  double radius_;
+  int loops_;
+
+  // built from the point, node and lane tables
+  std::vector<vector_map::Lane> lanes_;
+  std::vector<vector_map::Point> start_points_;
+  std::vector<vector_map::Point> end_points_;
+  PointGrid start_point_grid_;
+  PointGrid end_point_grid_;
+  std::unordered_map<int, std::vector<vector_map::Lane>> lanes_by_start_point_;
+  std::unordered_map<int, std::vector<vector_map::Lane>> lanes_by_end_point_;
+
+  // fine lanes of the last waypoints, with the median points of their start and end points
+  bool has_fine_lanes_ = false;
+  std::vector<geometry_msgs::Point> waypoint_positions_;
+  std::vector<vector_map::Lane> fine_lanes_;
+  std::vector<vector_map::Point> median_points_;
+  std::vector<bool> has_median_point_;
+  std::unordered_map<int, size_t> first_fine_lane_index_;
+
+  // traveling route of the last pose
+  bool has_traveling_route_ = false;
+  geometry_msgs::Point pose_position_;
+  std::vector<vector_map::Lane> traveling_route_;
+
+  bool isSameWaypoints(const autoware_msgs::Lane& waypoints) const;
+  void updateFineLanes(const autoware_msgs::Lane& waypoints);
+  vector_map::Lane findStartLane(const std::vector<vector_map::Point>& points) const;
+  vector_map::Lane findEndLane(const std::vector<vector_map::Point>& points) const;
+  std::vector<vector_map::Lane> findNextLanes(const vector_map::Lane& lane) const;
+
+public:
+  TravelingRoute(const vector_map::VectorMap& vmap, double radius, int loops);
+
+  // rebuilds the lane tables and forgets the routes, to be called whenever points, nodes or lanes change
+  void update();
+
+  std::vector<vector_map::Lane> createFineLanes(const autoware_msgs::Lane& waypoints) const;
+
+  // all lanes if there are no waypoints, otherwise the fine lanes of the waypoints; cached until the waypoints change
+  const std::vector<vector_map::Lane>& findFineLanes(const autoware_msgs::Lane& waypoints);
+
+  // the lane nearest to the pose if there are no waypoints, otherwise the fine lanes from it on; empty if there is none
+  const std::vector<vector_map::Lane>& findTravelingRoute(const geometry_msgs::Point& position,
+                                                          const autoware_msgs::Lane& waypoints);
+};
+} // namespace vector_map_server
+
+#endif // VECTOR_MAP_SERVER_TRAVELING_ROUTE_H
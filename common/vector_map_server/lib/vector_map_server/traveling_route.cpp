@@ -0,0 +1,471 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+#include "vector_map_server/traveling_route.h"
+
+using vector_map::VectorMap;
+using vector_map::Filter;
+using vector_map::Key;
+
+using vector_map::Point;
+using vector_map::Node;
+using vector_map::Lane;
+
+using vector_map::convertGeomPointToPoint;
+
+namespace vector_map_server
+{
+namespace
+{
+bool isBranchingLane(const Lane& lane)
+{
+  return lane.jct == Lane::LEFT_BRANCHING || lane.jct == Lane::RIGHT_BRANCHING || lane.jct == Lane::COMPOSITION;
+}
+
+double computeDistance(const Point& p1, const Point& p2)
+{
+  return std::hypot(p2.bx - p1.bx, p2.ly - p1.ly); // XXX: don't consider z axis
+}
+
+double computeAngle(const Point& p1, const Point& p2)
+{
+  return std::atan2(p2.ly - p1.ly, p2.bx - p1.bx); // XXX: don't consider z axis
+}
+
+double computeScore(const Point& bp1, const Point& bp2, const Point& p1, const Point& p2, double radius)
+{
+  double distance_score = computeDistance(bp1, p1);
+  distance_score = 50 * (radius - distance_score) / radius;
+  double angle_score = computeAngle(p1, p2) - computeAngle(bp1, bp2);
+  angle_score = 50 * (M_PI - std::fabs(angle_score)) / M_PI;
+  return distance_score + angle_score;
+}
+
+Point createMedianPoint(const Point& p1, const Point& p2)
+{
+  Point point;
+  point.bx = (p1.bx + p2.bx) / 2;
+  point.ly = (p1.ly + p2.ly) / 2;
+  point.h = (p1.h + p2.h) / 2;
+  return point;
+}
+
+Point findNearestPoint(const std::vector<Point>& points, const Point& base_point)
+{
+  Point nearest_point;
+  double min_distance = DBL_MAX;
+  for (const auto& point : points)
+  {
+    double distance = computeDistance(base_point, point);
+    if (distance <= min_distance)
+    {
+      nearest_point = point;
+      min_distance = distance;
+    }
+  }
+  return nearest_point;
+}
+
+bool isSamePosition(const geometry_msgs::Point& p1, const geometry_msgs::Point& p2)
+{
+  return p1.x == p2.x && p1.y == p2.y && p1.z == p2.z;
+}
+
+const std::vector<Lane> null_lanes;
+} // namespace
+
+Point findStartPoint(const VectorMap& vmap, const Lane& lane)
+{
+  Point start_point;
+  Node node = vmap.findByKey(Key<Node>(lane.bnid));
+  if (node.nid == 0)
+    return start_point;
+  return vmap.findByKey(Key<Point>(node.pid));
+}
+
+Point findEndPoint(const VectorMap& vmap, const Lane& lane)
+{
+  Point end_point;
+  Node node = vmap.findByKey(Key<Node>(lane.fnid));
+  if (node.nid == 0)
+    return end_point;
+  return vmap.findByKey(Key<Point>(node.pid));
+}
+
+uint64_t TravelingRoute::PointGrid::findCell(double bx, double ly) const
+{
+  long long x = static_cast<long long>(std::floor(bx / cell_size_));
+  long long y = static_cast<long long>(std::floor(ly / cell_size_));
+  // shifted as unsigned, cells at negative coordinates would be undefined for a signed shift
+  return static_cast<uint64_t>(x) << 32 | static_cast<uint32_t>(y);
+}
+
+void TravelingRoute::PointGrid::update(const std::vector<Point>& points, double radius)
+{
+  cells_.clear();
+  // a point within the radius is at most one cell away
+  cell_size_ = (radius > 0 && std::isfinite(radius)) ? 2 * radius : 0;
+  if (cell_size_ == 0)
+    return;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    if (std::isfinite(points[i].bx) && std::isfinite(points[i].ly))
+      cells_[findCell(points[i].bx, points[i].ly)].push_back(i);
+  }
+}
+
+std::vector<Point> TravelingRoute::PointGrid::findNearPoints(const std::vector<Point>& points,
+                                                             const Point& base_point, double radius) const
+{
+  std::vector<Point> near_points;
+  if (cell_size_ == 0 || !(radius <= cell_size_ / 2) || !std::isfinite(base_point.bx) ||
+      !std::isfinite(base_point.ly))
+  {
+    for (const auto& point : points)
+    {
+      if (computeDistance(base_point, point) <= radius)
+        near_points.push_back(point);
+    }
+    return near_points;
+  }
+
+  std::vector<size_t> candidates;
+  for (int dx = -1; dx <= 1; ++dx)
+  {
+    for (int dy = -1; dy <= 1; ++dy)
+    {
+      auto cell = cells_.find(findCell(base_point.bx + dx * cell_size_, base_point.ly + dy * cell_size_));
+      if (cell != cells_.end())
+        candidates.insert(candidates.end(), cell->second.begin(), cell->second.end());
+    }
+  }
+  std::sort(candidates.begin(), candidates.end());
+  for (size_t i : candidates)
+  {
+    if (computeDistance(base_point, points[i]) <= radius)
+      near_points.push_back(points[i]);
+  }
+  return near_points;
+}
+
+TravelingRoute::TravelingRoute(const VectorMap& vmap, double radius, int loops)
+  : vmap_(vmap), radius_(radius), loops_(loops)
+{
+}
+
+void TravelingRoute::update()
+{
+  lanes_ = vmap_.findByFilter([](const Lane& lane){return true;});
+
+  start_points_.clear();
+  end_points_.clear();
+  std::unordered_map<int, std::vector<Lane>> lanes_by_start_node;
+  std::unordered_map<int, std::vector<Lane>> lanes_by_end_node;
+  for (const auto& lane : lanes_)
+  {
+    Point start_point = findStartPoint(vmap_, lane);
+    if (start_point.pid != 0)
+      start_points_.push_back(start_point);
+    Point end_point = findEndPoint(vmap_, lane);
+    if (end_point.pid != 0)
+      end_points_.push_back(end_point);
+    lanes_by_start_node[lane.bnid].push_back(lane);
+    lanes_by_end_node[lane.fnid].push_back(lane);
+  }
+  start_point_grid_.update(start_points_, radius_);
+  end_point_grid_.update(end_points_, radius_);
+
+  // lanes of all nodes of a point, nodes and lanes in the order of their keys
+  lanes_by_start_point_.clear();
+  lanes_by_end_point_.clear();
+  for (const auto& node : vmap_.findByFilter([](const Node& node){return true;}))
+  {
+    auto start_lanes = lanes_by_start_node.find(node.nid);
+    if (start_lanes != lanes_by_start_node.end())
+    {
+      auto& lanes = lanes_by_start_point_[node.pid];
+      lanes.insert(lanes.end(), start_lanes->second.begin(), start_lanes->second.end());
+    }
+    auto end_lanes = lanes_by_end_node.find(node.nid);
+    if (end_lanes != lanes_by_end_node.end())
+    {
+      auto& lanes = lanes_by_end_point_[node.pid];
+      lanes.insert(lanes.end(), end_lanes->second.begin(), end_lanes->second.end());
+    }
+  }
+
+  has_fine_lanes_ = false;
+  has_traveling_route_ = false;
+}
+
+Lane TravelingRoute::findStartLane(const std::vector<Point>& points) const
+{
+  Lane start_lane;
+  if (points.size() < 2)
+    return start_lane;
+
+  Point bp1 = points[0];
+  Point bp2 = points[1];
+  double max_score = -DBL_MAX;
+  for (const auto& p1 : start_point_grid_.findNearPoints(start_points_, bp1, radius_))
+  {
+    auto lanes = lanes_by_start_point_.find(p1.pid);
+    if (lanes == lanes_by_start_point_.end())
+      continue;
+    for (const auto& lane : lanes->second)
+    {
+      if (lane.lnid == 0)
+        continue;
+      Point p2 = findEndPoint(vmap_, lane);
+      if (p2.pid == 0)
+        continue;
+      double score = computeScore(bp1, bp2, p1, p2, radius_);
+      if (score >= max_score)
+      {
+        start_lane = lane;
+        max_score = score;
+      }
+    }
+  }
+  return start_lane;
+}
+
+Lane TravelingRoute::findEndLane(const std::vector<Point>& points) const
+{
+  Lane end_lane;
+  if (points.size() < 2)
+    return end_lane;
+
+  Point bp1 = points[points.size() - 2];
+  Point bp2 = points[points.size() - 1];
+  double max_score = -DBL_MAX;
+  for (const auto& p2 : end_point_grid_.findNearPoints(end_points_, bp2, radius_))
+  {
+    auto lanes = lanes_by_end_point_.find(p2.pid);
+    if (lanes == lanes_by_end_point_.end())
+      continue;
+    for (const auto& lane : lanes->second)
+    {
+      if (lane.lnid == 0)
+        continue;
+      Point p1 = findStartPoint(vmap_, lane);
+      if (p1.pid == 0)
+        continue;
+      double score = computeScore(bp2, bp1, p2, p1, radius_);
+      if (score >= max_score)
+      {
+        end_lane = lane;
+        max_score = score;
+      }
+    }
+  }
+  return end_lane;
+}
+
+std::vector<Lane> TravelingRoute::findNextLanes(const Lane& lane) const
+{
+  // the lanes filtering all lanes by flid, flid2, flid3 or flid4 finds, in the order of their keys
+  std::vector<int> lnids = { lane.flid, lane.flid2, lane.flid3, lane.flid4 };
+  std::sort(lnids.begin(), lnids.end());
+  lnids.erase(std::unique(lnids.begin(), lnids.end()), lnids.end());
+
+  std::vector<Lane> next_lanes;
+  for (int lnid : lnids)
+  {
+    Lane next_lane = vmap_.findByKey(Key<Lane>(lnid));
+    if (next_lane.lnid != 0)
+      next_lanes.push_back(next_lane);
+  }
+  return next_lanes;
+}
+
+std::vector<Lane> TravelingRoute::createFineLanes(const autoware_msgs::Lane& waypoints) const
+{
+  std::vector<Lane> null_lanes;
+
+  std::vector<Point> coarse_points;
+  for (const auto& waypoint : waypoints.waypoints)
+    coarse_points.push_back(convertGeomPointToPoint(waypoint.pose.pose.position));
+
+  Lane start_lane = findStartLane(coarse_points);
+  if (start_lane.lnid == 0)
+    return null_lanes;
+
+  Lane end_lane = findEndLane(coarse_points);
+  if (end_lane.lnid == 0)
+    return null_lanes;
+
+  std::vector<Lane> fine_lanes;
+  Lane current_lane = start_lane;
+  for (int i = 0; i < loops_; ++i)
+  {
+    fine_lanes.push_back(current_lane);
+    if (current_lane.lnid == end_lane.lnid)
+      return fine_lanes;
+
+    if (isBranchingLane(current_lane))
+    {
+      Point fine_p1 = findEndPoint(vmap_, current_lane);
+      if (fine_p1.pid == 0)
+        return null_lanes;
+
+      Point coarse_p1 = findNearestPoint(coarse_points, fine_p1); // certainly succeed
+
+      if (computeDistance(fine_p1, coarse_p1) > radius_)
+        return null_lanes;
+
+      Point coarse_p2;
+      double distance = -DBL_MAX;
+      for (const auto& coarse_point : coarse_points)
+      {
+        if (distance == -DBL_MAX)
+        {
+          if (coarse_point.bx == coarse_p1.bx && coarse_point.ly == coarse_p1.ly) // XXX: don't consider z axis
+            distance = 0;
+          continue;
+        }
+        coarse_p2 = coarse_point;
+        distance = computeDistance(coarse_p2, coarse_p1);
+        if (distance > radius_)
+          break;
+      }
+      if (distance <= 0)
+        return null_lanes;
+
+      double max_score = -DBL_MAX;
+      for (const auto& lane : findNextLanes(current_lane))
+      {
+        Lane next_lane = lane;
+        Point next_point = findEndPoint(vmap_, next_lane);
+        if (next_point.pid == 0)
+          continue;
+        Point fine_p2 = next_point;
+        while (computeDistance(fine_p2, fine_p1) <= radius_ && !isBranchingLane(next_lane) && next_lane.flid != 0)
+        {
+          next_lane = vmap_.findByKey(Key<Lane>(next_lane.flid));
+          if (next_lane.lnid == 0)
+            break;
+          next_point = findEndPoint(vmap_, next_lane);
+          if (next_point.pid == 0)
+            break;
+          fine_p2 = next_point;
+        }
+        double score = computeScore(fine_p1, fine_p2, coarse_p1, coarse_p2, radius_);
+        if (score >= max_score)
+        {
+          current_lane = lane;
+          max_score = score;
+        }
+      }
+      if (max_score == -DBL_MAX)
+        return null_lanes;
+    }
+    else
+      current_lane = vmap_.findByKey(Key<Lane>(current_lane.flid));
+    if (current_lane.lnid == 0)
+      return null_lanes;
+  }
+
+  return null_lanes;
+}
+
+bool TravelingRoute::isSameWaypoints(const autoware_msgs::Lane& waypoints) const
+{
+  if (waypoints.waypoints.size() != waypoint_positions_.size())
+    return false;
+  for (size_t i = 0; i < waypoint_positions_.size(); ++i)
+  {
+    if (!isSamePosition(waypoints.waypoints[i].pose.pose.position, waypoint_positions_[i]))
+      return false;
+  }
+  return true;
+}
+
+void TravelingRoute::updateFineLanes(const autoware_msgs::Lane& waypoints)
+{
+  waypoint_positions_.clear();
+  for (const auto& waypoint : waypoints.waypoints)
+    waypoint_positions_.push_back(waypoint.pose.pose.position);
+
+  if (waypoints.waypoints.empty())
+    fine_lanes_ = lanes_;
+  else
+    fine_lanes_ = createFineLanes(waypoints);
+
+  median_points_.clear();
+  has_median_point_.clear();
+  first_fine_lane_index_.clear();
+  for (size_t i = 0; i < fine_lanes_.size(); ++i)
+  {
+    Point start_point = findStartPoint(vmap_, fine_lanes_[i]);
+    Point end_point = findEndPoint(vmap_, fine_lanes_[i]);
+    median_points_.push_back(createMedianPoint(start_point, end_point));
+    has_median_point_.push_back(start_point.pid != 0 && end_point.pid != 0);
+    first_fine_lane_index_.emplace(fine_lanes_[i].lnid, i);
+  }
+
+  has_fine_lanes_ = true;
+  has_traveling_route_ = false;
+}
+
+const std::vector<Lane>& TravelingRoute::findFineLanes(const autoware_msgs::Lane& waypoints)
+{
+  if (!has_fine_lanes_ || !isSameWaypoints(waypoints))
+    updateFineLanes(waypoints);
+  return fine_lanes_;
+}
+
+const std::vector<Lane>& TravelingRoute::findTravelingRoute(const geometry_msgs::Point& position,
+                                                            const autoware_msgs::Lane& waypoints)
+{
+  findFineLanes(waypoints);
+  if (has_traveling_route_ && isSamePosition(position, pose_position_))
+    return traveling_route_;
+
+  // the nearest lane by the median point of its start and end point, the last one of equally near lanes
+  Point base_point = convertGeomPointToPoint(position);
+  size_t nearest_index = fine_lanes_.size();
+  double min_distance = DBL_MAX;
+  for (size_t i = 0; i < fine_lanes_.size(); ++i)
+  {
+    if (!has_median_point_[i])
+      continue;
+    double distance = computeDistance(base_point, median_points_[i]);
+    if (distance <= min_distance)
+    {
+      nearest_index = i;
+      min_distance = distance;
+    }
+  }
+
+  traveling_route_.clear();
+  if (nearest_index < fine_lanes_.size())
+  {
+    if (waypoints.waypoints.empty())
+      traveling_route_.push_back(fine_lanes_[nearest_index]);
+    else
+      traveling_route_.assign(fine_lanes_.begin() + first_fine_lane_index_.at(fine_lanes_[nearest_index].lnid),
+                              fine_lanes_.end());
+  }
+  pose_position_ = position;
+  has_traveling_route_ = true;
+  return traveling_route_;
+}
+} // namespace vector_map_server
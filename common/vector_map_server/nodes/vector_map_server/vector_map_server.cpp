@@ -14,10 +14,13 @@
  * limitations under the License.
  */
 
+#include <memory>
+
 #include <geometry_msgs/PoseStamped.h>
 #include "autoware_msgs/Lane.h"
 #include <visualization_msgs/MarkerArray.h>
 #include "vector_map/vector_map.h"
+#include "vector_map_server/traveling_route.h"
 
 #include "vector_map_server/GetDTLane.h"
 #include "vector_map_server/GetNode.h"
@@ -50,7 +53,6 @@
 using vector_map::VectorMap;
 using vector_map::Category;
 using vector_map::Color;
-using vector_map::Filter;
 using vector_map::Key;
 
 using vector_map::Point;
@@ -88,345 +90,16 @@ using vector_map::RailCrossing;
 
 using vector_map::isValidMarker;
 using vector_map::convertPointToGeomPoint;
-using vector_map::convertGeomPointToPoint;
+
+using vector_map_server::findStartPoint;
+using vector_map_server::findEndPoint;
+using vector_map_server::LaneLinkedObjects;
+using vector_map_server::TravelingRoute;
 
 using Polygon = std::vector<geometry_msgs::Point>;
 
 namespace
 {
-bool isBranchingLane(const Lane& lane)
-{
-  return lane.jct == Lane::LEFT_BRANCHING || lane.jct == Lane::RIGHT_BRANCHING || lane.jct == Lane::COMPOSITION;
-}
-
-bool isMergingLane(const Lane& lane)
-{
-  return lane.jct == Lane::LEFT_MERGING || lane.jct == Lane::RIGHT_MERGING || lane.jct == Lane::COMPOSITION;
-}
-
-double computeDistance(const Point& p1, const Point& p2)
-{
-  return std::hypot(p2.bx - p1.bx, p2.ly - p1.ly); // XXX: don't consider z axis
-}
-
-double computeAngle(const Point& p1, const Point& p2)
-{
-  return std::atan2(p2.ly - p1.ly, p2.bx - p1.bx); // XXX: don't consider z axis
-}
-
-double computeScore(const Point& bp1, const Point& bp2, const Point& p1, const Point& p2, double radius)
-{
-  double distance_score = computeDistance(bp1, p1);
-  distance_score = 50 * (radius - distance_score) / radius;
-  double angle_score = computeAngle(p1, p2) - computeAngle(bp1, bp2);
-  angle_score = 50 * (M_PI - std::fabs(angle_score)) / M_PI;
-  return distance_score + angle_score;
-}
-
-Point findStartPoint(const VectorMap& vmap, const Lane& lane)
-{
-  Point start_point;
-  Node node = vmap.findByKey(Key<Node>(lane.bnid));
-  if (node.nid == 0)
-    return start_point;
-  return vmap.findByKey(Key<Point>(node.pid));
-}
-
-Point findEndPoint(const VectorMap& vmap, const Lane& lane)
-{
-  Point end_point;
-  Node node = vmap.findByKey(Key<Node>(lane.fnid));
-  if (node.nid == 0)
-    return end_point;
-  return vmap.findByKey(Key<Point>(node.pid));
-}
-
-Point createMedianPoint(const Point& p1, const Point& p2)
-{
-  Point point;
-  point.bx = (p1.bx + p2.bx) / 2;
-  point.ly = (p1.ly + p2.ly) / 2;
-  point.h = (p1.h + p2.h) / 2;
-  return point;
-}
-
-std::vector<Point> findStartPoints(const VectorMap& vmap)
-{
-  std::vector<Point> start_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
-  {
-    Node node = vmap.findByKey(Key<Node>(lane.bnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    start_points.push_back(point);
-  }
-  return start_points;
-}
-
-std::vector<Point> findEndPoints(const VectorMap& vmap)
-{
-  std::vector<Point> end_points;
-  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
-  {
-    Node node = vmap.findByKey(Key<Node>(lane.fnid));
-    if (node.nid == 0)
-      continue;
-    Point point = vmap.findByKey(Key<Point>(node.pid));
-    if (point.pid == 0)
-      continue;
-    end_points.push_back(point);
-  }
-  return end_points;
-}
-
-Point findNearestPoint(const std::vector<Point>& points, const Point& base_point)
-{
-  Point nearest_point;
-  double min_distance = DBL_MAX;
-  for (const auto& point : points)
-  {
-    double distance = computeDistance(base_point, point);
-    if (distance <= min_distance)
-    {
-      nearest_point = point;
-      min_distance = distance;
-    }
-  }
-  return nearest_point;
-}
-
-std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point& base_point, double radius)
-{
-  std::vector<Point> near_points;
-  for (const auto& point : points)
-  {
-    if (computeDistance(base_point, point) <= radius)
-      near_points.push_back(point);
-  }
-  return near_points;
-}
-
-std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
-{
-  std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
-  {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
-      lanes.push_back(lane);
-  }
-  return lanes;
-}
-
-std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
-{
-  std::vector<Lane> lanes;
-  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
-  {
-    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
-      lanes.push_back(lane);
-  }
-  return lanes;
-}
-
-Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
-{
-  Lane start_lane;
-  if (points.size() < 2)
-    return start_lane;
-
-  Point bp1 = points[0];
-  Point bp2 = points[1];
-  double max_score = -DBL_MAX;
-  for (const auto& p1 : findNearPoints(findStartPoints(vmap), bp1, radius))
-  {
-    for (const auto& lane : findLanesByStartPoint(vmap, p1))
-    {
-      if (lane.lnid == 0)
-        continue;
-      Point p2 = findEndPoint(vmap, lane);
-      if (p2.pid == 0)
-        continue;
-      double score = computeScore(bp1, bp2, p1, p2, radius);
-      if (score >= max_score)
-      {
-        start_lane = lane;
-        max_score = score;
-      }
-    }
-  }
-  return start_lane;
-}
-
-Lane findEndLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
-{
-  Lane end_lane;
-  if (points.size() < 2)
-    return end_lane;
-
-  Point bp1 = points[points.size() - 2];
-  Point bp2 = points[points.size() - 1];
-  double max_score = -DBL_MAX;
-  for (const auto& p2 : findNearPoints(findEndPoints(vmap), bp2, radius))
-  {
-    for (const auto& lane : findLanesByEndPoint(vmap, p2))
-    {
-      if (lane.lnid == 0)
-        continue;
-      Point p1 = findStartPoint(vmap, lane);
-      if (p1.pid == 0)
-        continue;
-      double score = computeScore(bp2, bp1, p2, p1, radius);
-      if (score >= max_score)
-      {
-        end_lane = lane;
-        max_score = score;
-      }
-    }
-  }
-  return end_lane;
-}
-
-Lane findNearestLane(const VectorMap& vmap, const std::vector<Lane>& lanes, const Point& base_point)
-{
-  Lane nearest_lane;
-  double min_distance = DBL_MAX;
-  for (const auto& lane : lanes)
-  {
-    Point start_point = findStartPoint(vmap, lane);
-    if (start_point.pid == 0)
-      continue;
-    Point end_point = findEndPoint(vmap, lane);
-    if (end_point.pid == 0)
-      continue;
-    Point median_point = createMedianPoint(start_point, end_point);
-    double distance = computeDistance(base_point, median_point);
-    if (distance <= min_distance)
-    {
-      nearest_lane = lane;
-      min_distance = distance;
-    }
-  }
-  return nearest_lane;
-}
-
-std::vector<Lane> findNearLanes(const VectorMap& vmap, const std::vector<Lane>& lanes, const Point& base_point,
-                                double radius)
-{
-  std::vector<Lane> near_lanes;
-  for (const auto& lane : lanes)
-  {
-    Point start_point = findStartPoint(vmap, lane);
-    if (start_point.pid == 0)
-      continue;
-    Point end_point = findEndPoint(vmap, lane);
-    if (end_point.pid == 0)
-      continue;
-    Point median_point = createMedianPoint(start_point, end_point);
-    if (computeDistance(base_point, median_point) <= radius)
-      near_lanes.push_back(lane);
-  }
-  return near_lanes;
-}
-
-std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::Lane& waypoints, double radius,
-                                  int loops)
-{
-  std::vector<Lane> null_lanes;
-
-  std::vector<Point> coarse_points;
-  for (const auto& waypoint : waypoints.waypoints)
-    coarse_points.push_back(convertGeomPointToPoint(waypoint.pose.pose.position));
-
-  Lane start_lane = findStartLane(vmap, coarse_points, radius);
-  if (start_lane.lnid == 0)
-    return null_lanes;
-
-  Lane end_lane = findEndLane(vmap, coarse_points, radius);
-  if (end_lane.lnid == 0)
-    return null_lanes;
-
-  std::vector<Lane> fine_lanes;
-  Lane current_lane = start_lane;
-  for (int i = 0; i < loops; ++i)
-  {
-    fine_lanes.push_back(current_lane);
-    if (current_lane.lnid == end_lane.lnid)
-      return fine_lanes;
-
-    if (isBranchingLane(current_lane))
-    {
-      Point fine_p1 = findEndPoint(vmap, current_lane);
-      if (fine_p1.pid == 0)
-        return null_lanes;
-
-      Point coarse_p1 = findNearestPoint(coarse_points, fine_p1); // certainly succeed
-
-      if (computeDistance(fine_p1, coarse_p1) > radius)
-        return null_lanes;
-
-      Point coarse_p2;
-      double distance = -DBL_MAX;
-      for (const auto& coarse_point : coarse_points)
-      {
-        if (distance == -DBL_MAX)
-        {
-          if (coarse_point.bx == coarse_p1.bx && coarse_point.ly == coarse_p1.ly) // XXX: don't consider z axis
-            distance = 0;
-          continue;
-        }
-        coarse_p2 = coarse_point;
-        distance = computeDistance(coarse_p2, coarse_p1);
-        if (distance > radius)
-          break;
-      }
-      if (distance <= 0)
-        return null_lanes;
-
-      double max_score = -DBL_MAX;
-      Filter<Lane> is_next_lane = [&current_lane](const Lane& lane)
-        {
-          return lane.lnid == current_lane.flid || lane.lnid == current_lane.flid2 ||
-                 lane.lnid == current_lane.flid3 || lane.lnid == current_lane.flid4;
-        };
-      for (const auto& lane : vmap.findByFilter(is_next_lane))
-      {
-        Lane next_lane = lane;
-        Point next_point = findEndPoint(vmap, next_lane);
-        if (next_point.pid == 0)
-          continue;
-        Point fine_p2 = next_point;
-        while (computeDistance(fine_p2, fine_p1) <= radius && !isBranchingLane(next_lane) && next_lane.flid != 0)
-        {
-          next_lane = vmap.findByKey(Key<Lane>(next_lane.flid));;
-          if (next_lane.lnid == 0)
-            break;
-          next_point = findEndPoint(vmap, next_lane);
-          if (next_point.pid == 0)
-            break;
-          fine_p2 = next_point;
-        }
-        double score = computeScore(fine_p1, fine_p2, coarse_p1, coarse_p2, radius);
-        if (score >= max_score)
-        {
-          current_lane = lane;
-          max_score = score;
-        }
-      }
-      if (max_score == -DBL_MAX)
-        return null_lanes;
-    }
-    else
-      current_lane = vmap.findByKey(Key<Lane>(current_lane.flid));;
-    if (current_lane.lnid == 0)
-      return null_lanes;
-  }
-
-  return null_lanes;
-}
-
 bool isValidPolygon(const Polygon& polygon)
 {
   return polygon.size() > 3;
@@ -512,42 +185,38 @@ private:
   VectorMap vmap_;
   double radius_;
   int loops_;
+  std::unique_ptr<TravelingRoute> traveling_route_;
+  LaneLinkedObjects<RoadEdge> road_edges_;
+  LaneLinkedObjects<Gutter> gutters_;
+  LaneLinkedObjects<Curb> curbs_;
+  LaneLinkedObjects<WhiteLine> white_lines_;
+  LaneLinkedObjects<StopLine> stop_lines_;
+  LaneLinkedObjects<ZebraZone> zebra_zones_;
+  LaneLinkedObjects<CrossWalk> cross_walks_;
+  LaneLinkedObjects<RoadMark> road_marks_;
+  LaneLinkedObjects<RoadPole> road_poles_;
+  LaneLinkedObjects<RoadSign> road_signs_;
+  LaneLinkedObjects<Signal> signals_;
+  LaneLinkedObjects<StreetLight> street_lights_;
+  LaneLinkedObjects<UtilityPole> utility_poles_;
+  LaneLinkedObjects<GuardRail> guard_rails_;
+  LaneLinkedObjects<SideWalk> side_walks_;
+  LaneLinkedObjects<DriveOnPortion> drive_on_portions_;
+  LaneLinkedObjects<CrossRoad> cross_roads_;
+  LaneLinkedObjects<SideStrip> side_strips_;
+  LaneLinkedObjects<CurveMirror> curve_mirrors_;
+  LaneLinkedObjects<Wall> walls_;
+  LaneLinkedObjects<Fence> fences_;
+  LaneLinkedObjects<RailCrossing> rail_crossings_;
 
   bool debug_;
   visualization_msgs::MarkerArray marker_array_;
   ros::Publisher marker_array_pub_;
 
-  std::vector<Lane> createTravelingRoute(const geometry_msgs::PoseStamped& pose,
-                                         const autoware_msgs::Lane& waypoints)
+  const std::vector<Lane>& createTravelingRoute(const geometry_msgs::PoseStamped& pose,
+                                                const autoware_msgs::Lane& waypoints)
   {
-    std::vector<Lane> null_lanes;
-
-    std::vector<Lane> fine_lanes;
-    if (waypoints.waypoints.empty())
-      fine_lanes = vmap_.findByFilter([](const Lane& lane){return true;});
-    else
-      fine_lanes = createFineLanes(vmap_, waypoints, radius_, loops_);
-    if (fine_lanes.empty())
-      return null_lanes;
-
-    Lane nearest_lane = findNearestLane(vmap_, fine_lanes, convertGeomPointToPoint(pose.pose.position));
-    if (nearest_lane.lnid == 0)
-      return null_lanes;
-
-    std::vector<Lane> traveling_route;
-    if (waypoints.waypoints.empty())
-      traveling_route.push_back(nearest_lane);
-    else
-    {
-      bool future = false;
-      for (const auto& fine_lane : fine_lanes)
-      {
-        if (fine_lane.lnid == nearest_lane.lnid)
-          future = true;
-        if (future)
-          traveling_route.push_back(fine_lane);
-      }
-    }
+    const std::vector<Lane>& traveling_route = traveling_route_->findTravelingRoute(pose.pose.position, waypoints);
 
     if (debug_)
     {
@@ -586,18 +255,46 @@ private:
 public:
   explicit VectorMapServer(ros::NodeHandle& nh)
   {
-    vmap_.subscribe(nh, Category::ALL, ros::Duration(0));
     nh.param<double>("vector_map_server/radius", radius_, 10);
     nh.param<int>("vector_map_server/loops", loops_, 10000);
     nh.param<bool>("vector_map_server/debug", debug_, false);
     if (debug_)
       marker_array_pub_ = nh.advertise<visualization_msgs::MarkerArray>("vector_map_server", 10, true);
+
+    // the route and lane-linked objects are rebuilt only when their tables change, not on every request
+    traveling_route_.reset(new TravelingRoute(vmap_, radius_, loops_));
+    vmap_.registerCallback([this](const vector_map_msgs::PointArray& msg){traveling_route_->update();});
+    vmap_.registerCallback([this](const vector_map_msgs::NodeArray& msg){traveling_route_->update();});
+    vmap_.registerCallback([this](const vector_map_msgs::LaneArray& msg){traveling_route_->update();});
+    vmap_.registerCallback([this](const vector_map_msgs::RoadEdgeArray& msg){road_edges_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::GutterArray& msg){gutters_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::CurbArray& msg){curbs_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::WhiteLineArray& msg){white_lines_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::StopLineArray& msg){stop_lines_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::ZebraZoneArray& msg){zebra_zones_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::CrossWalkArray& msg){cross_walks_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::RoadMarkArray& msg){road_marks_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::RoadPoleArray& msg){road_poles_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::RoadSignArray& msg){road_signs_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::SignalArray& msg){signals_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::StreetLightArray& msg){street_lights_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::UtilityPoleArray& msg){utility_poles_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::GuardRailArray& msg){guard_rails_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::SideWalkArray& msg){side_walks_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::DriveOnPortionArray& msg){drive_on_portions_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::CrossRoadArray& msg){cross_roads_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::SideStripArray& msg){side_strips_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::CurveMirrorArray& msg){curve_mirrors_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::WallArray& msg){walls_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::FenceArray& msg){fences_.update(vmap_);});
+    vmap_.registerCallback([this](const vector_map_msgs::RailCrossingArray& msg){rail_crossings_.update(vmap_);});
+    vmap_.subscribe(nh, Category::ALL, ros::Duration(0));
   }
 
   bool getDTLane(vector_map_server::GetDTLane::Request& request,
                  vector_map_server::GetDTLane::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
@@ -614,7 +311,7 @@ public:
   bool getNode(vector_map_server::GetNode::Request& request,
                vector_map_server::GetNode::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
@@ -636,7 +333,7 @@ public:
   bool getLane(vector_map_server::GetLane::Request& request,
                vector_map_server::GetLane::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
@@ -648,7 +345,7 @@ public:
   bool getWayArea(vector_map_server::GetWayArea::Request& request,
                   vector_map_server::GetWayArea::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
@@ -665,14 +362,13 @@ public:
   bool getRoadEdge(vector_map_server::GetRoadEdge::Request& request,
                    vector_map_server::GetRoadEdge::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_edge : vmap_.findByFilter(
-           [&lane](const RoadEdge& road_edge){return road_edge.linkid == lane.lnid;}))
+      for (const auto& road_edge : road_edges_.findByLane(lane.lnid))
         response.objects.data.push_back(road_edge);
     }
     return true;
@@ -681,14 +377,13 @@ public:
   bool getGutter(vector_map_server::GetGutter::Request& request,
                  vector_map_server::GetGutter::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& gutter : vmap_.findByFilter(
-           [&lane](const Gutter& gutter){return gutter.linkid == lane.lnid;}))
+      for (const auto& gutter : gutters_.findByLane(lane.lnid))
         response.objects.data.push_back(gutter);
     }
     return true;
@@ -697,14 +392,13 @@ public:
   bool getCurb(vector_map_server::GetCurb::Request& request,
                vector_map_server::GetCurb::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curb : vmap_.findByFilter(
-           [&lane](const Curb& curb){return curb.linkid == lane.lnid;}))
+      for (const auto& curb : curbs_.findByLane(lane.lnid))
         response.objects.data.push_back(curb);
     }
     return true;
@@ -713,14 +407,13 @@ public:
   bool getWhiteLine(vector_map_server::GetWhiteLine::Request& request,
                     vector_map_server::GetWhiteLine::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& white_line : vmap_.findByFilter(
-           [&lane](const WhiteLine& white_line){return white_line.linkid == lane.lnid;}))
+      for (const auto& white_line : white_lines_.findByLane(lane.lnid))
         response.objects.data.push_back(white_line);
     }
     return true;
@@ -729,14 +422,13 @@ public:
   bool getStopLine(vector_map_server::GetStopLine::Request& request,
                    vector_map_server::GetStopLine::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& stop_line : vmap_.findByFilter(
-           [&lane](const StopLine& stop_line){return stop_line.linkid == lane.lnid;}))
+      for (const auto& stop_line : stop_lines_.findByLane(lane.lnid))
         response.objects.data.push_back(stop_line);
     }
     return true;
@@ -745,14 +437,13 @@ public:
   bool getZebraZone(vector_map_server::GetZebraZone::Request& request,
                     vector_map_server::GetZebraZone::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& zebra_zone : vmap_.findByFilter(
-           [&lane](const ZebraZone& zebra_zone){return zebra_zone.linkid == lane.lnid;}))
+      for (const auto& zebra_zone : zebra_zones_.findByLane(lane.lnid))
         response.objects.data.push_back(zebra_zone);
     }
     return true;
@@ -761,14 +452,13 @@ public:
   bool getCrossWalk(vector_map_server::GetCrossWalk::Request& request,
                     vector_map_server::GetCrossWalk::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_walk : vmap_.findByFilter(
-           [&lane](const CrossWalk& cross_walk){return cross_walk.linkid == lane.lnid;}))
+      for (const auto& cross_walk : cross_walks_.findByLane(lane.lnid))
         response.objects.data.push_back(cross_walk);
     }
     return true;
@@ -777,14 +467,13 @@ public:
   bool getRoadMark(vector_map_server::GetRoadMark::Request& request,
                    vector_map_server::GetRoadMark::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_mark : vmap_.findByFilter(
-           [&lane](const RoadMark& road_mark){return road_mark.linkid == lane.lnid;}))
+      for (const auto& road_mark : road_marks_.findByLane(lane.lnid))
         response.objects.data.push_back(road_mark);
     }
     return true;
@@ -793,14 +482,13 @@ public:
   bool getRoadPole(vector_map_server::GetRoadPole::Request& request,
                    vector_map_server::GetRoadPole::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_pole : vmap_.findByFilter(
-           [&lane](const RoadPole& road_pole){return road_pole.linkid == lane.lnid;}))
+      for (const auto& road_pole : road_poles_.findByLane(lane.lnid))
         response.objects.data.push_back(road_pole);
     }
     return true;
@@ -809,14 +497,13 @@ public:
   bool getRoadSign(vector_map_server::GetRoadSign::Request& request,
                    vector_map_server::GetRoadSign::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& road_sign : vmap_.findByFilter(
-           [&lane](const RoadSign& road_sign){return road_sign.linkid == lane.lnid;}))
+      for (const auto& road_sign : road_signs_.findByLane(lane.lnid))
         response.objects.data.push_back(road_sign);
     }
     return true;
@@ -825,14 +512,13 @@ public:
   bool getSignal(vector_map_server::GetSignal::Request& request,
                  vector_map_server::GetSignal::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& signal : vmap_.findByFilter(
-           [&lane](const Signal& signal){return signal.linkid == lane.lnid;}))
+      for (const auto& signal : signals_.findByLane(lane.lnid))
         response.objects.data.push_back(signal);
     }
     return true;
@@ -841,14 +527,13 @@ public:
   bool getStreetLight(vector_map_server::GetStreetLight::Request& request,
                       vector_map_server::GetStreetLight::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& street_light : vmap_.findByFilter(
-           [&lane](const StreetLight& street_light){return street_light.linkid == lane.lnid;}))
+      for (const auto& street_light : street_lights_.findByLane(lane.lnid))
         response.objects.data.push_back(street_light);
     }
     return true;
@@ -857,14 +542,13 @@ public:
   bool getUtilityPole(vector_map_server::GetUtilityPole::Request& request,
                       vector_map_server::GetUtilityPole::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& utility_pole : vmap_.findByFilter(
-           [&lane](const UtilityPole& utility_pole){return utility_pole.linkid == lane.lnid;}))
+      for (const auto& utility_pole : utility_poles_.findByLane(lane.lnid))
         response.objects.data.push_back(utility_pole);
     }
     return true;
@@ -873,14 +557,13 @@ public:
   bool getGuardRail(vector_map_server::GetGuardRail::Request& request,
                     vector_map_server::GetGuardRail::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& guard_rail : vmap_.findByFilter(
-           [&lane](const GuardRail& guard_rail){return guard_rail.linkid == lane.lnid;}))
+      for (const auto& guard_rail : guard_rails_.findByLane(lane.lnid))
         response.objects.data.push_back(guard_rail);
     }
     return true;
@@ -889,14 +572,13 @@ public:
   bool getSideWalk(vector_map_server::GetSideWalk::Request& request,
                    vector_map_server::GetSideWalk::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_walk : vmap_.findByFilter(
-           [&lane](const SideWalk& side_walk){return side_walk.linkid == lane.lnid;}))
+      for (const auto& side_walk : side_walks_.findByLane(lane.lnid))
         response.objects.data.push_back(side_walk);
     }
     return true;
@@ -905,14 +587,13 @@ public:
   bool getDriveOnPortion(vector_map_server::GetDriveOnPortion::Request& request,
                          vector_map_server::GetDriveOnPortion::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& drive_on_portion : vmap_.findByFilter(
-           [&lane](const DriveOnPortion& drive_on_portion){return drive_on_portion.linkid == lane.lnid;}))
+      for (const auto& drive_on_portion : drive_on_portions_.findByLane(lane.lnid))
         response.objects.data.push_back(drive_on_portion);
     }
     return true;
@@ -921,14 +602,13 @@ public:
   bool getCrossRoad(vector_map_server::GetCrossRoad::Request& request,
                     vector_map_server::GetCrossRoad::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& cross_road : vmap_.findByFilter(
-           [&lane](const CrossRoad& cross_road){return cross_road.linkid == lane.lnid;}))
+      for (const auto& cross_road : cross_roads_.findByLane(lane.lnid))
         response.objects.data.push_back(cross_road);
     }
     return true;
@@ -937,14 +617,13 @@ public:
   bool getSideStrip(vector_map_server::GetSideStrip::Request& request,
                     vector_map_server::GetSideStrip::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& side_strip : vmap_.findByFilter(
-           [&lane](const SideStrip& side_strip){return side_strip.linkid == lane.lnid;}))
+      for (const auto& side_strip : side_strips_.findByLane(lane.lnid))
         response.objects.data.push_back(side_strip);
     }
     return true;
@@ -953,14 +632,13 @@ public:
   bool getCurveMirror(vector_map_server::GetCurveMirror::Request& request,
                       vector_map_server::GetCurveMirror::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& curve_mirror : vmap_.findByFilter(
-           [&lane](const CurveMirror& curve_mirror){return curve_mirror.linkid == lane.lnid;}))
+      for (const auto& curve_mirror : curve_mirrors_.findByLane(lane.lnid))
         response.objects.data.push_back(curve_mirror);
     }
     return true;
@@ -969,14 +647,13 @@ public:
   bool getWall(vector_map_server::GetWall::Request& request,
                vector_map_server::GetWall::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& wall : vmap_.findByFilter(
-           [&lane](const Wall& wall){return wall.linkid == lane.lnid;}))
+      for (const auto& wall : walls_.findByLane(lane.lnid))
         response.objects.data.push_back(wall);
     }
     return true;
@@ -985,14 +662,13 @@ public:
   bool getFence(vector_map_server::GetFence::Request& request,
                 vector_map_server::GetFence::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& fence : vmap_.findByFilter(
-           [&lane](const Fence& fence){return fence.linkid == lane.lnid;}))
+      for (const auto& fence : fences_.findByLane(lane.lnid))
         response.objects.data.push_back(fence);
     }
     return true;
@@ -1001,14 +677,13 @@ public:
   bool getRailCrossing(vector_map_server::GetRailCrossing::Request& request,
                        vector_map_server::GetRailCrossing::Response& response)
   {
-    std::vector<Lane> traveling_route = createTravelingRoute(request.pose, request.waypoints);
+    const std::vector<Lane>& traveling_route = createTravelingRoute(request.pose, request.waypoints);
     if (traveling_route.empty())
       return false;
     response.objects.header.frame_id = "map";
     for (const auto& lane : traveling_route)
     {
-      for (const auto& rail_crossing : vmap_.findByFilter(
-           [&lane](const RailCrossing& rail_crossing){return rail_crossing.linkid == lane.lnid;}))
+      for (const auto& rail_crossing : rail_crossings_.findByLane(lane.lnid))
         response.objects.data.push_back(rail_crossing);
     }
     return true;
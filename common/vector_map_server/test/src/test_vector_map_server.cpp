@@ -0,0 +1,816 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <random>
+
+#include <gtest/gtest.h>
+#include <ros/ros.h>
+#include "vector_map_server/traveling_route.h"
+
+using vector_map::VectorMap;
+using vector_map::Category;
+using vector_map::Key;
+
+using vector_map::Point;
+using vector_map::Node;
+using vector_map::Lane;
+using vector_map::WhiteLine;
+
+using vector_map::convertGeomPointToPoint;
+
+using vector_map_server::LaneLinkedObjects;
+using vector_map_server::TravelingRoute;
+
+namespace
+{
+const double RADIUS = 10;
+const int LOOPS = 10000;
+
+// the traveling route as the server created it from the whole map on every request
+namespace legacy
+{
+bool isBranchingLane(const Lane& lane)
+{
+  return lane.jct == Lane::LEFT_BRANCHING || lane.jct == Lane::RIGHT_BRANCHING || lane.jct == Lane::COMPOSITION;
+}
+
+double computeDistance(const Point& p1, const Point& p2)
+{
+  return std::hypot(p2.bx - p1.bx, p2.ly - p1.ly);
+}
+
+double computeAngle(const Point& p1, const Point& p2)
+{
+  return std::atan2(p2.ly - p1.ly, p2.bx - p1.bx);
+}
+
+double computeScore(const Point& bp1, const Point& bp2, const Point& p1, const Point& p2, double radius)
+{
+  double distance_score = computeDistance(bp1, p1);
+  distance_score = 50 * (radius - distance_score) / radius;
+  double angle_score = computeAngle(p1, p2) - computeAngle(bp1, bp2);
+  angle_score = 50 * (M_PI - std::fabs(angle_score)) / M_PI;
+  return distance_score + angle_score;
+}
+
+Point findStartPoint(const VectorMap& vmap, const Lane& lane)
+{
+  Point start_point;
+  Node node = vmap.findByKey(Key<Node>(lane.bnid));
+  if (node.nid == 0)
+    return start_point;
+  return vmap.findByKey(Key<Point>(node.pid));
+}
+
+Point findEndPoint(const VectorMap& vmap, const Lane& lane)
+{
+  Point end_point;
+  Node node = vmap.findByKey(Key<Node>(lane.fnid));
+  if (node.nid == 0)
+    return end_point;
+  return vmap.findByKey(Key<Point>(node.pid));
+}
+
+Point createMedianPoint(const Point& p1, const Point& p2)
+{
+  Point point;
+  point.bx = (p1.bx + p2.bx) / 2;
+  point.ly = (p1.ly + p2.ly) / 2;
+  point.h = (p1.h + p2.h) / 2;
+  return point;
+}
+
+std::vector<Point> findStartPoints(const VectorMap& vmap)
+{
+  std::vector<Point> start_points;
+  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
+  {
+    Node node = vmap.findByKey(Key<Node>(lane.bnid));
+    if (node.nid == 0)
+      continue;
+    Point point = vmap.findByKey(Key<Point>(node.pid));
+    if (point.pid == 0)
+      continue;
+    start_points.push_back(point);
+  }
+  return start_points;
+}
+
+std::vector<Point> findEndPoints(const VectorMap& vmap)
+{
+  std::vector<Point> end_points;
+  for (const auto& lane : vmap.findByFilter([](const Lane& lane){return true;}))
+  {
+    Node node = vmap.findByKey(Key<Node>(lane.fnid));
+    if (node.nid == 0)
+      continue;
+    Point point = vmap.findByKey(Key<Point>(node.pid));
+    if (point.pid == 0)
+      continue;
+    end_points.push_back(point);
+  }
+  return end_points;
+}
+
+Point findNearestPoint(const std::vector<Point>& points, const Point& base_point)
+{
+  Point nearest_point;
+  double min_distance = DBL_MAX;
+  for (const auto& point : points)
+  {
+    double distance = computeDistance(base_point, point);
+    if (distance <= min_distance)
+    {
+      nearest_point = point;
+      min_distance = distance;
+    }
+  }
+  return nearest_point;
+}
+
+std::vector<Point> findNearPoints(const std::vector<Point>& points, const Point& base_point, double radius)
+{
+  std::vector<Point> near_points;
+  for (const auto& point : points)
+  {
+    if (computeDistance(base_point, point) <= radius)
+      near_points.push_back(point);
+  }
+  return near_points;
+}
+
+std::vector<Lane> findLanesByStartPoint(const VectorMap& vmap, const Point& start_point)
+{
+  std::vector<Lane> lanes;
+  for (const auto& node : vmap.findByFilter([&start_point](const Node& node){return node.pid == start_point.pid;}))
+  {
+    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.bnid == node.nid;}))
+      lanes.push_back(lane);
+  }
+  return lanes;
+}
+
+std::vector<Lane> findLanesByEndPoint(const VectorMap& vmap, const Point& end_point)
+{
+  std::vector<Lane> lanes;
+  for (const auto& node : vmap.findByFilter([&end_point](const Node& node){return node.pid == end_point.pid;}))
+  {
+    for (const auto& lane : vmap.findByFilter([&node](const Lane& lane){return lane.fnid == node.nid;}))
+      lanes.push_back(lane);
+  }
+  return lanes;
+}
+
+Lane findStartLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
+{
+  Lane start_lane;
+  if (points.size() < 2)
+    return start_lane;
+
+  Point bp1 = points[0];
+  Point bp2 = points[1];
+  double max_score = -DBL_MAX;
+  for (const auto& p1 : findNearPoints(findStartPoints(vmap), bp1, radius))
+  {
+    for (const auto& lane : findLanesByStartPoint(vmap, p1))
+    {
+      if (lane.lnid == 0)
+        continue;
+      Point p2 = findEndPoint(vmap, lane);
+      if (p2.pid == 0)
+        continue;
+      double score = computeScore(bp1, bp2, p1, p2, radius);
+      if (score >= max_score)
+      {
+        start_lane = lane;
+        max_score = score;
+      }
+    }
+  }
+  return start_lane;
+}
+
+Lane findEndLane(const VectorMap& vmap, const std::vector<Point>& points, double radius)
+{
+  Lane end_lane;
+  if (points.size() < 2)
+    return end_lane;
+
+  Point bp1 = points[points.size() - 2];
+  Point bp2 = points[points.size() - 1];
+  double max_score = -DBL_MAX;
+  for (const auto& p2 : findNearPoints(findEndPoints(vmap), bp2, radius))
+  {
+    for (const auto& lane : findLanesByEndPoint(vmap, p2))
+    {
+      if (lane.lnid == 0)
+        continue;
+      Point p1 = findStartPoint(vmap, lane);
+      if (p1.pid == 0)
+        continue;
+      double score = computeScore(bp2, bp1, p2, p1, radius);
+      if (score >= max_score)
+      {
+        end_lane = lane;
+        max_score = score;
+      }
+    }
+  }
+  return end_lane;
+}
+
+Lane findNearestLane(const VectorMap& vmap, const std::vector<Lane>& lanes, const Point& base_point)
+{
+  Lane nearest_lane;
+  double min_distance = DBL_MAX;
+  for (const auto& lane : lanes)
+  {
+    Point start_point = findStartPoint(vmap, lane);
+    if (start_point.pid == 0)
+      continue;
+    Point end_point = findEndPoint(vmap, lane);
+    if (end_point.pid == 0)
+      continue;
+    Point median_point = createMedianPoint(start_point, end_point);
+    double distance = computeDistance(base_point, median_point);
+    if (distance <= min_distance)
+    {
+      nearest_lane = lane;
+      min_distance = distance;
+    }
+  }
+  return nearest_lane;
+}
+
+std::vector<Lane> createFineLanes(const VectorMap& vmap, const autoware_msgs::Lane& waypoints, double radius,
+                                  int loops)
+{
+  std::vector<Lane> null_lanes;
+
+  std::vector<Point> coarse_points;
+  for (const auto& waypoint : waypoints.waypoints)
+    coarse_points.push_back(convertGeomPointToPoint(waypoint.pose.pose.position));
+
+  Lane start_lane = findStartLane(vmap, coarse_points, radius);
+  if (start_lane.lnid == 0)
+    return null_lanes;
+
+  Lane end_lane = findEndLane(vmap, coarse_points, radius);
+  if (end_lane.lnid == 0)
+    return null_lanes;
+
+  std::vector<Lane> fine_lanes;
+  Lane current_lane = start_lane;
+  for (int i = 0; i < loops; ++i)
+  {
+    fine_lanes.push_back(current_lane);
+    if (current_lane.lnid == end_lane.lnid)
+      return fine_lanes;
+
+    if (isBranchingLane(current_lane))
+    {
+      Point fine_p1 = findEndPoint(vmap, current_lane);
+      if (fine_p1.pid == 0)
+        return null_lanes;
+
+      Point coarse_p1 = findNearestPoint(coarse_points, fine_p1);
+
+      if (computeDistance(fine_p1, coarse_p1) > radius)
+        return null_lanes;
+
+      Point coarse_p2;
+      double distance = -DBL_MAX;
+      for (const auto& coarse_point : coarse_points)
+      {
+        if (distance == -DBL_MAX)
+        {
+          if (coarse_point.bx == coarse_p1.bx && coarse_point.ly == coarse_p1.ly)
+            distance = 0;
+          continue;
+        }
+        coarse_p2 = coarse_point;
+        distance = computeDistance(coarse_p2, coarse_p1);
+        if (distance > radius)
+          break;
+      }
+      if (distance <= 0)
+        return null_lanes;
+
+      double max_score = -DBL_MAX;
+      vector_map::Filter<Lane> is_next_lane = [&current_lane](const Lane& lane)
+        {
+          return lane.lnid == current_lane.flid || lane.lnid == current_lane.flid2 ||
+                 lane.lnid == current_lane.flid3 || lane.lnid == current_lane.flid4;
+        };
+      for (const auto& lane : vmap.findByFilter(is_next_lane))
+      {
+        Lane next_lane = lane;
+        Point next_point = findEndPoint(vmap, next_lane);
+        if (next_point.pid == 0)
+          continue;
+        Point fine_p2 = next_point;
+        while (computeDistance(fine_p2, fine_p1) <= radius && !isBranchingLane(next_lane) && next_lane.flid != 0)
+        {
+          next_lane = vmap.findByKey(Key<Lane>(next_lane.flid));
+          if (next_lane.lnid == 0)
+            break;
+          next_point = findEndPoint(vmap, next_lane);
+          if (next_point.pid == 0)
+            break;
+          fine_p2 = next_point;
+        }
+        double score = computeScore(fine_p1, fine_p2, coarse_p1, coarse_p2, radius);
+        if (score >= max_score)
+        {
+          current_lane = lane;
+          max_score = score;
+        }
+      }
+      if (max_score == -DBL_MAX)
+        return null_lanes;
+    }
+    else
+      current_lane = vmap.findByKey(Key<Lane>(current_lane.flid));
+    if (current_lane.lnid == 0)
+      return null_lanes;
+  }
+
+  return null_lanes;
+}
+
+std::vector<Lane> createTravelingRoute(const VectorMap& vmap, const geometry_msgs::Point& position,
+                                       const autoware_msgs::Lane& waypoints)
+{
+  std::vector<Lane> null_lanes;
+
+  std::vector<Lane> fine_lanes;
+  if (waypoints.waypoints.empty())
+    fine_lanes = vmap.findByFilter([](const Lane& lane){return true;});
+  else
+    fine_lanes = createFineLanes(vmap, waypoints, RADIUS, LOOPS);
+  if (fine_lanes.empty())
+    return null_lanes;
+
+  Lane nearest_lane = findNearestLane(vmap, fine_lanes, convertGeomPointToPoint(position));
+  if (nearest_lane.lnid == 0)
+    return null_lanes;
+
+  std::vector<Lane> traveling_route;
+  if (waypoints.waypoints.empty())
+    traveling_route.push_back(nearest_lane);
+  else
+  {
+    bool future = false;
+    for (const auto& fine_lane : fine_lanes)
+    {
+      if (fine_lane.lnid == nearest_lane.lnid)
+        future = true;
+      if (future)
+        traveling_route.push_back(fine_lane);
+    }
+  }
+  return traveling_route;
+}
+} // namespace legacy
+
+// a grid of one-way roads crossing every 50 m, split into lanes of 2 m which branch at the crossings
+struct TestMap
+{
+  vector_map_msgs::PointArray points;
+  vector_map_msgs::NodeArray nodes;
+  vector_map_msgs::LaneArray lanes;
+  vector_map_msgs::WhiteLineArray white_lines;
+};
+
+const int LANES_PER_ROAD = 25;
+const double LANE_LENGTH = 2;
+
+TestMap createTestMap(int crossings, std::mt19937& engine)
+{
+  TestMap map;
+  std::map<std::pair<int, int>, int> pids;
+  std::map<std::pair<int, bool>, int> nids;
+  auto findNode = [&](int x, int y, bool vertical)
+    {
+      auto pid = pids.find(std::make_pair(x, y));
+      if (pid == pids.end())
+      {
+        Point point;
+        point.pid = map.points.data.size() + 1;
+        point.bx = y * LANE_LENGTH;
+        point.ly = x * LANE_LENGTH;
+        map.points.data.push_back(point);
+        pid = pids.emplace(std::make_pair(x, y), point.pid).first;
+      }
+      // a crossing has a node for either road on the same point
+      auto nid = nids.find(std::make_pair(pid->second, vertical));
+      if (nid == nids.end())
+      {
+        Node node;
+        node.nid = map.nodes.data.size() + 1;
+        node.pid = pid->second;
+        map.nodes.data.push_back(node);
+        nid = nids.emplace(std::make_pair(pid->second, vertical), node.nid).first;
+      }
+      return nid->second;
+    };
+
+  int length = (crossings - 1) * LANES_PER_ROAD;
+  std::vector<Lane> lanes;
+  std::vector<std::pair<int, int>> lane_points;
+  for (int road = 0; road < crossings; ++road)
+  {
+    for (bool vertical : { false, true })
+    {
+      bool forward = road % 2 == 0;
+      for (int i = 0; i < length; ++i)
+      {
+        int from = forward ? i : length - i;
+        int to = forward ? i + 1 : length - i - 1;
+        int offset = road * LANES_PER_ROAD;
+        Lane lane;
+        lane.bnid = vertical ? findNode(offset, from, true) : findNode(from, offset, false);
+        lane.fnid = vertical ? findNode(offset, to, true) : findNode(to, offset, false);
+        lanes.push_back(lane);
+        lane_points.emplace_back(map.nodes.data[lane.bnid - 1].pid, map.nodes.data[lane.fnid - 1].pid);
+      }
+    }
+  }
+
+  // lane ids in another order than the lanes follow each other
+  std::vector<int> lnids(lanes.size());
+  std::iota(lnids.begin(), lnids.end(), 1);
+  std::shuffle(lnids.begin(), lnids.end(), engine);
+  for (size_t i = 0; i < lanes.size(); ++i)
+    lanes[i].lnid = lnids[i];
+
+  std::multimap<int, size_t> lanes_by_start_point;
+  std::multimap<int, size_t> lanes_by_end_point;
+  for (size_t i = 0; i < lanes.size(); ++i)
+  {
+    lanes_by_start_point.emplace(lane_points[i].first, i);
+    lanes_by_end_point.emplace(lane_points[i].second, i);
+  }
+  for (size_t i = 0; i < lanes.size(); ++i)
+  {
+    std::vector<int> flids;
+    auto next_lanes = lanes_by_start_point.equal_range(lane_points[i].second);
+    for (auto it = next_lanes.first; it != next_lanes.second; ++it)
+    {
+      // the straight lane first
+      if (lanes[it->second].bnid == lanes[i].fnid)
+        flids.insert(flids.begin(), lanes[it->second].lnid);
+      else
+        flids.push_back(lanes[it->second].lnid);
+    }
+    std::vector<int> blids;
+    auto previous_lanes = lanes_by_end_point.equal_range(lane_points[i].first);
+    for (auto it = previous_lanes.first; it != previous_lanes.second; ++it)
+      blids.push_back(lanes[it->second].lnid);
+
+    Lane& lane = lanes[i];
+    lane.flid = flids.size() > 0 ? flids[0] : 0;
+    lane.flid2 = flids.size() > 1 ? flids[1] : 0;
+    lane.blid = blids.size() > 0 ? blids[0] : 0;
+    lane.blid2 = blids.size() > 1 ? blids[1] : 0;
+    if (flids.size() > 1)
+      lane.jct = lane.lnid % 2 == 0 ? Lane::LEFT_BRANCHING : Lane::RIGHT_BRANCHING;
+    else if (blids.size() > 1)
+      lane.jct = lane.lnid % 2 == 0 ? Lane::LEFT_MERGING : Lane::RIGHT_MERGING;
+    else
+      lane.jct = Lane::NORMAL;
+    lane.span = LANE_LENGTH;
+    map.lanes.data.push_back(lane);
+  }
+
+  // none, one or two white lines for a lane, and some linked to no lane
+  std::uniform_int_distribution<int> white_line_count(-1, 2);
+  for (const auto& lane : lanes)
+  {
+    int count = white_line_count(engine);
+    for (int i = 0; i < count; ++i)
+    {
+      WhiteLine white_line;
+      white_line.lid = map.white_lines.data.size() + 1;
+      white_line.linkid = lane.lnid;
+      map.white_lines.data.push_back(white_line);
+    }
+  }
+  for (int i = 0; i < 10; ++i)
+  {
+    WhiteLine white_line;
+    white_line.lid = map.white_lines.data.size() + 1;
+    map.white_lines.data.push_back(white_line);
+  }
+  std::vector<int> ids(map.white_lines.data.size());
+  std::iota(ids.begin(), ids.end(), 1);
+  std::shuffle(ids.begin(), ids.end(), engine);
+  for (size_t i = 0; i < ids.size(); ++i)
+    map.white_lines.data[i].id = ids[i];
+
+  return map;
+}
+
+geometry_msgs::Point createPosition(const Point& point, double noise, std::mt19937& engine)
+{
+  std::uniform_real_distribution<double> distribution(-noise, noise);
+  geometry_msgs::Point position;
+  position.x = point.ly + distribution(engine);
+  position.y = point.bx + distribution(engine);
+  return position;
+}
+
+// waypoints along the start points of lanes which follow each other, taking a random branch at the crossings
+autoware_msgs::Lane createWaypoints(const TestMap& map, size_t lanes, std::mt19937& engine)
+{
+  std::map<int, Lane> lanes_by_lnid;
+  for (const auto& lane : map.lanes.data)
+    lanes_by_lnid.emplace(lane.lnid, lane);
+  auto findPoint = [&map](int nid){return map.points.data[map.nodes.data[nid - 1].pid - 1];};
+
+  autoware_msgs::Lane waypoints;
+  std::uniform_int_distribution<size_t> start(0, map.lanes.data.size() - 1);
+  Lane lane = map.lanes.data[start(engine)];
+  for (size_t i = 0; i < lanes; ++i)
+  {
+    autoware_msgs::Waypoint waypoint;
+    waypoint.pose.pose.position = createPosition(findPoint(lane.bnid), 0.5, engine);
+    waypoints.waypoints.push_back(waypoint);
+
+    std::vector<int> flids;
+    for (int flid : { lane.flid, lane.flid2 })
+    {
+      if (flid != 0)
+        flids.push_back(flid);
+    }
+    if (flids.empty())
+      break;
+    lane = lanes_by_lnid.at(flids[std::uniform_int_distribution<size_t>(0, flids.size() - 1)(engine)]);
+  }
+  autoware_msgs::Waypoint waypoint;
+  waypoint.pose.pose.position = createPosition(findPoint(lane.fnid), 0.5, engine);
+  waypoints.waypoints.push_back(waypoint);
+  return waypoints;
+}
+
+std::vector<int> findLnids(const std::vector<Lane>& lanes)
+{
+  std::vector<int> lnids;
+  for (const auto& lane : lanes)
+    lnids.push_back(lane.lnid);
+  return lnids;
+}
+
+std::vector<int> findIds(const std::vector<WhiteLine>& white_lines)
+{
+  std::vector<int> ids;
+  for (const auto& white_line : white_lines)
+    ids.push_back(white_line.id);
+  return ids;
+}
+} // namespace
+
+class VectorMapServerTestSuite : public ::testing::Test
+{
+protected:
+  ros::NodeHandle nh_;
+  ros::Publisher point_pub_;
+  ros::Publisher node_pub_;
+  ros::Publisher lane_pub_;
+  ros::Publisher white_line_pub_;
+
+  VectorMap vmap_;
+  TravelingRoute traveling_route_;
+  LaneLinkedObjects<WhiteLine> white_lines_;
+  int point_updates_ = 0;
+  int node_updates_ = 0;
+  int lane_updates_ = 0;
+  int white_line_updates_ = 0;
+
+  std::mt19937 engine_;
+  TestMap map_;
+
+  VectorMapServerTestSuite() : traveling_route_(vmap_, RADIUS, LOOPS)
+  {
+  }
+
+  virtual void SetUp()
+  {
+    point_pub_ = nh_.advertise<vector_map_msgs::PointArray>("/vector_map_info/point", 1, true);
+    node_pub_ = nh_.advertise<vector_map_msgs::NodeArray>("/vector_map_info/node", 1, true);
+    lane_pub_ = nh_.advertise<vector_map_msgs::LaneArray>("/vector_map_info/lane", 1, true);
+    white_line_pub_ = nh_.advertise<vector_map_msgs::WhiteLineArray>("/vector_map_info/white_line", 1, true);
+
+    // as the server updates its caches
+    vmap_.registerCallback([this](const vector_map_msgs::PointArray& msg){traveling_route_.update(); ++point_updates_;});
+    vmap_.registerCallback([this](const vector_map_msgs::NodeArray& msg){traveling_route_.update(); ++node_updates_;});
+    vmap_.registerCallback([this](const vector_map_msgs::LaneArray& msg){traveling_route_.update(); ++lane_updates_;});
+    vmap_.registerCallback([this](const vector_map_msgs::WhiteLineArray& msg){
+        white_lines_.update(vmap_);
+        ++white_line_updates_;
+      });
+    vmap_.subscribe(nh_, Category::POINT | Category::NODE | Category::LANE | Category::WHITE_LINE, ros::Duration(0));
+
+    map_ = createTestMap(8, engine_);
+    point_pub_.publish(map_.points);
+    node_pub_.publish(map_.nodes);
+    lane_pub_.publish(map_.lanes);
+    white_line_pub_.publish(map_.white_lines);
+    waitForUpdates(1, 1);
+  }
+
+  void waitForUpdates(int lane_updates, int white_line_updates)
+  {
+    ros::Time end = ros::Time::now() + ros::Duration(30);
+    while (ros::ok() && ros::Time::now() < end &&
+           (point_updates_ < 1 || node_updates_ < 1 || lane_updates_ < lane_updates ||
+            white_line_updates_ < white_line_updates))
+    {
+      ros::spinOnce();
+      ros::Duration(0.01).sleep();
+    }
+    ASSERT_GE(lane_updates_, lane_updates);
+    ASSERT_GE(white_line_updates_, white_line_updates);
+  }
+
+  // compares the cached route with the legacy one for poses around and away from the waypoints, returns the number
+  // of nonempty routes
+  int expectLegacyRoutes(const autoware_msgs::Lane& waypoints, int poses)
+  {
+    std::uniform_real_distribution<double> city(-20, 8 * LANES_PER_ROAD * LANE_LENGTH);
+    std::uniform_int_distribution<int> kind(0, 3);
+    int nonempty_routes = 0;
+    geometry_msgs::Point position;
+    for (int i = 0; i < poses; ++i)
+    {
+      switch (kind(engine_))
+      {
+        case 0:
+          if (!waypoints.waypoints.empty())
+          {
+            size_t index = std::uniform_int_distribution<size_t>(0, waypoints.waypoints.size() - 1)(engine_);
+            position = createPosition(convertGeomPointToPoint(waypoints.waypoints[index].pose.pose.position), 3,
+                                      engine_);
+          }
+          break;
+        case 1:
+          position.x = city(engine_);
+          position.y = city(engine_);
+          break;
+        case 2:
+          // a pose on the grid of lane ends and medians, often equally near to several lanes
+          position.x = std::round(city(engine_) / LANE_LENGTH) * LANE_LENGTH;
+          position.y = std::round(city(engine_) / LANE_LENGTH) * LANE_LENGTH + LANE_LENGTH / 2;
+          break;
+        default:
+          break; // the previous pose again
+      }
+
+      std::vector<Lane> expected = legacy::createTravelingRoute(vmap_, position, waypoints);
+      const std::vector<Lane>& traveling_route = traveling_route_.findTravelingRoute(position, waypoints);
+      EXPECT_EQ(findLnids(expected), findLnids(traveling_route));
+      if (traveling_route.empty())
+        continue;
+      ++nonempty_routes;
+
+      for (const auto& lane : traveling_route)
+      {
+        std::vector<WhiteLine> expected_white_lines = vmap_.findByFilter(
+          [&lane](const WhiteLine& white_line){return white_line.linkid == lane.lnid;});
+        EXPECT_EQ(findIds(expected_white_lines), findIds(white_lines_.findByLane(lane.lnid)));
+      }
+    }
+    return nonempty_routes;
+  }
+};
+
+TEST_F(VectorMapServerTestSuite, createFineLanes)
+{
+  int nonempty_fine_lanes = 0;
+  for (int i = 0; i < 50; ++i)
+  {
+    autoware_msgs::Lane waypoints = createWaypoints(map_, 5 + 5 * i, engine_);
+    std::vector<Lane> expected = legacy::createFineLanes(vmap_, waypoints, RADIUS, LOOPS);
+    std::vector<Lane> fine_lanes = traveling_route_.createFineLanes(waypoints);
+    EXPECT_EQ(findLnids(expected), findLnids(fine_lanes));
+    if (!fine_lanes.empty())
+      ++nonempty_fine_lanes;
+  }
+  EXPECT_GT(nonempty_fine_lanes, 10);
+
+  // waypoints off the map or too few
+  autoware_msgs::Lane waypoints;
+  EXPECT_TRUE(traveling_route_.createFineLanes(waypoints).empty());
+  waypoints.waypoints.resize(1);
+  EXPECT_TRUE(traveling_route_.createFineLanes(waypoints).empty());
+  waypoints.waypoints.resize(2);
+  waypoints.waypoints[0].pose.pose.position.x = -1000;
+  waypoints.waypoints[1].pose.pose.position.x = -1010;
+  EXPECT_TRUE(traveling_route_.createFineLanes(waypoints).empty());
+}
+
+TEST_F(VectorMapServerTestSuite, findTravelingRoute)
+{
+  EXPECT_GT(expectLegacyRoutes(autoware_msgs::Lane(), 100), 0);
+
+  int nonempty_routes = 0;
+  for (int i = 0; i < 30; ++i)
+    nonempty_routes += expectLegacyRoutes(createWaypoints(map_, 10 + 10 * i, engine_), 20);
+  EXPECT_GT(nonempty_routes, 0);
+
+  // back to no waypoints after the waypoints
+  expectLegacyRoutes(autoware_msgs::Lane(), 20);
+}
+
+TEST_F(VectorMapServerTestSuite, updateMap)
+{
+  autoware_msgs::Lane waypoints = createWaypoints(map_, 100, engine_);
+  expectLegacyRoutes(waypoints, 20);
+
+  // lanes removed with lanes still linked to them, and white lines moved to other lanes
+  std::bernoulli_distribution removed(0.05);
+  vector_map_msgs::LaneArray lanes;
+  for (const auto& lane : map_.lanes.data)
+  {
+    if (!removed(engine_))
+      lanes.data.push_back(lane);
+  }
+  vector_map_msgs::WhiteLineArray white_lines = map_.white_lines;
+  std::uniform_int_distribution<int> lnid(0, map_.lanes.data.size());
+  for (auto& white_line : white_lines.data)
+    white_line.linkid = lnid(engine_);
+  int lane_updates = lane_updates_ + 1;
+  int white_line_updates = white_line_updates_ + 1;
+  lane_pub_.publish(lanes);
+  white_line_pub_.publish(white_lines);
+  waitForUpdates(lane_updates, white_line_updates);
+
+  expectLegacyRoutes(waypoints, 20);
+  for (int i = 0; i < 10; ++i)
+    expectLegacyRoutes(createWaypoints(map_, 20 + 20 * i, engine_), 10);
+  expectLegacyRoutes(autoware_msgs::Lane(), 20);
+}
+
+TEST_F(VectorMapServerTestSuite, benchmark)
+{
+  // a vehicle driving along its waypoints, requesting the route about every meter
+  autoware_msgs::Lane waypoints = createWaypoints(map_, 300, engine_);
+  std::vector<geometry_msgs::Point> positions;
+  for (size_t i = 0; i + 1 < waypoints.waypoints.size(); ++i)
+  {
+    const geometry_msgs::Point& p1 = waypoints.waypoints[i].pose.pose.position;
+    const geometry_msgs::Point& p2 = waypoints.waypoints[i + 1].pose.pose.position;
+    for (double t : { 0.0, 0.5 })
+    {
+      geometry_msgs::Point position;
+      position.x = p1.x + (p2.x - p1.x) * t;
+      position.y = p1.y + (p2.y - p1.y) * t;
+      positions.push_back(position);
+    }
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  size_t legacy_lanes = 0;
+  for (const auto& position : positions)
+    legacy_lanes += legacy::createTravelingRoute(vmap_, position, waypoints).size();
+  auto legacy_end = std::chrono::steady_clock::now();
+  size_t lanes = 0;
+  for (const auto& position : positions)
+    lanes += traveling_route_.findTravelingRoute(position, waypoints).size();
+  auto end = std::chrono::steady_clock::now();
+  EXPECT_EQ(legacy_lanes, lanes);
+
+  double legacy_time = std::chrono::duration<double, std::milli>(legacy_end - start).count();
+  double time = std::chrono::duration<double, std::milli>(end - legacy_end).count();
+  std::cout << positions.size() << " routes from " << waypoints.waypoints.size() << " waypoints on "
+            << map_.lanes.data.size() << " lanes: legacy " << legacy_time << " ms, cached " << time << " ms"
+            << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  ros::init(argc, argv, "VectorMapServerTestSuite");
+
+  return RUN_ALL_TESTS();
+}
@@ -23,6 +23,7 @@ Nmea2TFPoseNode::Nmea2TFPoseNode()
   : private_nh_("~")
   , MAP_FRAME_("map")
   , GPS_FRAME_("gps")
+  , check_checksum_(false)
   , roll_(0)
   , pitch_(0)
   , yaw_(0)
@@ -45,6 +46,7 @@ void Nmea2TFPoseNode::initForROS()
 {
   // ros parameter settings
   private_nh_.getParam("plane", plane_number_);
+  private_nh_.param<bool>("check_checksum", check_checksum_, false);
 
   // setup subscriber
   sub1_ = nh_.subscribe("nmea_sentence", 100, &Nmea2TFPoseNode::callbackFromNmeaSentence, this);
@@ -87,57 +89,58 @@ void Nmea2TFPoseNode::createOrientation()
   pitch_ = 0;
 }
 
-void Nmea2TFPoseNode::convert(std::vector<std::string> nmea, ros::Time current_stamp)
+void Nmea2TFPoseNode::convert(const gnss::NmeaSentence &nmea, ros::Time current_stamp)
 {
   try
   {
-    if (nmea.at(0).compare(0, 2, "QQ") == 0)
+    const gnss::NmeaField &header = nmea.field(0);
+    if (header.startsWith("QQ"))
     {
-      orientation_time_ = stod(nmea.at(3));
-      roll_ = stod(nmea.at(4)) * M_PI / 180.;
-      pitch_ = -1 * stod(nmea.at(5)) * M_PI / 180.;
-      yaw_ = -1 * stod(nmea.at(6)) * M_PI / 180. + M_PI / 2;
+      orientation_time_ = nmea.toDouble(3);
+      roll_ = nmea.toDouble(4) * M_PI / 180.;
+      pitch_ = -1 * nmea.toDouble(5) * M_PI / 180.;
+      yaw_ = -1 * nmea.toDouble(6) * M_PI / 180. + M_PI / 2;
       orientation_stamp_ = current_stamp;
       orientation_ready_ = true;
       ROS_INFO("QQ is subscribed.");
     }
-    else if (nmea.at(0) == "$PASHR")
+    else if (header == "$PASHR")
     {
-      orientation_time_ = stod(nmea.at(1));
-      roll_ = stod(nmea.at(4)) * M_PI / 180.;
-      pitch_ = -1 * stod(nmea.at(5)) * M_PI / 180.;
-      yaw_ = -1 * stod(nmea.at(2)) * M_PI / 180. + M_PI / 2;
+      orientation_time_ = nmea.toDouble(1);
+      roll_ = nmea.toDouble(4) * M_PI / 180.;
+      pitch_ = -1 * nmea.toDouble(5) * M_PI / 180.;
+      yaw_ = -1 * nmea.toDouble(2) * M_PI / 180. + M_PI / 2;
       orientation_ready_ = true;
       ROS_INFO("PASHR is subscribed.");
     }
-    else if (nmea.at(0).compare(3, 3, "GGA") == 0)
+    else if (header.size >= 6 && header.data[3] == 'G' && header.data[4] == 'G' && header.data[5] == 'A')
     {
-      position_time_ = stod(nmea.at(1));
-      double lat = stod(nmea.at(2));
-      double lon = stod(nmea.at(4));
-      double h = stod(nmea.at(9));
+      position_time_ = nmea.toDouble(1);
+      double lat = nmea.toDouble(2);
+      double lon = nmea.toDouble(4);
+      double h = nmea.toDouble(9);
 
-      if (nmea.at(3) == "S")
+      if (nmea.field(3) == "S")
         lat = -lat;
 
-      if (nmea.at(5) == "W")
+      if (nmea.field(5) == "W")
         lon = -lon;
 
       geo_.set_llh_nmea_degrees(lat, lon, h);
 
       ROS_INFO("GGA is subscribed.");
     }
-    else if (nmea.at(0) == "$GPRMC")
+    else if (header == "$GPRMC")
     {
-      position_time_ = stoi(nmea.at(1));
-      double lat = stod(nmea.at(3));
-      double lon = stod(nmea.at(5));
+      position_time_ = nmea.toInt(1);
+      double lat = nmea.toDouble(3);
+      double lon = nmea.toDouble(5);
       double h = 0.0;
 
-      if (nmea.at(4) == "S")
+      if (nmea.field(4) == "S")
         lat = -lat;
 
-      if (nmea.at(6) == "W")
+      if (nmea.field(6) == "W")
         lon = -lon;
 
       geo_.set_llh_nmea_degrees(lat, lon, h);
@@ -153,8 +156,21 @@ void Nmea2TFPoseNode::convert(std::vector<std::string> nmea, ros::Time current_s
 
 void Nmea2TFPoseNode::callbackFromNmeaSentence(const nmea_msgs::Sentence::ConstPtr &msg)
 {
+  if (!nmea_.tokenize(msg->sentence))
+  {
+    ROS_WARN_STREAM("Message is invalid : too many fields");
+    return;
+  }
+
+  // sentences without checksum, like the QQ sentences of some receivers, are always accepted
+  if (check_checksum_ && nmea_.hasChecksum() && !nmea_.isChecksumValid())
+  {
+    ROS_WARN_STREAM("Message is invalid : checksum mismatch");
+    return;
+  }
+
   current_time_ = msg->header.stamp;
-  convert(split(msg->sentence), msg->header.stamp);
+  convert(nmea_, msg->header.stamp);
 
   double timeout = 10.0;
   // if orientation_stamp_ is 0 then no "QQ" sentence was ever received,
@@ -199,16 +215,4 @@ void Nmea2TFPoseNode::callbackFromNmeaSentence(const nmea_msgs::Sentence::ConstP
   }
 }
 
-std::vector<std::string> split(const std::string &string)
-{
-  std::vector<std::string> str_vec_ptr;
-  std::string token;
-  std::stringstream ss(string);
-
-  while (getline(ss, token, ','))
-    str_vec_ptr.push_back(token);
-
-  return str_vec_ptr;
-}
-
 }  // namespace gnss_localizer
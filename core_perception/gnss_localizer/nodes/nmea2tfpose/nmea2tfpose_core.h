@@ -28,6 +28,7 @@
 #include <tf/transform_broadcaster.h>
 
 #include <gnss/geo_pos_conv.hpp>
+#include <gnss/nmea_sentence.hpp>
 
 namespace gnss_localizer
 {
@@ -56,6 +57,8 @@ private:
 
   // variables
   int32_t plane_number_;
+  bool check_checksum_;
+  gnss::NmeaSentence nmea_;
   geo_pos_conv geo_;
   geo_pos_conv last_geo_;
   double roll_, pitch_, yaw_;
@@ -74,10 +77,8 @@ private:
   void publishPoseStamped();
   void publishTF();
   void createOrientation();
-  void convert(std::vector<std::string> nmea, ros::Time current_stamp);
+  void convert(const gnss::NmeaSentence &nmea, ros::Time current_stamp);
 };
 
-std::vector<std::string> split(const std::string &string);
-
 }  // namespace gnss_localizer
 #endif  // NMEA2TFPOSE_CORE_H
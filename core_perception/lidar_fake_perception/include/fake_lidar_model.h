@@ -0,0 +1,89 @@
+/*
+*/
+
+#ifndef FAKE_LIDAR_MODEL_H
+#define FAKE_LIDAR_MODEL_H
+
+#include <vector>
+
+#include <Eigen/Core>
+
+// Sensor model of a spinning lidar, the beams of each elevation are cast every horizontal
+// resolution step against boxes, the first box hit by a beam returns a point
+class FakeLidarModel
+{
+public:
+  struct Box
+  {
+    Eigen::Vector3d position;    // box center in the sensor frame
+    Eigen::Matrix3d rotation;    // box orientation in the sensor frame
+    Eigen::Vector3d dimensions;  // length, width, height [m]
+  };
+
+  struct Hit
+  {
+    Eigen::Vector3f point;  // in the sensor frame
+    int box;                // index of the box hit
+  };
+
+  // vertical_angles: elevation of each beam [rad], horizontal_resolution [rad], max_range [m]
+  FakeLidarModel(const std::vector<double>& vertical_angles, double horizontal_resolution, double max_range);
+
+  // beams evenly spread from min_angle to max_angle [rad]
+  static std::vector<double> uniformVerticalAngles(int beams, double min_angle, double max_angle);
+
+  void setBoxes(const std::vector<Box>& boxes);
+
+  // nearest hit of every beam crossing one of the boxes, at most one point per beam and step
+  void cast(std::vector<Hit>& hits);
+
+  // true if one of the boxes lies between the sensor and the point, or contains it
+  bool isOccluded(const Eigen::Vector3f& point) const;
+
+  int getBeamCount() const
+  {
+    return static_cast<int>(vertical_angles_.size());
+  }
+
+  int getStepCount() const
+  {
+    return steps_;
+  }
+
+private:
+  // box in its own frame, with the angular sector it can cover seen from the sensor
+  struct PreparedBox
+  {
+    Eigen::Matrix3d rotation_inv;
+    Eigen::Vector3d origin;  // sensor origin in the box frame
+    Eigen::Vector3d half_size;
+    bool contains_sensor;    // no return, every beam would hit at zero range
+    bool all_around;         // sensor above or below the box
+    double min_azimuth;
+    double max_azimuth;      // may exceed pi, the sector wraps around
+    double min_elevation;
+    double max_elevation;
+  };
+
+  std::vector<double> vertical_angles_;  // sorted
+  std::vector<double> beam_cos_;
+  std::vector<double> beam_sin_;
+  std::vector<double> step_cos_;
+  std::vector<double> step_sin_;
+  double horizontal_resolution_;
+  double max_range_;
+  int steps_;
+
+  std::vector<PreparedBox> boxes_;
+  std::vector<std::vector<int> > azimuth_bins_;  // boxes covering each degree of azimuth
+
+  // nearest hit of the beams cast, and the beams touched by the last cast
+  std::vector<float> range_image_;
+  std::vector<int> hit_box_;
+  std::vector<int> touched_;
+
+  int getStep(double azimuth) const;
+  bool intersect(const PreparedBox& box, const Eigen::Vector3d& direction, double& distance) const;
+};
+
+#endif
@@ -5,6 +5,7 @@
 #define LIDAR_FAKE_PERCEPTION_H
 
 #include <iostream>
+#include <memory>
 #include <vector>
 
 #include <ros/ros.h>
@@ -21,6 +22,8 @@
 #include <pcl_ros/point_cloud.h>
 #include <pcl_ros/transforms.h>
 
+#include "fake_lidar_model.h"
+
 class LidarFakePerception
 {
 public:
@@ -70,19 +73,34 @@ private:
   // param, object meta-info
   double object_intensity_;  // constant intensity value of fake points, 0-255 [-]
   double object_lifetime_;   // fake object lifetime (NOTE: when this is negative value, lifetime is inifinity) [s]
-  double object_points_space_;  // fake points space [m]
   std::string object_label_;    // fake object label (e.g. tracking state)
   std::string object_frame_;    // fake object frame_id (NOTE: not affected to input object)
+  int max_objects_;             // number of fake objects, a new initial pose replaces the oldest one
+
+  // param, sensor model
+  int lidar_beams_;                    // number of beams, evenly spread over the vertical field of view
+  double lidar_min_elevation_;         // elevation of the lowest beam [deg]
+  double lidar_max_elevation_;         // elevation of the highest beam [deg]
+  double lidar_horizontal_resolution_; // azimuth step between two firings [deg]
+  double lidar_max_range_;             // range [m]
+
+  // fake object, pose in global frame
+  struct FakeObject
+  {
+    ros::Time initial_time;
+    tf::Transform pose;
+    autoware_msgs::DetectedObject object;
+  };
 
   // variables
   int fake_object_id_;
-  bool fake_object_pose_initialized_;
-  ros::Time fake_object_initial_time_;
   std::string global_frame_;
   std::string pointcloud_frame_;
-  tf::Transform fake_object_pose_;  // global
+  std::vector<FakeObject> fakes_;
   geometry_msgs::Twist fake_object_twist_;
-  autoware_msgs::DetectedObject fake_object_;
+  std::unique_ptr<FakeLidarModel> lidar_model_;
+  std::vector<FakeLidarModel::Box> fake_boxes_;
+  std::vector<FakeLidarModel::Hit> fake_hits_;
   autoware_msgs::DetectedObjectArray fake_objects_;
   autoware_msgs::DetectedObjectArray real_objects_;
   PointCloudT fake_points_;
@@ -96,10 +114,9 @@ private:
 
   // functions, mainloop
   void updateFakes();
-  bool updateFakeObject();
+  bool updateFakeObjects();
   void updatePose(const double& dt, const geometry_msgs::Twist& twist, tf::Transform& tf);
   void updateFakePoints();
-  void convertObjectToPoints(const autoware_msgs::DetectedObject& obj, PointCloudT& points);
   void publishFakes();
 };
 
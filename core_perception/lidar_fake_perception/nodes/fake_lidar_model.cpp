@@ -0,0 +1,266 @@
+/*
+*/
+
+#include "fake_lidar_model.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+const int AZIMUTH_BINS = 360;
+
+int getAzimuthBin(double azimuth)
+{
+  int bin = static_cast<int>(std::floor((azimuth + M_PI) / (2. * M_PI) * AZIMUTH_BINS));
+  return ((bin % AZIMUTH_BINS) + AZIMUTH_BINS) % AZIMUTH_BINS;
+}
+}  // namespace
+
+FakeLidarModel::FakeLidarModel(const std::vector<double>& vertical_angles, double horizontal_resolution,
+                               double max_range)
+  : vertical_angles_(vertical_angles), horizontal_resolution_(horizontal_resolution), max_range_(max_range)
+{
+  std::sort(vertical_angles_.begin(), vertical_angles_.end());
+  for (const auto& angle : vertical_angles_)
+  {
+    beam_cos_.push_back(std::cos(angle));
+    beam_sin_.push_back(std::sin(angle));
+  }
+
+  steps_ = std::max(1, static_cast<int>(std::round(2. * M_PI / horizontal_resolution_)));
+  horizontal_resolution_ = 2. * M_PI / steps_;
+  for (int i = 0; i < steps_; ++i)
+  {
+    double azimuth = -M_PI + i * horizontal_resolution_;
+    step_cos_.push_back(std::cos(azimuth));
+    step_sin_.push_back(std::sin(azimuth));
+  }
+
+  range_image_.assign(vertical_angles_.size() * steps_, std::numeric_limits<float>::infinity());
+  hit_box_.assign(range_image_.size(), -1);
+  azimuth_bins_.resize(AZIMUTH_BINS);
+}
+
+std::vector<double> FakeLidarModel::uniformVerticalAngles(int beams, double min_angle, double max_angle)
+{
+  std::vector<double> angles;
+  for (int i = 0; i < beams; ++i)
+  {
+    angles.push_back(beams > 1 ? min_angle + (max_angle - min_angle) * i / (beams - 1) : min_angle);
+  }
+  return angles;
+}
+
+int FakeLidarModel::getStep(double azimuth) const
+{
+  int step = static_cast<int>(std::floor((azimuth + M_PI) / horizontal_resolution_));
+  return ((step % steps_) + steps_) % steps_;
+}
+
+void FakeLidarModel::setBoxes(const std::vector<Box>& boxes)
+{
+  boxes_.clear();
+  for (auto& bin : azimuth_bins_)
+  {
+    bin.clear();
+  }
+
+  for (const auto& box : boxes)
+  {
+    PreparedBox prepared;
+    prepared.rotation_inv = box.rotation.transpose();
+    prepared.origin = -prepared.rotation_inv * box.position;
+    prepared.half_size = box.dimensions / 2.;
+    prepared.contains_sensor = (prepared.origin.cwiseAbs().array() <= prepared.half_size.array()).all();
+
+    // bounding cylinder of the corners, giving a conservative sector of azimuth and elevation
+    double radius = 0;
+    double min_z = std::numeric_limits<double>::max();
+    double max_z = -std::numeric_limits<double>::max();
+    const Eigen::Vector3d& center = box.position;
+    for (int i = 0; i < 8; ++i)
+    {
+      Eigen::Vector3d corner(i & 1 ? prepared.half_size.x() : -prepared.half_size.x(),
+                             i & 2 ? prepared.half_size.y() : -prepared.half_size.y(),
+                             i & 4 ? prepared.half_size.z() : -prepared.half_size.z());
+      corner = box.rotation * corner + box.position;
+      radius = std::max(radius, std::hypot(corner.x() - center.x(), corner.y() - center.y()));
+      min_z = std::min(min_z, corner.z());
+      max_z = std::max(max_z, corner.z());
+    }
+
+    double distance = std::hypot(center.x(), center.y());
+    prepared.all_around = distance <= radius;
+    double min_distance = prepared.all_around ? 0 : distance - radius;
+    double max_distance = distance + radius;
+    prepared.max_elevation = std::atan2(max_z, max_z > 0 ? min_distance : max_distance);
+    prepared.min_elevation = std::atan2(min_z, min_z < 0 ? min_distance : max_distance);
+    if (prepared.all_around)
+    {
+      prepared.min_azimuth = -M_PI;
+      prepared.max_azimuth = M_PI;
+    }
+    else
+    {
+      double azimuth = std::atan2(center.y(), center.x());
+      double half_width = std::asin(radius / distance);
+      prepared.min_azimuth = azimuth - half_width;
+      prepared.max_azimuth = azimuth + half_width;
+    }
+
+    int index = static_cast<int>(boxes_.size());
+    boxes_.push_back(prepared);
+    if (prepared.contains_sensor)
+    {
+      continue;
+    }
+    int first_bin = getAzimuthBin(prepared.min_azimuth);
+    int bins = prepared.all_around ?
+                   AZIMUTH_BINS :
+                   static_cast<int>(std::ceil((prepared.max_azimuth - prepared.min_azimuth) / (2. * M_PI) * AZIMUTH_BINS)) + 1;
+    for (int i = 0; i < std::min(bins, AZIMUTH_BINS); ++i)
+    {
+      azimuth_bins_[(first_bin + i) % AZIMUTH_BINS].push_back(index);
+    }
+  }
+}
+
+bool FakeLidarModel::intersect(const PreparedBox& box, const Eigen::Vector3d& direction, double& distance) const
+{
+  // slab test in the box frame, distance to where the ray enters the box
+  Eigen::Vector3d local_direction = box.rotation_inv * direction;
+  double t_enter = 0;
+  double t_exit = std::numeric_limits<double>::max();
+  for (int axis = 0; axis < 3; ++axis)
+  {
+    double origin = box.origin[axis];
+    double half_size = box.half_size[axis];
+    if (std::fabs(local_direction[axis]) < 1e-12)
+    {
+      if (origin < -half_size || origin > half_size)
+      {
+        return false;
+      }
+      continue;
+    }
+    double t0 = (-half_size - origin) / local_direction[axis];
+    double t1 = (half_size - origin) / local_direction[axis];
+    if (t0 > t1)
+    {
+      std::swap(t0, t1);
+    }
+    t_enter = std::max(t_enter, t0);
+    t_exit = std::min(t_exit, t1);
+    if (t_enter > t_exit)
+    {
+      return false;
+    }
+  }
+  distance = t_enter;
+  return true;
+}
+
+void FakeLidarModel::cast(std::vector<Hit>& hits)
+{
+  hits.clear();
+  touched_.clear();
+
+  for (int b = 0; b < static_cast<int>(boxes_.size()); ++b)
+  {
+    const PreparedBox& box = boxes_[b];
+    if (box.contains_sensor)
+    {
+      continue;
+    }
+    auto first_beam = std::lower_bound(vertical_angles_.begin(), vertical_angles_.end(), box.min_elevation);
+    auto last_beam = std::upper_bound(vertical_angles_.begin(), vertical_angles_.end(), box.max_elevation);
+    if (first_beam == last_beam)
+    {
+      continue;
+    }
+
+    int first_step = box.all_around ? 0 : getStep(box.min_azimuth);
+    int steps = box.all_around ?
+                    steps_ :
+                    std::min(steps_, static_cast<int>((box.max_azimuth - box.min_azimuth) / horizontal_resolution_) + 2);
+    for (auto beam_it = first_beam; beam_it != last_beam; ++beam_it)
+    {
+      int beam = static_cast<int>(beam_it - vertical_angles_.begin());
+      for (int i = 0; i < steps; ++i)
+      {
+        int step = (first_step + i) % steps_;
+        Eigen::Vector3d direction(beam_cos_[beam] * step_cos_[step], beam_cos_[beam] * step_sin_[step],
+                                  beam_sin_[beam]);
+        double distance;
+        if (!intersect(box, direction, distance) || distance > max_range_)
+        {
+          continue;
+        }
+
+        int cell = beam * steps_ + step;
+        if (hit_box_[cell] < 0)
+        {
+          touched_.push_back(cell);
+        }
+        else if (distance >= range_image_[cell])
+        {
+          continue;
+        }
+        range_image_[cell] = static_cast<float>(distance);
+        hit_box_[cell] = b;
+      }
+    }
+  }
+
+  // collect the nearest hits and reset the touched beams for the next cast
+  hits.reserve(touched_.size());
+  for (const auto& cell : touched_)
+  {
+    int beam = cell / steps_;
+    int step = cell % steps_;
+    float range = range_image_[cell];
+    Hit hit;
+    hit.point = Eigen::Vector3f(range * beam_cos_[beam] * step_cos_[step], range * beam_cos_[beam] * step_sin_[step],
+                                range * beam_sin_[beam]);
+    hit.box = hit_box_[cell];
+    hits.push_back(hit);
+
+    range_image_[cell] = std::numeric_limits<float>::infinity();
+    hit_box_[cell] = -1;
+  }
+}
+
+bool FakeLidarModel::isOccluded(const Eigen::Vector3f& point) const
+{
+  Eigen::Vector3d target = point.cast<double>();
+  double range = target.norm();
+  if (range <= 0)
+  {
+    return false;
+  }
+
+  const std::vector<int>& bin = azimuth_bins_[getAzimuthBin(std::atan2(target.y(), target.x()))];
+  if (bin.empty())
+  {
+    return false;
+  }
+
+  Eigen::Vector3d direction = target / range;
+  double elevation = std::asin(direction.z());
+  for (const auto& index : bin)
+  {
+    const PreparedBox& box = boxes_[index];
+    if (elevation < box.min_elevation || elevation > box.max_elevation)
+    {
+      continue;
+    }
+    double distance;
+    if (intersect(box, direction, distance) && distance < range)
+    {
+      return true;
+    }
+  }
+  return false;
+}
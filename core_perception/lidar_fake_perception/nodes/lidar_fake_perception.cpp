@@ -3,6 +3,8 @@
 
 #include "lidar_fake_perception.h"
 
+#include <algorithm>
+
 LidarFakePerception::LidarFakePerception() : nh_(), private_nh_("~")
 {
   private_nh_.param<bool>("publish_objects", publish_objects_, true);
@@ -20,10 +22,16 @@ LidarFakePerception::LidarFakePerception() : nh_(), private_nh_("~")
 
   private_nh_.param<double>("object_intensity", object_intensity_, 100.0);
   private_nh_.param<double>("object_lifetime", object_lifetime_, -1);
-  private_nh_.param<double>("object_points_space", object_points_space_, 0.2);
 
   private_nh_.param<std::string>("object_label", object_label_, "Stable");
   private_nh_.param<std::string>("object_frame", object_frame_, "velodyne");
+  private_nh_.param<int>("max_objects", max_objects_, 1);
+
+  private_nh_.param<int>("lidar_beams", lidar_beams_, 32);
+  private_nh_.param<double>("lidar_min_elevation", lidar_min_elevation_, -30.67);
+  private_nh_.param<double>("lidar_max_elevation", lidar_max_elevation_, 10.67);
+  private_nh_.param<double>("lidar_horizontal_resolution", lidar_horizontal_resolution_, 0.2);
+  private_nh_.param<double>("lidar_max_range", lidar_max_range_, 100.0);
 
   object_initial_pose_sub_ =
       nh_.subscribe("/move_base_simple/goal", 1, &LidarFakePerception::objectInitialPoseCallback, this);
@@ -38,7 +46,10 @@ LidarFakePerception::LidarFakePerception() : nh_(), private_nh_("~")
   global_frame_ = "world";  // overwritten by object initial pose
   pointcloud_frame_ = "velodyne"; // overwritten by pointcloud data
 
-  fake_object_pose_initialized_ = false;
+  lidar_model_.reset(new FakeLidarModel(
+      FakeLidarModel::uniformVerticalAngles(lidar_beams_, lidar_min_elevation_ * M_PI / 180.,
+                                            lidar_max_elevation_ * M_PI / 180.),
+      lidar_horizontal_resolution_ * M_PI / 180., lidar_max_range_));
 }
 
 LidarFakePerception::~LidarFakePerception()
@@ -61,11 +72,16 @@ void LidarFakePerception::run()
 void LidarFakePerception::objectInitialPoseCallback(const geometry_msgs::PoseStampedConstPtr& msg)
 {
   global_frame_ = msg->header.frame_id;
-  fake_object_initial_time_ = msg->header.stamp;
 
-  tf::poseMsgToTF(msg->pose, fake_object_pose_);
-
-  fake_object_pose_initialized_ = true;
+  // add a fake object, replacing the oldest one when all are in use
+  FakeObject fake;
+  fake.initial_time = msg->header.stamp;
+  tf::poseMsgToTF(msg->pose, fake.pose);
+  fakes_.push_back(fake);
+  if (static_cast<int>(fakes_.size()) > std::max(1, max_objects_))
+  {
+    fakes_.erase(fakes_.begin());
+  }
 }
 
 void LidarFakePerception::objectsCallback(const autoware_msgs::DetectedObjectArray& msg)
@@ -97,39 +113,55 @@ void LidarFakePerception::updateFakes()
     fake_object_id_ = (real_objects_.objects.end() - 1)->id + 1;  // using incremented id
   }
 
-  if (real_points_.size() != 0)
-  {
-    fake_points_.resize(real_points_.size());
-    std::copy(real_points_.begin(), real_points_.end(), fake_points_.begin());
-  }
-
-  if (fake_object_pose_initialized_)
+  if (updateFakeObjects())
   {
-    if (updateFakeObject())
+    updateFakePoints();
+    for (const auto& fake : fakes_)
     {
-      updateFakePoints();
-      fake_objects_.objects.push_back(fake_object_);
+      fake_objects_.objects.push_back(fake.object);
     }
   }
+  else if (real_points_.size() != 0)
+  {
+    fake_points_ = real_points_;
+  }
 }
 
-bool LidarFakePerception::updateFakeObject()
+bool LidarFakePerception::updateFakeObjects()
 {
+  fake_boxes_.clear();
+
   // check lifetime
   if (object_lifetime_ > 0)
   {
-    if ((ros::Time::now() - fake_object_initial_time_).toSec() > object_lifetime_)
-    {
-      return false;
-    }
+    ros::Time now = ros::Time::now();
+    fakes_.erase(std::remove_if(fakes_.begin(), fakes_.end(),
+                                [&](const FakeObject& fake) {
+                                  return (now - fake.initial_time).toSec() > object_lifetime_;
+                                }),
+                 fakes_.end());
+  }
+  if (fakes_.empty())
+  {
+    return false;
   }
 
-  // obtain world -> sensor frame
+  // obtain world -> object frame, and object frame -> sensor frame
   tf::StampedTransform global2local;
+  tf::StampedTransform local2sensor;
   try
   {
     tf_listener_.waitForTransform(global_frame_, object_frame_, ros::Time(0), ros::Duration(1.0));
     tf_listener_.lookupTransform(global_frame_, object_frame_, ros::Time(0), global2local);
+    if (pointcloud_frame_ != object_frame_)
+    {
+      tf_listener_.waitForTransform(pointcloud_frame_, object_frame_, ros::Time(0), ros::Duration(1.0));
+      tf_listener_.lookupTransform(pointcloud_frame_, object_frame_, ros::Time(0), local2sensor);
+    }
+    else
+    {
+      local2sensor.setIdentity();
+    }
   }
   catch (tf::TransformException ex)
   {
@@ -150,23 +182,38 @@ bool LidarFakePerception::updateFakeObject()
     twist.linear.x = object_velocity_;
     twist.angular.z = object_angular_velocity_;
   }
-  updatePose(1. / publish_rate_, twist, fake_object_pose_);
 
-  // fix height
-  tf::Vector3 objpos = fake_object_pose_.getOrigin();
-  fake_object_pose_.setOrigin(tf::Vector3(objpos.x(), objpos.y(), object_z_offset_ + object_height_ / 2.));
-
-  // update msg
-  fake_object_.header.stamp = ros::Time::now();
-  fake_object_.header.frame_id = object_frame_;
-  fake_object_.id = fake_object_id_;
-  fake_object_.label = object_label_;
-  fake_object_.dimensions.x = object_length_;
-  fake_object_.dimensions.y = object_width_;
-  fake_object_.dimensions.z = object_height_;
-  fake_object_.velocity = twist;
-  fake_object_.acceleration = geometry_msgs::Twist();                              // NOTE: by constant velocity model
-  tf::poseTFToMsg(global2local.inverse() * fake_object_pose_, fake_object_.pose);  // local
+  for (size_t i = 0; i < fakes_.size(); ++i)
+  {
+    FakeObject& fake = fakes_[i];
+    updatePose(1. / publish_rate_, twist, fake.pose);
+
+    // fix height
+    tf::Vector3 objpos = fake.pose.getOrigin();
+    fake.pose.setOrigin(tf::Vector3(objpos.x(), objpos.y(), object_z_offset_ + object_height_ / 2.));
+
+    // update msg
+    autoware_msgs::DetectedObject& object = fake.object;
+    object.header.stamp = ros::Time::now();
+    object.header.frame_id = object_frame_;
+    object.id = fake_object_id_ + i;
+    object.label = object_label_;
+    object.dimensions.x = object_length_;
+    object.dimensions.y = object_width_;
+    object.dimensions.z = object_height_;
+    object.velocity = twist;
+    object.acceleration = geometry_msgs::Twist();                        // NOTE: by constant velocity model
+    tf::Transform local_pose = global2local.inverse() * fake.pose;
+    tf::poseTFToMsg(local_pose, object.pose);                            // local
+
+    // box seen by the sensor
+    tf::Transform sensor_pose = local2sensor * local_pose;
+    FakeLidarModel::Box box;
+    tf::vectorTFToEigen(sensor_pose.getOrigin(), box.position);
+    tf::matrixTFToEigen(sensor_pose.getBasis(), box.rotation);
+    box.dimensions = Eigen::Vector3d(object_length_, object_width_, object_height_);
+    fake_boxes_.push_back(box);
+  }
 
   return true;
 }
@@ -179,47 +226,46 @@ void LidarFakePerception::updatePose(const double& dt, const geometry_msgs::Twis
   dpose.setOrigin(tf::Vector3(twist.linear.x * dt, twist.linear.y * dt, twist.linear.z * dt));
   dquat.setRPY(twist.angular.x * dt, twist.angular.y * dt, twist.angular.z * dt);
   dpose.setRotation(dquat);
-  fake_object_pose_ *= dpose;  // transform
+  tf *= dpose;  // transform
 }
 
 void LidarFakePerception::updateFakePoints()
 {
-  PointCloudT points;
-  convertObjectToPoints(fake_object_, points);
-  fake_points_ += points;
-  fake_points_.header = pcl_conversions::toPCL(fake_object_.header);
-  pcl::toROSMsg(fake_points_, fake_object_.pointcloud);
-}
-
-void LidarFakePerception::convertObjectToPoints(const autoware_msgs::DetectedObject& obj, PointCloudT& points)
-{
-  points.clear();
+  // beams of the sensor cast against the fake objects, the nearest return of each beam
+  lidar_model_->setBoxes(fake_boxes_);
+  lidar_model_->cast(fake_hits_);
 
-  double hl = object_length_ / 2.0;
-  double hw = object_width_ / 2.0;
-  double hh = object_height_ / 2.0;
-
-  for (double x = -hl; x <= hl; x += object_points_space_)
+  // real points behind the fake objects are hidden by them
+  fake_points_.reserve(real_points_.size() + fake_hits_.size());
+  for (const auto& point : real_points_)
   {
-    for (double y = -hw; y <= hw; y += object_points_space_)
+    if (!lidar_model_->isOccluded(point.getVector3fMap()))
     {
-      for (double z = -hh; z <= hh; z += object_points_space_)
-      {
-        PointT point;
-        point.x = x;
-        point.y = y;
-        point.z = z;
-        point.intensity = object_intensity_;
-        points.push_back(point);
-      }
+      fake_points_.push_back(point);
     }
   }
 
-  tf::Transform trans_tf;
-  Eigen::Affine3d trans_eigen;
-  tf::poseMsgToTF(obj.pose, trans_tf);
-  tf::poseTFToEigen(trans_tf, trans_eigen);
-  pcl::transformPointCloud(points, points, trans_eigen);
+  std::vector<PointCloudT> object_points(fakes_.size());
+  for (const auto& hit : fake_hits_)
+  {
+    PointT point;
+    point.x = hit.point.x();
+    point.y = hit.point.y();
+    point.z = hit.point.z();
+    point.intensity = object_intensity_;
+    fake_points_.push_back(point);
+    object_points[hit.box].push_back(point);
+  }
+
+  std_msgs::Header header;
+  header.stamp = ros::Time::now();
+  header.frame_id = pointcloud_frame_;
+  fake_points_.header = pcl_conversions::toPCL(header);
+  for (size_t i = 0; i < fakes_.size(); ++i)
+  {
+    object_points[i].header = fake_points_.header;
+    pcl::toROSMsg(object_points[i], fakes_[i].object.pointcloud);
+  }
 }
 
 void LidarFakePerception::publishFakes()
@@ -230,10 +276,10 @@ void LidarFakePerception::publishFakes()
     fake_objects_.header.stamp = ros::Time::now();
   }
 
-  if (fake_points_.size() != 0)  // publish empty
+  if (fake_points_.size() == 0)  // publish empty
   {
     fake_points_.header.frame_id = pointcloud_frame_;
-    fake_points_.header = pcl_conversions::toPCL(fake_object_.header);
+    pcl_conversions::toPCL(ros::Time::now(), fake_points_.header.stamp);
   }
 
   if (publish_objects_)
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+#include <Eigen/Geometry>
+
+#include "fake_lidar_model.h"
+
+namespace
+{
+double deg2rad(double deg)
+{
+  return deg * M_PI / 180.;
+}
+
+FakeLidarModel::Box createBox(double x, double y, double yaw)
+{
+  FakeLidarModel::Box box;
+  box.position = Eigen::Vector3d(x, y, -1.0);  // sensor 1.9m above the ground
+  box.rotation = Eigen::AngleAxisd(yaw, Eigen::Vector3d::UnitZ()).toRotationMatrix();
+  box.dimensions = Eigen::Vector3d(4.8, 1.8, 1.8);
+  return box;
+}
+
+// distance from the point to the box surface, negative inside
+double signedDistance(const FakeLidarModel::Box& box, const Eigen::Vector3f& point)
+{
+  Eigen::Vector3d local = box.rotation.transpose() * (point.cast<double>() - box.position);
+  Eigen::Vector3d d = local.cwiseAbs() - box.dimensions / 2.;
+  double outside = d.cwiseMax(0.).norm();
+  double inside = std::min(d.maxCoeff(), 0.);
+  return outside + inside;
+}
+
+FakeLidarModel createModel(int beams)
+{
+  // HDL-64E and VLS-128 like vertical fields of view
+  std::vector<double> angles = beams > 64 ?
+                                   FakeLidarModel::uniformVerticalAngles(beams, deg2rad(-25.), deg2rad(15.)) :
+                                   FakeLidarModel::uniformVerticalAngles(beams, deg2rad(-24.9), deg2rad(2.));
+  return FakeLidarModel(angles, deg2rad(0.2), 120.);
+}
+}  // namespace
+
+TEST(TestFakeLidarModel, pointsOnTheVisibleSurface)
+{
+  FakeLidarModel model = createModel(64);
+  FakeLidarModel::Box box = createBox(10., 2., 0.3);
+  model.setBoxes({ box });
+
+  std::vector<FakeLidarModel::Hit> hits;
+  model.cast(hits);
+  ASSERT_GT(hits.size(), 100u);
+  for (const auto& hit : hits)
+  {
+    EXPECT_EQ(0, hit.box);
+    EXPECT_NEAR(0., signedDistance(box, hit.point), 1e-3);
+    // first surface along the beam, the sensor side of the box
+    EXPECT_FALSE(model.isOccluded(hit.point * 0.999f));
+  }
+
+  // the buffers are reset between casts
+  std::vector<FakeLidarModel::Hit> again;
+  model.cast(again);
+  EXPECT_EQ(hits.size(), again.size());
+
+  // sensor inside the box, no return
+  box = createBox(0., 0., 0.);
+  box.position.z() = 0.;
+  model.setBoxes({ box });
+  model.cast(hits);
+  EXPECT_TRUE(hits.empty());
+}
+
+TEST(TestFakeLidarModel, nearBoxOccludesFarBox)
+{
+  FakeLidarModel model = createModel(64);
+  std::vector<FakeLidarModel::Box> boxes = { createBox(20., 0., 0.), createBox(10., 0., 0.) };
+
+  std::vector<FakeLidarModel::Hit> hits;
+  model.setBoxes({ boxes[0] });
+  model.cast(hits);
+  size_t far_alone = hits.size();
+
+  model.setBoxes(boxes);
+  model.cast(hits);
+  size_t far_behind = 0;
+  for (const auto& hit : hits)
+  {
+    EXPECT_NEAR(0., signedDistance(boxes[hit.box], hit.point), 1e-3);
+    if (hit.box == 0)
+    {
+      far_behind++;
+      // nothing of the near box on the way
+      EXPECT_GT(signedDistance(boxes[1], hit.point), 0.);
+    }
+  }
+  EXPECT_LT(far_behind, far_alone / 2);
+
+  // real points
+  EXPECT_TRUE(model.isOccluded(Eigen::Vector3f(30., 0., -1.)));
+  EXPECT_TRUE(model.isOccluded(Eigen::Vector3f(10., 0., -1.)));  // inside
+  EXPECT_FALSE(model.isOccluded(Eigen::Vector3f(5., 0., -1.)));
+  EXPECT_FALSE(model.isOccluded(Eigen::Vector3f(15., 5., -1.)));
+  EXPECT_FALSE(model.isOccluded(Eigen::Vector3f(30., 0., 3.)));
+}
+
+TEST(TestFakeLidarModel, sectorAcrossAzimuthWrap)
+{
+  FakeLidarModel model = createModel(64);
+  std::vector<FakeLidarModel::Hit> front, back;
+  model.setBoxes({ createBox(10., 0., 0.) });
+  model.cast(front);
+  model.setBoxes({ createBox(-10., 0., 0.) });
+  model.cast(back);
+  EXPECT_GT(back.size(), 100u);
+  EXPECT_NEAR(static_cast<double>(front.size()), static_cast<double>(back.size()), 0.02 * front.size());
+  EXPECT_TRUE(model.isOccluded(Eigen::Vector3f(-20., 0.01, -1.)));
+  EXPECT_TRUE(model.isOccluded(Eigen::Vector3f(-20., -0.01, -1.)));
+}
+
+TEST(TestFakeLidarModel, benchmark)
+{
+  for (int beams : { 64, 128 })
+  {
+    FakeLidarModel model = createModel(beams);
+
+    // real cloud, ground returns of every beam below the horizon
+    std::vector<Eigen::Vector3f> real_points;
+    for (int b = 0; b < beams; ++b)
+    {
+      double elevation = beams > 64 ? deg2rad(-25. + 40. * b / (beams - 1)) : deg2rad(-24.9 + 26.9 * b / (beams - 1));
+      double range = elevation < -0.01 ? std::min(120., 1.9 / std::tan(-elevation)) : 120.;
+      for (int s = 0; s < model.getStepCount(); ++s)
+      {
+        double azimuth = -M_PI + 2. * M_PI * s / model.getStepCount();
+        real_points.emplace_back(range * std::cos(azimuth), range * std::sin(azimuth), range * std::tan(elevation));
+      }
+    }
+
+    for (int n_objects : { 10, 30, 60 })
+    {
+      std::mt19937 gen(n_objects);
+      std::uniform_real_distribution<double> position(-60., 60.);
+      std::uniform_real_distribution<double> yaw(-M_PI, M_PI);
+      std::vector<FakeLidarModel::Box> boxes;
+      while (static_cast<int>(boxes.size()) < n_objects)
+      {
+        double x = position(gen), y = position(gen);
+        if (std::hypot(x, y) > 5.)
+        {
+          boxes.push_back(createBox(x, y, yaw(gen)));
+        }
+      }
+
+      const int cycles = 20;
+      std::vector<FakeLidarModel::Hit> hits;
+      size_t kept = 0;
+      auto start = std::chrono::steady_clock::now();
+      for (int i = 0; i < cycles; ++i)
+      {
+        model.setBoxes(boxes);
+        model.cast(hits);
+        kept = 0;
+        for (const auto& point : real_points)
+        {
+          kept += model.isOccluded(point) ? 0 : 1;
+        }
+      }
+      double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / cycles;
+
+      EXPECT_LE(hits.size(), static_cast<size_t>(beams * model.getStepCount()));
+      EXPECT_LT(kept, real_points.size());
+      // previous dense volume at 0.05m
+      size_t dense = static_cast<size_t>(n_objects * (4.8 / 0.05 + 1) * (1.8 / 0.05 + 1) * (1.8 / 0.05 + 1));
+      printf("[ %3d beams, %2d objects ] %6.2f ms/cycle, %6zu fake points (dense volume: %zu), %zu of %zu real points "
+             "kept\n",
+             beams, n_objects, ms, hits.size(), dense, kept, real_points.size());
+    }
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
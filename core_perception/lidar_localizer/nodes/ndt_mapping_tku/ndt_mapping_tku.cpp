@@ -4,7 +4,7 @@
   2005/4/24 tku
 */
 
-// number of cells
+// default number of cells
 #define G_MAP_X 2000
 #define G_MAP_Y 2000
 #define G_MAP_Z 200
@@ -17,8 +17,10 @@
 #include <GL/glut.h>
 #include <math.h>
 #include <stdio.h>
+#include <algorithm>
 #include <chrono>
 #include <string>
+#include <vector>
 #include "algebra.h"
 #include "ndt.h"
 
@@ -408,10 +410,9 @@ void points_callback(const sensor_msgs::PointCloud2::ConstPtr &msg)
 
 void save_nd_map(char *name)
 {
-  int i, j, k, layer;
+  int i, layer;
   NDData nddat;
   NDMapPtr ndmap;
-  NDPtr *ndp;
   FILE *ofp;
 
   pcl::PointCloud<pcl::PointXYZ> cloud;
@@ -420,35 +421,35 @@ void save_nd_map(char *name)
   ndmap = NDmap;
   ofp = fopen(name, "w");
 
-  for (layer = 0; layer < 2; layer++)
+  for (layer = 0; layer < 2 && ndmap; layer++)
   {
-    ndp = ndmap->nd;
-    for (i = 0; i < ndmap->x; i++)
+    // cells in the order of their index
+    std::vector<std::pair<long long, NDPtr> > cells;
+    cells.reserve(ndmap->num);
+    for (i = 0; i < ndmap->capacity; i++)
     {
-      for (j = 0; j < ndmap->y; j++)
-      {
-        for (k = 0; k < ndmap->z; k++)
-        {
-          if (*ndp)
-          {
-            update_covariance(*ndp);
-            nddat.nd = **ndp;
-            nddat.x = i;
-            nddat.y = j;
-            nddat.z = k;
-            nddat.layer = layer;
-
-            fwrite(&nddat, sizeof(NDData), 1, ofp);
-
-            // regist the point to pcd data;
-            p.x = (*ndp)->mean.x;
-            p.y = (*ndp)->mean.y;
-            p.z = (*ndp)->mean.z;
-            cloud.points.push_back(p);
-          }
-          ndp++;
-        }
-      }
+      if (ndmap->nd[i])
+        cells.push_back(std::make_pair(ndmap->key[i], ndmap->nd[i]));
+    }
+    std::sort(cells.begin(), cells.end());
+
+    for (i = 0; i < (int)cells.size(); i++)
+    {
+      NDPtr nd = cells[i].second;
+      update_covariance(nd);
+      nddat.nd = *nd;
+      nddat.x = cells[i].first / ndmap->to_x;
+      nddat.y = (cells[i].first % ndmap->to_x) / ndmap->to_y;
+      nddat.z = cells[i].first % ndmap->to_y;
+      nddat.layer = layer;
+
+      fwrite(&nddat, sizeof(NDData), 1, ofp);
+
+      // regist the point to pcd data;
+      p.x = nd->mean.x;
+      p.y = nd->mean.y;
+      p.z = nd->mean.z;
+      cloud.points.push_back(p);
     }
     ndmap = ndmap->next;
   }
@@ -529,11 +530,12 @@ int main(int argc, char *argv[])
   // map path
   sprintf(g_ndmap_name, "%s", "ndmap");
 
-  // map size
-  g_map_x = G_MAP_X;
-  g_map_y = G_MAP_Y;
-  g_map_z = G_MAP_Z;
-  g_map_cellsize = G_MAP_CELLSIZE;
+  // map size, the map only stores occupied cells so a large extent costs no memory
+  private_nh.param("map_x", g_map_x, G_MAP_X);
+  private_nh.param("map_y", g_map_y, G_MAP_Y);
+  private_nh.param("map_z", g_map_z, G_MAP_Z);
+  private_nh.param("map_cellsize", g_map_cellsize, G_MAP_CELLSIZE);
+  private_nh.param("map_layer_num", g_map_layer_num, LAYER_NUM);
   // map center
   g_map_center_x = g_ini_x;
   g_map_center_y = g_ini_y;
@@ -4,7 +4,7 @@
  * ndt_matching for ROS
  */
 
-// number of cells
+// default number of cells
 #define G_MAP_X 2000
 #define G_MAP_Y 2000
 #define G_MAP_Z 200
@@ -503,11 +503,12 @@ int main(int argc, char *argv[])
   // map path
   sprintf(g_ndmap_name, "%s", "ndmap");
 
-  // map size
-  g_map_x = G_MAP_X;
-  g_map_y = G_MAP_Y;
-  g_map_z = G_MAP_Z;
-  g_map_cellsize = G_MAP_CELLSIZE;
+  // map size, the map only stores occupied cells so a large extent costs no memory
+  private_nh.param("map_x", g_map_x, G_MAP_X);
+  private_nh.param("map_y", g_map_y, G_MAP_Y);
+  private_nh.param("map_z", g_map_z, G_MAP_Z);
+  private_nh.param("map_cellsize", g_map_cellsize, G_MAP_CELLSIZE);
+  private_nh.param("map_layer_num", g_map_layer_num, LAYER_NUM);
   // map center
   g_map_center_x = g_ini_x;
   g_map_center_y = g_ini_y;
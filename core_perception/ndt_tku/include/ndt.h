@@ -20,79 +20,15 @@
 #define __NDT_TKU__
 
 #include <GL/glut.h>
-/*root cell size*/
-/*
-  #define MAP_CELLSIZE 0.2 //m
-
-  #define MAP_X 128
-  #define MAP_Y 80
-  #define MAP_Z 48
-*/
+#include <stddef.h>
 
-//#define MAP_CELLSIZE 1.0 //m
+/*
+ * The ND map is sparse: each layer keeps a hash table of the occupied cells, so the map extent and cell size are
+ * set at runtime (g_map_x, g_map_y, g_map_z, g_map_cellsize, g_map_layer_num) and memory scales with the number of
+ * occupied cells instead of the extent.
+ */
 #define MAX_ND_NUM (20000000)
-
-// map origin//
-// meidai_map
-#if 0
-#define MAP_CENTER_X (-18407.4 + 215)
-#define MAP_CENTER_Y (-93444.9 - 400)
-#define MAP_CENTER_Z 33
-#define MAP_ROTATION 0.0
-//map size
-#define MAP_X 1600
-#define MAP_Y 1600
-#define MAP_Z 200
-#endif
-
-// meidai_map_all
-#if 0
-#define MAP_CENTER_X (-18500)
-#define MAP_CENTER_Y (-93800)
-#define MAP_CENTER_Z 33
-#define MAP_ROTATION 0.0
-//map size
-#define MAP_X 2200
-#define MAP_Y 2600
-#define MAP_Z 200
-
-#endif
-
-// moriyama_map
-#if 0
-#define MAP_CENTER_X -15741
-#define MAP_CENTER_Y -85697
-#define MAP_CENTER_Z 70
-#define MAP_ROTATION 0.7
-//map size
-#define MAP_X 1600
-#define MAP_Y 1600
-#define MAP_Z 200
-#endif
-
-// tctslc map
-#if 0
-#define MAP_CENTER_X 3702
-#define MAP_CENTER_Y -99430
-#define MAP_CENTER_Z 85
-#define MAP_ROTATION 0
-//map size
-#define MAP_X 1600
-#define MAP_Y 1600
-#define MAP_Z 200
-#endif
-
-#if 0
-//map offset
-#define MAP_CENTER_X 0
-#define MAP_CENTER_Y 0
-#define MAP_CENTER_Z 0
-#define MAP_ROTATION 0
-//map size
-#define MAP_X 1600
-#define MAP_Y 1600
-#define MAP_Z 200
-#endif
+#define ND_BLOCK_SIZE (1 << 16) /*NDs are allocated in blocks of this size*/
 
 // initial position
 // meidai IB (141117_run01,run02)
@@ -168,7 +104,7 @@
 // x=-14763
 // y=-84780
 // q=-2.34
-#define LAYER_NUM 2  // 0.2 0.4 0.8 1.6 3.2(128*80*48)
+#define LAYER_NUM 2  // default number of layers, each doubles the cell size
 
 #define ND_MIN 40
 
@@ -241,13 +177,17 @@ typedef struct nd_map *NDMapPtr;
 
 typedef struct nd_map
 {
+  /*hash table of the occupied cells, key is the cell index x * to_x + y * to_y + z, empty slots have nd == 0*/
   NDPtr *nd;
+  long long *key;
+  int capacity; /*power of 2*/
+  int num;      /*occupied cells*/
   int layer;
   int x;
   int y;
   int z;
-  int to_x;
-  int to_y;
+  long long to_x;
+  long long to_y;
   double size;
   char name[30];
 
@@ -269,6 +209,10 @@ int add_point_covariance(NDPtr nd, PointPtr p);
 int update_covariance(NDPtr nd);
 int add_point_map(NDMapPtr ndmap, PointPtr point);
 int get_ND(NDMapPtr ndmap, PointPtr point, NDPtr *nd, int mode);
+NDPtr get_root_ND(NDMapPtr ndmap, PointPtr point, int mode);
+NDPtr find_ND(NDMapPtr ndmap, long long key);
+void update_covariances(void);
+size_t NDmap_memory_size(NDMapPtr ndmap);
 
 NDMapPtr initialize_NDmap(void);
 NDMapPtr initialize_NDmap_layer(int layer, NDMapPtr parent);
@@ -294,7 +238,8 @@ NDPtr add_ND(void);
 double calc_summand2d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H[3][3]);
 int adjust2d(PointPtr scan, int num, PosturePtr initial);
 
-double calc_summand3d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H[6][6], double qd3[6][3], double dist);
+double calc_summand3d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H[6][6], double qd3[6][3],
+                      double qdd3[6][6][3], double dist);
 double adjust3d(PointPtr scan, int num, PosturePtr initial, int target);
 void set_sincos2(double a, double b, double g, double sc[3][3]);
 void scan_transrate(PointPtr src, PointPtr dst, PosturePtr pose, int num);
@@ -302,4 +247,5 @@ void scan_transrate(PointPtr src, PointPtr dst, PosturePtr pose, int num);
 // values
 extern int g_map_x, g_map_y, g_map_z;
 extern double g_map_cellsize;
+extern int g_map_layer_num;
 #endif
@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <vector>
 #include "algebra.h"
 #include "ndt.h"
 
@@ -12,12 +13,20 @@ int NDs_num;
 
 int g_map_x, g_map_y, g_map_z;
 double g_map_cellsize;
+int g_map_layer_num = LAYER_NUM;
+
+/*blocks of NDs, NDs is the first one*/
+static std::vector<NDPtr> nd_blocks;
+/*NDs whose covariance has to be updated*/
+static std::vector<NDPtr> nd_updates;
 
 /*add point to ndcell */
 int add_point_covariance(NDPtr nd, PointPtr p)
 {
   /*add data num*/
   nd->num++;
+  if (nd->flag)
+    nd_updates.push_back(nd);
   nd->flag = 0; /*need to update*/
 
   /*calcurate means*/
@@ -83,11 +92,81 @@ int update_covariance(NDPtr nd)
   return 1;
 }
 
+/*slot of a cell index in the hash table*/
+static inline int hash_slot(NDMapPtr ndmap, long long key)
+{
+  return (int)(((unsigned long long)key * 0x9E3779B97F4A7C15ULL) >> 32) & (ndmap->capacity - 1);
+}
+
+static void resize_NDmap(NDMapPtr ndmap, int capacity)
+{
+  NDPtr *nd = ndmap->nd;
+  long long *key = ndmap->key;
+  int old_capacity = ndmap->capacity;
+
+  ndmap->nd = (NDPtr *)calloc(capacity, sizeof(NDPtr));
+  ndmap->key = (long long *)malloc(capacity * sizeof(long long));
+  ndmap->capacity = capacity;
+
+  for (int i = 0; i < old_capacity; i++)
+  {
+    if (nd[i])
+    {
+      int slot = hash_slot(ndmap, key[i]);
+      while (ndmap->nd[slot])
+        slot = (slot + 1) & (capacity - 1);
+      ndmap->nd[slot] = nd[i];
+      ndmap->key[slot] = key[i];
+    }
+  }
+  free(nd);
+  free(key);
+}
+
+/*get nd cell by cell index, 0 if the cell is empty*/
+NDPtr find_ND(NDMapPtr ndmap, long long key)
+{
+  int slot = hash_slot(ndmap, key);
+  while (ndmap->nd[slot])
+  {
+    if (ndmap->key[slot] == key)
+      return ndmap->nd[slot];
+    slot = (slot + 1) & (ndmap->capacity - 1);
+  }
+  return 0;
+}
+
+/*get nd cell by cell index, a new cell is added if the cell is empty*/
+static NDPtr find_or_add_ND(NDMapPtr ndmap, long long key)
+{
+  int slot = hash_slot(ndmap, key);
+  while (ndmap->nd[slot])
+  {
+    if (ndmap->key[slot] == key)
+      return ndmap->nd[slot];
+    slot = (slot + 1) & (ndmap->capacity - 1);
+  }
+
+  NDPtr nd = add_ND();
+  if (nd == 0)
+    return 0;
+
+  ndmap->nd[slot] = nd;
+  ndmap->key[slot] = key;
+  ndmap->num++;
+
+  /*keep the load factor under 1/2*/
+  if (ndmap->num * 2 > ndmap->capacity)
+    resize_NDmap(ndmap, ndmap->capacity * 2);
+
+  return nd;
+}
+
 /*add point to ndmap*/
 int add_point_map(NDMapPtr ndmap, PointPtr point)
 {
   double x, y, z;
-  NDPtr *ndp[8];
+  long long key[8];
 
   /*mapping*/
   x = (point->x / ndmap->size) + ndmap->x / 2;
@@ -103,22 +182,21 @@ int add_point_map(NDMapPtr ndmap, PointPtr point)
     return 0;
 
   /*select root ND*/
-  ndp[0] = ndmap->nd + (int)x * ndmap->to_x + (int)y * ndmap->to_y + (int)z;
-  ndp[1] = ndp[0] - ndmap->to_x;
-  ndp[2] = ndp[0] - ndmap->to_y;
-  ndp[4] = ndp[0] - 1;
-  ndp[3] = ndp[2] - ndmap->to_x;
-  ndp[5] = ndp[4] - ndmap->to_x;
-  ndp[6] = ndp[4] - ndmap->to_y;
-  ndp[7] = ndp[3] - 1;
+  key[0] = (int)x * ndmap->to_x + (int)y * ndmap->to_y + (int)z;
+  key[1] = key[0] - ndmap->to_x;
+  key[2] = key[0] - ndmap->to_y;
+  key[4] = key[0] - 1;
+  key[3] = key[2] - ndmap->to_x;
+  key[5] = key[4] - ndmap->to_x;
+  key[6] = key[4] - ndmap->to_y;
+  key[7] = key[3] - 1;
 
   /*add  point to map */
   for (int i = 0; i < 8; i++)
   {
-    if ((*ndp[i]) == 0)
-      *ndp[i] = add_ND();
-    if ((*ndp[i]) != 0)
-      add_point_covariance(*ndp[i], point);
+    NDPtr nd = find_or_add_ND(ndmap, key[i]);
+    if (nd != 0)
+      add_point_covariance(nd, point);
   }
 
   if (ndmap->next)
@@ -129,12 +207,10 @@ int add_point_map(NDMapPtr ndmap, PointPtr point)
   return 0;
 }
 
-/*get nd cell at point*/
-int get_ND(NDMapPtr ndmap, PointPtr point, NDPtr *nd, int ndmode)
+/*cell index of a point, false if out of the map*/
+static inline int point_to_key(NDMapPtr ndmap, PointPtr point, int ndmode, long long *key)
 {
   double x, y, z;
-  int i;
-  NDPtr *ndp[8];
 
   /*mapping*/
   if (ndmode < 3)
@@ -158,23 +234,36 @@ int get_ND(NDMapPtr ndmap, PointPtr point, NDPtr *nd, int ndmode)
   if (z < 1 || z >= ndmap->z)
     return 0;
 
+  *key = (int)x * ndmap->to_x + (int)y * ndmap->to_y + (int)z;
+  return 1;
+}
+
+/*get nd cell at point*/
+int get_ND(NDMapPtr ndmap, PointPtr point, NDPtr *nd, int ndmode)
+{
+  int i;
+  long long key[8];
+
+  if (!point_to_key(ndmap, point, ndmode, &key[0]))
+    return 0;
+
   /*select root ND*/
-  ndp[0] = ndmap->nd + (int)x * ndmap->to_x + (int)y * ndmap->to_y + (int)z;
-  ndp[1] = ndp[0] - ndmap->to_x;
-  ndp[2] = ndp[0] - ndmap->to_y;
-  ndp[4] = ndp[0] - 1;
-  ndp[3] = ndp[2] - ndmap->to_x;
-  ndp[5] = ndp[4] - ndmap->to_x;
-  ndp[6] = ndp[4] - ndmap->to_y;
-  ndp[7] = ndp[3] - 1;
+  key[1] = key[0] - ndmap->to_x;
+  key[2] = key[0] - ndmap->to_y;
+  key[4] = key[0] - 1;
+  key[3] = key[2] - ndmap->to_x;
+  key[5] = key[4] - ndmap->to_x;
+  key[6] = key[4] - ndmap->to_y;
+  key[7] = key[3] - 1;
 
   for (i = 0; i < 8; i++)
   {
-    if (*ndp[i] != 0)
+    NDPtr ndp = find_ND(ndmap, key[i]);
+    if (ndp != 0)
     {
-      if (!(*ndp[i])->flag)
-        update_covariance(*ndp[i]);
-      nd[i] = *ndp[i];
+      if (!ndp->flag)
+        update_covariance(ndp);
+      nd[i] = ndp;
     }
     else
     {
@@ -186,6 +275,29 @@ int get_ND(NDMapPtr ndmap, PointPtr point, NDPtr *nd, int ndmode)
   return 1;
 }
 
+/*get the root nd cell at point (nd[0] of get_ND) without updating it, see update_covariances*/
+NDPtr get_root_ND(NDMapPtr ndmap, PointPtr point, int ndmode)
+{
+  long long key;
+
+  if (!point_to_key(ndmap, point, ndmode, &key))
+    return 0;
+
+  NDPtr ndp = find_ND(ndmap, key);
+  return ndp ? ndp : NDs;
+}
+
+/*update the covariances of all NDs changed since the last call*/
+void update_covariances(void)
+{
+  for (size_t i = 0; i < nd_updates.size(); i++)
+  {
+    if (!nd_updates[i]->flag)
+      update_covariance(nd_updates[i]);
+  }
+  nd_updates.clear();
+}
+
 NDPtr add_ND(void)
 {
   NDPtr ndp;
@@ -197,7 +309,14 @@ NDPtr add_ND(void)
     return 0;
   }
 
-  ndp = NDs + NDs_num;
+  if (NDs_num % ND_BLOCK_SIZE == 0)
+  {
+    nd_blocks.push_back((NDPtr)malloc(sizeof(NormalDistribution) * ND_BLOCK_SIZE));
+    if (NDs_num == 0)
+      NDs = nd_blocks[0];
+  }
+
+  ndp = nd_blocks[NDs_num / ND_BLOCK_SIZE] + NDs_num % ND_BLOCK_SIZE;
   NDs_num++;
 
   ndp->flag = 0;
@@ -215,47 +334,36 @@ NDPtr add_ND(void)
   ndp->w = 1;
   ndp->is_source = 0;
 
+  nd_updates.push_back(ndp);
+
   return ndp;
 }
 
 NDMapPtr initialize_NDmap_layer(int layer, NDMapPtr child)
 {
-  // int i,j,k,i2,i3,m;
-  int i, j, k;
   int x, y, z;
-  NDPtr *nd, *ndp;
   NDMapPtr ndmap;
 
   x = (g_map_x >> layer) + 1;
   y = (g_map_y >> layer) + 1;
   z = (g_map_z >> layer) + 1;
 
-  nd = (NDPtr *)malloc(x * y * z * sizeof(NDPtr));
   ndmap = (NDMapPtr)malloc(sizeof(NDMap));
 
   ndmap->x = x;
   ndmap->y = y;
   ndmap->z = z;
-  ndmap->to_x = y * z;
+  ndmap->to_x = (long long)y * z;
   ndmap->to_y = z;
   ndmap->layer = layer;
-  ndmap->nd = nd;
   ndmap->next = child;
   ndmap->size = g_map_cellsize * ((int)1 << layer);
 
-  ndp = nd;
-
-  for (i = 0; i < x; i++)
-  {
-    for (j = 0; j < y; j++)
-    {
-      for (k = 0; k < z; k++)
-      {
-        *ndp = 0;
-        ndp++;
-      }
-    }
-  }
+  ndmap->nd = 0;
+  ndmap->key = 0;
+  ndmap->capacity = 0;
+  ndmap->num = 0;
+  resize_NDmap(ndmap, 1 << 16);
 
   return ndmap;
 }
@@ -270,7 +378,11 @@ NDMapPtr initialize_NDmap(void)
   ndmap = 0;
 
   // init NDs
-  NDs = (NDPtr)malloc(sizeof(NormalDistribution) * MAX_ND_NUM);
+  for (i = 0; i < (int)nd_blocks.size(); i++)
+    free(nd_blocks[i]);
+  nd_blocks.clear();
+  nd_updates.clear();
+  NDs = 0;
   NDs_num = 0;
 
   null_nd = add_ND();
@@ -278,8 +390,9 @@ NDMapPtr initialize_NDmap(void)
   {
     return 0;
   }
+  nd_updates.clear();
 
-  for (i = LAYER_NUM - 1; i >= 0; i--)
+  for (i = g_map_layer_num - 1; i >= 0; i--)
   {
     ndmap = initialize_NDmap_layer(i, ndmap);
   }
@@ -287,6 +400,17 @@ NDMapPtr initialize_NDmap(void)
   return ndmap;
 }
 
+/*bytes used by the hash tables of all layers and the NDs*/
+size_t NDmap_memory_size(NDMapPtr ndmap)
+{
+  size_t size = nd_blocks.size() * ND_BLOCK_SIZE * sizeof(NormalDistribution);
+  for (; ndmap; ndmap = ndmap->next)
+  {
+    size += sizeof(NDMap) + (size_t)ndmap->capacity * (sizeof(NDPtr) + sizeof(long long));
+  }
+  return size;
+}
+
 int round_covariance(NDPtr nd)
 {
   double v[3][3], a;
@@ -7,6 +7,8 @@
 #include "ndt.h"
 
 #define E_THETA 0.0001
+/*scan points are split into this many blocks, summed in order so the result does not depend on threads*/
+#define ADJUST_BLOCK_NUM 64
 
 extern int point_num;
 extern NDMapPtr NDmap;
@@ -17,8 +19,6 @@ extern double scan_points_totalweight;
 
 double qdd[3][3][2];
 double qd[3][2];
-double qd3[6][3];
-double qdd3[6][6][3];
 
 void set_sincos(double a, double b, double g, double sc_d[3][3][3]);
 void set_sincos2(double a, double b, double g, double sc[3][3]);
@@ -26,12 +26,13 @@ int check_Hessian(double H[3][3]);
 void save_data(PointPtr scan, int num, PosturePtr pose);
 void depth(PointPtr scan, int num, PosturePtr pose);
 
-double calc_summand3d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H[6][6], double qd3_d[6][3], double dist)
+double calc_summand3d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H[6][6], double qd3_d[6][3],
+                      double qdd3[6][6][3], double dist)
 {
   double a[3];
   double e;
   double q[3];
-  double qda[6][3], *qda_p;  //,*qdd_p;
+  double qda[6][3];
   int i, j;
 
   q[0] = p->x - nd->mean.x;
@@ -66,15 +67,12 @@ double calc_summand3d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H
 
   for (j = 0; j < 6; j++)
   {
-    qda[j][0] = qd3[j][0] * nd->inv_covariance[0][0] + qd3[j][1] * nd->inv_covariance[1][0] +
-                qd3[j][2] * nd->inv_covariance[2][0];
-    qda_p++;
-    qda[j][1] = qd3[j][0] * nd->inv_covariance[0][1] + qd3[j][1] * nd->inv_covariance[1][1] +
-                qd3[j][2] * nd->inv_covariance[2][1];
-    qda_p++;
-    qda[j][2] = qd3[j][0] * nd->inv_covariance[0][2] + qd3[j][1] * nd->inv_covariance[1][2] +
-                qd3[j][2] * nd->inv_covariance[2][2];
-    qda_p++;
+    qda[j][0] = qd3_d[j][0] * nd->inv_covariance[0][0] + qd3_d[j][1] * nd->inv_covariance[1][0] +
+                qd3_d[j][2] * nd->inv_covariance[2][0];
+    qda[j][1] = qd3_d[j][0] * nd->inv_covariance[0][1] + qd3_d[j][1] * nd->inv_covariance[1][1] +
+                qd3_d[j][2] * nd->inv_covariance[2][1];
+    qda[j][2] = qd3_d[j][0] * nd->inv_covariance[0][2] + qd3_d[j][1] * nd->inv_covariance[1][2] +
+                qd3_d[j][2] * nd->inv_covariance[2][2];
   }
 
   for (i = 0; i < 6; i++)
@@ -82,7 +80,7 @@ double calc_summand3d(PointPtr p, NDPtr nd, PosturePtr pose, double *g, double H
     for (j = 0; j < 6; j++)
     {
       H[i][j] = -e * ((-g[i]) * (g[j]) - (a[0] * qdd3[i][j][0] + a[1] * qdd3[i][j][1] + a[2] * qdd3[i][j][2]) -
-                      (qda[j][0] * qd3[i][0] + qda[j][1] * qd3[i][1] + qda[j][2] * qd3[i][2]));
+                      (qda[j][0] * qd3_d[i][0] + qda[j][1] * qd3_d[i][1] + qda[j][2] * qd3_d[i][2]));
     }
   }
 
@@ -178,31 +176,19 @@ void depth(PointPtr scan, int num, PosturePtr pose)
 
 double adjust3d(PointPtr scan, int num, PosturePtr initial, int target)
 {
-  double gsum[6], Hsum[6][6], Hsumh[6][6], Hinv[6][6], g[6], H[6][6], hH[6][6];
+  double gsum[6], Hsumh[6][6], Hinv[6][6], H[6][6];
   double sc[3][3], sc_d[3][3][3], sc_dd[3][3][3][3];
-  double *work;
   double esum = 0, gnum = 0;
-  NDPtr nd[8];
   NDMapPtr nd_map;
-  int i, j, n, m, k, layer;
-  double x, y, z;
+  int n, m, k, b, layer;
   PosturePtr pose;
-  Point p;
-  PointPtr scanptr;
-  int inc;
   int ndmode;
-  double dist;
+
+  /*partial sums of each block of scan points*/
+  double block_esum[ADJUST_BLOCK_NUM], block_gnum[ADJUST_BLOCK_NUM];
+  double block_gsum[ADJUST_BLOCK_NUM][6], block_Hsumh[ADJUST_BLOCK_NUM][6][6];
 
   /*initialize*/
-  gsum[0] = 0;
-  gsum[1] = 0;
-  gsum[2] = 0;
-  gsum[3] = 0;
-  gsum[4] = 0;
-  gsum[5] = 0;
-  j = 0;
-  zero_matrix6d(Hsum);
-  zero_matrix6d(Hsumh);
   pose = initial;
 
   set_sincos(pose->theta, pose->theta2, pose->theta3, sc_d);
@@ -212,123 +198,135 @@ double adjust3d(PointPtr scan, int num, PosturePtr initial, int target)
 
   set_sincos2(pose->theta, pose->theta2, pose->theta3, sc);
 
-  qd3[0][0] = 1;
-  qd3[0][1] = 0;
-  qd3[0][2] = 0;
-
-  qd3[1][0] = 0;
-  qd3[1][1] = 1;
-  qd3[1][2] = 0;
-
-  qd3[2][0] = 0;
-  qd3[2][1] = 0;
-  qd3[2][2] = 1;
-  for (n = 0; n < 6; n++)
-  {
-    for (m = 0; m < 6; m++)
-    {
-      for (k = 0; k < 3; k++)
-      {
-        qdd3[n][m][k] = 0;
-      }
-    }
-  }
-
   // using voxel grid filter
   switch (target)
   {
-    case 3:
-      inc = 1;
-      ndmode = 0;
-      break;
     case 2:
-      inc = 1;
       ndmode = 1;
       break;
-    case 1:
-      inc = 1;
-      ndmode = 0;
-      break;
     default:
-      inc = 1;
       ndmode = 0;
       break;
   }
 
-  //#endif
+  if (ndmode == 1)
+    layer = 1;  // layer_select;
+  else
+    layer = 0;  // layer_select;
+  nd_map = NDmap;
 
-  scanptr = scan;
-
-  // case of voxel grid filter used
-  for (i = 0; i < num; i += inc)
+  while (layer > 0)
   {
-    x = scanptr->x;
-    y = scanptr->y;
-    z = scanptr->z;
-    dist = 1;
-    scanptr += inc;
-
-    p.x = x * sc[0][0] + y * sc[0][1] + z * sc[0][2] + pose->x;
-    p.y = x * sc[1][0] + y * sc[1][1] + z * sc[1][2] + pose->y;
-    p.z = x * sc[2][0] + y * sc[2][1] + z * sc[2][2] + pose->z;
+    if (nd_map->next)
+      nd_map = nd_map->next;
+    layer--;
+  }
 
-    if (ndmode == 1)
-      layer = 1;  // layer_select;
-    if (ndmode == 0)
-      layer = 0;  // layer_select;
-    nd_map = NDmap;
+  /*NDs are read only while matching*/
+  update_covariances();
 
-    while (layer > 0)
-    {
-      if (nd_map->next)
-        nd_map = nd_map->next;
-      layer--;
-    }
+#pragma omp parallel for private(m, n, k)
+  for (b = 0; b < ADJUST_BLOCK_NUM; b++)
+  {
+    double g[6], hH[6][6];
+    double qd3[6][3], qdd3[6][6][3];
+    double x, y, z, dist, *work;
+    Point p;
+    NDPtr nd;
+    int i;
+
+    block_esum[b] = 0;
+    block_gnum[b] = 0;
+    for (m = 0; m < 6; m++)
+      block_gsum[b][m] = 0;
+    zero_matrix6d(block_Hsumh[b]);
 
+    qd3[0][0] = 1;
+    qd3[0][1] = 0;
+    qd3[0][2] = 0;
 
-    if (!get_ND(nd_map, &p, nd, target))
-      continue;
+    qd3[1][0] = 0;
+    qd3[1][1] = 1;
+    qd3[1][2] = 0;
 
-    work = (double *)sc_d;
-    for (m = 0; m < 3; m++)
+    qd3[2][0] = 0;
+    qd3[2][1] = 0;
+    qd3[2][2] = 1;
+    for (n = 0; n < 6; n++)
     {
-      for (k = 0; k < 3; k++)
+      for (m = 0; m < 6; m++)
       {
-        qd3[m + 3][k] = x * (*work) + y * (*(work + 1)) + z * (*(work + 2));
-        work += 3;
-      }
-    }
-
-    work = (double *)sc_dd;
-    for (n = 0; n < 3; n++) {
-      for (m = 0; m < 3; m++) {
-        for (k = 0; k < 3; k++) {
-          qdd3[n + 3][m + 3][k] = (*work * x + *(work + 1) * y + *(work + 2) * z - qd3[m + 3][k]) / E_THETA;
-          work += 3;
+        for (k = 0; k < 3; k++)
+        {
+          qdd3[n][m][k] = 0;
         }
       }
     }
 
-    if (nd[j])
+    // case of voxel grid filter used
+    for (i = (int)((long long)num * b / ADJUST_BLOCK_NUM); i < (int)((long long)num * (b + 1) / ADJUST_BLOCK_NUM); i++)
     {
-      if (nd[j]->num > 10 && nd[j]->sign == 1)
+      x = scan[i].x;
+      y = scan[i].y;
+      z = scan[i].z;
+      dist = 1;
+
+      p.x = x * sc[0][0] + y * sc[0][1] + z * sc[0][2] + pose->x;
+      p.y = x * sc[1][0] + y * sc[1][1] + z * sc[1][2] + pose->y;
+      p.z = x * sc[2][0] + y * sc[2][1] + z * sc[2][2] + pose->z;
+
+      nd = get_root_ND(nd_map, &p, target);
+      if (!nd)
+        continue;
+
+      if (nd->num > 10 && nd->sign == 1)
       {
-        //	double e;
-        esum += calc_summand3d(&p, nd[j], pose, g, hH, qd3, dist);
-        add_matrix6d(Hsumh, hH, Hsumh);
-
-        //	  dist =1;
-        gsum[0] += g[0];                //*nd[j]->w;
-        gsum[1] += g[1];                //*nd[j]->w;
-        gsum[2] += g[2] + pose->z * 0;  //*nd[j]->w;
-        gsum[3] += g[3];                //*nd[j]->w;
-        gsum[4] += g[4];                //+(pose->theta2-(0.0))*1;//*nd[j]->w;
-        gsum[5] += g[5];                //*nd[j]->w;
-        gnum += 1;                      // nd[j]->w;
+        work = (double *)sc_d;
+        for (m = 0; m < 3; m++)
+        {
+          for (k = 0; k < 3; k++)
+          {
+            qd3[m + 3][k] = x * (*work) + y * (*(work + 1)) + z * (*(work + 2));
+            work += 3;
+          }
+        }
+
+        work = (double *)sc_dd;
+        for (n = 0; n < 3; n++)
+        {
+          for (m = 0; m < 3; m++)
+          {
+            for (k = 0; k < 3; k++)
+            {
+              qdd3[n + 3][m + 3][k] = (*work * x + *(work + 1) * y + *(work + 2) * z - qd3[m + 3][k]) / E_THETA;
+              work += 3;
+            }
+          }
+        }
+
+        block_esum[b] += calc_summand3d(&p, nd, pose, g, hH, qd3, qdd3, dist);
+        add_matrix6d(block_Hsumh[b], hH, block_Hsumh[b]);
+
+        for (m = 0; m < 6; m++)
+          block_gsum[b][m] += g[m];
+        block_gnum[b] += 1;
       }
     }
   }
 
+  /*sum the blocks in order*/
+  for (m = 0; m < 6; m++)
+    gsum[m] = 0;
+  zero_matrix6d(Hsumh);
+  for (b = 0; b < ADJUST_BLOCK_NUM; b++)
+  {
+    esum += block_esum[b];
+    gnum += block_gnum[b];
+    for (m = 0; m < 6; m++)
+      gsum[m] += block_gsum[b][m];
+    add_matrix6d(Hsumh, block_Hsumh[b], Hsumh);
+  }
+
   if (gnum > 1)
   {
     identity_matrix6d(H);
@@ -359,7 +357,6 @@ double adjust3d(PointPtr scan, int num, PosturePtr initial, int target)
   }
   return esum;
 }
-
 void set_sincos2(double a, double b, double g, double sc[3][3])
 {
   double sa, ca, sb, cb, sg, cg;
@@ -0,0 +1,320 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "algebra.h"
+#include "ndt.h"
+
+extern NDMapPtr NDmap;
+extern NDPtr NDs;
+extern int NDs_num;
+
+namespace
+{
+// Street with buildings on both sides, posts and a sloped ground, in map coordinates
+std::vector<Point> createMapPoints(std::mt19937& gen)
+{
+  std::normal_distribution<double> noise(0.0, 0.02);
+  std::vector<Point> points;
+  Point p;
+
+  for (double x = -60.0; x <= 60.0; x += 0.2)
+  {
+    for (double y = -15.0; y <= 15.0; y += 0.2)
+    {
+      // ground
+      p.x = x + noise(gen);
+      p.y = y + noise(gen);
+      p.z = 0.01 * x + noise(gen);
+      points.push_back(p);
+    }
+    for (double z = 0.0; z <= 8.0; z += 0.2)
+    {
+      // facades with recesses every 10 m
+      double recess = (static_cast<int>(std::floor(x / 10.0)) % 2 == 0) ? 0.0 : 1.5;
+      p.x = x + noise(gen);
+      p.y = 12.0 + recess + noise(gen);
+      p.z = 0.01 * x + z + noise(gen);
+      points.push_back(p);
+      p.y = -12.0 - recess + noise(gen);
+      points.push_back(p);
+    }
+  }
+
+  // posts
+  for (double px = -55.0; px <= 55.0; px += 7.0)
+  {
+    for (double a = 0.0; a < 2.0 * M_PI; a += 0.3)
+    {
+      for (double z = 0.0; z <= 4.0; z += 0.2)
+      {
+        p.x = px + 0.2 * cos(a) + noise(gen);
+        p.y = 8.0 + 0.2 * sin(a) + noise(gen);
+        p.z = 0.01 * px + z + noise(gen);
+        points.push_back(p);
+      }
+    }
+  }
+  return points;
+}
+
+void buildMap(const std::vector<Point>& points)
+{
+  g_map_x = 2000;
+  g_map_y = 2000;
+  g_map_z = 200;
+  g_map_cellsize = 1.0;
+  g_map_layer_num = 2;
+
+  NDmap = initialize_NDmap();
+  for (size_t i = 0; i < points.size(); i++)
+  {
+    Point p = points[i];
+    add_point_map(NDmap, &p);
+  }
+}
+
+// Map points within range seen from the pose, in sensor coordinates
+std::vector<Point> createScan(const std::vector<Point>& map_points, const Posture& pose, std::mt19937& gen)
+{
+  std::uniform_real_distribution<double> keep(0.0, 1.0);
+  double sc[3][3];
+  set_sincos2(pose.theta, pose.theta2, pose.theta3, sc);
+
+  std::vector<Point> scan;
+  for (size_t i = 0; i < map_points.size(); i++)
+  {
+    double dx = map_points[i].x - pose.x, dy = map_points[i].y - pose.y, dz = map_points[i].z - pose.z;
+    double dist = dx * dx + dy * dy;
+    if (dist < 3.0 * 3.0 || dist > 40.0 * 40.0 || keep(gen) > 0.25)
+      continue;
+
+    // transpose of the rotation
+    Point p;
+    p.x = sc[0][0] * dx + sc[1][0] * dy + sc[2][0] * dz;
+    p.y = sc[0][1] * dx + sc[1][1] * dy + sc[2][1] * dz;
+    p.z = sc[0][2] * dx + sc[1][2] * dy + sc[2][2] * dz;
+    scan.push_back(p);
+  }
+  return scan;
+}
+
+// Iterations of ndt_matching_tku
+int match(std::vector<Point>& scan, Posture* pose)
+{
+  int j;
+  for (j = 0; j < 100; j++)
+  {
+    Posture bpose = *pose;
+    adjust3d(scan.data(), scan.size(), pose, 1);
+
+    if ((bpose.x - pose->x) * (bpose.x - pose->x) + (bpose.y - pose->y) * (bpose.y - pose->y) +
+            (bpose.z - pose->z) * (bpose.z - pose->z) + 3 * (bpose.theta - pose->theta) * (bpose.theta - pose->theta) +
+            3 * (bpose.theta2 - pose->theta2) * (bpose.theta2 - pose->theta2) +
+            3 * (bpose.theta3 - pose->theta3) * (bpose.theta3 - pose->theta3) <
+        0.00001)
+    {
+      break;
+    }
+  }
+  return j;
+}
+
+Posture makePosture(double x, double y, double z, double roll, double pitch, double yaw)
+{
+  Posture pose;
+  pose.x = x;
+  pose.y = y;
+  pose.z = z;
+  pose.theta = roll;
+  pose.theta2 = pitch;
+  pose.theta3 = yaw;
+  return pose;
+}
+}  // namespace
+
+TEST(TestNDMap, sparseCells)
+{
+  g_map_x = 2000;
+  g_map_y = 2000;
+  g_map_z = 200;
+  g_map_cellsize = 1.0;
+  g_map_layer_num = 3;
+
+  NDMapPtr ndmap = initialize_NDmap();
+  ASSERT_TRUE(ndmap != 0);
+  ASSERT_TRUE(ndmap->next != 0 && ndmap->next->next != 0 && ndmap->next->next->next == 0) << "3 layers expected";
+  EXPECT_DOUBLE_EQ(ndmap->next->size, 2.0);
+  EXPECT_DOUBLE_EQ(ndmap->next->next->size, 4.0);
+
+  // a point is added to the 8 cells around it on every layer
+  Point p;
+  p.x = 10.3;
+  p.y = -20.6;
+  p.z = 1.2;
+  add_point_map(ndmap, &p);
+  EXPECT_EQ(ndmap->num, 8);
+  EXPECT_EQ(ndmap->next->num, 8);
+  EXPECT_EQ(NDs_num, 1 + 3 * 8);
+
+  // points far out of a dense map of this extent only cost their cells
+  for (int i = 0; i < 20; i++)
+  {
+    p.x = 900.3;
+    p.y = -900.0 + i * 0.05;
+    p.z = 90.2;
+    add_point_map(ndmap, &p);
+  }
+
+  NDPtr nd[8];
+  ASSERT_TRUE(get_ND(ndmap, &p, nd, 3));
+  EXPECT_EQ(nd[0]->num, 20);
+  EXPECT_NEAR(nd[0]->mean.y, -900.0 + 19 * 0.05 / 2, 1e-9);
+
+  // out of the map
+  p.x = 1500.0;
+  EXPECT_FALSE(get_ND(ndmap, &p, nd, 3));
+  EXPECT_TRUE(get_root_ND(ndmap, &p, 3) == 0);
+
+  // empty cell in the map
+  p.x = 0.0;
+  p.y = 0.0;
+  p.z = 0.0;
+  EXPECT_TRUE(get_root_ND(ndmap, &p, 3) == NDs);
+}
+
+TEST(TestNDMap, growsHashTable)
+{
+  g_map_x = 2000;
+  g_map_y = 2000;
+  g_map_z = 200;
+  g_map_cellsize = 1.0;
+  g_map_layer_num = 1;
+
+  NDMapPtr ndmap = initialize_NDmap();
+  Point p;
+  for (int i = 0; i < 100; i++)
+  {
+    for (int j = 0; j < 100; j++)
+    {
+      p.x = i * 2.0 - 100.0;
+      p.y = j * 2.0 - 100.0;
+      p.z = 0.5;
+      add_point_map(ndmap, &p);
+    }
+  }
+
+  EXPECT_EQ(ndmap->num, 100 * 100 * 8);
+  EXPECT_GE(ndmap->capacity, ndmap->num * 2);
+  for (int i = 0; i < 100; i++)
+  {
+    for (int j = 0; j < 100; j++)
+    {
+      p.x = i * 2.0 - 100.0;
+      p.y = j * 2.0 - 100.0;
+      p.z = 0.5;
+      NDPtr nd = get_root_ND(ndmap, &p, 3);
+      ASSERT_TRUE(nd != 0 && nd != NDs);
+      ASSERT_EQ(nd->num, 1);
+    }
+  }
+}
+
+TEST(TestAdjust3d, convergesAndDeterministic)
+{
+  std::mt19937 gen(0);
+  std::vector<Point> map_points = createMapPoints(gen);
+  buildMap(map_points);
+
+  Posture truth = makePosture(3.0, 1.0, 0.03 + 1.8, 0.01, -0.02, 0.3);
+  std::vector<Point> scan = createScan(map_points, truth, gen);
+  ASSERT_GT(scan.size(), 10000u);
+
+  Posture pose = makePosture(3.6, 0.6, 1.9, 0.0, 0.0, 0.25);
+  match(scan, &pose);
+
+  EXPECT_NEAR(pose.x, truth.x, 0.1);
+  EXPECT_NEAR(pose.y, truth.y, 0.1);
+  EXPECT_NEAR(pose.z, truth.z, 0.1);
+  EXPECT_NEAR(pose.theta3, truth.theta3, 0.01);
+
+#ifdef _OPENMP
+  // the scan is summed in fixed blocks, the number of threads does not change the result
+  int num_threads = omp_get_max_threads();
+  Posture single = makePosture(3.6, 0.6, 1.9, 0.0, 0.0, 0.25);
+  omp_set_num_threads(1);
+  match(scan, &single);
+  omp_set_num_threads(num_threads);
+
+  EXPECT_EQ(pose.x, single.x);
+  EXPECT_EQ(pose.y, single.y);
+  EXPECT_EQ(pose.z, single.z);
+  EXPECT_EQ(pose.theta, single.theta);
+  EXPECT_EQ(pose.theta2, single.theta2);
+  EXPECT_EQ(pose.theta3, single.theta3);
+#endif
+}
+
+TEST(TestAdjust3d, benchmark)
+{
+  std::mt19937 gen(1);
+  std::vector<Point> map_points = createMapPoints(gen);
+  buildMap(map_points);
+
+  // memory of the dense map of the same extent: a pointer per cell of each layer and MAX_ND_NUM NDs
+  double dense_size = (double)MAX_ND_NUM * sizeof(NormalDistribution);
+  for (NDMapPtr ndmap = NDmap; ndmap; ndmap = ndmap->next)
+  {
+    dense_size += (double)ndmap->x * ndmap->y * ndmap->z * sizeof(NDPtr);
+  }
+  printf("[ ND map   ] %d NDs, sparse %.1f MB, dense %.1f MB\n", NDs_num, NDmap_memory_size(NDmap) / 1e6,
+         dense_size / 1e6);
+
+  const int scan_num = 20;
+  double msec = 0;
+  int iterations = 0;
+  for (int i = 0; i < scan_num; i++)
+  {
+    Posture truth = makePosture(-30.0 + i * 3.0, 0.5, 1.5 - 0.3 + 0.01 * i * 3.0, 0.0, 0.0, 0.05 * i);
+    std::vector<Point> scan = createScan(map_points, truth, gen);
+    Posture pose = makePosture(truth.x + 0.3, truth.y - 0.2, truth.z, 0.0, 0.0, truth.theta3 + 0.03);
+
+    auto start = std::chrono::steady_clock::now();
+    iterations += match(scan, &pose);
+    msec += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    EXPECT_NEAR(pose.x, truth.x, 0.1);
+    EXPECT_NEAR(pose.y, truth.y, 0.1);
+  }
+  printf("[ adjust3d ] %.3f ms per scan, %.1f iterations per scan\n", msec / scan_num, (double)iterations / scan_num);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
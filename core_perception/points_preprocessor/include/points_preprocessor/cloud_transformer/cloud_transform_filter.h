@@ -0,0 +1,85 @@
+/*
+ * Copyright 2017-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POINTS_PREPROCESSOR_CLOUD_TRANSFORMER_CLOUD_TRANSFORM_FILTER_H
+#define POINTS_PREPROCESSOR_CLOUD_TRANSFORMER_CLOUD_TRANSFORM_FILTER_H
+
+#include <cstdint>
+#include <vector>
+
+#include <Eigen/Core>
+#include <sensor_msgs/PointCloud2.h>
+
+/*!
+ * Transforms and/or crops a sensor_msgs::PointCloud2 without converting it to a pcl::PointCloud.
+ * Points are read and written through the x, y, z field offsets of the message, every other field is copied as is,
+ * so the output has the same layout as the input. The output message is meant to be reused between frames.
+ */
+class CloudTransformFilter
+{
+public:
+  CloudTransformFilter();
+
+  /*!
+   * Transform applied to x, y, z of every point. Points are cropped after the transform.
+   * @param[in] in_transform Homogeneous transform from the input frame to the output frame
+   */
+  void SetTransform(const Eigen::Matrix4f& in_transform);
+  void ClearTransform();
+
+  /*!
+   * Removes points with y > in_left_distance or y < -in_right_distance, as space_filter's lateral removal
+   */
+  void SetLateralRemoval(bool in_enable, float in_left_distance, float in_right_distance);
+
+  /*!
+   * Keeps points with in_below_distance <= z <= in_above_distance, as space_filter's vertical removal
+   */
+  void SetVerticalRemoval(bool in_enable, float in_below_distance, float in_above_distance);
+
+  /*!
+   * @param[in] in_cloud Cloud with FLOAT32 x, y, z fields
+   * @param[out] out_cloud Transformed and cropped cloud. Its data buffer is reused
+   * @retval false in_cloud has no FLOAT32 x, y, z fields
+   */
+  bool Apply(const sensor_msgs::PointCloud2& in_cloud, sensor_msgs::PointCloud2& out_cloud);
+
+private:
+  bool do_transform_;
+  Eigen::Matrix4f transform_;
+
+  bool lateral_removal_;
+  float left_distance_;
+  float right_distance_;
+
+  bool vertical_removal_;
+  float below_distance_;
+  float above_distance_;
+
+  // per point keep flags and kept points per block, reused between frames
+  std::vector<uint8_t> keep_;
+  std::vector<size_t> block_offsets_;
+
+  static const int NUM_BLOCKS = 64;
+
+  bool IsKept(float in_y, float in_z) const;
+
+  void TransformXYZ(float& io_x, float& io_y, float& io_z, bool in_check_finite) const;
+
+  void TransformPoint(uint8_t* io_point, uint32_t in_offset_x, uint32_t in_offset_y, uint32_t in_offset_z,
+                      bool in_check_finite) const;
+};
+
+#endif  // POINTS_PREPROCESSOR_CLOUD_TRANSFORMER_CLOUD_TRANSFORM_FILTER_H
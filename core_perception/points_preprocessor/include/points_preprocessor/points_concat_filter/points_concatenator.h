@@ -0,0 +1,153 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#ifndef POINTS_PREPROCESSOR_POINTS_CONCAT_FILTER_POINTS_CONCATENATOR_H
+#define POINTS_PREPROCESSOR_POINTS_CONCAT_FILTER_POINTS_CONCATENATOR_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+#include <sensor_msgs/PointCloud2.h>
+
+/*!
+ * Concatenates the clouds of several sensors into one cloud with the layout of pcl::PointXYZI.
+ * Each cloud is transformed as soon as it arrives, on the thread that delivers it, directly into a region of the
+ * output message reserved in arrival order. The output is presized to the largest clouds seen so far, so a frame
+ * is published without assembling it unless a sensor outgrew its size or delivered twice.
+ * Two output messages are used in turn, clouds of the next frame are written while the last output is published.
+ * AddCloud may be called concurrently for different sensors, but not for the same sensor.
+ */
+class PointsConcatenator
+{
+public:
+  enum class PublishPolicy
+  {
+    ALL_ARRIVED,  // wait until every sensor delivered a cloud
+    TIMEOUT,      // publish when every sensor delivered a cloud or the timeout after the first cloud expired
+  };
+
+  struct SensorStatus
+  {
+    bool arrived;            // sensor is included in the output
+    bool has_cloud;          // sensor delivered at least one cloud since start
+    double stamp;            // header stamp of the latest cloud of the sensor [s]
+    double age;              // output stamp - stamp [s]
+    size_t offset;           // index of the first point of the sensor in the output
+    uint32_t num_points;     // points of the sensor in the output
+    uint64_t missed_frames;  // consecutive outputs the sensor was missing from
+  };
+
+  PointsConcatenator(size_t in_num_sensors, const std::string& in_output_frame_id, PublishPolicy in_policy,
+                     double in_timeout);
+
+  /*!
+   * Transforms in_cloud into the current frame. A sensor delivering twice in the same frame replaces its cloud.
+   * @param[in] in_transform Transform from the cloud frame to the output frame
+   * @param[in] in_arrival_time Monotonic time of arrival [s], the first cloud of a frame starts its timeout
+   * @retval false in_cloud has no FLOAT32 x, y, z fields
+   */
+  bool AddCloud(size_t in_sensor, const sensor_msgs::PointCloud2& in_cloud, const Eigen::Matrix4f& in_transform,
+                double in_arrival_time);
+
+  /*!
+   * @param[in] in_now Monotonic time [s]
+   * @return true if the current frame has to be published according to the policy
+   */
+  bool IsDue(double in_now) const;
+
+  /*!
+   * Closes the current frame and starts a new one. Waits for the clouds of the frame still being transformed.
+   * The output stamp is the latest stamp among the arrived clouds.
+   * @param[out] out_status Status of each sensor for this output
+   * @retval false no cloud arrived since the last output
+   */
+  bool Concatenate(std::vector<SensorStatus>& out_status);
+
+  /*!
+   * @return Output of the last Concatenate, valid until the next one
+   */
+  const sensor_msgs::PointCloud2& GetConcatenatedCloud() const
+  {
+    return frames_[1 - current_frame_].cloud;
+  }
+
+  size_t GetNumSensors() const
+  {
+    return sensors_.size();
+  }
+
+  // layout of pcl::PointXYZI
+  static const uint32_t POINT_STEP = 32;
+  static const uint32_t OFFSET_X = 0;
+  static const uint32_t OFFSET_Y = 4;
+  static const uint32_t OFFSET_Z = 8;
+  static const uint32_t OFFSET_INTENSITY = 16;
+
+private:
+  // cloud of a sensor in a frame
+  struct SensorRegion
+  {
+    bool arrived;
+    size_t offset;                  // in points, unused if overflow
+    uint32_t size;                  // reserved points
+    uint32_t num_points;
+    bool overflow;                  // did not fit, transformed into overflow_data
+    std::vector<uint8_t> overflow_data;
+    ros::Time stamp;
+    bool is_dense;
+  };
+
+  struct FrameBuffer
+  {
+    sensor_msgs::PointCloud2 cloud;
+    std::vector<SensorRegion> regions;
+    size_t capacity;  // points
+    size_t fill;      // reserved points
+    size_t num_arrived;
+    int num_writers;
+    bool started;
+    double first_arrival_time;
+  };
+
+  struct SensorState
+  {
+    uint32_t max_points;
+    bool has_cloud;
+    ros::Time stamp;
+    uint64_t missed_frames;
+  };
+
+  PublishPolicy policy_;
+  double timeout_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable writers_done_;
+  FrameBuffer frames_[2];
+  int current_frame_;
+  std::vector<SensorState> sensors_;
+
+  void StartFrame(FrameBuffer& io_frame);
+  void FinishFrame(FrameBuffer& io_frame, std::vector<SensorStatus>& out_status);
+
+  static void TransformCloud(const sensor_msgs::PointCloud2& in_cloud, const Eigen::Matrix4f& in_transform,
+                             uint32_t in_offset_x, uint32_t in_offset_y, uint32_t in_offset_z,
+                             int in_offset_intensity, uint8_t* out_data);
+};
+
+#endif  // POINTS_PREPROCESSOR_POINTS_CONCAT_FILTER_POINTS_CONCATENATOR_H
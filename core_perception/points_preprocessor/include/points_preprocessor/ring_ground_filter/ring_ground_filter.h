@@ -0,0 +1,82 @@
+/*
+ * ring_ground_filter.h
+ *
+ * Created on	: June 5, 2018
+ * Author	: Patiphon Narksri
+ *
+ */
+#ifndef POINTS_PREPROCESSOR_RING_GROUND_FILTER_RING_GROUND_FILTER_H
+#define POINTS_PREPROCESSOR_RING_GROUND_FILTER_RING_GROUND_FILTER_H
+
+#include <string>
+#include <vector>
+
+#include <pcl/point_cloud.h>
+#include <velodyne_pointcloud/point_types.h>
+
+/*!
+ * Classifies the points of an organized multi-beam scan as ground and vertical, column by column.
+ * Columns are independent, so they are processed in parallel blocks whose outputs are merged in column order.
+ */
+class RingGroundFilter
+{
+public:
+
+	/*!
+	 * @param in_vertical_res Number of beams (rings) of the sensor
+	 * @param in_horizontal_res Number of azimuth columns
+	 * @param in_vertical_thres Height difference above which a group of points is vertical
+	 * @param in_radius_table Radius threshold for each row, row 0 is the highest ring
+	 */
+	RingGroundFilter(int in_vertical_res, int in_horizontal_res, double in_vertical_thres,
+				const std::vector<double> &in_radius_table);
+
+	void FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &in_cloud,
+				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_groundless_points,
+				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_ground_points);
+
+	/*!
+	 * Hard-coded radius tables of the 16, 32 and 64 beam models. Other models get the 64 beam table.
+	 */
+	static std::vector<double> CreateRadiusTable(int in_model, double in_sensor_height, double in_max_slope);
+
+	/*!
+	 * Radius table computed from the elevation angle of each ring
+	 * @param in_vertical_angles Elevation angle of each ring in radians, ordered by ring
+	 */
+	static std::vector<double> CreateRadiusTable(const std::vector<double> &in_vertical_angles,
+				double in_sensor_height, double in_max_slope);
+
+	/*!
+	 * Reads the elevation angles from a velodyne_pointcloud calibration file.
+	 * Rings are numbered by ascending vert_correction, as the velodyne driver does.
+	 * @retval false the file could not be read
+	 */
+	static bool LoadVerticalAngles(const std::string &in_calibration_file, std::vector<double> &out_vertical_angles);
+
+private:
+
+	int vertical_res_;
+	int horizontal_res_;
+	double vertical_thres_;
+	std::vector<double> radius_table_;
+
+	// column-major range image, index_map_[column * vertical_res_ + row] is the point index or -1
+	std::vector<int> index_map_;
+	std::vector<int> point_cells_;
+
+	// point indices emitted by each block of columns, kept between frames
+	std::vector<std::vector<int> > block_groundless_indices_;
+	std::vector<std::vector<int> > block_ground_indices_;
+
+	static const int NUM_COLUMN_BLOCKS = 64;
+
+	void ClassifyColumn(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &in_cloud, int in_column,
+				std::vector<int> &out_groundless_indices, std::vector<int> &out_ground_indices) const;
+
+	void CopyPoints(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &in_cloud,
+				const std::vector<std::vector<int> > &in_block_indices,
+				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_cloud) const;
+};
+
+#endif  // POINTS_PREPROCESSOR_RING_GROUND_FILTER_RING_GROUND_FILTER_H
@@ -0,0 +1,224 @@
+/*
+ * Copyright 2017-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "points_preprocessor/cloud_transformer/cloud_transform_filter.h"
+
+namespace
+{
+bool FindFloatField(const sensor_msgs::PointCloud2& in_cloud, const std::string& in_name, uint32_t& out_offset)
+{
+  for (const auto& field : in_cloud.fields)
+  {
+    if (field.name == in_name)
+    {
+      out_offset = field.offset;
+      return field.datatype == sensor_msgs::PointField::FLOAT32;
+    }
+  }
+  return false;
+}
+
+inline float ReadFloat(const uint8_t* in_point, uint32_t in_offset)
+{
+  float value;
+  std::memcpy(&value, in_point + in_offset, sizeof(float));
+  return value;
+}
+
+inline void WriteFloat(uint8_t* out_point, uint32_t in_offset, float in_value)
+{
+  std::memcpy(out_point + in_offset, &in_value, sizeof(float));
+}
+}  // namespace
+
+CloudTransformFilter::CloudTransformFilter()
+  : do_transform_(false)
+  , transform_(Eigen::Matrix4f::Identity())
+  , lateral_removal_(false)
+  , left_distance_(0.f)
+  , right_distance_(0.f)
+  , vertical_removal_(false)
+  , below_distance_(0.f)
+  , above_distance_(0.f)
+  , block_offsets_(NUM_BLOCKS + 1, 0)
+{
+}
+
+void CloudTransformFilter::SetTransform(const Eigen::Matrix4f& in_transform)
+{
+  transform_ = in_transform;
+  do_transform_ = true;
+}
+
+void CloudTransformFilter::ClearTransform()
+{
+  do_transform_ = false;
+}
+
+void CloudTransformFilter::SetLateralRemoval(bool in_enable, float in_left_distance, float in_right_distance)
+{
+  lateral_removal_ = in_enable;
+  left_distance_ = in_left_distance;
+  right_distance_ = in_right_distance;
+}
+
+void CloudTransformFilter::SetVerticalRemoval(bool in_enable, float in_below_distance, float in_above_distance)
+{
+  vertical_removal_ = in_enable;
+  below_distance_ = in_below_distance;
+  above_distance_ = in_above_distance;
+}
+
+bool CloudTransformFilter::IsKept(float in_y, float in_z) const
+{
+  if (lateral_removal_ && (in_y > left_distance_ || in_y < -1.0 * right_distance_))
+  {
+    return false;
+  }
+  if (vertical_removal_ && !(in_z >= below_distance_ && in_z <= above_distance_))
+  {
+    return false;
+  }
+  return true;
+}
+
+void CloudTransformFilter::TransformXYZ(float& io_x, float& io_y, float& io_z, bool in_check_finite) const
+{
+  // Dataset might contain NaNs and Infs, they are left untouched
+  if (in_check_finite && (!std::isfinite(io_x) || !std::isfinite(io_y) || !std::isfinite(io_z)))
+  {
+    return;
+  }
+  const float x = io_x;
+  const float y = io_y;
+  const float z = io_z;
+  io_x = static_cast<float>(transform_(0, 0) * x + transform_(0, 1) * y + transform_(0, 2) * z + transform_(0, 3));
+  io_y = static_cast<float>(transform_(1, 0) * x + transform_(1, 1) * y + transform_(1, 2) * z + transform_(1, 3));
+  io_z = static_cast<float>(transform_(2, 0) * x + transform_(2, 1) * y + transform_(2, 2) * z + transform_(2, 3));
+}
+
+void CloudTransformFilter::TransformPoint(uint8_t* io_point, uint32_t in_offset_x, uint32_t in_offset_y,
+                                          uint32_t in_offset_z, bool in_check_finite) const
+{
+  float x = ReadFloat(io_point, in_offset_x);
+  float y = ReadFloat(io_point, in_offset_y);
+  float z = ReadFloat(io_point, in_offset_z);
+  TransformXYZ(x, y, z, in_check_finite);
+  WriteFloat(io_point, in_offset_x, x);
+  WriteFloat(io_point, in_offset_y, y);
+  WriteFloat(io_point, in_offset_z, z);
+}
+
+bool CloudTransformFilter::Apply(const sensor_msgs::PointCloud2& in_cloud, sensor_msgs::PointCloud2& out_cloud)
+{
+  uint32_t offset_x, offset_y, offset_z;
+  if (!FindFloatField(in_cloud, "x", offset_x) || !FindFloatField(in_cloud, "y", offset_y) ||
+      !FindFloatField(in_cloud, "z", offset_z))
+  {
+    return false;
+  }
+
+  out_cloud.header = in_cloud.header;
+  out_cloud.fields = in_cloud.fields;
+  out_cloud.is_bigendian = in_cloud.is_bigendian;
+  out_cloud.point_step = in_cloud.point_step;
+  out_cloud.is_dense = in_cloud.is_dense;
+
+  const int width = in_cloud.width;
+  const int num_points = in_cloud.width * in_cloud.height;
+  const uint32_t point_step = in_cloud.point_step;
+  const bool check_finite = !in_cloud.is_dense;
+
+  if (!lateral_removal_ && !vertical_removal_)
+  {
+    // keep the organization of the cloud, rows may be padded
+    out_cloud.height = in_cloud.height;
+    out_cloud.width = in_cloud.width;
+    out_cloud.row_step = in_cloud.row_step;
+    out_cloud.data.resize(in_cloud.data.size());
+    std::copy(in_cloud.data.begin(), in_cloud.data.end(), out_cloud.data.begin());
+    if (do_transform_)
+    {
+#pragma omp parallel for
+      for (int i = 0; i < num_points; i++)
+      {
+        uint8_t* point = &out_cloud.data[(i / width) * in_cloud.row_step + (i % width) * point_step];
+        TransformPoint(point, offset_x, offset_y, offset_z, check_finite);
+      }
+    }
+    return true;
+  }
+
+  // the cropped cloud is unorganized. Points are counted per block so that blocks can be copied in parallel
+  keep_.resize(num_points);
+  const int points_per_block = (num_points + NUM_BLOCKS - 1) / NUM_BLOCKS;
+#pragma omp parallel for
+  for (int b = 0; b < NUM_BLOCKS; b++)
+  {
+    size_t num_kept = 0;
+    const int end = std::min(num_points, (b + 1) * points_per_block);
+    for (int i = b * points_per_block; i < end; i++)
+    {
+      const uint8_t* point = &in_cloud.data[(i / width) * in_cloud.row_step + (i % width) * point_step];
+      float x = ReadFloat(point, offset_x);
+      float y = ReadFloat(point, offset_y);
+      float z = ReadFloat(point, offset_z);
+      if (do_transform_)
+      {
+        TransformXYZ(x, y, z, check_finite);
+      }
+      keep_[i] = IsKept(y, z);
+      num_kept += keep_[i];
+    }
+    block_offsets_[b + 1] = num_kept;
+  }
+  for (int b = 0; b < NUM_BLOCKS; b++)
+  {
+    block_offsets_[b + 1] += block_offsets_[b];
+  }
+
+  const size_t num_kept = block_offsets_[NUM_BLOCKS];
+  out_cloud.height = 1;
+  out_cloud.width = num_kept;
+  out_cloud.row_step = num_kept * point_step;
+  out_cloud.data.resize(out_cloud.row_step);
+
+#pragma omp parallel for
+  for (int b = 0; b < NUM_BLOCKS; b++)
+  {
+    uint8_t* out_point = out_cloud.data.data() + block_offsets_[b] * point_step;
+    const int end = std::min(num_points, (b + 1) * points_per_block);
+    for (int i = b * points_per_block; i < end; i++)
+    {
+      if (!keep_[i])
+      {
+        continue;
+      }
+      const uint8_t* point = &in_cloud.data[(i / width) * in_cloud.row_step + (i % width) * point_step];
+      std::memcpy(out_point, point, point_step);
+      if (do_transform_)
+      {
+        TransformPoint(out_point, offset_x, offset_y, offset_z, check_finite);
+      }
+      out_point += point_step;
+    }
+  }
+  return true;
+}
@@ -18,13 +18,11 @@
 #include <iostream>
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
-#include <pcl_ros/point_cloud.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/point_types.h>
-#include <velodyne_pointcloud/point_types.h>
 #include <tf/transform_listener.h>
 #include <pcl_ros/transforms.h>
 
+#include "points_preprocessor/cloud_transformer/cloud_transform_filter.h"
+
 class CloudTransformerNode
 {
 private:
@@ -41,81 +39,19 @@ private:
 
 	bool                transform_ok_;
 
-	void publish_cloud(const ros::Publisher& in_publisher,
-	                   const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg)
-	{
-		in_publisher.publish(in_cloud_msg);
-	}
+	bool                lateral_removal_;
+	double              left_distance_;
+	double              right_distance_;
+	bool                vertical_removal_;
+	double              below_distance_;
+	double              above_distance_;
 
-	void transformXYZIRCloud(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>& in_cloud,
-	                         pcl::PointCloud<velodyne_pointcloud::PointXYZIR>& out_cloud,
-	                         const tf::StampedTransform& in_tf_stamped_transform)
-	{
-		Eigen::Matrix4f transform;
-		pcl_ros::transformAsMatrix(in_tf_stamped_transform, transform);
+	CloudTransformFilter cloud_filter_;
+	// reused between frames, publish() serializes it before the next callback
+	sensor_msgs::PointCloud2 transformed_cloud_;
 
-		if (&in_cloud != &out_cloud)
-		{
-			out_cloud.header   = in_cloud.header;
-			out_cloud.is_dense = in_cloud.is_dense;
-			out_cloud.width    = in_cloud.width;
-			out_cloud.height   = in_cloud.height;
-			out_cloud.points.reserve (out_cloud.points.size ());
-			out_cloud.points.assign (in_cloud.points.begin (), in_cloud.points.end ());
-			out_cloud.sensor_orientation_ = in_cloud.sensor_orientation_;
-			out_cloud.sensor_origin_      = in_cloud.sensor_origin_;
-			}
-		if (in_cloud.is_dense)
-			{
-			for (size_t i = 0; i < out_cloud.points.size (); ++i)
-				{
-				//out_cloud.points[i].getVector3fMap () = transform * in_cloud.points[i].getVector3fMap ();
-				Eigen::Matrix<float, 3, 1> pt (in_cloud[i].x, in_cloud[i].y, in_cloud[i].z);
-				out_cloud[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) +
-													transform (0, 1) * pt.coeffRef (1) +
-													transform (0, 2) * pt.coeffRef (2) +
-													transform (0, 3));
-				out_cloud[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) +
-													transform (1, 1) * pt.coeffRef (1) +
-													transform (1, 2) * pt.coeffRef (2) +
-													transform (1, 3));
-				out_cloud[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) +
-													transform (2, 1) * pt.coeffRef (1) +
-													transform (2, 2) * pt.coeffRef (2) +
-													transform (2, 3));
-				}
-			}
-		else
-		{
-			// Dataset might contain NaNs and Infs, so check for them first,
-			for (size_t i = 0; i < out_cloud.points.size (); ++i)
-			{
-				if (!pcl_isfinite (in_cloud.points[i].x) ||
-				           !pcl_isfinite (in_cloud.points[i].y) ||
-				           !pcl_isfinite (in_cloud.points[i].z))
-					{continue;}
-				//out_cloud.points[i].getVector3fMap () = transform * in_cloud.points[i].getVector3fMap ();
-				Eigen::Matrix<float, 3, 1> pt (in_cloud[i].x, in_cloud[i].y, in_cloud[i].z);
-				out_cloud[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) +
-													transform (0, 1) * pt.coeffRef (1) +
-													transform (0, 2) * pt.coeffRef (2) +
-													transform (0, 3));
-				out_cloud[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) +
-													transform (1, 1) * pt.coeffRef (1) +
-													transform (1, 2) * pt.coeffRef (2) +
-													transform (1, 3));
-				out_cloud[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) +
-													transform (2, 1) * pt.coeffRef (1) +
-													transform (2, 2) * pt.coeffRef (2) +
-													transform (2, 3));
-			}
-		}
-	}
-
-	void CloudCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_sensor_cloud)
+	void CloudCallback(const sensor_msgs::PointCloud2::ConstPtr &in_sensor_cloud)
 	{
-		pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::Ptr transformed_cloud_ptr (new pcl::PointCloud<velodyne_pointcloud::PointXYZIR>);
-
 		bool do_transform = false;
 		tf::StampedTransform transform;
 		if (target_frame_ != in_sensor_cloud->header.frame_id)
@@ -133,15 +69,26 @@ private:
 		}
 		if (do_transform)
 		{
-			transformXYZIRCloud(*in_sensor_cloud, *transformed_cloud_ptr, transform);
-			transformed_cloud_ptr->header.frame_id = target_frame_;
+			Eigen::Matrix4f transform_matrix;
+			pcl_ros::transformAsMatrix(transform, transform_matrix);
+			cloud_filter_.SetTransform(transform_matrix);
+		}
+		else
+			{ cloud_filter_.ClearTransform();}
+
+		if (!cloud_filter_.Apply(*in_sensor_cloud, transformed_cloud_))
+		{
+			ROS_ERROR("cloud_transformer: input cloud has no FLOAT32 x, y, z fields.");
+			return;
+		}
+		if (do_transform)
+		{
+			transformed_cloud_.header.frame_id = target_frame_;
 			if (!transform_ok_)
 				{ROS_INFO("cloud_transformer: Correctly Transformed"); transform_ok_=true;}
 		}
-		else
-			{ pcl::copyPointCloud(*in_sensor_cloud, *transformed_cloud_ptr);}
 
-		publish_cloud(transformed_points_pub_, transformed_cloud_ptr);
+		transformed_points_pub_.publish(transformed_cloud_);
 	}
 
 public:
@@ -161,6 +108,17 @@ public:
 		node_handle_.param<std::string>("output_point_topic", output_point_topic_, "/points_transformed");
 		ROS_INFO("output_point_topic: %s", output_point_topic_.c_str());
 
+		// optional crop in target_frame, same as space_filter
+		node_handle_.param("lateral_removal", lateral_removal_, false);
+		node_handle_.param("left_distance", left_distance_, 5.0);
+		node_handle_.param("right_distance", right_distance_, 5.0);
+		node_handle_.param("vertical_removal", vertical_removal_, false);
+		node_handle_.param("below_distance", below_distance_, -1.5);
+		node_handle_.param("above_distance", above_distance_, 0.5);
+		ROS_INFO("lateral_removal: %d, vertical_removal: %d", lateral_removal_, vertical_removal_);
+		cloud_filter_.SetLateralRemoval(lateral_removal_, left_distance_, right_distance_);
+		cloud_filter_.SetVerticalRemoval(vertical_removal_, below_distance_, above_distance_);
+
 		ROS_INFO("Subscribing to... %s", input_point_topic_.c_str());
 		points_node_sub_ = node_handle_.subscribe(input_point_topic_, 1, &CloudTransformerNode::CloudCallback, this);
 
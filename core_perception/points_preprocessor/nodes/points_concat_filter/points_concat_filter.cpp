@@ -14,55 +14,80 @@
  * limitations under the License.
  */
 
-#include <message_filters/subscriber.h>
-#include <message_filters/sync_policies/approximate_time.h>
-#include <message_filters/synchronizer.h>
-#include <pcl/point_types.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl_ros/point_cloud.h>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
 #include <pcl_ros/transforms.h>
 #include <ros/ros.h>
 #include <sensor_msgs/PointCloud2.h>
 #include <tf/tf.h>
 #include <tf/transform_listener.h>
-#include <velodyne_pointcloud/point_types.h>
 #include <yaml-cpp/yaml.h>
 
+#include "points_preprocessor/points_concat_filter/points_concatenator.h"
+
 class PointsConcatFilter
 {
 public:
   PointsConcatFilter();
+  void run();
 
 private:
-  typedef pcl::PointXYZI PointT;
-  typedef pcl::PointCloud<PointT> PointCloudT;
   typedef sensor_msgs::PointCloud2 PointCloudMsgT;
-  typedef message_filters::sync_policies::ApproximateTime<PointCloudMsgT, PointCloudMsgT, PointCloudMsgT,
-                                                          PointCloudMsgT, PointCloudMsgT, PointCloudMsgT,
-                                                          PointCloudMsgT, PointCloudMsgT>
-      SyncPolicyT;
+
+  // minimum time between two staleness warnings of the same input [s]
+  static constexpr double STALENESS_REPORT_PERIOD = 1.0;
+  // the timeout policy checks the frame deadline this many times per timeout
+  static constexpr double DEADLINE_CHECKS_PER_TIMEOUT = 10.0;
 
   ros::NodeHandle node_handle_, private_node_handle_;
-  message_filters::Subscriber<PointCloudMsgT> *cloud_subscribers_[8];
-  message_filters::Synchronizer<SyncPolicyT> *cloud_synchronizer_;
-  ros::Subscriber config_subscriber_;
+  std::vector<ros::Subscriber> cloud_subscribers_;
   ros::Publisher cloud_publisher_;
+  ros::WallTimer deadline_timer_;
   tf::TransformListener tf_listener_;
 
   size_t input_topics_size_;
   std::string input_topics_;
   std::string output_frame_id_;
+  std::string publish_policy_;
+  double timeout_;
+  double max_staleness_;
+  bool static_transforms_;
+
+  std::unique_ptr<PointsConcatenator> concatenator_;
+  std::vector<std::string> topic_names_;
 
-  void pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
-                           const PointCloudMsgT::ConstPtr &msg3, const PointCloudMsgT::ConstPtr &msg4,
-                           const PointCloudMsgT::ConstPtr &msg5, const PointCloudMsgT::ConstPtr &msg6,
-                           const PointCloudMsgT::ConstPtr &msg7, const PointCloudMsgT::ConstPtr &msg8);
+  // sensor frame -> output frame, looked up once when static_transforms is set
+  std::mutex transform_mutex_;
+  std::map<std::string, Eigen::Matrix4f, std::less<std::string>,
+           Eigen::aligned_allocator<std::pair<const std::string, Eigen::Matrix4f> > >
+      transform_cache_;
+
+  // serializes publishing between the sensor callbacks and the deadline timer
+  std::mutex publish_mutex_;
+  std::vector<PointsConcatenator::SensorStatus> sensor_status_;
+  // time of the last staleness warning of each input, so that every topic is throttled on its own
+  std::vector<ros::WallTime> last_staleness_report_;
+
+  void pointcloud_callback(const PointCloudMsgT::ConstPtr &msg, size_t sensor);
+  void deadline_callback(const ros::WallTimerEvent &event);
+  bool lookup_transform(const std::string &frame_id, Eigen::Matrix4f &transform);
+  void publish_if_due();
+  void report_staleness();
 };
 
-PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_("~"), tf_listener_()
+PointsConcatFilter::PointsConcatFilter()
+  : node_handle_(), private_node_handle_("~"), tf_listener_()
 {
   private_node_handle_.param("input_topics", input_topics_, std::string("[/points_alpha, /points_beta]"));
   private_node_handle_.param("output_frame_id", output_frame_id_, std::string("velodyne"));
+  private_node_handle_.param("publish_policy", publish_policy_, std::string("all_arrived"));
+  private_node_handle_.param("timeout", timeout_, 0.05);
+  private_node_handle_.param("max_staleness", max_staleness_, 0.1);
+  private_node_handle_.param("static_transforms", static_transforms_, true);
 
   YAML::Node topics = YAML::Load(input_topics_);
   input_topics_size_ = topics.size();
@@ -70,74 +95,147 @@ PointsConcatFilter::PointsConcatFilter() : node_handle_(), private_node_handle_(
   {
     ROS_ERROR("The size of input_topics must be between 2 and 8");
     ros::shutdown();
+    return;
+  }
+
+  PointsConcatenator::PublishPolicy policy = PointsConcatenator::PublishPolicy::ALL_ARRIVED;
+  if (publish_policy_ == "timeout")
+  {
+    policy = PointsConcatenator::PublishPolicy::TIMEOUT;
   }
-  for (size_t i = 0; i < 8; ++i)
+  else if (publish_policy_ != "all_arrived")
   {
-    if (i < input_topics_size_)
-    {
-      cloud_subscribers_[i] =
-          new message_filters::Subscriber<PointCloudMsgT>(node_handle_, topics[i].as<std::string>(), 1);
-    }
-    else
-    {
-      cloud_subscribers_[i] =
-          new message_filters::Subscriber<PointCloudMsgT>(node_handle_, topics[0].as<std::string>(), 1);
-    }
+    ROS_WARN("Unknown publish_policy %s, using all_arrived", publish_policy_.c_str());
+  }
+  concatenator_.reset(new PointsConcatenator(input_topics_size_, output_frame_id_, policy, timeout_));
+
+  last_staleness_report_.resize(input_topics_size_);
+  for (size_t i = 0; i < input_topics_size_; ++i)
+  {
+    topic_names_.push_back(topics[i].as<std::string>());
+    cloud_subscribers_.push_back(node_handle_.subscribe<PointCloudMsgT>(
+        topic_names_[i], 1, boost::bind(&PointsConcatFilter::pointcloud_callback, this, _1, i)));
   }
-  cloud_synchronizer_ = new message_filters::Synchronizer<SyncPolicyT>(
-      SyncPolicyT(10), *cloud_subscribers_[0], *cloud_subscribers_[1], *cloud_subscribers_[2], *cloud_subscribers_[3],
-      *cloud_subscribers_[4], *cloud_subscribers_[5], *cloud_subscribers_[6], *cloud_subscribers_[7]);
-  cloud_synchronizer_->registerCallback(
-      boost::bind(&PointsConcatFilter::pointcloud_callback, this, _1, _2, _3, _4, _5, _6, _7, _8));
   cloud_publisher_ = node_handle_.advertise<PointCloudMsgT>("/points_concat", 1);
+  if (policy == PointsConcatenator::PublishPolicy::TIMEOUT)
+  {
+    // polled rather than re-armed per frame: stopping a timer waits for its running callback,
+    // which would deadlock against a sensor callback holding publish_mutex_
+    deadline_timer_ = node_handle_.createWallTimer(ros::WallDuration(timeout_ / DEADLINE_CHECKS_PER_TIMEOUT),
+                                                   &PointsConcatFilter::deadline_callback, this);
+  }
 }
 
-void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg1, const PointCloudMsgT::ConstPtr &msg2,
-                                             const PointCloudMsgT::ConstPtr &msg3, const PointCloudMsgT::ConstPtr &msg4,
-                                             const PointCloudMsgT::ConstPtr &msg5, const PointCloudMsgT::ConstPtr &msg6,
-                                             const PointCloudMsgT::ConstPtr &msg7, const PointCloudMsgT::ConstPtr &msg8)
+void PointsConcatFilter::run()
 {
-  assert(2 <= input_topics_size_ && input_topics_size_ <= 8);
-
-  PointCloudMsgT::ConstPtr msgs[8] = { msg1, msg2, msg3, msg4, msg5, msg6, msg7, msg8 };
-  PointCloudT::Ptr cloud_sources[8];
-  PointCloudT::Ptr cloud_concatenated(new PointCloudT);
+  // one thread per sensor, so that each cloud is transformed as soon as it arrives
+  ros::AsyncSpinner spinner(input_topics_size_);
+  spinner.start();
+  ros::waitForShutdown();
+}
 
-  // transform points
-  try
+bool PointsConcatFilter::lookup_transform(const std::string &frame_id, Eigen::Matrix4f &transform)
+{
+  if (static_transforms_)
   {
-    for (size_t i = 0; i < input_topics_size_; ++i)
+    std::lock_guard<std::mutex> lock(transform_mutex_);
+    auto cached = transform_cache_.find(frame_id);
+    if (cached != transform_cache_.end())
     {
-      // Note: If you use kinetic, you can directly receive messages as
-      // PointCloutT.
-      cloud_sources[i] = PointCloudT().makeShared();
-      pcl::fromROSMsg(*msgs[i], *cloud_sources[i]);
-      tf_listener_.waitForTransform(output_frame_id_, msgs[i]->header.frame_id, ros::Time(0), ros::Duration(1.0));
-      pcl_ros::transformPointCloud(output_frame_id_, ros::Time(0), *cloud_sources[i], msgs[i]->header.frame_id, *cloud_sources[i], tf_listener_);
+      transform = cached->second;
+      return true;
     }
   }
+  try
+  {
+    tf::StampedTransform stamped_transform;
+    tf_listener_.waitForTransform(output_frame_id_, frame_id, ros::Time(0), ros::Duration(1.0));
+    tf_listener_.lookupTransform(output_frame_id_, frame_id, ros::Time(0), stamped_transform);
+    pcl_ros::transformAsMatrix(stamped_transform, transform);
+  }
   catch (tf::TransformException &ex)
   {
     ROS_ERROR("%s", ex.what());
+    return false;
+  }
+  if (static_transforms_)
+  {
+    std::lock_guard<std::mutex> lock(transform_mutex_);
+    transform_cache_[frame_id] = transform;
+  }
+  return true;
+}
+
+void PointsConcatFilter::pointcloud_callback(const PointCloudMsgT::ConstPtr &msg, size_t sensor)
+{
+  Eigen::Matrix4f transform;
+  if (!lookup_transform(msg->header.frame_id, transform))
+  {
     return;
   }
+  if (!concatenator_->AddCloud(sensor, *msg, transform, ros::WallTime::now().toSec()))
+  {
+    ROS_ERROR_THROTTLE(1.0, "%s has no FLOAT32 x, y, z fields", topic_names_[sensor].c_str());
+    return;
+  }
+  publish_if_due();
+}
 
-  // merge points
-  for (size_t i = 0; i < input_topics_size_; ++i)
+void PointsConcatFilter::deadline_callback(const ros::WallTimerEvent &event)
+{
+  // IsDue publishes a partial frame once timeout has passed since its first cloud
+  publish_if_due();
+}
+
+void PointsConcatFilter::publish_if_due()
+{
+  std::lock_guard<std::mutex> lock(publish_mutex_);
+  if (!concatenator_->IsDue(ros::WallTime::now().toSec()))
   {
-    *cloud_concatenated += *cloud_sources[i];
+    return;
   }
+  if (!concatenator_->Concatenate(sensor_status_))
+  {
+    return;
+  }
+  // serialized before returning, the message is written again only after the next output
+  cloud_publisher_.publish(concatenator_->GetConcatenatedCloud());
+  report_staleness();
+}
+
+void PointsConcatFilter::report_staleness()
+{
+  const ros::WallTime now = ros::WallTime::now();
+  for (size_t i = 0; i < sensor_status_.size(); ++i)
+  {
+    const PointsConcatenator::SensorStatus &status = sensor_status_[i];
+    const bool stale = !status.has_cloud || !status.arrived || status.age > max_staleness_;
+    if (!stale || (now - last_staleness_report_[i]).toSec() < STALENESS_REPORT_PERIOD)
+    {
+      continue;
+    }
+    last_staleness_report_[i] = now;
 
-  // publsh points
-  cloud_concatenated->header = pcl_conversions::toPCL(msgs[0]->header);
-  cloud_concatenated->header.frame_id = output_frame_id_;
-  cloud_publisher_.publish(cloud_concatenated);
+    if (!status.has_cloud)
+    {
+      ROS_WARN("%s: no cloud received yet", topic_names_[i].c_str());
+    }
+    else if (!status.arrived)
+    {
+      ROS_WARN("%s: missing from %lu outputs, latest cloud is %.3f s old", topic_names_[i].c_str(),
+               static_cast<unsigned long>(status.missed_frames), status.age);
+    }
+    else
+    {
+      ROS_WARN("%s: cloud is %.3f s older than the output", topic_names_[i].c_str(), status.age);
+    }
+  }
 }
 
 int main(int argc, char **argv)
 {
   ros::init(argc, argv, "points_concat_filter");
   PointsConcatFilter node;
-  ros::spin();
+  node.run();
   return 0;
 }
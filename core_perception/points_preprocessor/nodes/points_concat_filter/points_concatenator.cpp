@@ -0,0 +1,332 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <string>
+
+#include "points_preprocessor/points_concat_filter/points_concatenator.h"
+
+namespace
+{
+bool FindField(const sensor_msgs::PointCloud2& in_cloud, const std::string& in_name, uint32_t& out_offset)
+{
+  for (const auto& field : in_cloud.fields)
+  {
+    if (field.name == in_name)
+    {
+      out_offset = field.offset;
+      return field.datatype == sensor_msgs::PointField::FLOAT32;
+    }
+  }
+  return false;
+}
+
+inline float ReadFloat(const uint8_t* in_point, uint32_t in_offset)
+{
+  float value;
+  std::memcpy(&value, in_point + in_offset, sizeof(float));
+  return value;
+}
+
+inline void WriteFloat(uint8_t* out_point, uint32_t in_offset, float in_value)
+{
+  std::memcpy(out_point + in_offset, &in_value, sizeof(float));
+}
+
+sensor_msgs::PointField MakeField(const std::string& in_name, uint32_t in_offset)
+{
+  sensor_msgs::PointField field;
+  field.name = in_name;
+  field.offset = in_offset;
+  field.datatype = sensor_msgs::PointField::FLOAT32;
+  field.count = 1;
+  return field;
+}
+}  // namespace
+
+const uint32_t PointsConcatenator::POINT_STEP;
+const uint32_t PointsConcatenator::OFFSET_X;
+const uint32_t PointsConcatenator::OFFSET_Y;
+const uint32_t PointsConcatenator::OFFSET_Z;
+const uint32_t PointsConcatenator::OFFSET_INTENSITY;
+
+PointsConcatenator::PointsConcatenator(size_t in_num_sensors, const std::string& in_output_frame_id,
+                                       PublishPolicy in_policy, double in_timeout)
+  : policy_(in_policy), timeout_(in_timeout), current_frame_(0), sensors_(in_num_sensors)
+{
+  for (auto& sensor : sensors_)
+  {
+    sensor.max_points = 0;
+    sensor.has_cloud = false;
+    sensor.missed_frames = 0;
+  }
+  for (auto& frame : frames_)
+  {
+    frame.cloud.header.frame_id = in_output_frame_id;
+    frame.cloud.fields.push_back(MakeField("x", OFFSET_X));
+    frame.cloud.fields.push_back(MakeField("y", OFFSET_Y));
+    frame.cloud.fields.push_back(MakeField("z", OFFSET_Z));
+    frame.cloud.fields.push_back(MakeField("intensity", OFFSET_INTENSITY));
+    frame.cloud.height = 1;
+    frame.cloud.is_bigendian = false;
+    frame.cloud.point_step = POINT_STEP;
+    frame.regions.resize(in_num_sensors);
+    frame.capacity = 0;
+    StartFrame(frame);
+  }
+}
+
+void PointsConcatenator::TransformCloud(const sensor_msgs::PointCloud2& in_cloud, const Eigen::Matrix4f& in_transform,
+                                        uint32_t in_offset_x, uint32_t in_offset_y, uint32_t in_offset_z,
+                                        int in_offset_intensity, uint8_t* out_data)
+{
+  const uint32_t width = in_cloud.width;
+  const uint32_t num_points = in_cloud.width * in_cloud.height;
+  const bool check_finite = !in_cloud.is_dense;
+  const float padding = 1.f;
+  for (uint32_t i = 0; i < num_points; ++i)
+  {
+    const uint8_t* in_point = &in_cloud.data[(i / width) * in_cloud.row_step + (i % width) * in_cloud.point_step];
+    uint8_t* out_point = out_data + static_cast<size_t>(i) * POINT_STEP;
+    std::memset(out_point, 0, POINT_STEP);
+    std::memcpy(out_point + OFFSET_Z + sizeof(float), &padding, sizeof(float));
+
+    float x = ReadFloat(in_point, in_offset_x);
+    float y = ReadFloat(in_point, in_offset_y);
+    float z = ReadFloat(in_point, in_offset_z);
+    // Dataset might contain NaNs and Infs, they are left untouched
+    if (!check_finite || (std::isfinite(x) && std::isfinite(y) && std::isfinite(z)))
+    {
+      const float in_x = x;
+      const float in_y = y;
+      const float in_z = z;
+      x = in_transform(0, 0) * in_x + in_transform(0, 1) * in_y + in_transform(0, 2) * in_z + in_transform(0, 3);
+      y = in_transform(1, 0) * in_x + in_transform(1, 1) * in_y + in_transform(1, 2) * in_z + in_transform(1, 3);
+      z = in_transform(2, 0) * in_x + in_transform(2, 1) * in_y + in_transform(2, 2) * in_z + in_transform(2, 3);
+    }
+    WriteFloat(out_point, OFFSET_X, x);
+    WriteFloat(out_point, OFFSET_Y, y);
+    WriteFloat(out_point, OFFSET_Z, z);
+    if (in_offset_intensity >= 0)
+    {
+      WriteFloat(out_point, OFFSET_INTENSITY, ReadFloat(in_point, in_offset_intensity));
+    }
+  }
+}
+
+void PointsConcatenator::StartFrame(FrameBuffer& io_frame)
+{
+  // room for the largest cloud seen of every sensor. Growing only zero fills the tail the last output did not use
+  size_t capacity = 0;
+  for (const auto& sensor : sensors_)
+  {
+    capacity += sensor.max_points;
+  }
+  io_frame.capacity = std::max(io_frame.capacity, capacity);
+  io_frame.cloud.data.resize(io_frame.capacity * POINT_STEP);
+  for (auto& region : io_frame.regions)
+  {
+    region.arrived = false;
+    region.overflow = false;
+    region.size = 0;
+    region.num_points = 0;
+  }
+  io_frame.fill = 0;
+  io_frame.num_arrived = 0;
+  io_frame.num_writers = 0;
+  io_frame.started = false;
+  io_frame.first_arrival_time = 0.0;
+}
+
+bool PointsConcatenator::AddCloud(size_t in_sensor, const sensor_msgs::PointCloud2& in_cloud,
+                                  const Eigen::Matrix4f& in_transform, double in_arrival_time)
+{
+  uint32_t offset_x, offset_y, offset_z, offset_intensity;
+  if (!FindField(in_cloud, "x", offset_x) || !FindField(in_cloud, "y", offset_y) ||
+      !FindField(in_cloud, "z", offset_z))
+  {
+    return false;
+  }
+  // as pcl::fromROSMsg, intensity stays 0 unless it is a FLOAT32 field
+  const int intensity = FindField(in_cloud, "intensity", offset_intensity) ? static_cast<int>(offset_intensity) : -1;
+  const uint32_t num_points = in_cloud.width * in_cloud.height;
+
+  // reserve the region, the frame cannot be closed until this writer is done
+  FrameBuffer* frame;
+  SensorRegion* region;
+  uint8_t* target;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame = &frames_[current_frame_];
+    region = &frame->regions[in_sensor];
+    if (!frame->started)
+    {
+      frame->started = true;
+      frame->first_arrival_time = in_arrival_time;
+    }
+    SensorState& sensor = sensors_[in_sensor];
+    sensor.max_points = std::max(sensor.max_points, num_points);
+
+    // a second cloud in the same frame reuses the region if it fits, otherwise the old region is left as a hole
+    if (region->overflow || num_points > region->size)
+    {
+      region->overflow = frame->fill + num_points > frame->capacity;
+      if (!region->overflow)
+      {
+        region->offset = frame->fill;
+        region->size = num_points;
+        frame->fill += num_points;
+      }
+    }
+    if (region->overflow)
+    {
+      region->overflow_data.resize(static_cast<size_t>(num_points) * POINT_STEP);
+      target = region->overflow_data.data();
+    }
+    else
+    {
+      target = frame->cloud.data.data() + region->offset * POINT_STEP;
+    }
+    ++frame->num_writers;
+  }
+
+  TransformCloud(in_cloud, in_transform, offset_x, offset_y, offset_z, intensity, target);
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    region->num_points = num_points;
+    region->stamp = in_cloud.header.stamp;
+    region->is_dense = in_cloud.is_dense;
+    if (!region->arrived)
+    {
+      region->arrived = true;
+      ++frame->num_arrived;
+    }
+    SensorState& sensor = sensors_[in_sensor];
+    sensor.has_cloud = true;
+    sensor.stamp = in_cloud.header.stamp;
+    --frame->num_writers;
+  }
+  writers_done_.notify_all();
+  return true;
+}
+
+bool PointsConcatenator::IsDue(double in_now) const
+{
+  std::lock_guard<std::mutex> lock(mutex_);
+  const FrameBuffer& frame = frames_[current_frame_];
+  if (!frame.started)
+  {
+    return false;
+  }
+  if (frame.num_arrived == sensors_.size())
+  {
+    return true;
+  }
+  return policy_ == PublishPolicy::TIMEOUT && in_now - frame.first_arrival_time >= timeout_;
+}
+
+bool PointsConcatenator::Concatenate(std::vector<SensorStatus>& out_status)
+{
+  std::unique_lock<std::mutex> lock(mutex_);
+  FrameBuffer& frame = frames_[current_frame_];
+  if (!frame.started)
+  {
+    return false;
+  }
+  // new clouds go to the other message, the last output has been published by now
+  current_frame_ = 1 - current_frame_;
+  StartFrame(frames_[current_frame_]);
+  writers_done_.wait(lock, [&frame]() { return frame.num_writers == 0; });
+  FinishFrame(frame, out_status);
+  return true;
+}
+
+void PointsConcatenator::FinishFrame(FrameBuffer& io_frame, std::vector<SensorStatus>& out_status)
+{
+  // close the holes left by missing points or replaced clouds, regions are moved down in arrival order
+  std::vector<size_t> order;
+  for (size_t i = 0; i < io_frame.regions.size(); ++i)
+  {
+    if (io_frame.regions[i].arrived && !io_frame.regions[i].overflow)
+    {
+      order.push_back(i);
+    }
+  }
+  std::sort(order.begin(), order.end(), [&io_frame](size_t a, size_t b) {
+    return io_frame.regions[a].offset < io_frame.regions[b].offset;
+  });
+  uint8_t* data = io_frame.cloud.data.data();
+  size_t num_points = 0;
+  for (size_t i : order)
+  {
+    SensorRegion& region = io_frame.regions[i];
+    if (region.offset != num_points)
+    {
+      std::memmove(data + num_points * POINT_STEP, data + region.offset * POINT_STEP,
+                   static_cast<size_t>(region.num_points) * POINT_STEP);
+      region.offset = num_points;
+    }
+    num_points += region.num_points;
+  }
+  // clouds that did not fit are appended, the next frame has room for them
+  for (auto& region : io_frame.regions)
+  {
+    if (region.arrived && region.overflow)
+    {
+      region.offset = num_points;
+      num_points += region.num_points;
+      io_frame.cloud.data.resize(num_points * POINT_STEP);
+      std::copy(region.overflow_data.begin(), region.overflow_data.begin() + region.num_points * POINT_STEP,
+                io_frame.cloud.data.begin() + region.offset * POINT_STEP);
+    }
+  }
+
+  bool is_dense = true;
+  ros::Time stamp;
+  for (const auto& region : io_frame.regions)
+  {
+    if (region.arrived)
+    {
+      is_dense = is_dense && region.is_dense;
+      stamp = std::max(stamp, region.stamp);
+    }
+  }
+  io_frame.cloud.header.stamp = stamp;
+  io_frame.cloud.width = num_points;
+  io_frame.cloud.row_step = num_points * POINT_STEP;
+  io_frame.cloud.is_dense = is_dense;
+  io_frame.cloud.data.resize(io_frame.cloud.row_step);
+
+  out_status.resize(sensors_.size());
+  for (size_t i = 0; i < sensors_.size(); ++i)
+  {
+    const SensorRegion& region = io_frame.regions[i];
+    SensorState& sensor = sensors_[i];
+    SensorStatus& status = out_status[i];
+    sensor.missed_frames = region.arrived ? 0 : sensor.missed_frames + 1;
+    status.arrived = region.arrived;
+    status.has_cloud = sensor.has_cloud;
+    // a sensor may already have delivered to the next frame
+    const ros::Time sensor_stamp = region.arrived ? region.stamp : sensor.stamp;
+    status.stamp = sensor_stamp.toSec();
+    status.age = sensor.has_cloud ? (stamp - sensor_stamp).toSec() : 0.0;
+    status.offset = region.arrived ? region.offset : 0;
+    status.num_points = region.arrived ? region.num_points : 0;
+    status.missed_frames = sensor.missed_frames;
+  }
+}
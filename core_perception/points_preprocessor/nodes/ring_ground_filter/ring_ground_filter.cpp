@@ -5,348 +5,256 @@
  * Author	: Patiphon Narksri
  *
  */
-#include <ros/ros.h>
-#include <sensor_msgs/PointCloud2.h>
-#include <pcl_ros/point_cloud.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/point_types.h>
-#include <velodyne_pointcloud/point_types.h>
-#include <opencv/cv.h>
+#include <algorithm>
+#include <cmath>
 
-enum Label
-{
-	GROUND,
-	VERTICAL,
-	UNKNOWN //Initial state, not classified
-};
-
-class GroundFilter
-{
-public:
-
-	GroundFilter();
-
-private:
-
-	ros::NodeHandle node_handle_;
-	ros::Subscriber points_node_sub_;
-	ros::Publisher groundless_points_pub_;
-	ros::Publisher ground_points_pub_;
-
-	std::string point_topic_;
-	std::string no_ground_topic, ground_topic;
-	int 		sensor_model_;
-	double 		sensor_height_;
-	double 		max_slope_;
-	double vertical_thres_;
-	bool		floor_removal_;
-
-	int 		vertical_res_;
-	int 		horizontal_res_;
-	cv::Mat 	index_map_;
-	Label 		class_label_[64];
-	double	radius_table_[64];
-
-	//boost::chrono::high_resolution_clock::time_point t1_;
-	//boost::chrono::high_resolution_clock::time_point t2_;
-	//boost::chrono::nanoseconds elap_time_;
-	ros::Time t1_;
-	ros::Time t2_;
-	ros::Duration elap_time_;
-
-	const int 	DEFAULT_HOR_RES = 2000;
-
-	void InitLabelArray(int in_model);
-	void InitRadiusTable(int in_model);
-	void InitDepthMap(int in_width);
-	void VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg);
-	void FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg,
-				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_groundless_points,
-				pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_ground_points);
-
-};
-
-GroundFilter::GroundFilter() : node_handle_("~")
-{
-	ROS_INFO("Inititalizing Ground Filter...");
-	node_handle_.param<std::string>("point_topic", point_topic_, "/points_raw");
-	ROS_INFO("Input Point Cloud: %s", point_topic_.c_str());
- 	node_handle_.param("remove_floor",  floor_removal_,  true);
- 	ROS_INFO("Floor Removal: %d", floor_removal_);
-	node_handle_.param("sensor_model", sensor_model_, 64);
-	ROS_INFO("Sensor Model: %d", sensor_model_);
-	node_handle_.param("sensor_height", sensor_height_, 1.80);
-	ROS_INFO("Sensor Height: %f", sensor_height_);
-	node_handle_.param("max_slope", max_slope_, 10.0);
-	ROS_INFO("Max Slope: %f", max_slope_);
-	node_handle_.param("vertical_thres", vertical_thres_, 0.08);
-	ROS_INFO("Vertical Threshold: %f", vertical_thres_);
-
-	node_handle_.param<std::string>("no_ground_point_topic", no_ground_topic, "/points_no_ground");
-	ROS_INFO("No Ground Output Point Cloud: %s", no_ground_topic.c_str());
-	node_handle_.param<std::string>("ground_point_topic", ground_topic, "/points_ground");
-	ROS_INFO("Only Ground Output Point Cloud: %s", ground_topic.c_str());
-
-
-	int default_horizontal_res;
-	switch(sensor_model_)
-	{
-		case 64:
-			default_horizontal_res = 2083;
-			break;
-		case 32:
-			default_horizontal_res = 2250;
-			break;
-		case 16:
-			default_horizontal_res = 1800;
-			break;
-		default:
-			default_horizontal_res = DEFAULT_HOR_RES;
-			break;
-	}
-	node_handle_.param("horizontal_res", horizontal_res_, default_horizontal_res);
-
-	points_node_sub_ = node_handle_.subscribe(point_topic_, 10000, &GroundFilter::VelodyneCallback, this);
-	groundless_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(no_ground_topic, 10000);
-	ground_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(ground_topic, 10000);
+#include <yaml-cpp/yaml.h>
 
-	vertical_res_ = sensor_model_;
-	InitLabelArray(sensor_model_);
-	InitRadiusTable(sensor_model_);
-}
+#include "points_preprocessor/ring_ground_filter/ring_ground_filter.h"
 
-void GroundFilter::InitLabelArray(int in_model)
+RingGroundFilter::RingGroundFilter(int in_vertical_res, int in_horizontal_res, double in_vertical_thres,
+			const std::vector<double> &in_radius_table) :
+	vertical_res_(in_vertical_res),
+	horizontal_res_(in_horizontal_res),
+	vertical_thres_(in_vertical_thres),
+	radius_table_(in_radius_table),
+	block_groundless_indices_(NUM_COLUMN_BLOCKS),
+	block_ground_indices_(NUM_COLUMN_BLOCKS)
 {
-	for(int a = 0; a < vertical_res_; a++)
-	{
-		class_label_[a] = UNKNOWN;
-	}
+	radius_table_.resize(vertical_res_, 0.0);
+	index_map_.resize(vertical_res_ * horizontal_res_);
 }
 
-void GroundFilter::InitRadiusTable(int in_model)
+std::vector<double> RingGroundFilter::CreateRadiusTable(int in_model, double in_sensor_height, double in_max_slope)
 {
+	std::vector<double> radius_table;
 	double a;
 	double b;
 	double theta;
 	switch (in_model)
 	{
-		case 64:
-			a = 1.0/3*M_PI/180;
-			b = max_slope_*M_PI/180;
-			for (int i = 0; i < 64; i++)
-			{
-				if (i <= 31)
-				{
-					if (i == 31) a = -a;
-					theta = (1.0/3*i - 2.0)*M_PI/180;
-					radius_table_[i] = fabs(sensor_height_*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
-				}
-				else
-				{
-					a = 0.5*M_PI/180;
-					theta = (8.83 + (0.5)*(i - 32.0))*M_PI/180;
-					radius_table_[i] = fabs(sensor_height_*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
-				}
-			}
-			break;
 		case 32:
+			radius_table.resize(32);
 			a = 4.0/3*M_PI/180;
-			b = max_slope_*M_PI/180;
+			b = in_max_slope*M_PI/180;
 			for (int i = 0; i < 32; i++)
 			{
 				theta = (-31.0/3 + (4.0/3)*i)*180/M_PI;
-				radius_table_[i] = fabs(sensor_height_*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
+				radius_table[i] = fabs(in_sensor_height*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
 			}
 			break;
 		case 16:
+			radius_table.resize(16);
 			a = 2.0*M_PI/180;
-			b = max_slope_*M_PI/180;
+			b = in_max_slope*M_PI/180;
 			for (int i = 0; i < 16; i++)
 			{
 				theta = (-30.0/2 + (2.0)*i)*180/M_PI;
-				radius_table_[i] = fabs(sensor_height_*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
+				radius_table[i] = fabs(in_sensor_height*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
 			}
 			break;
+		case 64:
 		default:
+			radius_table.resize(64);
 			a = 1.0/3*M_PI/180;
-			b = max_slope_*M_PI/180;
+			b = in_max_slope*M_PI/180;
 			for (int i = 0; i < 64; i++)
 			{
 				if (i <= 31)
 				{
 					if (i == 31) a = -a;
 					theta = (1.0/3*i - 2.0)*M_PI/180;
-					radius_table_[i] = fabs(sensor_height_*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
+					radius_table[i] = fabs(in_sensor_height*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
 				}
 				else
 				{
 					a = 0.5*M_PI/180;
 					theta = (8.83 + (0.5)*(i - 32.0))*M_PI/180;
-					radius_table_[i] = fabs(sensor_height_*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
+					radius_table[i] = fabs(in_sensor_height*(1.0/(tan(theta)+tan(b)) - 1.0/(tan(a+theta)+tan(b))));
 				}
 			}
 			break;
 	}
+	return radius_table;
 }
 
-void GroundFilter::InitDepthMap(int in_width)
+std::vector<double> RingGroundFilter::CreateRadiusTable(const std::vector<double> &in_vertical_angles,
+			double in_sensor_height, double in_max_slope)
 {
-	const int mOne = -1;
-	index_map_ = cv::Mat_<int>(vertical_res_, in_width, mOne);
+	const int vertical_res = in_vertical_angles.size();
+	std::vector<double> radius_table(vertical_res, 0.0);
+	if (vertical_res < 2)
+	{
+		return radius_table;
+	}
+
+	// row 0 is the highest ring, theta is the depression angle of the row and a the angle to the row below
+	std::vector<double> theta(vertical_res);
+	for (int i = 0; i < vertical_res; i++)
+	{
+		theta[i] = -in_vertical_angles[vertical_res - 1 - i];
+	}
+	const double b = in_max_slope*M_PI/180;
+	for (int i = 0; i < vertical_res; i++)
+	{
+		const double a = (i < vertical_res - 1) ? theta[i + 1] - theta[i] : theta[i] - theta[i - 1];
+		radius_table[i] = fabs(in_sensor_height*(1.0/(tan(theta[i])+tan(b)) - 1.0/(tan(a+theta[i])+tan(b))));
+	}
+	return radius_table;
 }
 
-void GroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg,
-			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_groundless_points,
-			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_ground_points)
+bool RingGroundFilter::LoadVerticalAngles(const std::string &in_calibration_file,
+			std::vector<double> &out_vertical_angles)
 {
-
-	velodyne_pointcloud::PointXYZIR point;
-	InitDepthMap(horizontal_res_);
-
-	for (size_t i = 0; i < in_cloud_msg->points.size(); i++)
+	out_vertical_angles.clear();
+	try
 	{
-		double u = atan2(in_cloud_msg->points[i].y,in_cloud_msg->points[i].x) * 180/M_PI;
-		if (u < 0) { u = 360 + u; }
-		int column = horizontal_res_ - (int)((double)horizontal_res_ * u / 360.0) - 1;
-		int row = vertical_res_ - 1 - in_cloud_msg->points[i].ring;
-		index_map_.at<int>(row, column) = i;
+		YAML::Node calibration = YAML::LoadFile(in_calibration_file);
+		const YAML::Node &lasers = calibration["lasers"];
+		if (!lasers || !lasers.IsSequence())
+		{
+			return false;
+		}
+		for (size_t i = 0; i < lasers.size(); i++)
+		{
+			out_vertical_angles.push_back(lasers[i]["vert_correction"].as<double>());
+		}
 	}
+	catch (const YAML::Exception &e)
+	{
+		out_vertical_angles.clear();
+		return false;
+	}
+	std::sort(out_vertical_angles.begin(), out_vertical_angles.end());
+	return !out_vertical_angles.empty();
+}
 
-	for (int i = 0; i < horizontal_res_; i++)
+void RingGroundFilter::ClassifyColumn(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &in_cloud, int in_column,
+			std::vector<int> &out_groundless_indices, std::vector<int> &out_ground_indices) const
+{
+	const int *column_map = &index_map_[in_column * vertical_res_];
+	int point_index[vertical_res_];
+	int point_index_size = 0;
+	double z_max = 0;
+	double z_min = 0;
+	double r_ref = 0;
+	for (int j = 0; j < vertical_res_; j++)
 	{
-		Label point_class[vertical_res_];
-		int point_index[vertical_res_];
-		int point_index_size = 0;
-		double z_max = 0;
-		double z_min = 0;
-		double r_ref = 0;
-		std::copy(class_label_, class_label_ + vertical_res_, point_class);
-		for (int j = 0; j < vertical_res_; j++)
+		if (column_map[j] > -1)
 		{
-			if (index_map_.at<int>(j,i) > -1 && point_class[j] == UNKNOWN)
+			const velodyne_pointcloud::PointXYZIR &point = in_cloud.points[column_map[j]];
+			double x0 = point.x;
+			double y0 = point.y;
+			double z0 = point.z;
+			double r0 = sqrt(x0*x0 + y0*y0);
+			double r_diff = fabs(r0 - r_ref);
+			if (r_diff < radius_table_[j] || r_ref == 0)
 			{
-				double x0 = in_cloud_msg->points[index_map_.at<int>(j, i)].x;
-				double y0 = in_cloud_msg->points[index_map_.at<int>(j, i)].y;
-				double z0 = in_cloud_msg->points[index_map_.at<int>(j, i)].z;
-				double r0 = sqrt(x0*x0 + y0*y0);
-				double r_diff = fabs(r0 - r_ref);
-				if (r_diff < radius_table_[j] || r_ref == 0)
-				{
-					r_ref = r0;
-					if (z0 > z_max || r_ref == 0) z_max = z0;
-					if (z0 < z_min || r_ref == 0) z_min = z0;
-					point_index[point_index_size] = j;
-					point_index_size++;
-				}
-				else
-				{
-					if (point_index_size > 1 && (z_max - z_min) > vertical_thres_)
-					{
-						for (int m = 0; m < point_index_size; m++)
-						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_groundless_points.push_back(point);
-							point_class[point_index[m]] = VERTICAL;
-						}
-						point_index_size = 0;
-					}
-					else
-					{
-						for (int m = 0; m < point_index_size; m++)
-						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_ground_points.push_back(point);
-							point_class[point_index[m]] = GROUND;
-						}
-						point_index_size = 0;
-					}
-					r_ref = r0;
-					z_max = z0;
-					z_min = z0;
-					point_index[point_index_size] = j;
-					point_index_size++;
-				}
+				r_ref = r0;
+				if (z0 > z_max || r_ref == 0) z_max = z0;
+				if (z0 < z_min || r_ref == 0) z_min = z0;
+				point_index[point_index_size] = j;
+				point_index_size++;
 			}
-			if (j == vertical_res_ - 1 && point_index_size != 0)
+			else
 			{
-					if (point_index_size > 1 && (z_max - z_min) > vertical_thres_)
-					{
-						for (int m = 0; m < point_index_size; m++)
-						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_groundless_points.push_back(point);
-							point_class[point_index[m]] = VERTICAL;
-						}
-						point_index_size = 0;
-					}
-					else
-					{
-						for (int m = 0; m < point_index_size; m++)
-						{
-							int index = index_map_.at<int>(point_index[m],i);
-							point.x = in_cloud_msg->points[index].x;
-							point.y = in_cloud_msg->points[index].y;
-							point.z = in_cloud_msg->points[index].z;
-							point.intensity = in_cloud_msg->points[index].intensity;
-							point.ring = in_cloud_msg->points[index].ring;
-							out_ground_points.push_back(point);
-							point_class[point_index[m]] = GROUND;
-						}
-						point_index_size = 0;
-					}
+				std::vector<int> &out_indices = (point_index_size > 1 && (z_max - z_min) > vertical_thres_) ?
+							out_groundless_indices : out_ground_indices;
+				for (int m = 0; m < point_index_size; m++)
+				{
+					out_indices.push_back(column_map[point_index[m]]);
+				}
+				point_index_size = 0;
+				r_ref = r0;
+				z_max = z0;
+				z_min = z0;
+				point_index[point_index_size] = j;
+				point_index_size++;
 			}
 		}
 	}
+	if (point_index_size != 0)
+	{
+		std::vector<int> &out_indices = (point_index_size > 1 && (z_max - z_min) > vertical_thres_) ?
+					out_groundless_indices : out_ground_indices;
+		for (int m = 0; m < point_index_size; m++)
+		{
+			out_indices.push_back(column_map[point_index[m]]);
+		}
+	}
 }
 
-void GroundFilter::VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg)
+void RingGroundFilter::CopyPoints(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &in_cloud,
+			const std::vector<std::vector<int> > &in_block_indices,
+			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_cloud) const
 {
-
-	//t1_ = ros::Time().now();
-	pcl::PointCloud<velodyne_pointcloud::PointXYZIR> vertical_points;
-	pcl::PointCloud<velodyne_pointcloud::PointXYZIR> ground_points;
-	vertical_points.header = in_cloud_msg->header;
-	ground_points.header = in_cloud_msg->header;
-	vertical_points.clear();
-	ground_points.clear();
-
-	FilterGround(in_cloud_msg, vertical_points, ground_points);
-
-	if (!floor_removal_)
+	std::vector<size_t> offsets(in_block_indices.size() + 1, 0);
+	for (size_t b = 0; b < in_block_indices.size(); b++)
 	{
-		vertical_points = *in_cloud_msg;
+		offsets[b + 1] = offsets[b] + in_block_indices[b].size();
 	}
+	out_cloud.points.resize(offsets.back());
+	out_cloud.width = out_cloud.points.size();
+	out_cloud.height = 1;
 
-	groundless_points_pub_.publish(vertical_points);
-	ground_points_pub_.publish(ground_points);
-	//t2_ = boost::chrono::high_resolution_clock::now();
-	//t2_ = ros::Time().now();
-	//elap_time_ = t2_ - t1_;//boost::chrono::duration_cast<boost::chrono::nanoseconds>(t2_-t1_);
-	//std::cout << "Computational Time for one frame: " << elap_time_ << '\n';
+	#pragma omp parallel for
+	for (int b = 0; b < (int)in_block_indices.size(); b++)
+	{
+		for (size_t m = 0; m < in_block_indices[b].size(); m++)
+		{
+			out_cloud.points[offsets[b] + m] = in_cloud.points[in_block_indices[b][m]];
+		}
+	}
 }
 
-int main(int argc, char **argv)
+void RingGroundFilter::FilterGround(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &in_cloud,
+			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_groundless_points,
+			pcl::PointCloud<velodyne_pointcloud::PointXYZIR> &out_ground_points)
 {
+	const int num_points = in_cloud.points.size();
+	point_cells_.resize(num_points);
+
+	#pragma omp parallel for
+	for (int i = 0; i < num_points; i++)
+	{
+		const velodyne_pointcloud::PointXYZIR &point = in_cloud.points[i];
+		double u = atan2(point.y, point.x) * 180/M_PI;
+		if (u < 0) { u = 360 + u; }
+		int column = horizontal_res_ - (int)((double)horizontal_res_ * u / 360.0) - 1;
+		int row = vertical_res_ - 1 - point.ring;
+		if (column < 0 || column >= horizontal_res_ || row < 0 || row >= vertical_res_)
+		{
+			point_cells_[i] = -1;
+			continue;
+		}
+		point_cells_[i] = column * vertical_res_ + row;
+	}
 
-	ros::init(argc, argv, "ring_ground_filter");
-	GroundFilter node;
-	ros::spin();
+	// serial so that the last point falling in a cell wins, as in the range image
+	std::fill(index_map_.begin(), index_map_.end(), -1);
+	for (int i = 0; i < num_points; i++)
+	{
+		if (point_cells_[i] > -1)
+		{
+			index_map_[point_cells_[i]] = i;
+		}
+	}
 
-	return 0;
+	const int columns_per_block = (horizontal_res_ + NUM_COLUMN_BLOCKS - 1) / NUM_COLUMN_BLOCKS;
+	#pragma omp parallel for schedule(dynamic)
+	for (int b = 0; b < NUM_COLUMN_BLOCKS; b++)
+	{
+		std::vector<int> &groundless_indices = block_groundless_indices_[b];
+		std::vector<int> &ground_indices = block_ground_indices_[b];
+		groundless_indices.clear();
+		ground_indices.clear();
+		const int column_end = std::min(horizontal_res_, (b + 1) * columns_per_block);
+		for (int i = b * columns_per_block; i < column_end; i++)
+		{
+			ClassifyColumn(in_cloud, i, groundless_indices, ground_indices);
+		}
+	}
 
+	CopyPoints(in_cloud, block_groundless_indices_, out_groundless_points);
+	CopyPoints(in_cloud, block_ground_indices_, out_ground_points);
 }
@@ -0,0 +1,152 @@
+/*
+ * ring_ground_filter_node.cpp
+ *
+ * Created on	: June 5, 2018
+ * Author	: Patiphon Narksri
+ *
+ */
+#include <memory>
+
+#include <ros/ros.h>
+#include <sensor_msgs/PointCloud2.h>
+#include <pcl_ros/point_cloud.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <pcl/point_types.h>
+#include <velodyne_pointcloud/point_types.h>
+
+#include "points_preprocessor/ring_ground_filter/ring_ground_filter.h"
+
+class GroundFilter
+{
+public:
+
+	GroundFilter();
+
+private:
+
+	ros::NodeHandle node_handle_;
+	ros::Subscriber points_node_sub_;
+	ros::Publisher groundless_points_pub_;
+	ros::Publisher ground_points_pub_;
+
+	std::string point_topic_;
+	std::string no_ground_topic, ground_topic;
+	std::string calibration_file_;
+	int 		sensor_model_;
+	double 		sensor_height_;
+	double 		max_slope_;
+	double vertical_thres_;
+	bool		floor_removal_;
+
+	int 		vertical_res_;
+	int 		horizontal_res_;
+
+	std::unique_ptr<RingGroundFilter> ring_ground_filter_;
+
+	const int 	DEFAULT_HOR_RES = 2000;
+
+	void VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg);
+
+};
+
+GroundFilter::GroundFilter() : node_handle_("~")
+{
+	ROS_INFO("Inititalizing Ground Filter...");
+	node_handle_.param<std::string>("point_topic", point_topic_, "/points_raw");
+	ROS_INFO("Input Point Cloud: %s", point_topic_.c_str());
+ 	node_handle_.param("remove_floor",  floor_removal_,  true);
+ 	ROS_INFO("Floor Removal: %d", floor_removal_);
+	node_handle_.param("sensor_model", sensor_model_, 64);
+	ROS_INFO("Sensor Model: %d", sensor_model_);
+	node_handle_.param("sensor_height", sensor_height_, 1.80);
+	ROS_INFO("Sensor Height: %f", sensor_height_);
+	node_handle_.param("max_slope", max_slope_, 10.0);
+	ROS_INFO("Max Slope: %f", max_slope_);
+	node_handle_.param("vertical_thres", vertical_thres_, 0.08);
+	ROS_INFO("Vertical Threshold: %f", vertical_thres_);
+	node_handle_.param<std::string>("calibration_file", calibration_file_, "");
+	ROS_INFO("Calibration File: %s", calibration_file_.c_str());
+
+	node_handle_.param<std::string>("no_ground_point_topic", no_ground_topic, "/points_no_ground");
+	ROS_INFO("No Ground Output Point Cloud: %s", no_ground_topic.c_str());
+	node_handle_.param<std::string>("ground_point_topic", ground_topic, "/points_ground");
+	ROS_INFO("Only Ground Output Point Cloud: %s", ground_topic.c_str());
+
+
+	int default_horizontal_res;
+	switch(sensor_model_)
+	{
+		case 64:
+			default_horizontal_res = 2083;
+			break;
+		case 32:
+			default_horizontal_res = 2250;
+			break;
+		case 16:
+			default_horizontal_res = 1800;
+			break;
+		default:
+			default_horizontal_res = DEFAULT_HOR_RES;
+			break;
+	}
+	node_handle_.param("horizontal_res", horizontal_res_, default_horizontal_res);
+
+	std::vector<double> radius_table;
+	if (!calibration_file_.empty())
+	{
+		std::vector<double> vertical_angles;
+		if (!RingGroundFilter::LoadVerticalAngles(calibration_file_, vertical_angles))
+		{
+			ROS_ERROR("Could not read vert_correction of the lasers from %s", calibration_file_.c_str());
+			return;
+		}
+		radius_table = RingGroundFilter::CreateRadiusTable(vertical_angles, sensor_height_, max_slope_);
+	}
+	else
+	{
+		radius_table = RingGroundFilter::CreateRadiusTable(sensor_model_, sensor_height_, max_slope_);
+	}
+
+	if ((int)radius_table.size() != sensor_model_)
+	{
+		ROS_ERROR("Sensor Model %d has %d lasers in the radius table, set calibration_file for this model",
+					sensor_model_, (int)radius_table.size());
+		return;
+	}
+
+	vertical_res_ = sensor_model_;
+	ring_ground_filter_.reset(new RingGroundFilter(vertical_res_, horizontal_res_, vertical_thres_, radius_table));
+
+	points_node_sub_ = node_handle_.subscribe(point_topic_, 10000, &GroundFilter::VelodyneCallback, this);
+	groundless_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(no_ground_topic, 10000);
+	ground_points_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>(ground_topic, 10000);
+}
+
+void GroundFilter::VelodyneCallback(const pcl::PointCloud<velodyne_pointcloud::PointXYZIR>::ConstPtr &in_cloud_msg)
+{
+	pcl::PointCloud<velodyne_pointcloud::PointXYZIR> vertical_points;
+	pcl::PointCloud<velodyne_pointcloud::PointXYZIR> ground_points;
+	vertical_points.header = in_cloud_msg->header;
+	ground_points.header = in_cloud_msg->header;
+
+	ring_ground_filter_->FilterGround(*in_cloud_msg, vertical_points, ground_points);
+
+	if (!floor_removal_)
+	{
+		vertical_points = *in_cloud_msg;
+	}
+
+	groundless_points_pub_.publish(vertical_points);
+	ground_points_pub_.publish(ground_points);
+}
+
+int main(int argc, char **argv)
+{
+
+	ros::init(argc, argv, "ring_ground_filter");
+	GroundFilter node;
+	ros::spin();
+
+	return 0;
+
+}
@@ -5,12 +5,10 @@
  *      Author: ne0
  */
 #include <ros/ros.h>
-#include <pcl_conversions/pcl_conversions.h>
-#include <pcl/filters/extract_indices.h>
-#include <sensor_msgs/point_cloud_conversion.h>
-#include <sensor_msgs/PointCloud.h>
 #include <sensor_msgs/PointCloud2.h>
 
+#include "points_preprocessor/cloud_transformer/cloud_transform_filter.h"
+
 
 class SpaceFilter
 {
@@ -33,15 +31,10 @@ private:
 	double 			below_distance_;
 	double 			above_distance_;
 
-	void VelodyneCallback(const sensor_msgs::PointCloud2::Ptr& in_sensor_cloud_ptr);
-	void KeepLanes(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-							pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
-							float in_left_lane_threshold,
-							float in_right_lane_threshold);
-	void ClipCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-							pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
-							float in_min_height,
-							float in_max_height);
+	CloudTransformFilter	cloud_filter_;
+	sensor_msgs::PointCloud2	clipped_cloud_;
+
+	void VelodyneCallback(const sensor_msgs::PointCloud2::ConstPtr& in_sensor_cloud_ptr);
 };
 
 SpaceFilter::SpaceFilter() :
@@ -58,85 +51,22 @@ SpaceFilter::SpaceFilter() :
 	node_handle_.param("below_distance",  below_distance_,  -1.5);
 	node_handle_.param("above_distance",  above_distance_,  0.5);
 
+	cloud_filter_.SetLateralRemoval(lateral_removal_, left_distance_, right_distance_);
+	cloud_filter_.SetVerticalRemoval(vertical_removal_, below_distance_, above_distance_);
+
 	cloud_sub_ = node_handle_.subscribe(subscribe_topic_, 10, &SpaceFilter::VelodyneCallback, this);
 	cloud_pub_ = node_handle_.advertise<sensor_msgs::PointCloud2>( "/points_clipped", 10);
 }
 
-void SpaceFilter::KeepLanes(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-		pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
-		float in_left_lane_threshold,
-		float in_right_lane_threshold)
-{
-	pcl::PointIndices::Ptr far_indices (new pcl::PointIndices);
-	for(unsigned int i=0; i< in_cloud_ptr->points.size(); i++)
-	{
-		pcl::PointXYZ current_point;
-		current_point.x=in_cloud_ptr->points[i].x;
-		current_point.y=in_cloud_ptr->points[i].y;
-		current_point.z=in_cloud_ptr->points[i].z;
-
-		if (
-			current_point.y > (in_left_lane_threshold) || current_point.y < -1.0*in_right_lane_threshold
-		)
-		{
-			far_indices->indices.push_back(i);
-		}
-	}
-	out_cloud_ptr->points.clear();
-	pcl::ExtractIndices<pcl::PointXYZ> extract;
-	extract.setInputCloud (in_cloud_ptr);
-	extract.setIndices(far_indices);
-	extract.setNegative(true);//true removes the indices, false leaves only the indices
-	extract.filter(*out_cloud_ptr);
-}
-
-void SpaceFilter::ClipCloud(const pcl::PointCloud<pcl::PointXYZ>::Ptr in_cloud_ptr,
-		pcl::PointCloud<pcl::PointXYZ>::Ptr out_cloud_ptr,
-		float in_min_height,
-		float in_max_height)
+void SpaceFilter::VelodyneCallback(const sensor_msgs::PointCloud2::ConstPtr& in_sensor_cloud_ptr)
 {
-	out_cloud_ptr->points.clear();
-	for (unsigned int i=0; i<in_cloud_ptr->points.size(); i++)
-	{
-		if (in_cloud_ptr->points[i].z >= in_min_height &&
-				in_cloud_ptr->points[i].z <= in_max_height)
-		{
-			out_cloud_ptr->points.push_back(in_cloud_ptr->points[i]);
-		}
-	}
-}
-
-void SpaceFilter::VelodyneCallback(const sensor_msgs::PointCloud2::Ptr& in_sensor_cloud_ptr)
-{
-	pcl::PointCloud<pcl::PointXYZ>::Ptr current_sensor_cloud_ptr (new pcl::PointCloud<pcl::PointXYZ>);
-	pcl::PointCloud<pcl::PointXYZ>::Ptr inlanes_cloud_ptr (new pcl::PointCloud<pcl::PointXYZ>);
-	pcl::PointCloud<pcl::PointXYZ>::Ptr clipped_cloud_ptr (new pcl::PointCloud<pcl::PointXYZ>);
-
-	pcl::fromROSMsg(*in_sensor_cloud_ptr, *current_sensor_cloud_ptr);
-
-	if (lateral_removal_)
-	{
-		KeepLanes(current_sensor_cloud_ptr, inlanes_cloud_ptr, left_distance_, right_distance_);
-	}
-	else
-	{
-		inlanes_cloud_ptr = current_sensor_cloud_ptr;
-	}
-	if (vertical_removal_)
-	{
-		ClipCloud(inlanes_cloud_ptr, clipped_cloud_ptr, below_distance_, above_distance_);
-	}
-	else
+	// crops directly on the message buffer, all the fields of the input are kept
+	if (!cloud_filter_.Apply(*in_sensor_cloud_ptr, clipped_cloud_))
 	{
-		clipped_cloud_ptr = inlanes_cloud_ptr;
+		ROS_ERROR("space_filter: input cloud has no FLOAT32 x, y, z fields.");
+		return;
 	}
-
-	sensor_msgs::PointCloud2 cloud_msg;
-
-	pcl::toROSMsg(*clipped_cloud_ptr, cloud_msg);
-
-	cloud_msg.header=in_sensor_cloud_ptr->header;
-	cloud_pub_.publish(cloud_msg);
+	cloud_pub_.publish(clipped_cloud_);
 }
 
 int main(int argc, char **argv)
@@ -148,7 +78,3 @@ int main(int argc, char **argv)
 
 	return 0;
 }
-
-
-
-
@@ -0,0 +1,303 @@
+/*
+ * test_cloud_transform_filter.cpp
+ *
+ * Compares CloudTransformFilter with the per point transform of cloud_transformer and the lane/height crop of
+ * space_filter it replaced, and measures the time per frame of transform and transform + crop.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <gtest/gtest.h>
+
+#include "points_preprocessor/cloud_transformer/cloud_transform_filter.h"
+
+// same memory layout as velodyne_pointcloud::PointXYZIR
+struct PointXYZIR
+{
+	float x;
+	float y;
+	float z;
+	float padding;
+	float intensity;
+	uint16_t ring;
+};
+
+sensor_msgs::PointField MakeField(const std::string &name, uint32_t offset, uint8_t datatype)
+{
+	sensor_msgs::PointField field;
+	field.name = name;
+	field.offset = offset;
+	field.datatype = datatype;
+	field.count = 1;
+	return field;
+}
+
+sensor_msgs::PointCloud2 ToMsg(const std::vector<PointXYZIR> &in_points, bool in_is_dense)
+{
+	sensor_msgs::PointCloud2 cloud;
+	cloud.header.frame_id = "velodyne";
+	cloud.fields.push_back(MakeField("x", offsetof(PointXYZIR, x), sensor_msgs::PointField::FLOAT32));
+	cloud.fields.push_back(MakeField("y", offsetof(PointXYZIR, y), sensor_msgs::PointField::FLOAT32));
+	cloud.fields.push_back(MakeField("z", offsetof(PointXYZIR, z), sensor_msgs::PointField::FLOAT32));
+	cloud.fields.push_back(MakeField("intensity", offsetof(PointXYZIR, intensity), sensor_msgs::PointField::FLOAT32));
+	cloud.fields.push_back(MakeField("ring", offsetof(PointXYZIR, ring), sensor_msgs::PointField::UINT16));
+	cloud.height = 1;
+	cloud.width = in_points.size();
+	cloud.point_step = sizeof(PointXYZIR);
+	cloud.row_step = cloud.width * cloud.point_step;
+	cloud.is_dense = in_is_dense;
+	cloud.data.resize(cloud.row_step);
+	std::memcpy(cloud.data.data(), in_points.data(), cloud.data.size());
+	return cloud;
+}
+
+std::vector<PointXYZIR> FromMsg(const sensor_msgs::PointCloud2 &in_cloud)
+{
+	std::vector<PointXYZIR> points(in_cloud.width * in_cloud.height);
+	std::memcpy(points.data(), in_cloud.data.data(), points.size() * sizeof(PointXYZIR));
+	return points;
+}
+
+// transform of cloud_transformer, NaNs and Infs are kept as they are
+void TransformReference(const std::vector<PointXYZIR> &in_points, const Eigen::Matrix4f &transform,
+			bool in_is_dense, std::vector<PointXYZIR> &out_points)
+{
+	out_points = in_points;
+	for (size_t i = 0; i < out_points.size(); ++i)
+	{
+		if (!in_is_dense && (!std::isfinite(in_points[i].x) || !std::isfinite(in_points[i].y) ||
+					!std::isfinite(in_points[i].z)))
+			{continue;}
+		Eigen::Matrix<float, 3, 1> pt (in_points[i].x, in_points[i].y, in_points[i].z);
+		out_points[i].x = static_cast<float> (transform (0, 0) * pt.coeffRef (0) +
+							transform (0, 1) * pt.coeffRef (1) +
+							transform (0, 2) * pt.coeffRef (2) +
+							transform (0, 3));
+		out_points[i].y = static_cast<float> (transform (1, 0) * pt.coeffRef (0) +
+							transform (1, 1) * pt.coeffRef (1) +
+							transform (1, 2) * pt.coeffRef (2) +
+							transform (1, 3));
+		out_points[i].z = static_cast<float> (transform (2, 0) * pt.coeffRef (0) +
+							transform (2, 1) * pt.coeffRef (1) +
+							transform (2, 2) * pt.coeffRef (2) +
+							transform (2, 3));
+	}
+}
+
+// KeepLanes followed by ClipCloud of space_filter
+void CropReference(const std::vector<PointXYZIR> &in_points, float in_left_lane_threshold,
+			float in_right_lane_threshold, float in_min_height, float in_max_height,
+			std::vector<PointXYZIR> &out_points)
+{
+	std::vector<PointXYZIR> inlanes_points;
+	for (size_t i = 0; i < in_points.size(); i++)
+	{
+		if (!(in_points[i].y > (in_left_lane_threshold) || in_points[i].y < -1.0*in_right_lane_threshold))
+		{
+			inlanes_points.push_back(in_points[i]);
+		}
+	}
+	out_points.clear();
+	for (size_t i = 0; i < inlanes_points.size(); i++)
+	{
+		if (inlanes_points[i].z >= in_min_height && inlanes_points[i].z <= in_max_height)
+		{
+			out_points.push_back(inlanes_points[i]);
+		}
+	}
+}
+
+std::vector<PointXYZIR> MakeScan(int in_vertical_res, int in_horizontal_res)
+{
+	std::vector<PointXYZIR> points;
+	points.reserve(in_vertical_res * in_horizontal_res);
+	for (int c = 0; c < in_horizontal_res; c++)
+	{
+		const double azimuth = 2 * M_PI * c / in_horizontal_res;
+		for (int r = 0; r < in_vertical_res; r++)
+		{
+			const double elevation = (-25.0 + 40.0 * r / (in_vertical_res - 1)) * M_PI / 180;
+			const double range = 2.0 + (c * 7 + r * 13) % 60;
+			PointXYZIR point;
+			point.x = range * cos(elevation) * cos(azimuth);
+			point.y = range * cos(elevation) * sin(azimuth);
+			point.z = range * sin(elevation);
+			point.padding = 1.f;
+			point.intensity = (c + r) % 256;
+			point.ring = r;
+			points.push_back(point);
+		}
+	}
+	return points;
+}
+
+Eigen::Matrix4f MakeTransform()
+{
+	Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+	const float yaw = 0.3f;
+	const float pitch = 0.05f;
+	transform.block<3, 3>(0, 0) = (Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ()) *
+				Eigen::AngleAxisf(pitch, Eigen::Vector3f::UnitY())).toRotationMatrix();
+	transform(0, 3) = 1.2f;
+	transform(1, 3) = -0.3f;
+	transform(2, 3) = 1.9f;
+	return transform;
+}
+
+void ExpectSamePoints(const std::vector<PointXYZIR> &expected, const std::vector<PointXYZIR> &actual)
+{
+	ASSERT_EQ(expected.size(), actual.size());
+	// bitwise, so that untouched NaNs compare equal
+	for (size_t i = 0; i < expected.size(); i++)
+	{
+		EXPECT_EQ(0, std::memcmp(&expected[i].x, &actual[i].x, sizeof(float))) << "point " << i;
+		EXPECT_EQ(0, std::memcmp(&expected[i].y, &actual[i].y, sizeof(float))) << "point " << i;
+		EXPECT_EQ(0, std::memcmp(&expected[i].z, &actual[i].z, sizeof(float))) << "point " << i;
+		EXPECT_EQ(expected[i].intensity, actual[i].intensity);
+		EXPECT_EQ(expected[i].ring, actual[i].ring);
+	}
+}
+
+TEST(CloudTransformFilter, sameTransformAsCloudTransformer)
+{
+	std::vector<PointXYZIR> points = MakeScan(32, 1800);
+	points[10].x = std::numeric_limits<float>::quiet_NaN();
+	points[20].z = std::numeric_limits<float>::infinity();
+	const Eigen::Matrix4f transform = MakeTransform();
+
+	CloudTransformFilter filter;
+	filter.SetTransform(transform);
+	for (int is_dense = 0; is_dense < 2; is_dense++)
+	{
+		std::vector<PointXYZIR> expected;
+		TransformReference(points, transform, is_dense, expected);
+		const sensor_msgs::PointCloud2 in_cloud = ToMsg(points, is_dense);
+		sensor_msgs::PointCloud2 out_cloud;
+		ASSERT_TRUE(filter.Apply(in_cloud, out_cloud));
+		EXPECT_EQ(in_cloud.width, out_cloud.width);
+		EXPECT_EQ(in_cloud.height, out_cloud.height);
+		EXPECT_EQ(in_cloud.fields.size(), out_cloud.fields.size());
+		if (is_dense)
+		{
+			// NaNs are transformed too, only compare the finite points
+			expected.erase(expected.begin() + 20);
+			expected.erase(expected.begin() + 10);
+			std::vector<PointXYZIR> actual = FromMsg(out_cloud);
+			actual.erase(actual.begin() + 20);
+			actual.erase(actual.begin() + 10);
+			ExpectSamePoints(expected, actual);
+		}
+		else
+		{
+			ExpectSamePoints(expected, FromMsg(out_cloud));
+		}
+	}
+}
+
+TEST(CloudTransformFilter, sameCropAsSpaceFilter)
+{
+	const std::vector<PointXYZIR> points = MakeScan(64, 2000);
+	CloudTransformFilter filter;
+	filter.SetLateralRemoval(true, 5.0, 4.0);
+	filter.SetVerticalRemoval(true, -1.5, 0.5);
+
+	std::vector<PointXYZIR> expected;
+	CropReference(points, 5.0, 4.0, -1.5, 0.5, expected);
+	sensor_msgs::PointCloud2 out_cloud;
+	ASSERT_TRUE(filter.Apply(ToMsg(points, true), out_cloud));
+	EXPECT_GT(out_cloud.width, 0u);
+	EXPECT_LT(out_cloud.width, points.size());
+	EXPECT_EQ(out_cloud.width * out_cloud.point_step, out_cloud.row_step);
+	ExpectSamePoints(expected, FromMsg(out_cloud));
+
+	// the output buffer is reused for a smaller cloud
+	const std::vector<PointXYZIR> small_points(points.begin(), points.begin() + 100);
+	CropReference(small_points, 5.0, 4.0, -1.5, 0.5, expected);
+	ASSERT_TRUE(filter.Apply(ToMsg(small_points, true), out_cloud));
+	ExpectSamePoints(expected, FromMsg(out_cloud));
+}
+
+TEST(CloudTransformFilter, cropAfterTransform)
+{
+	const std::vector<PointXYZIR> points = MakeScan(32, 1800);
+	const Eigen::Matrix4f transform = MakeTransform();
+	CloudTransformFilter filter;
+	filter.SetTransform(transform);
+	filter.SetLateralRemoval(true, 6.0, 6.0);
+	filter.SetVerticalRemoval(true, 0.2, 2.5);
+
+	std::vector<PointXYZIR> transformed, expected;
+	TransformReference(points, transform, true, transformed);
+	CropReference(transformed, 6.0, 6.0, 0.2, 2.5, expected);
+	sensor_msgs::PointCloud2 out_cloud;
+	ASSERT_TRUE(filter.Apply(ToMsg(points, true), out_cloud));
+	ExpectSamePoints(expected, FromMsg(out_cloud));
+}
+
+TEST(CloudTransformFilter, rejectsCloudWithoutXYZ)
+{
+	sensor_msgs::PointCloud2 in_cloud = ToMsg(MakeScan(16, 10), true);
+	in_cloud.fields[2].datatype = sensor_msgs::PointField::FLOAT64;
+	sensor_msgs::PointCloud2 out_cloud;
+	CloudTransformFilter filter;
+	EXPECT_FALSE(filter.Apply(in_cloud, out_cloud));
+}
+
+TEST(CloudTransformFilter, benchmark)
+{
+	const int num_frames = 20;
+	const int models[] = { 32, 64, 128 };
+	const Eigen::Matrix4f transform = MakeTransform();
+	for (int m = 0; m < 3; m++)
+	{
+		const std::vector<PointXYZIR> points = MakeScan(models[m], 2000);
+		const sensor_msgs::PointCloud2 in_cloud = ToMsg(points, true);
+		CloudTransformFilter transform_filter;
+		transform_filter.SetTransform(transform);
+		CloudTransformFilter crop_filter;
+		crop_filter.SetTransform(transform);
+		crop_filter.SetLateralRemoval(true, 5.0, 5.0);
+		crop_filter.SetVerticalRemoval(true, -1.5, 0.5);
+		sensor_msgs::PointCloud2 out_cloud;
+
+		std::chrono::duration<double, std::milli> reference_time(0);
+		std::chrono::duration<double, std::milli> transform_time(0);
+		std::chrono::duration<double, std::milli> crop_time(0);
+		for (int f = 0; f < num_frames; f++)
+		{
+			// the serial path also decodes the message into points and encodes the result
+			auto start = std::chrono::steady_clock::now();
+			std::vector<PointXYZIR> transformed, cropped;
+			TransformReference(FromMsg(in_cloud), transform, true, transformed);
+			CropReference(transformed, 5.0, 5.0, -1.5, 0.5, cropped);
+			const sensor_msgs::PointCloud2 reference_cloud = ToMsg(cropped, true);
+			reference_time += std::chrono::steady_clock::now() - start;
+
+			start = std::chrono::steady_clock::now();
+			transform_filter.Apply(in_cloud, out_cloud);
+			transform_time += std::chrono::steady_clock::now() - start;
+
+			start = std::chrono::steady_clock::now();
+			crop_filter.Apply(in_cloud, out_cloud);
+			crop_time += std::chrono::steady_clock::now() - start;
+
+			ASSERT_EQ(reference_cloud.width, out_cloud.width);
+		}
+		std::cout << models[m] << " beams, " << points.size() << " points per frame [ms] serial transform + crop: "
+					<< reference_time.count() / num_frames << ", CloudTransformFilter transform: "
+					<< transform_time.count() / num_frames << ", transform + crop: "
+					<< crop_time.count() / num_frames << std::endl;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,386 @@
+/*
+ * test_points_concatenator.cpp
+ *
+ * Compares PointsConcatenator with the convert, transform and append concatenation it replaced,
+ * checks the publish policies and measures latency and throughput for 8 synthetic sensor streams.
+ */
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <gtest/gtest.h>
+
+#include "points_preprocessor/points_concat_filter/points_concatenator.h"
+
+// same memory layout as velodyne_pointcloud::PointXYZIR
+struct PointXYZIR
+{
+  float x;
+  float y;
+  float z;
+  float padding;
+  float intensity;
+  uint16_t ring;
+};
+
+struct PointXYZI
+{
+  float x;
+  float y;
+  float z;
+  float intensity;
+};
+
+sensor_msgs::PointField MakeField(const std::string &name, uint32_t offset, uint8_t datatype)
+{
+  sensor_msgs::PointField field;
+  field.name = name;
+  field.offset = offset;
+  field.datatype = datatype;
+  field.count = 1;
+  return field;
+}
+
+sensor_msgs::PointCloud2 MakeSensorCloud(int sensor, int vertical_res, int horizontal_res, double stamp)
+{
+  std::vector<PointXYZIR> points;
+  points.reserve(vertical_res * horizontal_res);
+  for (int c = 0; c < horizontal_res; c++)
+  {
+    const double azimuth = 2 * M_PI * c / horizontal_res;
+    for (int r = 0; r < vertical_res; r++)
+    {
+      const double elevation = (-15.0 + 30.0 * r / (vertical_res - 1)) * M_PI / 180;
+      const double range = 1.0 + (c * 7 + r * 13 + sensor * 5) % 50;
+      PointXYZIR point;
+      point.x = range * cos(elevation) * cos(azimuth);
+      point.y = range * cos(elevation) * sin(azimuth);
+      point.z = range * sin(elevation);
+      point.padding = 1.f;
+      point.intensity = (c + r + sensor) % 256;
+      point.ring = r;
+      points.push_back(point);
+    }
+  }
+
+  sensor_msgs::PointCloud2 cloud;
+  cloud.header.frame_id = "lidar" + std::to_string(sensor);
+  cloud.header.stamp.fromSec(stamp);
+  cloud.fields.push_back(MakeField("x", offsetof(PointXYZIR, x), sensor_msgs::PointField::FLOAT32));
+  cloud.fields.push_back(MakeField("y", offsetof(PointXYZIR, y), sensor_msgs::PointField::FLOAT32));
+  cloud.fields.push_back(MakeField("z", offsetof(PointXYZIR, z), sensor_msgs::PointField::FLOAT32));
+  cloud.fields.push_back(MakeField("intensity", offsetof(PointXYZIR, intensity), sensor_msgs::PointField::FLOAT32));
+  cloud.fields.push_back(MakeField("ring", offsetof(PointXYZIR, ring), sensor_msgs::PointField::UINT16));
+  cloud.height = 1;
+  cloud.width = points.size();
+  cloud.point_step = sizeof(PointXYZIR);
+  cloud.row_step = cloud.width * cloud.point_step;
+  cloud.is_dense = true;
+  cloud.data.resize(cloud.row_step);
+  std::memcpy(cloud.data.data(), points.data(), cloud.data.size());
+  return cloud;
+}
+
+Eigen::Matrix4f MakeSensorTransform(int sensor)
+{
+  // sensors on a ring around the vehicle, looking outwards
+  const float yaw = sensor * M_PI / 4;
+  Eigen::Matrix4f transform = Eigen::Matrix4f::Identity();
+  transform.block<3, 3>(0, 0) = Eigen::AngleAxisf(yaw, Eigen::Vector3f::UnitZ()).toRotationMatrix();
+  transform(0, 3) = 2.0f * std::cos(yaw);
+  transform(1, 3) = 1.0f * std::sin(yaw);
+  transform(2, 3) = 1.5f + 0.1f * sensor;
+  return transform;
+}
+
+// fromROSMsg, transformPointCloud and += of the previous points_concat_filter
+void ConcatenateReference(const std::vector<sensor_msgs::PointCloud2> &clouds,
+                          const std::vector<Eigen::Matrix4f> &transforms, std::vector<PointXYZI> &out_points)
+{
+  out_points.clear();
+  for (size_t i = 0; i < clouds.size(); ++i)
+  {
+    std::vector<PointXYZI> source(clouds[i].width * clouds[i].height);
+    for (size_t j = 0; j < source.size(); ++j)
+    {
+      PointXYZIR point;
+      std::memcpy(&point, &clouds[i].data[j * clouds[i].point_step], sizeof(PointXYZIR));
+      source[j].x = point.x;
+      source[j].y = point.y;
+      source[j].z = point.z;
+      source[j].intensity = point.intensity;
+    }
+    const Eigen::Affine3f transform(transforms[i]);
+    for (auto &point : source)
+    {
+      const Eigen::Vector3f transformed = transform * Eigen::Vector3f(point.x, point.y, point.z);
+      point.x = transformed.x();
+      point.y = transformed.y();
+      point.z = transformed.z();
+    }
+    out_points.insert(out_points.end(), source.begin(), source.end());
+  }
+}
+
+std::vector<PointXYZI> FromMsg(const sensor_msgs::PointCloud2 &cloud)
+{
+  std::vector<PointXYZI> points(cloud.width * cloud.height);
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    const uint8_t *point = &cloud.data[i * cloud.point_step];
+    std::memcpy(&points[i].x, point + PointsConcatenator::OFFSET_X, sizeof(float));
+    std::memcpy(&points[i].y, point + PointsConcatenator::OFFSET_Y, sizeof(float));
+    std::memcpy(&points[i].z, point + PointsConcatenator::OFFSET_Z, sizeof(float));
+    std::memcpy(&points[i].intensity, point + PointsConcatenator::OFFSET_INTENSITY, sizeof(float));
+  }
+  return points;
+}
+
+void ExpectSensorPoints(const std::vector<PointXYZI> &expected, size_t expected_offset,
+                        const std::vector<PointXYZI> &actual, const PointsConcatenator::SensorStatus &status,
+                        size_t num_points)
+{
+  ASSERT_TRUE(status.arrived);
+  ASSERT_EQ(num_points, status.num_points);
+  ASSERT_LE(status.offset + num_points, actual.size());
+  for (size_t j = 0; j < num_points; ++j)
+  {
+    const PointXYZI &e = expected[expected_offset + j];
+    const PointXYZI &a = actual[status.offset + j];
+    EXPECT_NEAR(e.x, a.x, 1e-4);
+    EXPECT_NEAR(e.y, a.y, 1e-4);
+    EXPECT_NEAR(e.z, a.z, 1e-4);
+    EXPECT_EQ(e.intensity, a.intensity);
+  }
+}
+
+TEST(PointsConcatenator, sameOutputAsTransformAndAppend)
+{
+  const size_t num_sensors = 4;
+  std::vector<sensor_msgs::PointCloud2> clouds;
+  std::vector<Eigen::Matrix4f> transforms;
+  std::vector<size_t> expected_offsets;
+  size_t num_points = 0;
+  for (size_t i = 0; i < num_sensors; ++i)
+  {
+    clouds.push_back(MakeSensorCloud(i, 16, 300 + 10 * i, 100.0 + 0.01 * i));
+    transforms.push_back(MakeSensorTransform(i));
+    expected_offsets.push_back(num_points);
+    num_points += clouds[i].width;
+  }
+  std::vector<PointXYZI> expected;
+  ConcatenateReference(clouds, transforms, expected);
+
+  PointsConcatenator concatenator(num_sensors, "base_link", PointsConcatenator::PublishPolicy::ALL_ARRIVED, 0.05);
+  std::vector<PointsConcatenator::SensorStatus> status;
+  // the first frame is assembled from overflow buffers, the second one is transformed in place
+  for (int f = 0; f < 2; ++f)
+  {
+    for (int i = num_sensors - 1; i >= 0; --i)
+    {
+      EXPECT_FALSE(concatenator.IsDue(0.0));
+      ASSERT_TRUE(concatenator.AddCloud(i, clouds[i], transforms[i], 0.0));
+    }
+    ASSERT_TRUE(concatenator.IsDue(0.0));
+    ASSERT_TRUE(concatenator.Concatenate(status));
+
+    const sensor_msgs::PointCloud2 &output = concatenator.GetConcatenatedCloud();
+    EXPECT_EQ("base_link", output.header.frame_id);
+    EXPECT_EQ(32u, output.point_step);
+    EXPECT_EQ(4u, output.fields.size());
+    EXPECT_EQ(output.width * output.point_step, output.data.size());
+    EXPECT_NEAR(100.03, output.header.stamp.toSec(), 1e-6);
+    const std::vector<PointXYZI> actual = FromMsg(output);
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < num_sensors; ++i)
+    {
+      ExpectSensorPoints(expected, expected_offsets[i], actual, status[i], clouds[i].width);
+      EXPECT_NEAR(0.03 - 0.01 * i, status[i].age, 1e-6);
+    }
+    // in place, the regions are in arrival order
+    if (f == 1)
+    {
+      EXPECT_EQ(0u, status[num_sensors - 1].offset);
+    }
+  }
+  // a new frame starts empty
+  EXPECT_FALSE(concatenator.IsDue(1.0));
+  EXPECT_FALSE(concatenator.Concatenate(status));
+}
+
+TEST(PointsConcatenator, closesHolesOfSmallerAndReplacedClouds)
+{
+  const Eigen::Matrix4f transform = MakeSensorTransform(1);
+  const sensor_msgs::PointCloud2 large0 = MakeSensorCloud(0, 8, 100, 1.0);
+  const sensor_msgs::PointCloud2 large1 = MakeSensorCloud(1, 8, 100, 1.0);
+  const sensor_msgs::PointCloud2 small0 = MakeSensorCloud(0, 8, 40, 2.0);
+  const sensor_msgs::PointCloud2 small1 = MakeSensorCloud(1, 8, 70, 2.0);
+  const sensor_msgs::PointCloud2 larger1 = MakeSensorCloud(1, 8, 90, 2.1);
+  std::vector<PointXYZI> expected0, expected1;
+  ConcatenateReference({ small0 }, { transform }, expected0);
+  ConcatenateReference({ larger1 }, { transform }, expected1);
+
+  PointsConcatenator concatenator(2, "base_link", PointsConcatenator::PublishPolicy::TIMEOUT, 0.05);
+  std::vector<PointsConcatenator::SensorStatus> status;
+  concatenator.AddCloud(0, large0, transform, 0.0);
+  concatenator.AddCloud(1, large1, transform, 0.0);
+  ASSERT_TRUE(concatenator.Concatenate(status));
+  concatenator.AddCloud(0, large0, transform, 0.1);
+  concatenator.AddCloud(1, large1, transform, 0.1);
+  ASSERT_TRUE(concatenator.Concatenate(status));
+
+  // sensor 1 delivers twice, the second cloud is larger than the first one
+  concatenator.AddCloud(1, small1, transform, 0.2);
+  concatenator.AddCloud(0, small0, transform, 0.2);
+  concatenator.AddCloud(1, larger1, transform, 0.21);
+  ASSERT_TRUE(concatenator.Concatenate(status));
+  const sensor_msgs::PointCloud2 &output = concatenator.GetConcatenatedCloud();
+  ASSERT_EQ(small0.width + larger1.width, output.width);
+  EXPECT_EQ(output.width * output.point_step, output.data.size());
+  const std::vector<PointXYZI> actual = FromMsg(output);
+  ExpectSensorPoints(expected0, 0, actual, status[0], small0.width);
+  ExpectSensorPoints(expected1, 0, actual, status[1], larger1.width);
+  EXPECT_NEAR(2.1, output.header.stamp.toSec(), 1e-6);
+}
+
+TEST(PointsConcatenator, keepsNonFinitePointsOfNonDenseClouds)
+{
+  sensor_msgs::PointCloud2 cloud = MakeSensorCloud(0, 4, 10, 1.0);
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  std::memcpy(&cloud.data[3 * cloud.point_step], &nan, sizeof(float));
+  cloud.is_dense = false;
+
+  PointsConcatenator concatenator(1, "base_link", PointsConcatenator::PublishPolicy::ALL_ARRIVED, 0.05);
+  ASSERT_TRUE(concatenator.AddCloud(0, cloud, MakeSensorTransform(3), 0.0));
+  std::vector<PointsConcatenator::SensorStatus> status;
+  ASSERT_TRUE(concatenator.Concatenate(status));
+  EXPECT_FALSE(concatenator.GetConcatenatedCloud().is_dense);
+  const std::vector<PointXYZI> actual = FromMsg(concatenator.GetConcatenatedCloud());
+  EXPECT_TRUE(std::isnan(actual[3].x));
+  PointXYZIR original;
+  std::memcpy(&original, &cloud.data[3 * cloud.point_step], sizeof(PointXYZIR));
+  EXPECT_EQ(original.y, actual[3].y);
+  EXPECT_EQ(original.z, actual[3].z);
+}
+
+TEST(PointsConcatenator, publishPolicies)
+{
+  const sensor_msgs::PointCloud2 cloud0 = MakeSensorCloud(0, 4, 10, 10.0);
+  const sensor_msgs::PointCloud2 cloud1 = MakeSensorCloud(1, 4, 20, 10.02);
+  const Eigen::Matrix4f identity = Eigen::Matrix4f::Identity();
+  std::vector<PointsConcatenator::SensorStatus> status;
+
+  PointsConcatenator all_arrived(3, "base_link", PointsConcatenator::PublishPolicy::ALL_ARRIVED, 0.05);
+  all_arrived.AddCloud(0, cloud0, identity, 1.0);
+  all_arrived.AddCloud(1, cloud1, identity, 1.01);
+  EXPECT_FALSE(all_arrived.IsDue(1.02));
+  EXPECT_FALSE(all_arrived.IsDue(10.0));
+
+  PointsConcatenator timeout(3, "base_link", PointsConcatenator::PublishPolicy::TIMEOUT, 0.05);
+  timeout.AddCloud(0, cloud0, identity, 1.0);
+  timeout.AddCloud(1, cloud1, identity, 1.01);
+  EXPECT_FALSE(timeout.IsDue(1.04));
+  EXPECT_TRUE(timeout.IsDue(1.06));
+  ASSERT_TRUE(timeout.Concatenate(status));
+  EXPECT_EQ(cloud0.width + cloud1.width, timeout.GetConcatenatedCloud().width);
+  EXPECT_TRUE(status[0].arrived);
+  EXPECT_TRUE(status[1].arrived);
+  EXPECT_FALSE(status[2].arrived);
+  EXPECT_FALSE(status[2].has_cloud);
+  EXPECT_EQ(1u, status[2].missed_frames);
+  EXPECT_NEAR(0.02, status[0].age, 1e-6);
+
+  // the next frame starts with the next cloud, a sensor delivering twice replaces its cloud
+  timeout.AddCloud(1, cloud0, identity, 2.0);
+  timeout.AddCloud(1, cloud1, identity, 2.01);
+  EXPECT_FALSE(timeout.IsDue(2.04));
+  EXPECT_TRUE(timeout.IsDue(2.06));
+  ASSERT_TRUE(timeout.Concatenate(status));
+  EXPECT_EQ(cloud1.width, timeout.GetConcatenatedCloud().width);
+  EXPECT_FALSE(status[0].arrived);
+  EXPECT_TRUE(status[0].has_cloud);
+  EXPECT_EQ(1u, status[0].missed_frames);
+  EXPECT_NEAR(0.02, status[0].age, 1e-6);
+  EXPECT_EQ(2u, status[2].missed_frames);
+}
+
+TEST(PointsConcatenator, rejectsCloudWithoutXYZ)
+{
+  sensor_msgs::PointCloud2 cloud = MakeSensorCloud(0, 4, 10, 1.0);
+  cloud.fields[1].name = "v";
+  PointsConcatenator concatenator(2, "base_link", PointsConcatenator::PublishPolicy::ALL_ARRIVED, 0.05);
+  EXPECT_FALSE(concatenator.AddCloud(0, cloud, Eigen::Matrix4f::Identity(), 0.0));
+  EXPECT_FALSE(concatenator.IsDue(0.0));
+}
+
+TEST(PointsConcatenator, benchmark)
+{
+  // 8 sensors of 32 x 1800 points, arriving 2 ms apart within a frame
+  const size_t num_sensors = 8;
+  const int num_frames = 20;
+  const std::chrono::milliseconds arrival_interval(2);
+  std::vector<sensor_msgs::PointCloud2> clouds;
+  std::vector<Eigen::Matrix4f> transforms;
+  for (size_t i = 0; i < num_sensors; ++i)
+  {
+    clouds.push_back(MakeSensorCloud(i, 32, 1800, 0.0));
+    transforms.push_back(MakeSensorTransform(i));
+  }
+
+  // previous node: everything is done after the last cloud arrived
+  std::chrono::duration<double, std::milli> reference_latency(0);
+  std::vector<PointXYZI> reference_points;
+  for (int f = 0; f < num_frames; ++f)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    ConcatenateReference(clouds, transforms, reference_points);
+    reference_latency += std::chrono::steady_clock::now() - start;
+  }
+
+  // each sensor has its own thread as with one spinner thread per topic
+  PointsConcatenator concatenator(num_sensors, "base_link", PointsConcatenator::PublishPolicy::ALL_ARRIVED, 0.1);
+  std::vector<PointsConcatenator::SensorStatus> status;
+  std::chrono::duration<double, std::milli> latency(0);
+  std::chrono::duration<double, std::milli> frame_time(0);
+  for (int f = 0; f < num_frames; ++f)
+  {
+    const auto frame_start = std::chrono::steady_clock::now();
+    std::vector<std::thread> sensors;
+    for (size_t i = 0; i < num_sensors; ++i)
+    {
+      sensors.emplace_back([&, i]() {
+        std::this_thread::sleep_until(frame_start + arrival_interval * i);
+        concatenator.AddCloud(i, clouds[i], transforms[i], 0.0);
+      });
+    }
+    for (auto &sensor : sensors)
+    {
+      sensor.join();
+    }
+    ASSERT_TRUE(concatenator.IsDue(0.0));
+    ASSERT_TRUE(concatenator.Concatenate(status));
+    const auto frame_end = std::chrono::steady_clock::now();
+    ASSERT_EQ(reference_points.size(), concatenator.GetConcatenatedCloud().width);
+    // from the arrival of the last cloud to the output
+    latency += frame_end - (frame_start + arrival_interval * (num_sensors - 1));
+    frame_time += frame_end - frame_start;
+  }
+
+  std::cout << num_sensors << " sensors, " << reference_points.size() << " points per frame, latency after the last "
+            << "cloud [ms] serial: " << reference_latency.count() / num_frames
+            << ", PointsConcatenator: " << latency.count() / num_frames
+            << ", frame time [ms]: " << frame_time.count() / num_frames << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
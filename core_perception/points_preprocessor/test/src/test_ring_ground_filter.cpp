@@ -0,0 +1,237 @@
+/*
+ * test_ring_ground_filter.cpp
+ *
+ * Compares RingGroundFilter with the serial range image implementation it replaced
+ * and measures the time per frame for synthetic 32, 64 and 128 beam clouds.
+ */
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "points_preprocessor/ring_ground_filter/ring_ground_filter.h"
+
+typedef pcl::PointCloud<velodyne_pointcloud::PointXYZIR> CloudXYZIR;
+
+// serial implementation with a row-major range image and per point push_back
+void FilterGroundReference(const CloudXYZIR &in_cloud, int vertical_res, int horizontal_res, double vertical_thres,
+			const std::vector<double> &radius_table, CloudXYZIR &out_groundless_points,
+			CloudXYZIR &out_ground_points)
+{
+	std::vector<int> index_map(vertical_res * horizontal_res, -1);
+	for (size_t i = 0; i < in_cloud.points.size(); i++)
+	{
+		double u = atan2(in_cloud.points[i].y, in_cloud.points[i].x) * 180/M_PI;
+		if (u < 0) { u = 360 + u; }
+		int column = horizontal_res - (int)((double)horizontal_res * u / 360.0) - 1;
+		int row = vertical_res - 1 - in_cloud.points[i].ring;
+		index_map[row * horizontal_res + column] = i;
+	}
+
+	for (int i = 0; i < horizontal_res; i++)
+	{
+		int point_index[vertical_res];
+		int point_index_size = 0;
+		double z_max = 0;
+		double z_min = 0;
+		double r_ref = 0;
+		for (int j = 0; j < vertical_res; j++)
+		{
+			const int index = index_map[j * horizontal_res + i];
+			if (index > -1)
+			{
+				double x0 = in_cloud.points[index].x;
+				double y0 = in_cloud.points[index].y;
+				double z0 = in_cloud.points[index].z;
+				double r0 = sqrt(x0*x0 + y0*y0);
+				double r_diff = fabs(r0 - r_ref);
+				if (r_diff < radius_table[j] || r_ref == 0)
+				{
+					r_ref = r0;
+					if (z0 > z_max || r_ref == 0) z_max = z0;
+					if (z0 < z_min || r_ref == 0) z_min = z0;
+					point_index[point_index_size] = j;
+					point_index_size++;
+				}
+				else
+				{
+					CloudXYZIR &out_cloud = (point_index_size > 1 && (z_max - z_min) > vertical_thres) ?
+								out_groundless_points : out_ground_points;
+					for (int m = 0; m < point_index_size; m++)
+					{
+						out_cloud.push_back(in_cloud.points[index_map[point_index[m] * horizontal_res + i]]);
+					}
+					point_index_size = 0;
+					r_ref = r0;
+					z_max = z0;
+					z_min = z0;
+					point_index[point_index_size] = j;
+					point_index_size++;
+				}
+			}
+			if (j == vertical_res - 1 && point_index_size != 0)
+			{
+				CloudXYZIR &out_cloud = (point_index_size > 1 && (z_max - z_min) > vertical_thres) ?
+							out_groundless_points : out_ground_points;
+				for (int m = 0; m < point_index_size; m++)
+				{
+					out_cloud.push_back(in_cloud.points[index_map[point_index[m] * horizontal_res + i]]);
+				}
+			}
+		}
+	}
+}
+
+std::vector<double> MakeVerticalAngles(int vertical_res)
+{
+	// evenly spread between -25 and +15 degrees
+	std::vector<double> vertical_angles(vertical_res);
+	for (int r = 0; r < vertical_res; r++)
+	{
+		vertical_angles[r] = (-25.0 + 40.0 * r / (vertical_res - 1)) * M_PI / 180;
+	}
+	return vertical_angles;
+}
+
+// flat ground with boxes standing on it and a wall at 40m
+CloudXYZIR MakeSyntheticCloud(const std::vector<double> &vertical_angles, int horizontal_res, double sensor_height)
+{
+	CloudXYZIR cloud;
+	cloud.points.reserve(vertical_angles.size() * horizontal_res);
+	for (int c = 0; c < horizontal_res; c++)
+	{
+		const double azimuth = 2 * M_PI * (c + 0.5) / horizontal_res;
+		// an obstacle at 8m every 30 degrees, 10 degrees wide
+		const bool has_obstacle = std::fmod(azimuth * 180 / M_PI, 30.0) < 10.0;
+		for (size_t r = 0; r < vertical_angles.size(); r++)
+		{
+			const double elevation = vertical_angles[r];
+			double range = 40.0 / cos(elevation);
+			if (elevation < 0)
+			{
+				range = std::min(range, sensor_height / sin(-elevation));
+			}
+			if (has_obstacle && 8.0 * tan(elevation) + sensor_height < 1.5)
+			{
+				range = std::min(range, 8.0 / cos(elevation));
+			}
+			velodyne_pointcloud::PointXYZIR point;
+			point.x = range * cos(elevation) * cos(azimuth);
+			point.y = range * cos(elevation) * sin(azimuth);
+			point.z = range * sin(elevation);
+			point.intensity = c % 256;
+			point.ring = r;
+			cloud.points.push_back(point);
+		}
+	}
+	cloud.width = cloud.points.size();
+	cloud.height = 1;
+	return cloud;
+}
+
+void ExpectSamePoints(const CloudXYZIR &expected, const CloudXYZIR &actual)
+{
+	ASSERT_EQ(expected.points.size(), actual.points.size());
+	for (size_t i = 0; i < expected.points.size(); i++)
+	{
+		EXPECT_EQ(expected.points[i].x, actual.points[i].x);
+		EXPECT_EQ(expected.points[i].y, actual.points[i].y);
+		EXPECT_EQ(expected.points[i].z, actual.points[i].z);
+		EXPECT_EQ(expected.points[i].ring, actual.points[i].ring);
+	}
+}
+
+TEST(RingGroundFilter, sameClassificationForExistingModels)
+{
+	const double sensor_height = 1.8;
+	const double max_slope = 10.0;
+	const double vertical_thres = 0.08;
+	const int models[] = { 16, 32, 64 };
+	const int horizontal_resolutions[] = { 1800, 2250, 2083 };
+	for (int m = 0; m < 3; m++)
+	{
+		const std::vector<double> radius_table =
+					RingGroundFilter::CreateRadiusTable(models[m], sensor_height, max_slope);
+		ASSERT_EQ(models[m], (int)radius_table.size());
+		// the synthetic scan is sampled more densely than the range image, so several points share a cell
+		const CloudXYZIR cloud = MakeSyntheticCloud(MakeVerticalAngles(models[m]), 2 * horizontal_resolutions[m],
+					sensor_height);
+
+		CloudXYZIR expected_groundless, expected_ground;
+		FilterGroundReference(cloud, models[m], horizontal_resolutions[m], vertical_thres, radius_table,
+					expected_groundless, expected_ground);
+
+		RingGroundFilter filter(models[m], horizontal_resolutions[m], vertical_thres, radius_table);
+		CloudXYZIR groundless, ground;
+		filter.FilterGround(cloud, groundless, ground);
+
+		EXPECT_GT(groundless.points.size(), 0u);
+		EXPECT_GT(ground.points.size(), 0u);
+		ExpectSamePoints(expected_groundless, groundless);
+		ExpectSamePoints(expected_ground, ground);
+	}
+}
+
+TEST(RingGroundFilter, radiusTableFromVerticalAngles)
+{
+	const double sensor_height = 1.8;
+	const double max_slope = 10.0;
+	const std::vector<double> vertical_angles = MakeVerticalAngles(128);
+	const std::vector<double> radius_table =
+				RingGroundFilter::CreateRadiusTable(vertical_angles, sensor_height, max_slope);
+	ASSERT_EQ(128u, radius_table.size());
+
+	// downward beams farther away get larger gaps on flat ground
+	const double b = max_slope * M_PI / 180;
+	const double theta = -vertical_angles[0];
+	const double a = vertical_angles[1] - vertical_angles[0];
+	const double expected = fabs(sensor_height * (1.0 / (tan(theta - a) + tan(b)) - 1.0 / (tan(theta) + tan(b))));
+	EXPECT_NEAR(expected, radius_table[126], 1e-9);
+	EXPECT_LT(radius_table[127], radius_table[100]);
+}
+
+TEST(RingGroundFilter, benchmark)
+{
+	const double sensor_height = 1.8;
+	const double max_slope = 10.0;
+	const double vertical_thres = 0.08;
+	const int horizontal_res = 2000;
+	const int num_frames = 20;
+	const int models[] = { 32, 64, 128 };
+	for (int m = 0; m < 3; m++)
+	{
+		const std::vector<double> radius_table =
+					RingGroundFilter::CreateRadiusTable(MakeVerticalAngles(models[m]), sensor_height, max_slope);
+		const CloudXYZIR cloud = MakeSyntheticCloud(MakeVerticalAngles(models[m]), horizontal_res, sensor_height);
+		RingGroundFilter filter(models[m], horizontal_res, vertical_thres, radius_table);
+
+		std::chrono::duration<double, std::milli> reference_time(0);
+		std::chrono::duration<double, std::milli> filter_time(0);
+		for (int f = 0; f < num_frames; f++)
+		{
+			CloudXYZIR expected_groundless, expected_ground, groundless, ground;
+			auto start = std::chrono::steady_clock::now();
+			FilterGroundReference(cloud, models[m], horizontal_res, vertical_thres, radius_table,
+						expected_groundless, expected_ground);
+			reference_time += std::chrono::steady_clock::now() - start;
+
+			start = std::chrono::steady_clock::now();
+			filter.FilterGround(cloud, groundless, ground);
+			filter_time += std::chrono::steady_clock::now() - start;
+
+			ASSERT_EQ(expected_groundless.points.size(), groundless.points.size());
+			ASSERT_EQ(expected_ground.points.size(), ground.points.size());
+		}
+		std::cout << models[m] << " beams, " << cloud.points.size() << " points per frame [ms] serial: "
+					<< reference_time.count() / num_frames << ", RingGroundFilter: "
+					<< filter_time.count() / num_frames << std::endl;
+	}
+}
+
+int main(int argc, char **argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -36,6 +36,7 @@
 #include <sensor_msgs/CameraInfo.h>
 #include <visualization_msgs/MarkerArray.h>
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -72,6 +73,7 @@ private:
 
   bool loaded_lanelet_map_ = false;
   lanelet::LaneletMapPtr lanelet_map_;
+  std::shared_ptr<lanelet::utils::query::QueryIndex> query_index_;
   lanelet::routing::RoutingGraphPtr routing_graph_ptr_;
 
   int adjust_proj_x_ = 0;
@@ -75,6 +75,7 @@ void FeatProjLanelet2::binMapCallback(const autoware_lanelet2_msgs::MapBin& msg)
 {
   lanelet_map_ = std::make_shared<lanelet::LaneletMap>();
   lanelet::utils::conversion::fromBinMsg(msg, lanelet_map_);
+  query_index_ = std::make_shared<lanelet::utils::query::QueryIndex>(lanelet_map_);
   loaded_lanelet_map_ = true;
 }
 
@@ -316,7 +317,7 @@ void FeatProjLanelet2::findVisibleTrafficLightFromLanes(
     }
   }
 
-  *visible_aw_tl = lanelet::utils::query::autowareTrafficLights(relevant_lanelets);
+  *visible_aw_tl = query_index_->autowareTrafficLights(relevant_lanelets);
 }
 
 // @brief create dummy light_bulbs linestring from traffic_light linestring
@@ -488,9 +489,8 @@ void FeatProjLanelet2::run()
   Eigen::Vector3f prev_position(0, 0, 0);
   Eigen::Quaternionf prev_orientation(0, 0, 0, 0);
 
-  lanelet::ConstLanelets all_lanelets = lanelet::utils::query::laneletLayer(lanelet_map_);
   std::vector<lanelet::AutowareTrafficLightConstPtr> aw_tl_reg_elems =
-      lanelet::utils::query::autowareTrafficLights(all_lanelets);
+      query_index_->autowareTrafficLights(query_index_->laneletLayer());
 
   std_msgs::ColorRGBA cl;
   cl.r = 0.9;
@@ -21,20 +21,10 @@
 
 #include <ros/ros.h>
 
+#include <amathutils_lib/sliding_window_statistics.hpp>
+
 class ValueTimeQueue
 {
-  struct ValueTime
-  {
-    ValueTime(const double a_value, const ros::Time &a_stamp)
-      : value(a_value)
-      , stamp(a_stamp)
-    {
-    }
-
-    double value;
-    ros::Time stamp;
-  };
-
   public:
     ValueTimeQueue();
     explicit ValueTimeQueue(const double window_size_sec);
@@ -44,7 +34,8 @@ class ValueTimeQueue
 
   private:
     double window_size_sec_;
-    std::deque<ValueTime> queue_;
+    std::deque<ros::Time> stamps_;  // stamps of the values in statistics_, in the same order
+    amathutils::SlidingWindowStatistics statistics_;
 };
 
 #endif  // VEL_POSE_DIFF_CHECKER_VALUE_TIME_QUEUE_H
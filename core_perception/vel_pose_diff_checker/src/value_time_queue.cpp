@@ -16,11 +16,6 @@
 
 #include "vel_pose_diff_checker/value_time_queue.h"
 
-#include <iostream>
-#include <deque>
-#include <algorithm>
-
-
 ValueTimeQueue::ValueTimeQueue()
   : window_size_sec_(1.0)
 {
@@ -34,17 +29,20 @@ ValueTimeQueue::ValueTimeQueue(const double window_size_sec)
 void ValueTimeQueue::addValueTime(const double value, const ros::Time &a_stamp)
 {
   const auto ros_time_now = ros::Time::now();
-  queue_.push_back(ValueTime(value, a_stamp));
-  while (!queue_.empty())
+  stamps_.push_back(a_stamp);
+  statistics_.push(value);
+  while (!stamps_.empty())
   {
     // for replay rosbag
-    if (queue_.front().stamp > ros_time_now)
+    if (stamps_.front() > ros_time_now)
     {
-      queue_.pop_front();
+      stamps_.pop_front();
+      statistics_.pop();
     }
-    else if (queue_.front().stamp < ros_time_now - ros::Duration(window_size_sec_))
+    else if (stamps_.front() < ros_time_now - ros::Duration(window_size_sec_))
     {
-      queue_.pop_front();
+      stamps_.pop_front();
+      statistics_.pop();
     }
     else
     {
@@ -55,15 +53,7 @@ void ValueTimeQueue::addValueTime(const double value, const ros::Time &a_stamp)
 
 double ValueTimeQueue::getMedianValue() const
 {
-  std::deque<ValueTime> queue_tmp = queue_;
-  const size_t median_index = queue_tmp.size() / 2;
-  std::nth_element(std::begin(queue_tmp), std::begin(queue_tmp) + median_index, std::end(queue_tmp),
-    [](const ValueTime &lhs, const ValueTime &rhs)
-    {
-      return lhs.value < rhs.value;
-    });  // NOLINT
-
-  return queue_tmp.at(median_index).value;
+  return statistics_.getMedian();
 }
 
 void ValueTimeQueue::setWindowSizeSec(const double time_window_size_sec)
@@ -42,9 +42,7 @@
 #include <opencv2/opencv.hpp>
 #include "opencv2/highgui/highgui.hpp"
 #include "opencv2/imgproc/imgproc.hpp"
-#include "clipper.hpp"
-
-using namespace ClipperLib;
+#include "convex_polygon.h"
 
 #define deg2rad(a) ((a)/180.0 * M_PI)
 
@@ -92,13 +90,13 @@ namespace beyondtrack
     double cd_area_;
     cv::Mat cd_2d_;
     std::vector<cv::Point> pd_2d_convhull_;
-    Paths pd_2d_convhull_clip_;
-    Paths cd_2d_convhull_clip_;
+    ConvexPolygon pd_2d_polygon_;
+    ConvexPolygon cd_2d_polygon_;
 
     std::vector<cv::Point> pd_3d_convhull_;
     std::vector<cv::Point> cd_3d_convhull_;
-    Paths pd_3d_convhull_clip_;
-    Paths cd_3d_convhull_clip_;
+    ConvexPolygon pd_3d_polygon_;
+    ConvexPolygon cd_3d_polygon_;
 
     Detection(int x, int y, int width, int height, std::string class_type)
     {
@@ -148,26 +146,14 @@ namespace beyondtrack
       pd_3d_xz.convertTo(pd_3d_xz, CV_32FC1);
 
       pd_3d_convhull_ = get_convhull(pd_3d_xz * 100); // due to cast
-
-      Paths pd_3d_convhull_clip(1);
-      for (const auto &e: pd_3d_convhull_)
-      {
-        pd_3d_convhull_clip[0] << IntPoint(e.x, e.y);
-      }
-      pd_3d_convhull_clip_ = pd_3d_convhull_clip;
+      pd_3d_polygon_.set(pd_3d_convhull_);
 
       // Pre-calculate the convexhull -- 2d --
       cv::Mat pd_2d = bvolume_proj_.colRange(0, 2);
       pd_2d.convertTo(pd_2d, CV_32FC1);
 
       pd_2d_convhull_ = get_convhull(pd_2d);
-
-      Paths pd_2d_convhull_clip(1);
-      for (const auto &e: pd_2d_convhull_)
-      {
-        pd_2d_convhull_clip[0] << IntPoint(e.x, e.y);
-      }
-      pd_2d_convhull_clip_ = pd_2d_convhull_clip;
+      pd_2d_polygon_.set(pd_2d_convhull_);
     }
 
     void propagate_cur_det(cv::Mat cuboid, double h, cv::Mat k, cv::Mat inv_k, cv::Mat n)
@@ -192,24 +178,18 @@ namespace beyondtrack
       bvolume_xy.convertTo(bvolume_xy, CV_32FC1);
 
       cd_3d_convhull_ = get_convhull(bvolume_xy * 100); // due to cast
-
-      Paths cd_3d_convhull_clip(1);
-      for (const auto &e: cd_3d_convhull_)
-      {
-        cd_3d_convhull_clip[0] << IntPoint(e.x, e.y);
-      }
-      cd_3d_convhull_clip_ = cd_3d_convhull_clip;
+      cd_3d_polygon_.set(cd_3d_convhull_);
 
       // Pre-calculate the convexhull -- 2d --
       cd_2d_ = (cv::Mat_<double>(4, 2) <<
                                        bbox_[0], bbox_[1], bbox_[2], bbox_[1], bbox_[2], bbox_[3], bbox_[0], bbox_[3]);
 
-      Paths cd_2d_convhull_clip(1);
+      std::vector<cv::Point> cd_2d_corners;
       for (int i = 0; i < 4; ++i)
       {
-        cd_2d_convhull_clip[0] << IntPoint((int) cd_2d_.at<double>(i, 0), (int) cd_2d_.at<double>(i, 1));
+        cd_2d_corners.push_back(cv::Point((int) cd_2d_.at<double>(i, 0), (int) cd_2d_.at<double>(i, 1)));
       }
-      cd_2d_convhull_clip_ = cd_2d_convhull_clip;
+      cd_2d_polygon_.set(cd_2d_corners);
 
       cd_area_ = (bbox_[3] - bbox_[1]) * (bbox_[2] - bbox_[0]);
     }
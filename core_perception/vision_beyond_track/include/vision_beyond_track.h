@@ -52,8 +52,9 @@
 #include <autoware_msgs/DetectedObject.h>
 #include <autoware_msgs/DetectedObjectArray.h>
 
+#include "convex_polygon.h"
 #include "detection.h"
-#include "hungarian.h"
+#include "gated_assignment.h"
 
 #define __APP_NAME__ "vision_beyond_track"
 
@@ -74,6 +75,7 @@ namespace beyondtrack
     cv::Mat camera_inv_k_;
     cv::Mat motion_;
     cv::Mat canonical_cuboid_ = create_cuboid();
+    ConvexPolygonClipper polygon_clipper_;
 
     void initialize(cv::Mat n, double h);
 
@@ -101,9 +103,9 @@ namespace beyondtrack
 
     void set_intrinsic(cv::Mat k_);
 
-    double get_3d2d_score(Detection cd, Detection pd);
+    double get_3d2d_score(const Detection &cd, const Detection &pd);
 
-    double get_3d3d_score(Detection cd, Detection pd);
+    double get_3d3d_score(const Detection &cd, const Detection &pd);
 
   };
 }
@@ -0,0 +1,331 @@
+/*
+ *  Copyright (c) 2018, Tokyo University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "convex_polygon.h"
+
+namespace beyondtrack
+{
+  namespace
+  {
+    // twice the signed area of the triangle (0, a, b)
+    double cross(const PolygonPoint &a, const PolygonPoint &b)
+    {
+      return a.x * b.y - b.x * a.y;
+    }
+
+    double signed_area(const std::vector<PolygonPoint> &points)
+    {
+      double area = 0;
+      for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+      {
+        area += cross(points[j], points[i]);
+      }
+      return area / 2.;
+    }
+
+    // > 0 if p is on the left of the edge a -> b
+    double side(const PolygonPoint &a, const PolygonPoint &b, const PolygonPoint &p)
+    {
+      return (b.x - a.x) * (p.y - a.y) - (b.y - a.y) * (p.x - a.x);
+    }
+
+    // ClipperLib::Round
+    double round_half_away(double v)
+    {
+      return v < 0 ? (double) (long long) (v - 0.5) : (double) (long long) (v + 0.5);
+    }
+
+    // a rounding that a last bit of floating point error could flip
+    bool near_half(double v)
+    {
+      return std::fabs(std::fabs(v - std::floor(v)) - 0.5) < 1e-7;
+    }
+
+    bool has_value_between(const std::vector<double> &sorted, double low, double high)
+    {
+      auto it = std::upper_bound(sorted.begin(), sorted.end(), low);
+      return it != sorted.end() && *it < high;
+    }
+
+    void to_path(const ConvexPolygon &polygon, ClipperLib::Paths &paths)
+    {
+      paths.resize(1);
+      paths[0].clear();
+      for (const auto &p: polygon.points())
+      {
+        paths[0].push_back(ClipperLib::IntPoint((ClipperLib::cInt) p.x, (ClipperLib::cInt) p.y));
+      }
+    }
+  }
+
+  void ConvexPolygon::update()
+  {
+    area_ = 0;
+    if (points_.size() < 3)
+    {
+      return;
+    }
+
+    area_ = signed_area(points_);
+    if (area_ < 0)
+    {
+      std::reverse(points_.begin(), points_.end());
+      area_ = -area_;
+    }
+
+    sorted_y_.clear();
+    for (const auto &p: points_)
+    {
+      sorted_y_.push_back(p.y);
+    }
+    std::sort(sorted_y_.begin(), sorted_y_.end());
+
+    min_x_ = max_x_ = points_[0].x;
+    min_y_ = max_y_ = points_[0].y;
+    for (const auto &p: points_)
+    {
+      min_x_ = std::min(min_x_, p.x);
+      max_x_ = std::max(max_x_, p.x);
+      min_y_ = std::min(min_y_, p.y);
+      max_y_ = std::max(max_y_, p.y);
+    }
+  }
+
+  bool ConvexPolygonClipper::near_at_scanbeam(const PolygonPoint &p0, const PolygonPoint &p1, const PolygonPoint &q0,
+                                              const PolygonPoint &q1, const ConvexPolygon &a,
+                                              const ConvexPolygon &b) const
+  {
+    // Clipper orders the edges by their rounded abscissa at each scanbeam boundary, the crossings are
+    // found and rounded in the scanbeam where that order flips. It is the exact one as long as the
+    // edges are more than a unit apart at every boundary; horizontal edges lie on a boundary.
+    if (p0.y == p1.y || q0.y == q1.y)
+    {
+      return false;
+    }
+    double y_low = std::max(std::min(p0.y, p1.y), std::min(q0.y, q1.y));
+    double y_high = std::min(std::max(p0.y, p1.y), std::max(q0.y, q1.y));
+    if (y_low > y_high)
+    {
+      return false;
+    }
+
+    const double margin = 1 + 1e-7;
+    auto separation = [&](double y)
+    {
+      return p0.x + (p1.x - p0.x) * (y - p0.y) / (p1.y - p0.y) - q0.x - (q1.x - q0.x) * (y - q0.y) / (q1.y - q0.y);
+    };
+    double s_low = separation(y_low);
+    double s_high = separation(y_high);
+    // the ends of the common range are vertices, hence boundaries
+    if (std::fabs(s_low) < margin || std::fabs(s_high) < margin)
+    {
+      return true;
+    }
+    if ((s_low > 0) == (s_high > 0))
+    {
+      return false;
+    }
+
+    // the separation is linear, under a unit around the crossing only
+    double y_minus = y_low + (-margin - s_low) * (y_high - y_low) / (s_high - s_low);
+    double y_plus = y_low + (margin - s_low) * (y_high - y_low) / (s_high - s_low);
+    double low = std::min(y_minus, y_plus);
+    double high = std::max(y_minus, y_plus);
+    return has_value_between(a.sorted_y(), low, high) || has_value_between(b.sorted_y(), low, high);
+  }
+
+  double ConvexPolygonClipper::clipper_union_area(const ConvexPolygon &a, const ConvexPolygon &b)
+  {
+    to_path(a, subject_);
+    to_path(b, clip_);
+    clipper_.Clear();
+    clipper_.AddPaths(subject_, ClipperLib::ptSubject, true);
+    clipper_.AddPaths(clip_, ClipperLib::ptClip, true);
+    clipper_.Execute(ClipperLib::ctIntersection, solution_, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    if (solution_.empty())
+    {
+      return 0;
+    }
+    clipper_.Execute(ClipperLib::ctUnion, solution_, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return ClipperLib::Area(solution_[0]);
+  }
+
+  void ConvexPolygonClipper::add_inner_vertices(const ConvexPolygon &polygon, const ConvexPolygon &other)
+  {
+    const std::vector<PolygonPoint> &other_points = other.points();
+    for (const auto &p: polygon.points())
+    {
+      bool inside = true;
+      for (size_t i = 0, j = other_points.size() - 1; i < other_points.size() && inside; j = i++)
+      {
+        inside = side(other_points[j], other_points[i], p) >= 0;
+      }
+      if (inside)
+      {
+        intersection_.push_back(p);
+        intersection_rounded_.push_back(p);
+      }
+    }
+  }
+
+  double ConvexPolygonClipper::crossings_area(const ConvexPolygon &polygon, bool polygon_a)
+  {
+    if (polygon_a)
+    {
+      std::sort(crossings_.begin(), crossings_.end(), [](const Crossing &l, const Crossing &r)
+      {
+        return l.edge_a < r.edge_a || (l.edge_a == r.edge_a && l.t_a < r.t_a);
+      });
+    } else
+    {
+      std::sort(crossings_.begin(), crossings_.end(), [](const Crossing &l, const Crossing &r)
+      {
+        return l.edge_b < r.edge_b || (l.edge_b == r.edge_b && l.t_b < r.t_b);
+      });
+    }
+
+    // replace each split edge p0 -> p1 by p0 -> c1 -> ... -> cn -> p1
+    const std::vector<PolygonPoint> &points = polygon.points();
+    double area = 0;
+    for (size_t first = 0; first < crossings_.size();)
+    {
+      size_t edge = polygon_a ? crossings_[first].edge_a : crossings_[first].edge_b;
+      size_t last = first;
+      while (last + 1 < crossings_.size() && (polygon_a ? crossings_[last + 1].edge_a : crossings_[last + 1].edge_b) == edge)
+      {
+        ++last;
+      }
+
+      const PolygonPoint &p0 = points[edge];
+      const PolygonPoint &p1 = points[(edge + 1) % points.size()];
+      area -= cross(p0, p1);
+      area += cross(p0, crossings_[first].rounded);
+      for (size_t i = first; i < last; ++i)
+      {
+        area += cross(crossings_[i].rounded, crossings_[i + 1].rounded);
+      }
+      area += cross(crossings_[last].rounded, p1);
+      first = last + 1;
+    }
+    return area;
+  }
+
+  double ConvexPolygonClipper::union_area(const ConvexPolygon &a, const ConvexPolygon &b)
+  {
+    if (a.area() <= 0 || b.area() <= 0 || !a.bounds_overlap(b))
+    {
+      return 0;
+    }
+
+    intersection_.clear();
+    intersection_rounded_.clear();
+    crossings_.clear();
+    add_inner_vertices(a, b);
+    add_inner_vertices(b, a);
+
+    const std::vector<PolygonPoint> &points_a = a.points();
+    const std::vector<PolygonPoint> &points_b = b.points();
+    for (size_t i = 0; i < points_a.size(); ++i)
+    {
+      const PolygonPoint &p0 = points_a[i];
+      const PolygonPoint &p1 = points_a[(i + 1) % points_a.size()];
+      for (size_t j = 0; j < points_b.size(); ++j)
+      {
+        const PolygonPoint &q0 = points_b[j];
+        const PolygonPoint &q1 = points_b[(j + 1) % points_b.size()];
+        if (near_at_scanbeam(p0, p1, q0, q1, a, b))
+        {
+          return clipper_union_area(a, b);
+        }
+
+        double d0 = side(q0, q1, p0);
+        double d1 = side(q0, q1, p1);
+        double e0 = side(p0, p1, q0);
+        double e1 = side(p0, p1, q1);
+        // proper crossings only, the touching vertices are inner vertices
+        if (((d0 > 0 && d1 < 0) || (d0 < 0 && d1 > 0)) && ((e0 > 0 && e1 < 0) || (e0 < 0 && e1 > 0)))
+        {
+          double t = d0 / (d0 - d1);
+          Crossing crossing;
+          crossing.edge_a = i;
+          crossing.t_a = t;
+          crossing.edge_b = j;
+          crossing.t_b = e0 / (e0 - e1);
+          crossing.point = {p0.x + t * (p1.x - p0.x), p0.y + t * (p1.y - p0.y)};
+          if (near_half(crossing.point.x) || near_half(crossing.point.y))
+          {
+            return clipper_union_area(a, b);
+          }
+          crossing.rounded = {round_half_away(crossing.point.x), round_half_away(crossing.point.y)};
+          crossings_.push_back(crossing);
+          intersection_.push_back(crossing.point);
+          intersection_rounded_.push_back(crossing.rounded);
+        }
+      }
+    }
+
+    if (intersection_.size() < 3)
+    {
+      return 0;
+    }
+
+    // the intersection is convex, its vertices are sorted by angle around their centroid
+    PolygonPoint center = {0, 0};
+    for (const auto &p: intersection_)
+    {
+      center.x += p.x;
+      center.y += p.y;
+    }
+    center.x /= intersection_.size();
+    center.y /= intersection_.size();
+    order_.clear();
+    for (size_t i = 0; i < intersection_.size(); ++i)
+    {
+      order_.push_back(std::make_pair(std::atan2(intersection_[i].y - center.y, intersection_[i].x - center.x), i));
+    }
+    std::sort(order_.begin(), order_.end());
+
+    double intersection_area = 0;
+    for (size_t i = 0, j = order_.size() - 1; i < order_.size(); j = i++)
+    {
+      intersection_area += cross(intersection_rounded_[order_[j].second], intersection_rounded_[order_[i].second]);
+    }
+    if (intersection_area <= 0)
+    {
+      return 0;
+    }
+
+    double area_a = 2 * a.area() + crossings_area(a, true);
+    double area_b = 2 * b.area() + crossings_area(b, false);
+    return (area_a + area_b - intersection_area) / 2.;
+  }
+}
@@ -0,0 +1,146 @@
+/*
+ *  Copyright (c) 2018, Tokyo University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BEYOND_CONVEX_POLYGON_H
+#define BEYOND_CONVEX_POLYGON_H
+
+#include <vector>
+#include "clipper.hpp"
+
+namespace beyondtrack
+{
+  struct PolygonPoint
+  {
+    double x;
+    double y;
+  };
+
+  // Convex polygon with integer vertices, as the convex hulls of the detections,
+  // with its area and bounds computed once
+  class ConvexPolygon
+  {
+  public:
+    ConvexPolygon()
+    {
+    };
+
+    // Vertices of a convex hull in any orientation, stored counter-clockwise
+    template<typename PointT>
+    void set(const std::vector<PointT> &in_points)
+    {
+      points_.clear();
+      for (const auto &p: in_points)
+      {
+        points_.push_back({(double) p.x, (double) p.y});
+      }
+      update();
+    }
+
+    const std::vector<PolygonPoint> &points() const
+    {
+      return points_;
+    }
+
+    double area() const
+    {
+      return area_;
+    }
+
+    // Ordinates of the vertices in ascending order, the scanbeams of the Clipper sweep
+    const std::vector<double> &sorted_y() const
+    {
+      return sorted_y_;
+    }
+
+    // True if the bounds of both polygons overlap with a non zero area, a necessary
+    // condition for a non zero intersection
+    bool bounds_overlap(const ConvexPolygon &other) const
+    {
+      return min_x_ < other.max_x_ && other.min_x_ < max_x_ && min_y_ < other.max_y_ && other.min_y_ < max_y_;
+    }
+
+  private:
+    void update();
+
+    std::vector<PolygonPoint> points_;
+    std::vector<double> sorted_y_;
+    double area_ = 0;
+    double min_x_ = 0;
+    double max_x_ = 0;
+    double min_y_ = 0;
+    double max_y_ = 0;
+  };
+
+  // Union of two overlapping convex polygons, computed from the vertices of each polygon inside the other and
+  // the crossings of their edges. The crossing points are rounded to integers as ClipperLib does for its
+  // integer polygons, so the areas are those of a Clipper union, slivers that vanish once rounded included.
+  // Where Clipper would round differently, edges closer than a unit at the boundary of a scanbeam, the union
+  // is left to Clipper itself. The buffers are kept between calls, so scoring many pairs doesn't allocate.
+  class ConvexPolygonClipper
+  {
+  public:
+    // Area of the union, 0 if the polygons don't overlap. a and b are the subject and the clip polygons
+    // of the Clipper union.
+    double union_area(const ConvexPolygon &a, const ConvexPolygon &b);
+
+  private:
+    struct Crossing
+    {
+      size_t edge_a;
+      double t_a;
+      size_t edge_b;
+      double t_b;
+      PolygonPoint point;
+      PolygonPoint rounded;
+    };
+
+    // true if the edges are within a unit from each other at a scanbeam boundary of the polygons
+    bool near_at_scanbeam(const PolygonPoint &p0, const PolygonPoint &p1, const PolygonPoint &q0,
+                          const PolygonPoint &q1, const ConvexPolygon &a, const ConvexPolygon &b) const;
+
+    double clipper_union_area(const ConvexPolygon &a, const ConvexPolygon &b);
+
+    void add_inner_vertices(const ConvexPolygon &polygon, const ConvexPolygon &other);
+
+    // twice the area added to the polygon when its edges are split at the rounded crossings
+    double crossings_area(const ConvexPolygon &polygon, bool polygon_a);
+
+    std::vector<Crossing> crossings_;
+    std::vector<PolygonPoint> intersection_;
+    std::vector<PolygonPoint> intersection_rounded_;
+    std::vector<std::pair<double, size_t> > order_;
+    ClipperLib::Clipper clipper_;
+    ClipperLib::Paths subject_;
+    ClipperLib::Paths clip_;
+    ClipperLib::Paths solution_;
+  };
+}
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ *  Copyright (c) 2018, Tokyo University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <numeric>
+#include "gated_assignment.h"
+#include "hungarian.h"
+
+namespace beyondtrack
+{
+  namespace
+  {
+    int find_group(std::vector<int> &parents, int i)
+    {
+      while (parents[i] != i)
+      {
+        parents[i] = parents[parents[i]];
+        i = parents[i];
+      }
+      return i;
+    }
+  }
+
+  void solve_gated_assignment(const std::vector<std::vector<double> > &cost_matrix, double max_cost,
+                              std::vector<int> &assignment)
+  {
+    size_t n_rows = cost_matrix.size();
+    size_t n_cols = n_rows > 0 ? cost_matrix[0].size() : 0;
+    assignment.assign(n_rows, -1);
+
+    // union find over the rows [0, n_rows) and the columns [n_rows, n_rows + n_cols)
+    std::vector<int> parents(n_rows + n_cols);
+    std::iota(parents.begin(), parents.end(), 0);
+    std::vector<bool> gated(n_rows + n_cols, false);
+    for (size_t r = 0; r < n_rows; ++r)
+    {
+      for (size_t c = 0; c < n_cols; ++c)
+      {
+        if (cost_matrix[r][c] < max_cost)
+        {
+          gated[r] = gated[n_rows + c] = true;
+          parents[find_group(parents, r)] = find_group(parents, n_rows + c);
+        }
+      }
+    }
+
+    std::vector<std::vector<int> > group_rows(n_rows + n_cols);
+    std::vector<std::vector<int> > group_cols(n_rows + n_cols);
+    for (size_t r = 0; r < n_rows; ++r)
+    {
+      if (gated[r])
+      {
+        group_rows[find_group(parents, r)].push_back(r);
+      }
+    }
+    for (size_t c = 0; c < n_cols; ++c)
+    {
+      if (gated[n_rows + c])
+      {
+        group_cols[find_group(parents, n_rows + c)].push_back(c);
+      }
+    }
+
+    HungarianAlgorithm hungarian;
+    std::vector<std::vector<double> > group_matrix;
+    std::vector<int> group_assignment;
+    for (size_t g = 0; g < group_rows.size(); ++g)
+    {
+      const std::vector<int> &rows = group_rows[g];
+      const std::vector<int> &cols = group_cols[g];
+      if (rows.empty())
+      {
+        continue;
+      }
+
+      if (rows.size() == 1 && cols.size() == 1)
+      {
+        assignment[rows[0]] = cols[0];
+        continue;
+      }
+
+      group_matrix.assign(rows.size(), std::vector<double>(cols.size()));
+      for (size_t i = 0; i < rows.size(); ++i)
+      {
+        for (size_t j = 0; j < cols.size(); ++j)
+        {
+          group_matrix[i][j] = cost_matrix[rows[i]][cols[j]];
+        }
+      }
+      hungarian.Solve(group_matrix, group_assignment);
+      for (size_t i = 0; i < rows.size(); ++i)
+      {
+        if (group_assignment[i] != -1)
+        {
+          assignment[rows[i]] = cols[group_assignment[i]];
+        }
+      }
+    }
+  }
+}
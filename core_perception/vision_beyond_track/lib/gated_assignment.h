@@ -0,0 +1,48 @@
+/*
+ *  Copyright (c) 2018, Tokyo University
+ *  All rights reserved.
+ *
+ *  Redistribution and use in source and binary forms, with or without
+ *  modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name of Autoware nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ *  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ *  AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ *  IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ *  DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ *  FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ *  DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ *  SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ *  CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ *  OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BEYOND_GATED_ASSIGNMENT_H
+#define BEYOND_GATED_ASSIGNMENT_H
+
+#include <vector>
+
+namespace beyondtrack
+{
+  // Optimal assignment of a cost matrix where most entries are max_cost, the pairs rejected by the gating.
+  // Rows and columns linked by entries below max_cost are split into connected groups, and each group is
+  // solved with HungarianAlgorithm on its own. The total cost of any assignment is max_cost for each pair plus
+  // the (cost - max_cost) of its gated pairs, so the groups are independent and the gated pairs of the
+  // optimal assignment are the same as with the whole matrix.
+  // Rows without any gated pair are left unassigned (-1).
+  void solve_gated_assignment(const std::vector<std::vector<double> > &cost_matrix, double max_cost,
+                              std::vector<int> &assignment);
+}
+
+#endif
@@ -92,27 +92,31 @@ namespace beyondtrack
 
   std::vector<std::vector<double> > BeyondTracker::generate_score_matrices()
   {
-    std::vector<std::vector<double> > array;
-    for (auto &&pd: prev_detections_)
+    // pairs whose hulls don't overlap in 2d nor in 3d keep MAX_VALUE without being scored
+    std::vector<std::vector<double> > array(prev_detections_.size(),
+                                            std::vector<double>(cur_detections_.size(), MAX_VALUE));
+    for (size_t p = 0; p < prev_detections_.size(); ++p)
     {
-      std::vector<double> tmp_array;
-      for (auto &&cd: cur_detections_)
+      const Detection &pd = prev_detections_[p];
+      for (size_t c = 0; c < cur_detections_.size(); ++c)
       {
-        double score_2d = get_3d2d_score(cd, pd);
-        double score_3d = get_3d3d_score(cd, pd);
+        const Detection &cd = cur_detections_[c];
+        bool overlap_2d = pd.pd_2d_polygon_.bounds_overlap(cd.cd_2d_polygon_);
+        bool overlap_3d = cd.cd_3d_polygon_.bounds_overlap(pd.pd_3d_polygon_);
+        if (!overlap_2d && !overlap_3d)
+        {
+          continue;
+        }
+
+        double score_2d = overlap_2d ? get_3d2d_score(cd, pd) : MAX_VALUE;
+        double score_3d = overlap_3d ? get_3d3d_score(cd, pd) : MAX_VALUE;
         double score = all_wts_[0] * score_3d + all_wts_[1] * score_2d;
         if (score > MAX_VALUE)
         {
           score = MAX_VALUE;
         }
-        tmp_array.push_back(score);
-        // std::cout << "Score 2d: " << score_2d << '\n';
-        // std::cout << "Score 3d: " << score_3d << '\n';
-        // std::cout << "Score: " << score << '\n';
-        // std::cout << score << '\t';
+        array[p][c] = score;
       }
-      // std::cout << '\n';
-      array.push_back(tmp_array);
     }
     return array;
   }
@@ -160,11 +164,8 @@ namespace beyondtrack
     // std::cout << "generate_score_matrices: " << msec << " milli sec \in_angle";
 
     // start = std::chrono::system_clock::now();
-    HungarianAlgorithm HungAlgo;
     std::vector<int> assignment;
-
-    //double cost =
-    HungAlgo.Solve(cost_matrix, assignment);
+    solve_gated_assignment(cost_matrix, MAX_VALUE, assignment);
 
     // end = std::chrono::system_clock::now();
     // dur = end - start;
@@ -203,38 +204,27 @@ namespace beyondtrack
     camera_inv_k_ = camera_k_.inv();
   }
 
-  double BeyondTracker::get_3d2d_score(Detection cd, Detection pd)
+  // Area of the union of the hulls over the area of the current detection, MAX_VALUE if they don't overlap
+  double BeyondTracker::get_3d2d_score(const Detection &cd, const Detection &pd)
   {
-    Paths solution;
-    Clipper c;
-    c.AddPaths(pd.pd_2d_convhull_clip_, ptSubject, true);
-    c.AddPaths(cd.cd_2d_convhull_clip_, ptClip, true);
-    c.Execute(ctIntersection, solution, pftNonZero, pftNonZero);
-    if (solution.size() > 0)
+    double area_union = polygon_clipper_.union_area(pd.pd_2d_polygon_, cd.cd_2d_polygon_);
+    if (area_union > 0)
     {
-      c.Execute(ctUnion, solution, pftNonZero, pftNonZero);
-      auto area_in = Area(solution[0]);
       double area_target = cd.cd_area_;
-      return area_in / area_target;
+      return area_union / area_target;
     } else
     {
       return MAX_VALUE;
     }
   }
 
-  double BeyondTracker::get_3d3d_score(Detection cd, Detection pd)
+  double BeyondTracker::get_3d3d_score(const Detection &cd, const Detection &pd)
   {
-    Paths solution;
-    Clipper c;
-    c.AddPaths(cd.cd_3d_convhull_clip_, ptSubject, true);
-    c.AddPaths(pd.pd_3d_convhull_clip_, ptClip, true);
-    c.Execute(ctIntersection, solution, pftNonZero, pftNonZero);
-    if (solution.size() > 0)
+    double area_union = polygon_clipper_.union_area(cd.cd_3d_polygon_, pd.pd_3d_polygon_);
+    if (area_union > 0)
     {
-      c.Execute(ctUnion, solution, pftNonZero, pftNonZero);
-      auto area_in = Area(solution[0]);
-      double area_target = cv::contourArea(cd.cd_3d_convhull_);
-      return area_in / area_target;
+      double area_target = cd.cd_3d_polygon_.area();
+      return area_union / area_target;
     } else
     {
       return MAX_VALUE;
@@ -0,0 +1,413 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "clipper.hpp"
+#include "convex_polygon.h"
+#include "gated_assignment.h"
+#include "hungarian.h"
+
+using beyondtrack::ConvexPolygon;
+using beyondtrack::ConvexPolygonClipper;
+
+namespace
+{
+const double MAX_VALUE = 10000;
+const double THRES_SCORE = 1000;
+const double WEIGHT_3D = 0.6;
+const double WEIGHT_2D = 0.4;
+
+struct Point
+{
+  int x, y;
+};
+
+// monotone chain, counter-clockwise without collinear points
+std::vector<Point> convexHull(std::vector<Point> points)
+{
+  std::sort(points.begin(), points.end(), [](const Point& a, const Point& b) {
+    return a.x < b.x || (a.x == b.x && a.y < b.y);
+  });
+  auto cross = [](const Point& o, const Point& a, const Point& b) {
+    return (long long)(a.x - o.x) * (b.y - o.y) - (long long)(a.y - o.y) * (b.x - o.x);
+  };
+  std::vector<Point> hull(2 * points.size());
+  size_t k = 0;
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    while (k >= 2 && cross(hull[k - 2], hull[k - 1], points[i]) <= 0)
+      --k;
+    hull[k++] = points[i];
+  }
+  for (size_t i = points.size() - 1, t = k + 1; i > 0; --i)
+  {
+    while (k >= t && cross(hull[k - 2], hull[k - 1], points[i - 1]) <= 0)
+      --k;
+    hull[k++] = points[i - 1];
+  }
+  hull.resize(k > 1 ? k - 1 : k);
+  return hull;
+}
+
+// both representations of a hull, clipper paths for the previous scoring
+struct Hull
+{
+  ClipperLib::Paths paths;
+  ConvexPolygon polygon;
+
+  explicit Hull(const std::vector<Point>& points) : paths(1)
+  {
+    for (const auto& p : points)
+      paths[0] << ClipperLib::IntPoint(p.x, p.y);
+    polygon.set(points);
+  }
+};
+
+// hulls of a detection as computed by Detection::propagate_cur_det and propagate_prev_det
+struct SimDetection
+{
+  int object_id = -1;
+  double cd_area;
+  Hull cd_2d, pd_2d, cd_3d, pd_3d;
+
+  SimDetection(double x, double y, double w, double h, double gx, double gz, double yaw)
+    : cd_area(w * h)
+    , cd_2d(rectangle(x, y, w, h))
+    , pd_2d(expanded(x, y, w, h))
+    , cd_3d(footprint(gx, gz, yaw, { 0 }))
+    , pd_3d(footprint(gx, gz, yaw, { -0.1, 0, 0.1 }))
+  {
+  }
+
+  static std::vector<Point> rectangle(double x, double y, double w, double h)
+  {
+    return { { (int)x, (int)y }, { (int)(x + w), (int)y }, { (int)(x + w), (int)(y + h) }, { (int)x, (int)(y + h) } };
+  }
+
+  // projection of the bounding volume, the box grown with cut corners
+  static std::vector<Point> expanded(double x, double y, double w, double h)
+  {
+    double cx = x + w / 2, cy = y + h / 2;
+    std::vector<Point> points;
+    for (int i = 0; i < 8; ++i)
+    {
+      double a = i * M_PI / 4 + M_PI / 8;
+      points.push_back({ (int)std::lround(cx + 0.65 * w * std::cos(a) / std::cos(M_PI / 8)),
+                         (int)std::lround(cy + 0.65 * h * std::sin(a) / std::cos(M_PI / 8)) });
+    }
+    return convexHull(points);
+  }
+
+  // ground footprint in cm of the car cuboid, rotated by the yaw offsets of the bounding volume
+  static std::vector<Point> footprint(double gx, double gz, double yaw, const std::vector<double>& offsets)
+  {
+    std::vector<Point> points;
+    for (double offset : offsets)
+    {
+      double c = std::cos(yaw + offset), s = std::sin(yaw + offset);
+      for (const auto& corner : { std::make_pair(-2.15, -1.0), std::make_pair(2.15, -1.0), std::make_pair(2.15, 1.0),
+                                  std::make_pair(-2.15, 1.0) })
+      {
+        double lx = corner.first * 1.3, lz = corner.second * 1.1;
+        points.push_back({ (int)((gx + c * lx - s * lz) * 100), (int)((gz + s * lx + c * lz) * 100) });
+      }
+    }
+    return convexHull(points);
+  }
+};
+
+// previous BeyondTracker::get_3d2d_score / get_3d3d_score
+double clipperScore(const ClipperLib::Paths& subject, const ClipperLib::Paths& clip, double area_target)
+{
+  ClipperLib::Paths solution;
+  ClipperLib::Clipper c;
+  c.AddPaths(subject, ClipperLib::ptSubject, true);
+  c.AddPaths(clip, ClipperLib::ptClip, true);
+  c.Execute(ClipperLib::ctIntersection, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+  if (solution.size() > 0)
+  {
+    c.Execute(ClipperLib::ctUnion, solution, ClipperLib::pftNonZero, ClipperLib::pftNonZero);
+    return ClipperLib::Area(solution[0]) / area_target;
+  }
+  return MAX_VALUE;
+}
+
+double polygonScore(ConvexPolygonClipper& clipper, const ConvexPolygon& subject, const ConvexPolygon& clip,
+                    double area_target)
+{
+  double area_union = clipper.union_area(subject, clip);
+  if (area_union > 0)
+    return area_union / area_target;
+  return MAX_VALUE;
+}
+
+double combine(double score_3d, double score_2d)
+{
+  return std::min(MAX_VALUE, WEIGHT_3D * score_3d + WEIGHT_2D * score_2d);
+}
+
+// previous tracker association: every pair scored with clipper, full hungarian
+std::vector<int> associateClipper(const std::vector<SimDetection>& prev, const std::vector<SimDetection>& cur,
+                                  std::vector<std::vector<double> >& cost_matrix)
+{
+  cost_matrix.assign(prev.size(), std::vector<double>());
+  for (size_t p = 0; p < prev.size(); ++p)
+  {
+    for (const auto& cd : cur)
+    {
+      double score_2d = clipperScore(prev[p].pd_2d.paths, cd.cd_2d.paths, cd.cd_area);
+      double score_3d = clipperScore(cd.cd_3d.paths, prev[p].pd_3d.paths, cd.cd_3d.polygon.area());
+      cost_matrix[p].push_back(combine(score_3d, score_2d));
+    }
+  }
+  HungarianAlgorithm hungarian;
+  std::vector<int> assignment;
+  hungarian.Solve(cost_matrix, assignment);
+  return assignment;
+}
+
+// current tracker association: gated convex scoring, assignment of the gated groups
+std::vector<int> associateGated(ConvexPolygonClipper& clipper, const std::vector<SimDetection>& prev,
+                                const std::vector<SimDetection>& cur, std::vector<std::vector<double> >& cost_matrix)
+{
+  cost_matrix.assign(prev.size(), std::vector<double>(cur.size(), MAX_VALUE));
+  for (size_t p = 0; p < prev.size(); ++p)
+  {
+    const SimDetection& pd = prev[p];
+    for (size_t c = 0; c < cur.size(); ++c)
+    {
+      const SimDetection& cd = cur[c];
+      bool overlap_2d = pd.pd_2d.polygon.bounds_overlap(cd.cd_2d.polygon);
+      bool overlap_3d = cd.cd_3d.polygon.bounds_overlap(pd.pd_3d.polygon);
+      if (!overlap_2d && !overlap_3d)
+        continue;
+      double score_2d = overlap_2d ? polygonScore(clipper, pd.pd_2d.polygon, cd.cd_2d.polygon, cd.cd_area) : MAX_VALUE;
+      double score_3d =
+          overlap_3d ? polygonScore(clipper, cd.cd_3d.polygon, pd.pd_3d.polygon, cd.cd_3d.polygon.area()) : MAX_VALUE;
+      cost_matrix[p][c] = combine(score_3d, score_2d);
+    }
+  }
+  std::vector<int> assignment;
+  beyondtrack::solve_gated_assignment(cost_matrix, MAX_VALUE, assignment);
+  return assignment;
+}
+
+// BeyondTracker::process id propagation
+void assignIds(const std::vector<SimDetection>& prev, std::vector<SimDetection>& cur,
+               const std::vector<std::vector<double> >& cost_matrix, const std::vector<int>& assignment, int& global_id)
+{
+  for (size_t x = 0; x < cost_matrix.size(); ++x)
+  {
+    if (assignment[x] != -1 && cost_matrix[x][assignment[x]] < THRES_SCORE)
+      cur[assignment[x]].object_id = prev[x].object_id;
+  }
+  for (auto& cd : cur)
+  {
+    if (cd.object_id == -1)
+      cd.object_id = global_id++;
+  }
+}
+
+struct SimObject
+{
+  double gx, gz, yaw, speed;
+};
+
+// cars on a road ahead of the camera, projected to a 1920x1080 image, some appear and disappear each frame
+std::vector<std::vector<SimDetection> > createSequence(size_t n_objects, size_t n_frames, std::mt19937& gen)
+{
+  std::uniform_real_distribution<double> lateral(-40, 40);
+  std::uniform_real_distribution<double> depth(5, 80);
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::normal_distribution<double> noise(0, 1);
+  std::vector<SimObject> objects;
+  for (size_t i = 0; i < n_objects; ++i)
+    objects.push_back({ lateral(gen), depth(gen), unit(gen) * 0.4 - 0.2, unit(gen) * 0.3 });
+
+  std::vector<std::vector<SimDetection> > sequence;
+  for (size_t f = 0; f < n_frames; ++f)
+  {
+    std::vector<SimDetection> frame;
+    for (auto& o : objects)
+    {
+      o.gz += o.speed;
+      if (unit(gen) < 0.03)
+        o = { lateral(gen), depth(gen), unit(gen) * 0.4 - 0.2, unit(gen) * 0.3 };
+      if (unit(gen) < 0.05)
+        continue;  // missed detection
+
+      double scale = 1000 / o.gz;
+      double w = 2.5 * scale + noise(gen), h = 1.8 * scale + noise(gen);
+      double x = 960 + o.gx * scale - w / 2 + noise(gen), y = 540 + 1.2 * scale - h + noise(gen);
+      frame.push_back(SimDetection(x, y, w, h, o.gx + 0.05 * noise(gen), o.gz + 0.05 * noise(gen), o.yaw));
+    }
+    sequence.push_back(frame);
+  }
+  return sequence;
+}
+}  // namespace
+
+TEST(TestAssociation, convexScoreSameAsClipper)
+{
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<int> coordinate(0, 400);
+  std::uniform_int_distribution<int> count(3, 24);
+  ConvexPolygonClipper clipper;
+  int n_overlaps = 0;
+  for (int i = 0; i < 20000; ++i)
+  {
+    std::vector<Point> a, b;
+    int ax = coordinate(gen), ay = coordinate(gen), bx = coordinate(gen), by = coordinate(gen);
+    for (int j = count(gen); j > 0; --j)
+      a.push_back({ ax + coordinate(gen) / 4, ay + coordinate(gen) / 4 });
+    for (int j = count(gen); j > 0; --j)
+      b.push_back({ bx + coordinate(gen) / 4, by + coordinate(gen) / 4 });
+    Hull ha(convexHull(a)), hb(convexHull(b));
+    if (ha.polygon.area() == 0 || hb.polygon.area() == 0)
+      continue;
+
+    double expected = clipperScore(ha.paths, hb.paths, hb.polygon.area());
+    double score = polygonScore(clipper, ha.polygon, hb.polygon, hb.polygon.area());
+    double reversed = polygonScore(clipper, hb.polygon, ha.polygon, hb.polygon.area());
+    EXPECT_NEAR(score, reversed, 1e-9);
+
+    EXPECT_NEAR(expected, score, 1e-9) << i;
+    if (expected != MAX_VALUE)
+      n_overlaps++;
+  }
+  EXPECT_GT(n_overlaps, 1000);
+}
+
+TEST(TestAssociation, gatedAssignmentSameAsHungarian)
+{
+  std::mt19937 gen(1);
+  std::uniform_real_distribution<double> unit(0, 1);
+  std::uniform_int_distribution<int> size(1, 30);
+  HungarianAlgorithm hungarian;
+  for (int i = 0; i < 2000; ++i)
+  {
+    int rows = size(gen), cols = size(gen);
+    double density = unit(gen) * 0.2;
+    std::vector<std::vector<double> > cost_matrix(rows, std::vector<double>(cols, MAX_VALUE));
+    for (auto& row : cost_matrix)
+    {
+      for (auto& cost : row)
+      {
+        if (unit(gen) < density)
+        {
+          double r = unit(gen);
+          cost = r < 0.8 ? 1 + 3 * unit(gen) : (r < 0.9 ? 4000 + unit(gen) : 6000 + unit(gen));
+        }
+      }
+    }
+
+    std::vector<std::vector<double> > full = cost_matrix;
+    std::vector<int> expected;
+    hungarian.Solve(full, expected);
+    std::vector<int> assignment;
+    beyondtrack::solve_gated_assignment(cost_matrix, MAX_VALUE, assignment);
+
+    ASSERT_EQ(expected.size(), assignment.size());
+    double expected_cost = 0, cost = 0;
+    for (int r = 0; r < rows; ++r)
+    {
+      if (expected[r] != -1 && cost_matrix[r][expected[r]] < MAX_VALUE)
+        expected_cost += cost_matrix[r][expected[r]] - MAX_VALUE;
+      if (assignment[r] != -1)
+        cost += cost_matrix[r][assignment[r]] - MAX_VALUE;
+      // the pairs kept by the tracker
+      bool expected_match = expected[r] != -1 && cost_matrix[r][expected[r]] < THRES_SCORE;
+      bool match = assignment[r] != -1 && cost_matrix[r][assignment[r]] < THRES_SCORE;
+      EXPECT_EQ(expected_match, match);
+      if (expected_match && match)
+      {
+        EXPECT_EQ(expected[r], assignment[r]);
+      }
+    }
+    EXPECT_NEAR(expected_cost, cost, 1e-6);
+  }
+
+  std::vector<std::vector<double> > empty;
+  std::vector<int> assignment;
+  beyondtrack::solve_gated_assignment(empty, MAX_VALUE, assignment);
+  EXPECT_TRUE(assignment.empty());
+}
+
+TEST(TestAssociation, sameTrackIdsBenchmark)
+{
+  for (size_t n_objects : { 10, 50, 100, 200 })
+  {
+    std::mt19937 gen(n_objects);
+    const size_t n_frames = n_objects > 100 ? 20 : 50;
+    const std::vector<std::vector<SimDetection> > sequence = createSequence(n_objects, n_frames, gen);
+
+    std::vector<SimDetection> clipper_prev = sequence[0], gated_prev = sequence[0];
+    int clipper_id = 1, gated_id = 1;
+    for (auto& d : clipper_prev)
+      d.object_id = clipper_id++;
+    for (auto& d : gated_prev)
+      d.object_id = gated_id++;
+
+    ConvexPolygonClipper clipper;
+    std::vector<std::vector<double> > cost_matrix;
+    double clipper_time = 0, gated_time = 0;
+    size_t n_detections = 0, n_different = 0;
+    for (size_t f = 1; f < sequence.size(); ++f)
+    {
+      std::vector<SimDetection> clipper_cur = sequence[f], gated_cur = sequence[f];
+      n_detections += gated_cur.size();
+
+      auto start = std::chrono::steady_clock::now();
+      std::vector<int> assignment = associateClipper(clipper_prev, clipper_cur, cost_matrix);
+      clipper_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      assignIds(clipper_prev, clipper_cur, cost_matrix, assignment, clipper_id);
+
+      start = std::chrono::steady_clock::now();
+      assignment = associateGated(clipper, gated_prev, gated_cur, cost_matrix);
+      gated_time += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+      assignIds(gated_prev, gated_cur, cost_matrix, assignment, gated_id);
+
+      for (size_t i = 0; i < gated_cur.size(); ++i)
+      {
+        if (clipper_cur[i].object_id != gated_cur[i].object_id)
+          n_different++;
+      }
+      clipper_prev = clipper_cur;
+      gated_prev = gated_cur;
+    }
+
+    EXPECT_EQ(0u, n_different) << n_objects << " objects";
+    EXPECT_EQ(clipper_id, gated_id);
+    printf("[ %3zu objects, %zu frames ] clipper + hungarian: %8.2f ms/frame, gated convex + groups: %6.3f ms/frame "
+           "(%zu detections, %zu different ids)\n",
+           n_objects, n_frames, clipper_time * 1e3 / (n_frames - 1), gated_time * 1e3 / (n_frames - 1), n_detections,
+           n_different);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -21,6 +21,8 @@
  */
 #include "vision_darknet_detect.h"
 
+#include <algorithm>
+
 #if (CV_MAJOR_VERSION <= 2)
 #include <opencv2/contrib/contrib.hpp>
 #else
@@ -103,40 +105,26 @@ namespace darknet
         int num_classes = output_layer.classes;
         detection *darknet_detections = get_network_boxes(darknet_network_, darknet_network_->w, darknet_network_->h, min_confidence_, .5, NULL, 0, &nboxes);
 
-        do_nms_sort(darknet_detections, nboxes, num_classes, nms_threshold_);
-
-        std::vector< RectClassScore<float> > detections;
-
+        //boxes without objectness are left out of the suppression as in do_nms_sort, boxes without any class
+        //above the threshold can neither be kept nor suppress another one
+        nms_boxes_.clear();
+        nms_probs_.clear();
         for (int i = 0; i < nboxes; i++)
         {
-            int class_id = -1;
-            float score = 0.f;
-            //find the class
-            for(int j = 0; j < num_classes; ++j){
-                if (darknet_detections[i].prob[j] >= min_confidence_){
-                    if (class_id < 0) {
-                        class_id = j;
-                        score = darknet_detections[i].prob[j];
-                    }
-                }
-            }
-            //if class found
-            if (class_id >= 0)
-            {
-                RectClassScore<float> detection;
+            const float *prob = darknet_detections[i].prob;
+            if (darknet_detections[i].objectness == 0
+                || std::all_of(prob, prob + num_classes, [](float p) { return p == 0.f; }))
+                continue;
+            const box &bbox = darknet_detections[i].bbox;
+            nms_boxes_.push_back({bbox.x, bbox.y, bbox.w, bbox.h});
+            nms_probs_.insert(nms_probs_.end(), prob, prob + num_classes);
+        }
+        free_detections(darknet_detections, nboxes);
 
-                detection.x = darknet_detections[i].bbox.x - darknet_detections[i].bbox.w/2;
-                detection.y = darknet_detections[i].bbox.y - darknet_detections[i].bbox.h/2;
-                detection.w = darknet_detections[i].bbox.w;
-                detection.h = darknet_detections[i].bbox.h;
-                detection.score = score;
-                detection.class_type = class_id;
-                //std::cout << detection.toString() << std::endl;
+        nms_.run(nms_boxes_, nms_probs_.data(), num_classes, nms_threshold_);
 
-                detections.push_back(detection);
-            }
-        }
-        //std::cout << std::endl;
+        std::vector< RectClassScore<float> > detections;
+        vision_detector::decodeCenterBoxes(nms_boxes_, nms_probs_.data(), num_classes, min_confidence_, detections);
         return detections;
     }
 }  // namespace darknet
@@ -183,67 +171,18 @@ void Yolo3DetectorNode::convert_rect_to_image_obj(std::vector< RectClassScore<fl
     }
 }
 
-void Yolo3DetectorNode::rgbgr_image(image& im)
-{
-    int i;
-    for(i = 0; i < im.w*im.h; ++i)
-    {
-        float swap = im.data[i];
-        im.data[i] = im.data[i+im.w*im.h*2];
-        im.data[i+im.w*im.h*2] = swap;
-    }
-}
-
 image Yolo3DetectorNode::convert_ipl_to_image(const sensor_msgs::ImageConstPtr& msg)
 {
-    cv_bridge::CvImagePtr cv_image = cv_bridge::toCvCopy(msg, "bgr8");//toCvCopy(image_source, sensor_msgs::image_encodings::BGR8);
-    cv::Mat mat_image = cv_image->image;
-
-    int network_input_width = yolo_detector_.get_network_width();
-    int network_input_height = yolo_detector_.get_network_height();
-
-    int image_height = msg->height,
-            image_width = msg->width;
-
-    IplImage ipl_image;
-    cv::Mat final_mat;
-
-    if (network_input_width!=image_width
-        || network_input_height != image_height)
-    {
-        //final_mat = cv::Mat(network_input_width, network_input_height, CV_8UC3, cv::Scalar(0,0,0));
-        image_ratio_ = (double ) network_input_width /  (double)mat_image.cols;
-
-        cv::resize(mat_image, final_mat, cv::Size(), image_ratio_, image_ratio_);
-        image_top_bottom_border_ = abs(final_mat.rows-network_input_height)/2;
-        image_left_right_border_ = abs(final_mat.cols-network_input_width)/2;
-        cv::copyMakeBorder(final_mat, final_mat,
-                           image_top_bottom_border_, image_top_bottom_border_,
-                           image_left_right_border_, image_left_right_border_,
-                           cv::BORDER_CONSTANT, cv::Scalar(0,0,0));
-    }
-    else
-        final_mat = mat_image;
-
-    ipl_image = final_mat;
+    cv_bridge::CvImageConstPtr cv_image = cv_bridge::toCvShare(msg, "bgr8");
 
-    unsigned char *data = (unsigned char *)ipl_image.imageData;
-    int h = ipl_image.height;
-    int w = ipl_image.width;
-    int c = ipl_image.nChannels;
-    int step = ipl_image.widthStep;
-    int i, j, k;
+    //letterbox into the network input, scaled to [0,1] in RGB order, in a single pass
+    preprocessor_->run(cv_image->image, darknet_image_data_.data());
+    image_ratio_ = preprocessor_->ratio();
+    image_top_bottom_border_ = preprocessor_->borderTop();
+    image_left_right_border_ = preprocessor_->borderLeft();
 
-    image darknet_image = make_image(w, h, c);
-
-    for(i = 0; i < h; ++i){
-        for(k= 0; k < c; ++k){
-            for(j = 0; j < w; ++j){
-                darknet_image.data[k*w*h + i*w + j] = data[i*step + j*c + k]/255.;
-            }
-        }
-    }
-    rgbgr_image(darknet_image);
+    image darknet_image = {preprocessor_->width(), preprocessor_->height(), preprocessor_->channels(),
+                           darknet_image_data_.data()};
     return darknet_image;
 }
 
@@ -262,8 +201,6 @@ void Yolo3DetectorNode::image_callback(const sensor_msgs::ImageConstPtr& in_imag
     convert_rect_to_image_obj(detections, output_message);
 
     publisher_objects_.publish(output_message);
-
-    free(darknet_image_.data);
 }
 
 void Yolo3DetectorNode::config_cb(const autoware_config_msgs::ConfigSSD::ConstPtr& param)
@@ -343,6 +280,12 @@ void Yolo3DetectorNode::Run()
 
     ROS_INFO("Initializing Yolo on Darknet...");
     yolo_detector_.load(network_definition_file, pretrained_model_file, score_threshold_, nms_threshold_);
+    preprocessor_.reset(new vision_detector::BlobPreprocessor(yolo_detector_.get_network_width(),
+                                                              yolo_detector_.get_network_height(), 3,
+                                                              vision_detector::BlobPreprocessor::LETTERBOX));
+    preprocessor_->setNormalization(cv::Scalar::all(0), cv::Scalar::all(255));
+    preprocessor_->setSwapRB(true);
+    darknet_image_data_.resize(preprocessor_->width() * preprocessor_->height() * preprocessor_->channels());
     ROS_INFO("Initialization complete.");
 
     #if (CV_MAJOR_VERSION <= 2)
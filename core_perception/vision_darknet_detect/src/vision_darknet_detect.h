@@ -27,6 +27,7 @@
 #include <fstream>
 #include <cstdint>
 #include <cstdlib>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -43,6 +44,9 @@
 
 #include <opencv2/opencv.hpp>
 
+#include <vision_detector_lib/blob_preprocessor.hpp>
+#include <vision_detector_lib/detection_postprocess.hpp>
+
 
 extern "C"
 {
@@ -64,6 +68,9 @@ namespace darknet {
         double min_confidence_, nms_threshold_;
         network* darknet_network_;
         std::vector<box> darknet_boxes_;
+        vision_detector::PerClassNms nms_;
+        std::vector<vision_detector::CenterBox> nms_boxes_;//boxes with a class above min_confidence_
+        std::vector<float> nms_probs_;
         std::vector<RectClassScore<float> > forward(image &in_darknet_image);
     public:
         Yolo3Detector() {}
@@ -94,6 +101,8 @@ class Yolo3DetectorNode {
     darknet::Yolo3Detector          yolo_detector_;
 
     image darknet_image_ = {};
+    std::vector<float>              darknet_image_data_;//network input, reused between frames
+    std::unique_ptr<vision_detector::BlobPreprocessor> preprocessor_;
 
     float                           score_threshold_;
     float                           nms_threshold_;
@@ -108,7 +117,6 @@ class Yolo3DetectorNode {
 
     void                            convert_rect_to_image_obj(std::vector< RectClassScore<float> >& in_objects,
                                       autoware_msgs::DetectedObjectArray& out_message);
-    void                            rgbgr_image(image& im);
     image                           convert_ipl_to_image(const sensor_msgs::ImageConstPtr& msg);
     void                            image_callback(const sensor_msgs::ImageConstPtr& in_image_message);
     void                            config_cb(const autoware_config_msgs::ConfigSSD::ConstPtr& param);
@@ -0,0 +1,124 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISION_DETECTOR_LIB_BLOB_PREPROCESSOR_HPP
+#define VISION_DETECTOR_LIB_BLOB_PREPROCESSOR_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <opencv2/core/core.hpp>
+
+/**
+ * @file blob_preprocessor.hpp
+ * @brief conversion of 8 bit camera images into the planar float input of a detection network
+ *
+ * Resizing, letterboxing, normalization, channel reordering and the interleaved to planar transposition are done
+ * in one pass over the output, writing straight into the network input buffer. The resize is the bilinear
+ * interpolation of cv::resize with its 11 bit fixed point weights, so the output matches the previous chain of
+ * cv::resize, cv::copyMakeBorder, convertTo, cv::subtract and cv::split up to one grey level. The interpolation
+ * tables are kept between frames and only rebuilt when the image size changes.
+ */
+
+namespace vision_detector
+{
+class BlobPreprocessor
+{
+public:
+  enum ResizeMode
+  {
+    /// scale each axis to the network size
+    STRETCH,
+    /// keep the aspect ratio, center the image and fill the rest with black
+    LETTERBOX
+  };
+
+  /**
+   * @param width network input width
+   * @param height network input height
+   * @param channels network input channels, 1 or 3
+   */
+  BlobPreprocessor(const int width, const int height, const int channels, const ResizeMode mode = STRETCH);
+
+  /**
+   * @brief input value of a channel is (pixel - mean) / std, defaults to mean 0 and std 1
+   */
+  void setNormalization(const cv::Scalar& mean, const cv::Scalar& std);
+
+  /**
+   * @brief write the channels of a 3 channel network in RGB order instead of the BGR order of the image
+   */
+  void setSwapRB(const bool swap_rb);
+
+  /**
+   * @brief fill the network input from an 8 bit image, BGR for 3 and 4 channels
+   * @param blob width * height * channels floats, one plane per channel
+   */
+  void run(const cv::Mat& image, float* blob);
+
+  int width() const;
+  int height() const;
+  int channels() const;
+
+  /**
+   * @brief scale from image to network input pixels of the last run
+   */
+  double ratio() const;
+
+  /**
+   * @brief offset of the image in the network input of the last run, non zero for LETTERBOX only
+   */
+  int borderLeft() const;
+  int borderTop() const;
+
+private:
+  void updateTables(const int image_cols, const int image_rows, const int image_channels);
+  void updateLookUpTable();
+
+  int width_;
+  int height_;
+  int channels_;
+  ResizeMode mode_;
+  cv::Scalar mean_;
+  cv::Scalar std_;
+  bool swap_rb_;
+
+  // geometry of the last image
+  int image_cols_;
+  int image_rows_;
+  int image_channels_;
+  double ratio_;
+  int resized_width_;
+  int resized_height_;
+  int border_left_;
+  int border_top_;
+
+  // source element offsets and 11 bit weights of each resized column, and source rows and weights of each resized
+  // row, like the tables of cv::resize
+  std::vector<int> x_offsets_;
+  std::vector<int16_t> x_weights_;
+  std::vector<int> y_offsets_;
+  std::vector<int16_t> y_weights_;
+
+  // normalized float of each 8 bit value and network channel
+  std::vector<float> look_up_table_;
+
+  // image converted to the channel count of the network when they differ
+  cv::Mat converted_;
+};
+}  // namespace vision_detector
+
+#endif  // VISION_DETECTOR_LIB_BLOB_PREPROCESSOR_HPP
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef VISION_DETECTOR_LIB_DETECTION_POSTPROCESS_HPP
+#define VISION_DETECTOR_LIB_DETECTION_POSTPROCESS_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @file detection_postprocess.hpp
+ * @brief non maximum suppression and decoding of detection network outputs into RectClassScore boxes
+ */
+
+namespace vision_detector
+{
+/**
+ * @brief box given by its center and size, the darknet box layout
+ */
+struct CenterBox
+{
+  float x;
+  float y;
+  float w;
+  float h;
+};
+
+/**
+ * @brief intersection over union, with the float operations of darknet's box_iou
+ */
+float boxIou(const CenterBox& a, const CenterBox& b);
+
+/**
+ * @brief greedy non maximum suppression of each class, the boxes kept are the ones darknet's do_nms_sort keeps
+ *
+ * For every class the boxes with a non zero probability are visited by descending probability, and the probability
+ * of every following box overlapping a kept one by more than the threshold is set to zero. Only the candidates of a
+ * class are sorted, instead of all detections for every class, and the buffers are kept between calls.
+ */
+class PerClassNms
+{
+public:
+  /**
+   * @param probs num boxes x num_classes, row major, the probabilities of suppressed boxes are set to zero
+   */
+  void run(const std::vector<CenterBox>& boxes, float* probs, const int num_classes, const float nms_threshold);
+
+private:
+  // probability and index of the boxes of the current class
+  std::vector<std::pair<float, int> > candidates_;
+};
+
+/**
+ * @brief one RectClassScore per box with a class probability of at least min_confidence, the first such class
+ * of the box, as top left corner and size
+ */
+template <typename RectT>
+void decodeCenterBoxes(const std::vector<CenterBox>& boxes, const float* probs, const int num_classes,
+                       const float min_confidence, std::vector<RectT>& detections)
+{
+  for (size_t i = 0; i < boxes.size(); ++i)
+  {
+    const float* box_probs = probs + i * num_classes;
+    for (int j = 0; j < num_classes; ++j)
+    {
+      if (box_probs[j] >= min_confidence)
+      {
+        RectT detection;
+        detection.x = boxes[i].x - boxes[i].w / 2;
+        detection.y = boxes[i].y - boxes[i].h / 2;
+        detection.w = boxes[i].w;
+        detection.h = boxes[i].h;
+        detection.score = box_probs[j];
+        detection.class_type = j;
+        detection.enabled = true;
+        detections.push_back(detection);
+        break;
+      }
+    }
+  }
+}
+
+/**
+ * @brief boxes of a caffe DetectionOutput layer, rows of [image_id, label, score, xmin, ymin, xmax, ymax] with
+ * coordinates relative to the image size, rows with image_id -1 are skipped
+ */
+template <typename RectT>
+void decodeDetectionOutput(const float* result, const int num_det, const int image_width, const int image_height,
+                           std::vector<RectT>& detections)
+{
+  for (int k = 0; k < num_det; ++k, result += 7)
+  {
+    if (result[0] == -1)
+    {
+      continue;
+    }
+    RectT detection;
+    detection.class_type = static_cast<int>(result[1]);
+    detection.score = result[2];
+    detection.x = result[3] * image_width;
+    detection.y = result[4] * image_height;
+    detection.w = result[5] * image_width - detection.x;
+    detection.h = result[6] * image_height - detection.y;
+    detection.enabled = true;
+    detections.push_back(detection);
+  }
+}
+
+/**
+ * @brief index of the highest score of each pixel, the first one on ties
+ * @param scores channels planes of num_pixels scores
+ */
+void argmaxChannels(const float* scores, const int channels, const int num_pixels, uint8_t* labels);
+}  // namespace vision_detector
+
+#endif  // VISION_DETECTOR_LIB_DETECTION_POSTPROCESS_HPP
@@ -0,0 +1,286 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vision_detector_lib/blob_preprocessor.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include <opencv2/imgproc/imgproc.hpp>
+
+namespace vision_detector
+{
+namespace
+{
+// weights of cv::resize for 8 bit images, INTER_RESIZE_COEF_BITS
+const int kWeightBits = 11;
+const int kWeightScale = 1 << kWeightBits;
+
+void resizeTable(const int src_size, const int dst_size, const double scale, const int element_step,
+                 std::vector<int>& offsets, std::vector<int16_t>& weights, const bool clamp_fraction)
+{
+  offsets.resize(2 * dst_size);
+  weights.resize(2 * dst_size);
+  for (int d = 0; d < dst_size; ++d)
+  {
+    float f = static_cast<float>((d + 0.5) * scale - 0.5);
+    int s = static_cast<int>(std::floor(f));
+    f -= s;
+    // cv::resize moves columns outside of the image onto the border, rows are clipped when they are read
+    if (clamp_fraction && s < 0)
+    {
+      f = 0;
+      s = 0;
+    }
+    if (clamp_fraction && s >= src_size - 1)
+    {
+      f = 0;
+      s = src_size - 1;
+    }
+    offsets[2 * d] = std::min(std::max(s, 0), src_size - 1) * element_step;
+    offsets[2 * d + 1] = std::min(std::max(s + 1, 0), src_size - 1) * element_step;
+    weights[2 * d] = static_cast<int16_t>(std::lrint((1.f - f) * kWeightScale));
+    weights[2 * d + 1] = static_cast<int16_t>(std::lrint(f * kWeightScale));
+  }
+}
+
+// bilinear value of cv::resize, horizontal weights applied first and the sum rounded back to 8 bits
+inline int interpolate(const int p00, const int p01, const int p10, const int p11, const int alpha0, const int alpha1,
+                       const int beta0, const int beta1)
+{
+  const int row0 = p00 * alpha0 + p01 * alpha1;
+  const int row1 = p10 * alpha0 + p11 * alpha1;
+  const int value = (row0 * beta0 + row1 * beta1 + (1 << (2 * kWeightBits - 1))) >> (2 * kWeightBits);
+  return std::min(std::max(value, 0), 255);
+}
+}  // namespace
+
+BlobPreprocessor::BlobPreprocessor(const int width, const int height, const int channels, const ResizeMode mode)
+  : width_(width)
+  , height_(height)
+  , channels_(channels)
+  , mode_(mode)
+  , mean_(0, 0, 0, 0)
+  , std_(1, 1, 1, 1)
+  , swap_rb_(false)
+  , image_cols_(0)
+  , image_rows_(0)
+  , image_channels_(0)
+  , ratio_(1.0)
+  , resized_width_(width)
+  , resized_height_(height)
+  , border_left_(0)
+  , border_top_(0)
+{
+  CV_Assert(width > 0 && height > 0 && (channels == 1 || channels == 3));
+  updateLookUpTable();
+}
+
+void BlobPreprocessor::setNormalization(const cv::Scalar& mean, const cv::Scalar& std)
+{
+  mean_ = mean;
+  std_ = std;
+  updateLookUpTable();
+}
+
+void BlobPreprocessor::setSwapRB(const bool swap_rb)
+{
+  swap_rb_ = swap_rb;
+}
+
+int BlobPreprocessor::width() const
+{
+  return width_;
+}
+
+int BlobPreprocessor::height() const
+{
+  return height_;
+}
+
+int BlobPreprocessor::channels() const
+{
+  return channels_;
+}
+
+double BlobPreprocessor::ratio() const
+{
+  return ratio_;
+}
+
+int BlobPreprocessor::borderLeft() const
+{
+  return border_left_;
+}
+
+int BlobPreprocessor::borderTop() const
+{
+  return border_top_;
+}
+
+void BlobPreprocessor::updateLookUpTable()
+{
+  // same float operations as convertTo(CV_32F) followed by cv::subtract and a division by the std
+  look_up_table_.resize(channels_ * 256);
+  for (int c = 0; c < channels_; ++c)
+  {
+    for (int v = 0; v < 256; ++v)
+    {
+      const float centered = static_cast<float>(v) - static_cast<float>(mean_[c]);
+      look_up_table_[c * 256 + v] = static_cast<float>(centered / std_[c]);
+    }
+  }
+}
+
+void BlobPreprocessor::updateTables(const int image_cols, const int image_rows, const int image_channels)
+{
+  if (image_cols == image_cols_ && image_rows == image_rows_ && image_channels == image_channels_)
+  {
+    return;
+  }
+  image_cols_ = image_cols;
+  image_rows_ = image_rows;
+  image_channels_ = image_channels;
+
+  double scale_x, scale_y;
+  if (mode_ == LETTERBOX)
+  {
+    ratio_ = std::min(static_cast<double>(width_) / image_cols, static_cast<double>(height_) / image_rows);
+    resized_width_ = std::min(width_, static_cast<int>(std::lrint(image_cols * ratio_)));
+    resized_height_ = std::min(height_, static_cast<int>(std::lrint(image_rows * ratio_)));
+    border_left_ = (width_ - resized_width_) / 2;
+    border_top_ = (height_ - resized_height_) / 2;
+    scale_x = scale_y = 1. / ratio_;
+  }
+  else
+  {
+    ratio_ = static_cast<double>(width_) / image_cols;
+    resized_width_ = width_;
+    resized_height_ = height_;
+    border_left_ = border_top_ = 0;
+    scale_x = 1. / ratio_;
+    scale_y = 1. / (static_cast<double>(height_) / image_rows);
+  }
+
+  resizeTable(image_cols, resized_width_, scale_x, channels_, x_offsets_, x_weights_, true);
+  resizeTable(image_rows, resized_height_, scale_y, 1, y_offsets_, y_weights_, false);
+}
+
+void BlobPreprocessor::run(const cv::Mat& image, float* blob)
+{
+  CV_Assert(image.depth() == CV_8U && !image.empty());
+
+  const cv::Mat* sample = &image;
+  if (image.channels() != channels_)
+  {
+    if (image.channels() == 3 && channels_ == 1)
+      cv::cvtColor(image, converted_, cv::COLOR_BGR2GRAY);
+    else if (image.channels() == 4 && channels_ == 1)
+      cv::cvtColor(image, converted_, cv::COLOR_BGRA2GRAY);
+    else if (image.channels() == 4 && channels_ == 3)
+      cv::cvtColor(image, converted_, cv::COLOR_BGRA2BGR);
+    else
+      cv::cvtColor(image, converted_, cv::COLOR_GRAY2BGR);
+    sample = &converted_;
+  }
+
+  updateTables(sample->cols, sample->rows, image.channels());
+
+  const int plane = width_ * height_;
+  const bool identity = resized_width_ == sample->cols && resized_height_ == sample->rows;
+  int channel_planes[3];
+  for (int c = 0; c < channels_; ++c)
+  {
+    channel_planes[c] = (swap_rb_ && channels_ == 3 ? 2 - c : c) * plane;
+  }
+
+  // letterbox borders, black before normalization
+  if (resized_width_ != width_ || resized_height_ != height_)
+  {
+    for (int c = 0; c < channels_; ++c)
+    {
+      float* out = blob + channel_planes[c];
+      const float black = look_up_table_[c * 256];
+      std::fill(out, out + border_top_ * width_, black);
+      std::fill(out + (border_top_ + resized_height_) * width_, out + plane, black);
+      for (int y = border_top_; y < border_top_ + resized_height_; ++y)
+      {
+        std::fill(out + y * width_, out + y * width_ + border_left_, black);
+        std::fill(out + y * width_ + border_left_ + resized_width_, out + (y + 1) * width_, black);
+      }
+    }
+  }
+
+  const uint8_t* data = sample->data;
+  const size_t step = sample->step;
+  const int cn = channels_;
+  const float* table = look_up_table_.data();
+
+#pragma omp parallel for schedule(static)
+  for (int dy = 0; dy < resized_height_; ++dy)
+  {
+    const int row_offset = (dy + border_top_) * width_ + border_left_;
+    if (identity)
+    {
+      const uint8_t* src = data + dy * step;
+      for (int c = 0; c < cn; ++c)
+      {
+        float* out = blob + channel_planes[c] + row_offset;
+        const float* lut = table + c * 256;
+        for (int dx = 0; dx < resized_width_; ++dx)
+        {
+          out[dx] = lut[src[dx * cn + c]];
+        }
+      }
+      continue;
+    }
+
+    const uint8_t* src0 = data + y_offsets_[2 * dy] * step;
+    const uint8_t* src1 = data + y_offsets_[2 * dy + 1] * step;
+    const int beta0 = y_weights_[2 * dy];
+    const int beta1 = y_weights_[2 * dy + 1];
+    if (cn == 3)
+    {
+      float* out0 = blob + channel_planes[0] + row_offset;
+      float* out1 = blob + channel_planes[1] + row_offset;
+      float* out2 = blob + channel_planes[2] + row_offset;
+      for (int dx = 0; dx < resized_width_; ++dx)
+      {
+        const uint8_t* p00 = src0 + x_offsets_[2 * dx];
+        const uint8_t* p01 = src0 + x_offsets_[2 * dx + 1];
+        const uint8_t* p10 = src1 + x_offsets_[2 * dx];
+        const uint8_t* p11 = src1 + x_offsets_[2 * dx + 1];
+        const int alpha0 = x_weights_[2 * dx];
+        const int alpha1 = x_weights_[2 * dx + 1];
+        out0[dx] = table[interpolate(p00[0], p01[0], p10[0], p11[0], alpha0, alpha1, beta0, beta1)];
+        out1[dx] = table[256 + interpolate(p00[1], p01[1], p10[1], p11[1], alpha0, alpha1, beta0, beta1)];
+        out2[dx] = table[512 + interpolate(p00[2], p01[2], p10[2], p11[2], alpha0, alpha1, beta0, beta1)];
+      }
+    }
+    else
+    {
+      float* out = blob + channel_planes[0] + row_offset;
+      for (int dx = 0; dx < resized_width_; ++dx)
+      {
+        const int x0 = x_offsets_[2 * dx];
+        const int x1 = x_offsets_[2 * dx + 1];
+        out[dx] = table[interpolate(src0[x0], src0[x1], src1[x0], src1[x1], x_weights_[2 * dx], x_weights_[2 * dx + 1],
+                                    beta0, beta1)];
+      }
+    }
+  }
+}
+}  // namespace vision_detector
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "vision_detector_lib/detection_postprocess.hpp"
+
+#include <algorithm>
+
+namespace vision_detector
+{
+namespace
+{
+float overlap(const float x1, const float w1, const float x2, const float w2)
+{
+  const float l1 = x1 - w1 / 2;
+  const float l2 = x2 - w2 / 2;
+  const float left = l1 > l2 ? l1 : l2;
+  const float r1 = x1 + w1 / 2;
+  const float r2 = x2 + w2 / 2;
+  const float right = r1 < r2 ? r1 : r2;
+  return right - left;
+}
+
+// higher probability first, lower index first on ties
+bool compareCandidates(const std::pair<float, int>& a, const std::pair<float, int>& b)
+{
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+const int kArgmaxBlock = 256;
+}  // namespace
+
+float boxIou(const CenterBox& a, const CenterBox& b)
+{
+  const float w = overlap(a.x, a.w, b.x, b.w);
+  const float h = overlap(a.y, a.h, b.y, b.h);
+  const float intersection = (w < 0 || h < 0) ? 0 : w * h;
+  const float box_union = a.w * a.h + b.w * b.h - intersection;
+  return intersection / box_union;
+}
+
+void PerClassNms::run(const std::vector<CenterBox>& boxes, float* probs, const int num_classes,
+                      const float nms_threshold)
+{
+  const int num_boxes = static_cast<int>(boxes.size());
+  for (int k = 0; k < num_classes; ++k)
+  {
+    candidates_.clear();
+    for (int i = 0; i < num_boxes; ++i)
+    {
+      if (probs[i * num_classes + k] != 0)
+      {
+        candidates_.push_back(std::make_pair(probs[i * num_classes + k], i));
+      }
+    }
+    std::sort(candidates_.begin(), candidates_.end(), compareCandidates);
+
+    for (size_t a = 0; a < candidates_.size(); ++a)
+    {
+      if (candidates_[a].first == 0)
+      {
+        continue;
+      }
+      const CenterBox& kept = boxes[candidates_[a].second];
+      for (size_t b = a + 1; b < candidates_.size(); ++b)
+      {
+        if (candidates_[b].first != 0 && boxIou(kept, boxes[candidates_[b].second]) > nms_threshold)
+        {
+          candidates_[b].first = 0;
+          probs[candidates_[b].second * num_classes + k] = 0;
+        }
+      }
+    }
+  }
+}
+
+void argmaxChannels(const float* scores, const int channels, const int num_pixels, uint8_t* labels)
+{
+  // blocks of pixels, so that every channel plane is read sequentially
+#pragma omp parallel for schedule(static)
+  for (int begin = 0; begin < num_pixels; begin += kArgmaxBlock)
+  {
+    const int count = std::min(kArgmaxBlock, num_pixels - begin);
+    float best[kArgmaxBlock];
+    uint8_t best_label[kArgmaxBlock];
+    std::copy(scores + begin, scores + begin + count, best);
+    std::fill(best_label, best_label + count, 0);
+    for (int c = 1; c < channels; ++c)
+    {
+      const float* plane = scores + static_cast<size_t>(c) * num_pixels + begin;
+      for (int i = 0; i < count; ++i)
+      {
+        if (plane[i] > best[i])
+        {
+          best[i] = plane[i];
+          best_label[i] = static_cast<uint8_t>(c);
+        }
+      }
+    }
+    std::copy(best_label, best_label + count, labels + begin);
+  }
+}
+}  // namespace vision_detector
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include <opencv2/core/core.hpp>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "vision_detector_lib/blob_preprocessor.hpp"
+
+namespace
+{
+// the previous vision_ssd_detect preprocessing, the same chain without mean in vision_segment_enet_detect
+std::vector<float> caffePreprocess(const cv::Mat& img, const cv::Size& input_geometry, const cv::Scalar& mean)
+{
+  std::vector<float> blob(input_geometry.area() * 3);
+  std::vector<cv::Mat> input_channels;
+  for (int i = 0; i < 3; ++i)
+  {
+    input_channels.push_back(cv::Mat(input_geometry, CV_32FC1, blob.data() + i * input_geometry.area()));
+  }
+
+  cv::Mat sample_resized;
+  if (img.size() != input_geometry)
+    cv::resize(img, sample_resized, input_geometry);
+  else
+    sample_resized = img;
+
+  cv::Mat sample_float;
+  sample_resized.convertTo(sample_float, CV_32FC3);
+  cv::Mat mean_img(input_geometry, CV_32FC3, mean);
+  cv::Mat sample_normalized;
+  cv::subtract(sample_float, mean_img, sample_normalized);
+  cv::split(sample_normalized, input_channels);
+  return blob;
+}
+
+// the previous vision_darknet_detect letterbox, valid when the resized image height leaves an even border
+std::vector<float> darknetPreprocess(const cv::Mat& mat_image, const int network_input_width,
+                                     const int network_input_height)
+{
+  cv::Mat final_mat;
+  if (network_input_width != mat_image.cols || network_input_height != mat_image.rows)
+  {
+    double image_ratio = (double)network_input_width / (double)mat_image.cols;
+    cv::resize(mat_image, final_mat, cv::Size(), image_ratio, image_ratio);
+    int image_top_bottom_border = abs(final_mat.rows - network_input_height) / 2;
+    int image_left_right_border = abs(final_mat.cols - network_input_width) / 2;
+    cv::copyMakeBorder(final_mat, final_mat, image_top_bottom_border, image_top_bottom_border,
+                       image_left_right_border, image_left_right_border, cv::BORDER_CONSTANT, cv::Scalar(0, 0, 0));
+  }
+  else
+    final_mat = mat_image;
+
+  const int h = final_mat.rows, w = final_mat.cols, c = final_mat.channels();
+  std::vector<float> data(w * h * c);
+  for (int i = 0; i < h; ++i)
+    for (int k = 0; k < c; ++k)
+      for (int j = 0; j < w; ++j)
+        data[k * w * h + i * w + j] = final_mat.data[i * final_mat.step + j * c + k] / 255.;
+
+  // rgbgr_image
+  for (int i = 0; i < w * h; ++i)
+    std::swap(data[i], data[i + w * h * 2]);
+  return data;
+}
+
+cv::Mat createImage(const int rows, const int cols, const bool smooth)
+{
+  cv::Mat image(rows, cols, CV_8UC3);
+  cv::randu(image, cv::Scalar::all(0), cv::Scalar::all(256));
+  if (smooth)
+  {
+    cv::GaussianBlur(image, image, cv::Size(0, 0), 4.0);
+    cv::normalize(image, image, 0, 255, cv::NORM_MINMAX);
+  }
+  return image;
+}
+
+// largest difference in 8 bit levels
+double maxLevelDifference(const std::vector<float>& expected, const std::vector<float>& actual, const double scale)
+{
+  EXPECT_EQ(expected.size(), actual.size());
+  double max_difference = 0;
+  for (size_t i = 0; i < expected.size() && i < actual.size(); ++i)
+  {
+    max_difference = std::max(max_difference, std::fabs(expected[i] - actual[i]) / scale);
+  }
+  return max_difference;
+}
+}  // namespace
+
+TEST(TestBlobPreprocessor, stretchMatchesCaffePreprocess)
+{
+  const cv::Scalar mean(102.9801, 115.9465, 122.7717);
+  const cv::Size sizes[] = { cv::Size(1280, 720), cv::Size(640, 480), cv::Size(200, 150), cv::Size(300, 300) };
+  for (const cv::Size& size : sizes)
+  {
+    for (const bool smooth : { false, true })
+    {
+      cv::Mat image = createImage(size.height, size.width, smooth);
+      std::vector<float> expected = caffePreprocess(image, cv::Size(300, 300), mean);
+
+      vision_detector::BlobPreprocessor preprocessor(300, 300, 3);
+      preprocessor.setNormalization(mean, cv::Scalar::all(1));
+      std::vector<float> blob(300 * 300 * 3, -1000);
+      preprocessor.run(image, blob.data());
+
+      if (size == cv::Size(300, 300))
+        ASSERT_EQ(maxLevelDifference(expected, blob, 1.0), 0.0);
+      else
+        ASSERT_LE(maxLevelDifference(expected, blob, 1.0), 1.0 + 1e-4) << size;
+    }
+  }
+}
+
+TEST(TestBlobPreprocessor, letterboxMatchesDarknetPreprocess)
+{
+  const cv::Size sizes[] = { cv::Size(1920, 1080), cv::Size(1280, 720), cv::Size(832, 832), cv::Size(416, 416) };
+  for (const cv::Size& size : sizes)
+  {
+    cv::Mat image = createImage(size.height, size.width, true);
+    std::vector<float> expected = darknetPreprocess(image, 416, 416);
+
+    vision_detector::BlobPreprocessor preprocessor(416, 416, 3, vision_detector::BlobPreprocessor::LETTERBOX);
+    preprocessor.setNormalization(cv::Scalar::all(0), cv::Scalar::all(255));
+    preprocessor.setSwapRB(true);
+    std::vector<float> blob(416 * 416 * 3, -1000);
+    preprocessor.run(image, blob.data());
+
+    ASSERT_LE(maxLevelDifference(expected, blob, 1.0 / 255), 1.0 + 1e-4) << size;
+    ASSERT_DOUBLE_EQ(preprocessor.ratio(), 416.0 / size.width);
+    ASSERT_EQ(preprocessor.borderLeft(), 0);
+    ASSERT_EQ(preprocessor.borderTop(), (416 - static_cast<int>(std::lrint(size.height * 416.0 / size.width))) / 2);
+    // the borders are exactly black
+    ASSERT_EQ(blob[0], 0.f);
+    ASSERT_EQ(blob[416 * 416 * 3 - 1], 0.f);
+  }
+}
+
+TEST(TestBlobPreprocessor, channelConversion)
+{
+  cv::Mat image = createImage(480, 640, true);
+  cv::Mat bgra;
+  cv::cvtColor(image, bgra, cv::COLOR_BGR2BGRA);
+
+  vision_detector::BlobPreprocessor preprocessor(320, 240, 3);
+  std::vector<float> from_bgr(320 * 240 * 3), from_bgra(320 * 240 * 3);
+  preprocessor.run(image, from_bgr.data());
+  preprocessor.run(bgra, from_bgra.data());
+  ASSERT_EQ(from_bgr, from_bgra);
+
+  cv::Mat gray;
+  cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
+  cv::Mat gray_resized, expected;
+  cv::resize(gray, gray_resized, cv::Size(320, 240));
+  gray_resized.convertTo(expected, CV_32FC1);
+
+  vision_detector::BlobPreprocessor gray_preprocessor(320, 240, 1);
+  std::vector<float> blob(320 * 240);
+  gray_preprocessor.run(image, blob.data());
+  ASSERT_LE(maxLevelDifference(std::vector<float>(expected.begin<float>(), expected.end<float>()), blob, 1.0),
+            1.0 + 1e-4);
+}
+
+TEST(TestBlobPreprocessor, benchmark)
+{
+  struct Case
+  {
+    cv::Size image;
+    cv::Size network;
+    bool letterbox;
+  };
+  const Case cases[] = { { cv::Size(1920, 1080), cv::Size(416, 416), true },
+                         { cv::Size(1280, 720), cv::Size(300, 300), false },
+                         { cv::Size(1280, 720), cv::Size(1024, 512), false } };
+  const int iterations = 50;
+  for (const Case& c : cases)
+  {
+    cv::Mat image = createImage(c.image.height, c.image.width, true);
+    vision_detector::BlobPreprocessor preprocessor(
+        c.network.width, c.network.height, 3,
+        c.letterbox ? vision_detector::BlobPreprocessor::LETTERBOX : vision_detector::BlobPreprocessor::STRETCH);
+    if (c.letterbox)
+    {
+      preprocessor.setNormalization(cv::Scalar::all(0), cv::Scalar::all(255));
+      preprocessor.setSwapRB(true);
+    }
+    std::vector<float> blob(c.network.area() * 3);
+
+    auto start = std::chrono::steady_clock::now();
+    double checksum = 0;
+    for (int i = 0; i < iterations; ++i)
+    {
+      std::vector<float> previous = c.letterbox ? darknetPreprocess(image, c.network.width, c.network.height) :
+                                                  caffePreprocess(image, c.network, cv::Scalar::all(0));
+      checksum += previous[i];
+    }
+    const double previous_msec =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+      preprocessor.run(image, blob.data());
+      checksum += blob[i];
+    }
+    const double fused_msec =
+        std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+    std::printf("[ %4dx%4d -> %4dx%4d %s ] previous: %7.3f ms, fused: %7.3f ms (checksum %g)\n", c.image.width,
+                c.image.height, c.network.width, c.network.height, c.letterbox ? "letterbox" : "stretch  ",
+                previous_msec, fused_msec, checksum);
+  }
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
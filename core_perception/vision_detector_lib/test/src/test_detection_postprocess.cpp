@@ -0,0 +1,318 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "vision_detector_lib/detection_postprocess.hpp"
+
+using vision_detector::CenterBox;
+
+namespace
+{
+struct Rect
+{
+  float x, y, w, h, score;
+  int class_type;
+  bool enabled;
+};
+
+// darknet's detection and do_nms_sort, with the index of the box to follow it through the sorting
+struct Detection
+{
+  CenterBox bbox;
+  std::vector<float> prob;
+  float objectness;
+  int sort_class;
+  int index;
+};
+
+void doNmsSort(std::vector<Detection>& dets, const int classes, const float thresh)
+{
+  int total = static_cast<int>(dets.size());
+  int k = total - 1;
+  for (int i = 0; i <= k; ++i)
+  {
+    if (dets[i].objectness == 0)
+    {
+      std::swap(dets[i], dets[k]);
+      --k;
+      --i;
+    }
+  }
+  total = k + 1;
+
+  for (k = 0; k < classes; ++k)
+  {
+    for (int i = 0; i < total; ++i)
+      dets[i].sort_class = k;
+    std::sort(dets.begin(), dets.begin() + total, [k](const Detection& a, const Detection& b) {
+      return a.prob[k] > b.prob[k] || (a.prob[k] == b.prob[k] && a.index < b.index);
+    });
+    for (int i = 0; i < total; ++i)
+    {
+      if (dets[i].prob[k] == 0)
+        continue;
+      for (int j = i + 1; j < total; ++j)
+      {
+        if (vision_detector::boxIou(dets[i].bbox, dets[j].bbox) > thresh)
+          dets[j].prob[k] = 0;
+      }
+    }
+  }
+}
+
+// overlapping boxes around a few objects, probabilities below the threshold already zeroed as get_network_boxes does
+std::vector<Detection> createDetections(const int num_boxes, const int num_classes, const float threshold,
+                                        std::mt19937& gen)
+{
+  std::uniform_real_distribution<float> center(0, 416);
+  std::normal_distribution<float> jitter(0, 8);
+  std::uniform_real_distribution<float> size(20, 120);
+  std::uniform_real_distribution<float> score(0, 1);
+  std::uniform_int_distribution<int> object(0, 15);
+
+  std::vector<CenterBox> objects(16);
+  for (CenterBox& o : objects)
+    o = { center(gen), center(gen), size(gen), size(gen) };
+
+  std::vector<Detection> dets(num_boxes);
+  for (int i = 0; i < num_boxes; ++i)
+  {
+    const CenterBox& o = objects[object(gen)];
+    dets[i].bbox = { o.x + jitter(gen), o.y + jitter(gen), o.w + jitter(gen), o.h + jitter(gen) };
+    dets[i].objectness = score(gen) < 0.1f ? 0 : score(gen);
+    dets[i].prob.resize(num_classes);
+    for (float& p : dets[i].prob)
+    {
+      const float value = dets[i].objectness * score(gen);
+      p = value > threshold ? value : 0;
+    }
+    dets[i].index = i;
+  }
+  return dets;
+}
+
+std::set<std::tuple<int, int, float> > keptSet(const std::vector<Detection>& dets, const int num_classes)
+{
+  std::set<std::tuple<int, int, float> > kept;
+  for (const Detection& d : dets)
+    for (int k = 0; k < num_classes; ++k)
+      if (d.prob[k] != 0)
+        kept.insert(std::make_tuple(d.index, k, d.prob[k]));
+  return kept;
+}
+}  // namespace
+
+TEST(TestDetectionPostprocess, boxIou)
+{
+  CenterBox a = { 10, 10, 10, 10 };
+  CenterBox b = { 15, 10, 10, 10 };
+  CenterBox c = { 100, 100, 10, 10 };
+  EXPECT_FLOAT_EQ(vision_detector::boxIou(a, a), 1.f);
+  EXPECT_FLOAT_EQ(vision_detector::boxIou(a, b), 50.f / 150.f);
+  EXPECT_FLOAT_EQ(vision_detector::boxIou(a, c), 0.f);
+}
+
+TEST(TestDetectionPostprocess, sameAsDoNmsSort)
+{
+  std::mt19937 gen(0);
+  const int num_classes = 20;
+  const float threshold = 0.3f;
+  vision_detector::PerClassNms nms;
+  for (int trial = 0; trial < 50; ++trial)
+  {
+    std::vector<Detection> expected = createDetections(300, num_classes, threshold, gen);
+
+    // only boxes with an objectness take part, as in the node
+    std::vector<CenterBox> boxes;
+    std::vector<float> probs;
+    std::vector<int> indices;
+    for (const Detection& d : expected)
+    {
+      if (d.objectness == 0)
+        continue;
+      boxes.push_back(d.bbox);
+      probs.insert(probs.end(), d.prob.begin(), d.prob.end());
+      indices.push_back(d.index);
+    }
+
+    for (const float nms_threshold : { 0.3f, 0.45f })
+    {
+      std::vector<Detection> reference = expected;
+      doNmsSort(reference, num_classes, nms_threshold);
+      // boxes without objectness are left out of the suppression
+      for (Detection& d : reference)
+        if (d.objectness == 0)
+          std::fill(d.prob.begin(), d.prob.end(), 0.f);
+
+      std::vector<float> actual_probs = probs;
+      nms.run(boxes, actual_probs.data(), num_classes, nms_threshold);
+      std::vector<Detection> actual(boxes.size());
+      for (size_t i = 0; i < boxes.size(); ++i)
+      {
+        actual[i].index = indices[i];
+        actual[i].prob.assign(actual_probs.begin() + i * num_classes, actual_probs.begin() + (i + 1) * num_classes);
+      }
+      ASSERT_EQ(keptSet(reference, num_classes), keptSet(actual, num_classes));
+    }
+  }
+}
+
+TEST(TestDetectionPostprocess, decode)
+{
+  std::vector<CenterBox> boxes = { { 50, 60, 20, 40 }, { 10, 10, 4, 4 } };
+  std::vector<float> probs = { 0.f, 0.6f, 0.9f, 0.2f, 0.f, 0.f };
+  std::vector<Rect> rects;
+  vision_detector::decodeCenterBoxes(boxes, probs.data(), 3, 0.5f, rects);
+  ASSERT_EQ(rects.size(), 1u);
+  EXPECT_FLOAT_EQ(rects[0].x, 40.f);
+  EXPECT_FLOAT_EQ(rects[0].y, 40.f);
+  EXPECT_FLOAT_EQ(rects[0].w, 20.f);
+  EXPECT_FLOAT_EQ(rects[0].h, 40.f);
+  EXPECT_FLOAT_EQ(rects[0].score, 0.6f);
+  EXPECT_EQ(rects[0].class_type, 1);
+
+  std::vector<float> result = { 0, 3, 0.8f, 0.1f, 0.2f, 0.5f, 0.6f, -1, 1, 0.9f, 0, 0, 1, 1 };
+  rects.clear();
+  vision_detector::decodeDetectionOutput(result.data(), 2, 1000, 500, rects);
+  ASSERT_EQ(rects.size(), 1u);
+  EXPECT_EQ(rects[0].class_type, 3);
+  EXPECT_FLOAT_EQ(rects[0].score, 0.8f);
+  EXPECT_FLOAT_EQ(rects[0].x, 100.f);
+  EXPECT_FLOAT_EQ(rects[0].y, 100.f);
+  EXPECT_FLOAT_EQ(rects[0].w, 400.f);
+  EXPECT_FLOAT_EQ(rects[0].h, 200.f);
+}
+
+TEST(TestDetectionPostprocess, argmaxChannels)
+{
+  std::mt19937 gen(1);
+  std::uniform_int_distribution<int> level(0, 7);
+  const int channels = 12, num_pixels = 1000;
+  // coarse scores, so that ties between channels are frequent
+  std::vector<float> scores(channels * num_pixels);
+  for (float& s : scores)
+    s = static_cast<float>(level(gen));
+
+  std::vector<uint8_t> labels(num_pixels);
+  vision_detector::argmaxChannels(scores.data(), channels, num_pixels, labels.data());
+  for (int i = 0; i < num_pixels; ++i)
+  {
+    // first maximum of the pixel, as minMaxLoc on the transposed scores
+    int expected = 0;
+    for (int c = 1; c < channels; ++c)
+      if (scores[c * num_pixels + i] > scores[expected * num_pixels + i])
+        expected = c;
+    ASSERT_EQ(labels[i], expected) << i;
+  }
+}
+
+TEST(TestDetectionPostprocess, benchmark)
+{
+  std::mt19937 gen(2);
+  // yolov3 at 416x416, 80 classes
+  const int num_boxes = 10647, num_classes = 80, iterations = 5;
+  const float threshold = 0.5f, nms_threshold = 0.45f;
+  std::vector<Detection> dets = createDetections(num_boxes, num_classes, threshold, gen);
+  // most boxes of a real frame have no class above the threshold
+  for (int i = 0; i < num_boxes; ++i)
+    if (i % 50 != 0)
+      std::fill(dets[i].prob.begin(), dets[i].prob.end(), 0.f);
+
+  auto start = std::chrono::steady_clock::now();
+  size_t n_previous = 0;
+  for (int it = 0; it < iterations; ++it)
+  {
+    std::vector<Detection> reference = dets;
+    doNmsSort(reference, num_classes, nms_threshold);
+    n_previous += keptSet(reference, num_classes).size();
+  }
+  const double previous_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  vision_detector::PerClassNms nms;
+  start = std::chrono::steady_clock::now();
+  size_t n_nms = 0;
+  for (int it = 0; it < iterations; ++it)
+  {
+    std::vector<CenterBox> boxes;
+    std::vector<float> probs;
+    for (const Detection& d : dets)
+    {
+      if (d.objectness == 0 || std::all_of(d.prob.begin(), d.prob.end(), [](float p) { return p == 0; }))
+        continue;
+      boxes.push_back(d.bbox);
+      probs.insert(probs.end(), d.prob.begin(), d.prob.end());
+    }
+    nms.run(boxes, probs.data(), num_classes, nms_threshold);
+    n_nms += std::count_if(probs.begin(), probs.end(), [](float p) { return p != 0; });
+  }
+  const double nms_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  // enet output, 20 classes at 1024x512
+  const int channels = 20, num_pixels = 1024 * 512;
+  std::vector<float> scores(channels * num_pixels);
+  std::uniform_real_distribution<float> score(0, 1);
+  for (float& s : scores)
+    s = score(gen);
+  std::vector<uint8_t> labels(num_pixels), expected(num_pixels);
+
+  start = std::chrono::steady_clock::now();
+  for (int it = 0; it < iterations; ++it)
+  {
+    // the previous transposition followed by a search of each pixel row
+    std::vector<float> transposed(scores.size());
+    for (int c = 0; c < channels; ++c)
+      for (int i = 0; i < num_pixels; ++i)
+        transposed[i * channels + c] = scores[c * num_pixels + i];
+    for (int i = 0; i < num_pixels; ++i)
+    {
+      const float* row = &transposed[i * channels];
+      expected[i] = static_cast<uint8_t>(std::max_element(row, row + channels) - row);
+    }
+  }
+  const double transpose_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  start = std::chrono::steady_clock::now();
+  for (int it = 0; it < iterations; ++it)
+    vision_detector::argmaxChannels(scores.data(), channels, num_pixels, labels.data());
+  const double argmax_msec =
+      std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / iterations;
+
+  std::printf("[ %d boxes, %d classes ] do_nms_sort: %7.3f ms, per class nms: %7.3f ms\n", num_boxes, num_classes,
+              previous_msec, nms_msec);
+  std::printf("[ %d pixels, %d classes ] transpose and search: %7.3f ms, blocked argmax: %7.3f ms\n", num_pixels,
+              channels, transpose_msec, argmax_msec);
+  EXPECT_EQ(n_previous, n_nms);
+  EXPECT_EQ(expected, labels);
+}
+
+int main(int argc, char** argv)
+{
+  testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
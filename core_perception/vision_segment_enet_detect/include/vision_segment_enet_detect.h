@@ -21,6 +21,8 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include <vision_detector_lib/blob_preprocessor.hpp>
+
 class ENetSegmenter
 {
 public:
@@ -31,11 +33,9 @@ public:
 private:
 	void SetMean(const std::string& in_mean_file);
 
-	void WrapInputLayer(std::vector<cv::Mat>* in_input_channels);
-
-	void Preprocess(const cv::Mat& img, std::vector<cv::Mat>* in_input_channels);
+	void Preprocess(const cv::Mat& img, float* in_input_data);
 
-	cv::Mat Visualization(cv::Mat in_prediction_map, std::string in_lookuptable_file);
+	cv::Mat Visualization(const cv::Mat& in_prediction_map);
 
 private:
 	std::shared_ptr<caffe::Net<float> > 	net_;
@@ -43,6 +43,9 @@ private:
 	int 						num_channels_;
 	std::string 				lookuptable_file_;
 	cv::Scalar 					pixel_mean_;
+	cv::Mat 					label_colours_;
+	cv::Mat 					prediction_map_;
+	std::unique_ptr<vision_detector::BlobPreprocessor> preprocessor_;
 
 };
 
@@ -14,6 +14,8 @@
 #include <opencv2/highgui/highgui.hpp>
 #include <opencv2/imgproc/imgproc.hpp>
 
+#include <vision_detector_lib/blob_preprocessor.hpp>
+
 #include "rect_class_score.h"
 
 namespace SSD
@@ -39,15 +41,14 @@ public:
 private:
   void SetMean(const cv::Scalar &in_mean_value);
 
-  void WrapInputLayer(std::vector<cv::Mat> *input_channels);
-
-  void Preprocess(const cv::Mat &img, std::vector<cv::Mat> *input_channels);
+  void Preprocess(const cv::Mat &img, float *input_data);
 
 private:
   boost::shared_ptr <caffe::Net<float> > net_;
   cv::Size input_geometry_;
   int num_channels_;
   cv::Scalar mean_;
+  std::unique_ptr<vision_detector::BlobPreprocessor> preprocessor_;
 };
 
 #endif //SSD_DETECTOR_H
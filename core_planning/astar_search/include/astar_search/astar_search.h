@@ -17,6 +17,7 @@
 #ifndef ASTER_PLANNER_H
 #define ASTER_PLANNER_H
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <queue>
@@ -30,6 +31,7 @@
 #include <nav_msgs/Path.h>
 
 #include "astar_search/astar_util.h"
+#include "astar_search/reeds_shepp.h"
 
 class AstarSearch
 {
@@ -61,6 +63,7 @@ private:
   bool detectCollision(const SimpleNode& sn);
   bool calcWaveFrontHeuristic(const SimpleNode& sn);
   bool detectCollisionWaveFront(const WaveFrontNode& sn);
+  bool tryAnalyticExpansion(const AstarNode& node);
 
   // ros param
   ros::NodeHandle n_;
@@ -90,11 +93,18 @@ private:
   double potential_weight_;           // weight of potential cost [-]
   double distance_heuristic_weight_;  // obstacle threshold on grid [0,255]
 
+  // analytic expansion configs
+  bool use_analytic_expansion_;       // connect nodes to the goal by Reeds-Shepp (Dubins if !use_back_) paths
+  int analytic_expansion_interval_;   // try the connection every this many expanded nodes [-]
+  double analytic_expansion_range_;   // try the connection only within this distance to the goal [m]
+
   // hybrid astar variables
   std::vector<std::vector<NodeUpdate>> state_update_table_;
   std::vector<std::vector<std::vector<AstarNode>>> nodes_;
   std::priority_queue<SimpleNode, std::vector<SimpleNode>, std::greater<SimpleNode>> openlist_;
   std::vector<SimpleNode> goallist_;
+  int expanded_node_count_;                    // expanded nodes in the last search
+  std::vector<ReedsSheppPose> analytic_path_;  // collision free path from the last node of setPath to the goal
 
   // costmap as occupancy grid
   nav_msgs::OccupancyGrid costmap_;
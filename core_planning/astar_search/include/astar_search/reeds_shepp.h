@@ -0,0 +1,65 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef REEDS_SHEPP_H
+#define REEDS_SHEPP_H
+
+#include <vector>
+
+// Shortest paths between two poses of a car with a minimum turning radius, used as analytic expansion of the search.
+// Reeds-Shepp paths move forward and backward, Dubins paths only forward.
+// The Reeds-Shepp formulas follow J. A. Reeds and L. A. Shepp, "Optimal paths for a car that goes both forwards and
+// backwards", Pacific Journal of Mathematics, 1990.
+
+struct ReedsSheppPath
+{
+  enum SegmentType
+  {
+    NOP,
+    LEFT,
+    STRAIGHT,
+    RIGHT
+  };
+
+  SegmentType type[5];
+  double length[5];       // signed length of each segment divided by turning radius, negative if backward
+  double turning_radius;  // [m]
+
+  ReedsSheppPath();
+
+  // sum of the segment lengths [m], infinity if there is no path
+  double totalLength() const;
+};
+
+struct ReedsSheppPose
+{
+  double x, y, theta;
+  bool back;  // true if the vehicle moves backward to this pose
+};
+
+// The path minimizes its length plus switch_cost [m] for each change of the moving direction, the direction before
+// the path is backward if start_back
+ReedsSheppPath calcReedsSheppPath(double x0, double y0, double theta0, double x1, double y1, double theta1,
+                                  double turning_radius, double switch_cost = 0.0, bool start_back = false);
+
+ReedsSheppPath calcDubinsPath(double x0, double y0, double theta0, double x1, double y1, double theta1,
+                              double turning_radius);
+
+// Sample poses every step [m] along the path from (x0, y0, theta0), start excluded, end included
+void interpolateReedsSheppPath(const ReedsSheppPath& path, double x0, double y0, double theta0, double step,
+                               std::vector<ReedsSheppPose>* poses);
+
+#endif
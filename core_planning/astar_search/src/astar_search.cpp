@@ -45,6 +45,14 @@ AstarSearch::AstarSearch()
   private_nh_.param<double>("potential_weight", potential_weight_, 10.0);
   private_nh_.param<double>("distance_heuristic_weight", distance_heuristic_weight_, 1.0);
 
+  // analytic expansion configs
+  private_nh_.param<bool>("use_analytic_expansion", use_analytic_expansion_, false);
+  private_nh_.param<int>("analytic_expansion_interval", analytic_expansion_interval_, 5);
+  private_nh_.param<double>("analytic_expansion_range", analytic_expansion_range_, 30.0);
+  analytic_expansion_interval_ = std::max(analytic_expansion_interval_, 1);
+
+  expanded_node_count_ = 0;
+
   createStateUpdateTable();
 }
 
@@ -335,6 +343,8 @@ bool AstarSearch::isOutOfRange(int index_x, int index_y)
 bool AstarSearch::search()
 {
   ros::WallTime begin = ros::WallTime::now();
+  expanded_node_count_ = 0;
+  analytic_path_.clear();
 
   // Start A* search
   // If the openlist is empty, search failed
@@ -365,6 +375,17 @@ bool AstarSearch::search()
       return true;
     }
 
+    // Analytic expansion, the rest of the path is a Reeds-Shepp (Dubins) curve to the exact goal pose if it is free
+    if (use_analytic_expansion_ && expanded_node_count_ % analytic_expansion_interval_ == 0 &&
+        calcDistance(current_an->x, current_an->y, goal_pose_local_.pose.position.x,
+                     goal_pose_local_.pose.position.y) < analytic_expansion_range_ &&
+        tryAnalyticExpansion(*current_an))
+    {
+      setPath(top_sn);
+      return true;
+    }
+    expanded_node_count_++;
+
     // Expand nodes
     for (const auto& state : state_update_table_[top_sn.index_theta])
     {
@@ -489,6 +510,56 @@ void AstarSearch::setPath(const SimpleNode& goal)
 
   // Reverse the vector to be start to goal order
   std::reverse(path_.poses.begin(), path_.poses.end());
+
+  // Append the analytic expansion from the last node to the goal
+  for (const auto& p : analytic_path_)
+  {
+    geometry_msgs::PoseStamped ros_pose;
+    ros_pose.pose = xytToPoseMsg(p.x, p.y, p.theta);
+    ros_pose.header = header;
+    path_.poses.push_back(ros_pose);
+  }
+}
+
+// Connect the node to the goal pose with the cheapest path of the vehicle
+// The path is sampled every grid cell and checked with the footprint of detectCollision
+bool AstarSearch::tryAnalyticExpansion(const AstarNode& node)
+{
+  const double goal_x = goal_pose_local_.pose.position.x;
+  const double goal_y = goal_pose_local_.pose.position.y;
+
+  // A change of the moving direction costs reverse_weight_ times a step in the search, the same is charged here
+  const double step = minimum_turning_radius_ * 2.0 * M_PI / theta_size_;
+  const double switch_cost = (reverse_weight_ - 1.0) * step;
+
+  ReedsSheppPath rs_path = use_back_ ? calcReedsSheppPath(node.x, node.y, node.theta, goal_x, goal_y, goal_yaw_,
+                                                          minimum_turning_radius_, switch_cost, node.back) :
+                                       calcDubinsPath(node.x, node.y, node.theta, goal_x, goal_y, goal_yaw_,
+                                                      minimum_turning_radius_);
+
+  interpolateReedsSheppPath(rs_path, node.x, node.y, node.theta, costmap_.info.resolution, &analytic_path_);
+  if (analytic_path_.empty())
+  {
+    return false;
+  }
+
+  for (const auto& p : analytic_path_)
+  {
+    SimpleNode sn;
+    poseToIndex(xytToPoseMsg(p.x, p.y, p.theta), &sn.index_x, &sn.index_y, &sn.index_theta);
+    if (isOutOfRange(sn.index_x, sn.index_y) || detectCollision(sn))
+    {
+      analytic_path_.clear();
+      return false;
+    }
+  }
+
+  // End exactly at the goal
+  analytic_path_.back().x = goal_x;
+  analytic_path_.back().y = goal_y;
+  analytic_path_.back().theta = goal_yaw_;
+
+  return true;
 }
 
 // Check if the next state is the goal
@@ -534,11 +605,11 @@ bool AstarSearch::isObs(int index_x, int index_y)
 bool AstarSearch::detectCollision(const SimpleNode& sn)
 {
   // Define the robot as rectangle
-  static double left = -1.0 * robot_base2back_;
-  static double right = robot_length_ - robot_base2back_;
-  static double top = robot_width_ / 2.0;
-  static double bottom = -1.0 * robot_width_ / 2.0;
-  static double resolution = costmap_.info.resolution;
+  const double left = -1.0 * robot_base2back_;
+  const double right = robot_length_ - robot_base2back_;
+  const double top = robot_width_ / 2.0;
+  const double bottom = -1.0 * robot_width_ / 2.0;
+  const double resolution = costmap_.info.resolution;
 
   // Coordinate of base_link in OccupancyGrid frame
   static double one_angle_range = 2.0 * M_PI / theta_size_;
@@ -681,6 +752,7 @@ bool AstarSearch::detectCollisionWaveFront(const WaveFrontNode& ref)
 void AstarSearch::reset()
 {
   path_.poses.clear();
+  analytic_path_.clear();
 
   // Clear queue
   std::priority_queue<SimpleNode, std::vector<SimpleNode>, std::greater<SimpleNode>> empty;
@@ -0,0 +1,679 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "astar_search/reeds_shepp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+typedef ReedsSheppPath::SegmentType Seg;
+
+const Seg L = ReedsSheppPath::LEFT;
+const Seg S = ReedsSheppPath::STRAIGHT;
+const Seg R = ReedsSheppPath::RIGHT;
+const Seg N = ReedsSheppPath::NOP;
+
+const Seg RS_TYPES[18][5] = {
+  { L, R, L, N, N },  // 0
+  { R, L, R, N, N },  // 1
+  { L, R, L, R, N },  // 2
+  { R, L, R, L, N },  // 3
+  { L, R, S, L, N },  // 4
+  { R, L, S, R, N },  // 5
+  { L, S, R, L, N },  // 6
+  { R, S, L, R, N },  // 7
+  { L, R, S, R, N },  // 8
+  { R, L, S, L, N },  // 9
+  { R, S, R, L, N },  // 10
+  { L, S, L, R, N },  // 11
+  { L, S, R, N, N },  // 12
+  { R, S, L, N, N },  // 13
+  { L, S, L, N, N },  // 14
+  { R, S, R, N, N },  // 15
+  { L, R, S, L, R },  // 16
+  { R, L, S, R, L },  // 17
+};
+
+const Seg DUBINS_TYPES[6][3] = {
+  { L, S, L },  // LSL
+  { L, S, R },  // LSR
+  { R, S, L },  // RSL
+  { R, S, R },  // RSR
+  { R, L, R },  // RLR
+  { L, R, L },  // LRL
+};
+
+const double RS_ZERO = 10 * std::numeric_limits<double>::epsilon();
+const double DUBINS_EPS = 1e-6;
+const double DUBINS_ZERO = -1e-9;
+
+// Normalized lengths of the best path found so far
+struct Candidate
+{
+  const Seg* type;
+  int size;
+  double length[5];
+  double sum;
+  double cost;         // sum plus the switch cost of each change of the moving direction
+  double switch_cost;  // normalized
+  bool start_back;     // moving direction before the path
+};
+
+void setCandidate(Candidate* c, const Seg* type, int size, double t, double u, double v, double w = 0.0,
+                  double x = 0.0)
+{
+  c->type = type;
+  c->size = size;
+  c->length[0] = t;
+  c->length[1] = u;
+  c->length[2] = v;
+  c->length[3] = w;
+  c->length[4] = x;
+  c->sum = std::fabs(t) + std::fabs(u) + std::fabs(v) + std::fabs(w) + std::fabs(x);
+}
+
+// Replace the candidate if the path is cheaper, zero length segments do not change the moving direction
+void updateCandidate(Candidate* c, const Seg* type, int size, double t, double u, double v, double w = 0.0,
+                     double x = 0.0)
+{
+  const double length[5] = { t, u, v, w, x };
+  double cost = 0.0;
+  bool back = c->start_back;
+  for (int i = 0; i < size; i++)
+  {
+    cost += std::fabs(length[i]);
+    if (std::fabs(length[i]) > RS_ZERO && (length[i] < 0) != back)
+    {
+      back = !back;
+      cost += c->switch_cost;
+    }
+  }
+  if (cost < c->cost)
+  {
+    setCandidate(c, type, size, t, u, v, w, x);
+    c->cost = cost;
+  }
+}
+
+// to [-pi, pi]
+inline double mod2pi(double x)
+{
+  double v = std::fmod(x, 2.0 * M_PI);
+  if (v < -M_PI)
+    v += 2.0 * M_PI;
+  else if (v > M_PI)
+    v -= 2.0 * M_PI;
+  return v;
+}
+
+// to [0, 2pi)
+inline double mod2piPositive(double x)
+{
+  if (x < 0 && x > -RS_ZERO)
+    return 0;
+  double v = x - 2.0 * M_PI * std::floor(x / (2.0 * M_PI));
+  if (2.0 * M_PI - v < 0.5 * DUBINS_EPS)
+    v = 0;
+  return v;
+}
+
+inline void polar(double x, double y, double* r, double* theta)
+{
+  *r = std::sqrt(x * x + y * y);
+  *theta = std::atan2(y, x);
+}
+
+inline void tauOmega(double u, double v, double xi, double eta, double phi, double* tau, double* omega)
+{
+  double delta = mod2pi(u - v);
+  double a = std::sin(u) - std::sin(delta);
+  double b = std::cos(u) - std::cos(delta) - 1.0;
+  double t1 = std::atan2(eta * a - xi * b, xi * a + eta * b);
+  double t2 = 2.0 * (std::cos(delta) - std::cos(v) - std::cos(u)) + 3.0;
+  *tau = (t2 < 0) ? mod2pi(t1 + M_PI) : mod2pi(t1);
+  *omega = mod2pi(*tau - u + v - phi);
+}
+
+// formula 8.1
+bool LpSpLp(double x, double y, double phi, double* t, double* u, double* v)
+{
+  polar(x - std::sin(phi), y - 1.0 + std::cos(phi), u, t);
+  if (*t >= -RS_ZERO)
+  {
+    *v = mod2pi(phi - *t);
+    if (*v >= -RS_ZERO)
+      return true;
+  }
+  return false;
+}
+
+// formula 8.2
+bool LpSpRp(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double t1, u1;
+  polar(x + std::sin(phi), y - 1.0 - std::cos(phi), &u1, &t1);
+  u1 = u1 * u1;
+  if (u1 >= 4.0)
+  {
+    *u = std::sqrt(u1 - 4.0);
+    double theta = std::atan2(2.0, *u);
+    *t = mod2pi(t1 + theta);
+    *v = mod2pi(*t - phi);
+    return *t >= -RS_ZERO && *v >= -RS_ZERO;
+  }
+  return false;
+}
+
+// formula 8.3 / 8.4, with the typo of the paper corrected
+bool LpRmL(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double xi = x - std::sin(phi), eta = y - 1.0 + std::cos(phi), u1, theta;
+  polar(xi, eta, &u1, &theta);
+  if (u1 <= 4.0)
+  {
+    *u = -2.0 * std::asin(0.25 * u1);
+    *t = mod2pi(theta + 0.5 * *u + M_PI);
+    *v = mod2pi(phi - *t + *u);
+    return *t >= -RS_ZERO && *u <= RS_ZERO;
+  }
+  return false;
+}
+
+// formula 8.7
+bool LpRupLumRm(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi);
+  double rho = 0.25 * (2.0 + std::sqrt(xi * xi + eta * eta));
+  if (rho <= 1.0)
+  {
+    *u = std::acos(rho);
+    tauOmega(*u, -*u, xi, eta, phi, t, v);
+    return *t >= -RS_ZERO && *v <= RS_ZERO;
+  }
+  return false;
+}
+
+// formula 8.8
+bool LpRumLumRp(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi);
+  double rho = (20.0 - xi * xi - eta * eta) / 16.0;
+  if (rho >= 0 && rho <= 1)
+  {
+    *u = -std::acos(rho);
+    if (*u >= -0.5 * M_PI)
+    {
+      tauOmega(*u, *u, xi, eta, phi, t, v);
+      return *t >= -RS_ZERO && *v >= -RS_ZERO;
+    }
+  }
+  return false;
+}
+
+// formula 8.9
+bool LpRmSmLm(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double xi = x - std::sin(phi), eta = y - 1.0 + std::cos(phi), rho, theta;
+  polar(xi, eta, &rho, &theta);
+  if (rho >= 2.0)
+  {
+    double r = std::sqrt(rho * rho - 4.0);
+    *u = 2.0 - r;
+    *t = mod2pi(theta + std::atan2(r, -2.0));
+    *v = mod2pi(phi - 0.5 * M_PI - *t);
+    return *t >= -RS_ZERO && *u <= RS_ZERO && *v <= RS_ZERO;
+  }
+  return false;
+}
+
+// formula 8.10
+bool LpRmSmRm(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi), rho, theta;
+  polar(-eta, xi, &rho, &theta);
+  if (rho >= 2.0)
+  {
+    *t = theta;
+    *u = 2.0 - rho;
+    *v = mod2pi(*t + 0.5 * M_PI - phi);
+    return *t >= -RS_ZERO && *u <= RS_ZERO && *v <= RS_ZERO;
+  }
+  return false;
+}
+
+// formula 8.11, with the typo of the paper corrected
+bool LpRmSLmRp(double x, double y, double phi, double* t, double* u, double* v)
+{
+  double xi = x + std::sin(phi), eta = y - 1.0 - std::cos(phi), rho, theta;
+  polar(xi, eta, &rho, &theta);
+  if (rho >= 2.0)
+  {
+    *u = 4.0 - std::sqrt(rho * rho - 4.0);
+    if (*u <= RS_ZERO)
+    {
+      *t = mod2pi(std::atan2((4.0 - *u) * xi - 2.0 * eta, -2.0 * xi + (*u - 4.0) * eta));
+      *v = mod2pi(*t - phi);
+      return *t >= -RS_ZERO && *v >= -RS_ZERO;
+    }
+  }
+  return false;
+}
+
+// Each family is tried on the goal as is, time-flipped (backward), reflected (left <-> right) and both
+void CSC(double x, double y, double phi, Candidate* c)
+{
+  double t, u, v;
+  if (LpSpLp(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[14], 3, t, u, v);
+  if (LpSpLp(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[14], 3, -t, -u, -v);
+  if (LpSpLp(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[15], 3, t, u, v);
+  if (LpSpLp(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[15], 3, -t, -u, -v);
+  if (LpSpRp(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[12], 3, t, u, v);
+  if (LpSpRp(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[12], 3, -t, -u, -v);
+  if (LpSpRp(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[13], 3, t, u, v);
+  if (LpSpRp(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[13], 3, -t, -u, -v);
+}
+
+void CCC(double x, double y, double phi, Candidate* c)
+{
+  double t, u, v;
+  if (LpRmL(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[0], 3, t, u, v);
+  if (LpRmL(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[0], 3, -t, -u, -v);
+  if (LpRmL(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[1], 3, t, u, v);
+  if (LpRmL(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[1], 3, -t, -u, -v);
+
+  // backwards
+  double xb = x * std::cos(phi) + y * std::sin(phi);
+  double yb = x * std::sin(phi) - y * std::cos(phi);
+  if (LpRmL(xb, yb, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[0], 3, v, u, t);
+  if (LpRmL(-xb, yb, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[0], 3, -v, -u, -t);
+  if (LpRmL(xb, -yb, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[1], 3, v, u, t);
+  if (LpRmL(-xb, -yb, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[1], 3, -v, -u, -t);
+}
+
+void CCCC(double x, double y, double phi, Candidate* c)
+{
+  double t, u, v;
+  if (LpRupLumRm(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[2], 4, t, u, -u, v);
+  if (LpRupLumRm(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[2], 4, -t, -u, u, -v);
+  if (LpRupLumRm(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[3], 4, t, u, -u, v);
+  if (LpRupLumRm(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[3], 4, -t, -u, u, -v);
+
+  if (LpRumLumRp(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[2], 4, t, u, u, v);
+  if (LpRumLumRp(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[2], 4, -t, -u, -u, -v);
+  if (LpRumLumRp(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[3], 4, t, u, u, v);
+  if (LpRumLumRp(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[3], 4, -t, -u, -u, -v);
+}
+
+void CCSC(double x, double y, double phi, Candidate* c)
+{
+  const double h = 0.5 * M_PI;
+  double t, u, v;
+  if (LpRmSmLm(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[4], 4, t, -h, u, v);
+  if (LpRmSmLm(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[4], 4, -t, h, -u, -v);
+  if (LpRmSmLm(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[5], 4, t, -h, u, v);
+  if (LpRmSmLm(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[5], 4, -t, h, -u, -v);
+
+  if (LpRmSmRm(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[8], 4, t, -h, u, v);
+  if (LpRmSmRm(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[8], 4, -t, h, -u, -v);
+  if (LpRmSmRm(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[9], 4, t, -h, u, v);
+  if (LpRmSmRm(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[9], 4, -t, h, -u, -v);
+
+  // backwards
+  double xb = x * std::cos(phi) + y * std::sin(phi);
+  double yb = x * std::sin(phi) - y * std::cos(phi);
+  if (LpRmSmLm(xb, yb, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[6], 4, v, u, -h, t);
+  if (LpRmSmLm(-xb, yb, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[6], 4, -v, -u, h, -t);
+  if (LpRmSmLm(xb, -yb, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[7], 4, v, u, -h, t);
+  if (LpRmSmLm(-xb, -yb, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[7], 4, -v, -u, h, -t);
+
+  if (LpRmSmRm(xb, yb, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[10], 4, v, u, -h, t);
+  if (LpRmSmRm(-xb, yb, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[10], 4, -v, -u, h, -t);
+  if (LpRmSmRm(xb, -yb, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[11], 4, v, u, -h, t);
+  if (LpRmSmRm(-xb, -yb, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[11], 4, -v, -u, h, -t);
+}
+
+void CCSCC(double x, double y, double phi, Candidate* c)
+{
+  const double h = 0.5 * M_PI;
+  double t, u, v;
+  if (LpRmSLmRp(x, y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[16], 5, t, -h, u, -h, v);
+  if (LpRmSLmRp(-x, y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[16], 5, -t, h, -u, h, -v);
+  if (LpRmSLmRp(x, -y, -phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[17], 5, t, -h, u, -h, v);
+  if (LpRmSLmRp(-x, -y, phi, &t, &u, &v))
+    updateCandidate(c, RS_TYPES[17], 5, -t, h, -u, h, -v);
+}
+
+bool dubinsLSL(double d, double alpha, double beta, Candidate* c)
+{
+  double ca = std::cos(alpha), sa = std::sin(alpha), cb = std::cos(beta), sb = std::sin(beta);
+  double tmp = 2.0 + d * d - 2.0 * (ca * cb + sa * sb - d * (sa - sb));
+  if (tmp < DUBINS_ZERO)
+    return false;
+  double theta = std::atan2(cb - ca, d + sa - sb);
+  setCandidate(c, DUBINS_TYPES[0], 3, mod2piPositive(-alpha + theta), std::sqrt(std::max(tmp, 0.0)),
+               mod2piPositive(beta - theta));
+  return true;
+}
+
+bool dubinsRSR(double d, double alpha, double beta, Candidate* c)
+{
+  double ca = std::cos(alpha), sa = std::sin(alpha), cb = std::cos(beta), sb = std::sin(beta);
+  double tmp = 2.0 + d * d - 2.0 * (ca * cb + sa * sb - d * (sb - sa));
+  if (tmp < DUBINS_ZERO)
+    return false;
+  double theta = std::atan2(ca - cb, d - sa + sb);
+  setCandidate(c, DUBINS_TYPES[3], 3, mod2piPositive(alpha - theta), std::sqrt(std::max(tmp, 0.0)),
+               mod2piPositive(-beta + theta));
+  return true;
+}
+
+bool dubinsRSL(double d, double alpha, double beta, Candidate* c)
+{
+  double ca = std::cos(alpha), sa = std::sin(alpha), cb = std::cos(beta), sb = std::sin(beta);
+  double tmp = d * d - 2.0 + 2.0 * (ca * cb + sa * sb - d * (sa + sb));
+  if (tmp < DUBINS_ZERO)
+    return false;
+  double p = std::sqrt(std::max(tmp, 0.0));
+  double theta = std::atan2(ca + cb, d - sa - sb) - std::atan2(2.0, p);
+  setCandidate(c, DUBINS_TYPES[2], 3, mod2piPositive(alpha - theta), p, mod2piPositive(beta - theta));
+  return true;
+}
+
+bool dubinsLSR(double d, double alpha, double beta, Candidate* c)
+{
+  double ca = std::cos(alpha), sa = std::sin(alpha), cb = std::cos(beta), sb = std::sin(beta);
+  double tmp = -2.0 + d * d + 2.0 * (ca * cb + sa * sb + d * (sa + sb));
+  if (tmp < DUBINS_ZERO)
+    return false;
+  double p = std::sqrt(std::max(tmp, 0.0));
+  double theta = std::atan2(-ca - cb, d + sa + sb) - std::atan2(-2.0, p);
+  setCandidate(c, DUBINS_TYPES[1], 3, mod2piPositive(-alpha + theta), p, mod2piPositive(-beta + theta));
+  return true;
+}
+
+bool dubinsRLR(double d, double alpha, double beta, Candidate* c)
+{
+  double ca = std::cos(alpha), sa = std::sin(alpha), cb = std::cos(beta), sb = std::sin(beta);
+  double tmp = 0.125 * (6.0 - d * d + 2.0 * (ca * cb + sa * sb + d * (sa - sb)));
+  if (std::fabs(tmp) >= 1.0)
+    return false;
+  double p = 2.0 * M_PI - std::acos(tmp);
+  double theta = std::atan2(ca - cb, d - sa + sb);
+  double t = mod2piPositive(alpha - theta + 0.5 * p);
+  setCandidate(c, DUBINS_TYPES[4], 3, t, p, mod2piPositive(alpha - beta - t + p));
+  return true;
+}
+
+bool dubinsLRL(double d, double alpha, double beta, Candidate* c)
+{
+  double ca = std::cos(alpha), sa = std::sin(alpha), cb = std::cos(beta), sb = std::sin(beta);
+  double tmp = 0.125 * (6.0 - d * d + 2.0 * (ca * cb + sa * sb - d * (sa - sb)));
+  if (std::fabs(tmp) >= 1.0)
+    return false;
+  double p = 2.0 * M_PI - std::acos(tmp);
+  double theta = std::atan2(-ca + cb, d + sa - sb);
+  double t = mod2piPositive(-alpha + theta + 0.5 * p);
+  setCandidate(c, DUBINS_TYPES[5], 3, t, p, mod2piPositive(beta - alpha - t + p));
+  return true;
+}
+
+Candidate shortestDubins(double x0, double y0, double theta0, double x1, double y1, double theta1,
+                         double turning_radius)
+{
+  double dx = x1 - x0, dy = y1 - y0;
+  double th = std::atan2(dy, dx);
+  double d = std::sqrt(dx * dx + dy * dy) / turning_radius;
+  double alpha = mod2piPositive(theta0 - th);
+  double beta = mod2piPositive(theta1 - th);
+
+  Candidate best;
+  if (d < DUBINS_EPS && std::fabs(alpha - beta) < DUBINS_EPS)
+  {
+    setCandidate(&best, DUBINS_TYPES[0], 3, 0.0, d, 0.0);
+    return best;
+  }
+
+  best.type = nullptr;
+  best.size = 0;
+  best.sum = std::numeric_limits<double>::infinity();
+  Candidate c;
+  if (dubinsLSL(d, alpha, beta, &c) && c.sum < best.sum)
+    best = c;
+  if (dubinsRSR(d, alpha, beta, &c) && c.sum < best.sum)
+    best = c;
+  if (dubinsRSL(d, alpha, beta, &c) && c.sum < best.sum)
+    best = c;
+  if (dubinsLSR(d, alpha, beta, &c) && c.sum < best.sum)
+    best = c;
+  if (dubinsRLR(d, alpha, beta, &c) && c.sum < best.sum)
+    best = c;
+  if (dubinsLRL(d, alpha, beta, &c) && c.sum < best.sum)
+    best = c;
+
+  return best;
+}
+
+// Type of a Dubins path driven from its end to its start
+const Seg* reversedDubinsType(const Seg* type)
+{
+  for (int i = 0; i < 6; i++)
+  {
+    if (DUBINS_TYPES[i][0] == type[2] && DUBINS_TYPES[i][1] == type[1] && DUBINS_TYPES[i][2] == type[0])
+      return DUBINS_TYPES[i];
+  }
+  return nullptr;
+}
+
+ReedsSheppPath toPath(const Candidate& c, double turning_radius)
+{
+  ReedsSheppPath path;
+  path.turning_radius = turning_radius;
+  if (c.type == nullptr)
+    return path;
+
+  for (int i = 0; i < c.size; i++)
+  {
+    path.type[i] = c.type[i];
+    path.length[i] = c.length[i];
+  }
+  return path;
+}
+
+// Move (x, y, theta) along a segment of normalized signed length
+void moveAlong(ReedsSheppPath::SegmentType type, double length, double radius, double* x, double* y, double* theta)
+{
+  const double phi = *theta;
+  if (type == ReedsSheppPath::LEFT)
+  {
+    *x += radius * (std::sin(phi + length) - std::sin(phi));
+    *y += radius * (-std::cos(phi + length) + std::cos(phi));
+    *theta = phi + length;
+  }
+  else if (type == ReedsSheppPath::RIGHT)
+  {
+    *x += radius * (-std::sin(phi - length) + std::sin(phi));
+    *y += radius * (std::cos(phi - length) - std::cos(phi));
+    *theta = phi - length;
+  }
+  else if (type == ReedsSheppPath::STRAIGHT)
+  {
+    *x += radius * length * std::cos(phi);
+    *y += radius * length * std::sin(phi);
+  }
+}
+
+}  // namespace
+
+ReedsSheppPath::ReedsSheppPath() : turning_radius(1.0)
+{
+  for (int i = 0; i < 5; i++)
+  {
+    type[i] = NOP;
+    length[i] = 0.0;
+  }
+  length[0] = std::numeric_limits<double>::infinity();
+}
+
+double ReedsSheppPath::totalLength() const
+{
+  double sum = 0.0;
+  for (int i = 0; i < 5; i++)
+    sum += std::fabs(length[i]);
+  return sum * turning_radius;
+}
+
+ReedsSheppPath calcReedsSheppPath(double x0, double y0, double theta0, double x1, double y1, double theta1,
+                                  double turning_radius, double switch_cost, bool start_back)
+{
+  // goal seen from the start, in units of the turning radius
+  double dx = x1 - x0, dy = y1 - y0;
+  double c = std::cos(theta0), s = std::sin(theta0);
+  double x = (c * dx + s * dy) / turning_radius;
+  double y = (-s * dx + c * dy) / turning_radius;
+  double phi = theta1 - theta0;
+
+  Candidate best;
+  best.type = nullptr;
+  best.size = 0;
+  best.sum = std::numeric_limits<double>::infinity();
+  best.cost = std::numeric_limits<double>::infinity();
+  best.switch_cost = switch_cost / turning_radius;
+  best.start_back = start_back;
+  CSC(x, y, phi, &best);
+  CCC(x, y, phi, &best);
+  CCCC(x, y, phi, &best);
+  CCSC(x, y, phi, &best);
+  CCSCC(x, y, phi, &best);
+
+  // The families only hold paths which can be the shortest. If changing the direction costs, driving only forward or
+  // only backward may be cheaper, the shortest of those are the Dubins paths to the goal and reversed from the goal
+  if (switch_cost > 0.0)
+  {
+    const Candidate forward = shortestDubins(x0, y0, theta0, x1, y1, theta1, turning_radius);
+    if (forward.type != nullptr)
+      updateCandidate(&best, forward.type, 3, forward.length[0], forward.length[1], forward.length[2]);
+    const Candidate backward = shortestDubins(x1, y1, theta1, x0, y0, theta0, turning_radius);
+    if (backward.type != nullptr)
+      updateCandidate(&best, reversedDubinsType(backward.type), 3, -backward.length[2], -backward.length[1],
+                      -backward.length[0]);
+  }
+
+  return toPath(best, turning_radius);
+}
+
+ReedsSheppPath calcDubinsPath(double x0, double y0, double theta0, double x1, double y1, double theta1,
+                              double turning_radius)
+{
+  return toPath(shortestDubins(x0, y0, theta0, x1, y1, theta1, turning_radius), turning_radius);
+}
+
+void interpolateReedsSheppPath(const ReedsSheppPath& path, double x0, double y0, double theta0, double step,
+                               std::vector<ReedsSheppPose>* poses)
+{
+  poses->clear();
+  if (!std::isfinite(path.totalLength()))
+    return;
+
+  const double radius = path.turning_radius;
+  const double normalized_step = step / radius;
+
+  // start pose of the current segment
+  double seg_x = x0, seg_y = y0, seg_theta = theta0;
+  // arc length travelled before the current segment, and position of the next sample, normalized
+  double travelled = 0.0;
+  double next_sample = normalized_step;
+
+  for (int i = 0; i < 5 && path.type[i] != ReedsSheppPath::NOP; i++)
+  {
+    const double length = path.length[i];
+    const double abs_length = std::fabs(length);
+    const bool back = length < 0;
+
+    while (next_sample < travelled + abs_length)
+    {
+      ReedsSheppPose p;
+      p.x = seg_x;
+      p.y = seg_y;
+      p.theta = seg_theta;
+      p.back = back;
+      double l = next_sample - travelled;
+      moveAlong(path.type[i], back ? -l : l, radius, &p.x, &p.y, &p.theta);
+      p.theta = mod2piPositive(p.theta);
+      poses->push_back(p);
+      next_sample += normalized_step;
+    }
+
+    moveAlong(path.type[i], length, radius, &seg_x, &seg_y, &seg_theta);
+    travelled += abs_length;
+
+    // keep the segment end, where the direction may change
+    if (abs_length > 0 && (poses->empty() || next_sample - normalized_step < travelled - RS_ZERO))
+    {
+      ReedsSheppPose p;
+      p.x = seg_x;
+      p.y = seg_y;
+      p.theta = mod2piPositive(seg_theta);
+      p.back = back;
+      poses->push_back(p);
+    }
+  }
+}
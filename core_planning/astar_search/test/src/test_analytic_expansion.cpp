@@ -0,0 +1,316 @@
+/*
+ * Copyright 2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <ros/ros.h>
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <random>
+
+#include "astar_search/astar_search.h"
+#include "astar_search/reeds_shepp.h"
+
+#include "test_class.h"
+
+namespace
+{
+struct Box
+{
+  double min_x, min_y, max_x, max_y;
+};
+
+struct Scene
+{
+  const char* name;
+  bool use_back;
+  std::vector<Box> obstacles;
+  geometry_msgs::Pose start;
+  geometry_msgs::Pose goal;
+};
+
+struct Result
+{
+  bool found;
+  int expanded_nodes;
+  double msec;
+  nav_msgs::Path path;
+};
+
+const double RESOLUTION = 0.5;
+const double MAP_LENGTH = 60.0;
+const double MAP_WIDTH = 40.0;
+
+nav_msgs::OccupancyGrid createCostmap(const std::vector<Box>& obstacles)
+{
+  nav_msgs::OccupancyGrid costmap;
+  costmap.header.frame_id = "world";
+  costmap.info.resolution = RESOLUTION;
+  costmap.info.width = MAP_LENGTH / RESOLUTION;
+  costmap.info.height = MAP_WIDTH / RESOLUTION;
+  costmap.info.origin.orientation.w = 1;
+  costmap.data.assign(costmap.info.width * costmap.info.height, 0);
+
+  for (const auto& box : obstacles)
+  {
+    for (int row = box.min_y / RESOLUTION; row < box.max_y / RESOLUTION; ++row)
+    {
+      for (int col = box.min_x / RESOLUTION; col < box.max_x / RESOLUTION; ++col)
+      {
+        costmap.data.at(row * costmap.info.width + col) = 100;
+      }
+    }
+  }
+  return costmap;
+}
+
+Result plan(const Scene& scene, bool use_analytic_expansion, TestClass** test_obj)
+{
+  ros::NodeHandle nh("~");
+  nh.setParam("use_back", scene.use_back);
+  nh.setParam("use_analytic_expansion", use_analytic_expansion);
+  nh.setParam("time_limit", 20000.0);
+
+  *test_obj = new TestClass();
+  AstarSearch& astar = (*test_obj)->astar_search_obj;
+  astar.initialize(createCostmap(scene.obstacles));
+
+  Result result;
+  ros::WallTime begin = ros::WallTime::now();
+  result.found = astar.makePlan(scene.start, scene.goal);
+  result.msec = (ros::WallTime::now() - begin).toSec() * 1000.0;
+  result.expanded_nodes = (*test_obj)->getExpandedNodeCount();
+  result.path = astar.getPath();
+
+  nh.setParam("use_back", true);
+  nh.setParam("use_analytic_expansion", false);
+  nh.setParam("time_limit", 5000.0);
+
+  return result;
+}
+
+// Parking lots and an obstacle on a road in a 60 x 40 m map, the map border is an obstacle
+std::vector<Scene> createScenes()
+{
+  std::vector<Scene> scenes;
+
+  // back into a perpendicular slot between parked cars
+  Scene perpendicular;
+  perpendicular.name = "perpendicular parking";
+  perpendicular.use_back = true;
+  for (double x = 12.0; x < 48.0; x += 3.0)
+  {
+    if (x != 30.0)
+    {
+      perpendicular.obstacles.push_back({ x + 0.4, 1.0, x + 2.6, 6.0 });
+    }
+  }
+  perpendicular.start = xytToPoseMsg(8.0, 14.0, 0.0);
+  perpendicular.goal = xytToPoseMsg(31.5, 2.5, M_PI_2);
+  scenes.push_back(perpendicular);
+
+  // parallel parking next to a curb
+  Scene parallel;
+  parallel.name = "parallel parking";
+  parallel.use_back = true;
+  parallel.obstacles.push_back({ 0.0, 0.0, MAP_LENGTH, 1.5 });
+  parallel.obstacles.push_back({ 14.0, 1.5, 19.0, 3.5 });
+  parallel.obstacles.push_back({ 27.0, 1.5, 32.0, 3.5 });
+  parallel.start = xytToPoseMsg(6.0, 9.0, 0.0);
+  parallel.goal = xytToPoseMsg(21.0, 2.5, 0.0);
+  scenes.push_back(parallel);
+
+  // forward only avoidance of a parked car on a two lane road
+  Scene avoidance;
+  avoidance.name = "avoidance";
+  avoidance.use_back = false;
+  avoidance.obstacles.push_back({ 0.0, 0.0, MAP_LENGTH, 13.0 });
+  avoidance.obstacles.push_back({ 0.0, 23.0, MAP_LENGTH, MAP_WIDTH });
+  avoidance.obstacles.push_back({ 26.0, 13.0, 31.0, 16.5 });
+  avoidance.start = xytToPoseMsg(5.0, 15.0, 0.0);
+  avoidance.goal = xytToPoseMsg(52.0, 15.0, 0.0);
+  scenes.push_back(avoidance);
+
+  return scenes;
+}
+
+}  // namespace
+
+TEST(TestReedsShepp, reachesGoal)
+{
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> position(-20.0, 20.0);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  const double step = 0.5;
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    double x0 = position(gen), y0 = position(gen), theta0 = angle(gen);
+    double x1 = position(gen), y1 = position(gen), theta1 = angle(gen);
+
+    ReedsSheppPath rs_path = calcReedsSheppPath(x0, y0, theta0, x1, y1, theta1, 6.0);
+    ReedsSheppPath dubins_path = calcDubinsPath(x0, y0, theta0, x1, y1, theta1, 6.0);
+    ASSERT_LE(rs_path.totalLength(), dubins_path.totalLength() + 1e-9) << "Reeds-Shepp path should not be longer";
+
+    for (const auto& path : { rs_path, dubins_path })
+    {
+      std::vector<ReedsSheppPose> poses;
+      interpolateReedsSheppPath(path, x0, y0, theta0, step, &poses);
+      ASSERT_FALSE(poses.empty());
+      ASSERT_NEAR(poses.back().x, x1, 1e-6);
+      ASSERT_NEAR(poses.back().y, y1, 1e-6);
+      ASSERT_NEAR(calcDiffOfRadian(poses.back().theta, theta1), 0.0, 1e-6);
+
+      double prev_x = x0, prev_y = y0;
+      for (const auto& p : poses)
+      {
+        ASSERT_LE(calcDistance(prev_x, prev_y, p.x, p.y), step + 1e-9) << "poses should be sampled every step";
+        prev_x = p.x;
+        prev_y = p.y;
+      }
+    }
+
+    std::vector<ReedsSheppPose> poses;
+    interpolateReedsSheppPath(dubins_path, x0, y0, theta0, step, &poses);
+    for (const auto& p : poses)
+    {
+      ASSERT_FALSE(p.back) << "Dubins path should be forward only";
+    }
+  }
+}
+
+TEST(TestReedsShepp, straightAndTurn)
+{
+  // straight ahead
+  ReedsSheppPath path = calcReedsSheppPath(0, 0, 0, 10, 0, 0, 6.0);
+  ASSERT_NEAR(path.totalLength(), 10.0, 1e-9);
+
+  // straight behind, forward only has to turn around
+  path = calcReedsSheppPath(0, 0, 0, -10, 0, 0, 6.0);
+  ASSERT_NEAR(path.totalLength(), 10.0, 1e-9);
+  path = calcDubinsPath(0, 0, 0, -10, 0, 0, 6.0);
+  ASSERT_GT(path.totalLength(), 2.0 * M_PI * 6.0);
+
+  // quarter circle to the left
+  path = calcDubinsPath(0, 0, 0, 6, 6, M_PI_2, 6.0);
+  ASSERT_NEAR(path.totalLength(), M_PI_2 * 6.0, 1e-9);
+}
+
+TEST(TestReedsShepp, switchCost)
+{
+  // backing straight into the goal switches the direction of a vehicle moving forward
+  ReedsSheppPath path = calcReedsSheppPath(0, 0, 0, -10, 0, 0, 6.0, 1.0, false);
+  ASSERT_NEAR(path.totalLength(), 10.0, 1e-9);
+
+  // a costly switch is avoided by a forward only path
+  path = calcReedsSheppPath(0, 0, 0, -10, 0, 0, 6.0, 100.0, false);
+  ASSERT_NEAR(path.totalLength(), calcDubinsPath(0, 0, 0, -10, 0, 0, 6.0).totalLength(), 1e-6);
+  for (int i = 0; i < 5; i++)
+  {
+    ASSERT_GE(path.length[i], 0.0);
+  }
+
+  // but not if the vehicle is already moving backward
+  path = calcReedsSheppPath(0, 0, 0, -10, 0, 0, 6.0, 100.0, true);
+  ASSERT_NEAR(path.totalLength(), 10.0, 1e-9);
+
+  // no switch cost gives the shortest path, paths with a switch cost still reach the goal
+  std::mt19937 gen(0);
+  std::uniform_real_distribution<double> position(-20.0, 20.0);
+  std::uniform_real_distribution<double> angle(-M_PI, M_PI);
+  for (int i = 0; i < 1000; ++i)
+  {
+    double x1 = position(gen), y1 = position(gen), theta1 = angle(gen);
+    ReedsSheppPath shortest = calcReedsSheppPath(0, 0, 0, x1, y1, theta1, 6.0);
+    ASSERT_DOUBLE_EQ(shortest.totalLength(), calcReedsSheppPath(0, 0, 0, x1, y1, theta1, 6.0, 0.0, true).totalLength());
+
+    for (const bool start_back : { false, true })
+    {
+      ReedsSheppPath weighted = calcReedsSheppPath(0, 0, 0, x1, y1, theta1, 6.0, 1000.0, start_back);
+      ASSERT_LE(shortest.totalLength(), weighted.totalLength() + 1e-9);
+
+      std::vector<ReedsSheppPose> poses;
+      interpolateReedsSheppPath(weighted, 0, 0, 0, 0.5, &poses);
+      ASSERT_FALSE(poses.empty());
+      ASSERT_NEAR(poses.back().x, x1, 1e-6);
+      ASSERT_NEAR(poses.back().y, y1, 1e-6);
+      ASSERT_NEAR(calcDiffOfRadian(poses.back().theta, theta1), 0.0, 1e-6);
+      for (const auto& p : poses)
+      {
+        ASSERT_EQ(p.back, start_back) << "a costly switch should be avoided";
+      }
+    }
+  }
+}
+
+TEST(TestAnalyticExpansion, planningScenes)
+{
+  for (const auto& scene : createScenes())
+  {
+    TestClass* without_obj;
+    TestClass* with_obj;
+    Result without = plan(scene, false, &without_obj);
+    Result with = plan(scene, true, &with_obj);
+
+    std::printf("[ %-21s ] without analytic expansion: %s, %7d expanded nodes, %9.3f ms\n", scene.name,
+                without.found ? "found " : "failed", without.expanded_nodes, without.msec);
+    std::printf("[ %-21s ] with analytic expansion   : %s, %7d expanded nodes, %9.3f ms\n", scene.name,
+                with.found ? "found " : "failed", with.expanded_nodes, with.msec);
+
+    ASSERT_TRUE(with.found) << scene.name;
+    EXPECT_LE(with.expanded_nodes, without.expanded_nodes) << scene.name;
+
+    // the path ends exactly at the goal and every pose is free
+    const geometry_msgs::Pose& last = with.path.poses.back().pose;
+    EXPECT_DOUBLE_EQ(last.position.x, scene.goal.position.x) << scene.name;
+    EXPECT_DOUBLE_EQ(last.position.y, scene.goal.position.y) << scene.name;
+    EXPECT_NEAR(calcDiffOfRadian(tf::getYaw(last.orientation), tf::getYaw(scene.goal.orientation)), 0.0, 1e-9)
+        << scene.name;
+
+    for (const auto& pose : with.path.poses)
+    {
+      SimpleNode sn;
+      with_obj->poseToIndex(pose.pose, &sn.index_x, &sn.index_y, &sn.index_theta);
+      ASSERT_FALSE(with_obj->isOutOfRange(sn.index_x, sn.index_y) || with_obj->detectCollision(sn)) << scene.name;
+    }
+
+    delete without_obj;
+    delete with_obj;
+  }
+}
+
+TEST(TestAnalyticExpansion, rejectsBlockedShot)
+{
+  // wall between the node and the goal
+  Scene scene;
+  scene.name = "blocked";
+  scene.use_back = true;
+  scene.obstacles.push_back({ 30.0, 0.0, 31.0, MAP_WIDTH });
+  scene.start = xytToPoseMsg(10.0, 20.0, 0.0);
+  scene.goal = xytToPoseMsg(50.0, 20.0, 0.0);
+
+  TestClass* test_obj;
+  Result result = plan(scene, true, &test_obj);
+  ASSERT_FALSE(result.found);
+
+  AstarNode node;
+  node.x = 10.0;
+  node.y = 20.0;
+  node.theta = 0.0;
+  node.back = false;
+  ASSERT_FALSE(test_obj->tryAnalyticExpansion(node));
+
+  delete test_obj;
+}
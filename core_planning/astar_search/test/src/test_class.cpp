@@ -128,3 +128,11 @@ bool TestClass::detectCollisionWaveFront(const WaveFrontNode& sn)
 {
   return astar_search_obj.detectCollisionWaveFront(sn);
 }
+bool TestClass::tryAnalyticExpansion(const AstarNode& node)
+{
+  return astar_search_obj.tryAnalyticExpansion(node);
+}
+int TestClass::getExpandedNodeCount()
+{
+  return astar_search_obj.expanded_node_count_;
+}
@@ -38,6 +38,8 @@ public:
   bool detectCollision(const SimpleNode& sn);
   bool calcWaveFrontHeuristic(const SimpleNode& sn);
   bool detectCollisionWaveFront(const WaveFrontNode& sn);
+  bool tryAnalyticExpansion(const AstarNode& node);
+  int getExpandedNodeCount();
 
   nav_msgs::OccupancyGrid costmap_;
 
@@ -90,6 +90,9 @@ private:
   double expand_polygon_size_;
   int size_of_expansion_kernel_;
 
+  bool use_rolling_window_;
+  double observation_decay_time_;
+
   grid_map::GridMap costmap_;
 
   ros::Subscriber sub_lanelet_bin_map_;
@@ -147,6 +150,13 @@ private:
   /// \param[in] in_sensor_points: subscribed pointcloud data
   grid_map::Matrix generateSensorPointsCostmap(const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
 
+  /// \brief calculate cost from pointcloud data accumulated in a rolling window in map_frame
+  /// \param[in] in_sensor_points: subscribed pointcloud data
+  /// \param[in] sensor_to_fixed: transform from lidar_frame to map_frame
+  /// \param[in] stamp: time stamp of subscribed pointcloud [s]
+  grid_map::Matrix generateRollingSensorPointsCostmap(const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points,
+                                                      const Eigen::Affine3d& sensor_to_fixed, const double stamp);
+
   /// \brief calculate cost from DetectedObjectArray
   /// \param[in] in_objects: subscribed DetectedObjectArray
   grid_map::Matrix generateObjectsCostmap(const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
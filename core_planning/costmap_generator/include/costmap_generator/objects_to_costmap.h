@@ -31,6 +31,9 @@
 #ifndef OBJECTS_TO_COSTMAP_H
 #define OBJECTS_TO_COSTMAP_H
 
+// headers in STL
+#include <vector>
+
 // headers in ROS
 #include <ros/ros.h>
 #include <grid_map_ros/grid_map_ros.hpp>
@@ -63,6 +66,17 @@ private:
   const std::string OBJECTS_COSTMAP_LAYER_;
   const std::string BLURRED_OBJECTS_COSTMAP_LAYER_;
 
+  // cells [begin_row, end_row) of one column whose centers are inside a polygon, in buffer index order
+  struct CellSpan
+  {
+    int column;
+    int begin_row;
+    int end_row;
+  };
+
+  // reused between cycles to avoid copying every layer of the input costmap
+  grid_map::GridMap objects_costmap_;
+
   /// \brief make 4 rectangle points from centroid position and orientation
   /// \param[in] in_object: subscribed one of DetectedObjectArray
   /// \param[in] expand_rectangle_size: expanding 4 points
@@ -100,6 +114,18 @@ private:
   /// \param[in] objects_costmap: update cost in this objects_costmap[gridmap_layer_name]
   void setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name, const float score,
                         grid_map::GridMap& objects_costmap);
+
+  /// \brief make objects_costmap_ the same geometry as costmap and reset its layers
+  /// \param[in] costmap: initialized gridmap
+  void initObjectsCostmap(const grid_map::GridMap& costmap);
+
+  /// \brief scanline rasterization of polygon. Same cells as grid_map::PolygonIterator
+  /// \param[in] polygon: polygon to be rasterized
+  /// \param[in] row_positions: x position of cell centers for each row in buffer order
+  /// \param[in] column_positions: y position of cell centers for each column in buffer order
+  /// \param[out] spans: cells whose center is inside polygon
+  void rasterizePolygon(const grid_map::Polygon& polygon, const std::vector<double>& row_positions,
+                        const std::vector<double>& column_positions, std::vector<CellSpan>* spans);
 };
 
 #endif  // OBJECTS_TO_COSTMAP_H
@@ -33,6 +33,7 @@
 
 // headers in ROS
 #include <ros/ros.h>
+#include <tf/transform_listener.h>
 #include <grid_map_ros/grid_map_ros.hpp>
 
 // headers in PCL
@@ -44,7 +45,8 @@ public:
   PointsToCostmap();
   ~PointsToCostmap();
 
-  /// \brief calculate cost from sensor points
+  /// \brief calculate cost from sensor points. Cells without points get grid_min_value, cells with a point in the
+  /// height range grid_max_value and cells whose points are all out of the height range keep their cost in gridmap
   /// \param[in] maximum_height_thres: Maximum height threshold for pointcloud data
   /// \param[in] minimum_height_thres: Minimum height threshold for pointcloud data
   /// \param[in] grid_min_value: Minimum cost for costmap
@@ -58,6 +60,39 @@ public:
                                                const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name,
                                                const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points);
 
+  /// \brief calculate cost from sensor points accumulated in a rolling window which follows the vehicle. Cells are
+  /// occupied while a point in the height range was observed within decay_time. Other cells hit only by points out of
+  /// the height range keep their cost in gridmap, all remaining cells get grid_min_value
+  /// \param[in] maximum_height_thres: Maximum height threshold for pointcloud data
+  /// \param[in] minimum_height_thres: Minimum height threshold for pointcloud data
+  /// \param[in] grid_min_value: Minimum cost for costmap
+  /// \param[in] grid_max_value: Maximum cost fot costmap
+  /// \param[in] gridmap: costmap based on gridmap
+  /// \param[in] gridmap_layer_name: gridmap layer name for gridmap
+  /// \param[in] in_sensor_points: subscribed pointcloud
+  /// \param[in] sensor_to_fixed: transform from the gridmap frame to the frame the window rolls in
+  /// \param[in] stamp: time stamp of subscribed pointcloud [s]
+  /// \param[in] decay_time: time an observed cell keeps its cost [s]. 0 keeps only the latest pointcloud
+  /// \param[out] calculated cost in grid_map::Matrix format
+  grid_map::Matrix makeCostmapFromSensorPointsRolling(const double maximum_height_thres,
+                                                      const double minimum_height_thres, const double grid_min_value,
+                                                      const double grid_max_value, const grid_map::GridMap& gridmap,
+                                                      const std::string& gridmap_layer_name,
+                                                      const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points,
+                                                      const Eigen::Affine3d& sensor_to_fixed, const double stamp,
+                                                      const double decay_time);
+
+  /// \brief get transform from the sensor frame to the fixed frame the rolling window is kept in
+  /// \param[in] tf_listener: listener to look up the transform with
+  /// \param[in] fixed_frame: frame the rolling window is kept in
+  /// \param[in] sensor_frame: frame of the pointcloud and the gridmap
+  /// \param[in] stamp: time of the transform
+  /// \param[out] sensor_to_fixed: transform from sensor_frame to fixed_frame
+  /// \param[out] bool: true if transform is available
+  static bool lookupSensorToFixedTransform(const tf::TransformListener& tf_listener, const std::string& fixed_frame,
+                                           const std::string& sensor_frame, const ros::Time& stamp,
+                                           Eigen::Affine3d* sensor_to_fixed);
+
 private:
   friend class TestClass;
 
@@ -69,6 +104,13 @@ private:
   double y_cell_size_;
   double x_cell_size_;
 
+  // rolling window in the fixed frame. Cells hold the last time a point in the height range was observed
+  grid_map::GridMap rolling_window_;
+  bool is_rolling_window_initialized_;
+  double rolling_window_start_stamp_;
+
+  const std::string OBSERVED_TIME_LAYER_;
+
   /// \brief initialize gridmap parameters
   /// \param[in] gridmap: gridmap object to be initialized
   void initGridmapParam(const grid_map::GridMap& gridmap);
@@ -83,6 +125,20 @@ private:
   /// \param[out] index in gridmap
   grid_map::Index fetchGridIndexFromPoint(const pcl::PointXYZ& point);
 
+  /// \brief Get index from a position in a gridmap centered at grid_position
+  /// \param[in] x: x coordinate in the frame of grid_position
+  /// \param[in] y: y coordinate in the frame of grid_position
+  /// \param[in] grid_position: center of the gridmap
+  /// \param[out] index in gridmap
+  grid_map::Index fetchGridIndexFromPosition(const double x, const double y, const grid_map::Position& grid_position);
+
+  /// \brief (re)create rolling window with the same geometry as gridmap
+  /// \param[in] gridmap: costmap based on gridmap
+  /// \param[in] window_position: center of the window in the fixed frame
+  /// \param[in] stamp: time stamp used as origin for the observed time layer
+  void initRollingWindow(const grid_map::GridMap& gridmap, const grid_map::Position& window_position,
+                         const double stamp);
+
   /// \brief Assign pointcloud to appropriate cell in gridmap
   /// \param[in] gridmap: costmap based on gridmap
   /// \param[in] in_sensor_points: subscribed pointcloud
@@ -64,6 +64,8 @@ void CostmapGeneratorLanelet2::init()
   private_nh_.param<bool>("use_wayarea", use_wayarea_, true);
   private_nh_.param<double>("expand_polygon_size", expand_polygon_size_, 1.0);
   private_nh_.param<int>("size_of_expansion_kernel", size_of_expansion_kernel_, 9);
+  private_nh_.param<bool>("use_rolling_window", use_rolling_window_, false);
+  private_nh_.param<double>("observation_decay_time", observation_decay_time_, 0.0);
 
   initGridmap();
 }
@@ -154,7 +156,21 @@ void CostmapGeneratorLanelet2::sensorPointsCallback(const sensor_msgs::PointClou
 
   pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
   pcl::fromROSMsg(*in_sensor_points_msg, *in_sensor_points);
-  costmap_[SENSOR_POINTS_COSTMAP_LAYER_] = generateSensorPointsCostmap(in_sensor_points);
+  if (use_rolling_window_)
+  {
+    Eigen::Affine3d sensor_to_fixed;
+    if (!PointsToCostmap::lookupSensorToFixedTransform(tf_listener_, map_frame_, lidar_frame_,
+                                                       in_sensor_points_msg->header.stamp, &sensor_to_fixed))
+    {
+      return;
+    }
+    costmap_[SENSOR_POINTS_COSTMAP_LAYER_] = generateRollingSensorPointsCostmap(
+        in_sensor_points, sensor_to_fixed, in_sensor_points_msg->header.stamp.toSec());
+  }
+  else
+  {
+    costmap_[SENSOR_POINTS_COSTMAP_LAYER_] = generateSensorPointsCostmap(in_sensor_points);
+  }
   costmap_[LANELET2_COSTMAP_LAYER_] = generateLanelet2Costmap();
   costmap_[COMBINED_COSTMAP_LAYER_] = generateCombinedCostmap();
 
@@ -184,6 +200,16 @@ CostmapGeneratorLanelet2::generateSensorPointsCostmap(const pcl::PointCloud<pcl:
   return sensor_points_costmap;
 }
 
+grid_map::Matrix CostmapGeneratorLanelet2::generateRollingSensorPointsCostmap(
+    const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points, const Eigen::Affine3d& sensor_to_fixed,
+    const double stamp)
+{
+  grid_map::Matrix sensor_points_costmap = points2costmap_.makeCostmapFromSensorPointsRolling(
+      maximum_lidar_height_thres_, minimum_lidar_height_thres_, grid_min_value_, grid_max_value_, costmap_,
+      SENSOR_POINTS_COSTMAP_LAYER_, in_sensor_points, sensor_to_fixed, stamp, observation_decay_time_);
+  return sensor_points_costmap;
+}
+
 grid_map::Matrix CostmapGeneratorLanelet2::generateObjectsCostmap(
     const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects, const bool use_convex_hull)
 {
@@ -29,6 +29,7 @@
  ********************/
 
 // headers in standard library
+#include <algorithm>
 #include <cmath>
 
 // headers in ROS
@@ -128,7 +129,6 @@ grid_map::Polygon ObjectsToCostmap::makePolygonFromObjectConvexHull(const autowa
 void ObjectsToCostmap::setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name,
                                        const float score, grid_map::GridMap& objects_costmap)
 {
-  grid_map::PolygonIterator iterators(objects_costmap, polygon);
   for (grid_map::PolygonIterator iterator(objects_costmap, polygon); !iterator.isPastEnd(); ++iterator)
   {
     const float current_score = objects_costmap.at(gridmap_layer_name, *iterator);
@@ -139,20 +139,116 @@ void ObjectsToCostmap::setCostInPolygon(const grid_map::Polygon& polygon, const
   }
 }
 
+void ObjectsToCostmap::initObjectsCostmap(const grid_map::GridMap& costmap)
+{
+  objects_costmap_.setGeometry(costmap.getLength(), costmap.getResolution(), costmap.getPosition());
+  objects_costmap_.setStartIndex(costmap.getStartIndex());
+  if (!objects_costmap_.exists(OBJECTS_COSTMAP_LAYER_))
+  {
+    objects_costmap_.add(OBJECTS_COSTMAP_LAYER_, 0);
+    objects_costmap_.add(BLURRED_OBJECTS_COSTMAP_LAYER_, 0);
+  }
+  objects_costmap_[OBJECTS_COSTMAP_LAYER_].setConstant(0);
+}
+
+void ObjectsToCostmap::rasterizePolygon(const grid_map::Polygon& polygon, const std::vector<double>& row_positions,
+                                        const std::vector<double>& column_positions, std::vector<CellSpan>* spans)
+{
+  spans->clear();
+  const std::vector<grid_map::Position>& vertices = polygon.getVertices();
+  if (vertices.size() < 3)
+  {
+    return;
+  }
+
+  double min_y = vertices[0].y();
+  double max_y = vertices[0].y();
+  for (const auto& vertex : vertices)
+  {
+    min_y = std::min(min_y, vertex.y());
+    max_y = std::max(max_y, vertex.y());
+  }
+
+  // cell positions decrease with increasing index. A scanline can only cross the polygon if min_y <= y < max_y
+  const auto column_begin = std::partition_point(column_positions.begin(), column_positions.end(),
+                                                 [max_y](const double y) { return y >= max_y; });
+  const auto column_end =
+      std::partition_point(column_begin, column_positions.end(), [min_y](const double y) { return y >= min_y; });
+
+  std::vector<double> crossings;
+  crossings.reserve(vertices.size());
+  for (auto column = column_begin; column != column_end; ++column)
+  {
+    const double y = *column;
+    // same crossing test as grid_map::Polygon::isInside
+    crossings.clear();
+    for (size_t i = 0, j = vertices.size() - 1; i < vertices.size(); j = i++)
+    {
+      if ((vertices[i].y() > y) != (vertices[j].y() > y))
+      {
+        crossings.push_back((vertices[j].x() - vertices[i].x()) * (y - vertices[i].y()) /
+                                (vertices[j].y() - vertices[i].y()) +
+                            vertices[i].x());
+      }
+    }
+    std::sort(crossings.begin(), crossings.end());
+
+    // a cell center x is inside if an odd number of crossings is greater than x
+    for (size_t k = 0; k + 1 < crossings.size(); k += 2)
+    {
+      const double lower_x = crossings[k];
+      const double upper_x = crossings[k + 1];
+      const auto row_begin = std::partition_point(row_positions.begin(), row_positions.end(),
+                                                  [upper_x](const double x) { return x >= upper_x; });
+      const auto row_end =
+          std::partition_point(row_begin, row_positions.end(), [lower_x](const double x) { return x >= lower_x; });
+      if (row_begin != row_end)
+      {
+        CellSpan span;
+        span.column = column - column_positions.begin();
+        span.begin_row = row_begin - row_positions.begin();
+        span.end_row = row_end - row_positions.begin();
+        spans->push_back(span);
+      }
+    }
+  }
+}
+
 grid_map::Matrix ObjectsToCostmap::makeCostmapFromObjects(const grid_map::GridMap& costmap,
                                                          const double expand_polygon_size,
                                                          const double size_of_expansion_kernel,
                                                          const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
                                                          const bool use_objects_convex_hull)
 {
-  grid_map::GridMap objects_costmap = costmap;
-  objects_costmap.add(OBJECTS_COSTMAP_LAYER_, 0);
-  objects_costmap.add(BLURRED_OBJECTS_COSTMAP_LAYER_, 0);
+  initObjectsCostmap(costmap);
+  const grid_map::Size size = objects_costmap_.getSize();
+  const grid_map::Index start_index = objects_costmap_.getStartIndex();
+
+  // cell center positions in buffer order, monotonically decreasing
+  std::vector<double> row_positions(size(0));
+  std::vector<double> column_positions(size(1));
+  grid_map::Position position;
+  for (int row = 0; row < size(0); row++)
+  {
+    objects_costmap_.getPosition(grid_map::getIndexFromBufferIndex(grid_map::Index(row, 0), size, start_index),
+                                 position);
+    row_positions[row] = position.x();
+  }
+  for (int column = 0; column < size(1); column++)
+  {
+    objects_costmap_.getPosition(grid_map::getIndexFromBufferIndex(grid_map::Index(0, column), size, start_index),
+                                 position);
+    column_positions[column] = position.y();
+  }
 
-  for (const auto& object : in_objects->objects)
+  const int num_objects = in_objects->objects.size();
+  std::vector<std::vector<CellSpan>> object_spans(num_objects);
+#pragma omp parallel for
+  for (int i = 0; i < num_objects; i++)
   {
-    grid_map::Polygon polygon, expanded_polygon;
-    if(use_objects_convex_hull)
+    const autoware_msgs::DetectedObject& object = in_objects->objects[i];
+    grid_map::Polygon expanded_polygon;
+    if (use_objects_convex_hull)
     {
       expanded_polygon = makePolygonFromObjectConvexHull(object, expand_polygon_size);
     }
@@ -160,22 +256,41 @@ grid_map::Matrix ObjectsToCostmap::makeCostmapFromObjects(const grid_map::GridMa
     {
       expanded_polygon = makePolygonFromObjectBox(object, expand_polygon_size);
     }
-    setCostInPolygon(expanded_polygon, OBJECTS_COSTMAP_LAYER_, object.score, objects_costmap);
-    setCostInPolygon(expanded_polygon, BLURRED_OBJECTS_COSTMAP_LAYER_, object.score, objects_costmap);
+    rasterizePolygon(expanded_polygon, row_positions, column_positions, &object_spans[i]);
+  }
+
+  grid_map::Matrix& objects_layer = objects_costmap_[OBJECTS_COSTMAP_LAYER_];
+  for (int i = 0; i < num_objects; i++)
+  {
+    const float score = in_objects->objects[i].score;
+    for (const auto& span : object_spans[i])
+    {
+      const int column = (span.column + start_index(1)) % size(1);
+      for (int buffer_row = span.begin_row; buffer_row < span.end_row; buffer_row++)
+      {
+        float& current_score = objects_layer((buffer_row + start_index(0)) % size(0), column);
+        if (score > current_score)
+        {
+          current_score = score;
+        }
+      }
+    }
   }
+  objects_costmap_[BLURRED_OBJECTS_COSTMAP_LAYER_] = objects_layer;
+
   // Applying mean filter to expanded gridmap
+  grid_map::Matrix& blurred_layer = objects_costmap_[BLURRED_OBJECTS_COSTMAP_LAYER_];
   const grid_map::SlidingWindowIterator::EdgeHandling edge_handling =
       grid_map::SlidingWindowIterator::EdgeHandling::CROP;
-  for (grid_map::SlidingWindowIterator iterator(objects_costmap, BLURRED_OBJECTS_COSTMAP_LAYER_, edge_handling,
+  for (grid_map::SlidingWindowIterator iterator(objects_costmap_, BLURRED_OBJECTS_COSTMAP_LAYER_, edge_handling,
                                                 size_of_expansion_kernel);
        !iterator.isPastEnd(); ++iterator)
   {
-    objects_costmap.at(BLURRED_OBJECTS_COSTMAP_LAYER_, *iterator) =
-        iterator.getData().meanOfFinites();  // Blurring.
+    const grid_map::Index& index = *iterator;
+    blurred_layer(index(0), index(1)) = iterator.getData().meanOfFinites();  // Blurring.
   }
 
-  objects_costmap[OBJECTS_COSTMAP_LAYER_] =
-      objects_costmap[OBJECTS_COSTMAP_LAYER_].cwiseMax(objects_costmap[BLURRED_OBJECTS_COSTMAP_LAYER_]);
+  objects_layer = objects_layer.cwiseMax(blurred_layer);
 
-  return objects_costmap[OBJECTS_COSTMAP_LAYER_];
+  return objects_layer;
 }
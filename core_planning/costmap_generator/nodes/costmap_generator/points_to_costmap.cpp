@@ -28,10 +28,17 @@
  *  OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  ********************/
 
+// headers in STL
+#include <cmath>
+#include <cstdint>
+
 #include "costmap_generator/points_to_costmap.h"
 
 // Constructor
 PointsToCostmap::PointsToCostmap()
+  : is_rolling_window_initialized_(false)
+  , rolling_window_start_stamp_(0.0)
+  , OBSERVED_TIME_LAYER_("observed_time")
 {
 }
 
@@ -62,13 +69,19 @@ bool PointsToCostmap::isValidInd(const grid_map::Index& grid_ind)
 }
 
 grid_map::Index PointsToCostmap::fetchGridIndexFromPoint(const pcl::PointXYZ& point)
+{
+  return fetchGridIndexFromPosition(point.x, point.y, grid_map::Position(grid_position_x_, grid_position_y_));
+}
+
+grid_map::Index PointsToCostmap::fetchGridIndexFromPosition(const double x, const double y,
+                                                            const grid_map::Position& grid_position)
 {
   // calculate out_grid_map position
-  const double origin_x_offset = grid_length_x_ / 2.0 - grid_position_x_;
-  const double origin_y_offset = grid_length_y_ / 2.0 - grid_position_y_;
+  const double origin_x_offset = grid_length_x_ / 2.0 - grid_position.x();
+  const double origin_y_offset = grid_length_y_ / 2.0 - grid_position.y();
   // coordinate conversion for making index. Set bottom left to the origin of coordinate (0, 0) in gridmap area
-  double mapped_x = (grid_length_x_ - origin_x_offset - point.x) / grid_resolution_;
-  double mapped_y = (grid_length_y_ - origin_y_offset - point.y) / grid_resolution_;
+  double mapped_x = (grid_length_x_ - origin_x_offset - x) / grid_resolution_;
+  double mapped_y = (grid_length_y_ - origin_y_offset - y) / grid_resolution_;
 
   int mapped_x_ind = std::ceil(mapped_x);
   int mapped_y_ind = std::ceil(mapped_y);
@@ -132,8 +145,180 @@ grid_map::Matrix PointsToCostmap::makeCostmapFromSensorPoints(
     const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points)
 {
   initGridmapParam(gridmap);
-  std::vector<std::vector<std::vector<double>>> grid_vec = assignPoints2GridCell(gridmap, in_sensor_points);
-  grid_map::Matrix costmap = calculateCostmap(maximum_height_thres, minimum_lidar_height_thres, grid_min_value,
-                                              grid_max_value, gridmap, gridmap_layer_name, grid_vec);
+
+  // a cell is occupied as soon as one point is in the height range, so only the state of each cell is kept
+  // instead of collecting every height per cell first
+  enum CellState : uint8_t
+  {
+    NO_POINTS,
+    OUT_OF_RANGE_POINTS,
+    IN_RANGE_POINTS
+  };
+  grid_map::Matrix costmap = gridmap[gridmap_layer_name];
+  Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic> cell_states =
+      Eigen::Matrix<uint8_t, Eigen::Dynamic, Eigen::Dynamic>::Constant(costmap.rows(), costmap.cols(), NO_POINTS);
+  for (const auto& point : *in_sensor_points)
+  {
+    grid_map::Index grid_ind = fetchGridIndexFromPoint(point);
+    if (!isValidInd(grid_ind))
+    {
+      continue;
+    }
+    uint8_t& state = cell_states(grid_ind.x(), grid_ind.y());
+    if (point.z <= maximum_height_thres && point.z >= minimum_lidar_height_thres)
+    {
+      state = IN_RANGE_POINTS;
+    }
+    else if (state == NO_POINTS)
+    {
+      state = OUT_OF_RANGE_POINTS;
+    }
+  }
+
+  // cells whose points are all out of the height range keep their previous cost
+  for (int x_ind = 0; x_ind < costmap.rows(); x_ind++)
+  {
+    for (int y_ind = 0; y_ind < costmap.cols(); y_ind++)
+    {
+      if (cell_states(x_ind, y_ind) == NO_POINTS)
+      {
+        costmap(x_ind, y_ind) = grid_min_value;
+      }
+      else if (cell_states(x_ind, y_ind) == IN_RANGE_POINTS)
+      {
+        costmap(x_ind, y_ind) = grid_max_value;
+      }
+    }
+  }
+  return costmap;
+}
+
+void PointsToCostmap::initRollingWindow(const grid_map::GridMap& gridmap, const grid_map::Position& window_position,
+                                        const double stamp)
+{
+  rolling_window_ = grid_map::GridMap();
+  rolling_window_.setGeometry(gridmap.getLength(), gridmap.getResolution(), window_position);
+  rolling_window_.add(OBSERVED_TIME_LAYER_);
+  rolling_window_start_stamp_ = stamp;
+  is_rolling_window_initialized_ = true;
+}
+
+grid_map::Matrix PointsToCostmap::makeCostmapFromSensorPointsRolling(
+    const double maximum_height_thres, const double minimum_lidar_height_thres, const double grid_min_value,
+    const double grid_max_value, const grid_map::GridMap& gridmap, const std::string& gridmap_layer_name,
+    const pcl::PointCloud<pcl::PointXYZ>::Ptr& in_sensor_points, const Eigen::Affine3d& sensor_to_fixed,
+    const double stamp, const double decay_time)
+{
+  initGridmapParam(gridmap);
+
+  // the window is centered at the gridmap center expressed in the fixed frame
+  const Eigen::Vector3d window_center = sensor_to_fixed * Eigen::Vector3d(grid_position_x_, grid_position_y_, 0.0);
+  const grid_map::Position window_position(window_center.x(), window_center.y());
+
+  if (!is_rolling_window_initialized_ || (rolling_window_.getSize() != gridmap.getSize()).any() ||
+      rolling_window_.getResolution() != gridmap.getResolution() || stamp < rolling_window_start_stamp_)
+  {
+    initRollingWindow(gridmap, window_position, stamp);
+  }
+  else
+  {
+    // shifts the circular buffer by whole cells and clears the cells leaving the window
+    rolling_window_.move(window_position);
+  }
+
+  const grid_map::Size size = rolling_window_.getSize();
+  const grid_map::Index start_index = rolling_window_.getStartIndex();
+  const grid_map::Position& rolling_position = rolling_window_.getPosition();
+  grid_map::Matrix& observed_time = rolling_window_[OBSERVED_TIME_LAYER_];
+
+  // time is kept relative to the first pointcloud, layers are stored as float
+  const float current_time = static_cast<float>(stamp - rolling_window_start_stamp_);
+
+  // output cells hit only by points out of the height range keep their previous cost, as in
+  // makeCostmapFromSensorPoints
+  grid_map::Matrix costmap = gridmap[gridmap_layer_name];
+  Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic> has_out_of_range_points =
+      Eigen::Matrix<bool, Eigen::Dynamic, Eigen::Dynamic>::Constant(costmap.rows(), costmap.cols(), false);
+  for (const auto& point : *in_sensor_points)
+  {
+    if (point.z > maximum_height_thres || point.z < minimum_lidar_height_thres)
+    {
+      const grid_map::Index grid_ind = fetchGridIndexFromPoint(point);
+      if (isValidInd(grid_ind))
+      {
+        has_out_of_range_points(grid_ind.x(), grid_ind.y()) = true;
+      }
+      continue;
+    }
+    const Eigen::Vector3d fixed_point = sensor_to_fixed * Eigen::Vector3d(point.x, point.y, point.z);
+    const grid_map::Index buffer_ind = fetchGridIndexFromPosition(fixed_point.x(), fixed_point.y(), rolling_position);
+    if (!grid_map::checkIfIndexInRange(buffer_ind, size))
+    {
+      continue;
+    }
+    const grid_map::Index ind = grid_map::getIndexFromBufferIndex(buffer_ind, size, start_index);
+    observed_time(ind.x(), ind.y()) = current_time;
+  }
+
+  // sample the window at the center of each output cell
+  const Eigen::Matrix3d rotation = sensor_to_fixed.linear();
+  const Eigen::Vector3d translation = sensor_to_fixed.translation();
+  for (int x_ind = 0; x_ind < costmap.rows(); x_ind++)
+  {
+    for (int y_ind = 0; y_ind < costmap.cols(); y_ind++)
+    {
+      const Eigen::Vector3d cell_center(grid_position_x_ + grid_length_x_ / 2.0 - (x_ind - 0.5) * grid_resolution_,
+                                        grid_position_y_ + grid_length_y_ / 2.0 - (y_ind - 0.5) * grid_resolution_,
+                                        0.0);
+      const Eigen::Vector3d fixed_center = rotation * cell_center + translation;
+      const grid_map::Index buffer_ind =
+          fetchGridIndexFromPosition(fixed_center.x(), fixed_center.y(), rolling_position);
+      bool is_occupied = false;
+      if (grid_map::checkIfIndexInRange(buffer_ind, size))
+      {
+        const grid_map::Index ind = grid_map::getIndexFromBufferIndex(buffer_ind, size, start_index);
+        const float observed = observed_time(ind.x(), ind.y());
+        is_occupied = !std::isnan(observed) && current_time - observed <= decay_time;
+      }
+      if (is_occupied)
+      {
+        costmap(x_ind, y_ind) = grid_max_value;
+      }
+      else if (!has_out_of_range_points(x_ind, y_ind))
+      {
+        costmap(x_ind, y_ind) = grid_min_value;
+      }
+    }
+  }
   return costmap;
 }
+
+bool PointsToCostmap::lookupSensorToFixedTransform(const tf::TransformListener& tf_listener,
+                                                   const std::string& fixed_frame, const std::string& sensor_frame,
+                                                   const ros::Time& stamp, Eigen::Affine3d* sensor_to_fixed)
+{
+  tf::StampedTransform transform;
+  try
+  {
+    tf_listener.waitForTransform(fixed_frame, sensor_frame, stamp, ros::Duration(0.1));
+    tf_listener.lookupTransform(fixed_frame, sensor_frame, stamp, transform);
+  }
+  catch (tf::TransformException ex)
+  {
+    ROS_ERROR("%s", ex.what());
+    return false;
+  }
+
+  const tf::Matrix3x3& basis = transform.getBasis();
+  const tf::Vector3& origin = transform.getOrigin();
+  sensor_to_fixed->setIdentity();
+  for (int i = 0; i < 3; i++)
+  {
+    for (int j = 0; j < 3; j++)
+    {
+      sensor_to_fixed->linear()(i, j) = basis[i][j];
+    }
+    sensor_to_fixed->translation()(i) = origin[i];
+  }
+  return true;
+}
@@ -31,6 +31,9 @@
 #include <ros/ros.h>
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <random>
+
 #include "costmap_generator/costmap_generator.h"
 #include "test_costmap_generator.hpp"
 
@@ -187,6 +190,250 @@ TEST_F(TestSuite, CheckHeightThresholdForCost)
   EXPECT_DOUBLE_EQ(expected_cost, costmap_mat(5,5));
 }
 
+pcl::PointCloud<pcl::PointXYZ>::Ptr makeDenseCloud(const size_t num_points, const double length_x,
+                                                   const double length_y, const unsigned int seed)
+{
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<float> dist_x(-length_x / 2.0, length_x / 2.0);
+  std::uniform_real_distribution<float> dist_y(-length_y / 2.0, length_y / 2.0);
+  std::uniform_real_distribution<float> dist_z(-4.0, 4.0);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr cloud(new pcl::PointCloud<pcl::PointXYZ>);
+  cloud->reserve(num_points);
+  for (size_t i = 0; i < num_points; i++)
+  {
+    cloud->push_back(pcl::PointXYZ(dist_x(engine), dist_y(engine), dist_z(engine)));
+  }
+  return cloud;
+}
+
+TEST_F(TestSuite, CheckMakeCostmapFromSensorPointsMatchesCellAssignment)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points = makeDenseCloud(1000, 12, 12, 0);
+
+  grid_map::Matrix expected_mat = test_obj_.calculateCostmap(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    test_obj_.assignPoints2GridCell(*test_obj_.dummy_costmap_, in_sensor_points));
+
+  grid_map::Matrix costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPoints(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    in_sensor_points);
+
+  EXPECT_TRUE(expected_mat.isApprox(costmap_mat));
+}
+
+TEST_F(TestSuite, CheckMakeCostmapFromSensorPointsKeepsCostOfOutOfRangeCells)
+{
+  const double previous_cost = 0.5;
+  (*test_obj_.dummy_costmap_)[test_obj_.dummy_layer_name_].setConstant(previous_cost);
+
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
+  in_sensor_points->push_back(pcl::PointXYZ(0.5, 0.5, 1.0));
+  in_sensor_points->push_back(pcl::PointXYZ(2.5, 2.5, test_obj_.dummy_maximum_lidar_height_thres_ + 1.0));
+  in_sensor_points->push_back(pcl::PointXYZ(-2.5, 2.5, test_obj_.dummy_minimum_lidar_height_thres_ - 1.0));
+  in_sensor_points->push_back(pcl::PointXYZ(-2.5, 2.5, 0.0));
+  const grid_map::Index in_range_ind =
+      test_obj_.fetchGridIndexFromPoint(*test_obj_.dummy_costmap_, in_sensor_points->at(0));
+  const grid_map::Index out_of_range_ind =
+      test_obj_.fetchGridIndexFromPoint(*test_obj_.dummy_costmap_, in_sensor_points->at(1));
+  const grid_map::Index mixed_ind =
+      test_obj_.fetchGridIndexFromPoint(*test_obj_.dummy_costmap_, in_sensor_points->at(2));
+
+  grid_map::Matrix costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPoints(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    in_sensor_points);
+
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_max_value_, costmap_mat(in_range_ind.x(), in_range_ind.y()));
+  EXPECT_DOUBLE_EQ(previous_cost, costmap_mat(out_of_range_ind.x(), out_of_range_ind.y()));
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_max_value_, costmap_mat(mixed_ind.x(), mixed_ind.y()));
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_min_value_, costmap_mat(0, 0));
+
+  // the same as collecting the heights per cell on a layer with a previous cost
+  pcl::PointCloud<pcl::PointXYZ>::Ptr dense_points = makeDenseCloud(200, 12, 12, 1);
+  grid_map::Matrix expected_mat = test_obj_.calculateCostmap(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    test_obj_.assignPoints2GridCell(*test_obj_.dummy_costmap_, dense_points));
+  costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPoints(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    dense_points);
+  EXPECT_TRUE(expected_mat.isApprox(costmap_mat));
+  EXPECT_TRUE((costmap_mat.array() == previous_cost).any());
+}
+
+TEST_F(TestSuite, CheckRollingCostmapStationary)
+{
+  // each output is the input layer of the next cycle, as in CostmapGenerator
+  const double previous_cost = 0.5;
+  grid_map::GridMap expected_costmap = *test_obj_.dummy_costmap_;
+  expected_costmap[test_obj_.dummy_layer_name_].setConstant(previous_cost);
+  grid_map::GridMap rolling_costmap = expected_costmap;
+
+  const Eigen::Affine3d identity = Eigen::Affine3d::Identity();
+  bool kept_previous_cost = false;
+  for (unsigned int cycle = 0; cycle < 5; cycle++)
+  {
+    // heights are spread beyond both thresholds, so some cells get only out-of-range points
+    pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points = makeDenseCloud(50, 12, 12, cycle);
+    grid_map::Matrix expected_mat = test_obj_.points2costmap_->makeCostmapFromSensorPoints(
+      test_obj_.dummy_maximum_lidar_height_thres_,
+      test_obj_.dummy_minimum_lidar_height_thres_,
+      test_obj_.dummy_grid_min_value_,
+      test_obj_.dummy_grid_max_value_,
+      expected_costmap,
+      test_obj_.dummy_layer_name_,
+      in_sensor_points);
+
+    const double stamp = 0.1 * cycle;
+    const double decay_time = 0.0;
+    grid_map::Matrix costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPointsRolling(
+      test_obj_.dummy_maximum_lidar_height_thres_,
+      test_obj_.dummy_minimum_lidar_height_thres_,
+      test_obj_.dummy_grid_min_value_,
+      test_obj_.dummy_grid_max_value_,
+      rolling_costmap,
+      test_obj_.dummy_layer_name_,
+      in_sensor_points, identity, stamp, decay_time);
+
+    EXPECT_TRUE(expected_mat.isApprox(costmap_mat));
+    // previous_cost survives only in cells that have had no point in the height range since the first cycle
+    kept_previous_cost |= (costmap_mat.array() == previous_cost).any();
+    expected_costmap[test_obj_.dummy_layer_name_] = expected_mat;
+    rolling_costmap[test_obj_.dummy_layer_name_] = costmap_mat;
+  }
+  EXPECT_TRUE(kept_previous_cost);
+}
+
+TEST_F(TestSuite, CheckRollingCostmapMovingWithDecay)
+{
+  pcl::PointCloud<pcl::PointXYZ>::Ptr in_sensor_points(new pcl::PointCloud<pcl::PointXYZ>);
+  test_obj_.dummy_pcl_point_->x = 0.5;
+  test_obj_.dummy_pcl_point_->y = 0.5;
+  test_obj_.dummy_pcl_point_->z = 1.0;
+  in_sensor_points->push_back(*test_obj_.dummy_pcl_point_);
+  pcl::PointCloud<pcl::PointXYZ>::Ptr empty_points(new pcl::PointCloud<pcl::PointXYZ>);
+
+  const double decay_time = 0.5;
+  Eigen::Affine3d sensor_to_fixed = Eigen::Affine3d::Identity();
+  grid_map::Matrix costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPointsRolling(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    in_sensor_points, sensor_to_fixed, 0.0, decay_time);
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_max_value_, costmap_mat(5, 5));
+
+  // vehicle moved 1m forward, the observed cell is now 1m behind the vehicle
+  sensor_to_fixed.translation().x() = 1.0;
+  costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPointsRolling(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    empty_points, sensor_to_fixed, 0.2, decay_time);
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_max_value_, costmap_mat(6, 5));
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_min_value_, costmap_mat(5, 5));
+
+  // observation is older than decay_time
+  costmap_mat = test_obj_.points2costmap_->makeCostmapFromSensorPointsRolling(
+    test_obj_.dummy_maximum_lidar_height_thres_,
+    test_obj_.dummy_minimum_lidar_height_thres_,
+    test_obj_.dummy_grid_min_value_,
+    test_obj_.dummy_grid_max_value_,
+    *test_obj_.dummy_costmap_,
+    test_obj_.dummy_layer_name_,
+    empty_points, sensor_to_fixed, 1.0, decay_time);
+  EXPECT_DOUBLE_EQ(test_obj_.dummy_grid_min_value_, costmap_mat(6, 5));
+}
+
+TEST_F(TestSuite, BenchmarkSensorPointsCostmapDenseCloud)
+{
+  grid_map::GridMap costmap;
+  costmap.setGeometry(grid_map::Length(50, 30), 0.2, grid_map::Position(20, 0));
+  costmap.add(test_obj_.dummy_layer_name_, test_obj_.dummy_grid_min_value_);
+
+  const int num_cycles = 20;
+  std::vector<pcl::PointCloud<pcl::PointXYZ>::Ptr> clouds;
+  for (int cycle = 0; cycle < num_cycles; cycle++)
+  {
+    clouds.push_back(makeDenseCloud(120000, 60, 40, cycle));
+  }
+
+  PointsToCostmap points2costmap;
+  std::chrono::duration<double, std::milli> cell_assignment_time(0);
+  std::chrono::duration<double, std::milli> in_place_time(0);
+  std::chrono::duration<double, std::milli> rolling_time(0);
+  for (int cycle = 0; cycle < num_cycles; cycle++)
+  {
+    auto start = std::chrono::steady_clock::now();
+    grid_map::Matrix expected_mat = test_obj_.calculateCostmap(
+      test_obj_.dummy_maximum_lidar_height_thres_,
+      test_obj_.dummy_minimum_lidar_height_thres_,
+      test_obj_.dummy_grid_min_value_,
+      test_obj_.dummy_grid_max_value_,
+      costmap,
+      test_obj_.dummy_layer_name_,
+      test_obj_.assignPoints2GridCell(costmap, clouds[cycle]));
+    cell_assignment_time += std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    grid_map::Matrix in_place_mat = points2costmap.makeCostmapFromSensorPoints(
+      test_obj_.dummy_maximum_lidar_height_thres_,
+      test_obj_.dummy_minimum_lidar_height_thres_,
+      test_obj_.dummy_grid_min_value_,
+      test_obj_.dummy_grid_max_value_,
+      costmap,
+      test_obj_.dummy_layer_name_,
+      clouds[cycle]);
+    in_place_time += std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    grid_map::Matrix rolling_mat = points2costmap.makeCostmapFromSensorPointsRolling(
+      test_obj_.dummy_maximum_lidar_height_thres_,
+      test_obj_.dummy_minimum_lidar_height_thres_,
+      test_obj_.dummy_grid_min_value_,
+      test_obj_.dummy_grid_max_value_,
+      costmap,
+      test_obj_.dummy_layer_name_,
+      clouds[cycle], Eigen::Affine3d::Identity(), 0.1 * cycle, 0.0);
+    rolling_time += std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(expected_mat.isApprox(in_place_mat));
+    EXPECT_TRUE(expected_mat.isApprox(rolling_mat));
+  }
+
+  std::cout << "per cycle [ms] cell assignment: " << cell_assignment_time.count() / num_cycles
+            << ", in place: " << in_place_time.count() / num_cycles
+            << ", rolling window: " << rolling_time.count() / num_cycles << std::endl;
+}
+
 TEST_F(TestSuite, CheckMakeExpandedPoints)
 {
   double expand_polygon_size = 1;
@@ -449,6 +696,129 @@ TEST_F(TestSuite, CheckMakeCostmapFromObjectsBoxBlur)
   EXPECT_NEAR(expected_score, gridmap_mat(7,6), buffer);
 }
 
+grid_map::Matrix makeCostmapFromObjectsWithPolygonIterator(TestClass& test_obj, const grid_map::GridMap& costmap,
+                                                           const double expand_polygon_size,
+                                                           const double size_of_expansion_kernel,
+                                                           const autoware_msgs::DetectedObjectArray::ConstPtr& in_objects,
+                                                           const bool use_objects_convex_hull)
+{
+  const std::string layer = "objects_costmap";
+  const std::string blurred_layer = "blurred_objects_costmap";
+  grid_map::GridMap objects_costmap = costmap;
+  objects_costmap.add(layer, 0);
+  objects_costmap.add(blurred_layer, 0);
+  for (const auto& object : in_objects->objects)
+  {
+    grid_map::Polygon polygon = use_objects_convex_hull ?
+                                    test_obj.makePolygonFromObjectConvexHull(object, expand_polygon_size) :
+                                    test_obj.makePolygonFromObjectBox(object, expand_polygon_size);
+    test_obj.setCostInPolygon(polygon, layer, object.score, objects_costmap);
+    test_obj.setCostInPolygon(polygon, blurred_layer, object.score, objects_costmap);
+  }
+  for (grid_map::SlidingWindowIterator iterator(objects_costmap, blurred_layer,
+                                                grid_map::SlidingWindowIterator::EdgeHandling::CROP,
+                                                size_of_expansion_kernel);
+       !iterator.isPastEnd(); ++iterator)
+  {
+    objects_costmap.at(blurred_layer, *iterator) = iterator.getData().meanOfFinites();
+  }
+  return objects_costmap[layer].cwiseMax(objects_costmap[blurred_layer]);
+}
+
+autoware_msgs::DetectedObjectArray::Ptr makeRandomObjects(const size_t num_objects, const double length_x,
+                                                          const double length_y, const double offset_x,
+                                                          const unsigned int seed)
+{
+  std::mt19937 engine(seed);
+  std::uniform_real_distribution<double> dist_x(offset_x - length_x / 2.0, offset_x + length_x / 2.0);
+  std::uniform_real_distribution<double> dist_y(-length_y / 2.0, length_y / 2.0);
+  std::uniform_real_distribution<double> dist_yaw(-M_PI, M_PI);
+  std::uniform_real_distribution<double> dist_size(0.5, 5.0);
+  std::uniform_real_distribution<float> dist_score(0.1, 1.0);
+  autoware_msgs::DetectedObjectArray::Ptr objects(new autoware_msgs::DetectedObjectArray);
+  for (size_t i = 0; i < num_objects; i++)
+  {
+    autoware_msgs::DetectedObject object;
+    object.header.frame_id = "test";
+    object.pose.position.x = dist_x(engine);
+    object.pose.position.y = dist_y(engine);
+    object.pose.orientation = tf::createQuaternionMsgFromYaw(dist_yaw(engine));
+    object.dimensions.x = dist_size(engine);
+    object.dimensions.y = dist_size(engine);
+    object.dimensions.z = 1.5;
+    object.score = dist_score(engine);
+
+    // convex hull of the footprint plus an upper layer which has to be ignored
+    for (const double z : { 0.0, 1.5 })
+    {
+      for (const double yaw : { 0.0, M_PI / 3, 2 * M_PI / 3, M_PI, 4 * M_PI / 3, 5 * M_PI / 3 })
+      {
+        geometry_msgs::Point32 point;
+        point.x = object.pose.position.x + object.dimensions.x / 2 * std::cos(yaw);
+        point.y = object.pose.position.y + object.dimensions.y / 2 * std::sin(yaw);
+        point.z = z;
+        object.convex_hull.polygon.points.push_back(point);
+      }
+    }
+    objects->objects.push_back(object);
+  }
+  return objects;
+}
+
+TEST_F(TestSuite, CheckMakeCostmapFromObjectsMatchesPolygonIterator)
+{
+  grid_map::GridMap costmap;
+  costmap.setGeometry(grid_map::Length(50, 30), 0.2, grid_map::Position(20, 0));
+  costmap.add(test_obj_.dummy_layer_name_, test_obj_.dummy_grid_min_value_);
+  autoware_msgs::DetectedObjectArray::ConstPtr objects = makeRandomObjects(50, 60, 40, 20, 0);
+
+  const double expand_polygon_size = 1;
+  const double size_of_expansion_kernel = 9;
+  for (const bool use_objects_convex_hull : { false, true })
+  {
+    grid_map::Matrix expected_mat = makeCostmapFromObjectsWithPolygonIterator(
+        test_obj_, costmap, expand_polygon_size, size_of_expansion_kernel, objects, use_objects_convex_hull);
+    grid_map::Matrix gridmap_mat = test_obj_.makeCostmapFromObjects(costmap, expand_polygon_size,
+                                                                    size_of_expansion_kernel, objects,
+                                                                    use_objects_convex_hull);
+    EXPECT_TRUE(expected_mat == gridmap_mat);
+  }
+}
+
+TEST_F(TestSuite, BenchmarkMakeCostmapFromObjects)
+{
+  grid_map::GridMap costmap;
+  costmap.setGeometry(grid_map::Length(50, 30), 0.2, grid_map::Position(20, 0));
+  costmap.add(test_obj_.dummy_layer_name_, test_obj_.dummy_grid_min_value_);
+
+  const int num_cycles = 10;
+  const double expand_polygon_size = 1;
+  const double size_of_expansion_kernel = 9;
+  const bool use_objects_convex_hull = true;
+  std::chrono::duration<double, std::milli> polygon_iterator_time(0);
+  std::chrono::duration<double, std::milli> scanline_time(0);
+  for (int cycle = 0; cycle < num_cycles; cycle++)
+  {
+    autoware_msgs::DetectedObjectArray::ConstPtr objects = makeRandomObjects(300, 60, 40, 20, cycle);
+
+    auto start = std::chrono::steady_clock::now();
+    grid_map::Matrix expected_mat = makeCostmapFromObjectsWithPolygonIterator(
+        test_obj_, costmap, expand_polygon_size, size_of_expansion_kernel, objects, use_objects_convex_hull);
+    polygon_iterator_time += std::chrono::steady_clock::now() - start;
+
+    start = std::chrono::steady_clock::now();
+    grid_map::Matrix gridmap_mat = test_obj_.makeCostmapFromObjects(costmap, expand_polygon_size,
+                                                                    size_of_expansion_kernel, objects,
+                                                                    use_objects_convex_hull);
+    scanline_time += std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(expected_mat == gridmap_mat);
+  }
+
+  std::cout << "per cycle with 300 objects [ms] polygon iterator: " << polygon_iterator_time.count() / num_cycles
+            << ", scanline: " << scanline_time.count() / num_cycles << std::endl;
+}
+
 int main(int argc, char** argv)
 {
   testing::InitGoogleTest(&argc, argv);
@@ -96,6 +96,9 @@ public:
   grid_map::Polygon makePolygonFromObjectConvexHull(const autoware_msgs::DetectedObject& in_object,
                                                     const double expand_polygon_size);
 
+  grid_map::Polygon makePolygonFromObjectBox(const autoware_msgs::DetectedObject& in_object,
+                                             const double expand_rectangle_size);
+
   void setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name,
                                        const float score, grid_map::GridMap& objects_costmap);
 
@@ -246,6 +249,12 @@ grid_map::Polygon TestClass::makePolygonFromObjectConvexHull(const autoware_msgs
   return objects2costmap_->makePolygonFromObjectConvexHull(in_object, expand_polygon_size);
 }
 
+grid_map::Polygon TestClass::makePolygonFromObjectBox(const autoware_msgs::DetectedObject& in_object,
+                                                    const double expand_rectangle_size)
+{
+  return objects2costmap_->makePolygonFromObjectBox(in_object, expand_rectangle_size);
+}
+
 void TestClass::setCostInPolygon(const grid_map::Polygon& polygon, const std::string& gridmap_layer_name,
                                      const float score, grid_map::GridMap& objects_costmap)
 {
@@ -71,11 +71,13 @@ public:
 	double pathDensity;
 	PlannerHNS::MAP_SOURCE_TYPE	mapSource;
 	bool bEnableDynamicMapUpdate;
+	bool bGoalsAsViaPoints;
 
 
 	WayPlannerParams()
 	{
 	    bEnableDynamicMapUpdate = false;
+	    bGoalsAsViaPoints = false;
 		bEnableReplanning = false;
 		bEnableHMI = false;
 		bEnableSmoothing = false;
@@ -158,6 +160,7 @@ private:
   	void SaveSimulationData();
   	int LoadSimulationData();
   	void ClearOldCostFromMap();
+  	void UpdateReachedViaPoints();
 
 
   	//Mapping Section
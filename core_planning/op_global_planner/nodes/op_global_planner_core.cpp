@@ -35,6 +35,7 @@ GlobalPlanner::GlobalPlanner()
 	nh.getParam("/op_global_planner/enableRvizInput" , m_params.bEnableRvizInput);
 	nh.getParam("/op_global_planner/enableReplan" , m_params.bEnableReplanning);
 	nh.getParam("/op_global_planner/enableDynamicMapUpdate" , m_params.bEnableDynamicMapUpdate);
+	nh.getParam("/op_global_planner/goalsAsViaPoints" , m_params.bGoalsAsViaPoints);
 	nh.getParam("/op_global_planner/mapFileName" , m_params.KmlMapPath);
 
 	int iSource = 0;
@@ -135,6 +136,8 @@ void GlobalPlanner::callbackGetRoadStatusOccupancyGrid(const nav_msgs::Occupancy
 	UtilityHNS::UtilityH::GetTickCount(t);
 	PlannerHNS::MappingHelpers::UpdateMapWithOccupancyGrid(grid, m_GridMapIntType, m_Map, modified_nodes);
 	m_ModifiedMapItemsTimes.push_back(std::make_pair(modified_nodes, t));
+	if(modified_nodes.size() > 0)
+		m_PlannerH.ClearSearchTree();
 
 	visualization_msgs::MarkerArray map_marker_array;
 	PlannerHNS::ROSHelpers::ConvertFromRoadNetworkToAutowareVisualizeMapFormat(m_Map, map_marker_array);
@@ -163,6 +166,9 @@ void GlobalPlanner::ClearOldCostFromMap()
 				}
 			}
 
+			if(m_ModifiedMapItemsTimes.at(i).first.size() > 0)
+				m_PlannerH.ClearSearchTree();
+
 			m_ModifiedMapItemsTimes.erase(m_ModifiedMapItemsTimes.begin()+i);
 			i--;
 		}
@@ -217,7 +223,22 @@ bool GlobalPlanner::GenerateGlobalPlan(PlannerHNS::WayPoint& startPoint, Planner
 	std::vector<int> predefinedLanesIds;
 	double ret = 0;
 
-	ret = m_PlannerH.PlanUsingDP(startPoint, goalPoint, MAX_GLOBAL_PLAN_DISTANCE, m_params.bEnableLaneChange, predefinedLanesIds, m_Map, generatedTotalPaths);
+	if(m_params.bGoalsAsViaPoints)
+	{
+		//one route passing by all the remaining goals in order
+		std::vector<PlannerHNS::WayPoint> viaPoints(m_GoalsPos.begin()+m_iCurrentGoalIndex, m_GoalsPos.end());
+		ret = m_PlannerH.PlanUsingDPViaPoints(startPoint, viaPoints, MAX_GLOBAL_PLAN_DISTANCE, m_params.bEnableLaneChange, predefinedLanesIds, m_Map, generatedTotalPaths);
+	}
+	else
+	{
+		//the search tree is kept by the planner, replanning from the same lane doesn't expand it again
+		std::vector<PlannerHNS::WayPoint> goalsPos(1, goalPoint);
+		std::vector<std::vector<std::vector<PlannerHNS::WayPoint> > > goalsPaths;
+		std::vector<double> goalsDistances;
+		m_PlannerH.PlanUsingDPMultiGoal(startPoint, goalsPos, MAX_GLOBAL_PLAN_DISTANCE, m_params.bEnableLaneChange, predefinedLanesIds, m_Map, goalsPaths, goalsDistances);
+		ret = goalsDistances.at(0);
+		generatedTotalPaths = goalsPaths.at(0);
+	}
 
 	if(ret == 0)
 	{
@@ -260,6 +281,37 @@ bool GlobalPlanner::GenerateGlobalPlan(PlannerHNS::WayPoint& startPoint, Planner
 	return false;
 }
 
+void GlobalPlanner::UpdateReachedViaPoints()
+{
+	//drop the via points the car passed on the current route, so a new plan doesn't go back to them
+	PlannerHNS::RelativeInfo info;
+	bool ret = PlannerHNS::PlanningHelpers::GetRelativeInfoRange(m_GeneratedTotalPaths, m_CurrentPose, 0.75, info);
+	if(ret == false || info.iGlobalPath < 0 || info.iGlobalPath >= (int)m_GeneratedTotalPaths.size())
+		return;
+
+	const std::vector<PlannerHNS::WayPoint>& path = m_GeneratedTotalPaths.at(info.iGlobalPath);
+	if(info.iFront < 0 || info.iFront >= (int)path.size())
+		return;
+
+	double car_distance = path.at(info.iFront).cost + info.to_front_distance;
+
+	//the last goal is the destination, it is never dropped
+	while(m_iCurrentGoalIndex + 1 < (int)m_GoalsPos.size())
+	{
+		PlannerHNS::RelativeInfo via_info;
+		if(!PlannerHNS::PlanningHelpers::GetRelativeInfo(path, m_GoalsPos.at(m_iCurrentGoalIndex), via_info)
+				|| via_info.iFront < 0 || via_info.iFront >= (int)path.size())
+			break;
+
+		double via_distance = path.at(via_info.iFront).cost + via_info.to_front_distance;
+		if(car_distance < via_distance)
+			break;
+
+		m_iCurrentGoalIndex++;
+		std::cout << "Via Point Passed, Current Goal Index = " << m_iCurrentGoalIndex << std::endl << std::endl;
+	}
+}
+
 void GlobalPlanner::VisualizeAndSend(const std::vector<std::vector<PlannerHNS::WayPoint> > generatedTotalPaths)
 {
 	autoware_msgs::LaneArray lane_array;
@@ -406,6 +458,7 @@ void GlobalPlanner::MainLoop()
 	{
 		ros::spinOnce();
 		bool bMakeNewPlan = false;
+		bool bMapLoaded = m_bKmlMap;
 
 		if(m_params.mapSource == PlannerHNS::MAP_KML_FILE && !m_bKmlMap)
 		{
@@ -458,12 +511,18 @@ void GlobalPlanner::MainLoop()
 			}
 		}
 
+		if(!bMapLoaded && m_bKmlMap)
+			m_PlannerH.ClearSearchTree();
+
 		ClearOldCostFromMap();
 
 		if(m_GoalsPos.size() > 0)
 		{
 			if(m_GeneratedTotalPaths.size() > 0 && m_GeneratedTotalPaths.at(0).size() > 3)
 			{
+				if(m_params.bGoalsAsViaPoints)
+					UpdateReachedViaPoints();
+
 				if(m_params.bEnableReplanning)
 				{
 					PlannerHNS::RelativeInfo info;
@@ -474,8 +533,10 @@ void GlobalPlanner::MainLoop()
 						if(remaining_distance <= REPLANNING_DISTANCE)
 						{
 							bMakeNewPlan = true;
-							if(m_GoalsPos.size() > 0)
+							if(m_GoalsPos.size() > 0 && !m_params.bGoalsAsViaPoints)
 								m_iCurrentGoalIndex = (m_iCurrentGoalIndex + 1) % m_GoalsPos.size();
+							else if(m_params.bGoalsAsViaPoints)
+								m_iCurrentGoalIndex = 0; //the route is done, pass by all the goals again
 							std::cout << "Current Goal Index = " << m_iCurrentGoalIndex << std::endl << std::endl;
 						}
 					}
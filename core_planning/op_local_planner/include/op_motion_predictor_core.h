@@ -44,6 +44,7 @@
 
 #include "op_planner/PlannerCommonDef.h"
 #include "op_planner/BehaviorPrediction.h"
+#include "op_planner/CurbObstacles.h"
 #include "op_utility/DataRW.h"
 
 namespace MotionPredictorNS
@@ -74,6 +75,9 @@ protected:
 
 	bool m_bEnableCurbObstacles;
 	std::vector<PlannerHNS::DetectedObject> curr_curbs_obstacles;
+	std::vector<autoware_msgs::DetectedObject> m_CurbsPredictedObjects;
+	PlannerHNS::CurbObstacles m_CurbObstacles;
+	bool bCurbsIndex;
 
 	PlannerHNS::BehaviorPrediction m_PredictBeh;
 	autoware_msgs::DetectedObjectArray m_PredictedResultsResults;
@@ -122,7 +126,7 @@ protected:
 	//Helper functions
 	void VisualizePrediction();
 	void UpdatePlanningParams(ros::NodeHandle& _nh);
-	void GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles);
+	bool GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles);
 
 public:
 	MotionPrediction();
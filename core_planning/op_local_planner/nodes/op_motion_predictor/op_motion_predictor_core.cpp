@@ -28,6 +28,7 @@ MotionPrediction::MotionPrediction()
 	bVehicleStatus = false;
 	bTrackedObjects = false;
 	m_bEnableCurbObstacles = false;
+	bCurbsIndex = false;
 	m_DistanceBetweenCurbs = 1.0;
 	m_VisualizationTime = 0.25;
 	m_bGoNextStep = false;
@@ -244,14 +245,18 @@ void MotionPrediction::callbackGetTrackedObjects(const autoware_msgs::DetectedOb
 
 		if(m_bEnableCurbObstacles)
 		{
-			curr_curbs_obstacles.clear();
-			GenerateCurbsObstacles(curr_curbs_obstacles);
-			//std::cout << "Curbs No: " << curr_curbs_obstacles.size() << endl;
-			for(unsigned int i = 0 ; i <curr_curbs_obstacles.size(); i++)
+			//the curbs messages are only converted again when the selected curbs change
+			if(GenerateCurbsObstacles(curr_curbs_obstacles))
 			{
-				PlannerHNS::ROSHelpers::ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(curr_curbs_obstacles.at(i), false, pred_obj);
-				m_PredictedResultsResults.objects.push_back(pred_obj);
+				//std::cout << "Curbs No: " << curr_curbs_obstacles.size() << endl;
+				m_CurbsPredictedObjects.clear();
+				for(unsigned int i = 0 ; i <curr_curbs_obstacles.size(); i++)
+				{
+					PlannerHNS::ROSHelpers::ConvertFromOpenPlannerDetectedObjectToAutowareDetectedObject(curr_curbs_obstacles.at(i), false, pred_obj);
+					m_CurbsPredictedObjects.push_back(pred_obj);
+				}
 			}
+			m_PredictedResultsResults.objects.insert(m_PredictedResultsResults.objects.end(), m_CurbsPredictedObjects.begin(), m_CurbsPredictedObjects.end());
 		}
 
 		m_PredictedResultsResults.header.stamp = ros::Time().now();
@@ -259,43 +264,11 @@ void MotionPrediction::callbackGetTrackedObjects(const autoware_msgs::DetectedOb
 	}
 }
 
-void MotionPrediction::GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles)
+bool MotionPrediction::GenerateCurbsObstacles(std::vector<PlannerHNS::DetectedObject>& curb_obstacles)
 {
-	if(!bNewCurrentPos) return;
-
-	for(unsigned int ic = 0; ic < m_Map.curbs.size(); ic++)
-	{
-
-		if(m_Map.curbs.at(ic).points.size() > 0)
-		{
-			PlannerHNS::DetectedObject obj;
-			obj.center.pos = m_Map.curbs.at(ic).points.at(0);
-
-			if(curb_obstacles.size()>0)
-			{
-				double distance_to_prev = hypot(curb_obstacles.at(curb_obstacles.size()-1).center.pos.y-obj.center.pos.y, curb_obstacles.at(curb_obstacles.size()-1).center.pos.x-obj.center.pos.x);
-				if(distance_to_prev < m_DistanceBetweenCurbs)
-					continue;
-			}
-
-			double longitudinalDist = hypot(m_CurrentPos.pos.y -obj.center.pos.y, m_CurrentPos.pos.x-obj.center.pos.x);
+	if(!bNewCurrentPos || !bCurbsIndex) return false;
 
-			if(longitudinalDist > m_PlanningParams.horizonDistance)
-				continue;
-
-			obj.bDirection = false;
-			obj.bVelocity = false;
-			obj.id = -1;
-			obj.t  = PlannerHNS::SIDEWALK;
-			obj.label = "curb";
-			for(unsigned int icp=0; icp< m_Map.curbs.at(ic).points.size(); icp++)
-			{
-				obj.contour.push_back(m_Map.curbs.at(ic).points.at(icp));
-			}
-
-			curb_obstacles.push_back(obj);
-		}
-	}
+	return m_CurbObstacles.GetObstacles(m_CurrentPos, m_PlanningParams.horizonDistance, m_DistanceBetweenCurbs, curb_obstacles);
 }
 
 void MotionPrediction::VisualizePrediction()
@@ -448,6 +421,12 @@ void MotionPrediction::MainLoop()
 			}
 		}
 
+		if(bMap && m_bEnableCurbObstacles && !bCurbsIndex)
+		{
+			bCurbsIndex = true;
+			m_CurbObstacles.SetCurbs(m_Map.curbs);
+		}
+
 		if(UtilityHNS::UtilityH::GetTimeDiffNow(m_VisualizationTimer) > m_VisualizationTime)
 		{
 			VisualizePrediction();
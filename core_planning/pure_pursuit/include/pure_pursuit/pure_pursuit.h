@@ -24,11 +24,13 @@
 #include <geometry_msgs/TwistStamped.h>
 
 // C++ includes
+#include <utility>
 #include <vector>
 
 // User defined includes
 #include <autoware_msgs/Lane.h>
 #include <libwaypoint_follower/libwaypoint_follower.h>
+#include <pure_pursuit/waypoint_path.h>
 
 namespace waypoint_follower
 {
@@ -54,6 +56,12 @@ public:
   void setCurrentWaypoints(const std::vector<autoware_msgs::Waypoint>& wps)
   {
     current_waypoints_ = wps;
+    current_path_.setWaypoints(current_waypoints_);
+  }
+  void setCurrentWaypoints(std::vector<autoware_msgs::Waypoint>&& wps)
+  {
+    current_waypoints_ = std::move(wps);
+    current_path_.setWaypoints(current_waypoints_);
   }
   void setCurrentPose(const geometry_msgs::PoseStampedConstPtr& msg)
   {
@@ -77,7 +85,7 @@ public:
   {
     return current_pose_;
   }
-  std::vector<autoware_msgs::Waypoint> getCurrentWaypoints() const
+  const std::vector<autoware_msgs::Waypoint>& getCurrentWaypoints() const
   {
     return current_waypoints_;
   }
@@ -117,6 +125,7 @@ private:
   geometry_msgs::Pose current_pose_;
   double current_linear_velocity_;
   std::vector<autoware_msgs::Waypoint> current_waypoints_;
+  WaypointPath current_path_;
 
   // functions
   double calcCurvature(geometry_msgs::Point target) const;
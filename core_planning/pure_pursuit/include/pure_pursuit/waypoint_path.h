@@ -0,0 +1,96 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef PURE_PURSUIT_WAYPOINT_PATH_H
+#define PURE_PURSUIT_WAYPOINT_PATH_H
+
+// ROS includes
+#include <geometry_msgs/Point.h>
+
+// C++ includes
+#include <vector>
+
+// User defined includes
+#include <autoware_msgs/Waypoint.h>
+
+namespace waypoint_follower
+{
+/**
+ * \brief Planar geometry of the waypoints, prepared once per path for the searches of PurePursuit.
+ *
+ * The waypoints are grouped into a hierarchy of nodes, each bounding its waypoints by a circle and the directions of
+ * its segments by a cone. A search only looks at the waypoints of the nodes it cannot rule out as a whole, so it
+ * visits the waypoints around the vehicle instead of the whole path. The results are exactly those of a scan over
+ * all waypoints.
+ */
+class WaypointPath
+{
+public:
+  void setWaypoints(const std::vector<autoware_msgs::Waypoint>& waypoints);
+
+  int size() const
+  {
+    return static_cast<int>(points_.size());
+  }
+
+  /**
+   * \brief Returns the idx number of next waypoint that is in front of the position, -1 if there is none.
+   *
+   * Starting from waypoint 0, this is the waypoint before the first one that is farther from the position than the
+   * closest waypoint before it and, if use_lookahead_distance, not closer than lookahead_distance, with the waypoint
+   * before it in front of the position along the segment between them. If no waypoint before the last qualifies, the
+   * last waypoint is returned.
+   */
+  int getNextWaypointNumber(
+    const geometry_msgs::Point& position, double lookahead_distance, bool use_lookahead_distance) const;
+  // true if any waypoint is farther than distance from the position
+  bool hasWaypointFartherThan(const geometry_msgs::Point& position, double distance) const;
+
+private:
+  // bounds of the waypoints idx - 1 and idx for the idx numbers [begin, end)
+  struct Node
+  {
+    int begin, end;
+    double center_x, center_y, radius;
+    // normalized mean direction of the segments, their largest deviation from it and the largest projection of their
+    // start points on it
+    bool has_direction;
+    double direction_x, direction_y, deviation, projection;
+  };
+  struct SearchState;
+
+  static constexpr int LEAF_SIZE = 16;
+  static constexpr int BRANCHING = 8;
+
+  std::vector<geometry_msgs::Point> points_;
+  std::vector<double> arc_length_;
+  // normalized direction of the segment from waypoint idx - 1 to idx, zero for a segment without length
+  std::vector<double> direction_x_, direction_y_;
+  // levels_[0] are the leaves, every node of the next level covers BRANCHING nodes of the level below
+  std::vector<std::vector<Node>> levels_;
+
+  Node createLeaf(int begin, int end) const;
+  Node createParent(const std::vector<Node>& children, int first, int last) const;
+  double getDistance(int idx, const geometry_msgs::Point& position) const;
+  bool isAhead(int idx, const geometry_msgs::Point& position) const;
+  bool isBehindAll(const Node& node, const geometry_msgs::Point& position, double node_distance) const;
+  int search(int level, int node_idx, SearchState* state) const;
+  bool isAboveMinimum(double distance, SearchState* state) const;
+  bool hasWaypointFartherThan(int level, int node_idx, const geometry_msgs::Point& position, double distance) const;
+};
+}  // namespace waypoint_follower
+
+#endif  // PURE_PURSUIT_WAYPOINT_PATH_H
@@ -14,6 +14,7 @@
  * limitations under the License.
  */
 
+#include <utility>
 #include <vector>
 #include <pure_pursuit/pure_pursuit_core.h>
 
@@ -282,7 +283,7 @@ void PurePursuitNode::callbackFromWayPoints(
     expand_size_ = -expanded_lane.waypoints.size();
     connectVirtualLastWaypoints(&expanded_lane, direction_);
     expand_size_ += expanded_lane.waypoints.size();
-    pp_.setCurrentWaypoints(expanded_lane.waypoints);
+    pp_.setCurrentWaypoints(std::move(expanded_lane.waypoints));
   }
   else
   {
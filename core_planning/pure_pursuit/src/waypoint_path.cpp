@@ -0,0 +1,434 @@
+/*
+ * Copyright 2015-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <libwaypoint_follower/libwaypoint_follower.h>
+#include <pure_pursuit/waypoint_path.h>
+
+namespace waypoint_follower
+{
+namespace
+{
+// slack for the rounding errors of the bounds, the bounds only rule out waypoints that are clearly outside of them
+constexpr double DISTANCE_MARGIN = 1e-6;
+// cosine slack, so that the angle of a waypoint ruled out as behind is clearly larger than 90 degrees
+constexpr double ANGLE_MARGIN = 1e-9;
+}  // namespace
+
+constexpr int WaypointPath::LEAF_SIZE;
+constexpr int WaypointPath::BRANCHING;
+
+// a node ruled out as a whole, its distances are only resolved if the closest distance is needed
+struct WaypointPath::SearchState
+{
+  struct Skipped
+  {
+    const Node* node;
+    double min_distance, max_distance;
+  };
+
+  geometry_msgs::Point position;
+  double lookahead_distance;
+  bool use_lookahead_distance;
+  double closest_distance;
+  std::vector<Skipped> skipped;
+};
+
+void WaypointPath::setWaypoints(const std::vector<autoware_msgs::Waypoint>& waypoints)
+{
+  // the same path is republished with every cycle, only its velocities change
+  const int path_size = static_cast<int>(waypoints.size());
+  bool is_same_path = path_size == size();
+  for (int i = 0; is_same_path && i < path_size; i++)
+  {
+    const geometry_msgs::Point& point = waypoints[i].pose.pose.position;
+    is_same_path = point.x == points_[i].x && point.y == points_[i].y && point.z == points_[i].z;
+  }
+  if (is_same_path)
+  {
+    return;
+  }
+
+  points_.resize(path_size);
+  arc_length_.resize(path_size);
+  direction_x_.resize(path_size);
+  direction_y_.resize(path_size);
+  for (int i = 0; i < path_size; i++)
+  {
+    points_[i] = waypoints[i].pose.pose.position;
+    if (i == 0)
+    {
+      arc_length_[i] = 0;
+      direction_x_[i] = direction_y_[i] = 0;
+      continue;
+    }
+    double dx = points_[i].x - points_[i - 1].x;
+    double dy = points_[i].y - points_[i - 1].y;
+    double length = std::sqrt(dx * dx + dy * dy);
+    double inverse_length = length > 0 ? 1 / length : 0;
+    arc_length_[i] = arc_length_[i - 1] + length;
+    direction_x_[i] = dx * inverse_length;
+    direction_y_[i] = dy * inverse_length;
+  }
+
+  // the searches cover the idx numbers between the first and the last waypoint
+  levels_.clear();
+  if (path_size < 3)
+  {
+    return;
+  }
+  levels_.emplace_back();
+  for (int begin = 1; begin < path_size - 1; begin += LEAF_SIZE)
+  {
+    levels_.back().push_back(createLeaf(begin, std::min(begin + LEAF_SIZE, path_size - 1)));
+  }
+  while (levels_.back().size() > 1)
+  {
+    const std::vector<Node>& children = levels_.back();
+    std::vector<Node> parents;
+    const int num_children = static_cast<int>(children.size());
+    for (int first = 0; first < num_children; first += BRANCHING)
+    {
+      parents.push_back(createParent(children, first, std::min(first + BRANCHING, num_children)));
+    }
+    levels_.push_back(std::move(parents));
+  }
+}
+
+WaypointPath::Node WaypointPath::createLeaf(int begin, int end) const
+{
+  Node node;
+  node.begin = begin;
+  node.end = end;
+
+  double min_x = points_[begin - 1].x, max_x = min_x;
+  double min_y = points_[begin - 1].y, max_y = min_y;
+  double sum_x = 0, sum_y = 0;
+  for (int i = begin; i < end; i++)
+  {
+    min_x = std::min(min_x, points_[i].x);
+    max_x = std::max(max_x, points_[i].x);
+    min_y = std::min(min_y, points_[i].y);
+    max_y = std::max(max_y, points_[i].y);
+    sum_x += direction_x_[i];
+    sum_y += direction_y_[i];
+  }
+  node.center_x = (min_x + max_x) / 2;
+  node.center_y = (min_y + max_y) / 2;
+  double radius2 = 0;
+  for (int i = begin - 1; i < end; i++)
+  {
+    double dx = points_[i].x - node.center_x;
+    double dy = points_[i].y - node.center_y;
+    radius2 = std::max(radius2, dx * dx + dy * dy);
+  }
+  node.radius = std::sqrt(radius2);
+
+  double sum = std::sqrt(sum_x * sum_x + sum_y * sum_y);
+  node.has_direction = sum > 0;
+  node.direction_x = node.has_direction ? sum_x / sum : 0;
+  node.direction_y = node.has_direction ? sum_y / sum : 0;
+  double deviation2 = 0;
+  node.projection = -std::numeric_limits<double>::infinity();
+  for (int i = begin; i < end; i++)
+  {
+    // a segment without length is never in front
+    if (direction_x_[i] == 0 && direction_y_[i] == 0)
+    {
+      continue;
+    }
+    double dx = direction_x_[i] - node.direction_x;
+    double dy = direction_y_[i] - node.direction_y;
+    deviation2 = std::max(deviation2, dx * dx + dy * dy);
+    node.projection =
+      std::max(node.projection, points_[i - 1].x * node.direction_x + points_[i - 1].y * node.direction_y);
+  }
+  node.deviation = std::sqrt(deviation2);
+  return node;
+}
+
+// bounds of the children [first, last), they are looser than those of a leaf over the same waypoints
+WaypointPath::Node WaypointPath::createParent(const std::vector<Node>& children, int first, int last) const
+{
+  Node node;
+  node.begin = children[first].begin;
+  node.end = children[last - 1].end;
+
+  double min_x = std::numeric_limits<double>::infinity(), max_x = -min_x;
+  double min_y = min_x, max_y = max_x;
+  double sum_x = 0, sum_y = 0;
+  for (int k = first; k < last; k++)
+  {
+    const Node& child = children[k];
+    min_x = std::min(min_x, child.center_x - child.radius);
+    max_x = std::max(max_x, child.center_x + child.radius);
+    min_y = std::min(min_y, child.center_y - child.radius);
+    max_y = std::max(max_y, child.center_y + child.radius);
+    sum_x += child.direction_x * (child.end - child.begin);
+    sum_y += child.direction_y * (child.end - child.begin);
+  }
+  node.center_x = (min_x + max_x) / 2;
+  node.center_y = (min_y + max_y) / 2;
+  node.radius = 0;
+  for (int k = first; k < last; k++)
+  {
+    const Node& child = children[k];
+    double dx = child.center_x - node.center_x;
+    double dy = child.center_y - node.center_y;
+    node.radius = std::max(node.radius, std::sqrt(dx * dx + dy * dy) + child.radius);
+  }
+
+  double sum = std::sqrt(sum_x * sum_x + sum_y * sum_y);
+  node.has_direction = sum > 0;
+  node.direction_x = node.has_direction ? sum_x / sum : 0;
+  node.direction_y = node.has_direction ? sum_y / sum : 0;
+  node.deviation = 0;
+  node.projection = -std::numeric_limits<double>::infinity();
+  for (int k = first; k < last; k++)
+  {
+    const Node& child = children[k];
+    if (!child.has_direction)
+    {
+      // without a direction the child may still have segments of any direction
+      node.has_direction = false;
+      break;
+    }
+    double dx = child.direction_x - node.direction_x;
+    double dy = child.direction_y - node.direction_y;
+    node.deviation = std::max(node.deviation, std::sqrt(dx * dx + dy * dy) + child.deviation);
+    node.projection =
+      std::max(node.projection, child.center_x * node.direction_x + child.center_y * node.direction_y + child.radius);
+  }
+  return node;
+}
+
+double WaypointPath::getDistance(int idx, const geometry_msgs::Point& position) const
+{
+  return getPlaneDistance(points_[idx], position);
+}
+
+// whether the waypoint before idx is in front of the position, along the segment to idx
+bool WaypointPath::isAhead(int idx, const geometry_msgs::Point& position) const
+{
+  const geometry_msgs::Point& prev = points_[idx - 1];
+  const geometry_msgs::Point& curr = points_[idx];
+  tf::Vector3 curr_vector(prev.x - position.x, prev.y - position.y, prev.z - position.z);
+  curr_vector.setZ(0);
+  tf::Vector3 traj_vector(curr.x - prev.x, curr.y - prev.y, curr.z - prev.z);
+  traj_vector.setZ(0);
+  double angle_in_rad = std::fabs(tf::tfAngle(curr_vector, traj_vector));
+  // if degree between curr_vector and the direction of the trajectory is more than 90 degrees, the point is behind
+  return !(std::isnan(angle_in_rad) || angle_in_rad > M_PI / 2);
+}
+
+// whether the position is past the start of every segment of the node, so that none of them is ahead
+bool WaypointPath::isBehindAll(const Node& node, const geometry_msgs::Point& position, double node_distance) const
+{
+  if (!node.has_direction)
+  {
+    return false;
+  }
+  // (position - start) * direction >= (position - start) * mean_direction - |position - start| * deviation
+  double projection = position.x * node.direction_x + position.y * node.direction_y - node.projection;
+  double max_distance = node_distance + node.radius;
+  return projection - max_distance * (node.deviation + ANGLE_MARGIN) > DISTANCE_MARGIN;
+}
+
+int WaypointPath::getNextWaypointNumber(
+  const geometry_msgs::Point& position, double lookahead_distance, bool use_lookahead_distance) const
+{
+  const int path_size = size();
+  if (path_size <= 1)
+  {
+    return -1;
+  }
+
+  SearchState state;
+  state.position = position;
+  state.lookahead_distance = lookahead_distance;
+  state.use_lookahead_distance = use_lookahead_distance;
+  state.closest_distance = getDistance(0, position);
+  if (!levels_.empty())
+  {
+    const int top = static_cast<int>(levels_.size()) - 1;
+    for (int node_idx = 0; node_idx < static_cast<int>(levels_[top].size()); node_idx++)
+    {
+      int idx = search(top, node_idx, &state);
+      if (idx != -1)
+      {
+        return idx - 1;
+      }
+    }
+  }
+  // the search reached the last waypoint
+  return path_size - 1;
+}
+
+int WaypointPath::search(int level, int node_idx, SearchState* state) const
+{
+  const Node& node = levels_[level][node_idx];
+  const geometry_msgs::Point& position = state->position;
+  double node_distance = std::hypot(position.x - node.center_x, position.y - node.center_y);
+  SearchState::Skipped skipped{ &node, node_distance - node.radius - DISTANCE_MARGIN,
+                                node_distance + node.radius + DISTANCE_MARGIN };
+  if ((state->use_lookahead_distance && skipped.max_distance < state->lookahead_distance) ||
+    isBehindAll(node, position, node_distance))
+  {
+    state->skipped.push_back(skipped);
+    return -1;
+  }
+
+  if (level > 0)
+  {
+    const int num_children = static_cast<int>(levels_[level - 1].size());
+    for (int child = node_idx * BRANCHING; child < std::min((node_idx + 1) * BRANCHING, num_children); child++)
+    {
+      int idx = search(level - 1, child, state);
+      if (idx != -1)
+      {
+        return idx;
+      }
+    }
+    return -1;
+  }
+
+  for (int i = node.begin; i < node.end; i++)
+  {
+    double distance = getDistance(i, position);
+    if (state->use_lookahead_distance && distance < state->lookahead_distance)
+    {
+      state->closest_distance = std::min(state->closest_distance, distance);
+      // the following waypoints stay within the lookahead distance at least until the arc length catches up
+      double arc_length = arc_length_[i] + (state->lookahead_distance - distance) - DISTANCE_MARGIN;
+      while (i + 1 < node.end && arc_length_[i + 1] < arc_length)
+      {
+        i++;
+      }
+      continue;
+    }
+    if (isAhead(i, position) && isAboveMinimum(distance, state))
+    {
+      return i;
+    }
+    state->closest_distance = std::min(state->closest_distance, distance);
+  }
+  return -1;
+}
+
+// whether distance is above the closest distance of the waypoints before, strictly if the lookahead distance is used
+bool WaypointPath::isAboveMinimum(double distance, SearchState* state) const
+{
+  auto is_above = [state, distance](double closest_distance) {
+    return state->use_lookahead_distance ? closest_distance < distance : closest_distance <= distance;
+  };
+  if (is_above(state->closest_distance))
+  {
+    return true;
+  }
+  for (const auto& skipped : state->skipped)
+  {
+    if (is_above(skipped.max_distance))
+    {
+      return true;
+    }
+  }
+  // the bounds are not sufficient, resolve the distances of the skipped nodes that may be closer
+  for (auto it = state->skipped.begin(); it != state->skipped.end();)
+  {
+    if (it->min_distance > distance)
+    {
+      ++it;
+      continue;
+    }
+    for (int i = it->node->begin; i < it->node->end; i++)
+    {
+      state->closest_distance = std::min(state->closest_distance, getDistance(i, state->position));
+    }
+    it = state->skipped.erase(it);
+  }
+  return is_above(state->closest_distance);
+}
+
+bool WaypointPath::hasWaypointFartherThan(const geometry_msgs::Point& position, double distance) const
+{
+  const int path_size = size();
+  if (levels_.empty())
+  {
+    for (int i = 0; i < path_size; i++)
+    {
+      if (getDistance(i, position) > distance)
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  if (getDistance(path_size - 1, position) > distance)
+  {
+    return true;
+  }
+  const int top = static_cast<int>(levels_.size()) - 1;
+  for (int node_idx = 0; node_idx < static_cast<int>(levels_[top].size()); node_idx++)
+  {
+    if (hasWaypointFartherThan(top, node_idx, position, distance))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool WaypointPath::hasWaypointFartherThan(
+  int level, int node_idx, const geometry_msgs::Point& position, double distance) const
+{
+  const Node& node = levels_[level][node_idx];
+  double node_distance = std::hypot(position.x - node.center_x, position.y - node.center_y);
+  if (node_distance - node.radius - DISTANCE_MARGIN > distance)
+  {
+    return true;
+  }
+  if (node_distance + node.radius + DISTANCE_MARGIN <= distance)
+  {
+    return false;
+  }
+
+  if (level > 0)
+  {
+    const int num_children = static_cast<int>(levels_[level - 1].size());
+    for (int child = node_idx * BRANCHING; child < std::min((node_idx + 1) * BRANCHING, num_children); child++)
+    {
+      if (hasWaypointFartherThan(level - 1, child, position, distance))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+  for (int i = node.begin - 1; i < node.end; i++)
+  {
+    if (getDistance(i, position) > distance)
+    {
+      return true;
+    }
+  }
+  return false;
+}
+}  // namespace waypoint_follower
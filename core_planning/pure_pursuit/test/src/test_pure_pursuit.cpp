@@ -17,6 +17,12 @@
 #include <ros/ros.h>
 #include <gtest/gtest.h>
 #include <pure_pursuit/pure_pursuit_core.h>
+#include <pure_pursuit/waypoint_path.h>
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
 
 namespace waypoint_follower
 {
@@ -211,6 +217,168 @@ TEST_F(PurePursuitNodeTestSuite, checkWaypointIsAheadOrBehind)
   ASSERT_NOT_NEAR_NEXT_WP_POSE_USING_CURR_POSE(7.95, 0, 7, 0); //  closest next waypoint is 5 (auto generated), not 4
 }
 
+// getNextWaypointNumber of PurePursuit before it searched a WaypointPath, scanning all waypoints
+int scanNextWaypointNumber(const std::vector<autoware_msgs::Waypoint>& waypoints, const geometry_msgs::Point& position,
+  double lookahead_distance, bool use_lookahead_distance)
+{
+  int path_size = static_cast<int>(waypoints.size());
+  if (path_size == 0)
+  {
+    return -1;
+  }
+  double closest_distance = getPlaneDistance(waypoints.at(0).pose.pose.position, position);
+  for (int i = 1; i < path_size; i++)
+  {
+    if (i == path_size - 1)
+    {
+      return i;
+    }
+    double current_distance = getPlaneDistance(waypoints.at(i).pose.pose.position, position);
+    if (use_lookahead_distance)
+    {
+      if (current_distance <= closest_distance)
+      {
+        closest_distance = current_distance;
+        continue;
+      }
+      if (current_distance < lookahead_distance)
+      {
+        continue;
+      }
+    }
+    else if (current_distance < closest_distance)
+    {
+      closest_distance = current_distance;
+      continue;
+    }
+    const geometry_msgs::Point& prev = waypoints.at(i - 1).pose.pose.position;
+    const geometry_msgs::Point& curr = waypoints.at(i).pose.pose.position;
+    tf::Vector3 curr_vector(prev.x - position.x, prev.y - position.y, prev.z - position.z);
+    curr_vector.setZ(0);
+    tf::Vector3 traj_vector(curr.x - prev.x, curr.y - prev.y, curr.z - prev.z);
+    traj_vector.setZ(0);
+    double angle_in_rad = std::fabs(tf::tfAngle(curr_vector, traj_vector));
+    if (std::isnan(angle_in_rad) || angle_in_rad > M_PI / 2)
+    {
+      continue;
+    }
+    return i - 1;
+  }
+  return -1;
+}
+
+// a winding path with curvature changes, reversals every 50 waypoints if reversing and repeated waypoints
+std::vector<autoware_msgs::Waypoint> generateWaypoints(std::mt19937* generator, int size, bool reversing)
+{
+  std::uniform_real_distribution<double> random(-1, 1);
+  std::vector<autoware_msgs::Waypoint> waypoints(size);
+  double x = 3000 + 100 * random(*generator), y = -12000 + 100 * random(*generator), yaw = 3 * random(*generator);
+  double curvature = 0;
+  for (int i = 0; i < size; i++)
+  {
+    waypoints[i].pose.pose.position.x = x;
+    waypoints[i].pose.pose.position.y = y;
+    waypoints[i].pose.pose.position.z = random(*generator);
+    double step = (i % 7 == 0) ? 0 : 1 + 0.2 * random(*generator);
+    if (i % 200 == 0)
+    {
+      curvature = random(*generator) * (reversing ? 0.3 : 0.05);
+    }
+    if (reversing && i % 50 == 0)
+    {
+      yaw += M_PI;
+    }
+    yaw += curvature * step;
+    x += step * std::cos(yaw);
+    y += step * std::sin(yaw);
+  }
+  return waypoints;
+}
+
+TEST(WaypointPathTestSuite, sameNextWaypointAsScan)
+{
+  std::mt19937 generator(42);
+  std::uniform_real_distribution<double> random(-1, 1);
+  WaypointPath path;
+  for (int trial = 0; trial < 400; trial++)
+  {
+    int size = trial < 40 ? trial : static_cast<int>(generator() % 3000) + 1;
+    std::vector<autoware_msgs::Waypoint> waypoints = generateWaypoints(&generator, size, trial % 2 == 1);
+    path.setWaypoints(waypoints);
+    ASSERT_EQ(path.size(), size);
+    for (int query = 0; query < 30; query++)
+    {
+      geometry_msgs::Point position;
+      if (size > 0)
+      {
+        position = waypoints[generator() % size].pose.pose.position;
+        double spread = (query % 3 == 0) ? 0 : (query % 3 == 1) ? 2 : 40;
+        position.x += spread * random(generator);
+        position.y += spread * random(generator);
+      }
+      double lookahead_distance = (query % 4 == 0) ? 0 : 30 * std::fabs(random(generator));
+      for (bool use_lookahead_distance : { true, false })
+      {
+        ASSERT_EQ(scanNextWaypointNumber(waypoints, position, lookahead_distance, use_lookahead_distance),
+          path.getNextWaypointNumber(position, lookahead_distance, use_lookahead_distance))
+          << "size " << size << ", query " << query;
+      }
+      bool farther = false;
+      for (const auto& waypoint : waypoints)
+      {
+        farther = farther || getPlaneDistance(waypoint.pose.pose.position, position) > lookahead_distance;
+      }
+      ASSERT_EQ(farther, path.hasWaypointFartherThan(position, lookahead_distance));
+    }
+  }
+}
+
+TEST(WaypointPathTestSuite, benchmarkNextWaypoint)
+{
+  for (int size : { 1000, 10000, 100000 })
+  {
+    // a gently curving road, the vehicle following it
+    std::vector<autoware_msgs::Waypoint> waypoints(size);
+    for (int i = 1; i < size; i++)
+    {
+      double yaw = 0.4 * std::sin(i / 300.0);
+      waypoints[i].pose.pose.position.x = waypoints[i - 1].pose.pose.position.x + std::cos(yaw);
+      waypoints[i].pose.pose.position.y = waypoints[i - 1].pose.pose.position.y + std::sin(yaw);
+    }
+    const int queries = 200;
+    std::vector<geometry_msgs::Point> positions;
+    for (int i = 0; i < queries; i++)
+    {
+      positions.push_back(waypoints[(static_cast<long>(size) * i) / queries].pose.pose.position);
+      positions.back().y += 0.3;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    WaypointPath path;
+    path.setWaypoints(waypoints);
+    auto built = std::chrono::steady_clock::now();
+    long sum = 0;
+    for (const auto& position : positions)
+    {
+      sum += path.getNextWaypointNumber(position, 10, true);
+    }
+    auto searched = std::chrono::steady_clock::now();
+    for (const auto& position : positions)
+    {
+      sum -= scanNextWaypointNumber(waypoints, position, 10, true);
+    }
+    auto scanned = std::chrono::steady_clock::now();
+    EXPECT_EQ(sum, 0);
+
+    auto micros = [](std::chrono::steady_clock::duration duration)
+    {
+      return std::chrono::duration<double, std::micro>(duration).count();
+    };
+    printf("%6d waypoints: build %8.1f us, search %6.2f us, scan %8.2f us per query\n", size, micros(built - start),
+      micros(searched - built) / queries, micros(scanned - searched) / queries);
+  }
+}
+
 }  // namespace waypoint_follower
 
 int main(int argc, char** argv)
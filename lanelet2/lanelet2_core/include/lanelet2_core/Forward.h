@@ -161,6 +161,10 @@ class BasicPolygonWithHoles2d;
 using BasicPolygonsWithHoles3d = std::vector<BasicPolygonWithHoles3d>;
 using BasicPolygonsWithHoles2d = std::vector<BasicPolygonWithHoles2d>;
 
+// LaneletMapLayers
+class LaneletMapLayers;
+using LaneletMapLayersConstPtr = std::shared_ptr<const LaneletMapLayers>;
+
 // LaneletMap
 class LaneletMap;
 using LaneletMapPtr = std::shared_ptr<LaneletMap>;
@@ -355,12 +355,29 @@ class LaneletMapLayers {
            lineStringLayer.size() + pointLayer.size();
   }
 
+  /**
+   * @brief Returns a number that changes whenever elements are added to or removed from this object
+   *
+   * Can be used to invalidate data derived from the map. Modifications of the elements themselves (e.g. of their
+   * attributes) are not tracked. The numbers are drawn from a counter shared by all maps, so a value is never reused
+   * after a modification.
+   */
+  size_t revision() const noexcept { return revision_; }
+
   LaneletLayer laneletLayer;                      //!< access to the lanelets within this map
   AreaLayer areaLayer;                            //!< access to areas
   RegulatoryElementLayer regulatoryElementLayer;  //!< access to regElems
   PolygonLayer polygonLayer;                      //!< access to the polygons
   LineStringLayer lineStringLayer;                //!< access to the lineStrings
   PointLayer pointLayer;                          //!< access to the points
+
+ protected:
+  //! Called by every function that modifies the layers
+  void touch() noexcept { revision_ = nextRevision(); }
+
+ private:
+  static size_t nextRevision() noexcept;
+  size_t revision_{nextRevision()};
 };
 
 /**
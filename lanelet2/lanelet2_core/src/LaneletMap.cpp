@@ -712,7 +712,13 @@ LaneletMapLayers::LaneletMapLayers(const LaneletLayer::Map& lanelets, const Area
       lineStringLayer(lineStrings),
       pointLayer(points) {}
 
+size_t LaneletMapLayers::nextRevision() noexcept {
+  static std::atomic<size_t> revision{0};
+  return ++revision;
+}
+
 void LaneletMap::add(Lanelet lanelet) {
+  touch();
   if (lanelet.id() == InvalId) {
     lanelet.setId(laneletLayer.uniqueId());
   } else if (laneletLayer.exists(lanelet.id())) {
@@ -740,6 +746,7 @@ void LaneletMap::add(Lanelet lanelet) {
 
 
 void LaneletMap::add(Area area) {
+  touch();
   if (area.id() == InvalId) {
     area.setId(areaLayer.uniqueId());
   } else if (areaLayer.exists(area.id())) {
@@ -770,6 +777,7 @@ void LaneletMap::add(Area area) {
 
 void LaneletMap::remove(Lanelet ll, const RegulatoryElementPtr& regElem)
 {
+  touch();
   if (ll.id() == InvalId) {
     throw InvalidInputError("Lanelet element with InvalId is passed to remove()!");
   }
@@ -817,6 +825,7 @@ void LaneletMap::remove(Lanelet ll, const RegulatoryElementPtr& regElem)
 
 void LaneletMap::remove(const RegulatoryElementPtr& regElem)
 {
+  touch();
   if (!regElem) 
   {
     throw NullptrError("Empty regulatory element passed to remove()!");
@@ -845,6 +854,7 @@ void LaneletMap::remove(const RegulatoryElementPtr& regElem)
 
 void LaneletMap::update(Lanelet ll, const RegulatoryElementPtr& regElem)
 {
+  touch();
   if (ll.id() == InvalId) {
     throw InvalidInputError("Lanelet element with InvalId is passed to update()!");
   }
@@ -879,6 +889,7 @@ void LaneletMap::update(Lanelet ll, const RegulatoryElementPtr& regElem)
 }
 
 void LaneletMap::add(const RegulatoryElementPtr& regElem) {
+  touch();
   if (!regElem) {
     throw NullptrError("Empty regulatory element passed to add()!");
   }
@@ -902,6 +913,7 @@ void LaneletMap::add(const RegulatoryElementPtr& regElem) {
 }
 
 void LaneletMap::add(Polygon3d polygon) {
+  touch();
   if (polygon.id() == InvalId) {
     polygon.setId(polygonLayer.uniqueId());
   } else if (polygonLayer.exists(polygon.id())) {
@@ -916,6 +928,7 @@ void LaneletMap::add(Polygon3d polygon) {
 }
 
 void LaneletMap::add(LineString3d lineString) {
+  touch();
   if (lineString.id() == InvalId) {
     lineString.setId(lineStringLayer.uniqueId());
   } else if (lineStringLayer.exists(lineString.id())) {
@@ -930,6 +943,7 @@ void LaneletMap::add(LineString3d lineString) {
 }
 
 void LaneletMap::add(Point3d point) {
+  touch();
   if (point.id() == InvalId) {
     point.setId(pointLayer.uniqueId());
   } else if (pointLayer.exists(point.id())) {
@@ -941,34 +955,40 @@ void LaneletMap::add(Point3d point) {
 }
 
 void LaneletSubmap::add(Lanelet lanelet) {
+  touch();
   checkId(lanelet);
   utils::forEach(lanelet.regulatoryElements(), [&](auto& regElem) { this->trackParameters(*regElem); });
   laneletLayer.add(lanelet);
 }
 
 void LaneletSubmap::add(Area area) {
+  touch();
   checkId(area);
   utils::forEach(area.regulatoryElements(), [&](auto& regElem) { this->trackParameters(*regElem); });
   areaLayer.add(area);
 }
 
 void LaneletSubmap::add(const RegulatoryElementPtr& regElem) {
+  touch();
   checkId(*regElem);
   trackParameters(*regElem);
   regulatoryElementLayer.add(regElem);
 }
 
 void LaneletSubmap::add(Polygon3d polygon) {
+  touch();
   checkId(polygon);
   polygonLayer.add(polygon);
 }
 
 void LaneletSubmap::add(LineString3d lineString) {
+  touch();
   checkId(lineString);
   lineStringLayer.add(lineString);
 }
 
 void LaneletSubmap::add(Point3d point) {
+  touch();
   checkId(point);
   pointLayer.add(point);
 }
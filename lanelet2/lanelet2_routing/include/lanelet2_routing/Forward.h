@@ -17,6 +17,7 @@ class Graph;
 
 class RoutingGraphGraph;
 class RouteGraph;
+class DijkstraSearchStatePool;
 }  // namespace internal
 
 using LaneId = uint16_t;
@@ -223,6 +223,19 @@ class RoutingGraph {
   ConstLanelets reachableSet(const ConstLanelet& lanelet, double maxRoutingCost, RoutingCostId routingCostId = {},
                              bool allowLaneChanges = true) const;
 
+  /** @brief Retrieves the reachable sets of many lanelets at once
+   *
+   *  Gives the same results as calling RoutingGraph::reachableSet for every lanelet, but the search is set up only
+   * once for all of them.
+   *  @param lanelets Start lanelets
+   *  @param maxRoutingCost Maximum amount of routing cost allowed to reach other lanelets
+   *  @param routingCostId ID of the routing cost module used for routing cost.
+   *  @param allowLaneChanges Allow or forbid lane changes
+   *  @return the reachable set of each lanelet, in the order of "lanelets". Empty for lanelets that are not part of
+   * the graph. */
+  std::vector<ConstLanelets> reachableSets(const ConstLanelets& lanelets, double maxRoutingCost,
+                                           RoutingCostId routingCostId = {}, bool allowLaneChanges = true) const;
+
   //! Retrieve set of lanelet or areas that are reachable without exceeding routing cost.
   ConstLaneletOrAreas reachableSetIncludingAreas(const ConstLaneletOrArea& llOrAr, double maxRoutingCost,
                                                  RoutingCostId routingCostId = {}) const;
@@ -286,6 +299,23 @@ class RoutingGraph {
   LaneletPaths possiblePathsTowards(const ConstLanelet& targetLanelet, uint32_t minLanelets,
                                     bool allowLaneChanges = false, RoutingCostId routingCostId = {}) const;
 
+  /** @brief Determines the possible paths from many start lanelets at once
+   *
+   *  Gives the same results as calling RoutingGraph::possiblePaths for every start lanelet, but the search is set up
+   * only once for all of them.
+   *  @return the possible paths of each start lanelet, in the order of "startPoints". Empty for lanelets that are not
+   * part of the graph.
+   *  @param startPoints Start lanelets
+   *  @param minRoutingCost Costs that must be reached by a route.
+   *  @param routingCostId ID of the routing cost module used
+   *  @param allowLaneChanges Allow or forbid lane changes */
+  std::vector<LaneletPaths> possiblePathSets(const ConstLanelets& startPoints, double minRoutingCost,
+                                             RoutingCostId routingCostId = {}, bool allowLaneChanges = false) const;
+
+  //! Similar to RoutingGraph::possiblePathSets, but for paths that are "minLanelets"-long.
+  std::vector<LaneletPaths> possiblePathSets(const ConstLanelets& startPoints, uint32_t minLanelets,
+                                             bool allowLaneChanges = false, RoutingCostId routingCostId = {}) const;
+
   //! Similar to RoutingGraph::possiblePaths, but also considers areas.
   LaneletOrAreaPaths possiblePathsIncludingAreas(const ConstLaneletOrArea& startPoint, double minRoutingCost,
                                                  RoutingCostId routingCostId = {}, bool allowLaneChanges = false) const;
@@ -391,8 +421,9 @@ class RoutingGraph {
 
  private:
   //! Documentation to be found in the cpp file.
-  std::unique_ptr<internal::RoutingGraphGraph> graph_;  ///< Wrapper of the routing graph
-  LaneletSubmapConstPtr passableLaneletSubmap_;         ///< Lanelet map of all passable lanelets
+  std::unique_ptr<internal::RoutingGraphGraph> graph_;               ///< Wrapper of the routing graph
+  LaneletSubmapConstPtr passableLaneletSubmap_;                      ///< Lanelet map of all passable lanelets
+  std::unique_ptr<internal::DijkstraSearchStatePool> searchStates_;  ///< States reused by the graph searches
 };
 
 }  // namespace routing
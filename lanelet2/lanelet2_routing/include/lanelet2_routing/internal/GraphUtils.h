@@ -15,7 +15,7 @@ template <typename ContainerT, typename T>
 inline bool has(const ContainerT& c, const T& t) {
   return std::find(c.begin(), c.end(), t) != c.end();
 }
-template <typename ContainerT, typename T>
+template <typename T>
 inline bool has(const std::set<T>& c, const T& t) {
   return c.find(t) != c.end();
 }
@@ -1,7 +1,12 @@
 #pragma once
-#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
-#include <boost/graph/filtered_graph.hpp>
-#include <boost/property_map/property_map.hpp>
+#include <boost/graph/graph_traits.hpp>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 #include "Exceptions.h"
 #include "Graph.h"
 #include "GraphUtils.h"
@@ -20,117 +25,301 @@ struct VertexVisitInformation {
 };
 
 struct VertexState {
-  RoutingGraphGraph::Vertex predecessor{};  //!< The vertex this refers to
-  double cost{};                            //!< Current accumulated cost
-  size_t length{};                          //!< Number of vertices to this vertex (including this one)
-  size_t numLaneChanges{};                  //!< Required lane changes along the shortest path in order to get here
-  bool predicate{true};                     //!< False if disabled by predicate
-  bool isLeaf{true};                        //!< True if it has no successor that is on the shortest path
+  RoutingGraphGraph::Vertex predecessor{};                //!< The vertex this refers to
+  double cost{std::numeric_limits<double>::infinity()};  //!< Current accumulated cost, infinity if not discovered
+  size_t length{};                                        //!< Number of vertices to this vertex (including this one)
+  size_t numLaneChanges{};  //!< Required lane changes along the shortest path in order to get here
+  bool predicate{true};     //!< False if disabled by predicate
+  bool isLeaf{true};        //!< True if it has no successor that is on the shortest path
 };
 
-template <typename VertexT>
-using DijkstraSearchMap = std::map<VertexT, VertexState>;
+template <typename G>
+class DijkstraStyleSearch;
 
-template <typename VertexT>
-struct DijkstraCostMap {
-  using key_type = VertexT;                             // NOLINT
-  using value_type = double;                            // NOLINT
-  using reference = void;                               // NOLINT
-  using category = boost::read_write_property_map_tag;  // NOLINT
-  DijkstraSearchMap<VertexT>* map{};
-};
+/** @brief The state of a DijkstraStyleSearch for every vertex of the graph, stored flat and indexed by the vertex.
+ *
+ *  Only the vertices discovered by a query are reset before the next one, so one state can serve any number of queries
+ *  on graphs with the same vertices without allocating or initializing per vertex state again. */
+class DijkstraSearchState {
+ public:
+  using Vertex = RoutingGraphGraph::Vertex;
+
+  DijkstraSearchState() = default;
+  explicit DijkstraSearchState(size_t numVertices) { reset(numVertices); }
 
-template <typename VertexT>
-inline typename DijkstraCostMap<VertexT>::value_type get(const DijkstraCostMap<VertexT>& map, VertexT key) {
-  auto val = map.map->find(key);
-  if (val != map.map->end()) {
-    return val->second.cost;
+  //! Forgets the last query and makes room for a graph with numVertices vertices
+  void reset(size_t numVertices) {
+    for (auto v : discovered_) {
+      vertices_[v] = VertexState{};
+    }
+    discovered_.clear();
+    heap_.clear();
+    if (vertices_.size() < numVertices) {
+      vertices_.resize(numVertices);
+      indexInHeap_.resize(numVertices);
+      tree_.resize(numVertices);
+    }
   }
-  return std::numeric_limits<double>::infinity();
-}
 
-template <typename VertexT>
-inline void put(DijkstraCostMap<VertexT>& map, VertexT key, typename DijkstraCostMap<VertexT>::value_type value) {
-  (*map.map)[key].cost = value;
-}
+  const VertexState& operator[](Vertex v) const { return vertices_[v]; }
 
-template <typename G>
-class DijkstraStyleSearch {
- public:
-  using VertexType = typename boost::graph_traits<G>::vertex_descriptor;
-  using EdgeType = typename boost::graph_traits<G>::edge_descriptor;
-  using DijkstraSearchMapType = DijkstraSearchMap<VertexType>;
-  using VisitCallback = std::function<bool(const VertexVisitInformation&)>;
+  //! The vertices discovered by the last query in the order they were discovered, starting with the start vertex
+  const std::vector<Vertex>& discovered() const { return discovered_; }
 
  private:
-  class LeafFilter {
-   public:
-    LeafFilter() = default;
-    LeafFilter(const DijkstraSearchMapType& m, const G& g) : m_{&m}, g_{&g} {}
-    bool operator()(EdgeType e) const { return (*m_).at(boost::source(e, *g_)).predicate; }
-
-   private:
-    const DijkstraSearchMapType* m_{};
-    const G* g_{};
+  template <typename G>
+  friend class DijkstraStyleSearch;
+
+  static constexpr Vertex NoVertex = std::numeric_limits<Vertex>::max();
+  static constexpr size_t NoPath = std::numeric_limits<size_t>::max();
+
+  //! Links the vertices on the paths to their predecessor, see DijkstraStyleSearch::forEachPath
+  struct TreeNode {
+    Vertex firstChild{NoVertex};
+    Vertex nextSibling{NoVertex};
+    size_t pathIndex{NoPath};  //!< Index of the path ending at this vertex
+    bool onPath{false};
   };
-  using SearchGraph = boost::filtered_graph<G, LeafFilter>;
 
-  template <typename Func>
-  class DijkstraStyleVisitor : public boost::default_dijkstra_visitor {
-    using FuncT = std::remove_reference_t<Func>;
-
-   public:
-    DijkstraStyleVisitor() = default;
-    DijkstraStyleVisitor(DijkstraSearchMapType& map, FuncT* cb) : map_{&map}, cb_{cb} {}
-
-    // called whenever a minimal edge is discovered
-    void examine_vertex(VertexType v, const SearchGraph& /*g*/) {  // NOLINT
-      auto& state = map_->at(v);
-      state.predicate =
-          ((*cb_)(VertexVisitInformation{v, state.predecessor, state.cost, state.length, state.numLaneChanges}));
-      map_->at(state.predecessor).isLeaf = v == state.predecessor;  // necessary for the initial vertex
+  // The priority queue is the 4-ary heap boost::dijkstra_shortest_paths uses (boost/graph/detail/d_ary_heap.hpp),
+  // vertices of equal cost leave it in the same order, so the search ends up with the same predecessors.
+  static constexpr size_t Arity = 4;
+
+  void push(Vertex v) {
+    heap_.push_back(v);
+    moveUp(heap_.size() - 1);
+  }
+
+  Vertex pop() {
+    Vertex top = heap_.front();
+    heap_.front() = heap_.back();
+    heap_.pop_back();
+    if (!heap_.empty()) {
+      indexInHeap_[heap_.front()] = 0;
+      moveDown();
     }
+    return top;
+  }
+
+  //! Restores the order after the cost of v decreased
+  void update(Vertex v) { moveUp(indexInHeap_[v]); }
 
-    void edge_relaxed(EdgeType e, const SearchGraph& g) {  // NOLINT
-      // called whenever a shorter path to e is discovered and before "examine vertex" is called
-      // cost is automatically updated by the dijkstra algorithm
-      auto& predecessor = (*map_).at(boost::source(e, g));
-      auto& follower = (*map_)[boost::target(e, g)];
-      follower.length = predecessor.length + 1;
-      follower.predecessor = boost::source(e, g);
-      follower.numLaneChanges = predecessor.numLaneChanges + (g[e].relation != RelationType::Successor);
+  void moveUp(size_t index) {
+    Vertex moved = heap_[index];
+    double cost = vertices_[moved].cost;
+    while (index > 0) {
+      size_t parent = (index - 1) / Arity;
+      if (!(cost < vertices_[heap_[parent]].cost)) {
+        break;
+      }
+      heap_[index] = heap_[parent];
+      indexInHeap_[heap_[index]] = index;
+      index = parent;
     }
+    heap_[index] = moved;
+    indexInHeap_[moved] = index;
+  }
+
+  void moveDown() {
+    size_t index = 0;
+    Vertex moved = heap_[0];
+    double cost = vertices_[moved].cost;
+    while (true) {
+      size_t firstChild = index * Arity + 1;
+      if (firstChild >= heap_.size()) {
+        break;
+      }
+      size_t smallest = firstChild;
+      double smallestCost = vertices_[heap_[firstChild]].cost;
+      for (size_t child = firstChild + 1; child < std::min(firstChild + Arity, heap_.size()); ++child) {
+        if (vertices_[heap_[child]].cost < smallestCost) {
+          smallest = child;
+          smallestCost = vertices_[heap_[child]].cost;
+        }
+      }
+      if (!(smallestCost < cost)) {
+        break;
+      }
+      std::swap(heap_[index], heap_[smallest]);
+      indexInHeap_[heap_[index]] = index;
+      indexInHeap_[heap_[smallest]] = smallest;
+      index = smallest;
+    }
+  }
+
+  std::vector<VertexState> vertices_;
+  std::vector<size_t> indexInHeap_;
+  std::vector<TreeNode> tree_;
+  std::vector<Vertex> discovered_;
+  std::vector<Vertex> heap_;
+  std::vector<Vertex> ends_;
+};
 
-   private:
-    DijkstraSearchMapType* map_{};
-    FuncT* cb_{};
+/** @brief Hands out the states for the searches on one graph and takes them back once a search is done.
+ *
+ *  Repeated queries on the graph this way neither allocate nor initialize their state. Every concurrent or nested
+ *  search gets a state of its own. */
+class DijkstraSearchStatePool {
+  struct Release {
+    DijkstraSearchStatePool* pool;
+    void operator()(DijkstraSearchState* state) const { pool->release(state); }
   };
 
  public:
-  //! Constructor for the graph search
-  explicit DijkstraStyleSearch(const G& graph) : graph_{graph, LeafFilter{vertices_, graph}} {}
+  using StatePtr = std::unique_ptr<DijkstraSearchState, Release>;
+
+  explicit DijkstraSearchStatePool(size_t numVertices) : numVertices_{numVertices} {}
+
+  StatePtr acquire() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (states_.empty()) {
+      lock.unlock();
+      return StatePtr{new DijkstraSearchState(numVertices_), Release{this}};
+    }
+    StatePtr state{states_.back().release(), Release{this}};
+    states_.pop_back();
+    return state;
+  }
+
+ private:
+  void release(DijkstraSearchState* state) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    states_.emplace_back(state);
+  }
+
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<DijkstraSearchState>> states_;
+  size_t numVertices_;
+};
+
+template <typename G>
+class DijkstraStyleSearch {
+ public:
+  using VertexType = typename boost::graph_traits<G>::vertex_descriptor;
+  using EdgeType = typename boost::graph_traits<G>::edge_descriptor;
+  using VisitCallback = std::function<bool(const VertexVisitInformation&)>;
+
+  //! Constructor for the graph search. The state is kept between queries.
+  explicit DijkstraStyleSearch(const G& graph)
+      : graph_{graph}, ownState_{std::make_unique<DijkstraSearchState>()}, state_{ownState_.get()} {}
+
+  //! Constructor for a graph search that works on a given state, e.g. one from a DijkstraSearchStatePool. The state
+  //! must outlive the search.
+  DijkstraStyleSearch(const G& graph, DijkstraSearchState& state) : graph_{graph}, state_{&state} {}
 
   //! Performs the dijkstra style search by calling func whenever the shortest path for a certain vertex is
   //! discovered. Whenever func returns false, the successor edges of this vertex will not be visited.
   template <typename Func>
   void query(VertexType start, Func&& func) {
-    vertices_.clear();
-    vertices_.emplace(start, VertexState{start, 0., 1, 0, true, true});
-    DijkstraStyleVisitor<decltype(func)> visitor{vertices_, &func};
-    auto inf = std::numeric_limits<double>::infinity();
-    // offering sane defaults seems to have been impossible...
-    boost::dijkstra_shortest_paths_no_color_map_no_init(
-        graph_, start, boost::dummy_property_map{}, DijkstraCostMap<VertexType>{&vertices_},
-        boost::get(&EdgeInfo::routingCost, graph_), boost::get(boost::vertex_index, graph_), std::less<double>{},
-        boost::closed_plus<double>{}, inf, 0., visitor);
+    auto& s = *state_;
+    s.reset(boost::num_vertices(graph_));
+    s.vertices_[start] = VertexState{start, 0., 1, 0, true, true};
+    s.discovered_.push_back(start);
+    s.push(start);
+    while (!s.heap_.empty()) {
+      auto vertex = s.pop();
+      auto& state = s.vertices_[vertex];
+      state.predicate = func(VertexVisitInformation{vertex, state.predecessor, state.cost, state.length,
+                                                    state.numLaneChanges});
+      s.vertices_[state.predecessor].isLeaf = vertex == state.predecessor;  // necessary for the initial vertex
+      if (!state.predicate) {
+        continue;
+      }
+      for (auto edges = boost::out_edges(vertex, graph_); edges.first != edges.second; ++edges.first) {
+        auto follower = boost::target(*edges.first, graph_);
+        auto& followerState = s.vertices_[follower];
+        const auto& edge = graph_[*edges.first];
+        double cost = state.cost + edge.routingCost;
+        if (!(cost < followerState.cost)) {
+          continue;
+        }
+        bool discovered = followerState.cost < std::numeric_limits<double>::infinity();
+        followerState.cost = cost;
+        followerState.predecessor = vertex;
+        followerState.length = state.length + 1;
+        followerState.numLaneChanges = state.numLaneChanges + (edge.relation != RelationType::Successor);
+        if (discovered) {
+          s.update(follower);
+        } else {
+          s.discovered_.push_back(follower);
+          s.push(follower);
+        }
+      }
+    }
+  }
+
+  /** @brief Calls func(index, path) with the path from the start to every vertex of the last query for which isEnd
+   *  returns true.
+   *
+   *  The tree of shortest paths is walked once, depth first, so the path to each vertex is the current prefix of the
+   *  walk and paths sharing a prefix don't walk it again. transform converts each vertex into the elements of the path
+   *  once. The index is the position of the end vertex among all end vertices in ascending order.
+   *  @param isEnd function taking the VertexState, true if a path ends at this vertex
+   *  @param transform function taking a vertex and returning the element of the path
+   *  @param func called with the index and the path as std::vector of the transformed vertices
+   *  @return number of paths */
+  template <typename IsEnd, typename Transform, typename Func>
+  size_t forEachPath(IsEnd&& isEnd, Transform&& transform, Func&& func) {
+    auto& s = *state_;
+    s.ends_.clear();
+    for (auto v : s.discovered_) {
+      s.tree_[v] = DijkstraSearchState::TreeNode{};
+      if (isEnd(s.vertices_[v])) {
+        s.ends_.push_back(v);
+      }
+    }
+    if (s.ends_.empty()) {
+      return 0;
+    }
+    std::sort(s.ends_.begin(), s.ends_.end());
+    for (size_t i = 0; i < s.ends_.size(); ++i) {
+      auto v = s.ends_[i];
+      s.tree_[v].pathIndex = i;
+      while (!s.tree_[v].onPath) {
+        s.tree_[v].onPath = true;
+        auto predecessor = s.vertices_[v].predecessor;
+        if (predecessor == v) {
+          break;
+        }
+        s.tree_[v].nextSibling = s.tree_[predecessor].firstChild;
+        s.tree_[predecessor].firstChild = v;
+        v = predecessor;
+      }
+    }
+
+    const auto root = s.discovered_.front();
+    auto v = root;
+    std::vector<std::decay_t<decltype(transform(v))>> path{transform(v)};
+    while (true) {
+      const auto& node = s.tree_[v];
+      if (node.pathIndex != DijkstraSearchState::NoPath) {
+        func(node.pathIndex, path);
+      }
+      if (node.firstChild != DijkstraSearchState::NoVertex) {
+        v = node.firstChild;
+        path.push_back(transform(v));
+        continue;
+      }
+      while (v != root && s.tree_[v].nextSibling == DijkstraSearchState::NoVertex) {
+        v = s.vertices_[v].predecessor;
+        path.pop_back();
+      }
+      if (v == root) {
+        break;
+      }
+      v = s.tree_[v].nextSibling;
+      path.back() = transform(v);
+    }
+    return s.ends_.size();
   }
 
   //! Returns the result
-  const DijkstraSearchMapType& getMap() const { return vertices_; }
+  const DijkstraSearchState& getState() const { return *state_; }
 
  private:
-  SearchGraph graph_;
-  DijkstraSearchMapType vertices_;
+  const G& graph_;
+  std::unique_ptr<DijkstraSearchState> ownState_;
+  DijkstraSearchState* state_;
 };
 
 }  // namespace internal
@@ -17,56 +17,92 @@ struct VisitationCount {
 };
 
 //! Explicit representation into which the implicit filtered_graph from boost is parsed. Contains functionality to add
-//! or delete vertices.
+//! or delete vertices. The graph only grows while the route grows: vertices keep the counters of the full graph between
+//! iterations and every iteration deletes vertices from a copy of them.
 class VisitedLaneletGraph {
-  using VisitedCounters = std::map<NextToRouteGraph::vertex_descriptor, Optional<VisitationCount>>;
+  struct Counters {
+    VisitationCount full;               //!< counters of all edges discovered so far
+    Optional<VisitationCount> current;  //!< counters of this iteration, empty if the vertex was removed
+    size_t iteration{};                 //!< iteration in which the vertex was discovered
+  };
+  using VisitedCounters = std::map<LaneletVertexId, Counters>;
 
  public:
-  using VisitedVertex = VisitedCounters::value_type;
-
   explicit VisitedLaneletGraph(const RouteLanelets& llts) : routeLanelets_{&llts} {}
 
+  //! To be called before the graph is extended by a new iteration
+  void nextIteration() { ++iteration_; }
+
   //! To be called on each new vertex once it is discovered
   void init(LaneletVertexId v) {
-    assert(!visited_[v]);
-    visited_[v] = VisitationCount{};
+    assert(visited_.find(v) == visited_.end());
+    visited_[v].iteration = iteration_;
   }
 
+  //! Returns whether the vertex was discovered in an iteration before the current one
+  bool isDiscoveredBefore(LaneletVertexId v) const {
+    auto iter = visited_.find(v);
+    return iter != visited_.end() && iter->second.iteration < iteration_;
+  }
+
+  //! Returns whether the vertex was discovered
+  bool isDiscovered(LaneletVertexId v) const { return visited_.find(v) != visited_.end(); }
+
   //! Adds an edge
-  void add(LaneletVertexId v, NextToRouteGraph::edge_descriptor e, const NextToRouteGraph& g) {
+  template <typename GraphT>
+  void add(LaneletVertexId v, GraphTraits::edge_descriptor e, const GraphT& g) {
     auto type = g[e].relation;
-    assert(!!visited_[v] && "init() should make sure vertex is valid!");
+    auto iter = visited_.find(v);
+    assert(iter != visited_.end() && "init() should make sure vertex is valid!");
     if (type == RelationType::Left || type == RelationType::Right) {
       auto dest = boost::target(e, g);
       if (routeLanelets_->find(dest) != routeLanelets_->end()) {
-        visited_[v]->numLaneChangesOut++;
+        iter->second.full.numLaneChangesOut++;
       }
     } else if (type == RelationType::Successor) {
-      visited_[v]->numFollowers++;
+      iter->second.full.numFollowers++;
     } else {
       assert(false && "This is not possible if the edge filter did his job!");
     }
   }
 
-  //! Prunes all leafs if this graph except for the lanelet llt
-  void pruneLeafsExcluding(LaneletVertexId llt, const NextToRouteGraph& g) {
-    bool progress = true;
-    while (progress) {
-      progress = false;
-      for (auto& vertex : visited_) {
-        if (vertex.first == llt || !vertex.second || !vertex.second->isLeaf()) {
-          continue;
-        }
-        progress = true;
-        remove(vertex, g);
+  //! Adds the lane changes of the discovered vertices to a lanelet that has just become part of the route
+  void addLaneChangesTo(LaneletVertexId v, const OriginalGraph& g) {
+    auto inEdges = boost::in_edges(v, g);
+    std::for_each(inEdges.first, inEdges.second, [&](OriginalGraph::edge_descriptor e) {
+      auto type = g[e].relation;
+      auto vertex = visited_.find(boost::source(e, g));
+      if ((type == RelationType::Left || type == RelationType::Right) && vertex != visited_.end()) {
+        vertex->second.full.numLaneChangesOut++;
       }
+    });
+  }
+
+  //! Restores all vertices and the counters of the full graph
+  void restore() {
+    for (auto& vertex : visited_) {
+      vertex.second.current = vertex.second.full;
     }
   }
 
-  //! Clears the graph
-  void clear() {
+  //! Prunes all leafs if this graph except for the lanelet llt
+  void pruneLeafsExcluding(LaneletVertexId llt, const OriginalGraph& g) {
+    // the vertices left after repeatedly removing leafs do not depend on the order of removal, so every vertex that
+    // becomes a leaf is removed once instead of sweeping over the graph until nothing changes
+    std::vector<LaneletVertexId> leafs;
     for (auto& vertex : visited_) {
-      vertex.second.reset();
+      if (vertex.first != llt && !!vertex.second.current && vertex.second.current->isLeaf()) {
+        leafs.push_back(vertex.first);
+      }
+    }
+    while (!leafs.empty()) {
+      auto leaf = leafs.back();
+      leafs.pop_back();
+      remove(*visited_.find(leaf), g, [&](LaneletVertexId newLeaf) {
+        if (newLeaf != llt) {
+          leafs.push_back(newLeaf);
+        }
+      });
     }
   }
 
@@ -74,41 +110,49 @@ class VisitedLaneletGraph {
   template <typename Func>
   void forAllValidLanelets(Func&& f) const {
     for (auto& vertex : visited_) {
-      if (!!vertex.second && !vertex.second->isLeaf()) {
-        f(vertex);
+      if (!!vertex.second.current && !vertex.second.current->isLeaf()) {
+        f(vertex.first);
       }
     }
   }
 
   //! Remove a vertex from the graph
-  void remove(LaneletVertexId v, const NextToRouteGraph& g) {
+  void remove(LaneletVertexId v, const OriginalGraph& g) {
     auto iter = visited_.find(v);
     assert(iter != visited_.end());
-    remove(*iter, g);
+    remove(*iter, g, [](LaneletVertexId /*newLeaf*/) {});
   }
 
  private:
-  void remove(VisitedCounters::value_type& v, const NextToRouteGraph& g) {
-    v.second.reset();
+  template <typename Func>
+  void remove(VisitedCounters::value_type& v, const OriginalGraph& g, Func&& onNewLeaf) {
+    // discovered vertices are all next to the route, so the in edges need not be filtered by the NextToRouteFilter
+    v.second.current.reset();
     auto inEdges = boost::in_edges(v.first, g);
-    std::for_each(inEdges.first, inEdges.second, [&](NextToRouteGraph::edge_descriptor e) {
+    std::for_each(inEdges.first, inEdges.second, [&](OriginalGraph::edge_descriptor e) {
       auto relation = g[e].relation;
       if ((relation & (RelationType::Successor | RelationType::Left | RelationType::Right)) == RelationType::None) {
         return;
       }
       auto vertex = visited_.find(boost::source(e, g));
-      if (vertex == visited_.end() || !vertex->second) {
+      if (vertex == visited_.end() || !vertex->second.current) {
         return;
       }
-      if (relation == RelationType::Successor && vertex->second->numFollowers > 0) {
-        vertex->second->numFollowers--;
-      } else if (vertex->second->numLaneChangesOut > 0) {  // implies left or right
-        vertex->second->numLaneChangesOut--;
+      auto& count = *vertex->second.current;
+      const bool wasLeaf = count.isLeaf();
+      if (relation == RelationType::Successor && count.numFollowers > 0) {
+        count.numFollowers--;
+      } else if (count.numLaneChangesOut > 0) {  // implies left or right
+        count.numLaneChangesOut--;
+      }
+      if (!wasLeaf && count.isLeaf()) {
+        onNewLeaf(vertex->first);
       }
     });
   }
   VisitedCounters visited_;
   const RouteLanelets* routeLanelets_{};
+  size_t iteration_{};
 };
 
 //! The visited lanelet graph initially also contains lanelets that are always conflicting with the route, but the route
@@ -134,9 +178,9 @@ class PathsOutOfRouteFinder {
   void forEachVertexOutOfRoute(const VisitedLaneletGraph& visited, Func&& f) {
     newConflictingVertices_.clear();
     permittedVertices_.clear();
-    visited.forAllValidLanelets([&](const VisitedLaneletGraph::VisitedVertex& v) {
-      if (conflictsWithRoute_(v.first)) {
-        newConflictingVertices_.push_back(v.first);
+    visited.forAllValidLanelets([&](LaneletVertexId v) {
+      if (conflictsWithRoute_(v)) {
+        newConflictingVertices_.push_back(v);
       }
     });
     permittedVertices_.resize(newConflictingVertices_.size(), false);
@@ -213,11 +257,21 @@ class PathsOutOfRouteFinder {
 //! Adaptor for boost graph. It is used to build the VisitedLaneletGraph.
 class NeighbouringGraphVisitor : public boost::default_bfs_visitor {
  public:
-  explicit NeighbouringGraphVisitor(VisitedLaneletGraph& counter) : counter_{&counter} {}
+  NeighbouringGraphVisitor(VisitedLaneletGraph& counter, const OriginalGraph& originalGraph)
+      : counter_{&counter}, originalGraph_{&originalGraph} {}
   // called by boost graph on a new vertex
   void examine_vertex(LaneletVertexId v, const NextToRouteGraph& /*g*/) {  // NOLINT
     counter_->init(v);
     vCurr_ = v;
+
+    // vertices of earlier iterations did not see this vertex when their edges were examined
+    auto inEdges = boost::in_edges(v, *originalGraph_);
+    std::for_each(inEdges.first, inEdges.second, [&](OriginalGraph::edge_descriptor e) {
+      auto source = boost::source(e, *originalGraph_);
+      if (OnlyDrivableEdgesFilter{*originalGraph_}(e) && counter_->isDiscoveredBefore(source)) {
+        counter_->add(source, e, *originalGraph_);
+      }
+    });
   }
 
   // called directly after an all its edges
@@ -229,14 +283,47 @@ class NeighbouringGraphVisitor : public boost::default_bfs_visitor {
  private:
   LaneletVertexId vCurr_{};
   VisitedLaneletGraph* counter_;
+  const OriginalGraph* originalGraph_;
+};
+
+//! The lane ids issued while constructing the route. Lanes that turn out to be the same lane are merged with
+//! union-find, instead of relabeling all vertices of the route on every merge.
+class LaneIds {
+ public:
+  //! Issues the id of a new lane
+  LaneId newLane() {
+    parents_.push_back(LaneId(FirstLaneId + parents_.size()));
+    return parents_.back();
+  }
+
+  //! Returns the id of the lane that the lane was merged into, or its own if it was not merged
+  LaneId find(LaneId laneId) {
+    auto root = laneId;
+    while (parent(root) != root) {
+      root = parent(root);
+    }
+    while (laneId != root) {
+      auto next = parent(laneId);
+      parent(laneId) = root;
+      laneId = next;
+    }
+    return root;
+  }
+
+  //! Merges a lane into another one. Both get the id of the other one.
+  void merge(LaneId from, LaneId to) { parent(find(from)) = find(to); }
+
+ private:
+  LaneId& parent(LaneId laneId) { return parents_[LaneId(laneId - FirstLaneId)]; }
+  static constexpr LaneId FirstLaneId{1000};
+  std::vector<LaneId> parents_;
 };
 
 //! A visitor that constructs the final route object by searching though the graph of lanelets on the route.
 class RouteConstructionVisitor : public boost::default_bfs_visitor {
  public:
-  RouteConstructionVisitor() = default;
-  RouteConstructionVisitor(const OriginalGraph& graph, RouteGraph& routeGraph)
-      : graph_{&graph}, routeGraph_{&routeGraph} {}
+  RouteConstructionVisitor(const OriginalGraph& graph, RouteGraph& routeGraph, LaneIds& laneIds)
+      : conflictInMap_{graph, OnlyConflictingFilter{graph}}, routeGraph_{&routeGraph}, laneIds_{&laneIds} {}
 
   //! called by boost graph on a new vertex
   void examine_vertex(LaneletVertexId v, const OnRouteGraph& g) {  // NOLINT
@@ -244,7 +331,7 @@ class RouteConstructionVisitor : public boost::default_bfs_visitor {
     if (routeGraph_->empty()) {
       // first time
 
-      sourceElem_ = routeGraph_->addVertex(RouteVertexInfo{llt, laneId_, {}});
+      sourceElem_ = routeGraph_->addVertex(RouteVertexInfo{llt, laneIds_->newLane(), {}});
     } else {
       sourceElem_ = *routeGraph_->getVertex(llt);
     }
@@ -258,20 +345,19 @@ class RouteConstructionVisitor : public boost::default_bfs_visitor {
     const auto newLane = isDifferentLane(e, g);
     auto type = g[e].relation;
     if (!destVertex) {
-      const auto laneId = newLane ? ++laneId_ : routeGraph()[sourceElem_].laneId;
+      const auto laneId = newLane ? laneIds_->newLane() : routeGraph()[sourceElem_].laneId;
       destVertex = routeGraph_->addVertex(RouteVertexInfo{llt, laneId, {}});
     } else if (!!destVertex && !newLane && type == RelationType::Successor &&
-               routeGraph()[sourceElem_].laneId != routeGraph()[*destVertex].laneId) {
+               laneIds_->find(routeGraph()[sourceElem_].laneId) != laneIds_->find(routeGraph()[*destVertex].laneId)) {
       // this happens if we reached a lanelet because it was part of a circle of reached through a conflicting lanelet.
       // In this case we have to adjust lane Ids
-      setLaneIdFromTo(routeGraph()[*destVertex].laneId, routeGraph()[sourceElem_].laneId);
+      laneIds_->merge(routeGraph()[*destVertex].laneId, routeGraph()[sourceElem_].laneId);
     }
     routeGraph_->addEdge(sourceElem_, *destVertex, g[e]);
   }
   void finish_vertex(LaneletVertexId v, const OnRouteGraph& g) {  // NOLINT
     // now that all neighbours are known, now is the time to add lanelets that conflict in the whole graph
-    OnlyConflictingGraph conflictInMap(*graph_, OnlyConflictingFilter{*graph_});
-    auto outGraph = boost::out_edges(v, conflictInMap);
+    auto outGraph = boost::out_edges(v, conflictInMap_);
     std::for_each(outGraph.first, outGraph.second, [&](GraphTraits::edge_descriptor e) {
       routeGraph()[sourceElem_].conflictingInMap.push_back(g[boost::target(e, g)].laneletOrArea);
     });
@@ -279,14 +365,6 @@ class RouteConstructionVisitor : public boost::default_bfs_visitor {
 
  private:
   RouteGraphType& routeGraph() { return routeGraph_->get(); }
-  void setLaneIdFromTo(LaneId from, LaneId to) {
-    auto& g = routeGraph_->get();
-    for (auto elem : g.vertex_set()) {
-      if (g[elem].laneId == from) {
-        g[elem].laneId = to;
-      }
-    }
-  }
 
   bool isDifferentLane(OnRouteGraph::edge_descriptor e, const OnRouteGraph& g) const {
     // we increment the lane id whenever the vertex has more than one predecessor or the singele predecessor has
@@ -322,9 +400,9 @@ class RouteConstructionVisitor : public boost::default_bfs_visitor {
     return hasOneEdge;
   }
 
-  const OriginalGraph* graph_{};
-  LaneId laneId_{1000};
+  OnlyConflictingGraph conflictInMap_;
   RouteGraph* routeGraph_{};
+  LaneIds* laneIds_{};
   LaneletVertexId sourceElem_{};
 };
 
@@ -336,7 +414,8 @@ void breadthFirstSearch(const Graph& g, StartVertex v, Visitor vis) {
 }
 
 //! This is the class that handles building the route. It iteratively adds lanelets initial route (i.e. the shortest
-//! path) that fulfill the definition of a lanelet on the route. This is done until convergence is reached.
+//! path) that fulfill the definition of a lanelet on the route. This is done until convergence is reached. The graph of
+//! lanelets next to the route is only extended by the lanelets that became adjacent in the previous iteration.
 class RouteUnderConstruction {
  public:
   RouteUnderConstruction(const std::vector<LaneletVertexId>& initialRoute, const OriginalGraph& originalGraph)
@@ -348,45 +427,86 @@ class RouteUnderConstruction {
         nextToRouteGraph_{originalGraph_, OnlyDrivableEdgesFilter{originalGraph_},
                           NextToRouteFilter{laneletsOnRoute_, originalGraph_}},
         laneletVisitor_{laneletsOnRoute_},
-        pathOutOfRouteFinder_{originalGraph_, laneletsOnRoute_} {}
+        pathOutOfRouteFinder_{originalGraph_, laneletsOnRoute_},
+        frontier_{begin_} {}
 
   //! Adds neighbours of the current route to the route if they fulfill the criteria. Returns true if something was
   //! added.
   bool addAdjacentLaneletsToRoute() {
-    laneletVisitor_.clear();
-
-    // query the (implicit) boost graph of adjacent lanelets into the nextToRouteGraph_
-    breadthFirstSearch(nextToRouteGraph_, begin_, NeighbouringGraphVisitor{laneletVisitor_});
+    laneletVisitor_.nextIteration();
+
+    // query the (implicit) boost graph of adjacent lanelets into the nextToRouteGraph_, starting from the frontier
+    // since the vertices found by earlier iterations keep their colors
+    for (auto v : frontier_) {
+      if (get(discovered_, v) == boost::two_bit_white) {
+        boost::queue<LaneletVertexId> q;
+        boost::breadth_first_visit(nextToRouteGraph_, v, q, NeighbouringGraphVisitor{laneletVisitor_, originalGraph_},
+                                   discovered_);
+      }
+    }
+    laneletVisitor_.restore();
 
     // remove lanelets that do not lead to end_ from the graph
-    laneletVisitor_.pruneLeafsExcluding(end_, nextToRouteGraph_);
+    laneletVisitor_.pruneLeafsExcluding(end_, originalGraph_);
 
     // remove lanelets that (temporarily) leave the route from the graph
     pathOutOfRouteFinder_.forEachVertexOutOfRoute(
-        laneletVisitor_, [&](auto& vertex) { laneletVisitor_.remove(vertex, nextToRouteGraph_); });
+        laneletVisitor_, [&](auto& vertex) { laneletVisitor_.remove(vertex, originalGraph_); });
 
     // add the new vertices to the laneletsOnTheRoute_ and determine if we made progress.
-    bool progress = false;
-    laneletVisitor_.forAllValidLanelets([&](auto lltId) { progress |= laneletsOnRoute_.insert(lltId.first).second; });
-    return progress;
+    LaneletVertexIds added;
+    laneletVisitor_.forAllValidLanelets([&](auto lltId) {
+      if (laneletsOnRoute_.insert(lltId).second) {
+        added.push_back(lltId);
+      }
+    });
+    updateFrontier(added);
+    return !added.empty();
   }
 
   //! Creates the route object from the current state of the route.
   Optional<Route> finalizeRoute(const OriginalGraph& theGraph, const LaneletPath& thePath) {
     auto routeGraph = std::make_unique<RouteGraph>(1);
     // Search the graph of the route. The visitor fills elements and lanebegins
-    RouteConstructionVisitor visitor(theGraph, *routeGraph);
+    LaneIds laneIds;
+    RouteConstructionVisitor visitor(theGraph, *routeGraph, laneIds);
     breadthFirstSearch(routeGraph_, begin_, visitor);
 
     if (!routeGraph->getVertex(thePath.back())) {
       return {};  // there was no path between begin and end
     }
     auto& g = routeGraph->get();
+    for (auto v : g.vertex_set()) {
+      g[v].laneId = laneIds.find(g[v].laneId);
+    }
     auto map = utils::createConstSubmap(utils::transform(g.vertex_set(), [&g](auto v) { return g[v].lanelet; }), {});
     return Route(thePath, std::move(routeGraph), std::move(map));
   }
 
  private:
+  //! Lanelets with an edge to the new route lanelets are now next to the route. The ones that can be driven to from
+  //! the discovered lanelets are where the next iteration continues.
+  void updateFrontier(const LaneletVertexIds& added) {
+    frontier_.clear();
+    auto isReachable = [&](LaneletVertexId v) {
+      auto inEdges = boost::in_edges(v, originalGraph_);
+      return std::any_of(inEdges.first, inEdges.second, [&](OriginalGraph::edge_descriptor e) {
+        return OnlyDrivableEdgesFilter{originalGraph_}(e) &&
+               laneletVisitor_.isDiscovered(boost::source(e, originalGraph_));
+      });
+    };
+    for (auto v : added) {
+      laneletVisitor_.addLaneChangesTo(v, originalGraph_);
+      auto inEdges = boost::in_edges(v, originalGraph_);
+      std::for_each(inEdges.first, inEdges.second, [&](OriginalGraph::edge_descriptor e) {
+        auto source = boost::source(e, originalGraph_);
+        if (!laneletVisitor_.isDiscovered(source) && isReachable(source)) {
+          frontier_.push_back(source);
+        }
+      });
+    }
+  }
+
   LaneletVertexId begin_;
   LaneletVertexId end_;
   RouteLanelets laneletsOnRoute_;  //! Lanelets already determined to be on the route
@@ -395,6 +515,8 @@ class RouteUnderConstruction {
   NextToRouteGraph nextToRouteGraph_;
   VisitedLaneletGraph laneletVisitor_;
   PathsOutOfRouteFinder pathOutOfRouteFinder_;
+  LaneletVertexIds frontier_;  //! Lanelets from which the graph of adjacent lanelets is extended
+  SparseColorMap discovered_;  //! Colors of the lanelets discovered in the graph of adjacent lanelets
 };
 }  // namespace
 
@@ -410,9 +532,6 @@ Optional<Route> RouteBuilder::getRouteFromShortestPath(const LaneletPath& path,
   // get the container for all the things
   RouteUnderConstruction routeUnderConstruction{vertexIds, originalGraph};
 
-  //! @todo deleteme
-  auto ids = utils::transform(graph_.get().m_vertices, [&](auto& v) { return v.m_property.laneletOrArea.id(); });
-
   bool progress = true;
   while (progress) {
     progress = routeUnderConstruction.addAdjacentLaneletsToRoute();
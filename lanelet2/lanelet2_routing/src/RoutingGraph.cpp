@@ -32,11 +32,12 @@ constexpr const char RoutingGraph::ParticipantHeight[];
 #endif
 
 namespace {
-using internal::DijkstraSearchMap;
+using internal::DijkstraSearchState;
 using internal::DijkstraStyleSearch;
 using internal::FilteredRoutingGraph;
 using internal::GraphType;
 using internal::LaneletVertexId;
+using internal::LaneletVertexIds;
 using internal::RoutingGraphGraph;
 using internal::VertexVisitInformation;
 
@@ -205,8 +206,8 @@ struct GetGraph<false> {
 };
 
 template <bool Backw, typename OutVertexT, typename GraphT>
-std::vector<OutVertexT> buildPath(const DijkstraSearchMap<LaneletVertexId>& map, LaneletVertexId vertex, GraphT g) {
-  auto* currInfo = &map.at(vertex);
+std::vector<OutVertexT> buildPath(const DijkstraSearchState& state, LaneletVertexId vertex, GraphT g) {
+  auto* currInfo = &state[vertex];
   auto size = currInfo->length;
   std::vector<OutVertexT> path(size);
   while (true) {
@@ -216,42 +217,48 @@ std::vector<OutVertexT> buildPath(const DijkstraSearchMap<LaneletVertexId>& map,
       break;
     }
     vertex = currInfo->predecessor;
-    currInfo = &map.at(vertex);
+    currInfo = &state[vertex];
   }
   return path;
 }
 
-template <bool Backw, typename OutVertexT, typename OutContainerT, typename Func>
-std::vector<OutContainerT> possiblePathsImpl(const GraphType::vertex_descriptor& start,
-                                             const FilteredRoutingGraph& graph, Func stopCriterion) {
+//! Runs func on a search of the graph (backwards if Backw) that works on the given state
+template <bool Backw, typename Func>
+auto withSearch(const FilteredRoutingGraph& graph, DijkstraSearchState& state, Func&& func) {
   auto g = GetGraph<Backw>{}(graph);
-  DijkstraStyleSearch<decltype(g)> search(g);
+  DijkstraStyleSearch<decltype(g)> search(g, state);
+  return func(search);
+}
+
+template <bool Backw, typename OutVertexT, typename OutContainerT, typename SearchT, typename Func>
+std::vector<OutContainerT> possiblePathsImpl(SearchT& search, const GraphType::vertex_descriptor& start,
+                                             const FilteredRoutingGraph& graph, Func stopCriterion) {
   search.query(start, stopCriterion);
-  auto keepPath = [&](auto& vertex) { return vertex.second.isLeaf && !vertex.second.predicate; };
-  auto numPaths = size_t(std::count_if(search.getMap().begin(), search.getMap().end(), keepPath));
-  std::vector<OutContainerT> result;
-  result.reserve(numPaths);
-  for (auto& vertex : search.getMap()) {
-    if (!keepPath(vertex)) {
-      continue;
-    }
-    result.emplace_back(buildPath<Backw, OutVertexT>(search.getMap(), vertex.first, graph));
-  }
+  auto keepPath = [](const internal::VertexState& state) { return state.isLeaf && !state.predicate; };
+  const auto& discovered = search.getState().discovered();
+  auto numPaths = size_t(std::count_if(discovered.begin(), discovered.end(),
+                                       [&](auto vertex) { return keepPath(search.getState()[vertex]); }));
+  std::vector<OutContainerT> result(numPaths);
+  search.forEachPath(keepPath, [&](auto vertex) { return static_cast<OutVertexT>(graph[vertex].laneletOrArea); },
+                     [&](size_t idx, const std::vector<OutVertexT>& path) {
+                       result[idx] = OutContainerT{Backw ? std::vector<OutVertexT>(path.rbegin(), path.rend()) : path};
+                     });
   return result;
 }
 
-template <bool Backw, typename OutVertexT, typename Func>
-std::vector<OutVertexT> reachableSetImpl(const GraphType::vertex_descriptor& start, const FilteredRoutingGraph& graph,
-                                         Func stopCriterion) {
-  auto g = GetGraph<Backw>{}(graph);
-  DijkstraStyleSearch<decltype(g)> search(g);
+template <typename OutVertexT, typename SearchT, typename Func>
+std::vector<OutVertexT> reachableSetImpl(SearchT& search, const GraphType::vertex_descriptor& start,
+                                         const FilteredRoutingGraph& graph, Func stopCriterion) {
   search.query(start, stopCriterion);
+  const auto& state = search.getState();
+  auto reached = reservedVector<LaneletVertexIds>(state.discovered().size());
+  std::copy_if(state.discovered().begin(), state.discovered().end(), std::back_inserter(reached),
+               [&](auto vertex) { return state[vertex].predicate; });
+  std::sort(reached.begin(), reached.end());
   std::vector<OutVertexT> result;
-  result.reserve(search.getMap().size());
-  for (auto& vertex : search.getMap()) {
-    if (vertex.second.predicate) {
-      result.emplace_back(static_cast<OutVertexT>(graph[vertex.first].laneletOrArea));
-    }
+  result.reserve(reached.size());
+  for (auto vertex : reached) {
+    result.emplace_back(static_cast<OutVertexT>(graph[vertex].laneletOrArea));
   }
   return result;
 }
@@ -274,6 +281,22 @@ struct StopIfCostMoreThan {
   }
   double c;
 };
+
+template <typename Func>
+std::vector<LaneletPaths> possiblePathSetsImpl(const ConstLanelets& startPoints, const RoutingGraphGraph& routingGraph,
+                                               const FilteredRoutingGraph& graph, DijkstraSearchState& state,
+                                               Func stopCriterion) {
+  return withSearch<false>(graph, state, [&](auto& search) {
+    auto result = reservedVector<std::vector<LaneletPaths>>(startPoints.size());
+    for (auto& startPoint : startPoints) {
+      auto start = routingGraph.getVertex(startPoint);
+      result.emplace_back(start ? possiblePathsImpl<false, ConstLanelet, LaneletPath>(search, *start, graph,
+                                                                                      stopCriterion)
+                                : LaneletPaths{});
+    }
+    return result;
+  });
+}
 }  // namespace
 
 RoutingGraph::RoutingGraph(RoutingGraph&& /*other*/) noexcept = default;
@@ -317,7 +340,8 @@ Optional<LaneletPath> RoutingGraph::shortestPath(const ConstLanelet& from, const
     return {};
   }
   auto graph = withLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  DijkstraStyleSearch<FilteredRoutingGraph> search(graph);
+  auto state = searchStates_->acquire();
+  DijkstraStyleSearch<FilteredRoutingGraph> search(graph, *state);
   class DestinationReached {};
   try {
     search.query(*startVertex, [endVertex](const internal::VertexVisitInformation& i) {
@@ -327,7 +351,7 @@ Optional<LaneletPath> RoutingGraph::shortestPath(const ConstLanelet& from, const
       return true;
     });
   } catch (DestinationReached) {
-    return LaneletPath{buildPath<false, ConstLanelet>(search.getMap(), *endVertex, graph)};
+    return LaneletPath{buildPath<false, ConstLanelet>(search.getState(), *endVertex, graph)};
   }
   return {};
 }
@@ -493,7 +517,24 @@ ConstLanelets RoutingGraph::reachableSet(const ConstLanelet& lanelet, double max
     return {};
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  return reachableSetImpl<false, ConstLanelet>(*start, graph, StopIfCostMoreThan<true>{maxRoutingCost});
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return reachableSetImpl<ConstLanelet>(search, *start, graph, StopIfCostMoreThan<true>{maxRoutingCost});
+  });
+}
+
+std::vector<ConstLanelets> RoutingGraph::reachableSets(const ConstLanelets& lanelets, double maxRoutingCost,
+                                                      RoutingCostId routingCostId, bool allowLaneChanges) const {
+  auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    auto result = reservedVector<std::vector<ConstLanelets>>(lanelets.size());
+    for (auto& lanelet : lanelets) {
+      auto start = graph_->getVertex(lanelet);
+      result.emplace_back(start ? reachableSetImpl<ConstLanelet>(search, *start, graph,
+                                                                 StopIfCostMoreThan<true>{maxRoutingCost})
+                                : ConstLanelets{});
+    }
+    return result;
+  });
 }
 
 ConstLaneletOrAreas RoutingGraph::reachableSetIncludingAreas(const ConstLaneletOrArea& llOrAr, double maxRoutingCost,
@@ -503,7 +544,9 @@ ConstLaneletOrAreas RoutingGraph::reachableSetIncludingAreas(const ConstLaneletO
     return {};
   }
   auto graph = graph_->withAreasAndLaneChanges(routingCostId);
-  return reachableSetImpl<false, ConstLaneletOrArea>(*start, graph, StopIfCostMoreThan<true>{maxRoutingCost});
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return reachableSetImpl<ConstLaneletOrArea>(search, *start, graph, StopIfCostMoreThan<true>{maxRoutingCost});
+  });
 }
 
 ConstLanelets RoutingGraph::reachableSetTowards(const ConstLanelet& lanelet, double maxRoutingCost,
@@ -513,7 +556,9 @@ ConstLanelets RoutingGraph::reachableSetTowards(const ConstLanelet& lanelet, dou
     return {};
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  return reachableSetImpl<true, ConstLanelet>(*start, graph, StopIfCostMoreThan<true>{maxRoutingCost});
+  return withSearch<true>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return reachableSetImpl<ConstLanelet>(search, *start, graph, StopIfCostMoreThan<true>{maxRoutingCost});
+  });
 }
 
 LaneletPaths RoutingGraph::possiblePaths(const ConstLanelet& startPoint, double minRoutingCost,
@@ -523,7 +568,10 @@ LaneletPaths RoutingGraph::possiblePaths(const ConstLanelet& startPoint, double
     return {};
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  return possiblePathsImpl<false, ConstLanelet, LaneletPath>(*start, graph, StopIfCostMoreThan<>{minRoutingCost});
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return possiblePathsImpl<false, ConstLanelet, LaneletPath>(search, *start, graph,
+                                                               StopIfCostMoreThan<>{minRoutingCost});
+  });
 }
 
 LaneletPaths RoutingGraph::possiblePaths(const ConstLanelet& startPoint, uint32_t minLanelets, bool allowLaneChanges,
@@ -533,7 +581,10 @@ LaneletPaths RoutingGraph::possiblePaths(const ConstLanelet& startPoint, uint32_
     return {};
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  return possiblePathsImpl<false, ConstLanelet, LaneletPath>(*start, graph, StopIfLaneletsMoreThan<>{minLanelets});
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return possiblePathsImpl<false, ConstLanelet, LaneletPath>(search, *start, graph,
+                                                               StopIfLaneletsMoreThan<>{minLanelets});
+  });
 }
 
 LaneletPaths RoutingGraph::possiblePathsTowards(const ConstLanelet& targetLanelet, double minRoutingCost,
@@ -543,7 +594,10 @@ LaneletPaths RoutingGraph::possiblePathsTowards(const ConstLanelet& targetLanele
     return {};
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  return possiblePathsImpl<true, ConstLanelet, LaneletPath>(*start, graph, StopIfCostMoreThan<>{minRoutingCost});
+  return withSearch<true>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return possiblePathsImpl<true, ConstLanelet, LaneletPath>(search, *start, graph,
+                                                              StopIfCostMoreThan<>{minRoutingCost});
+  });
 }
 
 LaneletPaths RoutingGraph::possiblePathsTowards(const ConstLanelet& targetLanelet, uint32_t minLanelets,
@@ -553,7 +607,24 @@ LaneletPaths RoutingGraph::possiblePathsTowards(const ConstLanelet& targetLanele
     return {};
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  return possiblePathsImpl<true, ConstLanelet, LaneletPath>(*start, graph, StopIfLaneletsMoreThan<>{minLanelets});
+  return withSearch<true>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return possiblePathsImpl<true, ConstLanelet, LaneletPath>(search, *start, graph,
+                                                              StopIfLaneletsMoreThan<>{minLanelets});
+  });
+}
+
+std::vector<LaneletPaths> RoutingGraph::possiblePathSets(const ConstLanelets& startPoints, double minRoutingCost,
+                                                       RoutingCostId routingCostId, bool allowLaneChanges) const {
+  auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
+  return possiblePathSetsImpl(startPoints, *graph_, graph, *searchStates_->acquire(),
+                              StopIfCostMoreThan<>{minRoutingCost});
+}
+
+std::vector<LaneletPaths> RoutingGraph::possiblePathSets(const ConstLanelets& startPoints, uint32_t minLanelets,
+                                                       bool allowLaneChanges, RoutingCostId routingCostId) const {
+  auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
+  return possiblePathSetsImpl(startPoints, *graph_, graph, *searchStates_->acquire(),
+                              StopIfLaneletsMoreThan<>{minLanelets});
 }
 
 LaneletOrAreaPaths RoutingGraph::possiblePathsIncludingAreas(const ConstLaneletOrArea& startPoint,
@@ -565,8 +636,10 @@ LaneletOrAreaPaths RoutingGraph::possiblePathsIncludingAreas(const ConstLaneletO
   }
   auto graph = allowLaneChanges ? graph_->withAreasAndLaneChanges(routingCostId)
                                 : graph_->withAreasWithoutLaneChanges(routingCostId);
-  return possiblePathsImpl<false, ConstLaneletOrArea, LaneletOrAreaPath>(*start, graph,
-                                                                         StopIfCostMoreThan<>{minRoutingCost});
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return possiblePathsImpl<false, ConstLaneletOrArea, LaneletOrAreaPath>(search, *start, graph,
+                                                                           StopIfCostMoreThan<>{minRoutingCost});
+  });
 }
 
 LaneletOrAreaPaths RoutingGraph::possiblePathsIncludingAreas(const ConstLaneletOrArea& startPoint, uint32_t minElements,
@@ -577,8 +650,10 @@ LaneletOrAreaPaths RoutingGraph::possiblePathsIncludingAreas(const ConstLaneletO
   }
   auto graph = allowLaneChanges ? graph_->withAreasAndLaneChanges(routingCostId)
                                 : graph_->withAreasWithoutLaneChanges(routingCostId);
-  return possiblePathsImpl<false, ConstLaneletOrArea, LaneletOrAreaPath>(*start, graph,
-                                                                         StopIfLaneletsMoreThan<>{minElements});
+  return withSearch<false>(graph, *searchStates_->acquire(), [&](auto& search) {
+    return possiblePathsImpl<false, ConstLaneletOrArea, LaneletOrAreaPath>(search, *start, graph,
+                                                                           StopIfLaneletsMoreThan<>{minElements});
+  });
 }
 
 void RoutingGraph::forEachSuccessor(const ConstLanelet& lanelet, const LaneletVisitFunction& f, bool allowLaneChanges,
@@ -588,7 +663,8 @@ void RoutingGraph::forEachSuccessor(const ConstLanelet& lanelet, const LaneletVi
     return;
   }
   auto graph = allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
-  DijkstraStyleSearch<FilteredRoutingGraph> search(graph);
+  auto state = searchStates_->acquire();
+  DijkstraStyleSearch<FilteredRoutingGraph> search(graph, *state);
   search.query(*start, [&](const VertexVisitInformation& i) -> bool {
     return f(LaneletVisitInformation{graph_->get()[i.vertex].lanelet(), graph_->get()[i.predecessor].lanelet(), i.cost,
                                      i.length, i.numLaneChanges});
@@ -604,7 +680,8 @@ void RoutingGraph::forEachSuccessorIncludingAreas(const ConstLaneletOrArea& lane
   }
   auto graph = allowLaneChanges ? graph_->withAreasAndLaneChanges(routingCostId)
                                 : graph_->withAreasWithoutLaneChanges(routingCostId);
-  DijkstraStyleSearch<FilteredRoutingGraph> search(graph);
+  auto state = searchStates_->acquire();
+  DijkstraStyleSearch<FilteredRoutingGraph> search(graph, *state);
   search.query(*start, [&](const VertexVisitInformation& i) -> bool {
     return f(LaneletOrAreaVisitInformation{graph_->get()[i.vertex].laneletOrArea,
                                            graph_->get()[i.predecessor].laneletOrArea, i.cost, i.length,
@@ -621,7 +698,8 @@ void RoutingGraph::forEachPredecessor(const ConstLanelet& lanelet, const Lanelet
   auto forwGraph =
       allowLaneChanges ? graph_->withLaneChanges(routingCostId) : graph_->withoutLaneChanges(routingCostId);
   auto graph = boost::make_reverse_graph(forwGraph);  // forwGraph needs to stay on the stack
-  internal::DijkstraStyleSearch<decltype(graph)> search(graph);
+  auto state = searchStates_->acquire();
+  internal::DijkstraStyleSearch<decltype(graph)> search(graph, *state);
   search.query(*start, [&](const VertexVisitInformation& i) -> bool {
     return f(LaneletVisitInformation{graph_->get()[i.vertex].lanelet(), graph_->get()[i.predecessor].lanelet(), i.cost,
                                      i.length, i.numLaneChanges});
@@ -638,7 +716,8 @@ void RoutingGraph::forEachPredecessorIncludingAreas(const ConstLaneletOrArea& la
   auto forwGraph = allowLaneChanges ? graph_->withAreasAndLaneChanges(routingCostId)
                                     : graph_->withAreasWithoutLaneChanges(routingCostId);
   auto graph = boost::make_reverse_graph(forwGraph);  // forwGraph needs to stay on the stack
-  internal::DijkstraStyleSearch<decltype(graph)> search(graph);
+  auto state = searchStates_->acquire();
+  internal::DijkstraStyleSearch<decltype(graph)> search(graph, *state);
   search.query(*start, [&](const VertexVisitInformation& i) -> bool {
     return f(LaneletOrAreaVisitInformation{graph_->get()[i.vertex].laneletOrArea,
                                            graph_->get()[i.predecessor].laneletOrArea, i.cost, i.length,
@@ -864,7 +943,9 @@ RoutingGraph::Errors RoutingGraph::checkValidity(bool throwOnError) const {
 }
 
 RoutingGraph::RoutingGraph(std::unique_ptr<RoutingGraphGraph>&& graph, LaneletSubmapConstPtr&& passableMap)
-    : graph_{std::move(graph)}, passableLaneletSubmap_{std::move(passableMap)} {}
+    : graph_{std::move(graph)},
+      passableLaneletSubmap_{std::move(passableMap)},
+      searchStates_{std::make_unique<internal::DijkstraSearchStatePool>(boost::num_vertices(graph_->get()))} {}
 
 }  // namespace routing
 }  // namespace lanelet
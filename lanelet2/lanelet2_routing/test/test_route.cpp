@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <chrono>
 #include "Route.h"
 #include "RoutingGraph.h"
 #include "test_routing_map.h"
@@ -402,3 +403,75 @@ TEST_F(RouteCircularNoLc, Circularity) {  // NOLINT
   EXPECT_EQ(route.remainingLane(lanelets.at(2067)).size(), 7ul);
 }
 
+
+namespace {
+/** A straight highway of numLanes lanes that is numLanelets lanelets long. The lanes are separated by dashed lines so
+ *  that lane changes are possible everywhere. */
+LaneletMapPtr buildHighway(int numLanes, int numLanelets) {
+  Id id{1000};
+  std::vector<Points3d> points(size_t(numLanes + 1));
+  for (auto i = 0; i <= numLanes; ++i) {
+    for (auto j = 0; j <= numLanelets; ++j) {
+      points[size_t(i)].push_back(Point3d(id++, 10. * j, 3.5 * i, 0.));
+    }
+  }
+  Lanelets lanelets;
+  for (auto j = 0; j < numLanelets; ++j) {
+    LineStrings3d bounds;
+    for (auto i = 0; i <= numLanes; ++i) {
+      LineString3d ls{id++, {points[size_t(i)][size_t(j)], points[size_t(i)][size_t(j + 1)]}};
+      ls.setAttribute(AttributeName::Type, AttributeValueString::LineThin);
+      ls.setAttribute(AttributeName::Subtype, i == 0 || i == numLanes ? AttributeValueString::Solid
+                                                                       : AttributeValueString::Dashed);
+      bounds.push_back(ls);
+    }
+    for (auto i = 0; i < numLanes; ++i) {
+      Lanelet ll{id++, bounds[size_t(i + 1)], bounds[size_t(i)]};
+      ll.setAttribute(AttributeName::Subtype, AttributeValueString::Road);
+      lanelets.push_back(ll);
+    }
+  }
+  return utils::createMap(lanelets);
+}
+
+//! The lanelet of the given lane and position of a highway built by buildHighway
+ConstLanelet highwayLanelet(const LaneletMap& map, int numLanes, int numLanelets, int lane, int position) {
+  const Id firstLanelet = 1000 + (numLanes + 1) * (numLanelets + 1) + numLanes + 1;
+  return map.laneletLayer.get(firstLanelet + position * (2 * numLanes + 1) + lane);
+}
+
+RoutingGraphUPtr buildHighwayGraph(const LaneletMap& map) {
+  auto trafficRules = traffic_rules::TrafficRulesFactory::create(Locations::Germany, Participants::Vehicle);
+  return RoutingGraph::build(map, *trafficRules, {std::make_shared<RoutingCostDistance>(2.)});
+}
+}  // namespace
+
+TEST(RouteHighway, create) {  // NOLINT
+  const int numLanes = 4;
+  const int numLanelets = 50;
+  auto map = buildHighway(numLanes, numLanelets);
+  auto graph = buildHighwayGraph(*map);
+  auto route = graph->getRoute(highwayLanelet(*map, numLanes, numLanelets, 0, 0),
+                               highwayLanelet(*map, numLanes, numLanelets, numLanes - 1, numLanelets - 1));
+  ASSERT_TRUE(!!route);
+  EXPECT_EQ(route->size(), size_t(numLanes * numLanelets));
+  EXPECT_EQ(route->numLanes(), size_t(numLanes));
+  EXPECT_EQ(route->fullLane(highwayLanelet(*map, numLanes, numLanelets, 1, 20)).size(), size_t(numLanelets));
+}
+
+TEST(RouteHighway, benchmark) {  // NOLINT
+  using Clock = std::chrono::steady_clock;
+  const int numLanes = 6;
+  for (auto numLanelets : {250, 500, 1000, 2000}) {
+    auto map = buildHighway(numLanes, numLanelets);
+    auto graph = buildHighwayGraph(*map);
+    auto start = Clock::now();
+    auto route = graph->getRoute(highwayLanelet(*map, numLanes, numLanelets, 0, 0),
+                                 highwayLanelet(*map, numLanes, numLanelets, numLanes - 1, numLanelets - 1));
+    double routeTime = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+    ASSERT_TRUE(!!route);
+    EXPECT_EQ(route->size(), size_t(numLanes * numLanelets));
+    std::cout << "[ route    ] " << numLanes << " lanes x " << numLanelets << " lanelets, getRoute " << routeTime
+              << " ms\n";
+  }
+}
@@ -56,10 +56,10 @@ TEST(DijkstraSearch, onSimpleGraph) {
     EXPECT_EQ(v.length, v.numLaneChanges + 1);
     return v.vertex != 4;
   });
-  EXPECT_EQ(searcher.getMap().size(), boost::num_vertices(g));
-  for (auto& v : searcher.getMap()) {
-    EXPECT_EQ(v.second.predicate, v.first != 4) << v.first;
-    EXPECT_EQ(v.second.isLeaf, v.first == 5 || v.first == 4) << v.first;
+  EXPECT_EQ(searcher.getState().discovered().size(), boost::num_vertices(g));
+  for (auto v : searcher.getState().discovered()) {
+    EXPECT_EQ(searcher.getState()[v].predicate, v != 4) << v;
+    EXPECT_EQ(searcher.getState()[v].isLeaf, v == 5 || v == 4) << v;
   }
 }
 
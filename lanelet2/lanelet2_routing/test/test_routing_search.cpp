@@ -0,0 +1,382 @@
+#include <gtest/gtest.h>
+#include <lanelet2_core/LaneletMap.h>
+#include <lanelet2_traffic_rules/TrafficRulesFactory.h>
+#include <array>
+#include <boost/graph/dijkstra_shortest_paths_no_color_map.hpp>
+#include <boost/graph/reverse_graph.hpp>
+#include <chrono>
+#include <map>
+#include "RoutingGraph.h"
+#include "internal/Graph.h"
+#include "internal/ShortestPath.h"
+
+using namespace lanelet;
+using namespace lanelet::routing;
+using namespace lanelet::routing::internal;
+
+namespace {
+/** A city of blocks x blocks square blocks. Every street has two lanes per direction, separated by a dashed line. At
+ *  the intersections both lanes continue straight on, the left lane can turn left and the right lane can turn right. */
+LaneletMapPtr buildGridCity(int blocks, double blockLength = 100.) {
+  const double laneWidth = 3.5;
+  const double margin = 10.;  // distance of the lanes to the center of the intersection
+  const std::array<BasicPoint2d, 4> headings{BasicPoint2d{1, 0}, BasicPoint2d{0, 1}, BasicPoint2d{-1, 0},
+                                             BasicPoint2d{0, -1}};
+  Id id{1000};
+  auto line = [&id](const Point3d& from, const Point3d& to, const char* subtype) {
+    LineString3d ls{id++, {from, to}};
+    ls.setAttribute(AttributeName::Type, AttributeValueString::LineThin);
+    ls.setAttribute(AttributeName::Subtype, subtype);
+    return ls;
+  };
+  Lanelets lanelets;
+  auto addLanelet = [&](const LineString3d& left, const LineString3d& right) {
+    Lanelet ll{id++, left, right};
+    ll.setAttribute(AttributeName::Subtype, AttributeValueString::Road);
+    lanelets.push_back(ll);
+  };
+
+  // start/end points (left and right) of both lanes of each street, by the node it leaves/enters and its heading
+  using LaneEnds = std::array<std::pair<Point3d, Point3d>, 2>;
+  std::map<std::array<int, 3>, LaneEnds> outgoing;
+  std::map<std::array<int, 3>, LaneEnds> incoming;
+  for (int x = 0; x <= blocks; ++x) {
+    for (int y = 0; y <= blocks; ++y) {
+      for (int h = 0; h < 4; ++h) {
+        const BasicPoint2d& d = headings[size_t(h)];
+        int toX = x + int(d.x());
+        int toY = y + int(d.y());
+        if (toX < 0 || toY < 0 || toX > blocks || toY > blocks) {
+          continue;
+        }
+        BasicPoint2d from{x * blockLength, y * blockLength};
+        BasicPoint2d normal{-d.y(), d.x()};
+        LineStrings3d bounds;
+        for (int offset = 0; offset < 3; ++offset) {
+          BasicPoint2d start = from + d * margin - normal * (offset * laneWidth + 0.5);
+          BasicPoint2d end = from + d * (blockLength - margin) - normal * (offset * laneWidth + 0.5);
+          const Id startId = id++;
+          const Id endId = id++;
+          bounds.push_back(line(Point3d(startId, start.x(), start.y(), 0), Point3d(endId, end.x(), end.y(), 0),
+                                offset == 1 ? AttributeValueString::Dashed : AttributeValueString::Solid));
+        }
+        LaneEnds& out = outgoing[{x, y, h}];
+        LaneEnds& in = incoming[{toX, toY, h}];
+        for (size_t lane = 0; lane < 2; ++lane) {
+          addLanelet(bounds[lane], bounds[lane + 1]);
+          out[lane] = {bounds[lane].front(), bounds[lane + 1].front()};
+          in[lane] = {bounds[lane].back(), bounds[lane + 1].back()};
+        }
+      }
+    }
+  }
+
+  auto connect = [&](const std::pair<Point3d, Point3d>& from, const std::pair<Point3d, Point3d>& to) {
+    addLanelet(line(from.first, to.first, AttributeValueString::Dashed),
+               line(from.second, to.second, AttributeValueString::Dashed));
+  };
+  for (auto& arrival : incoming) {
+    int x = arrival.first[0];
+    int y = arrival.first[1];
+    int h = arrival.first[2];
+    auto straight = outgoing.find({x, y, h});
+    if (straight != outgoing.end()) {
+      connect(arrival.second[0], straight->second[0]);
+      connect(arrival.second[1], straight->second[1]);
+    }
+    auto left = outgoing.find({x, y, (h + 1) % 4});
+    if (left != outgoing.end()) {
+      connect(arrival.second[0], left->second[0]);
+    }
+    auto right = outgoing.find({x, y, (h + 3) % 4});
+    if (right != outgoing.end()) {
+      connect(arrival.second[1], right->second[1]);
+    }
+  }
+  return utils::createMap(lanelets);
+}
+
+RoutingGraphUPtr buildGridCityGraph(const LaneletMap& map) {
+  auto trafficRules = traffic_rules::TrafficRulesFactory::create(Locations::Germany, Participants::Vehicle);
+  return RoutingGraph::build(map, *trafficRules, {std::make_shared<RoutingCostDistance>(2.)});
+}
+
+//! The streets of a grid city as a plain graph, every vertex is linked to its four neighbours with equal costs
+GraphType buildGridGraph(size_t size) {
+  GraphType g(size * size);
+  auto addEdge = [&](size_t from, size_t to, RelationType relation) {
+    auto e = boost::add_edge(from, to, g);
+    g[e.first] = EdgeInfo{100., 0, relation};
+  };
+  for (size_t x = 0; x < size; ++x) {
+    for (size_t y = 0; y < size; ++y) {
+      size_t v = x * size + y;
+      if (x + 1 < size) {
+        addEdge(v, v + size, RelationType::Successor);
+        addEdge(v + size, v, RelationType::Successor);
+      }
+      if (y + 1 < size) {
+        addEdge(v, v + 1, RelationType::Left);
+        addEdge(v + 1, v, RelationType::Right);
+      }
+    }
+  }
+  return g;
+}
+
+//! The search as it was implemented on a std::map and boost::dijkstra_shortest_paths, to compare with
+template <typename G>
+class MapBasedSearch {
+ public:
+  using VertexType = typename boost::graph_traits<G>::vertex_descriptor;
+  using EdgeType = typename boost::graph_traits<G>::edge_descriptor;
+  using SearchMap = std::map<VertexType, VertexState>;
+
+ private:
+  struct CostMap {
+    using key_type = VertexType;                          // NOLINT
+    using value_type = double;                            // NOLINT
+    using reference = void;                               // NOLINT
+    using category = boost::read_write_property_map_tag;  // NOLINT
+    SearchMap* map{};
+    friend double get(const CostMap& m, VertexType key) {
+      auto val = m.map->find(key);
+      return val != m.map->end() ? val->second.cost : std::numeric_limits<double>::infinity();
+    }
+    friend void put(CostMap& m, VertexType key, double value) { (*m.map)[key].cost = value; }
+  };
+
+  class LeafFilter {
+   public:
+    LeafFilter() = default;
+    LeafFilter(const SearchMap& m, const G& g) : m_{&m}, g_{&g} {}
+    bool operator()(EdgeType e) const { return (*m_).at(boost::source(e, *g_)).predicate; }
+
+   private:
+    const SearchMap* m_{};
+    const G* g_{};
+  };
+  using SearchGraph = boost::filtered_graph<G, LeafFilter>;
+
+  template <typename Func>
+  class Visitor : public boost::default_dijkstra_visitor {
+   public:
+    Visitor(SearchMap& map, Func* cb) : map_{&map}, cb_{cb} {}
+    void examine_vertex(VertexType v, const SearchGraph& /*g*/) {  // NOLINT
+      auto& state = map_->at(v);
+      state.predicate = (*cb_)(VertexVisitInformation{v, state.predecessor, state.cost, state.length,
+                                                      state.numLaneChanges});
+      map_->at(state.predecessor).isLeaf = v == state.predecessor;
+    }
+    void edge_relaxed(EdgeType e, const SearchGraph& g) {  // NOLINT
+      auto& predecessor = (*map_).at(boost::source(e, g));
+      auto& follower = (*map_)[boost::target(e, g)];
+      follower.length = predecessor.length + 1;
+      follower.predecessor = boost::source(e, g);
+      follower.numLaneChanges = predecessor.numLaneChanges + (g[e].relation != RelationType::Successor);
+    }
+
+   private:
+    SearchMap* map_{};
+    Func* cb_{};
+  };
+
+ public:
+  explicit MapBasedSearch(const G& graph) : graph_{graph, LeafFilter{vertices_, graph}} {}
+
+  template <typename Func>
+  void query(VertexType start, Func func) {
+    vertices_.clear();
+    vertices_.emplace(start, VertexState{start, 0., 1, 0, true, true});
+    Visitor<Func> visitor{vertices_, &func};
+    boost::dijkstra_shortest_paths_no_color_map_no_init(
+        graph_, start, boost::dummy_property_map{}, CostMap{&vertices_}, boost::get(&EdgeInfo::routingCost, graph_),
+        boost::get(boost::vertex_index, graph_), std::less<double>{}, boost::closed_plus<double>{},
+        std::numeric_limits<double>::infinity(), 0., visitor);
+  }
+
+  const SearchMap& getMap() const { return vertices_; }
+
+ private:
+  SearchGraph graph_;
+  SearchMap vertices_;
+};
+
+//! Stops at maxCost and at every seventh vertex, so that some paths end before the cost is reached
+struct GridPredicate {
+  double maxCost;
+  bool operator()(const VertexVisitInformation& i) const { return i.cost <= maxCost && i.vertex % 7 != 3; }
+};
+
+//! Counts the visited vertices and stops at maxCost
+struct StopIfVisits {
+  size_t* visits;
+  double maxCost;
+  bool operator()(const VertexVisitInformation& i) const {
+    ++*visits;
+    return i.cost <= maxCost;
+  }
+};
+
+template <typename G>
+void expectSameResult(const MapBasedSearch<G>& reference, const DijkstraStyleSearch<G>& search) {
+  const auto& state = search.getState();
+  ASSERT_EQ(reference.getMap().size(), state.discovered().size());
+  for (auto& expected : reference.getMap()) {
+    auto& actual = state[expected.first];
+    EXPECT_EQ(expected.second.predecessor, actual.predecessor) << expected.first;
+    EXPECT_EQ(expected.second.cost, actual.cost) << expected.first;
+    EXPECT_EQ(expected.second.length, actual.length) << expected.first;
+    EXPECT_EQ(expected.second.numLaneChanges, actual.numLaneChanges) << expected.first;
+    EXPECT_EQ(expected.second.predicate, actual.predicate) << expected.first;
+    EXPECT_EQ(expected.second.isLeaf, actual.isLeaf) << expected.first;
+  }
+}
+
+template <typename G>
+void compareSearches(const G& g) {
+  MapBasedSearch<G> reference(g);
+  DijkstraStyleSearch<G> search(g);  // reused for all queries
+  for (auto start : {0ul, 17ul, 210ul, 399ul}) {
+    for (double maxCost : {0., 350., 800., 10000.}) {
+      std::vector<VertexVisitInformation> referenceVisits;
+      std::vector<VertexVisitInformation> visits;
+      reference.query(start, [&](const VertexVisitInformation& i) {
+        referenceVisits.push_back(i);
+        return GridPredicate{maxCost}(i);
+      });
+      search.query(start, [&](const VertexVisitInformation& i) {
+        visits.push_back(i);
+        return GridPredicate{maxCost}(i);
+      });
+      ASSERT_EQ(referenceVisits.size(), visits.size());
+      for (size_t i = 0; i < visits.size(); ++i) {
+        EXPECT_EQ(referenceVisits[i].vertex, visits[i].vertex);
+        EXPECT_EQ(referenceVisits[i].predecessor, visits[i].predecessor);
+      }
+      expectSameResult(reference, search);
+    }
+  }
+}
+}  // namespace
+
+TEST(DijkstraSearch, matchesMapBasedSearch) {  // NOLINT
+  auto g = buildGridGraph(20);
+  compareSearches(g);
+  compareSearches(boost::make_reverse_graph(g));
+}
+
+TEST(DijkstraSearch, pathsShareTheSearchTree) {  // NOLINT
+  auto g = buildGridGraph(20);
+  DijkstraStyleSearch<GraphType> search(g);
+  search.query(210, GridPredicate{500.});
+  auto isEnd = [](const VertexState& v) { return v.isLeaf && !v.predicate; };
+  std::vector<std::vector<GraphType::vertex_descriptor>> paths;
+  auto numPaths = search.forEachPath(isEnd, [](auto v) { return v; }, [&](size_t idx, const auto& path) {
+    paths.resize(std::max(paths.size(), idx + 1));
+    paths[idx] = path;
+  });
+  ASSERT_EQ(numPaths, paths.size());
+  ASSERT_GT(numPaths, 10ul);
+  GraphType::vertex_descriptor last{};
+  for (auto& path : paths) {
+    ASSERT_FALSE(path.empty());
+    EXPECT_EQ(path.front(), 210ul);
+    EXPECT_TRUE(isEnd(search.getState()[path.back()]));
+    EXPECT_TRUE(path.back() > last || &path == &paths.front());  // ascending order of the last vertex
+    last = path.back();
+    EXPECT_EQ(path.size(), search.getState()[path.back()].length);
+    for (size_t i = 1; i < path.size(); ++i) {
+      EXPECT_EQ(search.getState()[path[i]].predecessor, path[i - 1]);
+    }
+  }
+}
+
+TEST(RoutingGraphSearch, batchedQueriesMatchSingleQueries) {  // NOLINT
+  auto map = buildGridCity(4);
+  auto graph = buildGridCityGraph(*map);
+  ConstLanelets starts(map->laneletLayer.begin(), map->laneletLayer.end());
+  starts.push_back(ConstLanelet(Id(1), LineString3d(), LineString3d()));  // not part of the graph
+
+  auto reachable = graph->reachableSets(starts, 300.);
+  auto pathsCost = graph->possiblePathSets(starts, 250.);
+  auto pathsLength = graph->possiblePathSets(starts, uint32_t(6), true);
+  ASSERT_EQ(reachable.size(), starts.size());
+  ASSERT_EQ(pathsCost.size(), starts.size());
+  ASSERT_EQ(pathsLength.size(), starts.size());
+  for (size_t i = 0; i < starts.size(); ++i) {
+    EXPECT_EQ(reachable[i], graph->reachableSet(starts[i], 300.));
+    auto expectSamePaths = [](const LaneletPaths& expected, const LaneletPaths& actual) {
+      ASSERT_EQ(expected.size(), actual.size());
+      for (size_t p = 0; p < expected.size(); ++p) {
+        EXPECT_TRUE(std::equal(expected[p].begin(), expected[p].end(), actual[p].begin(), actual[p].end()));
+      }
+    };
+    expectSamePaths(graph->possiblePaths(starts[i], 250.), pathsCost[i]);
+    expectSamePaths(graph->possiblePaths(starts[i], uint32_t(6), true), pathsLength[i]);
+    for (auto& path : pathsLength[i]) {
+      EXPECT_EQ(path.front(), starts[i]);
+      EXPECT_EQ(path.size(), 6ul);
+    }
+  }
+  EXPECT_TRUE(reachable.back().empty());
+  EXPECT_FALSE(reachable.front().empty());
+  EXPECT_FALSE(pathsLength.front().empty());
+}
+
+TEST(RoutingGraphSearch, benchmark) {  // NOLINT
+  using Clock = std::chrono::steady_clock;
+  auto ms = [](Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  };
+
+  // the search alone, against the previous std::map based one
+  auto g = buildGridGraph(150);
+  MapBasedSearch<GraphType> reference(g);
+  DijkstraStyleSearch<GraphType> search(g);
+  const size_t queries = 500;
+  size_t referenceVisits = 0;
+  size_t visits = 0;
+  auto start = Clock::now();
+  for (size_t i = 0; i < queries; ++i) {
+    reference.query(i * 37 % boost::num_vertices(g), StopIfVisits{&referenceVisits, 1000.});
+  }
+  double referenceTime = ms(start);
+  start = Clock::now();
+  for (size_t i = 0; i < queries; ++i) {
+    search.query(i * 37 % boost::num_vertices(g), StopIfVisits{&visits, 1000.});
+  }
+  double searchTime = ms(start);
+  EXPECT_EQ(referenceVisits, visits);
+  std::cout << "[ search   ] " << boost::num_vertices(g) << " vertices, " << queries << " queries, std::map "
+            << referenceTime << " ms, flat " << searchTime << " ms\n";
+
+  // the queries of the routing graph on a city of 20x20 blocks
+  auto map = buildGridCity(20);
+  auto graph = buildGridCityGraph(*map);
+  ConstLanelets starts;
+  for (auto& ll : map->laneletLayer) {
+    if (starts.size() < queries) {
+      starts.push_back(ll);
+    }
+  }
+  start = Clock::now();
+  size_t numSingle = 0;
+  for (auto& ll : starts) {
+    numSingle += graph->reachableSet(ll, 300.).size() + graph->possiblePaths(ll, 250.).size();
+  }
+  double singleTime = ms(start);
+  start = Clock::now();
+  size_t numBatched = 0;
+  for (auto& set : graph->reachableSets(starts, 300.)) {
+    numBatched += set.size();
+  }
+  for (auto& paths : graph->possiblePathSets(starts, 250.)) {
+    numBatched += paths.size();
+  }
+  double batchedTime = ms(start);
+  EXPECT_EQ(numSingle, numBatched);
+  std::cout << "[ routing  ] " << map->laneletLayer.size() << " lanelets, " << starts.size()
+            << " reachableSet + possiblePaths queries, single " << singleTime << " ms, batched " << batchedTime
+            << " ms\n";
+}
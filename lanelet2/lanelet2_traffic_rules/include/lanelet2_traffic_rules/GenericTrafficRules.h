@@ -80,6 +80,17 @@ class GenericTrafficRules : public TrafficRules {  // NOLINT
    */
   bool hasDynamicRules(const ConstLanelet& lanelet) const override;
 
+  /**
+   * @brief precomputes the rules for the lanelets, areas and their boundaries in a map
+   *
+   * Afterwards passability, one-way, speed limit and lane change queries for primitives of this map are answered from
+   * a table keyed by their id instead of being derived from their attributes on every call. Results are identical.
+   * The table is rebuilt on the next query after the map was modified through add, update or remove. Call this again
+   * after changing attributes or regulatory elements of primitives of the map in place. Passing nullptr removes the
+   * table. The map is kept alive as long as the table exists.
+   */
+  void compile(LaneletMapLayersConstPtr map);
+
  protected:
   //! Called by canPass to check if traffic rules make a certain primitive drivable/not drivable
   //! If the optional is empty, there is no traffic rule that determines this.
@@ -101,7 +112,17 @@ class GenericTrafficRules : public TrafficRules {  // NOLINT
   virtual Optional<SpeedLimitInformation> speedLimit(const RegulatoryElementConstPtrs& regelems) const = 0;
 
  private:
+  struct CompiledRules;
+
   SpeedLimitInformation speedLimit(const RegulatoryElementConstPtrs& regelems, const AttributeMap& attributes) const;
+  bool canPassImpl(const ConstLanelet& lanelet) const;
+  bool canPassImpl(const ConstArea& area) const;
+  bool isOneWayImpl(const ConstLanelet& lanelet) const;
+  LaneChangeType boundaryChangeType(const ConstLineString3d& boundary, bool virtualIsPassable) const;
+  const CompiledRules* compiledRules() const;
+  void rebuild(CompiledRules& rules) const;
+
+  std::shared_ptr<CompiledRules> compiled_;
 };
 }  // namespace traffic_rules
 }  // namespace lanelet
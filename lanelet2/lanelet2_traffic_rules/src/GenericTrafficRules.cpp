@@ -1,8 +1,12 @@
 #include "GenericTrafficRules.h"
+#include <lanelet2_core/LaneletMap.h>
 #include <lanelet2_core/geometry/Area.h>
 #include <lanelet2_core/geometry/Lanelet.h>
 #include <lanelet2_core/primitives/RegulatoryElement.h>
 #include <lanelet2_core/utility/Units.h>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 #include "Exceptions.h"
 
 namespace lanelet {
@@ -121,6 +125,45 @@ T sort(const T& toSort) {
 }
 
 }  // namespace
+
+//! Rules of the primitives of a map, the data pointer identifies the primitive the entry was computed for
+struct GenericTrafficRules::CompiledRules {
+  struct LaneletRules {
+    const void* data;
+    bool canPass;
+    bool canPassInverted;
+    bool isOneWay;
+    SpeedLimitInformation speedLimit;
+  };
+  struct AreaRules {
+    const void* data;
+    bool canPass;
+    SpeedLimitInformation speedLimit;
+  };
+  struct BoundaryRules {
+    const void* data;
+    LaneChangeType changeType[2][2];  //!< indexed by [inverted][virtualIsPassable]
+  };
+
+  explicit CompiledRules(LaneletMapLayersConstPtr map) : map{std::move(map)} {}
+
+  template <typename RulesT, typename PrimitiveT>
+  static const RulesT* find(const std::unordered_map<Id, RulesT>& table, const PrimitiveT& primitive) {
+    auto elem = table.find(primitive.id());
+    if (elem == table.end() || elem->second.data != primitive.constData().get()) {
+      return nullptr;
+    }
+    return &elem->second;
+  }
+
+  LaneletMapLayersConstPtr map;
+  std::atomic<size_t> revision{0};
+  std::mutex mutex;
+  std::unordered_map<Id, LaneletRules> lanelets;
+  std::unordered_map<Id, AreaRules> areas;
+  std::unordered_map<Id, BoundaryRules> boundaries;
+};
+
 TrafficRules::~TrafficRules() = default;
 
 bool GenericTrafficRules::hasDynamicRules(const ConstLanelet& lanelet) const {
@@ -130,6 +173,17 @@ bool GenericTrafficRules::hasDynamicRules(const ConstLanelet& lanelet) const {
 }
 
 bool GenericTrafficRules::canPass(const lanelet::ConstLanelet& lanelet) const {
+  const auto* compiled = compiledRules();
+  if (compiled != nullptr) {
+    const auto* rules = CompiledRules::find(compiled->lanelets, lanelet);
+    if (rules != nullptr) {
+      return lanelet.inverted() ? rules->canPassInverted : rules->canPass;
+    }
+  }
+  return canPassImpl(lanelet);
+}
+
+bool GenericTrafficRules::canPassImpl(const lanelet::ConstLanelet& lanelet) const {
   if (!isDrivingDir(lanelet, participant())) {
     return false;
   }
@@ -146,6 +200,17 @@ bool GenericTrafficRules::canPass(const lanelet::ConstLanelet& lanelet) const {
 }
 
 bool GenericTrafficRules::canPass(const ConstArea& area) const {
+  const auto* compiled = compiledRules();
+  if (compiled != nullptr) {
+    const auto* rules = CompiledRules::find(compiled->areas, area);
+    if (rules != nullptr) {
+      return rules->canPass;
+    }
+  }
+  return canPassImpl(area);
+}
+
+bool GenericTrafficRules::canPassImpl(const ConstArea& area) const {
   auto canPassByRule = canPass(area.regulatoryElements());
   if (!!canPassByRule) {
     return *canPassByRule;
@@ -204,14 +269,14 @@ bool GenericTrafficRules::canPass(const ConstLanelet& from, const ConstArea& to)
     return false;
   }
   if (geometry::leftOf(from, to)) {
-    return canChangeToLeft(laneChangeType(from.leftBound(), true));
+    return canChangeToLeft(boundaryChangeType(from.leftBound(), true));
   }
   if (geometry::rightOf(from, to)) {
-    return canChangeToRight(laneChangeType(from.rightBound(), true));
+    return canChangeToRight(boundaryChangeType(from.rightBound(), true));
   }
   auto line = determineCommonLine(from, to);
   if (!!line) {
-    return canChangeToRight(laneChangeType(*line, true));
+    return canChangeToRight(boundaryChangeType(*line, true));
   }
   return false;
 }
@@ -221,14 +286,14 @@ bool GenericTrafficRules::canPass(const ConstArea& from, const ConstLanelet& to)
     return false;
   }
   if (geometry::leftOf(to, from)) {
-    return canChangeToRight(laneChangeType(to.leftBound(), true));
+    return canChangeToRight(boundaryChangeType(to.leftBound(), true));
   }
   if (geometry::rightOf(to, from)) {
-    return canChangeToLeft(laneChangeType(to.rightBound(), true));
+    return canChangeToLeft(boundaryChangeType(to.rightBound(), true));
   }
   auto line = determineCommonLine(to.invert(), from);
   if (!!line) {
-    return canChangeToLeft(laneChangeType(*line, true));
+    return canChangeToLeft(boundaryChangeType(*line, true));
   }
   return false;
 }
@@ -241,7 +306,7 @@ bool GenericTrafficRules::canPass(const ConstArea& from, const ConstArea& to) co
   if (!line) {
     return false;
   }
-  return canChangeToLeft(laneChangeType(*line, true));
+  return canChangeToLeft(boundaryChangeType(*line, true));
 }
 
 bool GenericTrafficRules::canChangeLane(const ConstLanelet& from, const ConstLanelet& to) const {
@@ -254,7 +319,7 @@ bool GenericTrafficRules::canChangeLane(const ConstLanelet& from, const ConstLan
   } else if (!geometry::rightOf(from, to)) {
     return false;
   }
-  auto type = laneChangeType(isLeft ? from.rightBound() : from.leftBound());
+  auto type = boundaryChangeType(isLeft ? from.rightBound() : from.leftBound(), false);
   return isLeft ? canChangeToRight(type) : canChangeToLeft(type);
 }
 
@@ -312,10 +377,24 @@ SpeedLimitInformation GenericTrafficRules::speedLimit(const RegulatoryElementCon
 }
 
 SpeedLimitInformation GenericTrafficRules::speedLimit(const ConstLanelet& lanelet) const {
+  const auto* compiled = compiledRules();
+  if (compiled != nullptr) {
+    const auto* rules = CompiledRules::find(compiled->lanelets, lanelet);
+    if (rules != nullptr) {
+      return rules->speedLimit;
+    }
+  }
   return speedLimit(lanelet.regulatoryElements(), lanelet.attributes());
 }
 
 SpeedLimitInformation GenericTrafficRules::speedLimit(const ConstArea& area) const {
+  const auto* compiled = compiledRules();
+  if (compiled != nullptr) {
+    const auto* rules = CompiledRules::find(compiled->areas, area);
+    if (rules != nullptr) {
+      return rules->speedLimit;
+    }
+  }
   return speedLimit(area.regulatoryElements(), area.attributes());
 }
 
@@ -347,9 +426,93 @@ Optional<bool> GenericTrafficRules::canPass(const std::string& type, const std::
 }
 
 bool GenericTrafficRules::isOneWay(const ConstLanelet& lanelet) const {
+  const auto* compiled = compiledRules();
+  if (compiled != nullptr) {
+    const auto* rules = CompiledRules::find(compiled->lanelets, lanelet);
+    if (rules != nullptr) {
+      return rules->isOneWay;
+    }
+  }
+  return isOneWayImpl(lanelet);
+}
+
+bool GenericTrafficRules::isOneWayImpl(const ConstLanelet& lanelet) const {
   return isDrivingDir(lanelet, participant()) != isDrivingDir(lanelet.invert(), participant());
 }
 
+LaneChangeType GenericTrafficRules::boundaryChangeType(const ConstLineString3d& boundary,
+                                                       bool virtualIsPassable) const {
+  const auto* compiled = compiledRules();
+  if (compiled != nullptr) {
+    const auto* rules = CompiledRules::find(compiled->boundaries, boundary);
+    if (rules != nullptr) {
+      return rules->changeType[boundary.inverted() ? 1 : 0][virtualIsPassable ? 1 : 0];
+    }
+  }
+  return laneChangeType(boundary, virtualIsPassable);
+}
+
+void GenericTrafficRules::compile(LaneletMapLayersConstPtr map) {
+  if (!map) {
+    compiled_.reset();
+    return;
+  }
+  compiled_ = std::make_shared<CompiledRules>(std::move(map));
+  rebuild(*compiled_);
+}
+
+const GenericTrafficRules::CompiledRules* GenericTrafficRules::compiledRules() const {
+  if (!compiled_) {
+    return nullptr;
+  }
+  if (compiled_->revision != compiled_->map->revision()) {
+    std::lock_guard<std::mutex> lock(compiled_->mutex);
+    if (compiled_->revision != compiled_->map->revision()) {
+      rebuild(*compiled_);
+    }
+  }
+  return compiled_.get();
+}
+
+void GenericTrafficRules::rebuild(CompiledRules& rules) const {
+  // only the uncached implementations may be used here
+  rules.lanelets.clear();
+  rules.areas.clear();
+  rules.boundaries.clear();
+  auto addBoundary = [&](const ConstLineString3d& boundary) {
+    auto ls = boundary.inverted() ? boundary.invert() : boundary;
+    CompiledRules::BoundaryRules boundaryRules{ls.constData().get(), {}};
+    for (auto inverted : {false, true}) {
+      for (auto virtualIsPassable : {false, true}) {
+        boundaryRules.changeType[inverted ? 1 : 0][virtualIsPassable ? 1 : 0] =
+            laneChangeType(inverted ? ls.invert() : ls, virtualIsPassable);
+      }
+    }
+    rules.boundaries.emplace(ls.id(), boundaryRules);
+  };
+
+  const auto& map = *rules.map;
+  rules.lanelets.reserve(map.laneletLayer.size());
+  for (const ConstLanelet& ll : map.laneletLayer) {
+    auto lanelet = ll.inverted() ? ll.invert() : ll;
+    rules.lanelets.emplace(lanelet.id(), CompiledRules::LaneletRules{
+                                             lanelet.constData().get(), canPassImpl(lanelet),
+                                             canPassImpl(lanelet.invert()), isOneWayImpl(lanelet),
+                                             speedLimit(lanelet.regulatoryElements(), lanelet.attributes())});
+    addBoundary(lanelet.leftBound());
+    addBoundary(lanelet.rightBound());
+  }
+  rules.areas.reserve(map.areaLayer.size());
+  for (const ConstArea& area : map.areaLayer) {
+    rules.areas.emplace(area.id(), CompiledRules::AreaRules{area.constData().get(), canPassImpl(area),
+                                                            speedLimit(area.regulatoryElements(), area.attributes())});
+    for (const auto& boundary : area.outerBound()) {
+      addBoundary(boundary);
+    }
+  }
+  rules.revision = map.revision();
+}
+
 std::ostream& operator<<(std::ostream& stream, const SpeedLimitInformation& obj) {
   return stream << "speedLimit: " << units::KmHQuantity(obj.speedLimit).value()
                 << "km/h, mandatory: " << (obj.isMandatory ? "yes" : "no");
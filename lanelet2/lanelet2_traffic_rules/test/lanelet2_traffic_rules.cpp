@@ -1,6 +1,11 @@
+#include <lanelet2_core/LaneletMap.h>
 #include <lanelet2_core/primitives/BasicRegulatoryElements.h>
 #include <lanelet2_core/primitives/Lanelet.h>
 #include <lanelet2_core/utility/Units.h>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include "GenericTrafficRules.h"
 #include "TrafficRules.h"
 #include "TrafficRulesFactory.h"
 #include "gtest/gtest.h"
@@ -544,3 +549,164 @@ TEST_F(GermanTrafficRulesVehicle, factoryReturnsVehicleForCar) {  // NOLINT
   EXPECT_EQ(trafficRules->participant(), Participants::VehicleCar);
 }
 }  // namespace other
+
+namespace compiled {
+using lanelet::traffic_rules::GenericTrafficRules;
+
+std::vector<lanelet::traffic_rules::TrafficRulesPtr> allGermanRules() {
+  return {germanVehicleRules(), germanBikeRules(), germanPedestrianRules()};
+}
+
+GenericTrafficRules& generic(const lanelet::traffic_rules::TrafficRulesPtr& rules) {
+  return dynamic_cast<GenericTrafficRules&>(*rules);
+}
+
+// all answers of the rules for the primitives of the fixture
+std::vector<std::string> answers(const lanelet::traffic_rules::TrafficRules& rules, const TrafficRules& f) {
+  std::vector<lanelet::ConstLanelet> lanelets{f.lanelet, f.left, f.right, f.next};
+  for (size_t i = 0, n = lanelets.size(); i < n; ++i) {
+    lanelets.push_back(lanelets[i].invert());
+  }
+  std::vector<lanelet::ConstArea> areas{f.area, f.nextArea};
+  std::vector<std::string> result;
+  auto add = [&result](auto&& value) {
+    std::ostringstream os;
+    os << value;
+    result.push_back(os.str());
+  };
+  for (auto& ll : lanelets) {
+    add(rules.canPass(ll));
+    add(rules.isOneWay(ll));
+    add(rules.speedLimit(ll).speedLimit.value());
+    add(rules.speedLimit(ll).isMandatory);
+    for (auto& other : lanelets) {
+      add(rules.canPass(ll, other));
+      add(rules.canChangeLane(ll, other));
+    }
+    for (auto& ar : areas) {
+      add(rules.canPass(ll, ar));
+      add(rules.canPass(ar, ll));
+    }
+  }
+  for (auto& ar : areas) {
+    add(rules.canPass(ar));
+    add(rules.speedLimit(ar).speedLimit.value());
+    for (auto& other : areas) {
+      add(rules.canPass(ar, other));
+    }
+  }
+  return result;
+}
+
+TEST_F(TrafficRules, compiledRulesGiveSameAnswers) {  // NOLINT
+  lanelet.addRegulatoryElement(getSpeedLimit("de274-60"));
+  next.setAttribute(Attr::OneWay, false);
+  ls3.setAttribute(Attr::Type, Value::LineThin);
+  ls3.setAttribute(Attr::Subtype, Value::Dashed);
+  ls7.setAttribute(Attr::Type, Value::Virtual);
+  nextArea.attributes() = pedestrianAttr;
+  lanelet::LaneletMapPtr map = lanelet::utils::createMap({lanelet, left, right, next}, {area, nextArea});
+
+  for (auto& rules : allGermanRules()) {
+    auto expected = answers(*rules, *this);
+    generic(rules).compile(map);
+    EXPECT_EQ(expected, answers(*rules, *this)) << rules->participant();
+    generic(rules).compile(nullptr);
+    EXPECT_EQ(expected, answers(*rules, *this)) << rules->participant();
+  }
+}
+
+TEST_F(TrafficRules, compiledRulesFollowMapChanges) {  // NOLINT
+  lanelet::LaneletMapPtr map = lanelet::utils::createMap({lanelet, left}, {});
+  auto rules = germanVehicleRules();
+  generic(rules).compile(map);
+  EXPECT_TRUE(rules->canPass(lanelet, next));
+
+  // primitives that are not in the map are answered without the table
+  next.setAttribute(Attr::Subtype, Value::Walkway);
+  EXPECT_FALSE(rules->canPass(next));
+  EXPECT_FALSE(rules->canPass(lanelet, next));
+
+  // adding to the map rebuilds the table
+  map->add(next);
+  EXPECT_FALSE(rules->canPass(next));
+  next.setAttribute(Attr::Subtype, Value::Road);
+  EXPECT_FALSE(rules->canPass(next)) << "in-place edits require compiling again";
+  generic(rules).compile(map);
+  EXPECT_TRUE(rules->canPass(next));
+
+  // a different primitive with the same id is not mistaken for the compiled one
+  lanelet::Lanelet sameId{next.id(), ls6, ls5, pedestrianAttr};
+  EXPECT_FALSE(rules->canPass(sameId));
+}
+
+TEST(TrafficRulesBenchmark, compiledRules) {  // NOLINT
+  using namespace lanelet;
+  // grid of lanes with lane markings, every lanelet has a successor and neighbours
+  const int lanes = 20;
+  const int length = 200;
+  std::vector<std::vector<Point3d>> points(lanes + 1);
+  std::vector<std::vector<LineString3d>> bounds(lanes + 1);
+  Id id = 1;
+  for (int y = 0; y <= lanes; ++y) {
+    for (int x = 0; x <= length; ++x) {
+      points[y].emplace_back(id++, x, y * 3., 0.);
+    }
+    for (int x = 0; x < length; ++x) {
+      bounds[y].emplace_back(id++, Points3d{points[y][x], points[y][x + 1]},
+                             AttributeMap{{AttrStr::Type, Value::LineThin}, {AttrStr::Subtype, Value::Dashed}});
+    }
+  }
+  Lanelets lanelets;
+  lanelets.reserve(lanes * length);
+  for (int y = 0; y < lanes; ++y) {
+    for (int x = 0; x < length; ++x) {
+      AttributeMap attributes{{AttrStr::Subtype, Value::Road}, {AttrStr::Location, Value::Urban}};
+      if (y % 2 == 1) {
+        attributes[AttrStr::OneWay] = false;
+      }
+      lanelets.emplace_back(id++, bounds[y + 1][x], bounds[y][x], attributes);
+    }
+  }
+  LaneletMapPtr map = utils::createMap(lanelets, {});
+
+  // the queries of building a routing graph: every lanelet, its successor and its neighbours in both directions
+  auto query = [&](const traffic_rules::TrafficRules& rules) {
+    size_t result = 0;
+    for (int y = 0; y < lanes; ++y) {
+      for (int x = 0; x < length; ++x) {
+        const ConstLanelet ll = lanelets[y * length + x];
+        for (auto& cur : {ll, ll.invert()}) {
+          result += rules.canPass(cur) + rules.isOneWay(cur) + int(rules.speedLimit(cur).speedLimit.value());
+        }
+        if (x + 1 < length) {
+          const ConstLanelet next = lanelets[y * length + x + 1];
+          result += rules.canPass(ll, next) + rules.canPass(next.invert(), ll.invert());
+        }
+        if (y + 1 < lanes) {
+          const ConstLanelet left = lanelets[(y + 1) * length + x];
+          result += rules.canChangeLane(ll, left) + rules.canChangeLane(left, ll);
+        }
+      }
+    }
+    return result;
+  };
+
+  auto rules = germanVehicleRules();
+  auto time = [&](size_t& result) {
+    auto start = std::chrono::steady_clock::now();
+    result = query(*rules);
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  };
+  size_t uncompiledResult = 0;
+  size_t compiledResult = 0;
+  auto uncompiled = time(uncompiledResult);
+  auto start = std::chrono::steady_clock::now();
+  generic(rules).compile(map);
+  auto compile = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  auto compiled = time(compiledResult);
+  EXPECT_EQ(uncompiledResult, compiledResult);
+  std::cout << "[ compiled ] " << lanelets.size() << " lanelets, uncompiled " << uncompiled << " ms, compile "
+            << compile << " ms, compiled " << compiled << " ms\n";
+}
+}  // namespace compiled
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************
+ *
+ * multi_lidar_offline_calibrator.h
+ *
+ *  Offline calibration of several child lidars against one parent lidar from recorded frames.
+ */
+
+#ifndef PROJECT_MULTI_LIDAR_OFFLINE_CALIBRATOR_H
+#define PROJECT_MULTI_LIDAR_OFFLINE_CALIBRATOR_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <Eigen/Geometry>
+#include <Eigen/StdVector>
+#include <pcl/point_cloud.h>
+#include <pcl/point_types.h>
+
+/*!
+ * Settings of the offline calibration. The ndt_* values have the same meaning as the parameters of the online node.
+ */
+struct OfflineCalibrationParameters
+{
+	double              voxel_size = 0.1;            //!< leaf size used to downsample the child clouds
+	double              ndt_epsilon = 0.01;
+	double              ndt_step_size = 0.1;
+	std::vector<double> ndt_resolutions = {4.0, 2.0, 1.0}; //!< voxel sizes of the parent clouds, coarse to fine
+	int                 ndt_iterations = 400;        //!< maximum iterations of every resolution
+	int                 threads = 0;                 //!< frames aligned in parallel, 0 to use all cores
+	double              max_translation_deviation = 0.2; //!< frames farther from the median are rejected [m]
+	double              max_rotation_deviation = 0.05;   //!< frames rotated more from the median are rejected [rad]
+};
+
+/*!
+ * Calibration of one child sensor and the statistics of the frames it was estimated from.
+ */
+struct OfflineCalibrationResult
+{
+	std::string     child;
+	Eigen::Matrix4f transformation = Eigen::Matrix4f::Identity(); //!< transforms child points into the parent frame
+	bool            valid = false;               //!< false if no frame converged
+	size_t          frames = 0;                  //!< frames with a cloud of this child
+	size_t          converged_frames = 0;        //!< frames that converged within ndt_iterations at every resolution
+	size_t          inlier_frames = 0;           //!< converged frames within the deviation limits of the median
+	double          mean_fitness_score = 0.;     //!< of the inlier frames at the finest resolution
+	double          mean_iterations = 0.;        //!< of the inlier frames, summed over the resolutions
+	double          translation_deviation = 0.;  //!< RMS distance of the inlier frames from the result [m]
+	double          rotation_deviation = 0.;     //!< RMS rotation angle of the inlier frames from the result [rad]
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+/*!
+ * Estimate of one frame, input of MultiLidarOfflineCalibrator::CombineEstimates
+ */
+struct FrameCalibrationEstimate
+{
+	Eigen::Matrix4f transformation = Eigen::Matrix4f::Identity();
+	bool            converged = false;
+	double          fitness_score = 0.;
+	int             iterations = 0;
+
+	EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+};
+
+typedef std::vector<OfflineCalibrationResult, Eigen::aligned_allocator<OfflineCalibrationResult> >
+		OfflineCalibrationResults;
+typedef std::vector<FrameCalibrationEstimate, Eigen::aligned_allocator<FrameCalibrationEstimate> >
+		FrameCalibrationEstimates;
+
+/*!
+ * Calibrates several child lidars against one parent lidar from many recorded frames.
+ *
+ * Every frame is aligned on its own with NDT, from the coarsest to the finest resolution, each starting from the result
+ * of the previous one. The voxelized parent cloud of a resolution is built once and shared by all children of the
+ * frame. Frames are aligned in parallel threads. The calibration of a child combines the estimates of its converged
+ * frames after rejecting those far from their median, so it does not depend on single frames.
+ */
+class MultiLidarOfflineCalibrator
+{
+public:
+	typedef pcl::PointXYZI PointT;
+	typedef pcl::PointCloud<PointT> PointCloudT;
+
+	explicit MultiLidarOfflineCalibrator(const OfflineCalibrationParameters& in_parameters);
+
+	/*!
+	 * Adds a child sensor to calibrate.
+	 * @param in_child name of the child, used to add its clouds
+	 * @param in_initial_guess transformation of child points into the parent frame the alignment starts from
+	 */
+	void AddChild(const std::string& in_child, const Eigen::Matrix4f& in_initial_guess);
+
+	/*!
+	 * Adds the clouds of one frame. The child clouds are downsampled right away, so only the parent clouds are kept at
+	 * full density.
+	 * @param in_parent_cloud cloud of the parent sensor
+	 * @param in_child_clouds clouds of the child sensors recorded at the same time, by name; children without a cloud in
+	 * this frame are left out, unknown ones are ignored
+	 */
+	void AddFrame(const PointCloudT::ConstPtr& in_parent_cloud,
+	              const std::map<std::string, PointCloudT::ConstPtr>& in_child_clouds);
+
+	size_t GetFrameCount() const
+	{
+		return frames_.size();
+	}
+
+	/*!
+	 * Aligns all frames and combines the estimates of every child.
+	 * @return one result for every child, in the order they were added
+	 */
+	OfflineCalibrationResults Calibrate() const;
+
+	/*!
+	 * Combines the estimates of the frames of one child into its calibration.
+	 * @param in_child name of the child
+	 * @param in_estimates estimates of every frame with a cloud of this child
+	 * @param in_parameters limits to reject frames
+	 */
+	static OfflineCalibrationResult CombineEstimates(const std::string& in_child,
+	                                                 const FrameCalibrationEstimates& in_estimates,
+	                                                 const OfflineCalibrationParameters& in_parameters);
+
+private:
+	struct Frame
+	{
+		PointCloudT::ConstPtr              parent_cloud;
+		std::vector<PointCloudT::ConstPtr> child_clouds; //!< by child index, null if the child has no cloud
+	};
+
+	OfflineCalibrationParameters         parameters_;
+	std::vector<std::string>             children_;
+	std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > initial_guesses_;
+	std::vector<Frame>                   frames_;
+
+	/*!
+	 * Aligns the child clouds of one frame.
+	 * @param in_frame frame to align
+	 * @param out_estimates estimates by child index
+	 */
+	void AlignFrame(const Frame& in_frame, FrameCalibrationEstimates& out_estimates) const;
+};
+
+#endif //PROJECT_MULTI_LIDAR_OFFLINE_CALIBRATOR_H
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************
+ *
+ * multi_lidar_offline_calibrator.cpp
+ *
+ *  Offline calibration of several child lidars against one parent lidar from recorded frames.
+ */
+
+#include "multi_lidar_offline_calibrator.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+
+#include <pcl/filters/voxel_grid.h>
+#include <pcl/registration/ndt.h>
+
+namespace
+{
+	double TranslationDistance(const Eigen::Matrix4d& in_a, const Eigen::Matrix4d& in_b)
+	{
+		return (in_a.block<3, 1>(0, 3) - in_b.block<3, 1>(0, 3)).norm();
+	}
+
+	double RotationAngle(const Eigen::Matrix4d& in_a, const Eigen::Matrix4d& in_b)
+	{
+		Eigen::Matrix3d relative = in_a.block<3, 3>(0, 0).transpose() * in_b.block<3, 3>(0, 0);
+		return std::abs(Eigen::AngleAxisd(relative).angle());
+	}
+}
+
+MultiLidarOfflineCalibrator::MultiLidarOfflineCalibrator(const OfflineCalibrationParameters& in_parameters) :
+	parameters_(in_parameters)
+{
+	if (parameters_.ndt_resolutions.empty())
+	{
+		throw std::invalid_argument("at least one ndt resolution is required");
+	}
+}
+
+void MultiLidarOfflineCalibrator::AddChild(const std::string& in_child, const Eigen::Matrix4f& in_initial_guess)
+{
+	if (std::find(children_.begin(), children_.end(), in_child) != children_.end())
+	{
+		throw std::invalid_argument("child " + in_child + " was already added");
+	}
+	children_.push_back(in_child);
+	initial_guesses_.push_back(in_initial_guess);
+	for (auto& frame : frames_)
+	{
+		frame.child_clouds.emplace_back();
+	}
+}
+
+void MultiLidarOfflineCalibrator::AddFrame(const PointCloudT::ConstPtr& in_parent_cloud,
+                                           const std::map<std::string, PointCloudT::ConstPtr>& in_child_clouds)
+{
+	if (!in_parent_cloud || in_parent_cloud->empty())
+	{
+		return;
+	}
+	Frame frame;
+	frame.parent_cloud = in_parent_cloud;
+	frame.child_clouds.resize(children_.size());
+	bool has_child_cloud = false;
+	for (size_t i = 0; i < children_.size(); i++)
+	{
+		auto child_cloud = in_child_clouds.find(children_[i]);
+		if (child_cloud == in_child_clouds.end() || !child_cloud->second || child_cloud->second->empty())
+		{
+			continue;
+		}
+		if (parameters_.voxel_size > 0)
+		{
+			PointCloudT::Ptr filtered_cloud(new PointCloudT);
+			pcl::VoxelGrid<PointT> voxelized;
+			voxelized.setInputCloud(child_cloud->second);
+			voxelized.setLeafSize((float)parameters_.voxel_size, (float)parameters_.voxel_size,
+			                      (float)parameters_.voxel_size);
+			voxelized.filter(*filtered_cloud);
+			frame.child_clouds[i] = filtered_cloud;
+		}
+		else
+		{
+			frame.child_clouds[i] = child_cloud->second;
+		}
+		has_child_cloud = true;
+	}
+	if (has_child_cloud)
+	{
+		frames_.push_back(std::move(frame));
+	}
+}
+
+void MultiLidarOfflineCalibrator::AlignFrame(const Frame& in_frame, FrameCalibrationEstimates& out_estimates) const
+{
+	out_estimates.assign(children_.size(), FrameCalibrationEstimate());
+	for (size_t i = 0; i < children_.size(); i++)
+	{
+		out_estimates[i].transformation = initial_guesses_[i];
+		out_estimates[i].converged = static_cast<bool>(in_frame.child_clouds[i]);
+	}
+
+	PointCloudT aligned_cloud;
+	for (double resolution : parameters_.ndt_resolutions)
+	{
+		// setInputTarget voxelizes the parent cloud, every child of the frame is aligned against the same voxels
+		pcl::NormalDistributionsTransform<PointT, PointT> ndt;
+		ndt.setTransformationEpsilon(parameters_.ndt_epsilon);
+		ndt.setStepSize(parameters_.ndt_step_size);
+		ndt.setResolution((float)resolution);
+		ndt.setMaximumIterations(parameters_.ndt_iterations);
+		ndt.setInputTarget(in_frame.parent_cloud);
+
+		for (size_t i = 0; i < children_.size(); i++)
+		{
+			FrameCalibrationEstimate& estimate = out_estimates[i];
+			if (!estimate.converged)
+			{
+				continue;
+			}
+			ndt.setInputSource(in_frame.child_clouds[i]);
+			ndt.align(aligned_cloud, estimate.transformation);
+
+			// hasConverged is also true after running out of iterations, such a frame did not converge
+			estimate.converged = ndt.hasConverged() && ndt.getFinalNumIteration() < parameters_.ndt_iterations;
+			estimate.transformation = ndt.getFinalTransformation();
+			estimate.iterations += ndt.getFinalNumIteration();
+			estimate.fitness_score = ndt.getFitnessScore();
+		}
+	}
+}
+
+OfflineCalibrationResults MultiLidarOfflineCalibrator::Calibrate() const
+{
+	std::vector<FrameCalibrationEstimates> frame_estimates(frames_.size());
+
+	size_t thread_count = parameters_.threads > 0 ? parameters_.threads : std::thread::hardware_concurrency();
+	thread_count = std::max<size_t>(1, std::min(thread_count, frames_.size()));
+
+	std::atomic<size_t> next_frame(0);
+	std::vector<std::exception_ptr> errors(thread_count);
+	auto align_frames = [&](size_t in_thread)
+	{
+		try
+		{
+			for (size_t frame = next_frame++; frame < frames_.size(); frame = next_frame++)
+			{
+				AlignFrame(frames_[frame], frame_estimates[frame]);
+			}
+		}
+		catch (...)
+		{
+			errors[in_thread] = std::current_exception();
+			next_frame = frames_.size();
+		}
+	};
+	std::vector<std::thread> threads;
+	for (size_t i = 1; i < thread_count; i++)
+	{
+		threads.emplace_back(align_frames, i);
+	}
+	align_frames(0);
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	for (const auto& error : errors)
+	{
+		if (error)
+		{
+			std::rethrow_exception(error);
+		}
+	}
+
+	OfflineCalibrationResults results;
+	for (size_t i = 0; i < children_.size(); i++)
+	{
+		FrameCalibrationEstimates child_estimates;
+		for (size_t frame = 0; frame < frames_.size(); frame++)
+		{
+			if (frames_[frame].child_clouds[i])
+			{
+				child_estimates.push_back(frame_estimates[frame][i]);
+			}
+		}
+		results.push_back(CombineEstimates(children_[i], child_estimates, parameters_));
+	}
+	return results;
+}
+
+OfflineCalibrationResult MultiLidarOfflineCalibrator::CombineEstimates(const std::string& in_child,
+                                                                       const FrameCalibrationEstimates& in_estimates,
+                                                                       const OfflineCalibrationParameters& in_parameters)
+{
+	OfflineCalibrationResult result;
+	result.child = in_child;
+	result.frames = in_estimates.size();
+
+	std::vector<Eigen::Matrix4d, Eigen::aligned_allocator<Eigen::Matrix4d> > transformations;
+	std::vector<const FrameCalibrationEstimate*> converged;
+	for (const auto& estimate : in_estimates)
+	{
+		if (estimate.converged)
+		{
+			transformations.push_back(estimate.transformation.cast<double>());
+			converged.push_back(&estimate);
+		}
+	}
+	result.converged_frames = converged.size();
+	if (converged.empty())
+	{
+		return result;
+	}
+
+	// the median is the estimate closest to all others, translation and rotation weighted by their limits
+	size_t median = 0;
+	double median_distance = std::numeric_limits<double>::infinity();
+	for (size_t i = 0; i < transformations.size(); i++)
+	{
+		double distance = 0.;
+		for (size_t j = 0; j < transformations.size(); j++)
+		{
+			distance += TranslationDistance(transformations[i], transformations[j]) / in_parameters.max_translation_deviation
+			            + RotationAngle(transformations[i], transformations[j]) / in_parameters.max_rotation_deviation;
+		}
+		if (distance < median_distance)
+		{
+			median = i;
+			median_distance = distance;
+		}
+	}
+
+	// mean of the inliers, quaternions flipped to the hemisphere of the median so that they don't cancel out
+	Eigen::Quaterniond median_rotation(Eigen::Matrix3d(transformations[median].block<3, 3>(0, 0)));
+	Eigen::Vector3d translation_sum = Eigen::Vector3d::Zero();
+	Eigen::Vector4d rotation_sum = Eigen::Vector4d::Zero();
+	std::vector<size_t> inliers;
+	for (size_t i = 0; i < transformations.size(); i++)
+	{
+		if (TranslationDistance(transformations[i], transformations[median]) > in_parameters.max_translation_deviation
+		    || RotationAngle(transformations[i], transformations[median]) > in_parameters.max_rotation_deviation)
+		{
+			continue;
+		}
+		inliers.push_back(i);
+		Eigen::Quaterniond rotation(Eigen::Matrix3d(transformations[i].block<3, 3>(0, 0)));
+		if (rotation.dot(median_rotation) < 0)
+		{
+			rotation.coeffs() = -rotation.coeffs();
+		}
+		translation_sum += transformations[i].block<3, 1>(0, 3);
+		rotation_sum += rotation.coeffs();
+		result.mean_fitness_score += converged[i]->fitness_score;
+		result.mean_iterations += converged[i]->iterations;
+	}
+
+	Eigen::Matrix4d transformation = Eigen::Matrix4d::Identity();
+	transformation.block<3, 3>(0, 0) = Eigen::Quaterniond(rotation_sum.normalized()).toRotationMatrix();
+	transformation.block<3, 1>(0, 3) = translation_sum / inliers.size();
+
+	for (size_t i : inliers)
+	{
+		result.translation_deviation += std::pow(TranslationDistance(transformations[i], transformation), 2);
+		result.rotation_deviation += std::pow(RotationAngle(transformations[i], transformation), 2);
+	}
+	result.transformation = transformation.cast<float>();
+	result.valid = true;
+	result.inlier_frames = inliers.size();
+	result.mean_fitness_score /= inliers.size();
+	result.mean_iterations /= inliers.size();
+	result.translation_deviation = std::sqrt(result.translation_deviation / inliers.size());
+	result.rotation_deviation = std::sqrt(result.rotation_deviation / inliers.size());
+	return result;
+}
@@ -0,0 +1,357 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ ********************
+ *
+ * multi_lidar_offline_calibrator_node.cpp
+ *
+ *  Calibrates child lidars against a parent lidar from a bag file or from directories of PCD files.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <pcl/io/pcd_io.h>
+#include <pcl_conversions/pcl_conversions.h>
+#include <ros/ros.h>
+#include <rosbag/bag.h>
+#include <rosbag/view.h>
+#include <sensor_msgs/PointCloud2.h>
+
+#include "multi_lidar_offline_calibrator.h"
+
+#define __APP_NAME__ "multi_lidar_offline_calibrator"
+
+typedef MultiLidarOfflineCalibrator::PointCloudT PointCloudT;
+
+struct StampedCloudMsg
+{
+	ros::Time                          stamp;
+	sensor_msgs::PointCloud2::ConstPtr msg;
+};
+
+PointCloudT::ConstPtr ConvertCloud(const sensor_msgs::PointCloud2::ConstPtr& in_cloud_msg)
+{
+	PointCloudT::Ptr cloud(new PointCloudT);
+	pcl::fromROSMsg(*in_cloud_msg, *cloud);
+	return cloud;
+}
+
+/*!
+ * Reads the frames from a bag. Every child message is paired with the parent message nearest in time.
+ * @return false if the bag can't be read
+ */
+bool ReadBag(const std::string& in_bag_file, const std::string& in_parent_topic,
+             const std::vector<std::string>& in_child_topics, double in_max_time_difference, int in_frame_step,
+             int in_max_frames, MultiLidarOfflineCalibrator& out_calibrator,
+             std::map<std::string, std::string>& out_frame_ids)
+{
+	rosbag::Bag bag;
+	try
+	{
+		bag.open(in_bag_file, rosbag::bagmode::Read);
+	}
+	catch (const rosbag::BagException& e)
+	{
+		ROS_ERROR("[%s] Cannot open %s: %s", __APP_NAME__, in_bag_file.c_str(), e.what());
+		return false;
+	}
+
+	std::vector<std::string> topics(in_child_topics);
+	topics.push_back(in_parent_topic);
+	rosbag::View view(bag, rosbag::TopicQuery(topics));
+
+	ros::Duration max_time_difference(in_max_time_difference);
+	std::deque<StampedCloudMsg> parents;
+	std::map<std::string, std::deque<StampedCloudMsg> > children;
+	int parent_count = 0;
+
+	// adds the parents whose children can't arrive any more, i.e. the bag is past their stamp by the max difference
+	auto add_frames = [&](const ros::Time& in_latest_stamp)
+	{
+		while (!parents.empty() && parents.front().stamp + max_time_difference < in_latest_stamp
+		       && (in_max_frames <= 0 || (int)out_calibrator.GetFrameCount() < in_max_frames))
+		{
+			std::map<std::string, PointCloudT::ConstPtr> child_clouds;
+			for (const auto& child : children)
+			{
+				const StampedCloudMsg* nearest = nullptr;
+				double nearest_difference = in_max_time_difference;
+				for (const auto& candidate : child.second)
+				{
+					double difference = std::abs((candidate.stamp - parents.front().stamp).toSec());
+					if (difference <= nearest_difference)
+					{
+						nearest = &candidate;
+						nearest_difference = difference;
+					}
+				}
+				if (nearest)
+				{
+					child_clouds[child.first] = ConvertCloud(nearest->msg);
+				}
+			}
+			if (!child_clouds.empty())
+			{
+				out_calibrator.AddFrame(ConvertCloud(parents.front().msg), child_clouds);
+			}
+			parents.pop_front();
+		}
+	};
+
+	for (const rosbag::MessageInstance& message : view)
+	{
+		sensor_msgs::PointCloud2::ConstPtr cloud_msg = message.instantiate<sensor_msgs::PointCloud2>();
+		if (!cloud_msg)
+		{
+			continue;
+		}
+		out_frame_ids.emplace(message.getTopic(), cloud_msg->header.frame_id);
+		StampedCloudMsg stamped_cloud_msg{cloud_msg->header.stamp, cloud_msg};
+		if (message.getTopic() == in_parent_topic)
+		{
+			if (parent_count++ % in_frame_step == 0)
+			{
+				parents.push_back(stamped_cloud_msg);
+			}
+		}
+		else
+		{
+			children[message.getTopic()].push_back(stamped_cloud_msg);
+		}
+
+		add_frames(stamped_cloud_msg.stamp);
+		if (in_max_frames > 0 && (int)out_calibrator.GetFrameCount() >= in_max_frames)
+		{
+			break;
+		}
+
+		// child messages older than every parent still to come can't be paired any more
+		ros::Time oldest_stamp = parents.empty() ? stamped_cloud_msg.stamp : parents.front().stamp;
+		for (auto& child : children)
+		{
+			while (!child.second.empty() && child.second.front().stamp + max_time_difference < oldest_stamp)
+			{
+				child.second.pop_front();
+			}
+		}
+	}
+	add_frames(ros::TIME_MAX);
+	bag.close();
+	return true;
+}
+
+/*!
+ * Reads the frames from the directory of every sensor. Clouds with the same file name in the directories of the parent
+ * and a child are one frame.
+ * @return false if the directory of the parent can't be read
+ */
+bool ReadPcdDirectories(const std::string& in_pcd_directory, const std::string& in_parent_directory,
+                        const std::vector<std::string>& in_child_directories, int in_frame_step, int in_max_frames,
+                        MultiLidarOfflineCalibrator& out_calibrator)
+{
+	namespace fs = boost::filesystem;
+	fs::path parent_path = fs::path(in_pcd_directory) / in_parent_directory;
+	if (!fs::is_directory(parent_path))
+	{
+		ROS_ERROR("[%s] %s is not a directory", __APP_NAME__, parent_path.string().c_str());
+		return false;
+	}
+
+	std::vector<fs::path> parent_files;
+	for (fs::directory_iterator file(parent_path); file != fs::directory_iterator(); ++file)
+	{
+		if (file->path().extension() == ".pcd")
+		{
+			parent_files.push_back(file->path());
+		}
+	}
+	std::sort(parent_files.begin(), parent_files.end());
+
+	for (size_t i = 0; i < parent_files.size(); i += in_frame_step)
+	{
+		if (in_max_frames > 0 && (int)out_calibrator.GetFrameCount() >= in_max_frames)
+		{
+			break;
+		}
+		std::map<std::string, PointCloudT::ConstPtr> child_clouds;
+		for (const auto& child_directory : in_child_directories)
+		{
+			fs::path child_file = fs::path(in_pcd_directory) / child_directory / parent_files[i].filename();
+			PointCloudT::Ptr child_cloud(new PointCloudT);
+			if (fs::exists(child_file) && pcl::io::loadPCDFile(child_file.string(), *child_cloud) == 0)
+			{
+				child_clouds[child_directory] = child_cloud;
+			}
+		}
+		PointCloudT::Ptr parent_cloud(new PointCloudT);
+		if (child_clouds.empty() || pcl::io::loadPCDFile(parent_files[i].string(), *parent_cloud) != 0)
+		{
+			continue;
+		}
+		out_calibrator.AddFrame(parent_cloud, child_clouds);
+	}
+	return true;
+}
+
+int main(int argc, char **argv)
+{
+	ros::init(argc, argv, __APP_NAME__);
+	ros::NodeHandle private_node_handle("~");
+
+	std::string bag_file, pcd_directory, points_parent_src;
+	std::vector<std::string> points_child_srcs;
+	private_node_handle.param<std::string>("bag_file", bag_file, "");
+	private_node_handle.param<std::string>("pcd_directory", pcd_directory, "");
+	private_node_handle.param<std::string>("points_parent_src", points_parent_src, "points_raw");
+	private_node_handle.param<std::vector<std::string> >("points_child_srcs", points_child_srcs,
+	                                                      std::vector<std::string>());
+	if (points_child_srcs.empty())
+	{
+		std::string points_child_src;
+		private_node_handle.param<std::string>("points_child_src", points_child_src, "points_raw");
+		points_child_srcs.push_back(points_child_src);
+	}
+
+	OfflineCalibrationParameters parameters;
+	private_node_handle.param<double>("voxel_size", parameters.voxel_size, parameters.voxel_size);
+	private_node_handle.param<double>("ndt_epsilon", parameters.ndt_epsilon, parameters.ndt_epsilon);
+	private_node_handle.param<double>("ndt_step_size", parameters.ndt_step_size, parameters.ndt_step_size);
+	private_node_handle.param<std::vector<double> >("ndt_resolutions", parameters.ndt_resolutions,
+	                                                parameters.ndt_resolutions);
+	private_node_handle.param<int>("ndt_iterations", parameters.ndt_iterations, parameters.ndt_iterations);
+	private_node_handle.param<int>("threads", parameters.threads, parameters.threads);
+	private_node_handle.param<double>("max_translation_deviation", parameters.max_translation_deviation,
+	                                  parameters.max_translation_deviation);
+	private_node_handle.param<double>("max_rotation_deviation", parameters.max_rotation_deviation,
+	                                  parameters.max_rotation_deviation);
+
+	double max_time_difference;
+	int frame_step, max_frames;
+	private_node_handle.param<double>("max_time_difference", max_time_difference, 0.05);
+	private_node_handle.param<int>("frame_step", frame_step, 10);
+	private_node_handle.param<int>("max_frames", max_frames, 50);
+	frame_step = std::max(frame_step, 1);
+
+	// x y z roll pitch yaw of every child, the same guess for all of them if not given
+	std::vector<double> initial_guesses;
+	private_node_handle.param<std::vector<double> >("initial_guesses", initial_guesses, std::vector<double>());
+	if (initial_guesses.size() != 6 * points_child_srcs.size())
+	{
+		if (!initial_guesses.empty())
+		{
+			ROS_WARN("[%s] initial_guesses needs 6 values for each of the %zu children, using x y z roll pitch yaw",
+			         __APP_NAME__, points_child_srcs.size());
+		}
+		std::vector<double> initial_guess(6, 0.);
+		private_node_handle.param<double>("x", initial_guess[0], 0.0);
+		private_node_handle.param<double>("y", initial_guess[1], 0.0);
+		private_node_handle.param<double>("z", initial_guess[2], 0.0);
+		private_node_handle.param<double>("roll", initial_guess[3], 0.0);
+		private_node_handle.param<double>("pitch", initial_guess[4], 0.0);
+		private_node_handle.param<double>("yaw", initial_guess[5], 0.0);
+		initial_guesses.clear();
+		for (size_t i = 0; i < points_child_srcs.size(); i++)
+		{
+			initial_guesses.insert(initial_guesses.end(), initial_guess.begin(), initial_guess.end());
+		}
+	}
+
+	std::unique_ptr<MultiLidarOfflineCalibrator> calibrator;
+	try
+	{
+		calibrator.reset(new MultiLidarOfflineCalibrator(parameters));
+		for (size_t i = 0; i < points_child_srcs.size(); i++)
+		{
+			const double* guess = &initial_guesses[6 * i];
+			Eigen::Translation3f init_translation(guess[0], guess[1], guess[2]);
+			Eigen::AngleAxisf init_rotation_x(guess[3], Eigen::Vector3f::UnitX());
+			Eigen::AngleAxisf init_rotation_y(guess[4], Eigen::Vector3f::UnitY());
+			Eigen::AngleAxisf init_rotation_z(guess[5], Eigen::Vector3f::UnitZ());
+			calibrator->AddChild(points_child_srcs[i],
+			                     (init_translation * init_rotation_z * init_rotation_y * init_rotation_x).matrix());
+		}
+	}
+	catch (const std::invalid_argument& e)
+	{
+		ROS_ERROR("[%s] %s", __APP_NAME__, e.what());
+		return 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	std::map<std::string, std::string> frame_ids;
+	bool read;
+	if (!bag_file.empty())
+	{
+		ROS_INFO("[%s] Reading %s from %s", __APP_NAME__, points_parent_src.c_str(), bag_file.c_str());
+		read = ReadBag(bag_file, points_parent_src, points_child_srcs, max_time_difference, frame_step, max_frames,
+		               *calibrator, frame_ids);
+	}
+	else
+	{
+		ROS_INFO("[%s] Reading %s from %s", __APP_NAME__, points_parent_src.c_str(), pcd_directory.c_str());
+		read = ReadPcdDirectories(pcd_directory, points_parent_src, points_child_srcs, frame_step, max_frames,
+		                          *calibrator);
+	}
+	if (!read || calibrator->GetFrameCount() == 0)
+	{
+		ROS_ERROR("[%s] No frames to calibrate", __APP_NAME__);
+		return 1;
+	}
+	auto loaded = std::chrono::steady_clock::now();
+	ROS_INFO("[%s] Calibrating %zu children with %zu frames...", __APP_NAME__, points_child_srcs.size(),
+	         calibrator->GetFrameCount());
+
+	OfflineCalibrationResults results = calibrator->Calibrate();
+	auto calibrated = std::chrono::steady_clock::now();
+
+	std::string parent_frame = frame_ids.count(points_parent_src) ? frame_ids[points_parent_src] : points_parent_src;
+	for (const auto& result : results)
+	{
+		std::string child_frame = frame_ids.count(result.child) ? frame_ids[result.child] : result.child;
+		std::cout << "transformation from " << child_frame << " to " << parent_frame << std::endl;
+		std::cout << "frames: " << result.frames << " converged: " << result.converged_frames
+		          << " inliers: " << result.inlier_frames << " mean score: " << result.mean_fitness_score
+		          << " mean iterations: " << result.mean_iterations << std::endl;
+		if (!result.valid)
+		{
+			std::cout << "No frame converged" << std::endl << std::endl;
+			continue;
+		}
+		std::cout << "deviation of the frames translation: " << result.translation_deviation
+		          << " rotation: " << result.rotation_deviation << std::endl;
+
+		Eigen::Matrix3f rotation_matrix = result.transformation.block(0,0,3,3);
+		Eigen::Vector3f translation_vector = result.transformation.block(0,3,3,1);
+		std::cout << "This transformation can be replicated using:" << std::endl;
+		std::cout << "rosrun tf static_transform_publisher " << translation_vector.transpose()
+		          << " " << rotation_matrix.eulerAngles(2,1,0).transpose() << " /" << parent_frame
+		          << " /" << child_frame << " 10" << std::endl;
+		std::cout << "Corresponding transformation matrix:" << std::endl
+		          << std::endl << result.transformation << std::endl << std::endl;
+	}
+	ROS_INFO("[%s] Read in %.1f s, calibrated in %.1f s", __APP_NAME__,
+	         std::chrono::duration<double>(loaded - start).count(),
+	         std::chrono::duration<double>(calibrated - loaded).count());
+	return 0;
+}
@@ -0,0 +1,385 @@
+/*
+ * Copyright 2018-2019 Autoware Foundation. All rights reserved.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+#include <Eigen/Geometry>
+
+#include "multi_lidar_offline_calibrator.h"
+
+namespace
+{
+typedef MultiLidarOfflineCalibrator::PointT PointT;
+typedef MultiLidarOfflineCalibrator::PointCloudT PointCloudT;
+
+Eigen::Matrix4f CreateTransformation(double x, double y, double z, double roll, double pitch, double yaw)
+{
+	Eigen::Translation3f translation(x, y, z);
+	Eigen::AngleAxisf rotation_x(roll, Eigen::Vector3f::UnitX());
+	Eigen::AngleAxisf rotation_y(pitch, Eigen::Vector3f::UnitY());
+	Eigen::AngleAxisf rotation_z(yaw, Eigen::Vector3f::UnitZ());
+	return (translation * rotation_z * rotation_y * rotation_x).matrix();
+}
+
+double TranslationError(const Eigen::Matrix4f& a, const Eigen::Matrix4f& b)
+{
+	return (a.block<3, 1>(0, 3) - b.block<3, 1>(0, 3)).norm();
+}
+
+double RotationError(const Eigen::Matrix4f& a, const Eigen::Matrix4f& b)
+{
+	Eigen::Matrix3f relative = a.block<3, 3>(0, 0).transpose() * b.block<3, 3>(0, 0);
+	return std::abs(Eigen::AngleAxisf(relative).angle());
+}
+
+/*
+ * A yard with a ground plane, walls and boxes. Every sensor samples its own points of the surfaces within its range,
+ * so the clouds of the parent and the children of a frame share the scene but not the points.
+ */
+class SyntheticScene
+{
+public:
+	explicit SyntheticScene(std::mt19937& generator) : generator_(generator)
+	{
+		std::uniform_real_distribution<float> position(-18.f, 18.f), size(0.8f, 3.f), yaw(-M_PI, M_PI);
+		for (int i = 0; i < 25; i++)
+		{
+			Box box;
+			box.pose = CreateTransformation(position(generator_), position(generator_), 0., 0., 0., yaw(generator_));
+			box.size = Eigen::Vector3f(size(generator_), size(generator_), size(generator_));
+			boxes_.push_back(box);
+		}
+	}
+
+	PointCloudT::Ptr Sample(const Eigen::Matrix4f& sensor_pose, int points)
+	{
+		std::uniform_real_distribution<float> unit(0.f, 1.f);
+		std::normal_distribution<float> noise(0.f, 0.02f);
+		Eigen::Matrix4f world_to_sensor = sensor_pose.inverse();
+		PointCloudT::Ptr cloud(new PointCloudT);
+		while ((int)cloud->size() < points)
+		{
+			Eigen::Vector3f point;
+			float surface = unit(generator_);
+			if (surface < 0.3f)
+			{
+				// ground
+				point = Eigen::Vector3f(60.f * unit(generator_) - 30.f, 60.f * unit(generator_) - 30.f, 0.f);
+			}
+			else if (surface < 0.6f)
+			{
+				// walls of the yard
+				float along = 60.f * unit(generator_) - 30.f, height = 6.f * unit(generator_);
+				int wall = (int)(4.f * unit(generator_));
+				float across = wall % 2 == 0 ? -25.f : 25.f;
+				point = wall < 2 ? Eigen::Vector3f(across, along, height) : Eigen::Vector3f(along, across, height);
+			}
+			else
+			{
+				// one side of a box
+				const Box& box = boxes_[(size_t)(unit(generator_) * boxes_.size()) % boxes_.size()];
+				Eigen::Vector3f local(unit(generator_) - 0.5f, unit(generator_) - 0.5f, unit(generator_));
+				int axis = (int)(3.f * unit(generator_)) % 3;
+				local[axis] = axis == 2 ? 1.f : (unit(generator_) < 0.5f ? -0.5f : 0.5f);
+				local = local.cwiseProduct(box.size);
+				point = (box.pose * local.homogeneous()).head<3>();
+			}
+			if ((point - sensor_pose.block<3, 1>(0, 3)).norm() > 35.f)
+			{
+				continue;
+			}
+			Eigen::Vector3f sensor_point = (world_to_sensor * point.homogeneous()).head<3>();
+			PointT sample;
+			sample.x = sensor_point.x() + noise(generator_);
+			sample.y = sensor_point.y() + noise(generator_);
+			sample.z = sensor_point.z() + noise(generator_);
+			sample.intensity = 0.f;
+			cloud->push_back(sample);
+		}
+		return cloud;
+	}
+
+private:
+	struct Box
+	{
+		Eigen::Matrix4f pose;
+		Eigen::Vector3f size;
+
+		EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+	};
+
+	std::mt19937& generator_;
+	std::vector<Box, Eigen::aligned_allocator<Box> > boxes_;
+};
+
+/*
+ * A parent with a front and a rear child, recorded at several poses in the synthetic scene.
+ */
+class SyntheticRig
+{
+public:
+	static const int FRAMES = 4;
+	// upper bound of a single Calibrate call, with ample headroom for slow or loaded machines [s]
+	static constexpr double MAX_SECONDS = 20.;
+
+	SyntheticRig() : generator_(3), scene_(generator_)
+	{
+		// transformations of the child points into the parent frame
+		extrinsics.push_back(CreateTransformation(1.2, 0.6, -0.3, 0.02, -0.03, 0.35));
+		extrinsics.push_back(CreateTransformation(-1.5, -0.8, 0.2, -0.01, 0.02, -2.4));
+
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			Eigen::Matrix4f parent_pose = CreateTransformation(-6. + 2.5 * frame, 0.6 * frame - 2., 1.8, 0., 0.,
+			                                                   0.2 * frame);
+			parent_clouds_.push_back(scene_.Sample(parent_pose, 8000));
+			child_clouds_.emplace_back();
+			child_clouds_.back()["front"] = scene_.Sample(parent_pose * extrinsics[0], 4000);
+			child_clouds_.back()["rear"] = scene_.Sample(parent_pose * extrinsics[1], 4000);
+		}
+	}
+
+	/*!
+	 * Calibrates both children from all frames.
+	 * @param in_parameters calibration parameters
+	 * @param in_initial_guesses of the front and the rear child
+	 * @param out_seconds time spent in Calibrate
+	 * @return results of the front and the rear child
+	 */
+	OfflineCalibrationResults Calibrate(const OfflineCalibrationParameters& in_parameters,
+	                                    const std::vector<Eigen::Matrix4f,
+	                                                      Eigen::aligned_allocator<Eigen::Matrix4f> >& in_initial_guesses,
+	                                    double& out_seconds) const
+	{
+		MultiLidarOfflineCalibrator calibrator(in_parameters);
+		calibrator.AddChild("front", in_initial_guesses[0]);
+		calibrator.AddChild("rear", in_initial_guesses[1]);
+		for (int frame = 0; frame < FRAMES; frame++)
+		{
+			calibrator.AddFrame(parent_clouds_[frame], child_clouds_[frame]);
+		}
+		EXPECT_EQ(calibrator.GetFrameCount(), (size_t)FRAMES);
+
+		auto start = std::chrono::steady_clock::now();
+		OfflineCalibrationResults results = calibrator.Calibrate();
+		out_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return results;
+	}
+
+	/*!
+	 * Checks the results against the extrinsics and the runtime against MAX_SECONDS, and prints their errors.
+	 * @param in_results results of the front and the rear child
+	 * @param in_label printed with the errors
+	 * @param in_seconds time spent in Calibrate
+	 */
+	void ExpectAccurate(const OfflineCalibrationResults& in_results, const std::string& in_label, double in_seconds) const
+	{
+		ASSERT_EQ(in_results.size(), 2u);
+		EXPECT_LT(in_seconds, MAX_SECONDS) << in_label;
+		for (size_t i = 0; i < in_results.size(); i++)
+		{
+			const OfflineCalibrationResult& result = in_results[i];
+			ASSERT_TRUE(result.valid) << result.child;
+			EXPECT_EQ(result.frames, (size_t)FRAMES);
+			EXPECT_GE(result.inlier_frames, (size_t)FRAMES / 2) << result.child;
+			EXPECT_LT(TranslationError(result.transformation, extrinsics[i]), 0.05) << result.child;
+			EXPECT_LT(RotationError(result.transformation, extrinsics[i]), 0.01) << result.child;
+			printf("[ %s, %s ] %d frames in %.2f s, %zu inliers, %.0f iterations, error %.3f m %.4f rad, deviation "
+			       "%.3f m %.4f rad\n", result.child.c_str(), in_label.c_str(), FRAMES, in_seconds, result.inlier_frames,
+			       result.mean_iterations, TranslationError(result.transformation, extrinsics[i]),
+			       RotationError(result.transformation, extrinsics[i]), result.translation_deviation,
+			       result.rotation_deviation);
+		}
+	}
+
+	std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > extrinsics;
+
+private:
+	std::mt19937 generator_;
+	SyntheticScene scene_;
+	std::vector<PointCloudT::ConstPtr> parent_clouds_;
+	std::vector<std::map<std::string, PointCloudT::ConstPtr> > child_clouds_;
+};
+
+constexpr double SyntheticRig::MAX_SECONDS;
+
+FrameCalibrationEstimate CreateEstimate(double x, double yaw, bool converged)
+{
+	FrameCalibrationEstimate estimate;
+	estimate.transformation = CreateTransformation(x, 0.5, 0., 0., 0., yaw);
+	estimate.converged = converged;
+	estimate.fitness_score = 0.1;
+	estimate.iterations = 10;
+	return estimate;
+}
+}  // namespace
+
+TEST(MultiLidarOfflineCalibrator, combineEstimatesRejectsOutliers)
+{
+	OfflineCalibrationParameters parameters;
+	FrameCalibrationEstimates estimates;
+	estimates.push_back(CreateEstimate(1.00, 0.30, true));
+	estimates.push_back(CreateEstimate(1.02, 0.31, true));
+	estimates.push_back(CreateEstimate(0.98, 0.29, true));
+	estimates.push_back(CreateEstimate(3.00, 0.30, true));   // translation outlier
+	estimates.push_back(CreateEstimate(1.00, 1.00, true));   // rotation outlier
+	estimates.push_back(CreateEstimate(-5.0, 2.00, false));  // not converged
+
+	OfflineCalibrationResult result = MultiLidarOfflineCalibrator::CombineEstimates("child", estimates, parameters);
+	ASSERT_TRUE(result.valid);
+	EXPECT_EQ(result.child, "child");
+	EXPECT_EQ(result.frames, 6u);
+	EXPECT_EQ(result.converged_frames, 5u);
+	EXPECT_EQ(result.inlier_frames, 3u);
+	EXPECT_LT(TranslationError(result.transformation, CreateTransformation(1., 0.5, 0., 0., 0., 0.3)), 1e-5);
+	EXPECT_LT(RotationError(result.transformation, CreateTransformation(1., 0.5, 0., 0., 0., 0.3)), 1e-5);
+	EXPECT_NEAR(result.translation_deviation, std::sqrt(0.02 * 0.02 * 2 / 3), 1e-5);
+	EXPECT_NEAR(result.rotation_deviation, std::sqrt(0.01 * 0.01 * 2 / 3), 1e-4);
+	EXPECT_NEAR(result.mean_fitness_score, 0.1, 1e-9);
+	EXPECT_NEAR(result.mean_iterations, 10., 1e-9);
+}
+
+TEST(MultiLidarOfflineCalibrator, combineEstimatesAcrossQuaternionSigns)
+{
+	OfflineCalibrationParameters parameters;
+	FrameCalibrationEstimates estimates;
+	estimates.push_back(CreateEstimate(0., M_PI - 0.01, true));
+	estimates.push_back(CreateEstimate(0., -M_PI + 0.01, true));
+
+	OfflineCalibrationResult result = MultiLidarOfflineCalibrator::CombineEstimates("child", estimates, parameters);
+	ASSERT_TRUE(result.valid);
+	EXPECT_EQ(result.inlier_frames, 2u);
+	EXPECT_LT(RotationError(result.transformation, CreateTransformation(0., 0.5, 0., 0., 0., M_PI)), 1e-5);
+}
+
+TEST(MultiLidarOfflineCalibrator, noConvergedFrame)
+{
+	OfflineCalibrationParameters parameters;
+	FrameCalibrationEstimates estimates;
+	estimates.push_back(CreateEstimate(1., 0., false));
+
+	OfflineCalibrationResult result = MultiLidarOfflineCalibrator::CombineEstimates("child", estimates, parameters);
+	EXPECT_FALSE(result.valid);
+	EXPECT_EQ(result.frames, 1u);
+	EXPECT_EQ(result.converged_frames, 0u);
+}
+
+TEST(MultiLidarOfflineCalibrator, calibrateSyntheticRig)
+{
+	SyntheticRig rig;
+	std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > initial_guesses;
+	initial_guesses.push_back(CreateTransformation(1.5, 0.4, -0.2, 0., 0., 0.3));
+	initial_guesses.push_back(CreateTransformation(-1.2, -1.0, 0., 0., 0., -2.45));
+
+	OfflineCalibrationResults single_thread_results;
+	for (int threads : {1, 0})
+	{
+		OfflineCalibrationParameters parameters;
+		parameters.voxel_size = 0.2;
+		parameters.ndt_epsilon = 0.001;
+		parameters.threads = threads;
+		double seconds = 0.;
+		OfflineCalibrationResults results = rig.Calibrate(parameters, initial_guesses, seconds);
+		rig.ExpectAccurate(results, std::to_string(threads) + " threads", seconds);
+
+		// the frames are aligned independently, so the threads don't change the result
+		if (threads == 1)
+		{
+			single_thread_results = results;
+		}
+		else
+		{
+			for (size_t i = 0; i < results.size(); i++)
+			{
+				EXPECT_TRUE(results[i].transformation.isApprox(single_thread_results[i].transformation))
+					<< results[i].child;
+			}
+		}
+	}
+}
+
+TEST(MultiLidarOfflineCalibrator, calibrateSyntheticRigFromDistantGuess)
+{
+	// about 2 m and 0.25 rad off, farther than the finest resolution alone converges from
+	SyntheticRig rig;
+	std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > initial_guesses;
+	initial_guesses.push_back(CreateTransformation(2.7, -0.4, 0.2, -0.08, 0.12, 0.1));
+	initial_guesses.push_back(CreateTransformation(0., -1.8, -0.8, 0.04, -0.08, -2.65));
+
+	OfflineCalibrationParameters parameters;
+	parameters.voxel_size = 0.2;
+	parameters.ndt_epsilon = 0.001;
+	double seconds = 0.;
+	OfflineCalibrationResults results = rig.Calibrate(parameters, initial_guesses, seconds);
+	rig.ExpectAccurate(results, "distant guess", seconds);
+}
+
+TEST(MultiLidarOfflineCalibrator, iterationLimitIsNotConvergence)
+{
+	// one iteration cannot reach the epsilon from this guess, so NDT stops at the limit
+	SyntheticRig rig;
+	std::vector<Eigen::Matrix4f, Eigen::aligned_allocator<Eigen::Matrix4f> > initial_guesses;
+	initial_guesses.push_back(CreateTransformation(1.5, 0.4, -0.2, 0., 0., 0.3));
+	initial_guesses.push_back(CreateTransformation(-1.2, -1.0, 0., 0., 0., -2.45));
+
+	OfflineCalibrationParameters parameters;
+	parameters.voxel_size = 0.2;
+	parameters.ndt_epsilon = 1e-9;
+	parameters.ndt_iterations = 1;
+	parameters.ndt_resolutions = {1.0};
+	double seconds = 0.;
+	OfflineCalibrationResults results = rig.Calibrate(parameters, initial_guesses, seconds);
+	ASSERT_EQ(results.size(), 2u);
+	for (const auto& result : results)
+	{
+		EXPECT_EQ(result.frames, (size_t)SyntheticRig::FRAMES) << result.child;
+		EXPECT_EQ(result.converged_frames, 0u) << result.child;
+		EXPECT_FALSE(result.valid) << result.child;
+	}
+}
+
+TEST(MultiLidarOfflineCalibrator, framesWithoutChildClouds)
+{
+	OfflineCalibrationParameters parameters;
+	MultiLidarOfflineCalibrator calibrator(parameters);
+	calibrator.AddChild("front", Eigen::Matrix4f::Identity());
+	EXPECT_THROW(calibrator.AddChild("front", Eigen::Matrix4f::Identity()), std::invalid_argument);
+
+	PointCloudT::Ptr cloud(new PointCloudT);
+	PointT point;
+	point.x = point.y = point.z = 1.f;
+	cloud->push_back(point);
+	std::map<std::string, PointCloudT::ConstPtr> child_clouds;
+	child_clouds["unknown"] = cloud;
+	calibrator.AddFrame(cloud, child_clouds);
+	EXPECT_EQ(calibrator.GetFrameCount(), 0u);
+
+	OfflineCalibrationResults results = calibrator.Calibrate();
+	ASSERT_EQ(results.size(), 1u);
+	EXPECT_FALSE(results[0].valid);
+	EXPECT_EQ(results[0].frames, 0u);
+}
+
+int main(int argc, char** argv)
+{
+	testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}